@@ -6,6 +6,7 @@
 #include <Core/GameState/GameStateBase.h>
 #include <Core/System/Window.h>
 #include <Foundation/Application/Application.h>
+#include <Foundation/Memory/HeapProfile.h>
 #include <Foundation/Types/UniquePtr.h>
 
 class ezWindowBase;
@@ -73,6 +74,12 @@ public:
   /// \brief Does a profiling capture and writes it to disk at ':appdata'
   void TakeProfilingCapture();
 
+  /// \brief Captures a heap profile of all allocators with sampled tracking and writes it to disk at ':appdata/HeapProfiles'.
+  ///
+  /// The file starts with the difference to the previous heap profile, which shows where memory was allocated in between.
+  /// Set the CVar 'App.HeapProfileInterval' to write heap profiles periodically.
+  void TakeHeapProfile();
+
   /// \brief Schedules a screenshot to be taken at the end of the frame.
   ///
   /// After taking a screenshot, StoreScreenshot() is executed, which may decide where to write the result to.
@@ -89,6 +96,12 @@ protected:
   /// expose TakeScreenshot() as a console function
   ezConsoleFunction<void()> m_ConFunc_TakeScreenshot;
 
+  ezHeapProfile m_LastHeapProfile;
+  ezTime m_LastHeapProfileTime;
+
+  /// expose TakeHeapProfile() as a console function
+  ezConsoleFunction<void()> m_ConFunc_TakeHeapProfile;
+
   ///@}
   /// \name Frame Captures
   ///@{
@@ -8,6 +8,7 @@
 #include <Core/System/Window.h>
 #include <Foundation/Communication/GlobalEvent.h>
 #include <Foundation/Communication/Telemetry.h>
+#include <Foundation/Configuration/CVar.h>
 #include <Foundation/Configuration/Singleton.h>
 #include <Foundation/Configuration/Startup.h>
 #include <Foundation/IO/FileSystem/FileWriter.h>
@@ -19,11 +20,14 @@
 #include <Foundation/Time/Timestamp.h>
 #include <Texture/Image/Image.h>
 
+ezCVarFloat cvar_AppHeapProfileInterval("App.HeapProfileInterval", 0.0f, ezCVarFlags::Default, "Seconds between two heap profiles written to ':appdata/HeapProfiles', 0 to disable. Only allocators with sampled tracking show up in heap profiles.");
+
 ezGameApplicationBase* ezGameApplicationBase::s_pGameApplicationBaseInstance = nullptr;
 
 ezGameApplicationBase::ezGameApplicationBase(ezStringView sAppName)
   : ezApplication(sAppName)
   , m_ConFunc_TakeScreenshot("TakeScreenshot", "()", ezMakeDelegate(&ezGameApplicationBase::TakeScreenshot, this))
+  , m_ConFunc_TakeHeapProfile("TakeHeapProfile", "()", ezMakeDelegate(&ezGameApplicationBase::TakeHeapProfile, this))
   , m_ConFunc_CaptureFrame("CaptureFrame", "()", ezMakeDelegate(&ezGameApplicationBase::CaptureFrame, this))
 {
   s_pGameApplicationBaseInstance = this;
@@ -78,6 +82,60 @@ void ezGameApplicationBase::TakeProfilingCapture()
   ezTaskSystem::StartSingleTask(pWriteProfilingDataTask, ezTaskPriority::LongRunning);
 }
 
+void ezGameApplicationBase::TakeHeapProfile()
+{
+  class WriteHeapProfileTask final : public ezTask
+  {
+  public:
+    ezHeapProfile m_Profile;
+    ezHeapProfile m_PreviousProfile;
+
+    WriteHeapProfileTask() = default;
+    ~WriteHeapProfileTask() = default;
+
+  private:
+    virtual void Execute() override
+    {
+      ezStringBuilder sText;
+      auto Append = [&](const char* szText)
+      { sText.Append(szText); };
+
+      ezHeapProfile difference;
+      difference.MakeDifference(m_PreviousProfile, m_Profile);
+
+      sText.Append("Difference to the previous heap profile\n\n");
+      difference.Print(Append);
+      sText.Append("\n\nCurrent heap profile\n\n");
+      m_Profile.Print(Append, ezMath::MaxValue<ezUInt32>());
+
+      ezStringBuilder sPath(":appdata/HeapProfiles/", ezApplication::GetApplicationInstance()->GetApplicationName());
+      AppendCurrentTimestamp(sPath);
+      sPath.Append(".txt");
+
+      ezFileWriter fileWriter;
+      if (fileWriter.Open(sPath) == EZ_SUCCESS)
+      {
+        fileWriter.WriteBytes(sText.GetData(), sText.GetElementCount()).IgnoreResult();
+        ezLog::Info("Heap profile saved to '{0}'.", fileWriter.GetFilePathAbsolute().GetData());
+      }
+      else
+      {
+        ezLog::Error("Could not write heap profile to '{0}'.", sPath);
+      }
+    }
+  };
+
+  ezSharedPtr<WriteHeapProfileTask> pWriteHeapProfileTask = EZ_DEFAULT_NEW(WriteHeapProfileTask);
+  pWriteHeapProfileTask->ConfigureTask("Write Heap Profile", ezTaskNesting::Never);
+  pWriteHeapProfileTask->m_Profile.Capture();
+  pWriteHeapProfileTask->m_PreviousProfile = m_LastHeapProfile;
+
+  m_LastHeapProfile = pWriteHeapProfileTask->m_Profile;
+  m_LastHeapProfileTime = ezTime::Now();
+
+  ezTaskSystem::StartSingleTask(pWriteHeapProfileTask, ezTaskPriority::LongRunning);
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 void ezGameApplicationBase::TakeScreenshot()
@@ -531,6 +589,11 @@ void ezGameApplicationBase::Run_FinishFrame()
   ezFrameAllocator::Swap();
   ezProfilingSystem::StartNewFrame();
 
+  if (cvar_AppHeapProfileInterval > 0.0f && ezTime::Now() - m_LastHeapProfileTime >= ezTime::MakeFromSeconds(cvar_AppHeapProfileInterval))
+  {
+    TakeHeapProfile();
+  }
+
   // if many messages have been logged, make sure they get written to disk
   ezLog::Flush(100, ezTime::MakeFromSeconds(10));
 
@@ -59,6 +59,23 @@ public:
   /// Prefer to use more efficient methods on derived classes, only use this if you need to go through a ezComponentManagerBase pointer.
   virtual void CollectAllComponents(ezDynamicArray<ezComponent*>& out_allComponents, bool bOnlyActive) = 0;
 
+  /// \brief A queued message together with the component of this manager that receives it.
+  struct MessageBatchEntry
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    ezComponent* m_pComponent;
+    ezMessage* m_pMessage;
+  };
+
+  /// \brief Override this to process many queued messages of the same type for components of this manager at once.
+  ///
+  /// When batched message dispatch is enabled (cvar 'World.BatchedMessageDispatch', on by default), ezWorld groups the queued messages by message type
+  /// and receiver component type and passes each group to this function. All components in the batch were active and initialized
+  /// when the batch was built. The messages are in the same order in which they would have been dispatched one by one.
+  /// Return false to dispatch the messages through the regular message handlers instead, which is what the default implementation does.
+  virtual bool HandleMessageBatch(ezMessageId msgId, ezArrayPtr<const MessageBatchEntry> batch);
+
 protected:
   /// \cond
   // internal methods
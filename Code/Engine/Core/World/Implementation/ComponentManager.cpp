@@ -45,6 +45,11 @@ void ezComponentManagerBase::DeleteComponent(ezComponent* pComponent)
   GetWorld()->m_Data.m_DeadComponents.Insert(pComponent);
 }
 
+bool ezComponentManagerBase::HandleMessageBatch(ezMessageId msgId, ezArrayPtr<const MessageBatchEntry> batch)
+{
+  return false;
+}
+
 void ezComponentManagerBase::Deinitialize()
 {
   for (auto it = m_Components.GetIterator(); it.IsValid(); ++it)
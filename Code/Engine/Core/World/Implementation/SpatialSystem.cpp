@@ -45,6 +45,16 @@ void ezSpatialSystem::FindObjectsInBox(const ezBoundingBox& box, const QueryPara
     });
 }
 
+void ezSpatialSystem::FindVisibleObjectsMultiView(ezArrayPtr<const ezFrustum> frustums, const QueryParams& queryParams, ezArrayPtr<ezDynamicArray<const ezGameObject*>* const> out_objects, ezVisibilityState visType) const
+{
+  EZ_ASSERT_DEV(frustums.GetCount() == out_objects.GetCount(), "Need exactly one output array per frustum");
+
+  for (ezUInt32 i = 0; i < frustums.GetCount(); ++i)
+  {
+    FindVisibleObjects(frustums[i], queryParams, *out_objects[i], {}, visType);
+  }
+}
+
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
 void ezSpatialSystem::GetInternalStats(ezStringBuilder& ref_sSb) const
 {
@@ -0,0 +1,1160 @@
+#include <Core/CorePCH.h>
+
+#include <Core/World/SpatialSystem_Bvh.h>
+#include <Foundation/Configuration/CVar.h>
+#include <Foundation/Profiling/Profiling.h>
+#include <Foundation/SimdMath/SimdConversion.h>
+#include <Foundation/Time/Stopwatch.h>
+
+ezCVarFloat cvar_SpatialBvhRebuildThreshold("Spatial.Bvh.RebuildThreshold", 1.0f, ezCVarFlags::Default, "Fraction of the objects that have to be inserted, removed or moved out of their node bounds before the BVH is rebuilt");
+
+namespace
+{
+  static constexpr ezUInt32 CHILD_IS_DATA = 1u << 31;
+  static constexpr ezUInt32 MIN_CHANGES_FOR_REBUILD = 64;
+  static constexpr ezUInt32 NUM_BINS = 16;
+
+  /// Moving objects get this fraction of their radius as additional slack in the hierarchy, so that they don't have to refit it every frame.
+  static constexpr float MOVING_DATA_MARGIN = 0.25f;
+
+  EZ_ALWAYS_INLINE bool FilterDataByTags(const ezTagSet& tags, const ezTagSet* pIncludeTags, const ezTagSet* pExcludeTags)
+  {
+    if (pExcludeTags != nullptr && !pExcludeTags->IsEmpty() && pExcludeTags->IsAnySet(tags))
+      return true;
+
+    if (pIncludeTags != nullptr && !pIncludeTags->IsEmpty() && !pIncludeTags->IsAnySet(tags))
+      return true;
+
+    return false;
+  }
+
+  EZ_ALWAYS_INLINE ezUInt32 GetLaneMask(const ezSimdVec4b& v)
+  {
+    return (v.x() ? 1u : 0u) | (v.y() ? 2u : 0u) | (v.z() ? 4u : 0u) | (v.w() ? 8u : 0u);
+  }
+
+  EZ_ALWAYS_INLINE float GetHalfSurfaceArea(const ezSimdBBox& box)
+  {
+    const ezSimdVec4f vExtents = box.GetExtents();
+    return (vExtents.CompMul(vExtents.Get<ezSwizzle::YZXW>())).HorizontalSum<3>();
+  }
+
+  /// The box under which the data is stored in the hierarchy. Queries test the bounding sphere of the data, so the box has to enclose the
+  /// sphere as well.
+  EZ_ALWAYS_INLINE ezSimdBBox ComputeNodeBox(const ezSimdBBoxSphere& bounds, float fMargin)
+  {
+    const ezSimdVec4f vRadius = bounds.m_CenterAndRadius.Get<ezSwizzle::WWWW>();
+    const ezSimdVec4f vHalfExtents = ezSimdVec4f::MulAdd(vRadius, ezSimdVec4f(fMargin), bounds.m_BoxHalfExtents.CompMax(vRadius));
+
+    return ezSimdBBox::MakeFromCenterAndHalfExtents(bounds.m_CenterAndRadius, vHalfExtents);
+  }
+
+  EZ_ALWAYS_INLINE ezSimdBSphere GetInfiniteSphere()
+  {
+    return ezSimdBSphere(ezSimdVec4f::MakeZero(), ezMath::MaxValue<float>());
+  }
+
+  template <typename NodeType>
+  EZ_ALWAYS_INLINE ezSimdBBox GetChildBox(const NodeType& node, ezUInt32 uiSlot)
+  {
+    return ezSimdBBox(ezSimdVec4f(node.m_MinX[uiSlot], node.m_MinY[uiSlot], node.m_MinZ[uiSlot]), ezSimdVec4f(node.m_MaxX[uiSlot], node.m_MaxY[uiSlot], node.m_MaxZ[uiSlot]));
+  }
+
+  template <typename NodeType>
+  EZ_ALWAYS_INLINE ezSimdBSphere GetChildSphere(const NodeType& node, ezUInt32 uiSlot)
+  {
+    return ezSimdBSphere(ezSimdVec4f(node.m_SphereX[uiSlot], node.m_SphereY[uiSlot], node.m_SphereZ[uiSlot]), node.m_SphereR[uiSlot]);
+  }
+
+  /// The bounds of all four children of a node, loaded into SIMD registers.
+  struct ChildBoxes
+  {
+    template <typename NodeType>
+    EZ_ALWAYS_INLINE explicit ChildBoxes(const NodeType& node)
+    {
+      m_MinX.Load<4>(node.m_MinX);
+      m_MinY.Load<4>(node.m_MinY);
+      m_MinZ.Load<4>(node.m_MinZ);
+      m_MaxX.Load<4>(node.m_MaxX);
+      m_MaxY.Load<4>(node.m_MaxY);
+      m_MaxZ.Load<4>(node.m_MaxZ);
+    }
+
+    ezSimdVec4f m_MinX, m_MinY, m_MinZ;
+    ezSimdVec4f m_MaxX, m_MaxY, m_MaxZ;
+  };
+
+  struct ChildSpheres
+  {
+    template <typename NodeType>
+    EZ_ALWAYS_INLINE explicit ChildSpheres(const NodeType& node)
+    {
+      m_X.Load<4>(node.m_SphereX);
+      m_Y.Load<4>(node.m_SphereY);
+      m_Z.Load<4>(node.m_SphereZ);
+      m_R.Load<4>(node.m_SphereR);
+    }
+
+    ezSimdVec4f m_X, m_Y, m_Z, m_R;
+  };
+
+  struct FrustumPlanes
+  {
+    explicit FrustumPlanes(const ezFrustum& frustum)
+    {
+      for (ezUInt32 i = 0; i < 6; ++i)
+      {
+        const ezPlane& plane = frustum.GetPlane(i);
+        m_NormalX[i] = ezSimdVec4f(plane.m_vNormal.x);
+        m_NormalY[i] = ezSimdVec4f(plane.m_vNormal.y);
+        m_NormalZ[i] = ezSimdVec4f(plane.m_vNormal.z);
+        m_NegDistance[i] = ezSimdVec4f(plane.m_fNegDistance);
+      }
+    }
+
+    ezSimdVec4f m_NormalX[6];
+    ezSimdVec4f m_NormalY[6];
+    ezSimdVec4f m_NormalZ[6];
+    ezSimdVec4f m_NegDistance[6];
+  };
+
+  /// Returns a bit for every box that is not fully outside of any of the frustum planes.
+  EZ_FORCE_INLINE ezUInt32 BoxesFrustumIntersect(const ChildBoxes& boxes, const FrustumPlanes& planes)
+  {
+    ezSimdVec4b outside(false);
+
+    for (ezUInt32 i = 0; i < 6; ++i)
+    {
+      // the corner that lies furthest inside of the plane decides whether the box is outside
+      ezSimdVec4f dist = planes.m_NegDistance[i];
+      dist += (boxes.m_MinX.CompMul(planes.m_NormalX[i])).CompMin(boxes.m_MaxX.CompMul(planes.m_NormalX[i]));
+      dist += (boxes.m_MinY.CompMul(planes.m_NormalY[i])).CompMin(boxes.m_MaxY.CompMul(planes.m_NormalY[i]));
+      dist += (boxes.m_MinZ.CompMul(planes.m_NormalZ[i])).CompMin(boxes.m_MaxZ.CompMul(planes.m_NormalZ[i]));
+
+      outside = outside || (dist > ezSimdVec4f::MakeZero());
+    }
+
+    return GetLaneMask(!outside);
+  }
+
+  /// Returns a bit for every sphere that is not fully outside of any of the frustum planes.
+  EZ_FORCE_INLINE ezUInt32 SpheresFrustumIntersect(const ChildSpheres& spheres, const FrustumPlanes& planes)
+  {
+    ezSimdVec4b outside(false);
+
+    for (ezUInt32 i = 0; i < 6; ++i)
+    {
+      ezSimdVec4f dist = ezSimdVec4f::MulAdd(spheres.m_X, planes.m_NormalX[i], planes.m_NegDistance[i]);
+      dist = ezSimdVec4f::MulAdd(spheres.m_Y, planes.m_NormalY[i], dist);
+      dist = ezSimdVec4f::MulAdd(spheres.m_Z, planes.m_NormalZ[i], dist);
+
+      outside = outside || (dist > spheres.m_R);
+    }
+
+    return GetLaneMask(!outside);
+  }
+
+  EZ_FORCE_INLINE ezUInt32 BoxesBoxIntersect(const ChildBoxes& boxes, const ezSimdBBox& box)
+  {
+    const ezSimdVec4f minX(box.m_Min.x()), minY(box.m_Min.y()), minZ(box.m_Min.z());
+    const ezSimdVec4f maxX(box.m_Max.x()), maxY(box.m_Max.y()), maxZ(box.m_Max.z());
+
+    const ezSimdVec4b overlapX = (boxes.m_MinX <= maxX) && (boxes.m_MaxX >= minX);
+    const ezSimdVec4b overlapY = (boxes.m_MinY <= maxY) && (boxes.m_MaxY >= minY);
+    const ezSimdVec4b overlapZ = (boxes.m_MinZ <= maxZ) && (boxes.m_MaxZ >= minZ);
+
+    return GetLaneMask(overlapX && overlapY && overlapZ);
+  }
+
+  EZ_FORCE_INLINE ezUInt32 BoxesSphereIntersect(const ChildBoxes& boxes, const ezSimdBSphere& sphere)
+  {
+    const ezSimdVec4f x(sphere.m_CenterAndRadius.x()), y(sphere.m_CenterAndRadius.y()), z(sphere.m_CenterAndRadius.z());
+    const ezSimdVec4f r(sphere.m_CenterAndRadius.w());
+    const ezSimdVec4f zero = ezSimdVec4f::MakeZero();
+
+    const ezSimdVec4f dx = (boxes.m_MinX - x).CompMax(x - boxes.m_MaxX).CompMax(zero);
+    const ezSimdVec4f dy = (boxes.m_MinY - y).CompMax(y - boxes.m_MaxY).CompMax(zero);
+    const ezSimdVec4f dz = (boxes.m_MinZ - z).CompMax(z - boxes.m_MaxZ).CompMax(zero);
+
+    ezSimdVec4f distSquared = dx.CompMul(dx);
+    distSquared = ezSimdVec4f::MulAdd(dy, dy, distSquared);
+    distSquared = ezSimdVec4f::MulAdd(dz, dz, distSquared);
+
+    return GetLaneMask(distSquared <= r.CompMul(r));
+  }
+
+  /// Partitions the items with a binned surface area heuristic along the axis in which their centers are spread the most.
+  /// Returns the number of items in the first partition, which is always between 1 and the number of items - 1.
+  template <typename BuildItem>
+  ezUInt32 SplitItems(ezArrayPtr<BuildItem> items)
+  {
+    const ezUInt32 uiNumItems = items.GetCount();
+
+    float fCenterMin[3] = {ezMath::MaxValue<float>(), ezMath::MaxValue<float>(), ezMath::MaxValue<float>()};
+    float fCenterMax[3] = {-ezMath::MaxValue<float>(), -ezMath::MaxValue<float>(), -ezMath::MaxValue<float>()};
+
+    for (const BuildItem& item : items)
+    {
+      for (ezUInt32 a = 0; a < 3; ++a)
+      {
+        fCenterMin[a] = ezMath::Min(fCenterMin[a], item.m_fCenter[a]);
+        fCenterMax[a] = ezMath::Max(fCenterMax[a], item.m_fCenter[a]);
+      }
+    }
+
+    ezUInt32 uiAxis = 0;
+    for (ezUInt32 a = 1; a < 3; ++a)
+    {
+      if (fCenterMax[a] - fCenterMin[a] > fCenterMax[uiAxis] - fCenterMin[uiAxis])
+        uiAxis = a;
+    }
+
+    const float fExtent = fCenterMax[uiAxis] - fCenterMin[uiAxis];
+    if (fExtent <= ezMath::SmallEpsilon<float>())
+    {
+      // all centers are at the same spot, any split is as good as any other
+      return uiNumItems / 2;
+    }
+
+    const float fBinScale = (NUM_BINS * (1.0f - ezMath::LargeEpsilon<float>())) / fExtent;
+    auto GetBin = [&](const BuildItem& item) {
+      return ezMath::Min(static_cast<ezUInt32>((item.m_fCenter[uiAxis] - fCenterMin[uiAxis]) * fBinScale), NUM_BINS - 1);
+    };
+
+    ezSimdBBox binBoxes[NUM_BINS];
+    ezUInt32 binCounts[NUM_BINS] = {};
+    for (ezUInt32 b = 0; b < NUM_BINS; ++b)
+    {
+      binBoxes[b] = ezSimdBBox::MakeInvalid();
+    }
+
+    for (const BuildItem& item : items)
+    {
+      const ezUInt32 uiBin = GetBin(item);
+      binBoxes[uiBin].ExpandToInclude(item.m_Box);
+      ++binCounts[uiBin];
+    }
+
+    // sweep from the right to get the cost of everything right of each split position
+    float fRightCost[NUM_BINS] = {};
+    {
+      ezSimdBBox box = ezSimdBBox::MakeInvalid();
+      ezUInt32 uiCount = 0;
+      for (ezUInt32 b = NUM_BINS - 1; b > 0; --b)
+      {
+        box.ExpandToInclude(binBoxes[b]);
+        uiCount += binCounts[b];
+        fRightCost[b - 1] = uiCount > 0 ? GetHalfSurfaceArea(box) * uiCount : 0.0f;
+      }
+    }
+
+    ezUInt32 uiBestSplit = 0;
+    float fBestCost = ezMath::MaxValue<float>();
+    {
+      ezSimdBBox box = ezSimdBBox::MakeInvalid();
+      ezUInt32 uiCount = 0;
+      for (ezUInt32 b = 0; b < NUM_BINS - 1; ++b)
+      {
+        box.ExpandToInclude(binBoxes[b]);
+        uiCount += binCounts[b];
+
+        const float fCost = (uiCount > 0 ? GetHalfSurfaceArea(box) * uiCount : 0.0f) + fRightCost[b];
+        if (fCost < fBestCost)
+        {
+          fBestCost = fCost;
+          uiBestSplit = b;
+        }
+      }
+    }
+
+    // the first and the last bin are never empty, so both partitions always get at least one item
+    ezUInt32 uiLeft = 0;
+    ezUInt32 uiRight = uiNumItems;
+    while (uiLeft < uiRight)
+    {
+      if (GetBin(items[uiLeft]) <= uiBestSplit)
+      {
+        ++uiLeft;
+      }
+      else
+      {
+        --uiRight;
+        ezMath::Swap(items[uiLeft], items[uiRight]);
+      }
+    }
+
+    return uiLeft;
+  }
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+struct ezSpatialSystem_Bvh::Node
+{
+  EZ_DECLARE_POD_TYPE();
+
+  // Bounds of the four children in SoA layout. Only the first m_uiNumChildren entries are valid.
+  float m_MinX[4];
+  float m_MinY[4];
+  float m_MinZ[4];
+  float m_MaxX[4];
+  float m_MaxY[4];
+  float m_MaxZ[4];
+
+  // Bounding spheres of data children. Node children get an infinite sphere so that the sphere test always passes for them.
+  float m_SphereX[4];
+  float m_SphereY[4];
+  float m_SphereZ[4];
+  float m_SphereR[4];
+
+  ezUInt32 m_Children[4];         ///< Either a node index or a data index with CHILD_IS_DATA set
+  ezUInt32 m_CategoryBitmasks[4]; ///< Combined category bitmask of everything below each child
+
+  ezUInt32 m_uiParent;
+  ezUInt32 m_uiParentSlot;
+  ezUInt32 m_uiNumChildren;
+};
+
+struct ezSpatialSystem_Bvh::BuildItem
+{
+  ezSimdBBox m_Box;
+  float m_fCenter[3];
+  ezUInt32 m_uiDataIndex;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+template <typename ChildTestFunc, typename DataFunc>
+ezVisitorExecution::Enum ezSpatialSystem_Bvh::Traverse(ezUInt32 uiCategoryBitmask, ChildTestFunc childTest, DataFunc dataFunc) const
+{
+  if (m_uiRootNode == ezInvalidIndex)
+    return ezVisitorExecution::Continue;
+
+  ezHybridArray<ezUInt32, 64> stack;
+  stack.PushBack(m_uiRootNode);
+
+  while (!stack.IsEmpty())
+  {
+    const Node& node = m_Nodes[stack.PeekBack()];
+    stack.PopBack();
+
+    ezUInt32 uiMask = 0;
+    for (ezUInt32 i = 0; i < node.m_uiNumChildren; ++i)
+    {
+      uiMask |= (node.m_CategoryBitmasks[i] & uiCategoryBitmask) != 0 ? (1u << i) : 0u;
+    }
+
+    if (uiMask == 0)
+      continue;
+
+    uiMask = childTest(node, uiMask);
+
+    while (uiMask != 0)
+    {
+      const ezUInt32 i = ezMath::FirstBitLow(uiMask);
+      uiMask &= uiMask - 1;
+
+      const ezUInt32 uiChild = node.m_Children[i];
+      if (uiChild & CHILD_IS_DATA)
+      {
+        if (dataFunc(m_DataTable.GetValueUnchecked(uiChild & ~CHILD_IS_DATA)) == ezVisitorExecution::Stop)
+          return ezVisitorExecution::Stop;
+      }
+      else
+      {
+        stack.PushBack(uiChild);
+      }
+    }
+  }
+
+  return ezVisitorExecution::Continue;
+}
+
+template <typename Shape, typename ChildTestFunc>
+void ezSpatialSystem_Bvh::FindObjectsInShape(const Shape& shape, const QueryParams& queryParams, QueryCallback callback, ChildTestFunc childTest) const
+{
+  const bool bUseTagsFilter = queryParams.m_pIncludeTags != nullptr || queryParams.m_pExcludeTags != nullptr;
+
+  ezUInt32 uiNumObjectsTested = 0;
+  ezUInt32 uiNumObjectsPassed = 0;
+
+  auto DataCallback = [&](const Data& data) {
+    ++uiNumObjectsTested;
+
+    if (!shape.Overlaps(data.m_Bounds.GetSphere()))
+      return ezVisitorExecution::Continue;
+
+    if (bUseTagsFilter && FilterDataByTags(data.m_Tags, queryParams.m_pIncludeTags, queryParams.m_pExcludeTags))
+      return ezVisitorExecution::Continue;
+
+    ++uiNumObjectsPassed;
+    return callback(data.m_pObject);
+  };
+
+  ezVisitorExecution::Enum res = Traverse(queryParams.m_uiCategoryBitmask, [&](const Node& node, ezUInt32 uiMask) { return uiMask & childTest(ChildBoxes(node)); }, DataCallback);
+
+  // always visible data is part of every query, just like it would be when it had infinite bounds
+  for (ezUInt32 i = 0; i < m_AlwaysVisibleData.GetCount() && res == ezVisitorExecution::Continue; ++i)
+  {
+    const Data& data = m_DataTable.GetValueUnchecked(m_AlwaysVisibleData[i]);
+    if ((data.m_uiCategoryBitmask & queryParams.m_uiCategoryBitmask) == 0)
+      continue;
+
+    ++uiNumObjectsTested;
+
+    if (bUseTagsFilter && FilterDataByTags(data.m_Tags, queryParams.m_pIncludeTags, queryParams.m_pExcludeTags))
+      continue;
+
+    ++uiNumObjectsPassed;
+    res = callback(data.m_pObject);
+  }
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  if (queryParams.m_pStats != nullptr)
+  {
+    queryParams.m_pStats->m_uiTotalNumObjects = m_DataTable.GetCount();
+    queryParams.m_pStats->m_uiNumObjectsTested += uiNumObjectsTested;
+    queryParams.m_pStats->m_uiNumObjectsPassed += uiNumObjectsPassed;
+  }
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// clang-format off
+EZ_BEGIN_DYNAMIC_REFLECTED_TYPE(ezSpatialSystem_Bvh, 1, ezRTTINoAllocator)
+EZ_END_DYNAMIC_REFLECTED_TYPE;
+// clang-format on
+
+ezSpatialSystem_Bvh::ezSpatialSystem_Bvh()
+  : m_AlignedAllocator("Spatial System Aligned", ezFoundation::GetAlignedAllocator())
+  , m_DataTable(&m_AlignedAllocator)
+  , m_AlwaysVisibleData(&m_Allocator)
+  , m_Nodes(&m_Allocator)
+  , m_FreeNodes(&m_Allocator)
+  , m_BuildItems(&m_AlignedAllocator)
+{
+}
+
+ezSpatialSystem_Bvh::~ezSpatialSystem_Bvh() = default;
+
+void ezSpatialSystem_Bvh::GetAllNodeBoxes(ezDynamicArray<ezBoundingBox>& out_boundingBoxes) const
+{
+  if (m_uiRootNode == ezInvalidIndex)
+    return;
+
+  ezHybridArray<ezUInt32, 64> stack;
+  stack.PushBack(m_uiRootNode);
+
+  while (!stack.IsEmpty())
+  {
+    const Node& node = m_Nodes[stack.PeekBack()];
+    stack.PopBack();
+
+    for (ezUInt32 i = 0; i < node.m_uiNumChildren; ++i)
+    {
+      if ((node.m_Children[i] & CHILD_IS_DATA) == 0)
+      {
+        const ezSimdBBox box = GetChildBox(node, i);
+        out_boundingBoxes.PushBack(ezBoundingBox::MakeFromMinMax(ezSimdConversion::ToVec3(box.m_Min), ezSimdConversion::ToVec3(box.m_Max)));
+
+        stack.PushBack(node.m_Children[i]);
+      }
+    }
+  }
+}
+
+void ezSpatialSystem_Bvh::StartNewFrame()
+{
+  SUPER::StartNewFrame();
+
+  const ezUInt32 uiNumDataInTree = m_DataTable.GetCount() - m_AlwaysVisibleData.GetCount();
+  const ezUInt32 uiThreshold = ezMath::Max(MIN_CHANGES_FOR_REBUILD, static_cast<ezUInt32>(uiNumDataInTree * cvar_SpatialBvhRebuildThreshold));
+
+  if (m_uiNumChangesSinceRebuild > uiThreshold)
+  {
+    Rebuild();
+  }
+}
+
+ezSpatialDataHandle ezSpatialSystem_Bvh::CreateSpatialData(const ezSimdBBoxSphere& bounds, ezGameObject* pObject, ezUInt32 uiCategoryBitmask, const ezTagSet& tags)
+{
+  if (uiCategoryBitmask == 0)
+    return ezSpatialDataHandle();
+
+  Data data;
+  data.m_Bounds = bounds;
+  data.m_Tags = tags;
+  data.m_pObject = pObject;
+  data.m_uiCategoryBitmask = uiCategoryBitmask;
+
+  const ezSpatialDataId id = m_DataTable.Insert(std::move(data));
+  InsertIntoTree(id.m_InstanceIndex, ComputeNodeBox(bounds, 0.0f));
+
+  ++m_uiNumChangesSinceRebuild;
+
+  return ezSpatialDataHandle(id);
+}
+
+ezSpatialDataHandle ezSpatialSystem_Bvh::CreateSpatialDataAlwaysVisible(ezGameObject* pObject, ezUInt32 uiCategoryBitmask, const ezTagSet& tags)
+{
+  if (uiCategoryBitmask == 0)
+    return ezSpatialDataHandle();
+
+  Data data;
+  data.m_Tags = tags;
+  data.m_pObject = pObject;
+  data.m_uiCategoryBitmask = uiCategoryBitmask;
+
+  const ezSpatialDataId id = m_DataTable.Insert(std::move(data));
+  m_AlwaysVisibleData.PushBack(id.m_InstanceIndex);
+
+  return ezSpatialDataHandle(id);
+}
+
+void ezSpatialSystem_Bvh::DeleteSpatialData(const ezSpatialDataHandle& hData)
+{
+  Data* pData = nullptr;
+  EZ_VERIFY(m_DataTable.TryGetValue(hData.GetInternalID(), pData), "Invalid spatial data handle");
+
+  const ezUInt32 uiDataIndex = hData.GetInternalID().m_InstanceIndex;
+  if (pData->m_uiNodeIndex != ezInvalidIndex)
+  {
+    RemoveFromTree(uiDataIndex);
+    ++m_uiNumChangesSinceRebuild;
+  }
+  else
+  {
+    m_AlwaysVisibleData.RemoveAndSwap(uiDataIndex);
+  }
+
+  m_DataTable.Remove(hData.GetInternalID());
+}
+
+void ezSpatialSystem_Bvh::UpdateSpatialDataBounds(const ezSpatialDataHandle& hData, const ezSimdBBoxSphere& bounds)
+{
+  Data* pData = nullptr;
+  EZ_VERIFY(m_DataTable.TryGetValue(hData.GetInternalID(), pData), "Invalid spatial data handle");
+
+  // No need to update bounds for always visible data
+  if (pData->m_uiNodeIndex == ezInvalidIndex)
+    return;
+
+  pData->m_Bounds = bounds;
+
+  const ezUInt32 uiNodeIndex = pData->m_uiNodeIndex;
+  const ezUInt32 uiSlot = pData->m_uiNodeSlot;
+  Node& node = m_Nodes[uiNodeIndex];
+
+  const ezSimdBSphere sphere = bounds.GetSphere();
+  node.m_SphereX[uiSlot] = sphere.m_CenterAndRadius.x();
+  node.m_SphereY[uiSlot] = sphere.m_CenterAndRadius.y();
+  node.m_SphereZ[uiSlot] = sphere.m_CenterAndRadius.z();
+  node.m_SphereR[uiSlot] = sphere.m_CenterAndRadius.w();
+
+  if (GetChildBox(node, uiSlot).Contains(ComputeNodeBox(bounds, 0.0f)))
+    return;
+
+  pData->m_bMoved = true;
+  SetChild(uiNodeIndex, uiSlot, node.m_Children[uiSlot], ComputeNodeBox(bounds, MOVING_DATA_MARGIN), sphere, node.m_CategoryBitmasks[uiSlot]);
+  Refit(uiNodeIndex);
+
+  ++m_uiNumChangesSinceRebuild;
+}
+
+void ezSpatialSystem_Bvh::UpdateSpatialDataObject(const ezSpatialDataHandle& hData, ezGameObject* pObject)
+{
+  Data* pData = nullptr;
+  EZ_VERIFY(m_DataTable.TryGetValue(hData.GetInternalID(), pData), "Invalid spatial data handle");
+
+  pData->m_pObject = pObject;
+}
+
+void ezSpatialSystem_Bvh::FindObjectsInSphere(const ezBoundingSphere& sphere, const QueryParams& queryParams, QueryCallback callback) const
+{
+  EZ_PROFILE_SCOPE("FindObjectsInSphere");
+
+  const ezSimdBSphere simdSphere(ezSimdConversion::ToVec3(sphere.m_vCenter), sphere.m_fRadius);
+
+  FindObjectsInShape(simdSphere, queryParams, callback, [&](const ChildBoxes& boxes) { return BoxesSphereIntersect(boxes, simdSphere); });
+}
+
+void ezSpatialSystem_Bvh::FindObjectsInBox(const ezBoundingBox& box, const QueryParams& queryParams, QueryCallback callback) const
+{
+  EZ_PROFILE_SCOPE("FindObjectsInBox");
+
+  const ezSimdBBox simdBox(ezSimdConversion::ToVec3(box.m_vMin), ezSimdConversion::ToVec3(box.m_vMax));
+
+  FindObjectsInShape(simdBox, queryParams, callback, [&](const ChildBoxes& boxes) { return BoxesBoxIntersect(boxes, simdBox); });
+}
+
+void ezSpatialSystem_Bvh::FindVisibleObjects(const ezFrustum& frustum, const QueryParams& queryParams, ezDynamicArray<const ezGameObject*>& out_Objects, ezSpatialSystem::IsOccludedFunc IsOccluded, ezVisibilityState visType, ezSpatialSystem::AreOccludedFunc AreOccluded) const
+{
+  EZ_PROFILE_SCOPE("FindVisibleObjects");
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  ezStopwatch timer;
+#endif
+
+  const FrustumPlanes planes(frustum);
+
+  const bool bUseOcclusion = IsOccluded.IsValid() || AreOccluded.IsValid();
+  const bool bBatchOcclusion = AreOccluded.IsValid();
+  const bool bUseTagsFilter = queryParams.m_pIncludeTags != nullptr || queryParams.m_pExcludeTags != nullptr;
+
+  const ezUInt64 uiFrameIdxAndType = (m_uiFrameCounter << 4) | static_cast<ezUInt64>(visType);
+
+  ezUInt32 uiNumObjectsTested = 0;
+  ezUInt32 uiNumObjectsPassed = 0;
+
+  auto AddVisible = [&](const Data& data) {
+    data.m_LastVisibleFrameIdxAndVisType.Max(uiFrameIdxAndType);
+    out_Objects.PushBack(data.m_pObject);
+
+    ++uiNumObjectsPassed;
+  };
+
+  // Collects the objects that passed the frustum test, so that they can be handed to the occlusion test in one go.
+  static constexpr ezUInt32 MaxBatchCount = 32;
+  ezSimdBBox batchBoxes[MaxBatchCount];
+  const Data* batchData[MaxBatchCount];
+  bool batchOccluded[MaxBatchCount];
+  ezUInt32 uiBatchCount = 0;
+
+  auto FlushOcclusionBatch = [&]() {
+    if (uiBatchCount == 0)
+      return;
+
+    AreOccluded(ezMakeArrayPtr(batchBoxes, uiBatchCount), ezMakeArrayPtr(batchOccluded, uiBatchCount));
+
+    for (ezUInt32 i = 0; i < uiBatchCount; ++i)
+    {
+      if (!batchOccluded[i])
+      {
+        AddVisible(*batchData[i]);
+      }
+    }
+
+    uiBatchCount = 0;
+  };
+
+  auto ChildTest = [&](const Node& node, ezUInt32 uiMask) {
+    uiMask &= BoxesFrustumIntersect(ChildBoxes(node), planes);
+    uiMask &= SpheresFrustumIntersect(ChildSpheres(node), planes);
+
+    if (!bUseOcclusion)
+      return uiMask;
+
+    // Occlusion test whole subtrees, data children are tested in the data callback
+    ezSimdBBox nodeBoxes[4];
+    bool nodeOccluded[4];
+    ezUInt32 nodeSlots[4];
+    ezUInt32 uiNumNodes = 0;
+
+    for (ezUInt32 uiNodeMask = uiMask; uiNodeMask != 0; uiNodeMask &= uiNodeMask - 1)
+    {
+      const ezUInt32 i = ezMath::FirstBitLow(uiNodeMask);
+      if ((node.m_Children[i] & CHILD_IS_DATA) == 0)
+      {
+        nodeBoxes[uiNumNodes] = GetChildBox(node, i);
+        nodeSlots[uiNumNodes] = i;
+        ++uiNumNodes;
+      }
+    }
+
+    if (uiNumNodes == 0)
+      return uiMask;
+
+    if (bBatchOcclusion)
+    {
+      AreOccluded(ezMakeArrayPtr(nodeBoxes, uiNumNodes), ezMakeArrayPtr(nodeOccluded, uiNumNodes));
+    }
+    else
+    {
+      for (ezUInt32 i = 0; i < uiNumNodes; ++i)
+      {
+        nodeOccluded[i] = IsOccluded(nodeBoxes[i]);
+      }
+    }
+
+    for (ezUInt32 i = 0; i < uiNumNodes; ++i)
+    {
+      if (nodeOccluded[i])
+      {
+        uiMask &= ~(1u << nodeSlots[i]);
+      }
+    }
+
+    return uiMask;
+  };
+
+  auto DataCallback = [&](const Data& data) {
+    ++uiNumObjectsTested;
+
+    if (bUseTagsFilter && FilterDataByTags(data.m_Tags, queryParams.m_pIncludeTags, queryParams.m_pExcludeTags))
+      return ezVisitorExecution::Continue;
+
+    if (bUseOcclusion)
+    {
+      const ezSimdBBox bbox = data.m_Bounds.GetBox();
+
+      if (bBatchOcclusion)
+      {
+        batchBoxes[uiBatchCount] = bbox;
+        batchData[uiBatchCount] = &data;
+        ++uiBatchCount;
+
+        if (uiBatchCount == MaxBatchCount)
+        {
+          FlushOcclusionBatch();
+        }
+
+        return ezVisitorExecution::Continue;
+      }
+
+      if (IsOccluded(bbox))
+        return ezVisitorExecution::Continue;
+    }
+
+    AddVisible(data);
+    return ezVisitorExecution::Continue;
+  };
+
+  Traverse(queryParams.m_uiCategoryBitmask, ChildTest, DataCallback);
+
+  FlushOcclusionBatch();
+
+  for (ezUInt32 uiDataIndex : m_AlwaysVisibleData)
+  {
+    const Data& data = m_DataTable.GetValueUnchecked(uiDataIndex);
+    if ((data.m_uiCategoryBitmask & queryParams.m_uiCategoryBitmask) == 0)
+      continue;
+
+    ++uiNumObjectsTested;
+
+    if (bUseTagsFilter && FilterDataByTags(data.m_Tags, queryParams.m_pIncludeTags, queryParams.m_pExcludeTags))
+      continue;
+
+    AddVisible(data);
+  }
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  if (queryParams.m_pStats != nullptr)
+  {
+    queryParams.m_pStats->m_uiTotalNumObjects = m_DataTable.GetCount();
+    queryParams.m_pStats->m_uiNumObjectsTested += uiNumObjectsTested;
+    queryParams.m_pStats->m_uiNumObjectsPassed += uiNumObjectsPassed;
+    queryParams.m_pStats->m_TimeTaken = timer.GetRunningTotal();
+  }
+#endif
+}
+
+ezVisibilityState ezSpatialSystem_Bvh::GetVisibilityState(const ezSpatialDataHandle& hData, ezUInt32 uiNumFramesBeforeInvisible) const
+{
+  Data* pData = nullptr;
+  EZ_VERIFY(m_DataTable.TryGetValue(hData.GetInternalID(), pData), "Invalid spatial data handle");
+
+  if (pData->m_uiNodeIndex == ezInvalidIndex)
+    return ezVisibilityState::Direct;
+
+  const ezUInt64 uiLastVisibleFrameIdxAndVisType = pData->m_LastVisibleFrameIdxAndVisType;
+  const ezUInt64 uiLastVisibleFrameIdx = (uiLastVisibleFrameIdxAndVisType >> 4);
+  const ezUInt64 uiLastVisibilityType = (uiLastVisibleFrameIdxAndVisType & static_cast<ezUInt64>(15)); // mask out lower 4 bits
+
+  if (m_uiFrameCounter > uiLastVisibleFrameIdx + uiNumFramesBeforeInvisible)
+    return ezVisibilityState::Invisible;
+
+  return static_cast<ezVisibilityState>(uiLastVisibilityType);
+}
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+void ezSpatialSystem_Bvh::GetInternalStats(ezStringBuilder& sb) const
+{
+  ezUInt32 uiNumNodes = 0;
+  ezUInt32 uiMaxDepth = 0;
+
+  if (m_uiRootNode != ezInvalidIndex)
+  {
+    ezHybridArray<ezUInt32, 64> stack;
+    ezHybridArray<ezUInt32, 64> depthStack;
+    stack.PushBack(m_uiRootNode);
+    depthStack.PushBack(1);
+
+    while (!stack.IsEmpty())
+    {
+      const Node& node = m_Nodes[stack.PeekBack()];
+      const ezUInt32 uiDepth = depthStack.PeekBack();
+      stack.PopBack();
+      depthStack.PopBack();
+
+      ++uiNumNodes;
+      uiMaxDepth = ezMath::Max(uiMaxDepth, uiDepth);
+
+      for (ezUInt32 i = 0; i < node.m_uiNumChildren; ++i)
+      {
+        if ((node.m_Children[i] & CHILD_IS_DATA) == 0)
+        {
+          stack.PushBack(node.m_Children[i]);
+          depthStack.PushBack(uiDepth + 1);
+        }
+      }
+    }
+  }
+
+  sb.SetFormat("Num Objects: {}\nNum Always Visible Objects: {}\nNum Nodes: {}\nMax Depth: {}\n", m_DataTable.GetCount(), m_AlwaysVisibleData.GetCount(), uiNumNodes, uiMaxDepth);
+  sb.AppendFormat("Num Rebuilds: {}\nChanges Since Last Rebuild: {}\n", m_uiNumRebuilds, m_uiNumChangesSinceRebuild);
+}
+#endif
+
+ezUInt32 ezSpatialSystem_Bvh::AllocateNode(ezUInt32 uiParent, ezUInt32 uiParentSlot)
+{
+  ezUInt32 uiNodeIndex = 0;
+  if (!m_FreeNodes.IsEmpty())
+  {
+    uiNodeIndex = m_FreeNodes.PeekBack();
+    m_FreeNodes.PopBack();
+  }
+  else
+  {
+    uiNodeIndex = m_Nodes.GetCount();
+    m_Nodes.ExpandAndGetRef();
+  }
+
+  Node& node = m_Nodes[uiNodeIndex];
+  ezMemoryUtils::ZeroFill(&node, 1);
+  node.m_uiParent = uiParent;
+  node.m_uiParentSlot = uiParentSlot;
+
+  return uiNodeIndex;
+}
+
+void ezSpatialSystem_Bvh::FreeNode(ezUInt32 uiNodeIndex)
+{
+  m_Nodes[uiNodeIndex].m_uiNumChildren = 0;
+  m_FreeNodes.PushBack(uiNodeIndex);
+}
+
+void ezSpatialSystem_Bvh::SetChild(ezUInt32 uiNodeIndex, ezUInt32 uiSlot, ezUInt32 uiChild, const ezSimdBBox& box, const ezSimdBSphere& sphere, ezUInt32 uiCategoryBitmask)
+{
+  Node& node = m_Nodes[uiNodeIndex];
+
+  node.m_MinX[uiSlot] = box.m_Min.x();
+  node.m_MinY[uiSlot] = box.m_Min.y();
+  node.m_MinZ[uiSlot] = box.m_Min.z();
+  node.m_MaxX[uiSlot] = box.m_Max.x();
+  node.m_MaxY[uiSlot] = box.m_Max.y();
+  node.m_MaxZ[uiSlot] = box.m_Max.z();
+
+  node.m_SphereX[uiSlot] = sphere.m_CenterAndRadius.x();
+  node.m_SphereY[uiSlot] = sphere.m_CenterAndRadius.y();
+  node.m_SphereZ[uiSlot] = sphere.m_CenterAndRadius.z();
+  node.m_SphereR[uiSlot] = sphere.m_CenterAndRadius.w();
+
+  node.m_Children[uiSlot] = uiChild;
+  node.m_CategoryBitmasks[uiSlot] = uiCategoryBitmask;
+
+  if (uiChild & CHILD_IS_DATA)
+  {
+    Data& data = m_DataTable.GetValueUnchecked(uiChild & ~CHILD_IS_DATA);
+    data.m_uiNodeIndex = uiNodeIndex;
+    data.m_uiNodeSlot = uiSlot;
+  }
+  else
+  {
+    Node& childNode = m_Nodes[uiChild];
+    childNode.m_uiParent = uiNodeIndex;
+    childNode.m_uiParentSlot = uiSlot;
+  }
+}
+
+void ezSpatialSystem_Bvh::MoveChild(ezUInt32 uiNodeIndex, ezUInt32 uiTargetSlot, ezUInt32 uiSourceSlot)
+{
+  const Node& node = m_Nodes[uiNodeIndex];
+  SetChild(uiNodeIndex, uiTargetSlot, node.m_Children[uiSourceSlot], GetChildBox(node, uiSourceSlot), GetChildSphere(node, uiSourceSlot), node.m_CategoryBitmasks[uiSourceSlot]);
+}
+
+void ezSpatialSystem_Bvh::RemoveChild(ezUInt32 uiNodeIndex, ezUInt32 uiSlot)
+{
+  Node& node = m_Nodes[uiNodeIndex];
+
+  const ezUInt32 uiLastSlot = node.m_uiNumChildren - 1;
+  if (uiSlot != uiLastSlot)
+  {
+    MoveChild(uiNodeIndex, uiSlot, uiLastSlot);
+  }
+
+  node.m_uiNumChildren = uiLastSlot;
+}
+
+void ezSpatialSystem_Bvh::Refit(ezUInt32 uiNodeIndex)
+{
+  while (true)
+  {
+    const Node& node = m_Nodes[uiNodeIndex];
+    if (node.m_uiParent == ezInvalidIndex)
+      return;
+
+    float fMin[3] = {ezMath::MaxValue<float>(), ezMath::MaxValue<float>(), ezMath::MaxValue<float>()};
+    float fMax[3] = {-ezMath::MaxValue<float>(), -ezMath::MaxValue<float>(), -ezMath::MaxValue<float>()};
+    ezUInt32 uiCategoryBitmask = 0;
+
+    for (ezUInt32 i = 0; i < node.m_uiNumChildren; ++i)
+    {
+      fMin[0] = ezMath::Min(fMin[0], node.m_MinX[i]);
+      fMin[1] = ezMath::Min(fMin[1], node.m_MinY[i]);
+      fMin[2] = ezMath::Min(fMin[2], node.m_MinZ[i]);
+      fMax[0] = ezMath::Max(fMax[0], node.m_MaxX[i]);
+      fMax[1] = ezMath::Max(fMax[1], node.m_MaxY[i]);
+      fMax[2] = ezMath::Max(fMax[2], node.m_MaxZ[i]);
+      uiCategoryBitmask |= node.m_CategoryBitmasks[i];
+    }
+
+    Node& parent = m_Nodes[node.m_uiParent];
+    const ezUInt32 uiSlot = node.m_uiParentSlot;
+
+    // stop as soon as nothing changes anymore, everything above is still valid then
+    if (parent.m_MinX[uiSlot] == fMin[0] && parent.m_MinY[uiSlot] == fMin[1] && parent.m_MinZ[uiSlot] == fMin[2] &&
+        parent.m_MaxX[uiSlot] == fMax[0] && parent.m_MaxY[uiSlot] == fMax[1] && parent.m_MaxZ[uiSlot] == fMax[2] &&
+        parent.m_CategoryBitmasks[uiSlot] == uiCategoryBitmask)
+      return;
+
+    parent.m_MinX[uiSlot] = fMin[0];
+    parent.m_MinY[uiSlot] = fMin[1];
+    parent.m_MinZ[uiSlot] = fMin[2];
+    parent.m_MaxX[uiSlot] = fMax[0];
+    parent.m_MaxY[uiSlot] = fMax[1];
+    parent.m_MaxZ[uiSlot] = fMax[2];
+    parent.m_CategoryBitmasks[uiSlot] = uiCategoryBitmask;
+
+    uiNodeIndex = node.m_uiParent;
+  }
+}
+
+void ezSpatialSystem_Bvh::InsertIntoTree(ezUInt32 uiDataIndex, const ezSimdBBox& box)
+{
+  const Data& data = m_DataTable.GetValueUnchecked(uiDataIndex);
+  const ezSimdBSphere sphere = data.m_Bounds.GetSphere();
+  const ezUInt32 uiCategoryBitmask = data.m_uiCategoryBitmask;
+
+  if (m_uiRootNode == ezInvalidIndex)
+  {
+    m_uiRootNode = AllocateNode(ezInvalidIndex, 0);
+  }
+
+  ezUInt32 uiNodeIndex = m_uiRootNode;
+  while (true)
+  {
+    Node& node = m_Nodes[uiNodeIndex];
+    if (node.m_uiNumChildren < 4)
+    {
+      SetChild(uiNodeIndex, node.m_uiNumChildren, uiDataIndex | CHILD_IS_DATA, box, sphere, uiCategoryBitmask);
+      ++node.m_uiNumChildren;
+      break;
+    }
+
+    // Descend into the child whose surface area grows the least
+    ezUInt32 uiBestSlot = 0;
+    {
+      const ChildBoxes boxes(node);
+      const ezSimdVec4f extentX = boxes.m_MaxX - boxes.m_MinX;
+      const ezSimdVec4f extentY = boxes.m_MaxY - boxes.m_MinY;
+      const ezSimdVec4f extentZ = boxes.m_MaxZ - boxes.m_MinZ;
+      const ezSimdVec4f area = ezSimdVec4f::MulAdd(extentX, extentY, ezSimdVec4f::MulAdd(extentY, extentZ, extentZ.CompMul(extentX)));
+
+      const ezSimdVec4f unionX = boxes.m_MaxX.CompMax(ezSimdVec4f(box.m_Max.x())) - boxes.m_MinX.CompMin(ezSimdVec4f(box.m_Min.x()));
+      const ezSimdVec4f unionY = boxes.m_MaxY.CompMax(ezSimdVec4f(box.m_Max.y())) - boxes.m_MinY.CompMin(ezSimdVec4f(box.m_Min.y()));
+      const ezSimdVec4f unionZ = boxes.m_MaxZ.CompMax(ezSimdVec4f(box.m_Max.z())) - boxes.m_MinZ.CompMin(ezSimdVec4f(box.m_Min.z()));
+      const ezSimdVec4f unionArea = ezSimdVec4f::MulAdd(unionX, unionY, ezSimdVec4f::MulAdd(unionY, unionZ, unionZ.CompMul(unionX)));
+
+      float fArea[4];
+      float fCost[4];
+      area.Store<4>(fArea);
+      (unionArea - area).Store<4>(fCost);
+
+      for (ezUInt32 i = 1; i < 4; ++i)
+      {
+        if (fCost[i] < fCost[uiBestSlot] || (fCost[i] == fCost[uiBestSlot] && fArea[i] < fArea[uiBestSlot]))
+          uiBestSlot = i;
+      }
+    }
+
+    const ezUInt32 uiChild = node.m_Children[uiBestSlot];
+    if ((uiChild & CHILD_IS_DATA) == 0)
+    {
+      uiNodeIndex = uiChild;
+      continue;
+    }
+
+    // Pair the data up with the best fitting data child in a new node
+    const ezSimdBBox childBox = GetChildBox(node, uiBestSlot);
+    const ezSimdBSphere childSphere = GetChildSphere(node, uiBestSlot);
+    const ezUInt32 uiChildCategoryBitmask = node.m_CategoryBitmasks[uiBestSlot];
+
+    const ezUInt32 uiNewNodeIndex = AllocateNode(uiNodeIndex, uiBestSlot);
+    SetChild(uiNewNodeIndex, 0, uiChild, childBox, childSphere, uiChildCategoryBitmask);
+    SetChild(uiNewNodeIndex, 1, uiDataIndex | CHILD_IS_DATA, box, sphere, uiCategoryBitmask);
+    m_Nodes[uiNewNodeIndex].m_uiNumChildren = 2;
+
+    ezSimdBBox unionBox = childBox;
+    unionBox.ExpandToInclude(box);
+    SetChild(uiNodeIndex, uiBestSlot, uiNewNodeIndex, unionBox, GetInfiniteSphere(), uiChildCategoryBitmask | uiCategoryBitmask);
+    break;
+  }
+
+  Refit(uiNodeIndex);
+}
+
+void ezSpatialSystem_Bvh::RemoveFromTree(ezUInt32 uiDataIndex)
+{
+  Data& data = m_DataTable.GetValueUnchecked(uiDataIndex);
+  ezUInt32 uiNodeIndex = data.m_uiNodeIndex;
+
+  RemoveChild(uiNodeIndex, data.m_uiNodeSlot);
+
+  while (true)
+  {
+    Node& node = m_Nodes[uiNodeIndex];
+    const ezUInt32 uiParent = node.m_uiParent;
+    const ezUInt32 uiParentSlot = node.m_uiParentSlot;
+
+    if (uiParent == ezInvalidIndex)
+    {
+      if (node.m_uiNumChildren == 0)
+      {
+        FreeNode(uiNodeIndex);
+        m_uiRootNode = ezInvalidIndex;
+      }
+      else if (node.m_uiNumChildren == 1 && (node.m_Children[0] & CHILD_IS_DATA) == 0)
+      {
+        // the only child node becomes the new root
+        m_uiRootNode = node.m_Children[0];
+        m_Nodes[m_uiRootNode].m_uiParent = ezInvalidIndex;
+        FreeNode(uiNodeIndex);
+      }
+
+      return;
+    }
+
+    if (node.m_uiNumChildren == 0)
+    {
+      FreeNode(uiNodeIndex);
+      RemoveChild(uiParent, uiParentSlot);
+      uiNodeIndex = uiParent;
+      continue;
+    }
+
+    if (node.m_uiNumChildren == 1)
+    {
+      // collapse the node, its only child takes its place in the parent
+      SetChild(uiParent, uiParentSlot, node.m_Children[0], GetChildBox(node, 0), GetChildSphere(node, 0), node.m_CategoryBitmasks[0]);
+      FreeNode(uiNodeIndex);
+      Refit(uiParent);
+      return;
+    }
+
+    Refit(uiNodeIndex);
+    return;
+  }
+}
+
+void ezSpatialSystem_Bvh::Rebuild()
+{
+  EZ_PROFILE_SCOPE("Rebuild BVH");
+
+  m_Nodes.Clear();
+  m_FreeNodes.Clear();
+  m_uiRootNode = ezInvalidIndex;
+
+  m_BuildItems.Clear();
+  m_BuildItems.Reserve(m_DataTable.GetCount());
+
+  for (auto it = m_DataTable.GetIterator(); it.IsValid(); ++it)
+  {
+    const Data& data = it.Value();
+    if (data.m_uiNodeIndex == ezInvalidIndex)
+      continue;
+
+    BuildItem& item = m_BuildItems.ExpandAndGetRef();
+    item.m_Box = ComputeNodeBox(data.m_Bounds, data.m_bMoved ? MOVING_DATA_MARGIN : 0.0f);
+    item.m_fCenter[0] = data.m_Bounds.m_CenterAndRadius.x();
+    item.m_fCenter[1] = data.m_Bounds.m_CenterAndRadius.y();
+    item.m_fCenter[2] = data.m_Bounds.m_CenterAndRadius.z();
+    item.m_uiDataIndex = it.Id().m_InstanceIndex;
+  }
+
+  m_uiNumChangesSinceRebuild = 0;
+  ++m_uiNumRebuilds;
+
+  if (m_BuildItems.IsEmpty())
+    return;
+
+  m_Nodes.Reserve(m_BuildItems.GetCount() / 2 + 1);
+
+  m_uiRootNode = AllocateNode(ezInvalidIndex, 0);
+  BuildNode(m_uiRootNode, m_BuildItems.GetArrayPtr());
+}
+
+void ezSpatialSystem_Bvh::BuildNode(ezUInt32 uiNodeIndex, ezArrayPtr<BuildItem> items)
+{
+  ezArrayPtr<BuildItem> groups[4];
+  ezUInt32 uiNumGroups = 0;
+
+  if (items.GetCount() <= 4)
+  {
+    for (ezUInt32 i = 0; i < items.GetCount(); ++i)
+    {
+      groups[uiNumGroups++] = items.GetSubArray(i, 1);
+    }
+  }
+  else
+  {
+    // two levels of binary splits give the four children of this node
+    const ezUInt32 uiSplit = SplitItems(items);
+    ezArrayPtr<BuildItem> halves[2] = {items.GetSubArray(0, uiSplit), items.GetSubArray(uiSplit)};
+
+    for (ezArrayPtr<BuildItem> half : halves)
+    {
+      if (half.GetCount() == 1)
+      {
+        groups[uiNumGroups++] = half;
+      }
+      else
+      {
+        const ezUInt32 uiHalfSplit = SplitItems(half);
+        groups[uiNumGroups++] = half.GetSubArray(0, uiHalfSplit);
+        groups[uiNumGroups++] = half.GetSubArray(uiHalfSplit);
+      }
+    }
+  }
+
+  m_Nodes[uiNodeIndex].m_uiNumChildren = uiNumGroups;
+
+  for (ezUInt32 g = 0; g < uiNumGroups; ++g)
+  {
+    const ezArrayPtr<BuildItem> group = groups[g];
+
+    if (group.GetCount() == 1)
+    {
+      const BuildItem& item = group[0];
+      const Data& data = m_DataTable.GetValueUnchecked(item.m_uiDataIndex);
+
+      SetChild(uiNodeIndex, g, item.m_uiDataIndex | CHILD_IS_DATA, item.m_Box, data.m_Bounds.GetSphere(), data.m_uiCategoryBitmask);
+      continue;
+    }
+
+    ezSimdBBox groupBox = ezSimdBBox::MakeInvalid();
+    ezUInt32 uiGroupCategoryBitmask = 0;
+    for (const BuildItem& item : group)
+    {
+      groupBox.ExpandToInclude(item.m_Box);
+      uiGroupCategoryBitmask |= m_DataTable.GetValueUnchecked(item.m_uiDataIndex).m_uiCategoryBitmask;
+    }
+
+    const ezUInt32 uiChildNodeIndex = AllocateNode(uiNodeIndex, g);
+    SetChild(uiNodeIndex, g, uiChildNodeIndex, groupBox, GetInfiniteSphere(), uiGroupCategoryBitmask);
+    BuildNode(uiChildNodeIndex, group);
+  }
+}
+
+
+EZ_STATICLINK_FILE(Core, Core_World_Implementation_SpatialSystem_Bvh);
@@ -4,9 +4,11 @@
 #include <Foundation/Configuration/CVar.h>
 #include <Foundation/Profiling/Profiling.h>
 #include <Foundation/SimdMath/SimdConversion.h>
+#include <Foundation/Threading/TaskSystem.h>
 #include <Foundation/Time/Stopwatch.h>
 
 ezCVarInt cvar_SpatialQueriesCachingThreshold("Spatial.Queries.CachingThreshold", 100, ezCVarFlags::Default, "Number of objects that are tested for a query before it is considered for caching");
+ezCVarBool cvar_SpatialCullingMultithreaded("Spatial.Culling.Multithreaded", true, ezCVarFlags::Default, "Frustum cull the cells of the regular grid on multiple threads");
 
 struct PlaneData
 {
@@ -26,7 +28,10 @@ namespace
   enum
   {
     MAX_CELL_INDEX = (1 << 20) - 1,
-    CELL_INDEX_MASK = (1 << 21) - 1
+    CELL_INDEX_MASK = (1 << 21) - 1,
+
+    // fewer objects are culled faster on one thread than it takes to distribute them
+    MIN_OBJECTS_PER_CULLING_CHUNK = 1024
   };
 
   EZ_ALWAYS_INLINE ezSimdVec4f ToVec3(const ezSimdVec4i& v)
@@ -173,6 +178,69 @@ namespace
 
     return result;
   }
+
+  /// Returns a bitmask of the spheres in the given range that intersect the frustum.
+  EZ_FORCE_INLINE ezUInt32 SpheresFrustumIntersect(const ezSimdBSphere* pSpheres, ezUInt32 uiNumSpheres, const PlaneData& planeData)
+  {
+    ezUInt32 mask = 0;
+
+    ezUInt32 i = 0;
+    for (; i + 1 < uiNumSpheres; i += 2)
+    {
+      mask |= SphereFrustumIntersect(pSpheres[i], pSpheres[i + 1], planeData) << i;
+    }
+
+    if (i < uiNumSpheres && SphereFrustumIntersect(pSpheres[i], planeData))
+    {
+      mask |= EZ_BIT(i);
+    }
+
+    return mask;
+  }
+
+  PlaneData ComputePlaneData(const ezFrustum& frustum)
+  {
+    PlaneData planeData;
+
+    // Compiler is too stupid to properly unroll a constant loop so we do it by hand
+    ezSimdVec4f plane0 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(0).m_vNormal.x)));
+    ezSimdVec4f plane1 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(1).m_vNormal.x)));
+    ezSimdVec4f plane2 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(2).m_vNormal.x)));
+    ezSimdVec4f plane3 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(3).m_vNormal.x)));
+    ezSimdVec4f plane4 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(4).m_vNormal.x)));
+    ezSimdVec4f plane5 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(5).m_vNormal.x)));
+
+    ezSimdMat4f helperMat;
+    helperMat.SetRows(plane0, plane1, plane2, plane3);
+
+    planeData.m_x0x1x2x3 = helperMat.m_col0;
+    planeData.m_y0y1y2y3 = helperMat.m_col1;
+    planeData.m_z0z1z2z3 = helperMat.m_col2;
+    planeData.m_w0w1w2w3 = helperMat.m_col3;
+
+    helperMat.SetRows(plane4, plane5, plane4, plane5);
+
+    planeData.m_x4x5x4x5 = helperMat.m_col0;
+    planeData.m_y4y5y4y5 = helperMat.m_col1;
+    planeData.m_z4z5z4z5 = helperMat.m_col2;
+    planeData.m_w4w5w4w5 = helperMat.m_col3;
+
+    return planeData;
+  }
+
+  ezSimdBBox ComputeFrustumBox(const ezFrustum& frustum)
+  {
+    ezVec3 cornerPoints[8];
+    frustum.ComputeCornerPoints(cornerPoints).AssertSuccess();
+
+    ezSimdVec4f simdCornerPoints[8];
+    for (ezUInt32 i = 0; i < 8; ++i)
+    {
+      simdCornerPoints[i] = ezSimdConversion::ToVec3(cornerPoints[i]);
+    }
+
+    return ezSimdBBox::MakeFromPoints(simdCornerPoints, 8);
+  }
 } // namespace
 
 //////////////////////////////////////////////////////////////////////////
@@ -487,8 +555,39 @@ namespace ezInternal
       ezDynamicArray<const ezGameObject*>* m_pOutObjects;
       ezUInt64 m_uiFrameCounter;
       ezSpatialSystem::IsOccludedFunc m_IsOccludedCB;
+      ezSpatialSystem::AreOccludedFunc m_AreOccludedCB;
     };
 
+    /// Collects the objects that passed the frustum test, so that they can be handed to the occlusion test in one go.
+    struct OcclusionBatch
+    {
+      static constexpr ezUInt32 MaxCount = 32;
+
+      ezSimdBBox m_Boxes[MaxCount];
+      ezUInt32 m_uiIndices[MaxCount];
+      bool m_Occluded[MaxCount];
+      ezUInt32 m_uiCount = 0;
+    };
+
+    template <typename AddVisibleFunc>
+    EZ_FORCE_INLINE static void FlushOcclusionBatch(OcclusionBatch& ref_batch, const FrustumQueryData* pQueryData, AddVisibleFunc addVisible)
+    {
+      if (ref_batch.m_uiCount == 0)
+        return;
+
+      pQueryData->m_AreOccludedCB(ezMakeArrayPtr(ref_batch.m_Boxes, ref_batch.m_uiCount), ezMakeArrayPtr(ref_batch.m_Occluded, ref_batch.m_uiCount));
+
+      for (ezUInt32 j = 0; j < ref_batch.m_uiCount; ++j)
+      {
+        if (!ref_batch.m_Occluded[j])
+        {
+          addVisible(ref_batch.m_uiIndices[j]);
+        }
+      }
+
+      ref_batch.m_uiCount = 0;
+    }
+
     template <bool UseTagsFilter, bool UseOcclusionCallback>
     static ezVisitorExecution::Enum FrustumQueryCallback(const ezSpatialSystem_RegularGrid::Cell& cell, const ezSpatialSystem::QueryParams& queryParams, ezSpatialSystem_RegularGrid::Stats& ref_stats, void* pUserData, ezVisibilityState visType)
     {
@@ -499,9 +598,22 @@ namespace ezInternal
       if (!SphereFrustumIntersect(cellSphere, planeData))
         return ezVisitorExecution::Continue;
 
+      const bool bBatchOcclusion = UseOcclusionCallback && pQueryData->m_AreOccludedCB.IsValid();
+
       if constexpr (UseOcclusionCallback)
       {
-        if (pQueryData->m_IsOccludedCB(cell.m_Bounds.GetBox()))
+        bool bCellOccluded = false;
+        if (bBatchOcclusion)
+        {
+          const ezSimdBBox cellBox = cell.m_Bounds.GetBox();
+          pQueryData->m_AreOccludedCB(ezMakeArrayPtr(&cellBox, 1), ezMakeArrayPtr(&bCellOccluded, 1));
+        }
+        else
+        {
+          bCellOccluded = pQueryData->m_IsOccludedCB(cell.m_Bounds.GetBox());
+        }
+
+        if (bCellOccluded)
         {
           return ezVisitorExecution::Continue;
         }
@@ -519,6 +631,15 @@ namespace ezInternal
       ezUInt32 currentIndex = 0;
       const ezUInt64 uiFrameIdxAndType = (pQueryData->m_uiFrameCounter << 4) | static_cast<ezUInt64>(visType);
 
+      auto AddVisible = [&](ezUInt32 i) {
+        lastVisibleFrameIdxAndVisType[i].Max(uiFrameIdxAndType);
+        pQueryData->m_pOutObjects->PushBack(objectPointers[i]);
+
+        ref_stats.m_uiNumObjectsPassed++;
+      };
+
+      OcclusionBatch batch;
+
       while (currentIndex < numSpheres)
       {
         if (numSpheres - currentIndex >= 32)
@@ -550,16 +671,30 @@ namespace ezInternal
             if constexpr (UseOcclusionCallback)
             {
               const ezSimdBBox bbox = ezSimdBBox::MakeFromCenterAndHalfExtents(boundingSpheres[i].GetCenter(), boundingBoxHalfExtents[i]);
+
+              if (bBatchOcclusion)
+              {
+                batch.m_Boxes[batch.m_uiCount] = bbox;
+                batch.m_uiIndices[batch.m_uiCount] = i;
+                ++batch.m_uiCount;
+                continue;
+              }
+
               if (pQueryData->m_IsOccludedCB(bbox))
               {
                 continue;
               }
             }
 
-            lastVisibleFrameIdxAndVisType[i].Max(uiFrameIdxAndType);
-            pQueryData->m_pOutObjects->PushBack(objectPointers[i]);
+            AddVisible(i);
+          }
 
-            ref_stats.m_uiNumObjectsPassed++;
+          if constexpr (UseOcclusionCallback)
+          {
+            if (bBatchOcclusion)
+            {
+              FlushOcclusionBatch(batch, pQueryData, AddVisible);
+            }
           }
 
           currentIndex += 32;
@@ -585,16 +720,135 @@ namespace ezInternal
           {
             const ezSimdBBox bbox = ezSimdBBox::MakeFromCenterAndHalfExtents(boundingSpheres[i].GetCenter(), boundingBoxHalfExtents[i]);
 
+            if (bBatchOcclusion)
+            {
+              // the remaining objects are fewer than a full batch, so they all fit
+              batch.m_Boxes[batch.m_uiCount] = bbox;
+              batch.m_uiIndices[batch.m_uiCount] = i;
+              ++batch.m_uiCount;
+              continue;
+            }
+
             if (pQueryData->m_IsOccludedCB(bbox))
             {
               continue;
             }
           }
 
-          lastVisibleFrameIdxAndVisType[i].Max(uiFrameIdxAndType);
-          pQueryData->m_pOutObjects->PushBack(objectPointers[i]);
+          AddVisible(i);
+        }
+      }
+
+      if constexpr (UseOcclusionCallback)
+      {
+        if (bBatchOcclusion)
+        {
+          FlushOcclusionBatch(batch, pQueryData, AddVisible);
+        }
+      }
+
+      return ezVisitorExecution::Continue;
+    }
+
+    struct MultiViewQueryData
+    {
+      ezArrayPtr<const PlaneData> m_PlaneData;
+      ezArrayPtr<ezDynamicArray<const ezGameObject*>* const> m_OutObjects;
+      ezUInt64 m_uiFrameCounter;
+    };
+
+    template <bool UseTagsFilter>
+    static ezVisitorExecution::Enum MultiViewFrustumQueryCallback(const ezSpatialSystem_RegularGrid::Cell& cell, const ezSpatialSystem::QueryParams& queryParams, ezSpatialSystem_RegularGrid::Stats& ref_stats, void* pUserData, ezVisibilityState visType)
+    {
+      auto pQueryData = static_cast<const MultiViewQueryData*>(pUserData);
+      const ezUInt32 uiNumViews = pQueryData->m_PlaneData.GetCount();
+
+      const ezSimdBSphere cellSphere = cell.m_Bounds.GetSphere();
+
+      ezUInt32 uiCellViewMask = 0;
+      for (ezUInt32 uiView = 0; uiView < uiNumViews; ++uiView)
+      {
+        if (SphereFrustumIntersect(cellSphere, pQueryData->m_PlaneData[uiView]))
+        {
+          uiCellViewMask |= EZ_BIT(uiView);
+        }
+      }
+
+      if (uiCellViewMask == 0)
+        return ezVisitorExecution::Continue;
+
+      auto boundingSpheres = cell.m_BoundingSpheres.GetData();
+      auto tagSets = cell.m_TagSets.GetData();
+      auto objectPointers = cell.m_ObjectPointers.GetData();
+      auto lastVisibleFrameIdxAndVisType = cell.m_LastVisibleFrameIdxAndVisType.GetData();
+
+      const ezUInt32 numSpheres = cell.m_BoundingSpheres.GetCount();
+      ref_stats.m_uiNumObjectsTested += numSpheres;
+
+      const ezUInt64 uiFrameIdxAndType = (pQueryData->m_uiFrameCounter << 4) | static_cast<ezUInt64>(visType);
+
+      ezUInt32 objectMasks[ezSpatialSystem_RegularGrid::MAX_NUM_VIEWS_PER_PASS];
+
+      // test blocks of 32 objects against all views, so that the bounds are still in the cache for the next view
+      for (ezUInt32 uiBlockStart = 0; uiBlockStart < numSpheres; uiBlockStart += 32)
+      {
+        const ezUInt32 uiBlockSize = ezMath::Min(numSpheres - uiBlockStart, 32u);
+        ezUInt32 uiVisibleMask = 0;
+
+        ezUInt32 uiViewMask = uiCellViewMask;
+        while (uiViewMask > 0)
+        {
+          const ezUInt32 uiView = ezMath::FirstBitLow(uiViewMask);
+          uiViewMask &= uiViewMask - 1;
+
+          objectMasks[uiView] = SpheresFrustumIntersect(boundingSpheres + uiBlockStart, uiBlockSize, pQueryData->m_PlaneData[uiView]);
+          uiVisibleMask |= objectMasks[uiView];
+        }
+
+        if constexpr (UseTagsFilter)
+        {
+          ezUInt32 uiMask = uiVisibleMask;
+          while (uiMask > 0)
+          {
+            const ezUInt32 i = ezMath::FirstBitLow(uiMask);
+            uiMask &= uiMask - 1;
+
+            if (FilterByTags(tagSets[uiBlockStart + i], queryParams.m_pIncludeTags, queryParams.m_pExcludeTags))
+            {
+              uiVisibleMask &= ~EZ_BIT(i);
+              ref_stats.m_uiNumObjectsFiltered++;
+            }
+          }
+        }
+
+        {
+          ezUInt32 uiMask = uiVisibleMask;
+          while (uiMask > 0)
+          {
+            const ezUInt32 i = ezMath::FirstBitLow(uiMask);
+            uiMask &= uiMask - 1;
+
+            lastVisibleFrameIdxAndVisType[uiBlockStart + i].Max(uiFrameIdxAndType);
+          }
+        }
+
+        uiViewMask = uiCellViewMask;
+        while (uiViewMask > 0)
+        {
+          const ezUInt32 uiView = ezMath::FirstBitLow(uiViewMask);
+          uiViewMask &= uiViewMask - 1;
+
+          auto& outObjects = *pQueryData->m_OutObjects[uiView];
 
-          ref_stats.m_uiNumObjectsPassed++;
+          ezUInt32 uiMask = objectMasks[uiView] & uiVisibleMask;
+          while (uiMask > 0)
+          {
+            const ezUInt32 i = ezMath::FirstBitLow(uiMask);
+            uiMask &= uiMask - 1;
+
+            outObjects.PushBack(objectPointers[uiBlockStart + i]);
+            ref_stats.m_uiNumObjectsPassed++;
+          }
         }
       }
 
@@ -694,6 +948,15 @@ void ezSpatialSystem_RegularGrid::StartNewFrame()
 {
   SUPER::StartNewFrame();
 
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  {
+    EZ_LOCK(m_CullingStatsMutex);
+
+    m_LastFrameCullingStats.Swap(m_CullingStats);
+    m_CullingStats.Clear();
+  }
+#endif
+
   m_SortedCacheCandidates.Clear();
 
   {
@@ -836,7 +1099,7 @@ void ezSpatialSystem_RegularGrid::FindObjectsInBox(const ezBoundingBox& box, con
     &queryData, ezVisibilityState::Indirect);
 }
 
-void ezSpatialSystem_RegularGrid::FindVisibleObjects(const ezFrustum& frustum, const QueryParams& queryParams, ezDynamicArray<const ezGameObject*>& out_Objects, ezSpatialSystem::IsOccludedFunc IsOccluded, ezVisibilityState visType) const
+void ezSpatialSystem_RegularGrid::FindVisibleObjects(const ezFrustum& frustum, const QueryParams& queryParams, ezDynamicArray<const ezGameObject*>& out_Objects, ezSpatialSystem::IsOccludedFunc IsOccluded, ezVisibilityState visType, ezSpatialSystem::AreOccludedFunc AreOccluded) const
 {
   EZ_PROFILE_SCOPE("FindVisibleObjects");
 
@@ -844,67 +1107,151 @@ void ezSpatialSystem_RegularGrid::FindVisibleObjects(const ezFrustum& frustum, c
   ezStopwatch timer;
 #endif
 
-  ezVec3 cornerPoints[8];
-  frustum.ComputeCornerPoints(cornerPoints).AssertSuccess();
+  const ezSimdBBox simdBox = ComputeFrustumBox(frustum);
+
+  ezInternal::QueryHelper::FrustumQueryData queryData;
+  queryData.m_PlaneData = ComputePlaneData(frustum);
+  queryData.m_pOutObjects = &out_Objects;
+  queryData.m_uiFrameCounter = m_uiFrameCounter;
+  queryData.m_IsOccludedCB = IsOccluded;
+  queryData.m_AreOccludedCB = AreOccluded;
+
+  const bool bUseOcclusion = IsOccluded.IsValid() || AreOccluded.IsValid();
+  CellCallback noFilterCallback = bUseOcclusion ? &ezInternal::QueryHelper::FrustumQueryCallback<false, true> : &ezInternal::QueryHelper::FrustumQueryCallback<false, false>;
+  CellCallback filterByTagsCallback = bUseOcclusion ? &ezInternal::QueryHelper::FrustumQueryCallback<true, true> : &ezInternal::QueryHelper::FrustumQueryCallback<true, false>;
+
+  ezUInt32 uiNumChunks = 1;
+  Stats totalStats;
+
+  if (cvar_SpatialCullingMultithreaded)
+  {
+    ForEachMatchingGrid(queryParams, noFilterCallback, filterByTagsCallback,
+      [&](const Grid& grid, CellCallback cellCallback, Stats& ref_stats) {
+        uiNumChunks = ezMath::Max(uiNumChunks, CullCellsInGrid(grid, simdBox, cellCallback, queryParams, ref_stats, &queryData, visType));
 
-  ezSimdVec4f simdCornerPoints[8];
-  for (ezUInt32 i = 0; i < 8; ++i)
+        totalStats.m_uiNumObjectsTested += ref_stats.m_uiNumObjectsTested;
+        totalStats.m_uiNumObjectsPassed += ref_stats.m_uiNumObjectsPassed;
+      });
+  }
+  else
   {
-    simdCornerPoints[i] = ezSimdConversion::ToVec3(cornerPoints[i]);
+    ForEachMatchingGrid(queryParams, noFilterCallback, filterByTagsCallback,
+      [&](const Grid& grid, CellCallback cellCallback, Stats& ref_stats) {
+        grid.ForEachCellInBox(simdBox,
+          [&](const Cell& cell) {
+            return cellCallback(cell, queryParams, ref_stats, &queryData, visType);
+          });
+
+        totalStats.m_uiNumObjectsTested += ref_stats.m_uiNumObjectsTested;
+        totalStats.m_uiNumObjectsPassed += ref_stats.m_uiNumObjectsPassed;
+      });
   }
 
-  const ezSimdBBox simdBox = ezSimdBBox::MakeFromPoints(simdCornerPoints, 8);
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  const ezTime timeTaken = timer.GetRunningTotal();
 
-  ezInternal::QueryHelper::FrustumQueryData queryData;
+  if (queryParams.m_pStats != nullptr)
   {
-    // Compiler is too stupid to properly unroll a constant loop so we do it by hand
-    ezSimdVec4f plane0 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(0).m_vNormal.x)));
-    ezSimdVec4f plane1 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(1).m_vNormal.x)));
-    ezSimdVec4f plane2 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(2).m_vNormal.x)));
-    ezSimdVec4f plane3 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(3).m_vNormal.x)));
-    ezSimdVec4f plane4 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(4).m_vNormal.x)));
-    ezSimdVec4f plane5 = ezSimdConversion::ToVec4(*reinterpret_cast<const ezVec4*>(&(frustum.GetPlane(5).m_vNormal.x)));
+    queryParams.m_pStats->m_TimeTaken = timeTaken;
+  }
 
-    ezSimdMat4f helperMat;
-    helperMat.SetRows(plane0, plane1, plane2, plane3);
+  {
+    EZ_LOCK(m_CullingStatsMutex);
+
+    auto& cullingStats = m_CullingStats.ExpandAndGetRef();
+    cullingStats.m_TimeTaken = timeTaken;
+    cullingStats.m_uiNumObjectsTested = totalStats.m_uiNumObjectsTested;
+    cullingStats.m_uiNumObjectsPassed = totalStats.m_uiNumObjectsPassed;
+    cullingStats.m_uiNumChunks = uiNumChunks;
+    cullingStats.m_VisType = visType;
+  }
+#endif
+}
 
-    queryData.m_PlaneData.m_x0x1x2x3 = helperMat.m_col0;
-    queryData.m_PlaneData.m_y0y1y2y3 = helperMat.m_col1;
-    queryData.m_PlaneData.m_z0z1z2z3 = helperMat.m_col2;
-    queryData.m_PlaneData.m_w0w1w2w3 = helperMat.m_col3;
+void ezSpatialSystem_RegularGrid::FindVisibleObjectsMultiView(ezArrayPtr<const ezFrustum> frustums, const QueryParams& queryParams, ezArrayPtr<ezDynamicArray<const ezGameObject*>* const> out_Objects, ezVisibilityState visType) const
+{
+  EZ_ASSERT_DEV(frustums.GetCount() == out_Objects.GetCount(), "Need exactly one output array per frustum");
 
-    helperMat.SetRows(plane4, plane5, plane4, plane5);
+  if (frustums.GetCount() > MAX_NUM_VIEWS_PER_PASS)
+  {
+    for (ezUInt32 i = 0; i < frustums.GetCount(); i += MAX_NUM_VIEWS_PER_PASS)
+    {
+      const ezUInt32 uiCount = ezMath::Min<ezUInt32>(frustums.GetCount() - i, MAX_NUM_VIEWS_PER_PASS);
+      FindVisibleObjectsMultiView(frustums.GetSubArray(i, uiCount), queryParams, out_Objects.GetSubArray(i, uiCount), visType);
+    }
+    return;
+  }
 
-    queryData.m_PlaneData.m_x4x5x4x5 = helperMat.m_col0;
-    queryData.m_PlaneData.m_y4y5y4y5 = helperMat.m_col1;
-    queryData.m_PlaneData.m_z4z5z4z5 = helperMat.m_col2;
-    queryData.m_PlaneData.m_w4w5w4w5 = helperMat.m_col3;
+  EZ_PROFILE_SCOPE("FindVisibleObjectsMultiView");
 
-    queryData.m_pOutObjects = &out_Objects;
-    queryData.m_uiFrameCounter = m_uiFrameCounter;
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  ezStopwatch timer;
+#endif
 
-    queryData.m_IsOccludedCB = IsOccluded;
-  }
+  auto GetNumCellsInBox = [&](const ezSimdBBox& box) {
+    ezSimdVec4i minIndex = ToVec3I32((box.m_Min - m_vOverlapSize) * m_fInvCellSize);
+    ezSimdVec4i maxIndex = ToVec3I32((box.m_Max + m_vOverlapSize) * m_fInvCellSize);
+    ezSimdVec4f diff = ToVec3(maxIndex - minIndex + ezSimdVec4i(1));
+    return double(diff.x()) * double(diff.y()) * double(diff.z());
+  };
 
-  if (IsOccluded.IsValid())
+  ezHybridArray<PlaneData, MAX_NUM_VIEWS_PER_PASS> planeData;
+  ezSimdBBox unionBox = ezSimdBBox::MakeInvalid();
+  double fNumCellsInViewBoxes = 0.0;
+
+  for (const ezFrustum& frustum : frustums)
   {
-    ForEachCellInBoxInMatchingGrids(simdBox, queryParams,
-      &ezInternal::QueryHelper::FrustumQueryCallback<false, true>,
-      &ezInternal::QueryHelper::FrustumQueryCallback<true, true>,
-      &queryData, visType);
+    const ezSimdBBox frustumBox = ComputeFrustumBox(frustum);
+    unionBox.ExpandToInclude(frustumBox);
+    fNumCellsInViewBoxes += GetNumCellsInBox(frustumBox);
+
+    planeData.PushBack(ComputePlaneData(frustum));
   }
-  else
+
+  // views that are far apart would make us look up a lot of cells in between that no view can see
+  if (GetNumCellsInBox(unionBox) > fNumCellsInViewBoxes * 2.0)
   {
-    ForEachCellInBoxInMatchingGrids(simdBox, queryParams,
-      &ezInternal::QueryHelper::FrustumQueryCallback<false, false>,
-      &ezInternal::QueryHelper::FrustumQueryCallback<true, false>,
-      &queryData, visType);
+    SUPER::FindVisibleObjectsMultiView(frustums, queryParams, out_Objects, visType);
+    return;
   }
 
+  ezInternal::QueryHelper::MultiViewQueryData queryData;
+  queryData.m_PlaneData = planeData;
+  queryData.m_OutObjects = out_Objects;
+  queryData.m_uiFrameCounter = m_uiFrameCounter;
+
+  Stats totalStats;
+
+  ForEachMatchingGrid(queryParams,
+    &ezInternal::QueryHelper::MultiViewFrustumQueryCallback<false>,
+    &ezInternal::QueryHelper::MultiViewFrustumQueryCallback<true>,
+    [&](const Grid& grid, CellCallback cellCallback, Stats& ref_stats) {
+      grid.ForEachCellInBox(unionBox,
+        [&](const Cell& cell) {
+          return cellCallback(cell, queryParams, ref_stats, &queryData, visType);
+        });
+
+      totalStats.m_uiNumObjectsTested += ref_stats.m_uiNumObjectsTested;
+      totalStats.m_uiNumObjectsPassed += ref_stats.m_uiNumObjectsPassed;
+    });
+
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  const ezTime timeTaken = timer.GetRunningTotal();
+
   if (queryParams.m_pStats != nullptr)
   {
-    queryParams.m_pStats->m_TimeTaken = timer.GetRunningTotal();
+    queryParams.m_pStats->m_TimeTaken = timeTaken;
+  }
+
+  {
+    EZ_LOCK(m_CullingStatsMutex);
+
+    auto& cullingStats = m_CullingStats.ExpandAndGetRef();
+    cullingStats.m_TimeTaken = timeTaken;
+    cullingStats.m_uiNumObjectsTested = totalStats.m_uiNumObjectsTested;
+    cullingStats.m_uiNumObjectsPassed = totalStats.m_uiNumObjectsPassed;
+    cullingStats.m_uiNumViews = frustums.GetCount();
+    cullingStats.m_VisType = visType;
   }
 #endif
 }
@@ -938,6 +1285,7 @@ ezVisibilityState ezSpatialSystem_RegularGrid::GetVisibilityState(const ezSpatia
 void ezSpatialSystem_RegularGrid::GetInternalStats(ezStringBuilder& sb) const
 {
   EZ_LOCK(m_CacheCandidatesMutex);
+  EZ_LOCK(m_CullingStatsMutex);
 
   ezUInt32 uiNumActiveGrids = 0;
   for (auto& pGrid : m_Grids)
@@ -988,6 +1336,27 @@ void ezSpatialSystem_RegularGrid::GetInternalStats(ezStringBuilder& sb) const
       sb.AppendFormat("\nMigrationStatus: {}%%\n", ezArgF(float(uiNumObjectsMigrated) / m_DataTable.GetCount() * 100.0f, 2));
     }
   }
+
+  sb.AppendFormat("\nCulling (last frame, {}):\n", cvar_SpatialCullingMultithreaded ? "multi-threaded" : "single-threaded");
+
+  ezUInt32 uiViewIndex = 0;
+  for (auto& cullingStats : m_LastFrameCullingStats)
+  {
+    const char* szVisType = cullingStats.m_VisType == ezVisibilityState::Direct ? "Direct" : "Indirect";
+
+    if (cullingStats.m_uiNumViews > 1)
+    {
+      sb.AppendFormat(" Views {}-{} ({}, one pass): {}ms, Tested: {}, Passed: {}\n", uiViewIndex, uiViewIndex + cullingStats.m_uiNumViews - 1, szVisType,
+        ezArgF(cullingStats.m_TimeTaken.GetMilliseconds(), 3), cullingStats.m_uiNumObjectsTested, cullingStats.m_uiNumObjectsPassed);
+    }
+    else
+    {
+      sb.AppendFormat(" View {} ({}): {}ms, Tested: {}, Passed: {}, Chunks: {}\n", uiViewIndex, szVisType,
+        ezArgF(cullingStats.m_TimeTaken.GetMilliseconds(), 3), cullingStats.m_uiNumObjectsTested, cullingStats.m_uiNumObjectsPassed, cullingStats.m_uiNumChunks);
+    }
+
+    uiViewIndex += cullingStats.m_uiNumViews;
+  }
 }
 #endif
 
@@ -1056,6 +1425,18 @@ EZ_FORCE_INLINE void ezSpatialSystem_RegularGrid::ForEachGrid(const Data& data,
 }
 
 void ezSpatialSystem_RegularGrid::ForEachCellInBoxInMatchingGrids(const ezSimdBBox& box, const QueryParams& queryParams, CellCallback noFilterCallback, CellCallback filterByTagsCallback, void* pUserData, ezVisibilityState visType) const
+{
+  ForEachMatchingGrid(queryParams, noFilterCallback, filterByTagsCallback,
+    [&](const Grid& grid, CellCallback cellCallback, Stats& ref_stats) {
+      grid.ForEachCellInBox(box,
+        [&](const Cell& cell) {
+          return cellCallback(cell, queryParams, ref_stats, pUserData, visType);
+        });
+    });
+}
+
+template <typename Functor>
+void ezSpatialSystem_RegularGrid::ForEachMatchingGrid(const QueryParams& queryParams, CellCallback noFilterCallback, CellCallback filterByTagsCallback, Functor func) const
 {
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
   if (queryParams.m_pStats != nullptr)
@@ -1081,10 +1462,7 @@ void ezSpatialSystem_RegularGrid::ForEachCellInBoxInMatchingGrids(const ezSimdBB
     uiGridBitmask &= ~pGrid->m_Category.GetBitmask();
 
     Stats stats;
-    pGrid->ForEachCellInBox(box,
-      [&](const Cell& cell) {
-        return noFilterCallback(cell, queryParams, stats, pUserData, visType);
-      });
+    func(*pGrid, noFilterCallback, stats);
 
     UpdateCacheCandidate(queryParams.m_pIncludeTags, queryParams.m_pExcludeTags, pGrid->m_Category, 0.0f);
 
@@ -1111,10 +1489,7 @@ void ezSpatialSystem_RegularGrid::ForEachCellInBoxInMatchingGrids(const ezSimdBB
       continue;
 
     Stats stats;
-    pGrid->ForEachCellInBox(box,
-      [&](const Cell& cell) {
-        return cellCallback(cell, queryParams, stats, pUserData, visType);
-      });
+    func(*pGrid, cellCallback, stats);
 
     if (pGrid->m_bCanBeCached && useTagsFilter)
     {
@@ -1141,6 +1516,124 @@ void ezSpatialSystem_RegularGrid::ForEachCellInBoxInMatchingGrids(const ezSimdBB
   }
 }
 
+ezUInt32 ezSpatialSystem_RegularGrid::CullCellsInGrid(const Grid& grid, const ezSimdBBox& box, CellCallback cellCallback, const QueryParams& queryParams, Stats& ref_stats, void* pUserData, ezVisibilityState visType) const
+{
+  auto pQueryData = static_cast<ezInternal::QueryHelper::FrustumQueryData*>(pUserData);
+
+  ezHybridArray<const Cell*, 256> cellsInBox;
+  grid.ForEachCellInBox(box,
+    [&](const Cell& cell) {
+      cellsInBox.PushBack(&cell);
+      return ezVisitorExecution::Continue;
+    });
+
+  // test the cell bounds against the frustum two at a time, so that only the objects in visible cells count towards the work distribution
+  ezHybridArray<const Cell*, 256> visibleCells;
+  ezUInt32 uiNumObjects = 0;
+
+  auto AddVisibleCell = [&](const Cell* pCell) {
+    visibleCells.PushBack(pCell);
+    uiNumObjects += pCell->m_BoundingSpheres.GetCount();
+  };
+
+  ezUInt32 uiCellIndex = 0;
+  for (; uiCellIndex + 1 < cellsInBox.GetCount(); uiCellIndex += 2)
+  {
+    const Cell* pCellA = cellsInBox[uiCellIndex + 0];
+    const Cell* pCellB = cellsInBox[uiCellIndex + 1];
+
+    const ezUInt32 uiMask = SphereFrustumIntersect(pCellA->m_Bounds.GetSphere(), pCellB->m_Bounds.GetSphere(), pQueryData->m_PlaneData);
+
+    if (uiMask & 1)
+      AddVisibleCell(pCellA);
+    if (uiMask & 2)
+      AddVisibleCell(pCellB);
+  }
+
+  if (uiCellIndex < cellsInBox.GetCount() && SphereFrustumIntersect(cellsInBox[uiCellIndex]->m_Bounds.GetSphere(), pQueryData->m_PlaneData))
+  {
+    AddVisibleCell(cellsInBox[uiCellIndex]);
+  }
+
+  const ezUInt32 uiMaxChunks = ezTaskSystem::GetWorkerThreadCount(ezWorkerThreadType::ShortTasks) * 2;
+  const ezUInt32 uiNumChunks = ezMath::Min(uiMaxChunks, uiNumObjects / MIN_OBJECTS_PER_CULLING_CHUNK);
+
+  if (uiNumChunks <= 1)
+  {
+    for (const Cell* pCell : visibleCells)
+    {
+      cellCallback(*pCell, queryParams, ref_stats, pUserData, visType);
+    }
+
+    return 1;
+  }
+
+  struct Chunk
+  {
+    ezUInt32 m_uiFirstCell = 0;
+    ezUInt32 m_uiEndCell = 0;
+    Stats m_Stats;
+    ezDynamicArray<const ezGameObject*> m_Objects;
+  };
+
+  ezHybridArray<Chunk, 32> chunks;
+  chunks.SetCount(uiNumChunks);
+
+  // consecutive ranges of cells with roughly the same number of objects, so that appending the chunks in order gives the same result as culling on one thread
+  {
+    ezUInt32 uiCurrentChunk = 0;
+    ezUInt32 uiNumObjectsSoFar = 0;
+
+    for (ezUInt32 i = 0; i < visibleCells.GetCount(); ++i)
+    {
+      uiNumObjectsSoFar += visibleCells[i]->m_BoundingSpheres.GetCount();
+
+      chunks[uiCurrentChunk].m_uiEndCell = i + 1;
+
+      if (uiCurrentChunk + 1 < uiNumChunks && uiNumObjectsSoFar * uiNumChunks >= uiNumObjects * (uiCurrentChunk + 1))
+      {
+        ++uiCurrentChunk;
+        chunks[uiCurrentChunk].m_uiFirstCell = i + 1;
+        chunks[uiCurrentChunk].m_uiEndCell = i + 1;
+      }
+    }
+  }
+
+  auto CullChunks = [&](ezUInt32 uiStartChunk, ezUInt32 uiEndChunk) {
+    for (ezUInt32 uiChunk = uiStartChunk; uiChunk < uiEndChunk; ++uiChunk)
+    {
+      auto& chunk = chunks[uiChunk];
+
+      ezInternal::QueryHelper::FrustumQueryData chunkQueryData = *pQueryData;
+      chunkQueryData.m_pOutObjects = &chunk.m_Objects;
+
+      for (ezUInt32 i = chunk.m_uiFirstCell; i < chunk.m_uiEndCell; ++i)
+      {
+        // the visibility bookkeeping per object is done with atomics, so cells can be processed concurrently
+        cellCallback(*visibleCells[i], queryParams, chunk.m_Stats, &chunkQueryData, visType);
+      }
+    }
+  };
+
+  ezParallelForParams params;
+  params.m_uiBinSize = 1;
+  params.m_uiMaxTasksPerThread = 2;
+
+  // the occlusion callbacks are called from multiple threads at once, which is fine for the const queries of the occlusion buffer
+  ezTaskSystem::ParallelForIndexed(0u, uiNumChunks, CullChunks, "CullCellsInGrid", params);
+
+  for (auto& chunk : chunks)
+  {
+    pQueryData->m_pOutObjects->PushBackRange(chunk.m_Objects);
+
+    ref_stats.m_uiNumObjectsTested += chunk.m_Stats.m_uiNumObjectsTested;
+    ref_stats.m_uiNumObjectsPassed += chunk.m_Stats.m_uiNumObjectsPassed;
+    ref_stats.m_uiNumObjectsFiltered += chunk.m_Stats.m_uiNumObjectsFiltered;
+  }
+
+  return uiNumChunks;
+}
+
 void ezSpatialSystem_RegularGrid::MigrateCachedGrid(ezUInt32 uiCandidateIndex)
 {
   ezUInt32 uiTargetGridIndex = ezInvalidIndex;
@@ -5,10 +5,14 @@
 #include <Core/World/EventMessageHandlerComponent.h>
 #include <Core/World/World.h>
 #include <Core/World/WorldModule.h>
+#include <Foundation/Configuration/CVar.h>
 #include <Foundation/Memory/FrameAllocator.h>
 #include <Foundation/Profiling/Profiling.h>
 #include <Foundation/Utilities/Stats.h>
 
+ezCVarBool cvar_WorldBatchedMessageDispatch("World.BatchedMessageDispatch", true, ezCVarFlags::Default, "Dispatch queued messages in batches grouped by message type and receiver component type");
+ezCVarBool cvar_WorldThreadMessageBuffers("World.ThreadMessageBuffers", true, ezCVarFlags::Default, "Collect posted messages in per-thread buffers instead of a shared, locked message queue");
+
 ezStaticArray<ezWorld*, ezWorld::GetMaxNumWorlds()> ezWorld::s_Worlds;
 
 static ezGameObjectHandle DefaultGameObjectReferenceResolver(const void* pData, ezComponentHandle hThis, ezStringView sProperty)
@@ -379,23 +383,54 @@ void ezWorld::PostMessage(const ezGameObjectHandle& receiverObject, const ezMess
   metaData.m_uiReceiverIsComponent = false;
   metaData.m_uiRecursive = bRecursive;
 
+  EnqueueMessage(msg, metaData, queueType, delay);
+}
+
+void ezWorld::EnqueueMessage(const ezMessage& msg, QueuedMsgMetaData& metaData, ezObjectMsgQueueType::Enum queueType, ezTime delay) const
+{
   if (m_Data.m_ProcessingMessageQueue == queueType)
   {
     delay = ezMath::Max(delay, ezTime::MakeFromMilliseconds(1));
   }
 
+  // Use the calling thread's message buffer, if possible, so concurrent producers never contend on a lock.
+  ezInternal::WorldData::ThreadMessageBuffer* pThreadBuffer = cvar_WorldThreadMessageBuffers ? m_Data.GetThreadMessageBuffer() : nullptr;
+
   ezRTTIAllocator* pMsgRTTIAllocator = msg.GetDynamicRTTI()->GetAllocator();
   if (delay.IsPositive())
   {
     ezMessage* pMsgCopy = pMsgRTTIAllocator->Clone<ezMessage>(&msg, &m_Data.m_Allocator);
 
     metaData.m_Due = m_Data.m_Clock.GetAccumulatedTime() + delay;
-    m_Data.m_TimedMessageQueues[queueType].Enqueue(pMsgCopy, metaData);
+
+    if (pThreadBuffer != nullptr)
+    {
+      auto& entry = pThreadBuffer->m_TimedMessages[queueType].ExpandAndGetRef();
+      entry.m_pMessage = pMsgCopy;
+      entry.m_MetaData = metaData;
+      entry.m_uiMessageHash = 0;
+    }
+    else
+    {
+      m_Data.m_TimedMessageQueues[queueType].Enqueue(pMsgCopy, metaData);
+    }
   }
   else
   {
-    ezMessage* pMsgCopy = pMsgRTTIAllocator->Clone<ezMessage>(&msg, m_Data.m_StackAllocator.GetCurrentAllocator());
-    m_Data.m_MessageQueues[queueType].Enqueue(pMsgCopy, metaData);
+    if (pThreadBuffer != nullptr)
+    {
+      ezMessage* pMsgCopy = pMsgRTTIAllocator->Clone<ezMessage>(&msg, pThreadBuffer->m_pCurrentAllocator);
+
+      auto& entry = pThreadBuffer->m_Messages[queueType].ExpandAndGetRef();
+      entry.m_pMessage = pMsgCopy;
+      entry.m_MetaData = metaData;
+      entry.m_uiMessageHash = 0;
+    }
+    else
+    {
+      ezMessage* pMsgCopy = pMsgRTTIAllocator->Clone<ezMessage>(&msg, m_Data.m_StackAllocator.GetCurrentAllocator());
+      m_Data.m_MessageQueues[queueType].Enqueue(pMsgCopy, metaData);
+    }
   }
 }
 
@@ -410,24 +445,7 @@ void ezWorld::PostMessage(const ezComponentHandle& hReceiverComponent, const ezM
   metaData.m_uiReceiverIsComponent = true;
   metaData.m_uiRecursive = false;
 
-  if (m_Data.m_ProcessingMessageQueue == queueType)
-  {
-    delay = ezMath::Max(delay, ezTime::MakeFromMilliseconds(1));
-  }
-
-  ezRTTIAllocator* pMsgRTTIAllocator = msg.GetDynamicRTTI()->GetAllocator();
-  if (delay.IsPositive())
-  {
-    ezMessage* pMsgCopy = pMsgRTTIAllocator->Clone<ezMessage>(&msg, &m_Data.m_Allocator);
-
-    metaData.m_Due = m_Data.m_Clock.GetAccumulatedTime() + delay;
-    m_Data.m_TimedMessageQueues[queueType].Enqueue(pMsgCopy, metaData);
-  }
-  else
-  {
-    ezMessage* pMsgCopy = pMsgRTTIAllocator->Clone<ezMessage>(&msg, m_Data.m_StackAllocator.GetCurrentAllocator());
-    m_Data.m_MessageQueues[queueType].Enqueue(pMsgCopy, metaData);
-  }
+  EnqueueMessage(msg, metaData, queueType, delay);
 }
 
 void ezWorld::FindEventMsgHandlers(const ezMessage& msg, ezGameObject* pSearchObject, ezDynamicArray<ezComponent*>& out_components)
@@ -547,8 +565,9 @@ void ezWorld::Update()
     ProcessQueuedMessages(ezObjectMsgQueueType::AfterInitialized);
   }
 
-  // Swap our double buffered stack allocator
+  // Swap our double buffered stack allocators
   m_Data.m_StackAllocator.Swap();
+  m_Data.SwapThreadMessageAllocators();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -848,6 +867,85 @@ void ezWorld::ProcessQueuedMessage(const ezInternal::WorldData::MessageQueue::En
   }
 }
 
+void ezWorld::ProcessQueuedMessagesBatched(ezArrayPtr<const ezInternal::WorldData::MessageSortKey> sortedMessages)
+{
+  ezHybridArray<ezComponentManagerBase::MessageBatchEntry, 64> batch;
+
+  const ezUInt32 uiNumEntries = sortedMessages.GetCount();
+  for (ezUInt32 i = 0; i < uiNumEntries;)
+  {
+    const auto& firstEntry = *sortedMessages[i].m_pEntry;
+    if (!firstEntry.m_MetaData.m_uiReceiverIsComponent)
+    {
+      ProcessQueuedMessage(firstEntry);
+      ++i;
+      continue;
+    }
+
+    // The messages are sorted by message type first and by receiver second. Since the component type is stored in the upper bits of the
+    // component id, all messages of one type for components of one type form a consecutive range.
+    const ezMessageId msgId = sortedMessages[i].m_MsgId;
+    const ezWorldModuleTypeId uiTypeId = ezComponentId(firstEntry.m_MetaData.m_uiReceiverObjectOrComponent).m_TypeId;
+
+    ezUInt32 uiEnd = i + 1;
+    while (uiEnd < uiNumEntries)
+    {
+      const auto& entry = *sortedMessages[uiEnd].m_pEntry;
+      if (!entry.m_MetaData.m_uiReceiverIsComponent || sortedMessages[uiEnd].m_MsgId != msgId ||
+          ezComponentId(entry.m_MetaData.m_uiReceiverObjectOrComponent).m_TypeId != uiTypeId)
+        break;
+
+      ++uiEnd;
+    }
+
+    ezComponentManagerBase* pManager = nullptr;
+    if (uiTypeId < m_Data.m_Modules.GetCount())
+    {
+      pManager = static_cast<ezComponentManagerBase*>(m_Data.m_Modules[uiTypeId]);
+    }
+
+    if (pManager == nullptr)
+    {
+      for (; i < uiEnd; ++i)
+      {
+        ProcessQueuedMessage(*sortedMessages[i].m_pEntry);
+      }
+      continue;
+    }
+
+    batch.Clear();
+    for (; i < uiEnd; ++i)
+    {
+      const auto& entry = *sortedMessages[i].m_pEntry;
+
+      ezComponent* pReceiverComponent = nullptr;
+      if (pManager->TryGetComponent(ezComponentHandle(ezComponentId(entry.m_MetaData.m_uiReceiverObjectOrComponent)), pReceiverComponent))
+      {
+        if (pReceiverComponent->IsActiveAndInitialized() || pReceiverComponent->IsInitializing())
+        {
+          auto& batchEntry = batch.ExpandAndGetRef();
+          batchEntry.m_pComponent = pReceiverComponent;
+          batchEntry.m_pMessage = entry.m_pMessage;
+        }
+      }
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEBUG)
+      else if (entry.m_pMessage->GetDebugMessageRouting())
+      {
+        ezLog::Warning("ezWorld::ProcessQueuedMessage: Receiver ezComponent for message of type '{0}' does not exist anymore.", entry.m_pMessage->GetId());
+      }
+#endif
+    }
+
+    if (batch.IsEmpty() || pManager->HandleMessageBatch(msgId, batch))
+      continue;
+
+    for (auto& batchEntry : batch)
+    {
+      batchEntry.m_pComponent->SendMessageInternal(*batchEntry.m_pMessage, true);
+    }
+  }
+}
+
 void ezWorld::ProcessQueuedMessages(ezObjectMsgQueueType::Enum queueType)
 {
   EZ_PROFILE_SCOPE("Process Queued Messages");
@@ -884,19 +982,69 @@ void ezWorld::ProcessQueuedMessages(ezObjectMsgQueueType::Enum queueType)
     }
   };
 
+  // Same order as MessageComparer, regular messages are never delayed so m_Due doesn't need to be compared.
+  struct MessageSortKeyComparer
+  {
+    EZ_FORCE_INLINE bool Less(const ezInternal::WorldData::MessageSortKey& a, const ezInternal::WorldData::MessageSortKey& b) const
+    {
+      if (a.m_iSortingKey != b.m_iSortingKey)
+        return a.m_iSortingKey < b.m_iSortingKey;
+
+      if (a.m_MsgId != b.m_MsgId)
+        return a.m_MsgId < b.m_MsgId;
+
+      if (a.m_uiReceiverData != b.m_uiReceiverData)
+        return a.m_uiReceiverData < b.m_uiReceiverData;
+
+      return a.m_uiMessageHash < b.m_uiMessageHash;
+    }
+  };
+
+  m_Data.MergeThreadMessageBuffers(queueType);
+
   // regular messages
   {
     ezInternal::WorldData::MessageQueue& queue = m_Data.m_MessageQueues[queueType];
-    queue.Sort(MessageComparer());
 
-    m_Data.m_ProcessingMessageQueue = queueType;
-    for (ezUInt32 i = 0; i < queue.GetCount(); ++i)
+    if (cvar_WorldBatchedMessageDispatch)
     {
-      ProcessQueuedMessage(queue[i]);
+      // Sorting the deque directly calls two virtual functions per comparison and has to look up every entry in its blocks.
+      // The grouped dispatch sorts a compact array of keys instead, which is gathered once per message.
+      ezDynamicArray<ezInternal::WorldData::MessageSortKey> sortedMessages(m_Data.m_StackAllocator.GetCurrentAllocator());
+      sortedMessages.SetCountUninitialized(queue.GetCount());
 
-      // no need to deallocate these messages, they are allocated through a frame allocator
+      for (ezUInt32 i = 0; i < queue.GetCount(); ++i)
+      {
+        auto& entry = queue[i];
+        EZ_ASSERT_DEBUG(entry.m_MetaData.m_Due.IsZero(), "Regular messages are not expected to be delayed");
+
+        auto& key = sortedMessages[i];
+        key.m_uiReceiverData = entry.m_MetaData.m_uiReceiverData;
+        key.m_uiMessageHash = entry.m_pMessage->GetHash();
+        key.m_iSortingKey = entry.m_pMessage->GetSortingKey();
+        key.m_MsgId = entry.m_pMessage->GetId();
+        key.m_pEntry = &entry;
+      }
+
+      sortedMessages.Sort(MessageSortKeyComparer());
+
+      m_Data.m_ProcessingMessageQueue = queueType;
+      ProcessQueuedMessagesBatched(sortedMessages);
+      m_Data.m_ProcessingMessageQueue = ezObjectMsgQueueType::COUNT;
     }
-    m_Data.m_ProcessingMessageQueue = ezObjectMsgQueueType::COUNT;
+    else
+    {
+      queue.Sort(MessageComparer());
+
+      m_Data.m_ProcessingMessageQueue = queueType;
+      for (ezUInt32 i = 0; i < queue.GetCount(); ++i)
+      {
+        ProcessQueuedMessage(queue[i]);
+      }
+      m_Data.m_ProcessingMessageQueue = ezObjectMsgQueueType::COUNT;
+    }
+
+    // no need to deallocate these messages, they are allocated through a frame allocator
 
     queue.Clear();
   }
@@ -2,11 +2,15 @@
 
 #include <Core/ResourceManager/ResourceManager.h>
 #include <Core/World/Implementation/WorldData.h>
+#include <Core/World/SpatialSystem_Bvh.h>
 #include <Core/World/SpatialSystem_RegularGrid.h>
 #include <Core/World/World.h>
 
+#include <Foundation/Configuration/CVar.h>
 #include <Foundation/Time/DefaultTimeStepSmoothing.h>
 
+ezCVarBool cvar_WorldBatchedTransformUpdate("World.BatchedTransformUpdate", true, ezCVarFlags::Default, "Update global transforms of dynamic objects four at a time in structure-of-arrays form");
+
 namespace ezInternal
 {
   class DefaultCoordinateSystemProvider : public ezCoordinateSystemProvider
@@ -36,6 +40,52 @@ namespace ezInternal
     m_Function(context);
   }
 
+  void WorldData::TransformUpdateTask::Execute()
+  {
+    UpdateBlocks(0, m_pWorldData->m_Hierarchies[HierarchyType::Dynamic].m_Data[m_uiHierarchyLevel]->GetCount());
+  }
+
+  void WorldData::TransformUpdateTask::ExecuteWithMultiplicity(ezUInt32 uiInvocation) const
+  {
+    const ezUInt32 uiNumBlocks = m_pWorldData->m_Hierarchies[HierarchyType::Dynamic].m_Data[m_uiHierarchyLevel]->GetCount();
+    const ezUInt32 uiFirstBlock = uiInvocation * m_uiBlocksPerInvocation;
+
+    if (uiFirstBlock < uiNumBlocks)
+    {
+      UpdateBlocks(uiFirstBlock, ezMath::Min(m_uiBlocksPerInvocation, uiNumBlocks - uiFirstBlock));
+    }
+  }
+
+  void WorldData::TransformUpdateTask::UpdateBlocks(ezUInt32 uiFirstBlock, ezUInt32 uiNumBlocks) const
+  {
+    const ezUInt32 uiUpdateCounter = m_pWorldData->m_uiUpdateCounter;
+    const Hierarchy::DataBlockArray& blocks = *m_pWorldData->m_Hierarchies[HierarchyType::Dynamic].m_Data[m_uiHierarchyLevel];
+
+    for (ezUInt32 i = uiFirstBlock; i < uiFirstBlock + uiNumBlocks; ++i)
+    {
+      ezGameObject::TransformationData* pData = blocks[i].m_pData;
+      const ezUInt32 uiCount = blocks[i].m_uiCount;
+
+      if (m_bBatched)
+      {
+        if (m_uiHierarchyLevel == 0)
+          UpdateGlobalTransformsBatched<false>(pData, uiCount, uiUpdateCounter, nullptr);
+        else
+          UpdateGlobalTransformsBatched<true>(pData, uiCount, uiUpdateCounter, nullptr);
+      }
+      else
+      {
+        for (ezUInt32 j = 0; j < uiCount; ++j)
+        {
+          if (m_uiHierarchyLevel == 0)
+            UpdateGlobalTransform(pData + j, uiUpdateCounter);
+          else
+            UpdateGlobalTransformWithParent(pData + j, uiUpdateCounter);
+        }
+      }
+    }
+  }
+
   ////////////////////////////////////////////////////////////////////////////////////////////////////
 
   WorldData::WorldData(ezWorldDesc& desc)
@@ -88,7 +138,14 @@ namespace ezInternal
 
     if (m_pSpatialSystem == nullptr && desc.m_bAutoCreateSpatialSystem)
     {
-      m_pSpatialSystem = EZ_NEW(ezFoundation::GetAlignedAllocator(), ezSpatialSystem_RegularGrid);
+      if (desc.m_SpatialSystemType == ezSpatialSystemType::Bvh)
+      {
+        m_pSpatialSystem = EZ_NEW(ezFoundation::GetAlignedAllocator(), ezSpatialSystem_Bvh);
+      }
+      else
+      {
+        m_pSpatialSystem = EZ_NEW(ezFoundation::GetAlignedAllocator(), ezSpatialSystem_RegularGrid);
+      }
     }
 
     if (m_pCoordinateSystemProvider == nullptr)
@@ -109,6 +166,11 @@ namespace ezInternal
   WorldData::~WorldData()
   {
     ezResourceManager::GetResourceEvents().RemoveEventHandler(ezMakeDelegate(&WorldData::ResourceEventHandler, this));
+
+    for (ThreadMessageBuffer*& pBuffer : m_ThreadMessageBuffers)
+    {
+      EZ_DELETE(&m_Allocator, pBuffer);
+    }
   }
 
   void WorldData::Clear()
@@ -165,6 +227,8 @@ namespace ezInternal
 
     // delete task storage
     m_UpdateTasks.Clear();
+    m_TransformUpdateGraph.Clear();
+    m_TransformUpdateTasks.Clear();
 
     // delete queued messages
     for (ezUInt32 i = 0; i < ezObjectMsgQueueType::COUNT; ++i)
@@ -186,6 +250,193 @@ namespace ezInternal
           queue.Dequeue();
         }
       }
+
+      for (ThreadMessageBuffer* pBuffer : m_ThreadMessageBuffers)
+      {
+        if (pBuffer == nullptr)
+          continue;
+
+        pBuffer->m_Messages[i].Clear();
+
+        for (MessageQueue::Entry& entry : pBuffer->m_TimedMessages[i])
+        {
+          EZ_DELETE(&m_Allocator, entry.m_pMessage);
+        }
+        pBuffer->m_TimedMessages[i].Clear();
+      }
+    }
+  }
+
+  namespace
+  {
+    /// Every thread that posts messages occupies one bit in this mask for its lifetime.
+    /// The bit index is used to look up the thread's message buffer in every world.
+    ezAtomicInteger64 s_UsedThreadMessageBufferSlots;
+
+    struct ThreadMessageBufferSlot
+    {
+      ~ThreadMessageBufferSlot()
+      {
+        if (m_uiIndex != ezInvalidIndex)
+        {
+          s_UsedThreadMessageBufferSlots.And(~(ezInt64(1) << m_uiIndex));
+        }
+      }
+
+      ezUInt32 Acquire()
+      {
+        ezInt64 iUsedSlots = s_UsedThreadMessageBufferSlots;
+        while (iUsedSlots != -1)
+        {
+          const ezUInt32 uiIndex = ezMath::FirstBitLow(static_cast<ezUInt64>(~iUsedSlots));
+          const ezInt64 iPrevUsedSlots = s_UsedThreadMessageBufferSlots.CompareAndSwap(iUsedSlots, iUsedSlots | (ezInt64(1) << uiIndex));
+          if (iPrevUsedSlots == iUsedSlots)
+          {
+            m_uiIndex = uiIndex;
+            break;
+          }
+
+          iUsedSlots = iPrevUsedSlots;
+        }
+
+        return m_uiIndex;
+      }
+
+      ezUInt32 m_uiIndex = ezInvalidIndex;
+    };
+
+    thread_local ThreadMessageBufferSlot tl_ThreadMessageBufferSlot;
+  } // namespace
+
+  WorldData::ThreadMessageBuffer::CloneAllocator::CloneAllocator(ezStringView sName, ezAllocator* pParent)
+    : ezAllocatorWithPolicy<ezAllocPolicyStack, ezAllocatorTrackingMode::Basics>(sName, pParent)
+    , m_DestructData(pParent)
+  {
+  }
+
+  WorldData::ThreadMessageBuffer::CloneAllocator::~CloneAllocator()
+  {
+    Reset();
+  }
+
+  void* WorldData::ThreadMessageBuffer::CloneAllocator::Allocate(size_t uiSize, size_t uiAlign, ezMemoryUtils::DestructorFunction destructorFunc)
+  {
+    void* ptr = m_allocator.Allocate(uiSize, uiAlign);
+
+    if (destructorFunc != nullptr)
+    {
+      auto& data = m_DestructData.ExpandAndGetRef();
+      data.m_Func = destructorFunc;
+      data.m_Ptr = ptr;
+    }
+
+    return ptr;
+  }
+
+  void WorldData::ThreadMessageBuffer::CloneAllocator::Deallocate(void* pPtr)
+  {
+    EZ_REPORT_FAILURE("Message clones are released all at once and must not be deallocated individually");
+  }
+
+  void WorldData::ThreadMessageBuffer::CloneAllocator::Reset()
+  {
+    for (ezUInt32 i = m_DestructData.GetCount(); i-- > 0;)
+    {
+      auto& data = m_DestructData[i];
+      data.m_Func(data.m_Ptr);
+    }
+    m_DestructData.Clear();
+
+    m_allocator.Reset();
+
+    ezAllocator::Stats stats;
+    m_allocator.FillStats(stats);
+    ezMemoryTracker::SetAllocatorStats(m_Id, stats);
+  }
+
+  WorldData::ThreadMessageBuffer::ThreadMessageBuffer(ezStringView sName)
+    : m_Allocator0(ezStringBuilder(sName, "0"), ezFoundation::GetAlignedAllocator())
+    , m_Allocator1(ezStringBuilder(sName, "1"), ezFoundation::GetAlignedAllocator())
+  {
+  }
+
+  void WorldData::ThreadMessageBuffer::SwapAllocators()
+  {
+    m_pCurrentAllocator = (m_pCurrentAllocator == &m_Allocator0) ? &m_Allocator1 : &m_Allocator0;
+    m_pCurrentAllocator->Reset();
+  }
+
+  WorldData::ThreadMessageBuffer* WorldData::GetThreadMessageBuffer() const
+  {
+    EZ_CHECK_AT_COMPILETIME(MAX_THREAD_MESSAGE_BUFFERS == sizeof(ezInt64) * 8);
+
+    ezUInt32 uiIndex = tl_ThreadMessageBufferSlot.m_uiIndex;
+    if (uiIndex == ezInvalidIndex)
+    {
+      uiIndex = tl_ThreadMessageBufferSlot.Acquire();
+      if (uiIndex == ezInvalidIndex)
+        return nullptr;
+    }
+
+    // Only the thread owning the slot ever creates the buffer, so no synchronization is needed here.
+    ThreadMessageBuffer*& pBuffer = m_ThreadMessageBuffers[uiIndex];
+    if (pBuffer == nullptr)
+    {
+      ezStringBuilder sName;
+      sName.SetFormat("{} - Thread Messages {}", m_sName, uiIndex);
+
+      pBuffer = EZ_NEW(&m_Allocator, ThreadMessageBuffer, sName);
+    }
+
+    return pBuffer;
+  }
+
+  void WorldData::MergeThreadMessageBuffers(ezObjectMsgQueueType::Enum queueType)
+  {
+    MessageQueue& queue = m_MessageQueues[queueType];
+    MessageQueue& timedQueue = m_TimedMessageQueues[queueType];
+
+    ezUInt32 uiNumMessages = queue.GetCount();
+    ezUInt32 uiNumTimedMessages = timedQueue.GetCount();
+    for (ThreadMessageBuffer* pBuffer : m_ThreadMessageBuffers)
+    {
+      if (pBuffer != nullptr)
+      {
+        uiNumMessages += pBuffer->m_Messages[queueType].GetCount();
+        uiNumTimedMessages += pBuffer->m_TimedMessages[queueType].GetCount();
+      }
+    }
+
+    queue.Reserve(uiNumMessages);
+    timedQueue.Reserve(uiNumTimedMessages);
+
+    for (ThreadMessageBuffer* pBuffer : m_ThreadMessageBuffers)
+    {
+      if (pBuffer == nullptr)
+        continue;
+
+      for (const MessageQueue::Entry& entry : pBuffer->m_Messages[queueType])
+      {
+        queue.Enqueue(entry.m_pMessage, entry.m_MetaData);
+      }
+      pBuffer->m_Messages[queueType].Clear();
+
+      for (const MessageQueue::Entry& entry : pBuffer->m_TimedMessages[queueType])
+      {
+        timedQueue.Enqueue(entry.m_pMessage, entry.m_MetaData);
+      }
+      pBuffer->m_TimedMessages[queueType].Clear();
+    }
+  }
+
+  void WorldData::SwapThreadMessageAllocators()
+  {
+    for (ThreadMessageBuffer* pBuffer : m_ThreadMessageBuffers)
+    {
+      if (pBuffer != nullptr)
+      {
+        pBuffer->SwapAllocators();
+      }
     }
   }
 
@@ -307,6 +558,219 @@ namespace ezInternal
     return ezVisitorExecution::Continue;
   }
 
+  namespace
+  {
+    EZ_ALWAYS_INLINE void TransposeTransformationData4(ezSimdVec4f& ref_v0, ezSimdVec4f& ref_v1, ezSimdVec4f& ref_v2, ezSimdVec4f& ref_v3)
+    {
+      ezSimdMat4f m = ezSimdMat4f::MakeFromColumns(ref_v0, ref_v1, ref_v2, ref_v3);
+      m.Transpose();
+
+      ref_v0 = m.m_col0;
+      ref_v1 = m.m_col1;
+      ref_v2 = m.m_col2;
+      ref_v3 = m.m_col3;
+    }
+  } // namespace
+
+  // static
+  template <bool WITH_PARENT>
+  void WorldData::UpdateGlobalTransformsBatched(ezGameObject::TransformationData* pData, ezUInt32 uiCount, ezUInt32 uiUpdateCounter, ezSpatialSystem* pSpatialSystem)
+  {
+    ezGameObject::TransformationData* pEndData = pData + uiCount;
+
+    // All vectors below hold one component of four different entries, e.g. px = (pos0.x, pos1.x, pos2.x, pos3.x).
+    // The math is the same as in ezSimdTransform::operator* and ezSimdBBoxSphere::Transform, just without any shuffles.
+    for (; pData + 4 <= pEndData; pData += 4)
+    {
+      ezGameObject::TransformationData& d0 = pData[0];
+      ezGameObject::TransformationData& d1 = pData[1];
+      ezGameObject::TransformationData& d2 = pData[2];
+      ezGameObject::TransformationData& d3 = pData[3];
+
+      ezSimdVec4f px = d0.m_localPosition, py = d1.m_localPosition, pz = d2.m_localPosition, pw = d3.m_localPosition;
+      TransposeTransformationData4(px, py, pz, pw);
+
+      ezSimdVec4f qx = d0.m_localRotation.m_v, qy = d1.m_localRotation.m_v, qz = d2.m_localRotation.m_v, qw = d3.m_localRotation.m_v;
+      TransposeTransformationData4(qx, qy, qz, qw);
+
+      ezSimdVec4f sx = d0.m_localScaling, sy = d1.m_localScaling, sz = d2.m_localScaling, sw = d3.m_localScaling;
+      TransposeTransformationData4(sx, sy, sz, sw);
+
+      // w = uniform scaling
+      sx = sx.CompMul(sw);
+      sy = sy.CompMul(sw);
+      sz = sz.CompMul(sw);
+      sw = sw.CompMul(sw);
+
+      if constexpr (WITH_PARENT)
+      {
+        const ezSimdTransform& p0 = d0.m_pParentData->m_globalTransform;
+        const ezSimdTransform& p1 = d1.m_pParentData->m_globalTransform;
+        const ezSimdTransform& p2 = d2.m_pParentData->m_globalTransform;
+        const ezSimdTransform& p3 = d3.m_pParentData->m_globalTransform;
+
+        ezSimdVec4f ppx = p0.m_Position, ppy = p1.m_Position, ppz = p2.m_Position, ppw = p3.m_Position;
+        TransposeTransformationData4(ppx, ppy, ppz, ppw);
+
+        ezSimdVec4f pqx = p0.m_Rotation.m_v, pqy = p1.m_Rotation.m_v, pqz = p2.m_Rotation.m_v, pqw = p3.m_Rotation.m_v;
+        TransposeTransformationData4(pqx, pqy, pqz, pqw);
+
+        ezSimdVec4f psx = p0.m_Scale, psy = p1.m_Scale, psz = p2.m_Scale, psw = p3.m_Scale;
+        TransposeTransformationData4(psx, psy, psz, psw);
+
+        // position = parent position + parent rotation * (local position * parent scale)
+        {
+          const ezSimdVec4f vx = px.CompMul(psx);
+          const ezSimdVec4f vy = py.CompMul(psy);
+          const ezSimdVec4f vz = pz.CompMul(psz);
+
+          ezSimdVec4f tx = pqy.CompMul(vz) - pqz.CompMul(vy);
+          ezSimdVec4f ty = pqz.CompMul(vx) - pqx.CompMul(vz);
+          ezSimdVec4f tz = pqx.CompMul(vy) - pqy.CompMul(vx);
+          tx += tx;
+          ty += ty;
+          tz += tz;
+
+          px = ppx + vx + tx.CompMul(pqw) + (pqy.CompMul(tz) - pqz.CompMul(ty));
+          py = ppy + vy + ty.CompMul(pqw) + (pqz.CompMul(tx) - pqx.CompMul(tz));
+          pz = ppz + vz + tz.CompMul(pqw) + (pqx.CompMul(ty) - pqy.CompMul(tx));
+          pw = ppw + pw.CompMul(psw);
+        }
+
+        // rotation = parent rotation * local rotation
+        {
+          const ezSimdVec4f rx = qx.CompMul(pqw) + pqx.CompMul(qw) + (pqy.CompMul(qz) - pqz.CompMul(qy));
+          const ezSimdVec4f ry = qy.CompMul(pqw) + pqy.CompMul(qw) + (pqz.CompMul(qx) - pqx.CompMul(qz));
+          const ezSimdVec4f rz = qz.CompMul(pqw) + pqz.CompMul(qw) + (pqx.CompMul(qy) - pqy.CompMul(qx));
+          qw = pqw.CompMul(qw) - (pqx.CompMul(qx) + pqy.CompMul(qy) + pqz.CompMul(qz));
+          qx = rx;
+          qy = ry;
+          qz = rz;
+        }
+
+        sx = psx.CompMul(sx);
+        sy = psy.CompMul(sy);
+        sz = psz.CompMul(sz);
+        sw = psw.CompMul(sw);
+      }
+
+      // rotation matrix columns scaled by the global scale, see ezSimdQuat::GetAsMat4
+      ezSimdVec4f m00, m01, m02, m10, m11, m12, m20, m21, m22;
+      {
+        const ezSimdVec4f x2 = qx + qx;
+        const ezSimdVec4f y2 = qy + qy;
+        const ezSimdVec4f z2 = qz + qz;
+
+        const ezSimdVec4f xx2 = x2.CompMul(qx);
+        const ezSimdVec4f yy2 = y2.CompMul(qy);
+        const ezSimdVec4f zz2 = z2.CompMul(qz);
+
+        const ezSimdVec4f xy2 = qx.CompMul(y2);
+        const ezSimdVec4f yz2 = qy.CompMul(z2);
+        const ezSimdVec4f xz2 = qx.CompMul(z2);
+
+        const ezSimdVec4f wx2 = x2.CompMul(qw);
+        const ezSimdVec4f wy2 = y2.CompMul(qw);
+        const ezSimdVec4f wz2 = z2.CompMul(qw);
+
+        const ezSimdVec4f one(1.0f);
+
+        m00 = (one - (yy2 + zz2)).CompMul(sx);
+        m01 = (xy2 + wz2).CompMul(sx);
+        m02 = (xz2 - wy2).CompMul(sx);
+
+        m10 = (xy2 - wz2).CompMul(sy);
+        m11 = (one - (xx2 + zz2)).CompMul(sy);
+        m12 = (yz2 + wx2).CompMul(sy);
+
+        m20 = (xz2 + wy2).CompMul(sz);
+        m21 = (yz2 - wx2).CompMul(sz);
+        m22 = (one - (xx2 + yy2)).CompMul(sz);
+      }
+
+      ezSimdVec4f cx = d0.m_localBounds.m_CenterAndRadius, cy = d1.m_localBounds.m_CenterAndRadius, cz = d2.m_localBounds.m_CenterAndRadius, cr = d3.m_localBounds.m_CenterAndRadius;
+      TransposeTransformationData4(cx, cy, cz, cr);
+
+      ezSimdVec4f hx = d0.m_localBounds.m_BoxHalfExtents, hy = d1.m_localBounds.m_BoxHalfExtents, hz = d2.m_localBounds.m_BoxHalfExtents, hw = d3.m_localBounds.m_BoxHalfExtents;
+      TransposeTransformationData4(hx, hy, hz, hw);
+
+      // bounds, see ezSimdBBoxSphere::Transform
+      {
+        const ezSimdVec4f gcx = m00.CompMul(cx) + m10.CompMul(cy) + m20.CompMul(cz) + px;
+        const ezSimdVec4f gcy = m01.CompMul(cx) + m11.CompMul(cy) + m21.CompMul(cz) + py;
+        const ezSimdVec4f gcz = m02.CompMul(cx) + m12.CompMul(cy) + m22.CompMul(cz) + pz;
+
+        const ezSimdVec4f len0 = m00.CompMul(m00) + m01.CompMul(m01) + m02.CompMul(m02);
+        const ezSimdVec4f len1 = m10.CompMul(m10) + m11.CompMul(m11) + m12.CompMul(m12);
+        const ezSimdVec4f len2 = m20.CompMul(m20) + m21.CompMul(m21) + m22.CompMul(m22);
+        const ezSimdVec4f r = cr.CompMul(len0.CompMax(len1).CompMax(len2).GetSqrt());
+
+        const ezSimdVec4f ghx = (m00.Abs().CompMul(hx) + m10.Abs().CompMul(hy) + m20.Abs().CompMul(hz)).CompMin(r);
+        const ezSimdVec4f ghy = (m01.Abs().CompMul(hx) + m11.Abs().CompMul(hy) + m21.Abs().CompMul(hz)).CompMin(r);
+        const ezSimdVec4f ghz = (m02.Abs().CompMul(hx) + m12.Abs().CompMul(hy) + m22.Abs().CompMul(hz)).CompMin(r);
+
+        cx = gcx;
+        cy = gcy;
+        cz = gcz;
+        cr = r;
+        hx = ghx;
+        hy = ghy;
+        hz = ghz;
+        hw = ezSimdVec4f::MakeZero().CompMin(r);
+      }
+
+      TransposeTransformationData4(px, py, pz, pw);
+      TransposeTransformationData4(qx, qy, qz, qw);
+      TransposeTransformationData4(sx, sy, sz, sw);
+      TransposeTransformationData4(cx, cy, cz, cr);
+      TransposeTransformationData4(hx, hy, hz, hw);
+
+      const ezSimdVec4f* pPositions[] = {&px, &py, &pz, &pw};
+      const ezSimdVec4f* pRotations[] = {&qx, &qy, &qz, &qw};
+      const ezSimdVec4f* pScales[] = {&sx, &sy, &sz, &sw};
+      const ezSimdVec4f* pCenters[] = {&cx, &cy, &cz, &cr};
+      const ezSimdVec4f* pHalfExtents[] = {&hx, &hy, &hz, &hw};
+
+      for (ezUInt32 i = 0; i < 4; ++i)
+      {
+        ezGameObject::TransformationData& data = pData[i];
+        data.UpdateLastGlobalTransform(uiUpdateCounter);
+
+        data.m_globalTransform.m_Position = *pPositions[i];
+        data.m_globalTransform.m_Rotation.m_v = *pRotations[i];
+        data.m_globalTransform.m_Scale = *pScales[i];
+
+        const ezSimdBBoxSphere oldGlobalBounds = data.m_globalBounds;
+        data.m_globalBounds.m_CenterAndRadius = *pCenters[i];
+        data.m_globalBounds.m_BoxHalfExtents = *pHalfExtents[i];
+
+        if (pSpatialSystem != nullptr)
+        {
+          const bool bIsAlwaysVisible = data.m_localBounds.m_BoxHalfExtents.w() != ezSimdFloat::MakeZero();
+          if (data.m_hSpatialData.IsInvalidated() == false && bIsAlwaysVisible == false && data.m_globalBounds != oldGlobalBounds)
+          {
+            pSpatialSystem->UpdateSpatialDataBounds(data.m_hSpatialData, data.m_globalBounds);
+          }
+        }
+      }
+    }
+
+    // remainder
+    for (; pData < pEndData; ++pData)
+    {
+      if constexpr (WITH_PARENT)
+      {
+        pData->UpdateGlobalTransformWithParent(uiUpdateCounter);
+      }
+      else
+      {
+        pData->UpdateGlobalTransformWithoutParent(uiUpdateCounter);
+      }
+
+      pData->UpdateGlobalBounds(pSpatialSystem);
+    }
+  }
+
   void WorldData::UpdateGlobalTransforms()
   {
     struct UserData
@@ -319,72 +783,148 @@ namespace ezInternal
     userData.m_pSpatialSystem = m_pSpatialSystem.Borrow();
     userData.m_uiUpdateCounter = m_uiUpdateCounter;
 
-    struct RootLevel
+    struct RootLevelWithSpatialData
     {
       EZ_ALWAYS_INLINE static ezVisitorExecution::Enum Visit(ezGameObject::TransformationData* pData, void* pUserData0)
       {
-        auto pUserData = static_cast<const UserData*>(pUserData0);
-        WorldData::UpdateGlobalTransform(pData, pUserData->m_uiUpdateCounter);
+        auto pUserData = static_cast<UserData*>(pUserData0);
+        WorldData::UpdateGlobalTransformAndSpatialData(pData, pUserData->m_uiUpdateCounter, *pUserData->m_pSpatialSystem);
         return ezVisitorExecution::Continue;
       }
     };
 
-    struct WithParent
+    struct WithParentWithSpatialData
     {
       EZ_ALWAYS_INLINE static ezVisitorExecution::Enum Visit(ezGameObject::TransformationData* pData, void* pUserData0)
       {
-        auto pUserData = static_cast<const UserData*>(pUserData0);
-        WorldData::UpdateGlobalTransformWithParent(pData, pUserData->m_uiUpdateCounter);
+        auto pUserData = static_cast<UserData*>(pUserData0);
+        WorldData::UpdateGlobalTransformWithParentAndSpatialData(pData, pUserData->m_uiUpdateCounter, *pUserData->m_pSpatialSystem);
         return ezVisitorExecution::Continue;
       }
     };
 
-    struct RootLevelWithSpatialData
+    struct RootLevelBatched
     {
-      EZ_ALWAYS_INLINE static ezVisitorExecution::Enum Visit(ezGameObject::TransformationData* pData, void* pUserData0)
+      EZ_ALWAYS_INLINE static void VisitBatch(ezGameObject::TransformationData* pData, ezUInt32 uiCount, void* pUserData0)
       {
         auto pUserData = static_cast<UserData*>(pUserData0);
-        WorldData::UpdateGlobalTransformAndSpatialData(pData, pUserData->m_uiUpdateCounter, *pUserData->m_pSpatialSystem);
-        return ezVisitorExecution::Continue;
+        WorldData::UpdateGlobalTransformsBatched<false>(pData, uiCount, pUserData->m_uiUpdateCounter, pUserData->m_pSpatialSystem);
       }
     };
 
-    struct WithParentWithSpatialData
+    struct WithParentBatched
     {
-      EZ_ALWAYS_INLINE static ezVisitorExecution::Enum Visit(ezGameObject::TransformationData* pData, void* pUserData0)
+      EZ_ALWAYS_INLINE static void VisitBatch(ezGameObject::TransformationData* pData, ezUInt32 uiCount, void* pUserData0)
       {
         auto pUserData = static_cast<UserData*>(pUserData0);
-        WorldData::UpdateGlobalTransformWithParentAndSpatialData(pData, pUserData->m_uiUpdateCounter, *pUserData->m_pSpatialSystem);
-        return ezVisitorExecution::Continue;
+        WorldData::UpdateGlobalTransformsBatched<true>(pData, uiCount, pUserData->m_uiUpdateCounter, pUserData->m_pSpatialSystem);
       }
     };
 
     Hierarchy& hierarchy = m_Hierarchies[HierarchyType::Dynamic];
-    if (!hierarchy.m_Data.IsEmpty())
+    if (!hierarchy.m_Data.IsEmpty() && m_pSpatialSystem == nullptr)
     {
-      auto dataPtr = hierarchy.m_Data.GetData();
-
       // If we have no spatial system, we perform multi-threaded update as we do not
       // have to acquire a write lock in the process.
-      if (m_pSpatialSystem == nullptr)
+      UpdateGlobalTransformsMultiThreaded(cvar_WorldBatchedTransformUpdate);
+    }
+    else if (!hierarchy.m_Data.IsEmpty() && cvar_WorldBatchedTransformUpdate)
+    {
+      auto dataPtr = hierarchy.m_Data.GetData();
+
+      TraverseHierarchyLevelBatched<RootLevelBatched>(*dataPtr[0], &userData);
+
+      for (ezUInt32 i = 1; i < hierarchy.m_Data.GetCount(); ++i)
       {
-        TraverseHierarchyLevelMultiThreaded<RootLevel>(*dataPtr[0], &userData);
+        TraverseHierarchyLevelBatched<WithParentBatched>(*dataPtr[i], &userData);
+      }
+    }
+    else if (!hierarchy.m_Data.IsEmpty())
+    {
+      auto dataPtr = hierarchy.m_Data.GetData();
+
+      TraverseHierarchyLevel<RootLevelWithSpatialData>(*dataPtr[0], &userData);
+
+      for (ezUInt32 i = 1; i < hierarchy.m_Data.GetCount(); ++i)
+      {
+        TraverseHierarchyLevel<WithParentWithSpatialData>(*dataPtr[i], &userData);
+      }
+    }
+  }
 
-        for (ezUInt32 i = 1; i < hierarchy.m_Data.GetCount(); ++i)
+  void WorldData::UpdateGlobalTransformsMultiThreaded(bool bBatched)
+  {
+    Hierarchy& hierarchy = m_Hierarchies[HierarchyType::Dynamic];
+    const ezUInt32 uiNumLevels = hierarchy.m_Data.GetCount();
+
+    // hierarchy levels are never removed, so the graph only has to grow along with the hierarchy
+    if (m_TransformUpdateGraph.GetNodeCount() != uiNumLevels)
+    {
+      m_TransformUpdateGraph.Clear();
+
+      for (ezUInt32 i = 0; i < uiNumLevels; ++i)
+      {
+        if (i == m_TransformUpdateTasks.GetCount())
         {
-          TraverseHierarchyLevelMultiThreaded<WithParent>(*dataPtr[i], &userData);
+          ezSharedPtr<TransformUpdateTask> pTask = EZ_NEW(&m_Allocator, TransformUpdateTask);
+          pTask->ConfigureTask("World Transform Update Task", ezTaskNesting::Never);
+          pTask->m_pWorldData = this;
+          pTask->m_uiHierarchyLevel = i;
+          m_TransformUpdateTasks.PushBack(pTask);
         }
+
+        m_TransformUpdateGraph.AddNode(m_TransformUpdateTasks[i]);
+
+        if (i > 0)
+        {
+          m_TransformUpdateGraph.AddDependency(i, i - 1);
+        }
+      }
+
+      m_TransformUpdateGraph.Compile().AssertSuccess("Every hierarchy level only depends on the level above, the graph can't contain a cycle.");
+    }
+
+    ezParallelForParams parallelForParams;
+    parallelForParams.m_uiBinSize = 100;
+    parallelForParams.m_uiMaxTasksPerThread = 2;
+
+    ezUInt32 uiTotalBlocks = 0;
+
+    for (ezUInt32 i = 0; i < uiNumLevels; ++i)
+    {
+      TransformUpdateTask& task = *m_TransformUpdateTasks[i];
+      task.m_bBatched = bBatched;
+
+      const ezUInt32 uiNumBlocks = hierarchy.m_Data[i]->GetCount();
+      uiTotalBlocks += uiNumBlocks;
+
+      if (uiNumBlocks <= parallelForParams.m_uiBinSize)
+      {
+        task.SetMultiplicity(0);
       }
       else
       {
-        TraverseHierarchyLevel<RootLevelWithSpatialData>(*dataPtr[0], &userData);
+        ezUInt32 uiMultiplicity;
+        ezUInt64 uiBlocksPerInvocation;
+        parallelForParams.DetermineThreading(uiNumBlocks, uiMultiplicity, uiBlocksPerInvocation);
 
-        for (ezUInt32 i = 1; i < hierarchy.m_Data.GetCount(); ++i)
-        {
-          TraverseHierarchyLevel<WithParentWithSpatialData>(*dataPtr[i], &userData);
-        }
+        task.SetMultiplicity(uiMultiplicity);
+        task.m_uiBlocksPerInvocation = static_cast<ezUInt32>(uiBlocksPerInvocation);
       }
     }
+
+    if (uiTotalBlocks <= parallelForParams.m_uiBinSize)
+    {
+      // not worth waking up other threads
+      for (ezUInt32 i = 0; i < uiNumLevels; ++i)
+      {
+        m_TransformUpdateTasks[i]->Execute();
+      }
+
+      return;
+    }
+
+    ezTaskSystem::WaitForGroup(m_TransformUpdateGraph.Launch(ezTaskPriority::EarlyThisFrame));
   }
 
   void WorldData::ResourceEventHandler(const ezResourceEvent& e)
@@ -5,6 +5,7 @@
 #include <Foundation/Math/Random.h>
 #include <Foundation/Memory/FrameAllocator.h>
 #include <Foundation/Threading/DelegateTask.h>
+#include <Foundation/Threading/TaskGraph.h>
 #include <Foundation/Time/Clock.h>
 #include <Foundation/Types/SharedPtr.h>
 
@@ -126,8 +127,10 @@ namespace ezInternal
 
     template <typename VISITOR>
     static ezVisitorExecution::Enum TraverseHierarchyLevel(Hierarchy::DataBlockArray& blocks, void* pUserData = nullptr);
+
+    /// \brief Same as TraverseHierarchyLevel but passes whole runs of transformation data to VISITOR::VisitBatch instead of single entries.
     template <typename VISITOR>
-    ezVisitorExecution::Enum TraverseHierarchyLevelMultiThreaded(Hierarchy::DataBlockArray& blocks, void* pUserData = nullptr);
+    static void TraverseHierarchyLevelBatched(Hierarchy::DataBlockArray& blocks, void* pUserData = nullptr);
 
     using VisitorFunc = ezDelegate<ezVisitorExecution::Enum(ezGameObject*)>;
     void TraverseBreadthFirst(VisitorFunc& func);
@@ -140,8 +143,35 @@ namespace ezInternal
     static void UpdateGlobalTransformAndSpatialData(ezGameObject::TransformationData* pData, ezUInt32 uiUpdateCounter, ezSpatialSystem& spatialSystem);
     static void UpdateGlobalTransformWithParentAndSpatialData(ezGameObject::TransformationData* pData, ezUInt32 uiUpdateCounter, ezSpatialSystem& spatialSystem);
 
+    /// \brief Updates global transforms and bounds of uiCount consecutive entries. Four entries at a time are transposed into
+    /// structure-of-arrays form, so that every SIMD instruction computes one component of four transforms at once.
+    template <bool WITH_PARENT>
+    static void UpdateGlobalTransformsBatched(ezGameObject::TransformationData* pData, ezUInt32 uiCount, ezUInt32 uiUpdateCounter, ezSpatialSystem* pSpatialSystem);
+
     void UpdateGlobalTransforms();
 
+    /// \brief Updates the dynamic hierarchy on multiple threads. Only possible without a spatial system, which would require a write lock.
+    ///
+    /// Every hierarchy level is one node in m_TransformUpdateGraph that depends on the level above it. The whole hierarchy is thus
+    /// launched and waited for once, instead of once per level. The graph is only rebuilt when the number of levels changes.
+    void UpdateGlobalTransformsMultiThreaded(bool bBatched);
+
+    struct TransformUpdateTask final : public ezTask
+    {
+      virtual void Execute() override;
+      virtual void ExecuteWithMultiplicity(ezUInt32 uiInvocation) const override;
+
+      void UpdateBlocks(ezUInt32 uiFirstBlock, ezUInt32 uiNumBlocks) const;
+
+      WorldData* m_pWorldData = nullptr;
+      ezUInt32 m_uiHierarchyLevel = 0;
+      ezUInt32 m_uiBlocksPerInvocation = 0;
+      bool m_bBatched = false;
+    };
+
+    ezDynamicArray<ezSharedPtr<TransformUpdateTask>, ezLocalAllocatorWrapper> m_TransformUpdateTasks;
+    ezTaskGraph m_TransformUpdateGraph;
+
     void ResourceEventHandler(const ezResourceEvent& e);
 
     // game object lookups
@@ -232,10 +262,74 @@ namespace ezInternal
     };
 
     using MessageQueue = ezMessageQueue<QueuedMsgMetaData, ezLocalAllocatorWrapper>;
+
+    /// \brief Everything a queued message is sorted by, gathered once per message so that sorting needs no virtual calls and no deque access.
+    struct MessageSortKey
+    {
+      EZ_DECLARE_POD_TYPE();
+
+      ezUInt64 m_uiReceiverData;
+      ezUInt64 m_uiMessageHash;
+      ezInt32 m_iSortingKey;
+      ezMessageId m_MsgId;
+      MessageQueue::Entry* m_pEntry;
+    };
+
     mutable MessageQueue m_MessageQueues[ezObjectMsgQueueType::COUNT];
     mutable MessageQueue m_TimedMessageQueues[ezObjectMsgQueueType::COUNT];
     ezObjectMsgQueueType::Enum m_ProcessingMessageQueue = ezObjectMsgQueueType::COUNT;
 
+    /// \brief Messages that are posted from a thread are collected in a buffer owned by that thread without any locking.
+    ///
+    /// The buffers are merged into the message queues above at the beginning of ProcessQueuedMessages.
+    /// Regular messages are cloned into the buffer's own stack allocator so threads don't contend on the world's stack allocator either.
+    struct ThreadMessageBuffer
+    {
+      ThreadMessageBuffer(ezStringView sName);
+
+      /// \brief Stack allocator for message clones. Unlike ezLinearAllocator it doesn't support individual deallocations and thus only
+      /// needs to remember the destructors of the clones, which keeps cloning cheap.
+      class CloneAllocator : public ezAllocatorWithPolicy<ezAllocPolicyStack, ezAllocatorTrackingMode::Basics>
+      {
+      public:
+        CloneAllocator(ezStringView sName, ezAllocator* pParent);
+        ~CloneAllocator();
+
+        virtual void* Allocate(size_t uiSize, size_t uiAlign, ezMemoryUtils::DestructorFunction destructorFunc) override;
+        virtual void Deallocate(void* pPtr) override;
+
+        void Reset();
+
+      private:
+        struct DestructData
+        {
+          EZ_DECLARE_POD_TYPE();
+
+          ezMemoryUtils::DestructorFunction m_Func;
+          void* m_Ptr;
+        };
+
+        ezDynamicArray<DestructData> m_DestructData;
+      };
+
+      void SwapAllocators();
+
+      CloneAllocator m_Allocator0;
+      CloneAllocator m_Allocator1;
+      CloneAllocator* m_pCurrentAllocator = &m_Allocator0;
+      ezDynamicArray<MessageQueue::Entry> m_Messages[ezObjectMsgQueueType::COUNT];
+      ezDynamicArray<MessageQueue::Entry> m_TimedMessages[ezObjectMsgQueueType::COUNT];
+    };
+
+    static constexpr ezUInt32 MAX_THREAD_MESSAGE_BUFFERS = 64;
+    mutable ThreadMessageBuffer* m_ThreadMessageBuffers[MAX_THREAD_MESSAGE_BUFFERS] = {};
+
+    /// \brief Returns the message buffer of the calling thread. Returns nullptr if more than MAX_THREAD_MESSAGE_BUFFERS threads are alive,
+    /// in which case the message has to be put into the shared message queue instead.
+    ThreadMessageBuffer* GetThreadMessageBuffer() const;
+    void MergeThreadMessageBuffers(ezObjectMsgQueueType::Enum queueType);
+    void SwapThreadMessageAllocators();
+
     ezThreadID m_WriteThreadID;
     ezInt32 m_iWriteCounter = 0;
     mutable ezAtomicInteger32 m_iReadCounter;
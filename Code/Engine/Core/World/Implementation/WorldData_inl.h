@@ -31,32 +31,12 @@ namespace ezInternal
 
   // static
   template <typename VISITOR>
-  EZ_FORCE_INLINE ezVisitorExecution::Enum WorldData::TraverseHierarchyLevelMultiThreaded(
-    Hierarchy::DataBlockArray& blocks, void* pUserData /* = nullptr*/)
+  EZ_FORCE_INLINE void WorldData::TraverseHierarchyLevelBatched(Hierarchy::DataBlockArray& blocks, void* pUserData /* = nullptr*/)
   {
-    ezParallelForParams parallelForParams;
-    parallelForParams.m_uiBinSize = 100;
-    parallelForParams.m_uiMaxTasksPerThread = 2;
-    parallelForParams.m_pTaskAllocator = m_StackAllocator.GetCurrentAllocator();
-
-    ezTaskSystem::ParallelFor(
-      blocks.GetArrayPtr(),
-      [pUserData](ezArrayPtr<WorldData::Hierarchy::DataBlock> blocksSlice) {
-        for (WorldData::Hierarchy::DataBlock& block : blocksSlice)
-        {
-          ezGameObject::TransformationData* pCurrentData = block.m_pData;
-          ezGameObject::TransformationData* pEndData = block.m_pData + block.m_uiCount;
-
-          while (pCurrentData < pEndData)
-          {
-            VISITOR::Visit(pCurrentData, pUserData);
-            ++pCurrentData;
-          }
-        }
-      },
-      "World DataBlock Traversal Task", parallelForParams);
-
-    return ezVisitorExecution::Continue;
+    for (WorldData::Hierarchy::DataBlock& block : blocks)
+    {
+      VISITOR::VisitBatch(block.m_pData, block.m_uiCount, pUserData);
+    }
   }
 
   // static
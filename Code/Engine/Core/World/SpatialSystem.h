@@ -65,7 +65,22 @@ public:
 
   using IsOccludedFunc = ezDelegate<bool(const ezSimdBBox&)>;
 
-  virtual void FindVisibleObjects(const ezFrustum& frustum, const QueryParams& queryParams, ezDynamicArray<const ezGameObject*>& out_objects, IsOccludedFunc isOccluded, ezVisibilityState visType) const = 0;
+  /// \brief Batch version of IsOccludedFunc. Has to write to out_occluded[i] whether boxes[i] is fully occluded.
+  using AreOccludedFunc = ezDelegate<void(ezArrayPtr<const ezSimdBBox> boxes, ezArrayPtr<bool> out_occluded)>;
+
+  /// \brief Finds all objects that intersect the frustum and are not occluded.
+  ///
+  /// If areOccluded is valid, it is preferred over isOccluded and called with whole blocks of objects at once, which is usually much cheaper than
+  /// testing each object individually.
+  virtual void FindVisibleObjects(const ezFrustum& frustum, const QueryParams& queryParams, ezDynamicArray<const ezGameObject*>& out_objects, IsOccludedFunc isOccluded, ezVisibilityState visType, AreOccludedFunc areOccluded = {}) const = 0;
+
+  /// \brief Finds all objects that intersect any of the given frustums in one pass, e.g. for all shadow views of a light.
+  ///
+  /// The objects that intersect frustums[i] are appended to *out_objects[i]. Implementations load the bounds of each cell or node only once and test
+  /// them against all frustums while they are in the cache. The result for each frustum may contain a few more objects close to the frustum borders than
+  /// FindVisibleObjects would return. There is no occlusion culling, views that need it should use FindVisibleObjects instead.
+  /// The default implementation calls FindVisibleObjects once per frustum.
+  virtual void FindVisibleObjectsMultiView(ezArrayPtr<const ezFrustum> frustums, const QueryParams& queryParams, ezArrayPtr<ezDynamicArray<const ezGameObject*>* const> out_objects, ezVisibilityState visType) const;
 
   /// \brief Retrieves a state describing how visible the object is.
   ///
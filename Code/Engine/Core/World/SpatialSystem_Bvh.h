@@ -0,0 +1,98 @@
+#pragma once
+
+#include <Core/World/SpatialSystem.h>
+#include <Foundation/Containers/IdTable.h>
+
+/// \brief A spatial system that stores all spatial data in a single dynamic bounding volume hierarchy.
+///
+/// Every node of the hierarchy has up to four children whose bounds are stored in SoA layout, so that all children of a node are tested
+/// with one set of SIMD instructions. Each child additionally stores the combined category bitmask of its subtree, which allows queries
+/// to skip entire subtrees that do not contain any object of the requested categories.
+///
+/// Inserted objects are sorted into the hierarchy greedily and moving objects only refit the nodes above them. Since this slowly degrades
+/// the quality of the hierarchy, it is rebuilt from scratch in StartNewFrame() once enough changes have accumulated.
+///
+/// Compared to ezSpatialSystem_RegularGrid, the hierarchy does not depend on a fixed cell size and thus handles scenes with widely
+/// varying object sizes or large empty areas better.
+class EZ_CORE_DLL ezSpatialSystem_Bvh : public ezSpatialSystem
+{
+  EZ_ADD_DYNAMIC_REFLECTION(ezSpatialSystem_Bvh, ezSpatialSystem);
+
+public:
+  ezSpatialSystem_Bvh();
+  ~ezSpatialSystem_Bvh();
+
+  /// \brief Returns the bounding boxes of all nodes in the hierarchy. Useful for debug visualizations.
+  void GetAllNodeBoxes(ezDynamicArray<ezBoundingBox>& out_boundingBoxes) const;
+
+private:
+  // ezSpatialSystem implementation
+  virtual void StartNewFrame() override;
+
+  ezSpatialDataHandle CreateSpatialData(const ezSimdBBoxSphere& bounds, ezGameObject* pObject, ezUInt32 uiCategoryBitmask, const ezTagSet& tags) override;
+  ezSpatialDataHandle CreateSpatialDataAlwaysVisible(ezGameObject* pObject, ezUInt32 uiCategoryBitmask, const ezTagSet& tags) override;
+
+  void DeleteSpatialData(const ezSpatialDataHandle& hData) override;
+
+  void UpdateSpatialDataBounds(const ezSpatialDataHandle& hData, const ezSimdBBoxSphere& bounds) override;
+  void UpdateSpatialDataObject(const ezSpatialDataHandle& hData, ezGameObject* pObject) override;
+
+  void FindObjectsInSphere(const ezBoundingSphere& sphere, const QueryParams& queryParams, QueryCallback callback) const override;
+  void FindObjectsInBox(const ezBoundingBox& box, const QueryParams& queryParams, QueryCallback callback) const override;
+
+  void FindVisibleObjects(const ezFrustum& frustum, const QueryParams& queryParams, ezDynamicArray<const ezGameObject*>& out_Objects, ezSpatialSystem::IsOccludedFunc IsOccluded, ezVisibilityState visType, ezSpatialSystem::AreOccludedFunc AreOccluded = {}) const override;
+
+  ezVisibilityState GetVisibilityState(const ezSpatialDataHandle& hData, ezUInt32 uiNumFramesBeforeInvisible) const override;
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  virtual void GetInternalStats(ezStringBuilder& sb) const override;
+#endif
+
+  ezProxyAllocator m_AlignedAllocator;
+
+  struct Data
+  {
+    ezSimdBBoxSphere m_Bounds;
+    ezTagSet m_Tags;
+    ezGameObject* m_pObject = nullptr;
+    ezUInt32 m_uiCategoryBitmask = 0;
+    ezUInt32 m_uiNodeIndex = ezInvalidIndex; ///< ezInvalidIndex for always visible data
+    ezUInt32 m_uiNodeSlot = 0;
+    bool m_bMoved = false; ///< whether the data ever left its node bounds, moving data gets some slack in the hierarchy
+    mutable ezAtomicInteger64 m_LastVisibleFrameIdxAndVisType;
+  };
+
+  ezIdTable<ezSpatialDataId, Data, ezLocalAllocatorWrapper> m_DataTable;
+  ezDynamicArray<ezUInt32> m_AlwaysVisibleData;
+
+  struct Node;
+  ezDynamicArray<Node> m_Nodes;
+  ezDynamicArray<ezUInt32> m_FreeNodes;
+  ezUInt32 m_uiRootNode = ezInvalidIndex;
+
+  ezUInt32 m_uiNumChangesSinceRebuild = 0;
+  ezUInt32 m_uiNumRebuilds = 0;
+
+  ezUInt32 AllocateNode(ezUInt32 uiParent, ezUInt32 uiParentSlot);
+  void FreeNode(ezUInt32 uiNodeIndex);
+
+  void SetChild(ezUInt32 uiNodeIndex, ezUInt32 uiSlot, ezUInt32 uiChild, const ezSimdBBox& box, const ezSimdBSphere& sphere, ezUInt32 uiCategoryBitmask);
+  void MoveChild(ezUInt32 uiNodeIndex, ezUInt32 uiTargetSlot, ezUInt32 uiSourceSlot);
+  void RemoveChild(ezUInt32 uiNodeIndex, ezUInt32 uiSlot);
+  void Refit(ezUInt32 uiNodeIndex);
+
+  void InsertIntoTree(ezUInt32 uiDataIndex, const ezSimdBBox& box);
+  void RemoveFromTree(ezUInt32 uiDataIndex);
+
+  struct BuildItem;
+  ezDynamicArray<BuildItem> m_BuildItems;
+
+  void Rebuild();
+  void BuildNode(ezUInt32 uiNodeIndex, ezArrayPtr<BuildItem> items);
+
+  template <typename ChildTestFunc, typename DataFunc>
+  ezVisitorExecution::Enum Traverse(ezUInt32 uiCategoryBitmask, ChildTestFunc childTest, DataFunc dataFunc) const;
+
+  template <typename Shape, typename ChildTestFunc>
+  void FindObjectsInShape(const Shape& shape, const QueryParams& queryParams, QueryCallback callback, ChildTestFunc childTest) const;
+};
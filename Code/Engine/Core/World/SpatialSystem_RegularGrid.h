@@ -41,7 +41,8 @@ private:
   void FindObjectsInSphere(const ezBoundingSphere& sphere, const QueryParams& queryParams, QueryCallback callback) const override;
   void FindObjectsInBox(const ezBoundingBox& box, const QueryParams& queryParams, QueryCallback callback) const override;
 
-  void FindVisibleObjects(const ezFrustum& frustum, const QueryParams& queryParams, ezDynamicArray<const ezGameObject*>& out_Objects, ezSpatialSystem::IsOccludedFunc IsOccluded, ezVisibilityState visType) const override;
+  void FindVisibleObjects(const ezFrustum& frustum, const QueryParams& queryParams, ezDynamicArray<const ezGameObject*>& out_Objects, ezSpatialSystem::IsOccludedFunc IsOccluded, ezVisibilityState visType, ezSpatialSystem::AreOccludedFunc AreOccluded = {}) const override;
+  void FindVisibleObjectsMultiView(ezArrayPtr<const ezFrustum> frustums, const QueryParams& queryParams, ezArrayPtr<ezDynamicArray<const ezGameObject*>* const> out_Objects, ezVisibilityState visType) const override;
 
   ezVisibilityState GetVisibilityState(const ezSpatialDataHandle& hData, ezUInt32 uiNumFramesBeforeInvisible) const override;
 
@@ -59,7 +60,8 @@ private:
   {
     MAX_NUM_GRIDS = 63,
     MAX_NUM_REGULAR_GRIDS = (sizeof(ezSpatialData::Category::m_uiValue) * 8),
-    MAX_NUM_CACHED_GRIDS = MAX_NUM_GRIDS - MAX_NUM_REGULAR_GRIDS
+    MAX_NUM_CACHED_GRIDS = MAX_NUM_GRIDS - MAX_NUM_REGULAR_GRIDS,
+    MAX_NUM_VIEWS_PER_PASS = 32
   };
 
   struct Cell;
@@ -88,6 +90,28 @@ private:
   using CellCallback = ezDelegate<ezVisitorExecution::Enum(const Cell&, const QueryParams&, Stats&, void*, ezVisibilityState)>;
   void ForEachCellInBoxInMatchingGrids(const ezSimdBBox& box, const QueryParams& queryParams, CellCallback noFilterCallback, CellCallback filterByTagsCallback, void* pUserData, ezVisibilityState visType) const;
 
+  template <typename Functor>
+  void ForEachMatchingGrid(const QueryParams& queryParams, CellCallback noFilterCallback, CellCallback filterByTagsCallback, Functor func) const;
+
+  /// \brief Frustum culls the cells of the given grid on multiple threads if there are enough objects to make it worthwhile. Returns the number of chunks that were used.
+  ezUInt32 CullCellsInGrid(const Grid& grid, const ezSimdBBox& box, CellCallback cellCallback, const QueryParams& queryParams, Stats& ref_stats, void* pUserData, ezVisibilityState visType) const;
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  struct CullingStats
+  {
+    ezTime m_TimeTaken;
+    ezUInt32 m_uiNumObjectsTested = 0;
+    ezUInt32 m_uiNumObjectsPassed = 0;
+    ezUInt32 m_uiNumChunks = 0;
+    ezUInt32 m_uiNumViews = 1;
+    ezVisibilityState m_VisType = ezVisibilityState::Invisible;
+  };
+
+  mutable ezDynamicArray<CullingStats> m_CullingStats;
+  ezDynamicArray<CullingStats> m_LastFrameCullingStats;
+  mutable ezMutex m_CullingStatsMutex;
+#endif
+
   struct CacheCandidate
   {
     ezTagSet m_IncludeTags;
@@ -392,8 +392,10 @@ private:
   ezStringView GetObjectGlobalKey(const ezGameObject* pObject) const;
 
   void PostMessage(const ezGameObjectHandle& receiverObject, const ezMessage& msg, ezObjectMsgQueueType::Enum queueType, ezTime delay, bool bRecursive) const;
+  void EnqueueMessage(const ezMessage& msg, ezInternal::WorldData::QueuedMsgMetaData& metaData, ezObjectMsgQueueType::Enum queueType, ezTime delay) const;
   void ProcessQueuedMessage(const ezInternal::WorldData::MessageQueue::Entry& entry);
   void ProcessQueuedMessages(ezObjectMsgQueueType::Enum queueType);
+  void ProcessQueuedMessagesBatched(ezArrayPtr<const ezInternal::WorldData::MessageSortKey> sortedMessages);
 
   template <typename World, typename GameObject, typename Component>
   static void FindEventMsgHandlers(World& world, const ezMessage& msg, GameObject pSearchObject, ezDynamicArray<Component>& out_components);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Foundation/Strings/HashedString.h>
+#include <Foundation/Types/Enum.h>
 #include <Foundation/Types/SharedPtr.h>
 #include <Foundation/Types/UniquePtr.h>
 
@@ -9,6 +10,20 @@
 
 class ezTimeStepSmoothing;
 
+/// \brief Selects the spatial system that a world creates when none is passed in through ezWorldDesc::m_pSpatialSystem.
+struct ezSpatialSystemType
+{
+  using StorageType = ezUInt8;
+
+  enum Enum : StorageType
+  {
+    RegularGrid, ///< ezSpatialSystem_RegularGrid
+    Bvh,         ///< ezSpatialSystem_Bvh, better suited for scenes with widely varying object sizes or large empty areas
+
+    Default = RegularGrid
+  };
+};
+
 /// \brief Describes the initial state of a world.
 struct ezWorldDesc
 {
@@ -21,6 +36,7 @@ struct ezWorldDesc
 
   ezUniquePtr<ezSpatialSystem> m_pSpatialSystem;
   bool m_bAutoCreateSpatialSystem = true; ///< automatically create a default spatial system if none is set
+  ezEnum<ezSpatialSystemType> m_SpatialSystemType; ///< the type of spatial system that is created if m_bAutoCreateSpatialSystem is set
 
   ezSharedPtr<ezCoordinateSystemProvider> m_pCoordinateSystemProvider;
   ezUniquePtr<ezTimeStepSmoothing> m_pTimeStepSmoothing; ///< if nullptr, ezDefaultTimeStepSmoothing will be used
@@ -0,0 +1,373 @@
+#pragma once
+
+#include <Foundation/Algorithm/HashingUtils.h>
+#include <Foundation/IO/Stream.h>
+#include <Foundation/Math/Math.h>
+#include <Foundation/Memory/AllocatorWrapper.h>
+
+#if EZ_SIMD_IMPLEMENTATION == EZ_SIMD_IMPLEMENTATION_SSE
+#  include <emmintrin.h>
+#elif EZ_SIMD_IMPLEMENTATION == EZ_SIMD_IMPLEMENTATION_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace ezInternal
+{
+  /// \brief A group of 16 control bytes of an ezFlatHashTable, which are compared all at once.
+  ///
+  /// The match functions return a bitmask with one set bit per matching control byte.
+  /// Depending on the SIMD implementation each control byte may be represented by more than one bit in the mask, use GetIndex() to
+  /// convert the position of the lowest set bit to a control byte index.
+  struct ezFlatHashTableGroup
+  {
+    enum : ezUInt8
+    {
+      CONTROL_EMPTY = 0x80,
+      CONTROL_DELETED = 0xFE,
+    };
+
+    static constexpr ezUInt32 Size = 16;
+
+    EZ_ALWAYS_INLINE explicit ezFlatHashTableGroup(const ezUInt8* pControlBytes);
+
+    /// \brief Returns a mask of all control bytes that are equal to \a uiH2.
+    EZ_ALWAYS_INLINE ezUInt64 Match(ezUInt8 uiH2) const;
+
+    /// \brief Returns a mask of all empty slots.
+    EZ_ALWAYS_INLINE ezUInt64 MatchEmpty() const;
+
+    /// \brief Returns a mask of all slots that are either empty or deleted.
+    EZ_ALWAYS_INLINE ezUInt64 MatchEmptyOrDeleted() const;
+
+    /// \brief Returns a mask of all slots that hold a valid entry.
+    EZ_ALWAYS_INLINE ezUInt64 MatchFull() const;
+
+    /// \brief Returns the control byte index for the lowest bit in a (non-zero) match mask.
+    EZ_ALWAYS_INLINE static ezUInt32 GetIndex(ezUInt64 uiMask);
+
+    /// \brief Returns a mask that only contains the slots with index \a uiIndex and above.
+    EZ_ALWAYS_INLINE static ezUInt64 GetMaskFrom(ezUInt32 uiIndex);
+
+#if EZ_SIMD_IMPLEMENTATION == EZ_SIMD_IMPLEMENTATION_SSE
+    __m128i m_Control;
+#elif EZ_SIMD_IMPLEMENTATION == EZ_SIMD_IMPLEMENTATION_NEON
+    uint8x16_t m_Control;
+#else
+    ezUInt8 m_Control[Size];
+#endif
+  };
+} // namespace ezInternal
+
+/// \brief Implementation of a hashtable which stores key/value pairs, optimized for fast lookups.
+///
+/// This is a drop-in alternative to ezHashTable with the same interface, so call sites can switch between the two by changing the type.
+///
+/// Like ezHashTable it uses open addressing, but it stores one control byte per entry in a separate array. A control byte either marks the
+/// entry as empty or deleted, or it stores 7 bits of the entry's hash. Lookups compare a whole group of 16 control bytes with a single SIMD
+/// instruction and only compare the keys of entries whose hash bits match. Because of that, most lookups touch one cache line of control bytes
+/// and a single entry, even at high load. The table is resized when the load gets greater than 87.5%.
+///
+/// Prefer this container for large, lookup-heavy tables. For small tables that are mostly iterated, ezHashTable is just as good.
+
+/// \see ezHashTable
+template <typename KeyType, typename ValueType, typename Hasher>
+class ezFlatHashTableBase
+{
+public:
+  /// \brief Const iterator.
+  struct ConstIterator
+  {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = ConstIterator;
+    using difference_type = std::ptrdiff_t;
+    using pointer = ConstIterator*;
+    using reference = ConstIterator&;
+
+    EZ_DECLARE_POD_TYPE();
+
+    /// \brief Checks whether this iterator points to a valid element.
+    bool IsValid() const; // [tested]
+
+    /// \brief Checks whether the two iterators point to the same element.
+    bool operator==(const typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::ConstIterator& rhs) const;
+    EZ_ADD_DEFAULT_OPERATOR_NOTEQUAL(const typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::ConstIterator&);
+
+    /// \brief Returns the 'key' of the element that this iterator points to.
+    const KeyType& Key() const; // [tested]
+
+    /// \brief Returns the 'value' of the element that this iterator points to.
+    const ValueType& Value() const; // [tested]
+
+    /// \brief Advances the iterator to the next element in the map. The iterator will not be valid anymore, if the end is reached.
+    void Next(); // [tested]
+
+    /// \brief Shorthand for 'Next'
+    void operator++(); // [tested]
+
+    /// \brief Returns '*this' to enable foreach
+    EZ_ALWAYS_INLINE ConstIterator& operator*() { return *this; } // [tested]
+
+  protected:
+    friend class ezFlatHashTableBase<KeyType, ValueType, Hasher>;
+
+    explicit ConstIterator(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& hashTable);
+    void SetToBegin();
+    void SetToEnd();
+
+    const ezFlatHashTableBase<KeyType, ValueType, Hasher>* m_pHashTable = nullptr;
+    ezUInt32 m_uiCurrentIndex = 0; // current element index that this iterator points to.
+    ezUInt32 m_uiCurrentCount = 0; // current number of valid elements that this iterator has found so far.
+  };
+
+  /// \brief Iterator with write access.
+  struct Iterator : public ConstIterator
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    /// \brief Creates a new iterator from another.
+    EZ_ALWAYS_INLINE Iterator(const Iterator& rhs); // [tested]
+
+    /// \brief Assigns one iterator no another.
+    EZ_ALWAYS_INLINE void operator=(const Iterator& rhs); // [tested]
+
+    // this is required to pull in the const version of this function
+    using ConstIterator::Value;
+
+    /// \brief Returns the 'value' of the element that this iterator points to.
+    EZ_FORCE_INLINE ValueType& Value(); // [tested]
+
+    /// \brief Returns '*this' to enable foreach
+    EZ_ALWAYS_INLINE Iterator& operator*() { return *this; } // [tested]
+
+  private:
+    friend class ezFlatHashTableBase<KeyType, ValueType, Hasher>;
+
+    explicit Iterator(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& hashTable);
+  };
+
+protected:
+  /// \brief Creates an empty hashtable. Does not allocate any data yet.
+  explicit ezFlatHashTableBase(ezAllocator* pAllocator); // [tested]
+
+  /// \brief Creates a copy of the given hashtable.
+  ezFlatHashTableBase(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& rhs, ezAllocator* pAllocator); // [tested]
+
+  /// \brief Moves data from an existing hashtable into this one.
+  ezFlatHashTableBase(ezFlatHashTableBase<KeyType, ValueType, Hasher>&& rhs, ezAllocator* pAllocator); // [tested]
+
+  /// \brief Destructor.
+  ~ezFlatHashTableBase(); // [tested]
+
+  /// \brief Copies the data from another hashtable into this one.
+  void operator=(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& rhs); // [tested]
+
+  /// \brief Moves data from an existing hashtable into this one.
+  void operator=(ezFlatHashTableBase<KeyType, ValueType, Hasher>&& rhs); // [tested]
+
+public:
+  /// \brief Compares this table to another table.
+  bool operator==(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& rhs) const; // [tested]
+  EZ_ADD_DEFAULT_OPERATOR_NOTEQUAL(const ezFlatHashTableBase<KeyType, ValueType, Hasher>&);
+
+  /// \brief Expands the hashtable by over-allocating the internal storage so that the given number of entries can be inserted without
+  /// another allocation.
+  void Reserve(ezUInt32 uiCapacity); // [tested]
+
+  /// \brief Tries to compact the hashtable to avoid wasting memory.
+  ///
+  /// The resulting capacity is at least 'GetCount' (no elements get removed).
+  /// Will deallocate all data, if the hashtable is empty.
+  void Compact(); // [tested]
+
+  /// \brief Returns the number of active entries in the table.
+  ezUInt32 GetCount() const; // [tested]
+
+  /// \brief Returns true, if the hashtable does not contain any elements.
+  bool IsEmpty() const; // [tested]
+
+  /// \brief Clears the table.
+  void Clear(); // [tested]
+
+  /// \brief Inserts the key value pair or replaces value if an entry with the given key already exists.
+  ///
+  /// Returns true if an existing value was replaced and optionally writes out the old value to out_oldValue.
+  template <typename CompatibleKeyType, typename CompatibleValueType>
+  bool Insert(CompatibleKeyType&& key, CompatibleValueType&& value, ValueType* out_pOldValue = nullptr); // [tested]
+
+  /// \brief Removes the entry with the given key. Returns whether an entry was removed and optionally writes out the old value to out_oldValue.
+  template <typename CompatibleKeyType>
+  bool Remove(const CompatibleKeyType& key, ValueType* out_pOldValue = nullptr); // [tested]
+
+  /// \brief Erases the key/value pair at the given Iterator. Returns an iterator to the element after the given iterator.
+  Iterator Remove(const Iterator& pos); // [tested]
+
+  /// \brief Cannot remove an element with just a ConstIterator
+  void Remove(const ConstIterator& pos) = delete;
+
+  /// \brief Returns whether an entry with the given key was found and if found writes out the corresponding value to out_value.
+  template <typename CompatibleKeyType>
+  bool TryGetValue(const CompatibleKeyType& key, ValueType& out_value) const; // [tested]
+
+  /// \brief Returns whether an entry with the given key was found and if found writes out the pointer to the corresponding value to out_pValue.
+  template <typename CompatibleKeyType>
+  bool TryGetValue(const CompatibleKeyType& key, const ValueType*& out_pValue) const; // [tested]
+
+  /// \brief Returns whether an entry with the given key was found and if found writes out the pointer to the corresponding value to out_pValue.
+  template <typename CompatibleKeyType>
+  bool TryGetValue(const CompatibleKeyType& key, ValueType*& out_pValue) const; // [tested]
+
+  /// \brief Searches for key, returns a ConstIterator to it or an invalid iterator, if no such key is found. O(1) operation.
+  template <typename CompatibleKeyType>
+  ConstIterator Find(const CompatibleKeyType& key) const;
+
+  /// \brief Searches for key, returns an Iterator to it or an invalid iterator, if no such key is found. O(1) operation.
+  template <typename CompatibleKeyType>
+  Iterator Find(const CompatibleKeyType& key);
+
+  /// \brief Returns a pointer to the value of the entry with the given key if found, otherwise returns nullptr.
+  template <typename CompatibleKeyType>
+  const ValueType* GetValue(const CompatibleKeyType& key) const; // [tested]
+
+  /// \brief Returns a pointer to the value of the entry with the given key if found, otherwise returns nullptr.
+  template <typename CompatibleKeyType>
+  ValueType* GetValue(const CompatibleKeyType& key); // [tested]
+
+  /// \brief Returns the value to the given key if found or creates a new entry with the given key and a default constructed value.
+  ValueType& operator[](const KeyType& key); // [tested]
+
+  /// \brief Returns the value stored at the given key. If none exists, one is created. \a bExisted indicates whether an element needed to be created.
+  ValueType& FindOrAdd(const KeyType& key, bool* out_pExisted); // [tested]
+
+  /// \brief Returns if an entry with given key exists in the table.
+  template <typename CompatibleKeyType>
+  bool Contains(const CompatibleKeyType& key) const; // [tested]
+
+  /// \brief Returns an Iterator to the very first element.
+  Iterator GetIterator(); // [tested]
+
+  /// \brief Returns an Iterator to the first element that is not part of the hash-table. Needed to support range based for loops.
+  Iterator GetEndIterator(); // [tested]
+
+  /// \brief Returns a constant Iterator to the very first element.
+  ConstIterator GetIterator() const; // [tested]
+
+  /// \brief Returns a ConstIterator to the first element that is not part of the hash-table. Needed to support range based for loops.
+  ConstIterator GetEndIterator() const; // [tested]
+
+  /// \brief Returns the allocator that is used by this instance.
+  ezAllocator* GetAllocator() const;
+
+  /// \brief Returns the amount of bytes that are currently allocated on the heap.
+  ezUInt64 GetHeapMemoryUsage() const; // [tested]
+
+  /// \brief Swaps this map with the other one.
+  void Swap(ezFlatHashTableBase<KeyType, ValueType, Hasher>& other); // [tested]
+
+
+private:
+  struct Entry
+  {
+    KeyType key;
+    ValueType value;
+  };
+
+  using Group = ezInternal::ezFlatHashTableGroup;
+
+  Entry* m_pEntries;
+  ezUInt8* m_pControlBytes;
+
+  ezUInt32 m_uiCount;
+  ezUInt32 m_uiCapacity;
+
+  /// Number of empty entries that can still be filled before the table needs to be resized or cleaned up from deleted entries.
+  ezUInt32 m_uiGrowthLeft;
+
+  ezAllocator* m_pAllocator;
+
+  static ezUInt32 GetMaxLoad(ezUInt32 uiCapacity);
+  static ezUInt32 GetCapacityForCount(ezUInt32 uiCount);
+  static void SplitHash(ezUInt32 uiHash, ezUInt32& out_uiH1, ezUInt8& out_uiH2);
+
+  void SetCapacity(ezUInt32 uiCapacity);
+
+  void RemoveInternal(ezUInt32 uiIndex);
+
+  /// \brief Returns the index of an empty or deleted entry where an element with the given hash can be inserted. Resizes the table if necessary.
+  ezUInt32 PrepareInsert(ezUInt32 uiHash);
+
+  ezUInt32 FindFirstNonFull(ezUInt32 uiH1) const;
+
+  /// \brief Returns the index of the first valid entry at or after \a uiStartIndex, or the capacity, if there is none.
+  ezUInt32 FindNextValidEntry(ezUInt32 uiStartIndex) const;
+
+  template <typename CompatibleKeyType>
+  ezUInt32 FindEntry(const CompatibleKeyType& key) const;
+
+  template <typename CompatibleKeyType>
+  ezUInt32 FindEntry(ezUInt32 uiHash, const CompatibleKeyType& key) const;
+
+  bool IsValidEntry(ezUInt32 uiEntryIndex) const;
+};
+
+/// \brief \see ezFlatHashTableBase
+template <typename KeyType, typename ValueType, typename Hasher = ezHashHelper<KeyType>, typename AllocatorWrapper = ezDefaultAllocatorWrapper>
+class ezFlatHashTable : public ezFlatHashTableBase<KeyType, ValueType, Hasher>
+{
+public:
+  ezFlatHashTable();
+  explicit ezFlatHashTable(ezAllocator* pAllocator);
+
+  ezFlatHashTable(const ezFlatHashTable<KeyType, ValueType, Hasher, AllocatorWrapper>& other);
+  ezFlatHashTable(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& other);
+
+  ezFlatHashTable(ezFlatHashTable<KeyType, ValueType, Hasher, AllocatorWrapper>&& other);
+  ezFlatHashTable(ezFlatHashTableBase<KeyType, ValueType, Hasher>&& other);
+
+
+  void operator=(const ezFlatHashTable<KeyType, ValueType, Hasher, AllocatorWrapper>& rhs);
+  void operator=(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& rhs);
+
+  void operator=(ezFlatHashTable<KeyType, ValueType, Hasher, AllocatorWrapper>&& rhs);
+  void operator=(ezFlatHashTableBase<KeyType, ValueType, Hasher>&& rhs);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// begin() /end() for range-based for-loop support
+
+template <typename KeyType, typename ValueType, typename Hasher>
+typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::Iterator begin(ezFlatHashTableBase<KeyType, ValueType, Hasher>& ref_container)
+{
+  return ref_container.GetIterator();
+}
+
+template <typename KeyType, typename ValueType, typename Hasher>
+typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::ConstIterator begin(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& container)
+{
+  return container.GetIterator();
+}
+
+template <typename KeyType, typename ValueType, typename Hasher>
+typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::ConstIterator cbegin(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& container)
+{
+  return container.GetIterator();
+}
+
+template <typename KeyType, typename ValueType, typename Hasher>
+typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::Iterator end(ezFlatHashTableBase<KeyType, ValueType, Hasher>& ref_container)
+{
+  return ref_container.GetEndIterator();
+}
+
+template <typename KeyType, typename ValueType, typename Hasher>
+typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::ConstIterator end(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& container)
+{
+  return container.GetEndIterator();
+}
+
+template <typename KeyType, typename ValueType, typename Hasher>
+typename ezFlatHashTableBase<KeyType, ValueType, Hasher>::ConstIterator cend(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& container)
+{
+  return container.GetEndIterator();
+}
+
+#include <Foundation/Containers/Implementation/FlatHashTable_inl.h>
@@ -0,0 +1,987 @@
+/// \brief Value used by containers for indices to indicate an invalid index.
+#ifndef ezInvalidIndex
+#  define ezInvalidIndex 0xFFFFFFFF
+#endif
+
+// ***** Control byte group *****
+
+#if EZ_SIMD_IMPLEMENTATION == EZ_SIMD_IMPLEMENTATION_SSE
+
+EZ_ALWAYS_INLINE ezInternal::ezFlatHashTableGroup::ezFlatHashTableGroup(const ezUInt8* pControlBytes)
+{
+  m_Control = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pControlBytes));
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::Match(ezUInt8 uiH2) const
+{
+  return static_cast<ezUInt32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(uiH2)), m_Control)));
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::MatchEmpty() const
+{
+  return Match(CONTROL_EMPTY);
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::MatchEmptyOrDeleted() const
+{
+  // empty and deleted are the only control bytes with the high bit set
+  return static_cast<ezUInt32>(_mm_movemask_epi8(m_Control));
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::MatchFull() const
+{
+  return MatchEmptyOrDeleted() ^ 0xFFFFu;
+}
+
+EZ_ALWAYS_INLINE ezUInt32 ezInternal::ezFlatHashTableGroup::GetIndex(ezUInt64 uiMask)
+{
+  return ezMath::FirstBitLow(static_cast<ezUInt32>(uiMask));
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::GetMaskFrom(ezUInt32 uiIndex)
+{
+  return 0xFFFFu << uiIndex;
+}
+
+#elif EZ_SIMD_IMPLEMENTATION == EZ_SIMD_IMPLEMENTATION_NEON
+
+namespace ezInternal
+{
+  // NEON has no equivalent of _mm_movemask_epi8, narrowing every byte to 4 bits is the cheapest replacement.
+  // Only the highest bit of each nibble is kept, so that every control byte is represented by a single bit.
+  EZ_ALWAYS_INLINE ezUInt64 ezFlatHashTableNeonMask(uint8x16_t matches)
+  {
+    const uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(matches), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x8888888888888888ull;
+  }
+} // namespace ezInternal
+
+EZ_ALWAYS_INLINE ezInternal::ezFlatHashTableGroup::ezFlatHashTableGroup(const ezUInt8* pControlBytes)
+{
+  m_Control = vld1q_u8(pControlBytes);
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::Match(ezUInt8 uiH2) const
+{
+  return ezFlatHashTableNeonMask(vceqq_u8(vdupq_n_u8(uiH2), m_Control));
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::MatchEmpty() const
+{
+  return Match(CONTROL_EMPTY);
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::MatchEmptyOrDeleted() const
+{
+  return ezFlatHashTableNeonMask(vcltq_s8(vreinterpretq_s8_u8(m_Control), vdupq_n_s8(0)));
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::MatchFull() const
+{
+  return MatchEmptyOrDeleted() ^ 0x8888888888888888ull;
+}
+
+EZ_ALWAYS_INLINE ezUInt32 ezInternal::ezFlatHashTableGroup::GetIndex(ezUInt64 uiMask)
+{
+  return ezMath::FirstBitLow(uiMask) / 4;
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::GetMaskFrom(ezUInt32 uiIndex)
+{
+  return 0xFFFFFFFFFFFFFFFFull << (uiIndex * 4);
+}
+
+#else
+
+EZ_ALWAYS_INLINE ezInternal::ezFlatHashTableGroup::ezFlatHashTableGroup(const ezUInt8* pControlBytes)
+{
+  ezMemoryUtils::RawByteCopy(m_Control, pControlBytes, Size);
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::Match(ezUInt8 uiH2) const
+{
+  ezUInt64 uiMask = 0;
+  for (ezUInt32 i = 0; i < Size; ++i)
+  {
+    uiMask |= static_cast<ezUInt64>(m_Control[i] == uiH2) << i;
+  }
+  return uiMask;
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::MatchEmpty() const
+{
+  return Match(CONTROL_EMPTY);
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::MatchEmptyOrDeleted() const
+{
+  ezUInt64 uiMask = 0;
+  for (ezUInt32 i = 0; i < Size; ++i)
+  {
+    uiMask |= static_cast<ezUInt64>(m_Control[i] >> 7) << i;
+  }
+  return uiMask;
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::MatchFull() const
+{
+  return MatchEmptyOrDeleted() ^ 0xFFFFu;
+}
+
+EZ_ALWAYS_INLINE ezUInt32 ezInternal::ezFlatHashTableGroup::GetIndex(ezUInt64 uiMask)
+{
+  return ezMath::FirstBitLow(static_cast<ezUInt32>(uiMask));
+}
+
+EZ_ALWAYS_INLINE ezUInt64 ezInternal::ezFlatHashTableGroup::GetMaskFrom(ezUInt32 uiIndex)
+{
+  return 0xFFFFu << uiIndex;
+}
+
+#endif
+
+// ***** Const Iterator *****
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::ConstIterator::ConstIterator(const ezFlatHashTableBase<K, V, H>& hashTable)
+  : m_pHashTable(&hashTable)
+{
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::ConstIterator::SetToBegin()
+{
+  if (m_pHashTable->IsEmpty())
+  {
+    m_uiCurrentIndex = m_pHashTable->m_uiCapacity;
+    return;
+  }
+
+  m_uiCurrentIndex = m_pHashTable->FindNextValidEntry(0);
+}
+
+template <typename K, typename V, typename H>
+inline void ezFlatHashTableBase<K, V, H>::ConstIterator::SetToEnd()
+{
+  m_uiCurrentCount = m_pHashTable->m_uiCount;
+  m_uiCurrentIndex = m_pHashTable->m_uiCapacity;
+}
+
+
+template <typename K, typename V, typename H>
+EZ_FORCE_INLINE bool ezFlatHashTableBase<K, V, H>::ConstIterator::IsValid() const
+{
+  return m_uiCurrentCount < m_pHashTable->m_uiCount;
+}
+
+template <typename K, typename V, typename H>
+EZ_FORCE_INLINE bool ezFlatHashTableBase<K, V, H>::ConstIterator::operator==(const typename ezFlatHashTableBase<K, V, H>::ConstIterator& rhs) const
+{
+  return m_uiCurrentIndex == rhs.m_uiCurrentIndex && m_pHashTable->m_pEntries == rhs.m_pHashTable->m_pEntries;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE const K& ezFlatHashTableBase<K, V, H>::ConstIterator::Key() const
+{
+  return m_pHashTable->m_pEntries[m_uiCurrentIndex].key;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE const V& ezFlatHashTableBase<K, V, H>::ConstIterator::Value() const
+{
+  return m_pHashTable->m_pEntries[m_uiCurrentIndex].value;
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::ConstIterator::Next()
+{
+  // if we already iterated over the amount of valid elements that the hash-table stores, early out
+  if (m_uiCurrentCount >= m_pHashTable->m_uiCount)
+    return;
+
+  // increase the counter of how many elements we have seen
+  ++m_uiCurrentCount;
+
+  // skip over whole groups of empty and deleted entries
+  m_uiCurrentIndex = m_pHashTable->FindNextValidEntry(m_uiCurrentIndex + 1);
+
+  // if we reached the end of all elements in the container
+  // set the m_uiCurrentCount to maximum, to enable early-out in the future and to make 'IsValid' return 'false'
+  if (m_uiCurrentIndex >= m_pHashTable->m_uiCapacity)
+  {
+    m_uiCurrentCount = m_pHashTable->m_uiCount;
+  }
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE void ezFlatHashTableBase<K, V, H>::ConstIterator::operator++()
+{
+  Next();
+}
+
+
+// ***** Iterator *****
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::Iterator::Iterator(const ezFlatHashTableBase<K, V, H>& hashTable)
+  : ConstIterator(hashTable)
+{
+}
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::Iterator::Iterator(const typename ezFlatHashTableBase<K, V, H>::Iterator& rhs)
+  : ConstIterator(*rhs.m_pHashTable)
+{
+  this->m_uiCurrentIndex = rhs.m_uiCurrentIndex;
+  this->m_uiCurrentCount = rhs.m_uiCurrentCount;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE void ezFlatHashTableBase<K, V, H>::Iterator::operator=(const Iterator& rhs) // [tested]
+{
+  this->m_pHashTable = rhs.m_pHashTable;
+  this->m_uiCurrentIndex = rhs.m_uiCurrentIndex;
+  this->m_uiCurrentCount = rhs.m_uiCurrentCount;
+}
+
+template <typename K, typename V, typename H>
+EZ_FORCE_INLINE V& ezFlatHashTableBase<K, V, H>::Iterator::Value()
+{
+  return this->m_pHashTable->m_pEntries[this->m_uiCurrentIndex].value;
+}
+
+
+// ***** ezFlatHashTableBase *****
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::ezFlatHashTableBase(ezAllocator* pAllocator)
+{
+  m_pEntries = nullptr;
+  m_pControlBytes = nullptr;
+  m_uiCount = 0;
+  m_uiCapacity = 0;
+  m_uiGrowthLeft = 0;
+  m_pAllocator = pAllocator;
+}
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::ezFlatHashTableBase(const ezFlatHashTableBase<K, V, H>& other, ezAllocator* pAllocator)
+{
+  m_pEntries = nullptr;
+  m_pControlBytes = nullptr;
+  m_uiCount = 0;
+  m_uiCapacity = 0;
+  m_uiGrowthLeft = 0;
+  m_pAllocator = pAllocator;
+
+  *this = other;
+}
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::ezFlatHashTableBase(ezFlatHashTableBase<K, V, H>&& other, ezAllocator* pAllocator)
+{
+  m_pEntries = nullptr;
+  m_pControlBytes = nullptr;
+  m_uiCount = 0;
+  m_uiCapacity = 0;
+  m_uiGrowthLeft = 0;
+  m_pAllocator = pAllocator;
+
+  *this = std::move(other);
+}
+
+template <typename K, typename V, typename H>
+ezFlatHashTableBase<K, V, H>::~ezFlatHashTableBase()
+{
+  Clear();
+  EZ_DELETE_RAW_BUFFER(m_pAllocator, m_pEntries);
+  EZ_DELETE_RAW_BUFFER(m_pAllocator, m_pControlBytes);
+  m_uiCapacity = 0;
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::operator=(const ezFlatHashTableBase<K, V, H>& rhs)
+{
+  Clear();
+  Reserve(rhs.GetCount());
+
+  for (ezUInt32 i = rhs.FindNextValidEntry(0); i < rhs.m_uiCapacity; i = rhs.FindNextValidEntry(i + 1))
+  {
+    Insert(rhs.m_pEntries[i].key, rhs.m_pEntries[i].value);
+  }
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::operator=(ezFlatHashTableBase<K, V, H>&& rhs)
+{
+  // Clear any existing data (calls destructors if necessary)
+  Clear();
+
+  if (m_pAllocator != rhs.m_pAllocator)
+  {
+    Reserve(rhs.m_uiCount);
+
+    for (ezUInt32 i = rhs.FindNextValidEntry(0); i < rhs.m_uiCapacity; i = rhs.FindNextValidEntry(i + 1))
+    {
+      Insert(std::move(rhs.m_pEntries[i].key), std::move(rhs.m_pEntries[i].value));
+    }
+
+    rhs.Clear();
+  }
+  else
+  {
+    EZ_DELETE_RAW_BUFFER(m_pAllocator, m_pEntries);
+    EZ_DELETE_RAW_BUFFER(m_pAllocator, m_pControlBytes);
+
+    // Move all data over.
+    m_pEntries = rhs.m_pEntries;
+    m_pControlBytes = rhs.m_pControlBytes;
+    m_uiCount = rhs.m_uiCount;
+    m_uiCapacity = rhs.m_uiCapacity;
+    m_uiGrowthLeft = rhs.m_uiGrowthLeft;
+
+    // Temp copy forgets all its state.
+    rhs.m_pEntries = nullptr;
+    rhs.m_pControlBytes = nullptr;
+    rhs.m_uiCount = 0;
+    rhs.m_uiCapacity = 0;
+    rhs.m_uiGrowthLeft = 0;
+  }
+}
+
+template <typename K, typename V, typename H>
+bool ezFlatHashTableBase<K, V, H>::operator==(const ezFlatHashTableBase<K, V, H>& rhs) const
+{
+  if (m_uiCount != rhs.m_uiCount)
+    return false;
+
+  for (ezUInt32 i = FindNextValidEntry(0); i < m_uiCapacity; i = FindNextValidEntry(i + 1))
+  {
+    const V* pRhsValue = nullptr;
+    if (!rhs.TryGetValue(m_pEntries[i].key, pRhsValue))
+      return false;
+
+    if (m_pEntries[i].value != *pRhsValue)
+      return false;
+  }
+
+  return true;
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::Reserve(ezUInt32 uiCapacity)
+{
+  if (uiCapacity <= GetMaxLoad(m_uiCapacity))
+    return;
+
+  SetCapacity(GetCapacityForCount(uiCapacity));
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::Compact()
+{
+  if (IsEmpty())
+  {
+    // completely deallocate all data, if the table is empty.
+    EZ_DELETE_RAW_BUFFER(m_pAllocator, m_pEntries);
+    EZ_DELETE_RAW_BUFFER(m_pAllocator, m_pControlBytes);
+    m_uiCapacity = 0;
+    m_uiGrowthLeft = 0;
+  }
+  else
+  {
+    // always rehashes if there are deleted entries, to get rid of them
+    const ezUInt32 uiNewCapacity = GetCapacityForCount(m_uiCount);
+    if (m_uiCapacity != uiNewCapacity || m_uiGrowthLeft != GetMaxLoad(m_uiCapacity) - m_uiCount)
+      SetCapacity(uiNewCapacity);
+  }
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE ezUInt32 ezFlatHashTableBase<K, V, H>::GetCount() const
+{
+  return m_uiCount;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE bool ezFlatHashTableBase<K, V, H>::IsEmpty() const
+{
+  return m_uiCount == 0;
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::Clear()
+{
+  if (m_uiCapacity == 0)
+    return;
+
+  for (ezUInt32 i = FindNextValidEntry(0); i < m_uiCapacity; i = FindNextValidEntry(i + 1))
+  {
+    ezMemoryUtils::Destruct(&m_pEntries[i].key, 1);
+    ezMemoryUtils::Destruct(&m_pEntries[i].value, 1);
+  }
+
+  ezMemoryUtils::PatternFill(m_pControlBytes, Group::CONTROL_EMPTY, m_uiCapacity);
+  m_uiCount = 0;
+  m_uiGrowthLeft = GetMaxLoad(m_uiCapacity);
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType, typename CompatibleValueType>
+bool ezFlatHashTableBase<K, V, H>::Insert(CompatibleKeyType&& key, CompatibleValueType&& value, V* out_pOldValue /*= nullptr*/)
+{
+  const ezUInt32 uiHash = H::Hash(key);
+  ezUInt32 uiIndex = FindEntry(uiHash, key);
+
+  if (uiIndex != ezInvalidIndex)
+  {
+    if (out_pOldValue != nullptr)
+      *out_pOldValue = std::move(m_pEntries[uiIndex].value);
+
+    m_pEntries[uiIndex].value = std::forward<CompatibleValueType>(value); // Either move or copy assignment.
+    return true;
+  }
+
+  // new entry
+  uiIndex = PrepareInsert(uiHash);
+
+  // Both constructions might either be a move or a copy.
+  ezMemoryUtils::CopyOrMoveConstruct(&m_pEntries[uiIndex].key, std::forward<CompatibleKeyType>(key));
+  ezMemoryUtils::CopyOrMoveConstruct(&m_pEntries[uiIndex].value, std::forward<CompatibleValueType>(value));
+  ++m_uiCount;
+
+  return false;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+bool ezFlatHashTableBase<K, V, H>::Remove(const CompatibleKeyType& key, V* out_pOldValue /*= nullptr*/)
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  if (uiIndex != ezInvalidIndex)
+  {
+    if (out_pOldValue != nullptr)
+      *out_pOldValue = std::move(m_pEntries[uiIndex].value);
+
+    RemoveInternal(uiIndex);
+    return true;
+  }
+
+  return false;
+}
+
+template <typename K, typename V, typename H>
+typename ezFlatHashTableBase<K, V, H>::Iterator ezFlatHashTableBase<K, V, H>::Remove(const typename ezFlatHashTableBase<K, V, H>::Iterator& pos)
+{
+  EZ_ASSERT_DEBUG(pos.m_pHashTable == this, "Iterator from wrong hashtable");
+  Iterator it = pos;
+  ezUInt32 uiIndex = pos.m_uiCurrentIndex;
+  ++it;
+  --it.m_uiCurrentCount;
+  RemoveInternal(uiIndex);
+  return it;
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::RemoveInternal(ezUInt32 uiIndex)
+{
+  ezMemoryUtils::Destruct(&m_pEntries[uiIndex].key, 1);
+  ezMemoryUtils::Destruct(&m_pEntries[uiIndex].value, 1);
+
+  // A lookup only continues with the next group, if the current one has no empty entry.
+  // Once a group is full, it can't get an empty entry again, so if this group has an empty entry, it has never been full and no lookup
+  // ever went past it. In that case the entry can be marked as empty, otherwise it has to be marked as deleted to keep the probe chains intact.
+  const Group group(m_pControlBytes + (uiIndex & ~(Group::Size - 1)));
+  if (group.MatchEmpty() != 0)
+  {
+    m_pControlBytes[uiIndex] = Group::CONTROL_EMPTY;
+    ++m_uiGrowthLeft;
+  }
+  else
+  {
+    m_pControlBytes[uiIndex] = Group::CONTROL_DELETED;
+  }
+
+  --m_uiCount;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline bool ezFlatHashTableBase<K, V, H>::TryGetValue(const CompatibleKeyType& key, V& out_value) const
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  if (uiIndex != ezInvalidIndex)
+  {
+    EZ_ASSERT_DEBUG(m_pEntries != nullptr, "No entries present"); // To fix static analysis
+    out_value = m_pEntries[uiIndex].value;
+    return true;
+  }
+
+  return false;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline bool ezFlatHashTableBase<K, V, H>::TryGetValue(const CompatibleKeyType& key, const V*& out_pValue) const
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  if (uiIndex != ezInvalidIndex)
+  {
+    out_pValue = &m_pEntries[uiIndex].value;
+    EZ_ANALYSIS_ASSUME(out_pValue != nullptr);
+    return true;
+  }
+
+  return false;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline bool ezFlatHashTableBase<K, V, H>::TryGetValue(const CompatibleKeyType& key, V*& out_pValue) const
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  if (uiIndex != ezInvalidIndex)
+  {
+    out_pValue = &m_pEntries[uiIndex].value;
+    EZ_ANALYSIS_ASSUME(out_pValue != nullptr);
+    return true;
+  }
+
+  return false;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline typename ezFlatHashTableBase<K, V, H>::ConstIterator ezFlatHashTableBase<K, V, H>::Find(const CompatibleKeyType& key) const
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  if (uiIndex == ezInvalidIndex)
+  {
+    return GetEndIterator();
+  }
+
+  ConstIterator it(*this);
+  it.m_uiCurrentIndex = uiIndex;
+  it.m_uiCurrentCount = 0; // we do not know the 'count' (which is used as an optimization), so we just use 0
+
+  return it;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline typename ezFlatHashTableBase<K, V, H>::Iterator ezFlatHashTableBase<K, V, H>::Find(const CompatibleKeyType& key)
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  if (uiIndex == ezInvalidIndex)
+  {
+    return GetEndIterator();
+  }
+
+  Iterator it(*this);
+  it.m_uiCurrentIndex = uiIndex;
+  it.m_uiCurrentCount = 0; // we do not know the 'count' (which is used as an optimization), so we just use 0
+  return it;
+}
+
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline const V* ezFlatHashTableBase<K, V, H>::GetValue(const CompatibleKeyType& key) const
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  return (uiIndex != ezInvalidIndex) ? &m_pEntries[uiIndex].value : nullptr;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline V* ezFlatHashTableBase<K, V, H>::GetValue(const CompatibleKeyType& key)
+{
+  ezUInt32 uiIndex = FindEntry(key);
+  return (uiIndex != ezInvalidIndex) ? &m_pEntries[uiIndex].value : nullptr;
+}
+
+template <typename K, typename V, typename H>
+inline V& ezFlatHashTableBase<K, V, H>::operator[](const K& key)
+{
+  return FindOrAdd(key, nullptr);
+}
+
+template <typename K, typename V, typename H>
+V& ezFlatHashTableBase<K, V, H>::FindOrAdd(const K& key, bool* out_pExisted)
+{
+  const ezUInt32 uiHash = H::Hash(key);
+  ezUInt32 uiIndex = FindEntry(uiHash, key);
+
+  if (out_pExisted)
+  {
+    *out_pExisted = uiIndex != ezInvalidIndex;
+  }
+
+  if (uiIndex == ezInvalidIndex)
+  {
+    uiIndex = PrepareInsert(uiHash);
+
+    // new entry
+    ezMemoryUtils::CopyConstruct(&m_pEntries[uiIndex].key, key, 1);
+    ezMemoryUtils::Construct<ConstructAll>(&m_pEntries[uiIndex].value, 1);
+    ++m_uiCount;
+  }
+
+  EZ_ASSERT_DEBUG(m_pEntries != nullptr, "Entries should be present");
+  return m_pEntries[uiIndex].value;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+EZ_FORCE_INLINE bool ezFlatHashTableBase<K, V, H>::Contains(const CompatibleKeyType& key) const
+{
+  return FindEntry(key) != ezInvalidIndex;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE typename ezFlatHashTableBase<K, V, H>::Iterator ezFlatHashTableBase<K, V, H>::GetIterator()
+{
+  Iterator iterator(*this);
+  iterator.SetToBegin();
+  return iterator;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE typename ezFlatHashTableBase<K, V, H>::Iterator ezFlatHashTableBase<K, V, H>::GetEndIterator()
+{
+  Iterator iterator(*this);
+  iterator.SetToEnd();
+  return iterator;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE typename ezFlatHashTableBase<K, V, H>::ConstIterator ezFlatHashTableBase<K, V, H>::GetIterator() const
+{
+  ConstIterator iterator(*this);
+  iterator.SetToBegin();
+  return iterator;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE typename ezFlatHashTableBase<K, V, H>::ConstIterator ezFlatHashTableBase<K, V, H>::GetEndIterator() const
+{
+  ConstIterator iterator(*this);
+  iterator.SetToEnd();
+  return iterator;
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE ezAllocator* ezFlatHashTableBase<K, V, H>::GetAllocator() const
+{
+  return m_pAllocator;
+}
+
+template <typename K, typename V, typename H>
+ezUInt64 ezFlatHashTableBase<K, V, H>::GetHeapMemoryUsage() const
+{
+  return (ezUInt64)m_uiCapacity * (sizeof(Entry) + sizeof(ezUInt8));
+}
+
+// private methods
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE ezUInt32 ezFlatHashTableBase<K, V, H>::GetMaxLoad(ezUInt32 uiCapacity)
+{
+  // ensure a maximum load of 87.5%
+  return uiCapacity - uiCapacity / 8;
+}
+
+template <typename K, typename V, typename H>
+ezUInt32 ezFlatHashTableBase<K, V, H>::GetCapacityForCount(ezUInt32 uiCount)
+{
+  const ezUInt64 uiCapacity64 = (static_cast<ezUInt64>(uiCount) * 8 + 6) / 7;
+  EZ_ASSERT_DEBUG(uiCapacity64 <= 0x80000000llu, "ezFlatHashTable does not support more than 1.8 billion entries.");
+
+  return ezMath::Max<ezUInt32>(ezMath::PowerOfTwo_Ceil(static_cast<ezUInt32>(uiCapacity64)), Group::Size);
+}
+
+template <typename K, typename V, typename H>
+EZ_ALWAYS_INLINE void ezFlatHashTableBase<K, V, H>::SplitHash(ezUInt32 uiHash, ezUInt32& out_uiH1, ezUInt8& out_uiH2)
+{
+  // Many hash functions (e.g. for integers) don't distribute their lower bits well, so the hash is mixed once more.
+  // The upper bits of the product pick the group to start probing at, the top 7 bits are stored in the control byte.
+  const ezUInt64 uiMixed = static_cast<ezUInt64>(uiHash) * 0x9E3779B97F4A7C15ull;
+  out_uiH1 = static_cast<ezUInt32>(uiMixed >> 32);
+  out_uiH2 = static_cast<ezUInt8>(uiMixed >> 57);
+}
+
+template <typename K, typename V, typename H>
+void ezFlatHashTableBase<K, V, H>::SetCapacity(ezUInt32 uiCapacity)
+{
+  EZ_ASSERT_DEBUG(ezMath::IsPowerOf2(uiCapacity) && uiCapacity >= Group::Size, "uiCapacity must be a power of two and at least the group size.");
+  EZ_ASSERT_DEBUG(m_uiCount <= GetMaxLoad(uiCapacity), "uiCapacity is too small for the current number of entries.");
+
+  const ezUInt32 uiOldCapacity = m_uiCapacity;
+  Entry* pOldEntries = m_pEntries;
+  ezUInt8* pOldControlBytes = m_pControlBytes;
+
+  m_uiCapacity = uiCapacity;
+  m_uiGrowthLeft = GetMaxLoad(uiCapacity) - m_uiCount;
+  m_pEntries = EZ_NEW_RAW_BUFFER(m_pAllocator, Entry, m_uiCapacity);
+  m_pControlBytes = EZ_NEW_RAW_BUFFER(m_pAllocator, ezUInt8, m_uiCapacity);
+  ezMemoryUtils::PatternFill(m_pControlBytes, Group::CONTROL_EMPTY, m_uiCapacity);
+
+  for (ezUInt32 i = 0; i < uiOldCapacity; ++i)
+  {
+    if (pOldControlBytes[i] < Group::CONTROL_EMPTY)
+    {
+      // all keys are unique, so the entries can be placed without looking for an existing key
+      ezUInt32 uiH1;
+      ezUInt8 uiH2;
+      SplitHash(H::Hash(pOldEntries[i].key), uiH1, uiH2);
+
+      const ezUInt32 uiIndex = FindFirstNonFull(uiH1);
+      m_pControlBytes[uiIndex] = uiH2;
+
+      ezMemoryUtils::RelocateConstruct(&m_pEntries[uiIndex].key, &pOldEntries[i].key, 1);
+      ezMemoryUtils::RelocateConstruct(&m_pEntries[uiIndex].value, &pOldEntries[i].value, 1);
+    }
+  }
+
+  EZ_DELETE_RAW_BUFFER(m_pAllocator, pOldEntries);
+  EZ_DELETE_RAW_BUFFER(m_pAllocator, pOldControlBytes);
+}
+
+template <typename K, typename V, typename H>
+ezUInt32 ezFlatHashTableBase<K, V, H>::PrepareInsert(ezUInt32 uiHash)
+{
+  ezUInt32 uiH1;
+  ezUInt8 uiH2;
+  SplitHash(uiHash, uiH1, uiH2);
+
+  ezUInt32 uiIndex = m_uiCapacity > 0 ? FindFirstNonFull(uiH1) : ezInvalidIndex;
+
+  // deleted entries can always be reused, empty ones only as long as the maximum load isn't reached
+  if (uiIndex == ezInvalidIndex || (m_uiGrowthLeft == 0 && m_pControlBytes[uiIndex] != Group::CONTROL_DELETED))
+  {
+    if (m_uiCapacity > 0 && m_uiCount < GetMaxLoad(m_uiCapacity) / 2)
+    {
+      // most of the used entries are deleted ones, just get rid of them
+      SetCapacity(m_uiCapacity);
+    }
+    else
+    {
+      SetCapacity(ezMath::Max(GetCapacityForCount(m_uiCount + 1), m_uiCapacity * 2));
+    }
+
+    uiIndex = FindFirstNonFull(uiH1);
+  }
+
+  if (m_pControlBytes[uiIndex] == Group::CONTROL_EMPTY)
+  {
+    --m_uiGrowthLeft;
+  }
+
+  m_pControlBytes[uiIndex] = uiH2;
+  return uiIndex;
+}
+
+template <typename K, typename V, typename H>
+ezUInt32 ezFlatHashTableBase<K, V, H>::FindFirstNonFull(ezUInt32 uiH1) const
+{
+  const ezUInt32 uiGroupMask = (m_uiCapacity / Group::Size) - 1;
+  ezUInt32 uiGroup = uiH1 & uiGroupMask;
+
+  // triangular probing visits every group exactly once, because the number of groups is a power of two
+  for (ezUInt32 uiProbe = 1; uiProbe <= uiGroupMask + 1; ++uiProbe)
+  {
+    const Group group(m_pControlBytes + uiGroup * Group::Size);
+
+    const ezUInt64 uiMask = group.MatchEmptyOrDeleted();
+    if (uiMask != 0)
+      return uiGroup * Group::Size + Group::GetIndex(uiMask);
+
+    uiGroup = (uiGroup + uiProbe) & uiGroupMask;
+  }
+
+  return ezInvalidIndex;
+}
+
+template <typename K, typename V, typename H>
+ezUInt32 ezFlatHashTableBase<K, V, H>::FindNextValidEntry(ezUInt32 uiStartIndex) const
+{
+  while (uiStartIndex < m_uiCapacity)
+  {
+    const ezUInt32 uiGroupStart = uiStartIndex & ~(Group::Size - 1);
+    const Group group(m_pControlBytes + uiGroupStart);
+
+    const ezUInt64 uiMask = group.MatchFull() & Group::GetMaskFrom(uiStartIndex - uiGroupStart);
+    if (uiMask != 0)
+      return uiGroupStart + Group::GetIndex(uiMask);
+
+    uiStartIndex = uiGroupStart + Group::Size;
+  }
+
+  return m_uiCapacity;
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+EZ_ALWAYS_INLINE ezUInt32 ezFlatHashTableBase<K, V, H>::FindEntry(const CompatibleKeyType& key) const
+{
+  return FindEntry(H::Hash(key), key);
+}
+
+template <typename K, typename V, typename H>
+template <typename CompatibleKeyType>
+inline ezUInt32 ezFlatHashTableBase<K, V, H>::FindEntry(ezUInt32 uiHash, const CompatibleKeyType& key) const
+{
+  if (m_uiCapacity > 0)
+  {
+    ezUInt32 uiH1;
+    ezUInt8 uiH2;
+    SplitHash(uiHash, uiH1, uiH2);
+
+    const ezUInt32 uiGroupMask = (m_uiCapacity / Group::Size) - 1;
+    ezUInt32 uiGroup = uiH1 & uiGroupMask;
+
+    for (ezUInt32 uiProbe = 1; uiProbe <= uiGroupMask + 1; ++uiProbe)
+    {
+      const Group group(m_pControlBytes + uiGroup * Group::Size);
+
+      // only the keys of entries with matching hash bits need to be compared
+      for (ezUInt64 uiMask = group.Match(uiH2); uiMask != 0; uiMask &= uiMask - 1)
+      {
+        const ezUInt32 uiIndex = uiGroup * Group::Size + Group::GetIndex(uiMask);
+        if (H::Equal(m_pEntries[uiIndex].key, key))
+          return uiIndex;
+      }
+
+      // an empty entry ends the probe sequence
+      if (group.MatchEmpty() != 0)
+        break;
+
+      uiGroup = (uiGroup + uiProbe) & uiGroupMask;
+    }
+  }
+
+  // not found
+  return ezInvalidIndex;
+}
+
+template <typename K, typename V, typename H>
+EZ_FORCE_INLINE bool ezFlatHashTableBase<K, V, H>::IsValidEntry(ezUInt32 uiEntryIndex) const
+{
+  return m_pControlBytes[uiEntryIndex] < Group::CONTROL_EMPTY;
+}
+
+
+template <typename K, typename V, typename H, typename A>
+ezFlatHashTable<K, V, H, A>::ezFlatHashTable()
+  : ezFlatHashTableBase<K, V, H>(A::GetAllocator())
+{
+}
+
+template <typename K, typename V, typename H, typename A>
+ezFlatHashTable<K, V, H, A>::ezFlatHashTable(ezAllocator* pAllocator)
+  : ezFlatHashTableBase<K, V, H>(pAllocator)
+{
+}
+
+template <typename K, typename V, typename H, typename A>
+ezFlatHashTable<K, V, H, A>::ezFlatHashTable(const ezFlatHashTable<K, V, H, A>& other)
+  : ezFlatHashTableBase<K, V, H>(other, A::GetAllocator())
+{
+}
+
+template <typename K, typename V, typename H, typename A>
+ezFlatHashTable<K, V, H, A>::ezFlatHashTable(const ezFlatHashTableBase<K, V, H>& other)
+  : ezFlatHashTableBase<K, V, H>(other, A::GetAllocator())
+{
+}
+
+template <typename K, typename V, typename H, typename A>
+ezFlatHashTable<K, V, H, A>::ezFlatHashTable(ezFlatHashTable<K, V, H, A>&& other)
+  : ezFlatHashTableBase<K, V, H>(std::move(other), other.GetAllocator())
+{
+}
+
+template <typename K, typename V, typename H, typename A>
+ezFlatHashTable<K, V, H, A>::ezFlatHashTable(ezFlatHashTableBase<K, V, H>&& other)
+  : ezFlatHashTableBase<K, V, H>(std::move(other), other.GetAllocator())
+{
+}
+
+template <typename K, typename V, typename H, typename A>
+void ezFlatHashTable<K, V, H, A>::operator=(const ezFlatHashTable<K, V, H, A>& rhs)
+{
+  ezFlatHashTableBase<K, V, H>::operator=(rhs);
+}
+
+template <typename K, typename V, typename H, typename A>
+void ezFlatHashTable<K, V, H, A>::operator=(const ezFlatHashTableBase<K, V, H>& rhs)
+{
+  ezFlatHashTableBase<K, V, H>::operator=(rhs);
+}
+
+template <typename K, typename V, typename H, typename A>
+void ezFlatHashTable<K, V, H, A>::operator=(ezFlatHashTable<K, V, H, A>&& rhs)
+{
+  ezFlatHashTableBase<K, V, H>::operator=(std::move(rhs));
+}
+
+template <typename K, typename V, typename H, typename A>
+void ezFlatHashTable<K, V, H, A>::operator=(ezFlatHashTableBase<K, V, H>&& rhs)
+{
+  ezFlatHashTableBase<K, V, H>::operator=(std::move(rhs));
+}
+
+template <typename KeyType, typename ValueType, typename Hasher>
+void ezFlatHashTableBase<KeyType, ValueType, Hasher>::Swap(ezFlatHashTableBase<KeyType, ValueType, Hasher>& other)
+{
+  ezMath::Swap(this->m_pEntries, other.m_pEntries);
+  ezMath::Swap(this->m_pControlBytes, other.m_pControlBytes);
+  ezMath::Swap(this->m_uiCount, other.m_uiCount);
+  ezMath::Swap(this->m_uiCapacity, other.m_uiCapacity);
+  ezMath::Swap(this->m_uiGrowthLeft, other.m_uiGrowthLeft);
+  ezMath::Swap(this->m_pAllocator, other.m_pAllocator);
+}
+
+template <typename KeyType, typename ValueType, typename Hasher>
+ezResult ezStreamWriter::WriteHashTable(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& hashTable)
+{
+  const ezUInt64 uiWriteSize = hashTable.GetCount();
+  EZ_SUCCEED_OR_RETURN(WriteQWordValue(&uiWriteSize));
+
+  for (auto It = hashTable.GetIterator(); It.IsValid(); ++It)
+  {
+    EZ_SUCCEED_OR_RETURN(ezStreamWriterUtil::Serialize<KeyType>(*this, It.Key()));
+    EZ_SUCCEED_OR_RETURN(ezStreamWriterUtil::Serialize<ValueType>(*this, It.Value()));
+  }
+
+  return EZ_SUCCESS;
+}
+
+template <typename KeyType, typename ValueType, typename Hasher>
+ezResult ezStreamReader::ReadHashTable(ezFlatHashTableBase<KeyType, ValueType, Hasher>& inout_hashTable)
+{
+  ezUInt64 uiCount = 0;
+  EZ_SUCCEED_OR_RETURN(ReadQWordValue(&uiCount));
+
+  if (uiCount < ezMath::MaxValue<ezUInt32>())
+  {
+    inout_hashTable.Clear();
+    inout_hashTable.Reserve(static_cast<ezUInt32>(uiCount));
+
+    for (ezUInt32 i = 0; i < static_cast<ezUInt32>(uiCount); ++i)
+    {
+      KeyType Key;
+      ValueType Value;
+      EZ_SUCCEED_OR_RETURN(ezStreamReaderUtil::Deserialize(*this, Key));
+      EZ_SUCCEED_OR_RETURN(ezStreamReaderUtil::Deserialize(*this, Value));
+
+      inout_hashTable.Insert(std::move(Key), std::move(Value));
+    }
+
+    return EZ_SUCCESS;
+  }
+  else
+  {
+    // Containers currently use 32 bit for counts internally. Value from file is too large.
+    return EZ_FAILURE;
+  }
+}
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <Foundation/Containers/DynamicArray.h>
-#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Containers/FlatHashTable.h>
 #include <Foundation/Strings/HashedString.h>
 
 class ezRawMemoryStreamReader;
@@ -12,6 +12,8 @@ enum class ezArchiveCompressionMode : ezUInt8
   Uncompressed,
   Compressed_zstd,
   Compressed_zip,
+  Compressed_zstd_seekable, ///< Compressed in independent blocks with ezCompressedStreamWriterZstdSeekable, to allow reading at random positions.
+  Compressed_zstd_dictionary, ///< Compressed as a single zstd frame, using the dictionary stored in ezArchiveTOC::m_CompressionDictionary. See ezArchiveCompressionDictionary.
 };
 
 /// \brief Data for a single file entry in an ezArchive file
@@ -100,9 +102,11 @@ public:
   /// all files stored in the ezArchive
   ezDynamicArray<ezArchiveEntry> m_Entries;
   /// allows to map a hashed string to the index of the file entry for the file path
-  ezHashTable<ezArchiveStoredString, ezUInt32> m_PathToEntryIndex;
+  ezFlatHashTable<ezArchiveStoredString, ezUInt32> m_PathToEntryIndex;
   /// one large array holding all path strings for the file entries, to reduce allocations
   ezDynamicArray<ezUInt8> m_AllPathStrings;
+  /// the zstd dictionary for all entries with ezArchiveCompressionMode::Compressed_zstd_dictionary, empty if there are none
+  ezDynamicArray<ezUInt8> m_CompressionDictionary;
 
   /// \brief Returns the entry index for the given file or ezInvalidIndex, if not found.
   ezUInt32 FindEntry(ezStringView sFile) const;
@@ -5,6 +5,8 @@
 #include <Foundation/Containers/Deque.h>
 #include <Foundation/Types/Delegate.h>
 
+class ezArchiveCompressionDictionary;
+
 /// \brief Utility class to build an ezArchive file from files/folders on disk
 ///
 /// All functionality for writing an ezArchive file is available through ezArchiveUtils.
@@ -22,6 +24,9 @@ public:
   // all the source files from disk that should be put into the ezArchive
   ezDeque<SourceEntry> m_Entries;
 
+  /// The maximum size of the dictionary that is trained for entries with ezArchiveCompressionMode::Compressed_zstd_dictionary.
+  ezUInt32 m_uiMaxDictionarySize = 64 * 1024;
+
   enum class InclusionMode
   {
     Exclude,               ///< Do not add this file to the archive
@@ -31,6 +36,8 @@ public:
     Compress_zstd_average, ///< Add the file and try out compression. If compression does not help, the file will end up uncompressed in the archive.
     Compress_zstd_high,    ///< Add the file and try out compression. If compression does not help, the file will end up uncompressed in the archive.
     Compress_zstd_highest, ///< Add the file and try out compression. If compression does not help, the file will end up uncompressed in the archive.
+    Compress_zstd_seekable, ///< Add the file compressed in independent blocks, so that it can be read at random positions without decompressing everything in front of it. Good for large files of which only parts are read.
+    Compress_zstd_dictionary, ///< Add the file compressed with a dictionary that is trained over all files with this mode. Gives much better compression for many small, similar files.
   };
 
   /// \brief Custom decider whether to include a file into the archive
@@ -46,9 +53,14 @@ public:
   ezResult WriteArchive(ezStringView sFile) const;
 
   /// \brief Writes the previously gathered files to the file stream
+  ///
+  /// If any entry uses ezArchiveCompressionMode::Compressed_zstd_dictionary, a dictionary is trained over all of those entries first and
+  /// stored in the archive. If there isn't enough data to train a dictionary, these entries use regular zstd compression instead.
   ezResult WriteArchive(ezStreamWriter& inout_stream) const;
 
 protected:
+  void TrainCompressionDictionary(ezArchiveTOC& ref_toc, ezArchiveCompressionDictionary& ref_dictionary) const;
+
   /// Override this to get a callback when the next file is being written to the output. Return 'true' to continue, 'false' to cancel the entire archive generation.
   virtual bool WriteNextFileCallback(ezUInt32 uiCurEntry, ezUInt32 uiMaxEntries, ezStringView sSourceFile) const;
   /// Override this to get a progress report for writing a single file to the output
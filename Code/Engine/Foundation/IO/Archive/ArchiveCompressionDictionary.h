@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Foundation/Containers/DynamicArray.h>
+
+/// \brief A zstd dictionary that is shared by all entries of an archive with ezArchiveCompressionMode::Compressed_zstd_dictionary.
+///
+/// Small files (materials, prefabs, serialized components, ...) compress badly on their own, because zstd has no history to find matches in.
+/// A dictionary that contains the byte sequences that are common to many of these files acts as that history.
+///
+/// The dictionary is stored in ezArchiveTOC::m_CompressionDictionary. Before use, it has to be 'digested' once for compression and/or
+/// decompression, which is done by InitializeForCompression() and InitializeForDecompression(). Afterwards Compress() and Decompress() can be
+/// called from any thread.
+class EZ_FOUNDATION_DLL ezArchiveCompressionDictionary
+{
+  EZ_DISALLOW_COPY_AND_ASSIGN(ezArchiveCompressionDictionary);
+
+public:
+  ezArchiveCompressionDictionary();
+  ~ezArchiveCompressionDictionary();
+
+  /// \brief Builds a dictionary of at most \a uiMaxDictionarySize bytes from the given samples.
+  ///
+  /// The dictionary is assembled from the segments of the samples that contain the most frequent byte sequences.
+  /// Fails if there isn't enough sample data to build a useful dictionary.
+  static ezResult Train(ezArrayPtr<const ezArrayPtr<const ezUInt8>> samples, ezUInt32 uiMaxDictionarySize, ezDynamicArray<ezUInt8>& out_dictionary); // [tested]
+
+  /// \brief Prepares the dictionary for Compress(). The dictionary data is copied.
+  ezResult InitializeForCompression(ezArrayPtr<const ezUInt8> dictionary, ezInt32 iCompressionLevel); // [tested]
+
+  /// \brief Prepares the dictionary for Decompress(). The dictionary data is copied.
+  ezResult InitializeForDecompression(ezArrayPtr<const ezUInt8> dictionary); // [tested]
+
+  /// \brief Releases all data.
+  void Clear();
+
+  bool IsInitializedForCompression() const { return m_pCompressionDict != nullptr; }
+  bool IsInitializedForDecompression() const { return m_pDecompressionDict != nullptr; }
+
+  /// \brief Compresses \a source into a single zstd frame and appends it to \a out_compressed.
+  ezResult Compress(ezArrayPtr<const ezUInt8> source, ezDynamicArray<ezUInt8>& out_compressed) const; // [tested]
+
+  /// \brief Decompresses data that was compressed with Compress(). \a targetBuffer must have exactly the uncompressed size.
+  ezResult Decompress(ezArrayPtr<const ezUInt8> compressed, ezArrayPtr<ezUInt8> targetBuffer) const; // [tested]
+
+private:
+  /*ZSTD_CDict*/ void* m_pCompressionDict = nullptr;
+  /*ZSTD_DDict*/ void* m_pDecompressionDict = nullptr;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Foundation/IO/Archive/Archive.h>
+#include <Foundation/IO/Archive/ArchiveCompressionDictionary.h>
 #include <Foundation/IO/MemoryMappedFile.h>
 #include <Foundation/Types/UniquePtr.h>
 
@@ -33,6 +34,41 @@ public:
   /// \brief Creates a reader that will decompress the given file entry.
   ezUniquePtr<ezStreamReader> CreateEntryReader(ezUInt32 uiEntryIdx) const;
 
+  /// \brief Returns the raw (potentially compressed) data that is stored for the given entry.
+  ///
+  /// This is a view into the memory mapped archive, nothing is copied. It stays valid as long as the archive is open.
+  ezArrayPtr<const ezUInt8> GetStoredEntryData(ezUInt32 uiEntryIdx) const;
+
+  /// \brief For uncompressed entries, returns a view of the entry's data in the memory mapped archive without copying anything.
+  ///
+  /// Fails for compressed entries, use ReadEntry() or ReadEntries() for those.
+  ezResult GetUncompressedEntryData(ezUInt32 uiEntryIdx, ezArrayPtr<const ezUInt8>& out_data) const;
+
+  /// \brief Reads (and decompresses) the entire entry into \a targetBuffer, which must have exactly the uncompressed size of the entry.
+  ///
+  /// This is much faster than reading compressed entries through CreateEntryReader() and may be called from multiple threads at the same time.
+  ezResult ReadEntry(ezUInt32 uiEntryIdx, ezArrayPtr<ezUInt8> targetBuffer) const;
+
+  /// \brief Describes one entry to read with ReadEntries().
+  struct EntryRequest
+  {
+    ezUInt32 m_uiEntryIdx = ezInvalidIndex;
+
+    /// Must have exactly the uncompressed size of the entry.
+    ezArrayPtr<ezUInt8> m_TargetBuffer;
+
+    /// Set by ReadEntries().
+    ezResult m_Result = EZ_FAILURE;
+  };
+
+  /// \brief Returns the dictionary for entries with ezArchiveCompressionMode::Compressed_zstd_dictionary, ready for decompression.
+  const ezArchiveCompressionDictionary& GetCompressionDictionary() const { return m_CompressionDictionary; }
+
+  /// \brief Reads many entries at once. The entries are decompressed in parallel on the task system.
+  ///
+  /// Returns EZ_FAILURE if any of the entries could not be read, the result for each entry is stored in EntryRequest::m_Result.
+  ezResult ReadEntries(ezArrayPtr<EntryRequest> requests) const;
+
 protected:
   /// \brief Called by ExtractAllFiles() for progress reporting. Return false to abort.
   virtual bool ExtractNextFileCallback(ezUInt32 uiCurEntry, ezUInt32 uiMaxEntries, ezStringView sSourceFile) const;
@@ -42,6 +78,7 @@ protected:
 
   ezMemoryMappedFile m_MemFile;
   ezArchiveTOC m_ArchiveTOC;
+  ezArchiveCompressionDictionary m_CompressionDictionary;
   ezUInt8 m_uiArchiveVersion = 0;
   const void* m_pDataStart = nullptr;
   ezUInt64 m_uiMemFileSize = 0;
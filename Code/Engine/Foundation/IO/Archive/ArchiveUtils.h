@@ -10,6 +10,7 @@ class ezMemoryMappedFile;
 class ezArchiveTOC;
 class ezArchiveEntry;
 class ezRawMemoryStreamReader;
+class ezArchiveCompressionDictionary;
 
 /// \brief Utilities for working with ezArchive files
 namespace ezArchiveUtils
@@ -41,15 +42,24 @@ namespace ezArchiveUtils
   ///
   /// Appends information to the TOC for finding the data in the stream. Reads and updates inout_uiCurrentStreamPosition with the data byte
   /// offset. The progress callback is executed for every couple of KB of data that were written.
+  /// For ezArchiveCompressionMode::Compressed_zstd_dictionary, \a pDictionary must be initialized for compression. In that case the compression level
+  /// that the dictionary was initialized with is used instead of \a iCompressionLevel.
   EZ_FOUNDATION_DLL ezResult WriteEntry(ezStreamWriter& inout_stream, ezStringView sAbsSourcePath, ezUInt32 uiPathStringOffset,
     ezArchiveCompressionMode compression, ezInt32 iCompressionLevel, ezArchiveEntry& ref_tocEntry, ezUInt64& inout_uiCurrentStreamPosition,
-    FileWriteProgressCallback progress = FileWriteProgressCallback());
+    FileWriteProgressCallback progress = FileWriteProgressCallback(), const ezArchiveCompressionDictionary* pDictionary = nullptr);
+
+  /// \brief Same as the other WriteEntry() overload, but takes the data from a stream instead of a file.
+  ///
+  /// \a uiSourceSize is only used for progress reporting.
+  EZ_FOUNDATION_DLL ezResult WriteEntry(ezStreamWriter& inout_stream, ezStreamReader& inout_source, ezUInt64 uiSourceSize, ezUInt32 uiPathStringOffset,
+    ezArchiveCompressionMode compression, ezInt32 iCompressionLevel, ezArchiveEntry& ref_tocEntry, ezUInt64& inout_uiCurrentStreamPosition,
+    FileWriteProgressCallback progress = FileWriteProgressCallback(), const ezArchiveCompressionDictionary* pDictionary = nullptr);
 
   /// \brief Similar to WriteEntry, but if compression is enabled, checks that compression makes enough of a difference.
   /// If compression does not reduce file size enough, the file is stored uncompressed instead.
   EZ_FOUNDATION_DLL ezResult WriteEntryOptimal(ezStreamWriter& inout_stream, ezStringView sAbsSourcePath, ezUInt32 uiPathStringOffset,
     ezArchiveCompressionMode compression, ezInt32 iCompressionLevel, ezArchiveEntry& ref_tocEntry, ezUInt64& inout_uiCurrentStreamPosition,
-    FileWriteProgressCallback progress = FileWriteProgressCallback());
+    FileWriteProgressCallback progress = FileWriteProgressCallback(), const ezArchiveCompressionDictionary* pDictionary = nullptr);
 
   /// \brief Configures \a memReader as a view into the data stored for \a entry in the archive file.
   ///
@@ -60,7 +70,15 @@ namespace ezArchiveUtils
   /// \brief Creates a new stream reader which allows to read the uncompressed data for the given archive entry.
   ///
   /// Under the hood it may create different types of stream readers to uncompress or decode the data.
-  EZ_FOUNDATION_DLL ezUniquePtr<ezStreamReader> CreateEntryReader(const ezArchiveEntry& entry, const void* pStartOfArchiveData);
+  /// \a pDictionary is only needed for entries with ezArchiveCompressionMode::Compressed_zstd_dictionary and must be initialized for decompression.
+  EZ_FOUNDATION_DLL ezUniquePtr<ezStreamReader> CreateEntryReader(const ezArchiveEntry& entry, const void* pStartOfArchiveData, const ezArchiveCompressionDictionary* pDictionary = nullptr);
+
+  /// \brief Reads the entire data of the given archive entry into \a targetBuffer, which must be exactly as large as the uncompressed data.
+  ///
+  /// Compressed entries are decompressed directly from the archive memory into the target buffer, which is a lot cheaper than reading them
+  /// through a stream from CreateEntryReader().
+  /// This function is thread-safe, so many entries can be read in parallel.
+  EZ_FOUNDATION_DLL ezResult ReadEntry(const ezArchiveEntry& entry, const void* pStartOfArchiveData, ezArrayPtr<ezUInt8> targetBuffer, const ezArchiveCompressionDictionary* pDictionary = nullptr);
 
   EZ_FOUNDATION_DLL ezResult ReadZipHeader(ezStreamReader& inout_stream, ezUInt8& out_uiVersion);
   EZ_FOUNDATION_DLL ezResult ExtractZipTOC(ezMemoryMappedFile& ref_memFile, ezArchiveTOC& ref_toc);
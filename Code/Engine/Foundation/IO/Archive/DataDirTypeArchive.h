@@ -13,6 +13,8 @@ namespace ezDataDirectory
 {
   class ArchiveReaderUncompressed;
   class ArchiveReaderZstd;
+  class ArchiveReaderZstdSeekable;
+  class ArchiveReaderZstdDictionary;
   class ArchiveReaderZip;
 
   class EZ_FOUNDATION_DLL ArchiveType : public ezDataDirectoryType
@@ -50,6 +52,10 @@ namespace ezDataDirectory
 #ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
     ezHybridArray<ezUniquePtr<ArchiveReaderZstd>, 4> m_ReadersZstd;
     ezHybridArray<ArchiveReaderZstd*, 4> m_FreeReadersZstd;
+    ezHybridArray<ezUniquePtr<ArchiveReaderZstdSeekable>, 4> m_ReadersZstdSeekable;
+    ezHybridArray<ArchiveReaderZstdSeekable*, 4> m_FreeReadersZstdSeekable;
+    ezHybridArray<ezUniquePtr<ArchiveReaderZstdDictionary>, 4> m_ReadersZstdDictionary;
+    ezHybridArray<ArchiveReaderZstdDictionary*, 4> m_FreeReadersZstdDictionary;
 #endif
   };
 
@@ -93,6 +99,40 @@ namespace ezDataDirectory
 
     ezCompressedStreamReaderZstd m_CompressedStreamReader;
   };
+
+  class EZ_FOUNDATION_DLL ArchiveReaderZstdSeekable : public ArchiveReaderUncompressed
+  {
+    EZ_DISALLOW_COPY_AND_ASSIGN(ArchiveReaderZstdSeekable);
+
+  public:
+    ArchiveReaderZstdSeekable(ezInt32 iDataDirUserData);
+    ~ArchiveReaderZstdSeekable();
+
+    virtual ezUInt64 Read(void* pBuffer, ezUInt64 uiBytes) override;
+
+  protected:
+    virtual ezResult InternalOpen(ezFileShareMode::Enum FileShareMode) override;
+
+    friend class ArchiveType;
+
+    ezArrayPtr<const ezUInt8> m_StoredData;
+    ezCompressedStreamReaderZstdSeekable m_CompressedStreamReader;
+  };
+
+  /// Dictionary compressed entries are small, so they are decompressed entirely when the file is opened.
+  class EZ_FOUNDATION_DLL ArchiveReaderZstdDictionary : public ArchiveReaderUncompressed
+  {
+    EZ_DISALLOW_COPY_AND_ASSIGN(ArchiveReaderZstdDictionary);
+
+  public:
+    ArchiveReaderZstdDictionary(ezInt32 iDataDirUserData);
+    ~ArchiveReaderZstdDictionary();
+
+  protected:
+    friend class ArchiveType;
+
+    ezDynamicArray<ezUInt8> m_DecompressedData;
+  };
 #endif
 
 
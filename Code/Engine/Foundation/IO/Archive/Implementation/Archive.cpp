@@ -50,6 +50,8 @@ ezResult ezArchiveTOC::Serialize(ezStreamWriter& inout_stream) const
 
   EZ_SUCCEED_OR_RETURN(inout_stream.WriteArray(m_AllPathStrings));
 
+  EZ_SUCCEED_OR_RETURN(inout_stream.WriteArray(m_CompressionDictionary));
+
   return EZ_SUCCESS;
 }
 
@@ -82,7 +84,7 @@ struct ezHashHelper<ezOldTempHashedString>
 
 ezResult ezArchiveTOC::Deserialize(ezStreamReader& inout_stream, ezUInt8 uiArchiveVersion)
 {
-  EZ_ASSERT_ALWAYS(uiArchiveVersion <= 4, "Unsupported archive version {}", uiArchiveVersion);
+  EZ_ASSERT_ALWAYS(uiArchiveVersion <= 5, "Unsupported archive version {}", uiArchiveVersion);
 
   // we don't use the TOC version anymore, but the archive version instead
   const ezTypeVersion version = inout_stream.ReadVersion(2);
@@ -116,6 +118,12 @@ ezResult ezArchiveTOC::Deserialize(ezStreamReader& inout_stream, ezUInt8 uiArchi
 
   EZ_SUCCEED_OR_RETURN(inout_stream.ReadArray(m_AllPathStrings));
 
+  m_CompressionDictionary.Clear();
+  if (uiArchiveVersion >= 5)
+  {
+    EZ_SUCCEED_OR_RETURN(inout_stream.ReadArray(m_CompressionDictionary));
+  }
+
   if (bRecreateStringHashes)
   {
     ezLog::Info("Archive uses older string hashing, recomputing hashes.");
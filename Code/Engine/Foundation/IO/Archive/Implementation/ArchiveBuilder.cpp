@@ -1,8 +1,10 @@
 #include <Foundation/FoundationPCH.h>
 
 #include <Foundation/IO/Archive/ArchiveBuilder.h>
+#include <Foundation/IO/Archive/ArchiveCompressionDictionary.h>
 #include <Foundation/IO/Archive/ArchiveUtils.h>
 #include <Foundation/IO/CompressedStreamZstd.h>
+#include <Foundation/IO/FileSystem/FileReader.h>
 #include <Foundation/IO/FileSystem/FileWriter.h>
 #include <Foundation/IO/OSFile.h>
 #include <Foundation/Logging/Log.h>
@@ -63,6 +65,14 @@ void ezArchiveBuilder::AddFolder(ezStringView sAbsFolderPath, ezArchiveCompressi
             compression = ezArchiveCompressionMode::Compressed_zstd;
             iCompressionLevel = static_cast<ezInt32>(ezCompressedStreamWriterZstd::Compression::Highest);
             break;
+          case InclusionMode::Compress_zstd_seekable:
+            compression = ezArchiveCompressionMode::Compressed_zstd_seekable;
+            iCompressionLevel = static_cast<ezInt32>(ezCompressedStreamWriterZstd::Compression::Average);
+            break;
+          case InclusionMode::Compress_zstd_dictionary:
+            compression = ezArchiveCompressionMode::Compressed_zstd_dictionary;
+            iCompressionLevel = static_cast<ezInt32>(ezCompressedStreamWriterZstd::Compression::Average);
+            break;
 #  endif
         }
       }
@@ -105,6 +115,9 @@ ezResult ezArchiveBuilder::WriteArchive(ezStreamWriter& inout_stream) const
   ezUInt64 uiStreamSize = 0;
   const ezUInt32 uiNumEntries = m_Entries.GetCount();
 
+  ezArchiveCompressionDictionary dictionary;
+  TrainCompressionDictionary(toc, dictionary);
+
   ezStopwatch sw;
 
   for (ezUInt32 i = 0; i < uiNumEntries; ++i)
@@ -124,7 +137,13 @@ ezResult ezArchiveBuilder::WriteArchive(ezStreamWriter& inout_stream) const
 
     ezArchiveEntry& tocEntry = toc.m_Entries.ExpandAndGetRef();
 
-    EZ_SUCCEED_OR_RETURN(ezArchiveUtils::WriteEntryOptimal(inout_stream, e.m_sAbsSourcePath, uiPathStringOffset, e.m_CompressionMode, e.m_iCompressionLevel, tocEntry, uiStreamSize, ezMakeDelegate(&ezArchiveBuilder::WriteFileProgressCallback, this)));
+    ezArchiveCompressionMode compression = e.m_CompressionMode;
+    if (compression == ezArchiveCompressionMode::Compressed_zstd_dictionary && !dictionary.IsInitializedForCompression())
+    {
+      compression = ezArchiveCompressionMode::Compressed_zstd;
+    }
+
+    EZ_SUCCEED_OR_RETURN(ezArchiveUtils::WriteEntryOptimal(inout_stream, e.m_sAbsSourcePath, uiPathStringOffset, compression, e.m_iCompressionLevel, tocEntry, uiStreamSize, ezMakeDelegate(&ezArchiveBuilder::WriteFileProgressCallback, this), &dictionary));
 
     WriteFileResultCallback(i + 1, uiNumEntries, e.m_sAbsSourcePath, tocEntry.m_uiUncompressedDataSize, tocEntry.m_uiStoredDataSize, sw.Checkpoint());
   }
@@ -134,6 +153,62 @@ ezResult ezArchiveBuilder::WriteArchive(ezStreamWriter& inout_stream) const
   return EZ_SUCCESS;
 }
 
+void ezArchiveBuilder::TrainCompressionDictionary(ezArchiveTOC& ref_toc, ezArchiveCompressionDictionary& ref_dictionary) const
+{
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+  // zstd recommends about 100 times as much sample data as the dictionary size, more doesn't improve the result much
+  const ezUInt64 uiMaxSampleData = static_cast<ezUInt64>(m_uiMaxDictionarySize) * 100;
+
+  ezDynamicArray<ezDynamicArray<ezUInt8>> sampleData;
+  ezDynamicArray<ezArrayPtr<const ezUInt8>> samples;
+  ezUInt64 uiTotalSampleData = 0;
+  ezInt32 iCompressionLevel = 0;
+
+  for (const SourceEntry& e : m_Entries)
+  {
+    if (e.m_CompressionMode != ezArchiveCompressionMode::Compressed_zstd_dictionary)
+      continue;
+
+    iCompressionLevel = ezMath::Max(iCompressionLevel, e.m_iCompressionLevel);
+
+    if (uiTotalSampleData >= uiMaxSampleData)
+      continue;
+
+    ezFileReader file;
+    if (file.Open(e.m_sAbsSourcePath).Failed())
+      continue;
+
+    auto& data = sampleData.ExpandAndGetRef();
+    data.SetCountUninitialized(static_cast<ezUInt32>(ezMath::Min(file.GetFileSize(), uiMaxSampleData - uiTotalSampleData)));
+    data.SetCountUninitialized(static_cast<ezUInt32>(file.ReadBytes(data.GetData(), data.GetCount())));
+
+    uiTotalSampleData += data.GetCount();
+  }
+
+  if (sampleData.IsEmpty())
+    return;
+
+  for (const auto& data : sampleData)
+  {
+    samples.PushBack(data);
+  }
+
+  if (ezArchiveCompressionDictionary::Train(samples, m_uiMaxDictionarySize, ref_toc.m_CompressionDictionary).Failed())
+  {
+    ezLog::Warning("Not enough data to train a compression dictionary, using regular compression instead.");
+    return;
+  }
+
+  if (ref_dictionary.InitializeForCompression(ref_toc.m_CompressionDictionary, iCompressionLevel).Failed())
+  {
+    ref_toc.m_CompressionDictionary.Clear();
+    return;
+  }
+
+  ezLog::Info("Trained a compression dictionary of {} from {} files ({}).", ezArgFileSize(ref_toc.m_CompressionDictionary.GetCount()), sampleData.GetCount(), ezArgFileSize(uiTotalSampleData));
+#endif
+}
+
 bool ezArchiveBuilder::WriteNextFileCallback(ezUInt32 uiCurEntry, ezUInt32 uiMaxEntries, ezStringView sSourceFile) const
 {
   return true;
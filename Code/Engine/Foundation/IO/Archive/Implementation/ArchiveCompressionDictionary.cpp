@@ -0,0 +1,291 @@
+#include <Foundation/FoundationPCH.h>
+
+#include <Foundation/IO/Archive/ArchiveCompressionDictionary.h>
+
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+#  include <zstd/zstd.h>
+
+namespace
+{
+  /// One context per thread, so that Compress() and Decompress() can run in parallel without allocating a context every time.
+  struct ezThreadLocalZstdDictContexts
+  {
+    ~ezThreadLocalZstdDictContexts()
+    {
+      if (m_pCompressionContext != nullptr)
+      {
+        ZSTD_freeCCtx(m_pCompressionContext);
+      }
+
+      if (m_pDecompressionContext != nullptr)
+      {
+        ZSTD_freeDCtx(m_pDecompressionContext);
+      }
+    }
+
+    ZSTD_CCtx* GetCompressionContext()
+    {
+      if (m_pCompressionContext == nullptr)
+      {
+        m_pCompressionContext = ZSTD_createCCtx();
+      }
+
+      return m_pCompressionContext;
+    }
+
+    ZSTD_DCtx* GetDecompressionContext()
+    {
+      if (m_pDecompressionContext == nullptr)
+      {
+        m_pDecompressionContext = ZSTD_createDCtx();
+      }
+
+      return m_pDecompressionContext;
+    }
+
+    ZSTD_CCtx* m_pCompressionContext = nullptr;
+    ZSTD_DCtx* m_pDecompressionContext = nullptr;
+  };
+
+  thread_local ezThreadLocalZstdDictContexts s_ZstdDictContexts;
+} // namespace
+
+#endif
+
+ezArchiveCompressionDictionary::ezArchiveCompressionDictionary() = default;
+
+ezArchiveCompressionDictionary::~ezArchiveCompressionDictionary()
+{
+  Clear();
+}
+
+ezResult ezArchiveCompressionDictionary::Train(ezArrayPtr<const ezArrayPtr<const ezUInt8>> samples, ezUInt32 uiMaxDictionarySize, ezDynamicArray<ezUInt8>& out_dictionary)
+{
+  // This is a simplified version of the COVER algorithm that zstd's dictionary builder uses:
+  // All samples are split into 'epochs'. From each epoch the segment is picked, whose byte sequences (d-mers) are the most frequent ones
+  // over all samples. The d-mers of a picked segment don't count anymore for later segments, so that the dictionary doesn't contain the
+  // same data twice. The most valuable segments end up at the back of the dictionary, where they are the cheapest to reference.
+
+  constexpr ezUInt32 uiDmerSize = 8;
+  constexpr ezUInt32 uiSegmentSize = 512;
+  constexpr ezUInt32 uiDmersPerSegment = uiSegmentSize - uiDmerSize + 1;
+  constexpr ezUInt32 uiHashBits = 20;
+
+  out_dictionary.Clear();
+
+  ezDynamicArray<ezUInt8> data;
+  ezDynamicArray<ezUInt32> dmerHashes;
+
+  // concatenate all samples and hash each d-mer, d-mers that would cross a sample boundary get hash 0, which never has a frequency
+  {
+    ezUInt64 uiTotalSize = 0;
+    for (const auto& sample : samples)
+    {
+      uiTotalSize += sample.GetCount();
+    }
+
+    if (uiTotalSize < uiSegmentSize * 8 || uiTotalSize > ezMath::MaxValue<ezUInt32>())
+      return EZ_FAILURE;
+
+    data.Reserve(static_cast<ezUInt32>(uiTotalSize));
+    dmerHashes.Reserve(static_cast<ezUInt32>(uiTotalSize));
+
+    for (const auto& sample : samples)
+    {
+      data.PushBackRange(sample);
+
+      for (ezUInt32 i = 0; i < sample.GetCount(); ++i)
+      {
+        if (i + uiDmerSize > sample.GetCount())
+        {
+          dmerHashes.PushBack(0);
+          continue;
+        }
+
+        ezUInt64 uiDmer = 0;
+        ezMemoryUtils::RawByteCopy(&uiDmer, sample.GetPtr() + i, uiDmerSize);
+
+        const ezUInt32 uiHash = static_cast<ezUInt32>((uiDmer * 0xCF1BBCDCB7A56463ull) >> (64 - uiHashBits));
+        dmerHashes.PushBack(ezMath::Max(uiHash, 1u));
+      }
+    }
+  }
+
+  const ezUInt32 uiNumDmers = dmerHashes.GetCount();
+
+  ezDynamicArray<ezUInt32> frequencies;
+  frequencies.SetCount(1u << uiHashBits);
+
+  for (ezUInt32 uiHash : dmerHashes)
+  {
+    ++frequencies[uiHash];
+  }
+
+  frequencies[0] = 0;
+
+  // the dictionary shouldn't be larger than a fraction of the sample data, otherwise it just stores the samples
+  const ezUInt32 uiDictCapacity = ezMath::Min(uiMaxDictionarySize, data.GetCount() / 8);
+  const ezUInt32 uiNumEpochs = ezMath::Clamp(uiDictCapacity / uiSegmentSize / 4, 1u, uiNumDmers / uiSegmentSize);
+  const ezUInt32 uiEpochSize = uiNumDmers / uiNumEpochs;
+
+  ezDynamicArray<ezUInt8> dictionary;
+  dictionary.SetCountUninitialized(uiDictCapacity);
+  ezUInt32 uiDictTail = uiDictCapacity;
+
+  // how often each d-mer occurs in the current window, to only count every d-mer once per segment
+  ezDynamicArray<ezUInt16> windowCounts;
+  windowCounts.SetCount(1u << uiHashBits);
+
+  ezUInt32 uiEpochsWithoutResult = 0;
+
+  for (ezUInt32 uiEpoch = 0; uiDictTail > 0 && uiEpochsWithoutResult < uiNumEpochs; uiEpoch = (uiEpoch + 1) % uiNumEpochs)
+  {
+    const ezUInt32 uiEpochBegin = uiEpoch * uiEpochSize;
+    const ezUInt32 uiEpochEnd = ezMath::Min(uiEpochBegin + uiEpochSize, uiNumDmers);
+
+    ezUInt64 uiScore = 0;
+    ezUInt64 uiBestScore = 0;
+    ezUInt32 uiBestBegin = uiEpochBegin;
+    ezUInt32 uiWindowBegin = uiEpochBegin;
+
+    for (ezUInt32 uiWindowEnd = uiEpochBegin; uiWindowEnd < uiEpochEnd; ++uiWindowEnd)
+    {
+      const ezUInt32 uiNewHash = dmerHashes[uiWindowEnd];
+      if (windowCounts[uiNewHash]++ == 0)
+      {
+        uiScore += frequencies[uiNewHash];
+      }
+
+      if (uiWindowEnd - uiWindowBegin + 1 > uiDmersPerSegment)
+      {
+        const ezUInt32 uiOldHash = dmerHashes[uiWindowBegin++];
+        if (--windowCounts[uiOldHash] == 0)
+        {
+          uiScore -= frequencies[uiOldHash];
+        }
+      }
+
+      if (uiScore > uiBestScore)
+      {
+        uiBestScore = uiScore;
+        uiBestBegin = uiWindowBegin;
+      }
+    }
+
+    for (; uiWindowBegin < uiEpochEnd; ++uiWindowBegin)
+    {
+      --windowCounts[dmerHashes[uiWindowBegin]];
+    }
+
+    if (uiBestScore == 0)
+    {
+      ++uiEpochsWithoutResult;
+      continue;
+    }
+
+    uiEpochsWithoutResult = 0;
+
+    const ezUInt32 uiBestEnd = ezMath::Min(uiBestBegin + uiDmersPerSegment, uiNumDmers);
+    for (ezUInt32 i = uiBestBegin; i < uiBestEnd; ++i)
+    {
+      frequencies[dmerHashes[i]] = 0;
+    }
+
+    const ezUInt32 uiSegmentBytes = ezMath::Min(ezMath::Min(uiSegmentSize, data.GetCount() - uiBestBegin), uiDictTail);
+    uiDictTail -= uiSegmentBytes;
+    ezMemoryUtils::Copy(dictionary.GetData() + uiDictTail, data.GetData() + uiBestBegin, uiSegmentBytes);
+  }
+
+  if (uiDictCapacity - uiDictTail < uiSegmentSize)
+    return EZ_FAILURE;
+
+  out_dictionary = dictionary.GetArrayPtr().GetSubArray(uiDictTail);
+  return EZ_SUCCESS;
+}
+
+ezResult ezArchiveCompressionDictionary::InitializeForCompression(ezArrayPtr<const ezUInt8> dictionary, ezInt32 iCompressionLevel)
+{
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+  if (m_pCompressionDict != nullptr)
+  {
+    ZSTD_freeCDict(reinterpret_cast<ZSTD_CDict*>(m_pCompressionDict));
+  }
+
+  m_pCompressionDict = ZSTD_createCDict(dictionary.GetPtr(), dictionary.GetCount(), iCompressionLevel);
+  return m_pCompressionDict != nullptr ? EZ_SUCCESS : EZ_FAILURE;
+#else
+  return EZ_FAILURE;
+#endif
+}
+
+ezResult ezArchiveCompressionDictionary::InitializeForDecompression(ezArrayPtr<const ezUInt8> dictionary)
+{
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+  if (m_pDecompressionDict != nullptr)
+  {
+    ZSTD_freeDDict(reinterpret_cast<ZSTD_DDict*>(m_pDecompressionDict));
+  }
+
+  m_pDecompressionDict = ZSTD_createDDict(dictionary.GetPtr(), dictionary.GetCount());
+  return m_pDecompressionDict != nullptr ? EZ_SUCCESS : EZ_FAILURE;
+#else
+  return EZ_FAILURE;
+#endif
+}
+
+void ezArchiveCompressionDictionary::Clear()
+{
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+  if (m_pCompressionDict != nullptr)
+  {
+    ZSTD_freeCDict(reinterpret_cast<ZSTD_CDict*>(m_pCompressionDict));
+    m_pCompressionDict = nullptr;
+  }
+
+  if (m_pDecompressionDict != nullptr)
+  {
+    ZSTD_freeDDict(reinterpret_cast<ZSTD_DDict*>(m_pDecompressionDict));
+    m_pDecompressionDict = nullptr;
+  }
+#endif
+}
+
+ezResult ezArchiveCompressionDictionary::Compress(ezArrayPtr<const ezUInt8> source, ezDynamicArray<ezUInt8>& out_compressed) const
+{
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+  EZ_ASSERT_DEV(m_pCompressionDict != nullptr, "The dictionary has not been initialized for compression.");
+
+  const ezUInt32 uiPrevCount = out_compressed.GetCount();
+  out_compressed.SetCountUninitialized(uiPrevCount + static_cast<ezUInt32>(ZSTD_compressBound(source.GetCount())));
+
+  const size_t res = ZSTD_compress_usingCDict(s_ZstdDictContexts.GetCompressionContext(), out_compressed.GetData() + uiPrevCount, out_compressed.GetCount() - uiPrevCount, source.GetPtr(), source.GetCount(), reinterpret_cast<const ZSTD_CDict*>(m_pCompressionDict));
+
+  if (ZSTD_isError(res))
+  {
+    out_compressed.SetCountUninitialized(uiPrevCount);
+    return EZ_FAILURE;
+  }
+
+  out_compressed.SetCountUninitialized(uiPrevCount + static_cast<ezUInt32>(res));
+  return EZ_SUCCESS;
+#else
+  return EZ_FAILURE;
+#endif
+}
+
+ezResult ezArchiveCompressionDictionary::Decompress(ezArrayPtr<const ezUInt8> compressed, ezArrayPtr<ezUInt8> targetBuffer) const
+{
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+  if (m_pDecompressionDict == nullptr)
+    return EZ_FAILURE;
+
+  const size_t res = ZSTD_decompress_usingDDict(s_ZstdDictContexts.GetDecompressionContext(), targetBuffer.GetPtr(), targetBuffer.GetCount(), compressed.GetPtr(), compressed.GetCount(), reinterpret_cast<const ZSTD_DDict*>(m_pDecompressionDict));
+
+  if (ZSTD_isError(res) || res != targetBuffer.GetCount())
+    return EZ_FAILURE;
+
+  return EZ_SUCCESS;
+#else
+  return EZ_FAILURE;
+#endif
+}
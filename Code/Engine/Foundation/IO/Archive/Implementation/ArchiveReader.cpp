@@ -7,6 +7,7 @@
 #include <Foundation/IO/FileSystem/FileWriter.h>
 #include <Foundation/IO/MemoryStream.h>
 #include <Foundation/Logging/Log.h>
+#include <Foundation/Threading/TaskSystem.h>
 #include <Foundation/Types/Types.h>
 
 #include <Foundation/Logging/Log.h>
@@ -32,6 +33,14 @@ ezResult ezArchiveReader::OpenArchive(ezStringView sPath)
       m_pDataStart = m_MemFile.GetReadPointer(16, ezMemoryMappedFile::OffsetBase::Start);
 
       EZ_SUCCEED_OR_RETURN(ezArchiveUtils::ExtractTOC(m_MemFile, m_ArchiveTOC, m_uiArchiveVersion));
+
+      // digest the dictionary once, instead of every time an entry is decompressed
+      m_CompressionDictionary.Clear();
+      if (!m_ArchiveTOC.m_CompressionDictionary.IsEmpty() && m_CompressionDictionary.InitializeForDecompression(m_ArchiveTOC.m_CompressionDictionary).Failed())
+      {
+        ezLog::Error("Archive compression dictionary is not supported.");
+        return EZ_FAILURE;
+      }
     }
 
     else
@@ -106,7 +115,55 @@ void ezArchiveReader::ConfigureRawMemoryStreamReader(ezUInt32 uiEntryIdx, ezRawM
 
 ezUniquePtr<ezStreamReader> ezArchiveReader::CreateEntryReader(ezUInt32 uiEntryIdx) const
 {
-  return ezArchiveUtils::CreateEntryReader(m_ArchiveTOC.m_Entries[uiEntryIdx], m_pDataStart);
+  return ezArchiveUtils::CreateEntryReader(m_ArchiveTOC.m_Entries[uiEntryIdx], m_pDataStart, &m_CompressionDictionary);
+}
+
+ezArrayPtr<const ezUInt8> ezArchiveReader::GetStoredEntryData(ezUInt32 uiEntryIdx) const
+{
+  const ezArchiveEntry& entry = m_ArchiveTOC.m_Entries[uiEntryIdx];
+  const ezUInt8* pData = static_cast<const ezUInt8*>(m_pDataStart) + entry.m_uiDataStartOffset;
+
+  return ezArrayPtr<const ezUInt8>(pData, static_cast<ezUInt32>(entry.m_uiStoredDataSize));
+}
+
+ezResult ezArchiveReader::GetUncompressedEntryData(ezUInt32 uiEntryIdx, ezArrayPtr<const ezUInt8>& out_data) const
+{
+  if (m_ArchiveTOC.m_Entries[uiEntryIdx].m_CompressionMode != ezArchiveCompressionMode::Uncompressed)
+    return EZ_FAILURE;
+
+  out_data = GetStoredEntryData(uiEntryIdx);
+  return EZ_SUCCESS;
+}
+
+ezResult ezArchiveReader::ReadEntry(ezUInt32 uiEntryIdx, ezArrayPtr<ezUInt8> targetBuffer) const
+{
+  return ezArchiveUtils::ReadEntry(m_ArchiveTOC.m_Entries[uiEntryIdx], m_pDataStart, targetBuffer, &m_CompressionDictionary);
+}
+
+ezResult ezArchiveReader::ReadEntries(ezArrayPtr<EntryRequest> requests) const
+{
+  ezAtomicInteger32 iNumFailed;
+
+  ezParallelForParams params;
+  params.m_bAdaptive = true;
+
+  ezTaskSystem::ParallelFor<EntryRequest>(
+    requests,
+    [&](ezArrayPtr<EntryRequest> slice)
+    {
+      for (EntryRequest& request : slice)
+      {
+        request.m_Result = ReadEntry(request.m_uiEntryIdx, request.m_TargetBuffer);
+
+        if (request.m_Result.Failed())
+        {
+          iNumFailed.Increment();
+        }
+      }
+    },
+    "ezArchiveReader::ReadEntries", params);
+
+  return iNumFailed == 0 ? EZ_SUCCESS : EZ_FAILURE;
 }
 
 ezResult ezArchiveReader::ExtractFile(ezUInt32 uiEntryIdx, ezStringView sTargetFolder) const
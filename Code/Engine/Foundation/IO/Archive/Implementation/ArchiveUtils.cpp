@@ -3,12 +3,17 @@
 #include <Foundation/IO/Archive/ArchiveUtils.h>
 
 #include <Foundation/Algorithm/HashStream.h>
+#include <Foundation/IO/Archive/ArchiveCompressionDictionary.h>
 #include <Foundation/IO/CompressedStreamZstd.h>
 #include <Foundation/IO/FileSystem/FileReader.h>
 #include <Foundation/IO/MemoryMappedFile.h>
 #include <Foundation/IO/MemoryStream.h>
 #include <Foundation/Logging/Log.h>
 
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+#  include <zstd/zstd.h>
+#endif
+
 ezHybridArray<ezString, 4, ezStaticsAllocatorWrapper>& ezArchiveUtils::GetAcceptedArchiveFileExtensions()
 {
   static ezHybridArray<ezString, 4, ezStaticsAllocatorWrapper> extensions;
@@ -37,11 +42,12 @@ ezResult ezArchiveUtils::WriteHeader(ezStreamWriter& inout_stream)
   const char* szTag = "EZARCHIVE";
   EZ_SUCCEED_OR_RETURN(inout_stream.WriteBytes(szTag, 10));
 
-  const ezUInt8 uiArchiveVersion = 4;
+  const ezUInt8 uiArchiveVersion = 5;
 
   // Version 2: Added end-of-file marker for file corruption (cutoff) detection
   // Version 3: HashedStrings changed from MurmurHash to xxHash
   // Version 4: use 64 Bit string hashes
+  // Version 5: TOC stores a compression dictionary
   inout_stream << uiArchiveVersion;
 
   const ezUInt8 uiPadding[5] = {0, 0, 0, 0, 0};
@@ -62,7 +68,7 @@ ezResult ezArchiveUtils::ReadHeader(ezStreamReader& inout_stream, ezUInt8& out_u
   out_uiVersion = 0;
   inout_stream >> out_uiVersion;
 
-  if (out_uiVersion != 1 && out_uiVersion != 2 && out_uiVersion != 3 && out_uiVersion != 4)
+  if (out_uiVersion != 1 && out_uiVersion != 2 && out_uiVersion != 3 && out_uiVersion != 4 && out_uiVersion != 5)
   {
     ezLog::Error("Unsupported archive version '{}'.", out_uiVersion);
     return EZ_FAILURE;
@@ -88,12 +94,19 @@ ezResult ezArchiveUtils::ReadHeader(ezStreamReader& inout_stream, ezUInt8& out_u
 
 ezResult ezArchiveUtils::WriteEntry(
   ezStreamWriter& inout_stream, ezStringView sAbsSourcePath, ezUInt32 uiPathStringOffset, ezArchiveCompressionMode compression,
-  ezInt32 iCompressionLevel, ezArchiveEntry& inout_tocEntry, ezUInt64& inout_uiCurrentStreamPosition, FileWriteProgressCallback progress /*= FileWriteProgressCallback()*/)
+  ezInt32 iCompressionLevel, ezArchiveEntry& inout_tocEntry, ezUInt64& inout_uiCurrentStreamPosition, FileWriteProgressCallback progress /*= FileWriteProgressCallback()*/, const ezArchiveCompressionDictionary* pDictionary /*= nullptr*/)
 {
   ezFileReader file;
   EZ_SUCCEED_OR_RETURN(file.Open(sAbsSourcePath, 1024 * 1024));
 
-  const ezUInt64 uiMaxBytes = file.GetFileSize();
+  return WriteEntry(inout_stream, file, file.GetFileSize(), uiPathStringOffset, compression, iCompressionLevel, inout_tocEntry, inout_uiCurrentStreamPosition, progress, pDictionary);
+}
+
+ezResult ezArchiveUtils::WriteEntry(ezStreamWriter& inout_stream, ezStreamReader& inout_source, ezUInt64 uiSourceSize, ezUInt32 uiPathStringOffset,
+  ezArchiveCompressionMode compression, ezInt32 iCompressionLevel, ezArchiveEntry& inout_tocEntry, ezUInt64& inout_uiCurrentStreamPosition,
+  FileWriteProgressCallback progress /*= FileWriteProgressCallback()*/, const ezArchiveCompressionDictionary* pDictionary /*= nullptr*/)
+{
+  const ezUInt64 uiMaxBytes = uiSourceSize;
 
   ezUInt8 uiTemp[1024 * 8];
 
@@ -105,8 +118,13 @@ ezResult ezArchiveUtils::WriteEntry(
 
 #ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
   ezCompressedStreamWriterZstd zstdWriter;
+  ezCompressedStreamWriterZstdSeekable zstdSeekableWriter;
 #endif
 
+  // dictionary compression needs all data at once
+  ezContiguousMemoryStreamStorage dictionarySource;
+  ezMemoryStreamWriter dictionarySourceWriter(&dictionarySource);
+
   switch (compression)
   {
     case ezArchiveCompressionMode::Uncompressed:
@@ -120,6 +138,20 @@ ezResult ezArchiveUtils::WriteEntry(
       pWriter = &zstdWriter;
     }
     break;
+
+    case ezArchiveCompressionMode::Compressed_zstd_seekable:
+    {
+      zstdSeekableWriter.SetOutputStream(&inout_stream, (ezCompressedStreamWriterZstd::Compression)iCompressionLevel);
+      pWriter = &zstdSeekableWriter;
+    }
+    break;
+
+    case ezArchiveCompressionMode::Compressed_zstd_dictionary:
+    {
+      EZ_ASSERT_DEV(pDictionary != nullptr && pDictionary->IsInitializedForCompression(), "Dictionary compression requires a dictionary that is initialized for compression.");
+      pWriter = &dictionarySourceWriter;
+    }
+    break;
 #endif
 
     default:
@@ -132,7 +164,7 @@ ezResult ezArchiveUtils::WriteEntry(
   ezUInt64 uiRead = 0;
   while (true)
   {
-    uiRead = file.ReadBytes(uiTemp, EZ_ARRAY_SIZE(uiTemp));
+    uiRead = inout_source.ReadBytes(uiTemp, EZ_ARRAY_SIZE(uiTemp));
 
     if (uiRead == 0)
       break;
@@ -156,6 +188,28 @@ ezResult ezArchiveUtils::WriteEntry(
       EZ_SUCCEED_OR_RETURN(zstdWriter.FinishCompressedStream());
       inout_tocEntry.m_uiStoredDataSize = zstdWriter.GetWrittenBytes();
       break;
+
+    case ezArchiveCompressionMode::Compressed_zstd_seekable:
+      EZ_SUCCEED_OR_RETURN(zstdSeekableWriter.FinishCompressedStream());
+      inout_tocEntry.m_uiStoredDataSize = zstdSeekableWriter.GetWrittenBytes();
+      break;
+
+    case ezArchiveCompressionMode::Compressed_zstd_dictionary:
+    {
+      ezDynamicArray<ezUInt8> compressed;
+      if (dictionarySource.GetStorageSize32() > 0)
+      {
+        EZ_SUCCEED_OR_RETURN(pDictionary->Compress(ezArrayPtr<const ezUInt8>(dictionarySource.GetData(), dictionarySource.GetStorageSize32()), compressed));
+      }
+      else
+      {
+        EZ_SUCCEED_OR_RETURN(pDictionary->Compress({}, compressed));
+      }
+
+      EZ_SUCCEED_OR_RETURN(inout_stream.WriteBytes(compressed.GetData(), compressed.GetCount()));
+      inout_tocEntry.m_uiStoredDataSize = compressed.GetCount();
+      break;
+    }
 #endif
 
     case ezArchiveCompressionMode::Uncompressed:
@@ -169,7 +223,7 @@ ezResult ezArchiveUtils::WriteEntry(
   return EZ_SUCCESS;
 }
 
-ezResult ezArchiveUtils::WriteEntryOptimal(ezStreamWriter& inout_stream, ezStringView sAbsSourcePath, ezUInt32 uiPathStringOffset, ezArchiveCompressionMode compression, ezInt32 iCompressionLevel, ezArchiveEntry& ref_tocEntry, ezUInt64& inout_uiCurrentStreamPosition, FileWriteProgressCallback progress /*= FileWriteProgressCallback()*/)
+ezResult ezArchiveUtils::WriteEntryOptimal(ezStreamWriter& inout_stream, ezStringView sAbsSourcePath, ezUInt32 uiPathStringOffset, ezArchiveCompressionMode compression, ezInt32 iCompressionLevel, ezArchiveEntry& ref_tocEntry, ezUInt64& inout_uiCurrentStreamPosition, FileWriteProgressCallback progress /*= FileWriteProgressCallback()*/, const ezArchiveCompressionDictionary* pDictionary /*= nullptr*/)
 {
   if (compression == ezArchiveCompressionMode::Uncompressed)
   {
@@ -181,7 +235,7 @@ ezResult ezArchiveUtils::WriteEntryOptimal(ezStreamWriter& inout_stream, ezStrin
     ezMemoryStreamWriter writer(&storage);
 
     ezUInt64 streamPos = inout_uiCurrentStreamPosition;
-    EZ_SUCCEED_OR_RETURN(WriteEntry(writer, sAbsSourcePath, uiPathStringOffset, compression, iCompressionLevel, ref_tocEntry, streamPos, progress));
+    EZ_SUCCEED_OR_RETURN(WriteEntry(writer, sAbsSourcePath, uiPathStringOffset, compression, iCompressionLevel, ref_tocEntry, streamPos, progress, pDictionary));
 
     if (ref_tocEntry.m_uiStoredDataSize * 12 >= ref_tocEntry.m_uiUncompressedDataSize * 10)
     {
@@ -208,8 +262,15 @@ public:
 
 #endif
 
+/// Entries that can only be decompressed as a whole are decompressed up front and then read from memory.
+class ezDecompressedEntryStreamReader : public ezRawMemoryStreamReader
+{
+public:
+  ezDynamicArray<ezUInt8> m_Data;
+};
 
-ezUniquePtr<ezStreamReader> ezArchiveUtils::CreateEntryReader(const ezArchiveEntry& entry, const void* pStartOfArchiveData)
+
+ezUniquePtr<ezStreamReader> ezArchiveUtils::CreateEntryReader(const ezArchiveEntry& entry, const void* pStartOfArchiveData, const ezArchiveCompressionDictionary* pDictionary /*= nullptr*/)
 {
   ezUniquePtr<ezStreamReader> reader;
 
@@ -232,6 +293,35 @@ ezUniquePtr<ezStreamReader> ezArchiveUtils::CreateEntryReader(const ezArchiveEnt
       pRawReader->SetInputStream(&pRawReader->m_Source);
       break;
     }
+
+    case ezArchiveCompressionMode::Compressed_zstd_seekable:
+    {
+      reader = EZ_DEFAULT_NEW(ezCompressedStreamReaderZstdSeekable);
+      ezCompressedStreamReaderZstdSeekable* pSeekableReader = static_cast<ezCompressedStreamReaderZstdSeekable*>(reader.Borrow());
+
+      const ezUInt8* pStoredData = static_cast<const ezUInt8*>(ezMemoryUtils::AddByteOffset(pStartOfArchiveData, static_cast<std::ptrdiff_t>(entry.m_uiDataStartOffset)));
+      if (pSeekableReader->SetInputData(ezArrayPtr<const ezUInt8>(pStoredData, static_cast<ezUInt32>(entry.m_uiStoredDataSize))).Failed())
+      {
+        EZ_REPORT_FAILURE("Archive entry contains invalid seekable zstd data");
+      }
+      break;
+    }
+
+    case ezArchiveCompressionMode::Compressed_zstd_dictionary:
+    {
+      reader = EZ_DEFAULT_NEW(ezDecompressedEntryStreamReader);
+      ezDecompressedEntryStreamReader* pDecompressedReader = static_cast<ezDecompressedEntryStreamReader*>(reader.Borrow());
+
+      pDecompressedReader->m_Data.SetCountUninitialized(static_cast<ezUInt32>(entry.m_uiUncompressedDataSize));
+      if (ReadEntry(entry, pStartOfArchiveData, pDecompressedReader->m_Data, pDictionary).Failed())
+      {
+        EZ_REPORT_FAILURE("Archive entry could not be decompressed with the archive's dictionary");
+        pDecompressedReader->m_Data.Clear();
+      }
+
+      pDecompressedReader->Reset(pDecompressedReader->m_Data);
+      break;
+    }
 #endif
 
     default:
@@ -242,6 +332,101 @@ ezUniquePtr<ezStreamReader> ezArchiveUtils::CreateEntryReader(const ezArchiveEnt
   return std::move(reader);
 }
 
+ezResult ezArchiveUtils::ReadEntry(const ezArchiveEntry& entry, const void* pStartOfArchiveData, ezArrayPtr<ezUInt8> targetBuffer, const ezArchiveCompressionDictionary* pDictionary /*= nullptr*/)
+{
+  if (targetBuffer.GetCount() != entry.m_uiUncompressedDataSize)
+    return EZ_FAILURE;
+
+  const void* pStoredData = ezMemoryUtils::AddByteOffset(pStartOfArchiveData, static_cast<std::ptrdiff_t>(entry.m_uiDataStartOffset));
+  const size_t uiStoredSize = ezMath::SafeConvertToSizeT(entry.m_uiStoredDataSize);
+
+  switch (entry.m_CompressionMode)
+  {
+    case ezArchiveCompressionMode::Uncompressed:
+      ezMemoryUtils::RawByteCopy(targetBuffer.GetPtr(), pStoredData, uiStoredSize);
+      return EZ_SUCCESS;
+
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+    case ezArchiveCompressionMode::Compressed_zstd:
+    {
+      // the data is stored in the format of ezCompressedStreamWriterZstd, ie. as chunks with a 16 bit size prefix and a zero terminator,
+      // since the whole data is in memory, the chunks are fed to the decompressor directly, without copying them into a cache
+      ZSTD_DCtx* pContext = static_cast<ZSTD_DCtx*>(ezCompressedStreamReaderZstd::GetThreadLocalDecompressionContext());
+      ZSTD_DCtx_reset(pContext, ZSTD_reset_session_only);
+
+      ZSTD_outBuffer outBuffer;
+      outBuffer.dst = targetBuffer.GetPtr();
+      outBuffer.size = targetBuffer.GetCount();
+      outBuffer.pos = 0;
+
+      const ezUInt8* pCur = static_cast<const ezUInt8*>(pStoredData);
+      const ezUInt8* pEnd = pCur + uiStoredSize;
+
+      while (true)
+      {
+        if (pCur + sizeof(ezUInt16) > pEnd)
+          return EZ_FAILURE;
+
+        ezUInt16 uiChunkSize = 0;
+        ezMemoryUtils::RawByteCopy(&uiChunkSize, pCur, sizeof(ezUInt16));
+        pCur += sizeof(ezUInt16);
+
+        if (uiChunkSize == 0)
+          break;
+
+        if (pCur + uiChunkSize > pEnd)
+          return EZ_FAILURE;
+
+        ZSTD_inBuffer inBuffer;
+        inBuffer.src = pCur;
+        inBuffer.size = uiChunkSize;
+        inBuffer.pos = 0;
+
+        while (inBuffer.pos < inBuffer.size)
+        {
+          const size_t uiPrevInPos = inBuffer.pos;
+          const size_t uiPrevOutPos = outBuffer.pos;
+
+          const size_t res = ZSTD_decompressStream(pContext, &outBuffer, &inBuffer);
+          if (ZSTD_isError(res))
+            return EZ_FAILURE;
+
+          // no progress means that the data is larger than the target buffer
+          if (inBuffer.pos == uiPrevInPos && outBuffer.pos == uiPrevOutPos)
+            return EZ_FAILURE;
+        }
+
+        pCur += uiChunkSize;
+      }
+
+      return outBuffer.pos == outBuffer.size ? EZ_SUCCESS : EZ_FAILURE;
+    }
+
+    case ezArchiveCompressionMode::Compressed_zstd_seekable:
+    {
+      ezCompressedStreamReaderZstdSeekable reader;
+      EZ_SUCCEED_OR_RETURN(reader.SetInputData(ezArrayPtr<const ezUInt8>(static_cast<const ezUInt8*>(pStoredData), static_cast<ezUInt32>(uiStoredSize))));
+
+      if (reader.GetUncompressedSize() != targetBuffer.GetCount())
+        return EZ_FAILURE;
+
+      return reader.ReadBytes(targetBuffer.GetPtr(), targetBuffer.GetCount()) == targetBuffer.GetCount() ? EZ_SUCCESS : EZ_FAILURE;
+    }
+
+    case ezArchiveCompressionMode::Compressed_zstd_dictionary:
+    {
+      if (pDictionary == nullptr)
+        return EZ_FAILURE;
+
+      return pDictionary->Decompress(ezArrayPtr<const ezUInt8>(static_cast<const ezUInt8*>(pStoredData), static_cast<ezUInt32>(uiStoredSize)), targetBuffer);
+    }
+#endif
+
+    default:
+      return EZ_FAILURE;
+  }
+}
+
 void ezArchiveUtils::ConfigureRawMemoryStreamReader(const ezArchiveEntry& entry, const void* pStartOfArchiveData, ezRawMemoryStreamReader& ref_memReader)
 {
   ref_memReader.Reset(ezMemoryUtils::AddByteOffset(pStartOfArchiveData, static_cast<std::ptrdiff_t>(entry.m_uiDataStartOffset)), entry.m_uiStoredDataSize);
@@ -86,6 +86,38 @@ ezDataDirectoryReader* ezDataDirectory::ArchiveType::OpenFileToRead(ezStringView
         }
         break;
       }
+
+      case ezArchiveCompressionMode::Compressed_zstd_seekable:
+      {
+        if (!m_FreeReadersZstdSeekable.IsEmpty())
+        {
+          pReader = m_FreeReadersZstdSeekable.PeekBack();
+          m_FreeReadersZstdSeekable.PopBack();
+        }
+        else
+        {
+          m_ReadersZstdSeekable.PushBack(EZ_DEFAULT_NEW(ArchiveReaderZstdSeekable, 2));
+          pReader = m_ReadersZstdSeekable.PeekBack().Borrow();
+        }
+
+        static_cast<ArchiveReaderZstdSeekable*>(pReader)->m_StoredData = m_ArchiveReader.GetStoredEntryData(uiEntryIndex);
+        break;
+      }
+
+      case ezArchiveCompressionMode::Compressed_zstd_dictionary:
+      {
+        if (!m_FreeReadersZstdDictionary.IsEmpty())
+        {
+          pReader = m_FreeReadersZstdDictionary.PeekBack();
+          m_FreeReadersZstdDictionary.PopBack();
+        }
+        else
+        {
+          m_ReadersZstdDictionary.PushBack(EZ_DEFAULT_NEW(ArchiveReaderZstdDictionary, 3));
+          pReader = m_ReadersZstdDictionary.PeekBack().Borrow();
+        }
+        break;
+      }
 #endif
 
       default:
@@ -99,6 +131,23 @@ ezDataDirectoryReader* ezDataDirectory::ArchiveType::OpenFileToRead(ezStringView
 
   m_ArchiveReader.ConfigureRawMemoryStreamReader(uiEntryIndex, pReader->m_MemStreamReader);
 
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+  if (pEntry->m_CompressionMode == ezArchiveCompressionMode::Compressed_zstd_dictionary)
+  {
+    ArchiveReaderZstdDictionary* pDictReader = static_cast<ArchiveReaderZstdDictionary*>(pReader);
+    pDictReader->m_DecompressedData.SetCountUninitialized(static_cast<ezUInt32>(pEntry->m_uiUncompressedDataSize));
+
+    if (m_ArchiveReader.ReadEntry(uiEntryIndex, pDictReader->m_DecompressedData).Failed())
+    {
+      ezLog::Error("Failed to decompress '{}' from archive", sArchivePath);
+      OnReaderWriterClose(pReader);
+      return nullptr;
+    }
+
+    pReader->m_MemStreamReader.Reset(pDictReader->m_DecompressedData);
+  }
+#endif
+
   if (pReader->Open(sArchivePath, this, FileShareMode).Failed())
   {
     EZ_DEFAULT_DELETE(pReader);
@@ -221,6 +270,18 @@ void ezDataDirectory::ArchiveType::OnReaderWriterClose(ezDataDirectoryReaderWrit
     m_FreeReadersZstd.PushBack(static_cast<ArchiveReaderZstd*>(pClosed));
     return;
   }
+
+  if (pClosed->GetDataDirUserData() == 2)
+  {
+    m_FreeReadersZstdSeekable.PushBack(static_cast<ArchiveReaderZstdSeekable*>(pClosed));
+    return;
+  }
+
+  if (pClosed->GetDataDirUserData() == 3)
+  {
+    m_FreeReadersZstdDictionary.PushBack(static_cast<ArchiveReaderZstdDictionary*>(pClosed));
+    return;
+  }
 #endif
 
 
@@ -283,6 +344,36 @@ ezResult ezDataDirectory::ArchiveReaderZstd::InternalOpen(ezFileShareMode::Enum
   return EZ_SUCCESS;
 }
 
+//////////////////////////////////////////////////////////////////////////
+
+ezDataDirectory::ArchiveReaderZstdSeekable::ArchiveReaderZstdSeekable(ezInt32 iDataDirUserData)
+  : ArchiveReaderUncompressed(iDataDirUserData)
+{
+}
+
+ezDataDirectory::ArchiveReaderZstdSeekable::~ArchiveReaderZstdSeekable() = default;
+
+ezUInt64 ezDataDirectory::ArchiveReaderZstdSeekable::Read(void* pBuffer, ezUInt64 uiBytes)
+{
+  return m_CompressedStreamReader.ReadBytes(pBuffer, uiBytes);
+}
+
+ezResult ezDataDirectory::ArchiveReaderZstdSeekable::InternalOpen(ezFileShareMode::Enum FileShareMode)
+{
+  EZ_ASSERT_DEBUG(FileShareMode != ezFileShareMode::Exclusive, "Archives only support shared reading of files. Exclusive access cannot be guaranteed.");
+
+  return m_CompressedStreamReader.SetInputData(m_StoredData);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+ezDataDirectory::ArchiveReaderZstdDictionary::ArchiveReaderZstdDictionary(ezInt32 iDataDirUserData)
+  : ArchiveReaderUncompressed(iDataDirUserData)
+{
+}
+
+ezDataDirectory::ArchiveReaderZstdDictionary::~ArchiveReaderZstdDictionary() = default;
+
 #endif
 
 //////////////////////////////////////////////////////////////////////////
@@ -32,6 +32,12 @@ public:
   /// However, since this is a compressed stream, the decompression still needs to be done, so this won't save any time.
   virtual ezUInt64 ReadBytes(void* pReadBuffer, ezUInt64 uiBytesToRead) override; // [tested]
 
+  /// \brief Returns a decompression context (ZSTD_DCtx) of the calling thread, which is only created once per thread.
+  ///
+  /// Meant for decompressions that are finished within a single call, so that reading many small pieces of data doesn't create a
+  /// context every time. The context must not be kept, since it is deleted when the thread exits.
+  static /*ZSTD_DCtx*/ void* GetThreadLocalDecompressionContext();
+
 private:
   ezResult RefillReadCache();
 
@@ -154,4 +160,101 @@ private:
   ezDynamicArray<ezUInt8> m_CompressedCache;
 };
 
+/// \brief A stream writer that compresses the incoming data in blocks of fixed size, which can be decompressed independently of each other.
+///
+/// In contrast to ezCompressedStreamWriterZstd, the output can be read with random access through ezCompressedStreamReaderZstdSeekable,
+/// for the cost of decompressing a single block, instead of everything in front of the requested position. Since every block is compressed
+/// on its own, the compression ratio is a bit worse, the smaller the blocks are.
+///
+/// After all blocks a jump table with the offset of each block is written. Blocks that don't get smaller through compression are stored uncompressed.
+class EZ_FOUNDATION_DLL ezCompressedStreamWriterZstdSeekable final : public ezStreamWriter
+{
+public:
+  ezCompressedStreamWriterZstdSeekable();
+
+  /// \brief The constructor takes another stream writer to pass the output into, a compression level and the size of the blocks.
+  ezCompressedStreamWriterZstdSeekable(ezStreamWriter* pOutputStream, ezCompressedStreamWriterZstd::Compression ratio = ezCompressedStreamWriterZstd::Compression::Default, ezUInt32 uiBlockSizeKB = 64); // [tested]
+
+  /// \brief Calls FinishCompressedStream() internally.
+  ~ezCompressedStreamWriterZstdSeekable(); // [tested]
+
+  /// \brief Configures to which other ezStreamWriter the compressed data should be passed along. Finishes the previous stream, if there was one.
+  void SetOutputStream(ezStreamWriter* pOutputStream, ezCompressedStreamWriterZstd::Compression ratio = ezCompressedStreamWriterZstd::Compression::Default, ezUInt32 uiBlockSizeKB = 64); // [tested]
+
+  /// \brief Compresses \a uiBytesToWrite from \a pWriteBuffer. Whenever a block is full, it is compressed and written to the output stream.
+  virtual ezResult WriteBytes(const void* pWriteBuffer, ezUInt64 uiBytesToWrite) override; // [tested]
+
+  /// \brief Writes the last (partial) block and the jump table. After calling this function, no more data can be written to the stream.
+  ezResult FinishCompressedStream(); // [tested]
+
+  /// \brief Returns the size of the data in its uncompressed state.
+  ezUInt64 GetUncompressedSize() const { return m_uiUncompressedSize; } // [tested]
+
+  /// \brief Returns the exact number of bytes written to the output stream so far, including the jump table.
+  ezUInt64 GetWrittenBytes() const { return m_uiWrittenBytes; } // [tested]
+
+private:
+  ezResult WriteBlock();
+
+  ezUInt64 m_uiUncompressedSize = 0;
+  ezUInt64 m_uiWrittenBytes = 0;
+  ezUInt32 m_uiBlockSize = 0;
+  ezInt32 m_iCompressionLevel = 0;
+
+  ezStreamWriter* m_pOutputStream = nullptr;
+  /*ZSTD_CCtx*/ void* m_pZstdCCtx = nullptr;
+
+  ezDynamicArray<ezUInt8> m_Block;
+  ezDynamicArray<ezUInt8> m_CompressedBlock;
+  ezDynamicArray<ezUInt64> m_BlockOffsets;
+};
+
+/// \brief A stream reader for data that was written with ezCompressedStreamWriterZstdSeekable.
+///
+/// The entire compressed data has to be available in memory (e.g. through a memory mapped file). Only the blocks that are actually read
+/// get decompressed, so SkipBytes() and SetReadPosition() are cheap and reading from an arbitrary position only costs the decompression of
+/// the affected blocks. The most recently decompressed block is cached.
+///
+/// Every block is decompressed on its own, with the decompression context of the calling thread, so creating a reader is cheap.
+class EZ_FOUNDATION_DLL ezCompressedStreamReaderZstdSeekable : public ezStreamReader
+{
+public:
+  ezCompressedStreamReaderZstdSeekable(); // [tested]
+  ~ezCompressedStreamReaderZstdSeekable(); // [tested]
+
+  /// \brief Sets the compressed data to read from. The memory has to stay valid as long as the reader is used.
+  ///
+  /// Returns EZ_FAILURE, if the data doesn't contain a valid jump table.
+  ezResult SetInputData(ezArrayPtr<const ezUInt8> compressedData); // [tested]
+
+  /// \brief Reads either uiBytesToRead or the amount of remaining bytes in the stream into pReadBuffer.
+  ///
+  /// It is valid to pass nullptr for pReadBuffer, in this case the read position is only advanced by the given number of bytes.
+  virtual ezUInt64 ReadBytes(void* pReadBuffer, ezUInt64 uiBytesToRead) override; // [tested]
+
+  /// \brief Advances the read position without decompressing anything.
+  virtual ezUInt64 SkipBytes(ezUInt64 uiBytesToSkip) override; // [tested]
+
+  /// \brief Moves the read position to the given byte offset in the uncompressed data. Positions past the end are clamped.
+  void SetReadPosition(ezUInt64 uiPosition); // [tested]
+
+  ezUInt64 GetReadPosition() const { return m_uiReadPosition; } // [tested]
+
+  /// \brief Returns the size of the data in its uncompressed state.
+  ezUInt64 GetUncompressedSize() const { return m_uiUncompressedSize; } // [tested]
+
+private:
+  ezResult DecompressBlock(ezUInt32 uiBlockIdx, void* pTarget);
+
+  ezArrayPtr<const ezUInt8> m_CompressedData;
+  const ezUInt8* m_pJumpTable = nullptr;
+  ezUInt64 m_uiUncompressedSize = 0;
+  ezUInt64 m_uiReadPosition = 0;
+  ezUInt32 m_uiBlockSize = 0;
+  ezUInt32 m_uiNumBlocks = 0;
+
+  ezUInt32 m_uiCachedBlock = ezInvalidIndex;
+  ezDynamicArray<ezUInt8> m_BlockCache;
+};
+
 #endif // BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
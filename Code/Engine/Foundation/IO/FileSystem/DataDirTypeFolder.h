@@ -22,6 +22,41 @@ namespace ezDataDirectory
     /// \brief The factory that can be registered at ezFileSystem to create data directories of this type.
     static ezDataDirectoryType* Factory(ezStringView sDataDirectory, ezStringView sGroup, ezStringView sRootName, ezFileSystem::DataDirUsage usage);
 
+    /// \brief Same as Factory(), but the created data directories keep an index of all the files and folders inside them.
+    ///
+    /// Every mounted data directory is asked for every relative path until one of them has the file, so most lookups are misses.
+    /// With the index those misses are answered without asking the OS. The index is built when the data directory is mounted,
+    /// or loaded from s_sFileIndexCacheFolder if nothing changed since it was stored there. Files written or deleted through the data
+    /// directory are added and removed right away. Changes made by other means are picked up through an ezDirectoryWatcher,
+    /// a background thread applies them every s_FileIndexUpdateInterval, or UpdateFileIndex() applies them right away.
+    /// If s_bWatchIndexedDataDirectories is disabled, such files are never found until the data directory is mounted again.
+    ///
+    /// Register it with a higher priority than Factory() to mount all folders with an index.
+    /// Without support for file iterators, file stats and directory watchers it behaves exactly like Factory().
+    static ezDataDirectoryType* IndexedFactory(ezStringView sDataDirectory, ezStringView sGroup, ezStringView sRootName, ezFileSystem::DataDirUsage usage);
+
+    /// \brief If not empty, indexed data directories store their index in this folder and reuse it when they are mounted the next time.
+    ///
+    /// A stored index is only used if no folder inside the data directory was modified in between, which takes one stat per folder
+    /// instead of listing the whole directory tree.
+    static ezString s_sFileIndexCacheFolder;
+
+    /// \brief Whether indexed data directories watch their folder for changes that are not done through the data directory. On by default.
+    ///
+    /// Can be disabled for data that never changes while the application runs, since opening the watcher has to visit every folder once.
+    static bool s_bWatchIndexedDataDirectories;
+
+    /// \brief How often the background thread applies the changes reported by the directory watchers to the file indices.
+    ///
+    /// Lookups never ask the directory watcher themselves, so a file created by another process is only found after up to this much time.
+    static ezTime s_FileIndexUpdateInterval;
+
+    /// \brief Whether this data directory keeps an index of its files, see IndexedFactory().
+    bool HasFileIndex() const { return m_pFileIndex != nullptr; }
+
+    /// \brief Applies all changes that the directory watcher reported so far to the file index.
+    void UpdateFileIndex();
+
     /// A 'redirection file' is an optional file located inside a data directory that lists which file access is redirected to which other
     /// file lookup. Each redirection is one line in the file (terminated by a \n). Each line consists of the 'key' string, a semicolon and
     /// a 'value' string. No unnecessary whitespace is allowed. When a file that matches 'key' is accessed through a mounted data directory,
@@ -61,6 +96,11 @@ namespace ezDataDirectory
 
     void LoadRedirectionFile();
 
+    struct FileIndex;
+
+    /// \brief Creates the file index, called by 'IndexedFactory' before the data directory is initialized.
+    void EnableFileIndex();
+
     mutable ezMutex m_ReaderWriterMutex; ///< Locks m_Readers / m_Writers as well as the m_bIsInUse flag of each reader / writer.
     ezHybridArray<ezDataDirectory::FolderReader*, 4> m_Readers;
     ezHybridArray<ezDataDirectory::FolderWriter*, 4> m_Writers;
@@ -68,6 +108,8 @@ namespace ezDataDirectory
     mutable ezMutex m_RedirectionMutex;
     ezMap<ezString, ezString> m_FileRedirection;
     ezString128 m_sRedirectedDataDirPath;
+
+    FileIndex* m_pFileIndex = nullptr;
   };
 
 
@@ -34,11 +34,11 @@
 /// This allows to hook into the system and implement stuff like automatic asset transformations before/after certain
 /// file accesses, checking out files from revision control systems, or simply logging all file activity.
 ///
-/// All operations that go through the ezFileSystem are protected by a mutex, which means that opening, closing, deleting
-/// files, as well as adding or removing data directories etc. will be synchronized and cannot happen in parallel.
-/// Reading/writing file streams can happen in parallel, only the administrative tasks need to be protected.
+/// The list of data directories is published as an immutable snapshot. Opening, resolving and checking files only reads the current
+/// snapshot and never takes a lock, so any number of threads can do that in parallel. Adding or removing data directories
+/// is synchronized with a mutex, builds a new snapshot and swaps it in. Old snapshots are deleted once no thread reads them anymore.
 /// File events are broadcast as they occur, that means they will be executed on whichever thread triggered them.
-/// Since they are executed from within the filesystem mutex, they cannot occur in parallel.
+/// The event uses its own mutex, so handlers are never executed in parallel.
 class EZ_FOUNDATION_DLL ezFileSystem
 {
 public:
@@ -65,8 +65,8 @@ public:
 
   /// \name Data Directory Modifications
   ///
-  /// All functions that add / remove data directories are not thread safe and require that this is done
-  /// on a single thread with no other thread accessing anything in ezFileSystem simultaneously.
+  /// Data directories can be added while other threads access files, those threads either still see the previous data directories
+  /// or already the new ones. Removing a data directory deletes it right away, so no other thread may access files in it at that time.
   ///@{
 
   /// \brief This factory creates a data directory type, if it can handle the given data directory. Otherwise it returns nullptr.
@@ -84,7 +84,7 @@ public:
   static void RegisterDataDirectoryFactory(ezDataDirFactory factory, float fPriority = 0); // [tested]
 
   /// \brief Will remove all known data directory factories.
-  static void ClearAllDataDirectoryFactories() { s_pData->m_DataDirFactories.Clear(); } // [tested]
+  static void ClearAllDataDirectoryFactories(); // [tested]
 
   /// \brief Adds a data directory. It will try all the registered factories to find a data directory type that can handle the given path.
   ///
@@ -187,8 +187,9 @@ public:
   /// \name Misc
   ///@{
 
-  /// \brief Returns the (recursive) mutex that is used internally by the file system which can be used to guard bundled operations on the file
-  /// system.
+  /// \brief Returns the (recursive) mutex that is used internally by the file system to synchronize changes to the data directories.
+  ///
+  /// It can be used to guard bundled modifications of the data directories. Accessing files does not lock this mutex.
   static ezMutex& GetMutex();
 
 #if EZ_ENABLED(EZ_SUPPORTS_FILE_ITERATORS)
@@ -307,22 +308,35 @@ private:
     ezDataDirFactory m_Factory;
   };
 
-  struct FileSystemData
-  {
-    ezHybridArray<Factory, 4> m_DataDirFactories;
-    ezHybridArray<DataDirectory, 16> m_DataDirectories;
+  /// \brief An immutable list of data directories, see DataDirReadScope.
+  struct DataDirSnapshot;
+  struct FileSystemData;
 
-    ezEvent<const FileEvent&, ezMutex> m_Event;
-    ezMutex m_FsMutex;
-  };
+  /// \brief Gives lock-free read access to the current data directories.
+  ///
+  /// The snapshot and every ezDataDirectoryType in it stay alive until the scope ends, even if they are removed in the meantime.
+  /// Pointers to data directories taken from the scope must not be used after it ends.
+  class DataDirReadScope;
 
   /// \brief Returns a list of data directory categories that were embedded in the path.
   static ezStringView ExtractRootName(ezStringView sFile, ezString& rootName);
 
   /// \brief Returns the given path relative to its data directory. The path must be inside the given data directory.
-  static ezStringView GetDataDirRelativePath(ezStringView sFile, ezUInt32 uiDataDir);
+  static ezStringView GetDataDirRelativePath(ezStringView sFile, const ezDataDirectoryType* pDataDir);
+
+  static const DataDirectory* GetDataDirForRoot(const DataDirSnapshot& dataDirs, const ezString& sRoot);
+
+  /// \brief Replaces the current data directories and deletes all replaced snapshots that no reader can access anymore.
+  /// Must be called with the file system mutex held.
+  static void PublishDataDirectories(DataDirSnapshot* pDataDirs);
+
+  /// \brief Broadcasts the removal and publishes the data directories without it. Must be called with the file system mutex held.
+  ///
+  /// The data directory is only deleted once the snapshot that still contains it is deleted, i.e. when no reader can access it anymore.
+  static void RemoveDataDirectoryAt(ezUInt32 uiDataDirIndex);
 
-  static DataDirectory* GetDataDirForRoot(const ezString& sRoot);
+  /// \brief Broadcasts the event, if any event handlers are registered.
+  static void BroadcastFileEvent(const FileEvent& fileEvent);
 
   static void CleanUpRootName(ezStringBuilder& sRoot);
 
@@ -1,8 +1,19 @@
 #include <Foundation/FoundationPCH.h>
 
+#include <Foundation/Algorithm/HashingUtils.h>
 #include <Foundation/Configuration/Startup.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/IO/DirectoryWatcher.h>
 #include <Foundation/IO/FileSystem/DataDirTypeFolder.h>
+#include <Foundation/IO/MemoryStream.h>
 #include <Foundation/Logging/Log.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Threading/ThreadSignal.h>
+#include <Foundation/Types/UniquePtr.h>
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
 
 // clang-format off
 EZ_BEGIN_SUBSYSTEM_DECLARATION(Foundation, FolderDataDirectory)
@@ -23,6 +34,529 @@ namespace ezDataDirectory
 {
   ezString FolderType::s_sRedirectionFile;
   ezString FolderType::s_sRedirectionPrefix;
+  ezString FolderType::s_sFileIndexCacheFolder;
+  bool FolderType::s_bWatchIndexedDataDirectories = true;
+  ezTime FolderType::s_FileIndexUpdateInterval = ezTime::MakeFromMilliseconds(50);
+
+  /// \brief All files and folders inside an indexed data directory.
+  ///
+  /// The keys are the paths relative to the data directory, lower case on platforms where paths are case insensitive.
+  struct FolderType::FileIndex
+  {
+    static constexpr ezUInt32 s_uiCacheVersion = 1;
+    static constexpr ezUInt32 s_uiCacheEndMarker = 0x78646E49; // 'Indx', detects files that were not written completely
+
+    struct Entry
+    {
+      ezTimestamp m_LastModificationTime; ///< Only stored for folders, to validate the cached index.
+      bool m_bIsDirectory = false;
+    };
+
+    /// \brief A change to the index that is gathered without holding any lock and applied later.
+    struct Change
+    {
+      ezString m_sPath;
+      ezTimestamp m_LastModificationTime;
+      bool m_bRemove = false;
+      bool m_bIsDirectory = false;
+    };
+
+    /// Lookups only need shared access, only changes to m_Entries are exclusive.
+    mutable std::shared_mutex m_EntriesMutex;
+    ezStringBuilder m_sRootPath;
+    ezTimestamp m_RootModificationTime;
+    ezHashTable<ezString, Entry> m_Entries;
+
+#if EZ_ENABLED(EZ_SUPPORTS_DIRECTORY_WATCHER)
+    class WatcherThread;
+
+    ezMutex m_WatcherMutex; ///< ezDirectoryWatcher is not thread-safe, the watcher thread and UpdateFileIndex() both ask it for changes.
+    ezUniquePtr<ezDirectoryWatcher> m_pWatcher;
+
+    /// The indices whose directory watchers are polled by s_pWatcherThread. The thread only runs while there are any.
+    static ezMutex s_WatchedIndicesMutex;
+    static ezDynamicArray<FileIndex*> s_WatchedIndices;
+    static WatcherThread* s_pWatcherThread;
+
+    ~FileIndex()
+    {
+      StopWatching();
+    }
+#endif
+
+    ezResult Initialize(ezStringView sRootPath)
+    {
+      m_sRootPath = sRootPath;
+      m_sRootPath.MakeCleanPath();
+      m_sRootPath.Trim(nullptr, "/");
+
+      if (!ezPathUtils::IsAbsolutePath(m_sRootPath))
+        return EZ_FAILURE;
+
+#if EZ_ENABLED(EZ_SUPPORTS_DIRECTORY_WATCHER)
+      // start watching before the index is built, so that no change can slip through in between
+      if (s_bWatchIndexedDataDirectories)
+      {
+        m_pWatcher = EZ_DEFAULT_NEW(ezDirectoryWatcher);
+        EZ_SUCCEED_OR_RETURN(m_pWatcher->OpenDirectory(m_sRootPath, ezDirectoryWatcher::Watch::Creates | ezDirectoryWatcher::Watch::Deletes | ezDirectoryWatcher::Watch::Renames | ezDirectoryWatcher::Watch::Subdirectories));
+      }
+#endif
+
+      if (s_sFileIndexCacheFolder.IsEmpty() || LoadCache().Failed())
+      {
+        EZ_SUCCEED_OR_RETURN(Build());
+        SaveCache();
+      }
+
+#if EZ_ENABLED(EZ_SUPPORTS_DIRECTORY_WATCHER)
+      if (m_pWatcher != nullptr)
+      {
+        StartWatching();
+      }
+#endif
+
+      return EZ_SUCCESS;
+    }
+
+#if EZ_ENABLED(EZ_SUPPORTS_DIRECTORY_WATCHER)
+    void StartWatching();
+    void StopWatching();
+#endif
+
+    /// \brief Turns a path inside the data directory into the key of its entry. Returns false for paths that the index can't answer.
+    bool MakeKey(ezStringView sPath, ezStringBuilder& out_sKey) const
+    {
+      out_sKey = sPath;
+      out_sKey.MakeCleanPath();
+
+      if (ezPathUtils::IsAbsolutePath(out_sKey))
+      {
+        if (!out_sKey.StartsWith_NoCase(m_sRootPath))
+          return false;
+
+        const char* szRest = out_sKey.GetData() + m_sRootPath.GetElementCount();
+        if (*szRest != '\0' && !ezPathUtils::IsPathSeparator(*szRest))
+          return false;
+
+        out_sKey.Shrink(m_sRootPath.GetCharacterCount(), 0);
+      }
+      else if (ezPathUtils::IsRootedPath(out_sKey))
+      {
+        return false;
+      }
+
+      out_sKey.Trim("/");
+
+      if (out_sKey.IsEmpty() || out_sKey == ".." || out_sKey.StartsWith("../"))
+        return false;
+
+#if EZ_ENABLED(EZ_SUPPORTS_CASE_INSENSITIVE_PATHS)
+      out_sKey.ToLower();
+#endif
+
+      return true;
+    }
+
+    bool ContainsKey(ezStringView sKey, bool bAllowDirectories) const
+    {
+      std::shared_lock<std::shared_mutex> lock(m_EntriesMutex);
+
+      const Entry* pEntry = m_Entries.GetValue(sKey);
+      return pEntry != nullptr && (bAllowDirectories || !pEntry->m_bIsDirectory);
+    }
+
+    /// \brief Returns false, if the index knows that nothing exists at the given path. Files only, unless bAllowDirectories is set.
+    ///
+    /// Never asks the OS or the directory watcher, changes made by someone else are applied by the watcher thread.
+    bool MightExist(ezStringView sPath, bool bAllowDirectories) const
+    {
+      ezStringBuilder sKey;
+      if (!MakeKey(sPath, sKey))
+        return true;
+
+      return ContainsKey(sKey, bAllowDirectories);
+    }
+
+    /// \brief Adds the entry for the given path and all its parent folders. m_EntriesMutex must be locked exclusively.
+    void AddPath(ezStringView sPath, bool bIsDirectory, ezTimestamp lastModificationTime = {})
+    {
+      ezStringBuilder sKey;
+      if (!MakeKey(sPath, sKey))
+        return;
+
+      Entry entry;
+      entry.m_bIsDirectory = bIsDirectory;
+      entry.m_LastModificationTime = lastModificationTime;
+      m_Entries.Insert(sKey, entry);
+
+      // writing a file creates the folders that lead to it
+      Entry folderEntry;
+      folderEntry.m_bIsDirectory = true;
+
+      sKey.PathParentDirectory();
+      sKey.Trim(nullptr, "/");
+      while (!sKey.IsEmpty() && !m_Entries.Contains(sKey))
+      {
+        m_Entries.Insert(sKey, folderEntry);
+
+        sKey.PathParentDirectory();
+        sKey.Trim(nullptr, "/");
+      }
+    }
+
+    /// \brief Removes the entry for the given path, and everything inside it if it is a folder. m_EntriesMutex must be locked exclusively.
+    void RemovePath(ezStringView sPath)
+    {
+      ezStringBuilder sKey;
+      if (!MakeKey(sPath, sKey))
+        return;
+
+      Entry entry;
+      if (!m_Entries.Remove(sKey, &entry) || !entry.m_bIsDirectory)
+        return;
+
+      sKey.Append("/");
+      for (auto it = m_Entries.GetIterator(); it.IsValid();)
+      {
+        if (it.Key().StartsWith(sKey))
+          it = m_Entries.Remove(it);
+        else
+          ++it;
+      }
+    }
+
+    void AddPathLocked(ezStringView sPath, bool bIsDirectory)
+    {
+      std::unique_lock<std::shared_mutex> lock(m_EntriesMutex);
+      AddPath(sPath, bIsDirectory);
+    }
+
+    void RemovePathLocked(ezStringView sPath)
+    {
+      std::unique_lock<std::shared_mutex> lock(m_EntriesMutex);
+      RemovePath(sPath);
+    }
+
+    void ApplyChanges(const ezDynamicArray<Change>& changes)
+    {
+      std::unique_lock<std::shared_mutex> lock(m_EntriesMutex);
+
+      for (const Change& change : changes)
+      {
+        if (change.m_bRemove)
+          RemovePath(change.m_sPath);
+        else
+          AddPath(change.m_sPath, change.m_bIsDirectory, change.m_LastModificationTime);
+      }
+    }
+
+    /// \brief Lists everything inside the given absolute folder path. Doesn't access the index, so no lock is needed.
+    static void GatherFolderContent(ezStringView sFolder, ezDynamicArray<Change>& ref_changes)
+    {
+#if EZ_ENABLED(EZ_SUPPORTS_FILE_ITERATORS)
+      ezStringBuilder sPath;
+
+      ezFileSystemIterator it;
+      for (it.StartSearch(sFolder, ezFileSystemIteratorFlags::ReportFilesAndFoldersRecursive); it.IsValid(); it.Next())
+      {
+        const ezFileStats& stats = it.GetStats();
+        stats.GetFullPath(sPath);
+
+        Change& change = ref_changes.ExpandAndGetRef();
+        change.m_sPath = sPath;
+        change.m_bIsDirectory = stats.m_bIsDirectory;
+
+        if (stats.m_bIsDirectory)
+        {
+          change.m_LastModificationTime = stats.m_LastModificationTime;
+        }
+      }
+#endif
+    }
+
+    ezResult Build()
+    {
+#if EZ_ENABLED(EZ_SUPPORTS_FILE_STATS)
+      ezFileStats rootStats;
+      EZ_SUCCEED_OR_RETURN(ezOSFile::GetFileStats(m_sRootPath, rootStats));
+      m_RootModificationTime = rootStats.m_LastModificationTime;
+
+      ezDynamicArray<Change> content;
+      GatherFolderContent(m_sRootPath, content);
+
+      {
+        std::unique_lock<std::shared_mutex> lock(m_EntriesMutex);
+        m_Entries.Clear();
+      }
+
+      ApplyChanges(content);
+      return EZ_SUCCESS;
+#else
+      return EZ_FAILURE;
+#endif
+    }
+
+    /// \brief Applies all changes that the directory watcher reported so far. Returns whether there were any.
+    bool ApplyWatcherChanges()
+    {
+#if EZ_ENABLED(EZ_SUPPORTS_DIRECTORY_WATCHER)
+      if (m_pWatcher == nullptr)
+        return false;
+
+      ezDynamicArray<Change> changes;
+
+      {
+        EZ_LOCK(m_WatcherMutex);
+
+        m_pWatcher->EnumerateChanges([&](ezStringView sFilename, ezDirectoryWatcherAction action, ezDirectoryWatcherType type)
+          {
+            switch (action)
+            {
+              case ezDirectoryWatcherAction::Added:
+              case ezDirectoryWatcherAction::RenamedNewName:
+              {
+                Change& change = changes.ExpandAndGetRef();
+                change.m_sPath = sFilename;
+                change.m_bIsDirectory = (type == ezDirectoryWatcherType::Directory);
+
+                // a folder that is moved into the data directory is only reported as a whole
+                if (type == ezDirectoryWatcherType::Directory)
+                  GatherFolderContent(sFilename, changes);
+                break;
+              }
+
+              case ezDirectoryWatcherAction::Removed:
+              case ezDirectoryWatcherAction::RenamedOldName:
+              {
+                Change& change = changes.ExpandAndGetRef();
+                change.m_sPath = sFilename;
+                change.m_bRemove = true;
+                break;
+              }
+
+              default:
+                break;
+            } });
+
+        // the changes have to be applied in the order in which they were reported
+        if (!changes.IsEmpty())
+        {
+          ApplyChanges(changes);
+        }
+      }
+
+      return !changes.IsEmpty();
+#else
+      return false;
+#endif
+    }
+
+    void GetCacheFile(ezStringBuilder& out_sCacheFile) const
+    {
+      out_sCacheFile.SetFormat("{}/{}.ezFileIndex", s_sFileIndexCacheFolder, ezArgU(ezHashingUtils::xxHash64String(m_sRootPath), 16, true, 16));
+      out_sCacheFile.MakeCleanPath();
+    }
+
+    /// \brief Loads the index stored by SaveCache(), if no folder was modified since then.
+    ezResult LoadCache()
+    {
+#if EZ_DISABLED(EZ_SUPPORTS_FILE_STATS)
+      return EZ_FAILURE;
+#else
+      ezStringBuilder sCacheFile;
+      GetCacheFile(sCacheFile);
+
+      ezDynamicArray<ezUInt8> content;
+      {
+        ezOSFile file;
+        EZ_SUCCEED_OR_RETURN(file.Open(sCacheFile, ezFileOpenMode::Read));
+        file.ReadAll(content);
+      }
+
+      ezRawMemoryStreamReader stream(content);
+
+      ezUInt32 uiVersion = 0;
+      stream >> uiVersion;
+
+      ezStringBuilder sRootPath;
+      if (uiVersion != s_uiCacheVersion || stream.ReadString(sRootPath).Failed() || sRootPath != m_sRootPath)
+        return EZ_FAILURE;
+
+      ezFileStats stats;
+      ezTimestamp rootModificationTime;
+      stream >> rootModificationTime;
+
+      if (ezOSFile::GetFileStats(m_sRootPath, stats).Failed() || !stats.m_LastModificationTime.Compare(rootModificationTime, ezTimestamp::CompareMode::Identical))
+        return EZ_FAILURE;
+
+      ezUInt32 uiNumEntries = 0;
+      stream >> uiNumEntries;
+
+      ezHashTable<ezString, Entry> entries;
+      entries.Reserve(uiNumEntries);
+
+      ezStringBuilder sKey;
+      ezStringBuilder sPath;
+      for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+      {
+        Entry entry;
+        EZ_SUCCEED_OR_RETURN(stream.ReadString(sKey));
+        stream >> entry.m_bIsDirectory;
+
+        if (entry.m_bIsDirectory)
+        {
+          stream >> entry.m_LastModificationTime;
+
+          // adding or removing anything in a folder changes the modification time of that folder, changed file content doesn't matter here
+          sPath = m_sRootPath;
+          sPath.AppendPath(sKey);
+
+          if (ezOSFile::GetFileStats(sPath, stats).Failed() || !stats.m_bIsDirectory || !stats.m_LastModificationTime.Compare(entry.m_LastModificationTime, ezTimestamp::CompareMode::Identical))
+            return EZ_FAILURE;
+        }
+
+        entries.Insert(sKey, entry);
+      }
+
+      ezUInt32 uiEndMarker = 0;
+      stream >> uiEndMarker;
+
+      if (uiEndMarker != s_uiCacheEndMarker)
+        return EZ_FAILURE;
+
+      m_RootModificationTime = rootModificationTime;
+
+      std::unique_lock<std::shared_mutex> lock(m_EntriesMutex);
+      m_Entries.Swap(entries);
+      return EZ_SUCCESS;
+#endif
+    }
+
+    void SaveCache() const
+    {
+      if (s_sFileIndexCacheFolder.IsEmpty())
+        return;
+
+      // modification times only have a resolution of seconds on some platforms,
+      // so a folder that was modified just now could change again without it being detected at the next start
+      const ezTimestamp recentTime = ezTimestamp::CurrentTimestamp() - ezTime::MakeFromSeconds(2);
+
+      if (m_RootModificationTime.GetInt64(ezSIUnitOfTime::Microsecond) > recentTime.GetInt64(ezSIUnitOfTime::Microsecond))
+        return;
+
+      ezDynamicArray<ezUInt8> content;
+      ezMemoryStreamContainerWrapperStorage<ezDynamicArray<ezUInt8>> storage(&content);
+      ezMemoryStreamWriter stream(&storage);
+
+      stream << s_uiCacheVersion;
+      stream << m_sRootPath;
+      stream << m_RootModificationTime;
+      stream << m_Entries.GetCount();
+
+      for (auto it = m_Entries.GetIterator(); it.IsValid(); ++it)
+      {
+        const Entry& entry = it.Value();
+
+        if (entry.m_bIsDirectory && entry.m_LastModificationTime.GetInt64(ezSIUnitOfTime::Microsecond) > recentTime.GetInt64(ezSIUnitOfTime::Microsecond))
+          return;
+
+        stream << it.Key();
+        stream << entry.m_bIsDirectory;
+
+        if (entry.m_bIsDirectory)
+        {
+          stream << entry.m_LastModificationTime;
+        }
+      }
+
+      stream << s_uiCacheEndMarker;
+
+      ezStringBuilder sCacheFile;
+      GetCacheFile(sCacheFile);
+
+      ezOSFile file;
+      if (file.Open(sCacheFile, ezFileOpenMode::Write).Failed() || file.Write(content.GetData(), content.GetCount()).Failed())
+      {
+        ezLog::Warning("Could not store the file index of '{}' in '{}'", m_sRootPath, sCacheFile);
+      }
+    }
+  };
+
+#if EZ_ENABLED(EZ_SUPPORTS_DIRECTORY_WATCHER)
+
+  ezMutex FolderType::FileIndex::s_WatchedIndicesMutex;
+  ezDynamicArray<FolderType::FileIndex*> FolderType::FileIndex::s_WatchedIndices;
+  FolderType::FileIndex::WatcherThread* FolderType::FileIndex::s_pWatcherThread = nullptr;
+
+  /// \brief Applies the changes reported by the directory watchers of all indexed data directories every s_FileIndexUpdateInterval.
+  ///
+  /// This way lookups that miss the index never have to ask a directory watcher, which would cost a system call and a lock.
+  class FolderType::FileIndex::WatcherThread : public ezThread
+  {
+  public:
+    WatcherThread()
+      : ezThread("File Index Watcher")
+    {
+    }
+
+    std::atomic<bool> m_bStop = false;
+    ezThreadSignal m_Signal;
+
+  private:
+    virtual ezUInt32 Run() override
+    {
+      while (!m_bStop.load())
+      {
+        m_Signal.WaitForSignal(s_FileIndexUpdateInterval);
+
+        // StopWatching() takes the same lock, so no index can be deleted while its changes are applied
+        EZ_LOCK(s_WatchedIndicesMutex);
+
+        for (FileIndex* pIndex : s_WatchedIndices)
+        {
+          pIndex->ApplyWatcherChanges();
+        }
+      }
+
+      return 0;
+    }
+  };
+
+  void FolderType::FileIndex::StartWatching()
+  {
+    EZ_LOCK(s_WatchedIndicesMutex);
+
+    s_WatchedIndices.PushBack(this);
+
+    if (s_pWatcherThread == nullptr)
+    {
+      s_pWatcherThread = EZ_DEFAULT_NEW(WatcherThread);
+      s_pWatcherThread->Start();
+    }
+  }
+
+  void FolderType::FileIndex::StopWatching()
+  {
+    WatcherThread* pThreadToStop = nullptr;
+
+    {
+      EZ_LOCK(s_WatchedIndicesMutex);
+
+      if (!s_WatchedIndices.RemoveAndSwap(this) || !s_WatchedIndices.IsEmpty())
+        return;
+
+      pThreadToStop = s_pWatcherThread;
+      s_pWatcherThread = nullptr;
+    }
+
+    // the thread needs the lock to finish its current round, so it is joined without holding it
+    pThreadToStop->m_bStop = true;
+    pThreadToStop->m_Signal.RaiseSignal();
+    pThreadToStop->Join();
+    EZ_DEFAULT_DELETE(pThreadToStop);
+  }
+
+#endif
 
   ezResult FolderReader::InternalOpen(ezFileShareMode::Enum FileShareMode)
   {
@@ -81,6 +615,37 @@ namespace ezDataDirectory
     return nullptr;
   }
 
+  ezDataDirectoryType* FolderType::IndexedFactory(ezStringView sDataDirectory, ezStringView sGroup, ezStringView sRootName, ezFileSystem::DataDirUsage usage)
+  {
+    FolderType* pDataDir = EZ_DEFAULT_NEW(FolderType);
+    pDataDir->EnableFileIndex();
+
+    if (pDataDir->InitializeDataDirectory(sDataDirectory) == EZ_SUCCESS)
+      return pDataDir;
+
+    EZ_DEFAULT_DELETE(pDataDir);
+    return nullptr;
+  }
+
+  void FolderType::EnableFileIndex()
+  {
+    // without a directory watcher, files created by other means would never be found
+#if EZ_ENABLED(EZ_SUPPORTS_FILE_ITERATORS) && EZ_ENABLED(EZ_SUPPORTS_FILE_STATS) && EZ_ENABLED(EZ_SUPPORTS_DIRECTORY_WATCHER)
+    if (m_pFileIndex == nullptr)
+    {
+      m_pFileIndex = EZ_DEFAULT_NEW(FileIndex);
+    }
+#endif
+  }
+
+  void FolderType::UpdateFileIndex()
+  {
+    if (m_pFileIndex != nullptr)
+    {
+      m_pFileIndex->ApplyWatcherChanges();
+    }
+  }
+
   void FolderType::RemoveDataDirectory()
   {
     {
@@ -104,7 +669,10 @@ namespace ezDataDirectory
     ezStringBuilder sPath = GetRedirectedDataDirectoryPath();
     sPath.AppendPath(sFile);
 
-    ezOSFile::DeleteFile(sPath.GetData()).IgnoreResult();
+    if (ezOSFile::DeleteFile(sPath.GetData()).Succeeded() && m_pFileIndex != nullptr)
+    {
+      m_pFileIndex->RemovePathLocked(sFile);
+    }
   }
 
   FolderType::~FolderType()
@@ -115,6 +683,8 @@ namespace ezDataDirectory
 
     for (ezUInt32 i = 0; i < m_Writers.GetCount(); ++i)
       EZ_DEFAULT_DELETE(m_Writers[i]);
+
+    EZ_DEFAULT_DELETE(m_pFileIndex);
   }
 
   void FolderType::ReloadExternalConfigs()
@@ -185,6 +755,9 @@ namespace ezDataDirectory
     ezStringBuilder sRedirectedAsset;
     ResolveAssetRedirection(sFile, sRedirectedAsset);
 
+    if (m_pFileIndex != nullptr && !m_pFileIndex->MightExist(sRedirectedAsset, false))
+      return false;
+
     ezStringBuilder sPath = GetRedirectedDataDirectoryPath();
     sPath.AppendPath(sRedirectedAsset);
     return ezOSFile::ExistsFile(sPath);
@@ -195,6 +768,9 @@ namespace ezDataDirectory
     ezStringBuilder sRedirectedAsset;
     ResolveAssetRedirection(sFileOrFolder, sRedirectedAsset);
 
+    if (m_pFileIndex != nullptr && !m_pFileIndex->MightExist(sRedirectedAsset, true))
+      return EZ_FAILURE;
+
     ezStringBuilder sPath = GetRedirectedDataDirectoryPath();
 
     if (ezPathUtils::IsAbsolutePath(sRedirectedAsset))
@@ -221,7 +797,10 @@ namespace ezDataDirectory
   {
     // allow to set the 'empty' directory to handle all absolute paths
     if (sDirectory.IsEmpty())
+    {
+      EZ_DEFAULT_DELETE(m_pFileIndex);
       return EZ_SUCCESS;
+    }
 
     ezStringBuilder sRedirected;
     if (ezFileSystem::ResolveSpecialDirectory(sDirectory, sRedirected).Succeeded())
@@ -236,6 +815,12 @@ namespace ezDataDirectory
     if (!ezOSFile::ExistsDirectory(m_sRedirectedDataDirPath))
       return EZ_FAILURE;
 
+    if (m_pFileIndex != nullptr && m_pFileIndex->Initialize(m_sRedirectedDataDirPath).Failed())
+    {
+      ezLog::Warning("Could not index the data directory '{}', files will be looked up without an index.", m_sRedirectedDataDirPath.GetView());
+      EZ_DEFAULT_DELETE(m_pFileIndex);
+    }
+
     ReloadExternalConfigs();
 
     return EZ_SUCCESS;
@@ -275,6 +860,9 @@ namespace ezDataDirectory
     if (ezConversionUtils::IsStringUuid(sFileToOpen))
       return nullptr;
 
+    if (m_pFileIndex != nullptr && !m_pFileIndex->MightExist(sFileToOpen, false))
+      return nullptr;
+
     FolderReader* pReader = nullptr;
     {
       EZ_LOCK(m_ReaderWriterMutex);
@@ -360,6 +948,11 @@ namespace ezDataDirectory
       return nullptr;
     }
 
+    if (m_pFileIndex != nullptr)
+    {
+      m_pFileIndex->AddPathLocked(sFile, false);
+    }
+
     // if it succeeds, we return the reader
     return pWriter;
   }
@@ -7,6 +7,8 @@
 #include <Foundation/Strings/Implementation/StringIterator.h>
 #include <Foundation/Strings/StringView.h>
 
+#include <atomic>
+
 // clang-format off
 EZ_BEGIN_SUBSYSTEM_DECLARATION(Foundation, FileSystem)
 
@@ -23,11 +25,168 @@ EZ_BEGIN_SUBSYSTEM_DECLARATION(Foundation, FileSystem)
 EZ_END_SUBSYSTEM_DECLARATION;
 // clang-format on
 
+struct ezFileSystem::DataDirSnapshot
+{
+  DataDirSnapshot() = default;
+
+  /// \brief Copies the data directories, but not the link to other retired snapshots.
+  DataDirSnapshot(const DataDirSnapshot& other)
+    : m_DataDirectories(other.m_DataDirectories)
+  {
+  }
+
+  /// \brief Deletes the data directories that were removed when this snapshot was replaced, no reader can reach them anymore.
+  ~DataDirSnapshot()
+  {
+    for (ezDataDirectoryType* pDataDir : m_RemovedDataDirectories)
+    {
+      pDataDir->RemoveDataDirectory();
+    }
+  }
+
+  ezHybridArray<DataDirectory, 16> m_DataDirectories;
+
+  /// Data directories that are part of this snapshot, but not of the one that replaced it.
+  ezHybridArray<ezDataDirectoryType*, 1> m_RemovedDataDirectories;
+
+  DataDirSnapshot* m_pNextRetired = nullptr;
+  ezUInt32 m_uiRetiredInEpoch = 0;
+};
+
+struct ezFileSystem::FileSystemData
+{
+  ezHybridArray<Factory, 4> m_DataDirFactories;
+
+  std::atomic<DataDirSnapshot*> m_pDataDirs{nullptr};
+  DataDirSnapshot* m_pRetiredDataDirs = nullptr; ///< Replaced snapshots that readers might still access. Protected by m_FsMutex.
+  std::atomic<ezUInt32> m_uiEpoch{0};           ///< Advanced by writers once all readers of the previous epoch are done, see DataDirReadScope.
+
+  ezEvent<const FileEvent&, ezMutex> m_Event;
+  ezAtomicInteger32 m_iNumEventHandlers; ///< Allows to skip the event (and its mutex) when nobody listens.
+
+  ezMutex m_FsMutex; ///< Only taken by functions that modify the data directories.
+};
+
+namespace
+{
+  constexpr ezUInt32 s_uiNumFileSystemReaderSlots = 16;
+
+  /// Counts the threads that currently read a data directory snapshot, separately for even and odd epochs. Threads are spread over
+  /// several counters, each on its own cache line, so that readers don't contend with each other.
+  struct alignas(64) FileSystemReaderSlot
+  {
+    std::atomic<ezInt32> m_iNumReaders[2] = {0, 0};
+  };
+
+  FileSystemReaderSlot s_FileSystemReaderSlots[s_uiNumFileSystemReaderSlots];
+
+  FileSystemReaderSlot& GetFileSystemReaderSlot()
+  {
+    static std::atomic<ezUInt32> s_uiNextSlot{0};
+    thread_local const ezUInt32 uiSlot = s_uiNextSlot.fetch_add(1, std::memory_order_relaxed) % s_uiNumFileSystemReaderSlots;
+    return s_FileSystemReaderSlots[uiSlot];
+  }
+
+  ezInt32 CountFileSystemReaders(ezUInt32 uiEpoch)
+  {
+    ezInt32 iNumReaders = 0;
+    for (const FileSystemReaderSlot& slot : s_FileSystemReaderSlots)
+    {
+      iNumReaders += slot.m_iNumReaders[uiEpoch & 1].load();
+    }
+    return iNumReaders;
+  }
+} // namespace
+
+/// Readers register themselves for the current epoch. A snapshot that is replaced in epoch N can only be read by readers of epoch N or
+/// earlier. Writers only advance the epoch once all readers of the previous epoch are done, so once the epoch is N + 2, the snapshot
+/// can be deleted. Long-running readers therefore only delay the deletion of the snapshots that they might actually access.
+class ezFileSystem::DataDirReadScope
+{
+public:
+  DataDirReadScope()
+  {
+    FileSystemReaderSlot& slot = GetFileSystemReaderSlot();
+
+    // all operations are sequentially consistent, so a writer that advances the epoch either sees this reader,
+    // or this reader notices the new epoch and registers for that one instead
+    while (true)
+    {
+      const ezUInt32 uiEpoch = s_pData->m_uiEpoch.load();
+      m_pNumReaders = &slot.m_iNumReaders[uiEpoch & 1];
+      m_pNumReaders->fetch_add(1);
+
+      if (s_pData->m_uiEpoch.load() == uiEpoch)
+        break;
+
+      m_pNumReaders->fetch_sub(1);
+    }
+
+    m_pDataDirs = s_pData->m_pDataDirs.load();
+  }
+
+  ~DataDirReadScope() { m_pNumReaders->fetch_sub(1, std::memory_order_release); }
+
+  const DataDirSnapshot& GetSnapshot() const { return *m_pDataDirs; }
+  const ezHybridArray<DataDirectory, 16>& GetDataDirectories() const { return m_pDataDirs->m_DataDirectories; }
+
+private:
+  std::atomic<ezInt32>* m_pNumReaders = nullptr;
+  const DataDirSnapshot* m_pDataDirs = nullptr;
+};
+
 ezFileSystem::FileSystemData* ezFileSystem::s_pData = nullptr;
 ezString ezFileSystem::s_sSdkRootDir;
 ezMap<ezString, ezString> ezFileSystem::s_SpecialDirectories;
 
 
+void ezFileSystem::PublishDataDirectories(DataDirSnapshot* pDataDirs)
+{
+  DataDirSnapshot* pOldDataDirs = s_pData->m_pDataDirs.exchange(pDataDirs);
+
+  ezUInt32 uiEpoch = s_pData->m_uiEpoch.load();
+
+  if (pOldDataDirs != nullptr)
+  {
+    pOldDataDirs->m_uiRetiredInEpoch = uiEpoch;
+    pOldDataDirs->m_pNextRetired = s_pData->m_pRetiredDataDirs;
+    s_pData->m_pRetiredDataDirs = pOldDataDirs;
+  }
+
+  // the readers of the current epoch use the other counters than those of the previous and the next epoch,
+  // so the epoch can be advanced twice, if neither of them has readers anymore
+  for (ezUInt32 i = 0; i < 2 && CountFileSystemReaders(uiEpoch + 1) == 0; ++i)
+  {
+    ++uiEpoch;
+    s_pData->m_uiEpoch.store(uiEpoch);
+  }
+
+  // all snapshots that were retired at least two epochs ago can't be accessed anymore, the others are checked again on the next change
+  DataDirSnapshot** pLink = &s_pData->m_pRetiredDataDirs;
+  while (*pLink != nullptr)
+  {
+    DataDirSnapshot* pRetired = *pLink;
+
+    if (uiEpoch - pRetired->m_uiRetiredInEpoch >= 2)
+    {
+      *pLink = pRetired->m_pNextRetired;
+      EZ_DEFAULT_DELETE(pRetired);
+    }
+    else
+    {
+      pLink = &pRetired->m_pNextRetired;
+    }
+  }
+}
+
+void ezFileSystem::BroadcastFileEvent(const FileEvent& fileEvent)
+{
+  if (s_pData->m_iNumEventHandlers > 0)
+  {
+    s_pData->m_Event.Broadcast(fileEvent);
+  }
+}
+
 void ezFileSystem::RegisterDataDirectoryFactory(ezDataDirFactory factory, float fPriority /*= 0*/)
 {
   EZ_LOCK(s_pData->m_FsMutex);
@@ -37,10 +196,18 @@ void ezFileSystem::RegisterDataDirectoryFactory(ezDataDirFactory factory, float
   data.m_fPriority = fPriority;
 }
 
+void ezFileSystem::ClearAllDataDirectoryFactories()
+{
+  EZ_LOCK(s_pData->m_FsMutex);
+
+  s_pData->m_DataDirFactories.Clear();
+}
+
 ezEventSubscriptionID ezFileSystem::RegisterEventHandler(ezEvent<const FileEvent&>::Handler handler)
 {
   EZ_ASSERT_DEV(s_pData != nullptr, "FileSystem is not initialized.");
 
+  s_pData->m_iNumEventHandlers.Increment();
   return s_pData->m_Event.AddEventHandler(handler);
 }
 
@@ -49,13 +216,18 @@ void ezFileSystem::UnregisterEventHandler(ezEvent<const FileEvent&>::Handler han
   EZ_ASSERT_DEV(s_pData != nullptr, "FileSystem is not initialized.");
 
   s_pData->m_Event.RemoveEventHandler(handler);
+  s_pData->m_iNumEventHandlers.Decrement();
 }
 
 void ezFileSystem::UnregisterEventHandler(ezEventSubscriptionID subscriptionId)
 {
   EZ_ASSERT_DEV(s_pData != nullptr, "FileSystem is not initialized.");
 
+  if (subscriptionId == 0)
+    return;
+
   s_pData->m_Event.RemoveEventHandler(subscriptionId);
+  s_pData->m_iNumEventHandlers.Decrement();
 }
 
 void ezFileSystem::CleanUpRootName(ezStringBuilder& sRoot)
@@ -114,7 +286,9 @@ ezResult ezFileSystem::AddDataDirectory(ezStringView sDataDirectory, ezStringVie
         dd.m_sRootName = sCleanRootName;
         dd.m_sGroup = sGroup;
 
-        s_pData->m_DataDirectories.PushBack(dd);
+        DataDirSnapshot* pDataDirs = EZ_DEFAULT_NEW(DataDirSnapshot, *s_pData->m_pDataDirs.load());
+        pDataDirs->m_DataDirectories.PushBack(dd);
+        PublishDataDirectories(pDataDirs);
 
         {
           // Broadcast that a data directory was added
@@ -123,7 +297,7 @@ ezResult ezFileSystem::AddDataDirectory(ezStringView sDataDirectory, ezStringVie
           fe.m_sFileOrDirectory = sPath;
           fe.m_sOther = sCleanRootName;
           fe.m_pDataDir = pDataDir;
-          s_pData->m_Event.Broadcast(fe);
+          BroadcastFileEvent(fe);
         }
 
         return EZ_SUCCESS;
@@ -137,13 +311,38 @@ ezResult ezFileSystem::AddDataDirectory(ezStringView sDataDirectory, ezStringVie
     fe.m_EventType = FileEventType::AddDataDirectoryFailed;
     fe.m_sFileOrDirectory = sPath;
     fe.m_sOther = sCleanRootName;
-    s_pData->m_Event.Broadcast(fe);
+    BroadcastFileEvent(fe);
   }
 
   ezLog::Error("Adding Data Directory '{0}' failed.", ezArgSensitive(sDataDirectory, "Path"));
   return EZ_FAILURE;
 }
 
+void ezFileSystem::RemoveDataDirectoryAt(ezUInt32 uiDataDirIndex)
+{
+  // only writers replace the current snapshot and they all hold the mutex, so it can be accessed without a read scope here
+  const DataDirectory& directory = s_pData->m_pDataDirs.load()->m_DataDirectories[uiDataDirIndex];
+  ezDataDirectoryType* pDataDir = directory.m_pDataDirectory;
+
+  {
+    // Broadcast that a data directory is about to be removed
+    FileEvent fe;
+    fe.m_EventType = FileEventType::RemoveDataDirectory;
+    fe.m_sFileOrDirectory = pDataDir->GetDataDirectoryPath();
+    fe.m_sOther = directory.m_sRootName;
+    fe.m_pDataDir = pDataDir;
+    BroadcastFileEvent(fe);
+  }
+
+  DataDirSnapshot* pOldDataDirs = s_pData->m_pDataDirs.load();
+  DataDirSnapshot* pDataDirs = EZ_DEFAULT_NEW(DataDirSnapshot, *pOldDataDirs);
+  pDataDirs->m_DataDirectories.RemoveAtAndCopy(uiDataDirIndex);
+
+  // readers of the old snapshot may still use the data directory, it is deleted together with that snapshot
+  pOldDataDirs->m_RemovedDataDirectories.PushBack(pDataDir);
+
+  PublishDataDirectories(pDataDirs);
+}
 
 bool ezFileSystem::RemoveDataDirectory(ezStringView sRootName)
 {
@@ -152,29 +351,15 @@ bool ezFileSystem::RemoveDataDirectory(ezStringView sRootName)
 
   EZ_LOCK(s_pData->m_FsMutex);
 
-  for (ezUInt32 i = 0; i < s_pData->m_DataDirectories.GetCount();)
-  {
-    const auto& directory = s_pData->m_DataDirectories[i];
+  const auto& dataDirs = s_pData->m_pDataDirs.load()->m_DataDirectories;
 
-    if (directory.m_sRootName == sCleanRootName)
+  for (ezUInt32 i = 0; i < dataDirs.GetCount(); ++i)
+  {
+    if (dataDirs[i].m_sRootName == sCleanRootName)
     {
-      {
-        // Broadcast that a data directory is about to be removed
-        FileEvent fe;
-        fe.m_EventType = FileEventType::RemoveDataDirectory;
-        fe.m_sFileOrDirectory = directory.m_pDataDirectory->GetDataDirectoryPath();
-        fe.m_sOther = directory.m_sRootName;
-        fe.m_pDataDir = directory.m_pDataDirectory;
-        s_pData->m_Event.Broadcast(fe);
-      }
-
-      directory.m_pDataDirectory->RemoveDataDirectory();
-      s_pData->m_DataDirectories.RemoveAtAndCopy(i);
-
+      RemoveDataDirectoryAt(i);
       return true;
     }
-    else
-      ++i;
   }
 
   return false;
@@ -189,24 +374,14 @@ ezUInt32 ezFileSystem::RemoveDataDirectoryGroup(ezStringView sGroup)
 
   ezUInt32 uiRemoved = 0;
 
-  for (ezUInt32 i = 0; i < s_pData->m_DataDirectories.GetCount();)
+  // every removal publishes new data directories, so look them up again each time
+  for (ezUInt32 i = 0; i < s_pData->m_pDataDirs.load()->m_DataDirectories.GetCount();)
   {
-    if (s_pData->m_DataDirectories[i].m_sGroup == sGroup)
+    if (s_pData->m_pDataDirs.load()->m_DataDirectories[i].m_sGroup == sGroup)
     {
-      {
-        // Broadcast that a data directory is about to be removed
-        FileEvent fe;
-        fe.m_EventType = FileEventType::RemoveDataDirectory;
-        fe.m_sFileOrDirectory = s_pData->m_DataDirectories[i].m_pDataDirectory->GetDataDirectoryPath();
-        fe.m_sOther = s_pData->m_DataDirectories[i].m_sRootName;
-        fe.m_pDataDir = s_pData->m_DataDirectories[i].m_pDataDirectory;
-        s_pData->m_Event.Broadcast(fe);
-      }
-
       ++uiRemoved;
 
-      s_pData->m_DataDirectories[i].m_pDataDirectory->RemoveDataDirectory();
-      s_pData->m_DataDirectories.RemoveAtAndCopy(i);
+      RemoveDataDirectoryAt(i);
     }
     else
       ++i;
@@ -221,22 +396,10 @@ void ezFileSystem::ClearAllDataDirectories()
 
   EZ_LOCK(s_pData->m_FsMutex);
 
-  for (ezInt32 i = s_pData->m_DataDirectories.GetCount() - 1; i >= 0; --i)
+  while (!s_pData->m_pDataDirs.load()->m_DataDirectories.IsEmpty())
   {
-    {
-      // Broadcast that a data directory is about to be removed
-      FileEvent fe;
-      fe.m_EventType = FileEventType::RemoveDataDirectory;
-      fe.m_sFileOrDirectory = s_pData->m_DataDirectories[i].m_pDataDirectory->GetDataDirectoryPath();
-      fe.m_sOther = s_pData->m_DataDirectories[i].m_sRootName;
-      fe.m_pDataDir = s_pData->m_DataDirectories[i].m_pDataDirectory;
-      s_pData->m_Event.Broadcast(fe);
-    }
-
-    s_pData->m_DataDirectories[i].m_pDataDirectory->RemoveDataDirectory();
+    RemoveDataDirectoryAt(s_pData->m_pDataDirs.load()->m_DataDirectories.GetCount() - 1);
   }
-
-  s_pData->m_DataDirectories.Clear();
 }
 
 ezDataDirectoryType* ezFileSystem::FindDataDirectoryWithRoot(ezStringView sRootName)
@@ -244,9 +407,9 @@ ezDataDirectoryType* ezFileSystem::FindDataDirectoryWithRoot(ezStringView sRootN
   if (sRootName.IsEmpty())
     return nullptr;
 
-  EZ_LOCK(s_pData->m_FsMutex);
+  DataDirReadScope readScope;
 
-  for (const auto& dd : s_pData->m_DataDirectories)
+  for (const auto& dd : readScope.GetDataDirectories())
   {
     if (dd.m_sRootName.IsEqual_NoCase(sRootName))
     {
@@ -261,26 +424,26 @@ ezUInt32 ezFileSystem::GetNumDataDirectories()
 {
   EZ_ASSERT_DEV(s_pData != nullptr, "FileSystem is not initialized.");
 
-  return s_pData->m_DataDirectories.GetCount();
+  DataDirReadScope readScope;
+  return readScope.GetDataDirectories().GetCount();
 }
 
 ezDataDirectoryType* ezFileSystem::GetDataDirectory(ezUInt32 uiDataDirIndex)
 {
   EZ_ASSERT_DEV(s_pData != nullptr, "FileSystem is not initialized.");
 
-  return s_pData->m_DataDirectories[uiDataDirIndex].m_pDataDirectory;
+  DataDirReadScope readScope;
+  return readScope.GetDataDirectories()[uiDataDirIndex].m_pDataDirectory;
 }
 
-ezStringView ezFileSystem::GetDataDirRelativePath(ezStringView sPath, ezUInt32 uiDataDir)
+ezStringView ezFileSystem::GetDataDirRelativePath(ezStringView sPath, const ezDataDirectoryType* pDataDir)
 {
-  EZ_LOCK(s_pData->m_FsMutex);
-
   // if an absolute path is given, this will check whether the absolute path would fall into this data directory
   // if yes, the prefix path is removed and then only the relative path is given to the data directory type
   // otherwise the data directory would prepend its own path and thus create an invalid path to work with
 
   // first check the redirected directory
-  const ezString128& sRedDirPath = s_pData->m_DataDirectories[uiDataDir].m_pDataDirectory->GetRedirectedDataDirectoryPath();
+  const ezString128& sRedDirPath = pDataDir->GetRedirectedDataDirectoryPath();
 
   if (!sRedDirPath.IsEmpty() && sPath.StartsWith_NoCase(sRedDirPath))
   {
@@ -296,7 +459,7 @@ ezStringView ezFileSystem::GetDataDirRelativePath(ezStringView sPath, ezUInt32 u
   }
 
   // then check the original mount path
-  const ezString128& sDirPath = s_pData->m_DataDirectories[uiDataDir].m_pDataDirectory->GetDataDirectoryPath();
+  const ezString128& sDirPath = pDataDir->GetDataDirectoryPath();
 
   // If the data dir is empty we return the paths as is or the code below would remove the '/' in front of an
   // absolute path.
@@ -317,14 +480,12 @@ ezStringView ezFileSystem::GetDataDirRelativePath(ezStringView sPath, ezUInt32 u
 }
 
 
-ezFileSystem::DataDirectory* ezFileSystem::GetDataDirForRoot(const ezString& sRoot)
+const ezFileSystem::DataDirectory* ezFileSystem::GetDataDirForRoot(const DataDirSnapshot& dataDirs, const ezString& sRoot)
 {
-  EZ_LOCK(s_pData->m_FsMutex);
-
-  for (ezInt32 i = (ezInt32)s_pData->m_DataDirectories.GetCount() - 1; i >= 0; --i)
+  for (ezInt32 i = (ezInt32)dataDirs.m_DataDirectories.GetCount() - 1; i >= 0; --i)
   {
-    if (s_pData->m_DataDirectories[i].m_sRootName == sRoot)
-      return &s_pData->m_DataDirectories[i];
+    if (dataDirs.m_DataDirectories[i].m_sRootName == sRoot)
+      return &dataDirs.m_DataDirectories[i];
   }
 
   return nullptr;
@@ -349,18 +510,19 @@ void ezFileSystem::DeleteFile(ezStringView sFile)
   if (sRootName.IsEmpty())
     return;
 
-  EZ_LOCK(s_pData->m_FsMutex);
+  DataDirReadScope readScope;
+  const auto& dataDirs = readScope.GetDataDirectories();
 
-  for (ezInt32 i = (ezInt32)s_pData->m_DataDirectories.GetCount() - 1; i >= 0; --i)
+  for (ezInt32 i = (ezInt32)dataDirs.GetCount() - 1; i >= 0; --i)
   {
     // do not delete data from directories that are mounted as read only
-    if (s_pData->m_DataDirectories[i].m_Usage != AllowWrites)
+    if (dataDirs[i].m_Usage != AllowWrites)
       continue;
 
-    if (s_pData->m_DataDirectories[i].m_sRootName != sRootName)
+    if (dataDirs[i].m_sRootName != sRootName)
       continue;
 
-    ezStringView sRelPath = GetDataDirRelativePath(sFile, i);
+    ezStringView sRelPath = GetDataDirRelativePath(sFile, dataDirs[i].m_pDataDirectory);
 
     {
       // Broadcast that a file is about to be deleted
@@ -368,12 +530,12 @@ void ezFileSystem::DeleteFile(ezStringView sFile)
       FileEvent fe;
       fe.m_EventType = FileEventType::DeleteFile;
       fe.m_sFileOrDirectory = sRelPath;
-      fe.m_pDataDir = s_pData->m_DataDirectories[i].m_pDataDirectory;
+      fe.m_pDataDir = dataDirs[i].m_pDataDirectory;
       fe.m_sOther = sRootName;
-      s_pData->m_Event.Broadcast(fe);
+      BroadcastFileEvent(fe);
     }
 
-    s_pData->m_DataDirectories[i].m_pDataDirectory->DeleteFile(sRelPath);
+    dataDirs[i].m_pDataDirectory->DeleteFile(sRelPath);
   }
 }
 
@@ -386,16 +548,17 @@ bool ezFileSystem::ExistsFile(ezStringView sFile)
 
   const bool bOneSpecificDataDir = !sRootName.IsEmpty();
 
-  EZ_LOCK(s_pData->m_FsMutex);
+  DataDirReadScope readScope;
+  const auto& dataDirs = readScope.GetDataDirectories();
 
-  for (ezInt32 i = (ezInt32)s_pData->m_DataDirectories.GetCount() - 1; i >= 0; --i)
+  for (ezInt32 i = (ezInt32)dataDirs.GetCount() - 1; i >= 0; --i)
   {
-    if (!sRootName.IsEmpty() && s_pData->m_DataDirectories[i].m_sRootName != sRootName)
+    if (!sRootName.IsEmpty() && dataDirs[i].m_sRootName != sRootName)
       continue;
 
-    ezStringView sRelPath = GetDataDirRelativePath(sFile, i);
+    ezStringView sRelPath = GetDataDirRelativePath(sFile, dataDirs[i].m_pDataDirectory);
 
-    if (s_pData->m_DataDirectories[i].m_pDataDirectory->ExistsFile(sRelPath, bOneSpecificDataDir))
+    if (dataDirs[i].m_pDataDirectory->ExistsFile(sRelPath, bOneSpecificDataDir))
       return true;
   }
 
@@ -407,21 +570,22 @@ ezResult ezFileSystem::GetFileStats(ezStringView sFileOrFolder, ezFileStats& out
 {
   EZ_ASSERT_DEV(s_pData != nullptr, "FileSystem is not initialized.");
 
-  EZ_LOCK(s_pData->m_FsMutex);
+  DataDirReadScope readScope;
+  const auto& dataDirs = readScope.GetDataDirectories();
 
   ezString sRootName;
   sFileOrFolder = ExtractRootName(sFileOrFolder, sRootName);
 
   const bool bOneSpecificDataDir = !sRootName.IsEmpty();
 
-  for (ezInt32 i = (ezInt32)s_pData->m_DataDirectories.GetCount() - 1; i >= 0; --i)
+  for (ezInt32 i = (ezInt32)dataDirs.GetCount() - 1; i >= 0; --i)
   {
-    if (!sRootName.IsEmpty() && s_pData->m_DataDirectories[i].m_sRootName != sRootName)
+    if (!sRootName.IsEmpty() && dataDirs[i].m_sRootName != sRootName)
       continue;
 
-    ezStringView sRelPath = GetDataDirRelativePath(sFileOrFolder, i);
+    ezStringView sRelPath = GetDataDirRelativePath(sFileOrFolder, dataDirs[i].m_pDataDirectory);
 
-    if (s_pData->m_DataDirectories[i].m_pDataDirectory->GetFileStats(sRelPath, bOneSpecificDataDir, out_stats).Succeeded())
+    if (dataDirs[i].m_pDataDirectory->GetFileStats(sRelPath, bOneSpecificDataDir, out_stats).Succeeded())
       return EZ_SUCCESS;
   }
 
@@ -462,7 +626,8 @@ ezDataDirectoryReader* ezFileSystem::GetFileReader(ezStringView sFile, ezFileSha
   if (sFile.IsEmpty())
     return nullptr;
 
-  EZ_LOCK(s_pData->m_FsMutex);
+  DataDirReadScope readScope;
+  const auto& dataDirs = readScope.GetDataDirectories();
 
   ezString sRootName;
   sFile = ExtractRootName(sFile, sRootName);
@@ -474,13 +639,13 @@ ezDataDirectoryReader* ezFileSystem::GetFileReader(ezStringView sFile, ezFileSha
   const bool bOneSpecificDataDir = !sRootName.IsEmpty();
 
   // the last added data directory has the highest priority
-  for (ezInt32 i = (ezInt32)s_pData->m_DataDirectories.GetCount() - 1; i >= 0; --i)
+  for (ezInt32 i = (ezInt32)dataDirs.GetCount() - 1; i >= 0; --i)
   {
     // if a root is used, ignore all directories that do not have the same root name
-    if (bOneSpecificDataDir && s_pData->m_DataDirectories[i].m_sRootName != sRootName)
+    if (bOneSpecificDataDir && dataDirs[i].m_sRootName != sRootName)
       continue;
 
-    ezStringView sRelPath = GetDataDirRelativePath(sPath, i);
+    ezStringView sRelPath = GetDataDirRelativePath(sPath, dataDirs[i].m_pDataDirectory);
 
     if (bAllowFileEvents)
     {
@@ -490,12 +655,12 @@ ezDataDirectoryReader* ezFileSystem::GetFileReader(ezStringView sFile, ezFileSha
       fe.m_EventType = FileEventType::OpenFileAttempt;
       fe.m_sFileOrDirectory = sRelPath;
       fe.m_sOther = sRootName;
-      fe.m_pDataDir = s_pData->m_DataDirectories[i].m_pDataDirectory;
-      s_pData->m_Event.Broadcast(fe);
+      fe.m_pDataDir = dataDirs[i].m_pDataDirectory;
+      BroadcastFileEvent(fe);
     }
 
     // Let the data directory try to open the file.
-    ezDataDirectoryReader* pReader = s_pData->m_DataDirectories[i].m_pDataDirectory->OpenFileToRead(sRelPath, FileShareMode, bOneSpecificDataDir);
+    ezDataDirectoryReader* pReader = dataDirs[i].m_pDataDirectory->OpenFileToRead(sRelPath, FileShareMode, bOneSpecificDataDir);
 
     if (bAllowFileEvents && pReader != nullptr)
     {
@@ -504,8 +669,8 @@ ezDataDirectoryReader* ezFileSystem::GetFileReader(ezStringView sFile, ezFileSha
       fe.m_EventType = FileEventType::OpenFileSucceeded;
       fe.m_sFileOrDirectory = sRelPath;
       fe.m_sOther = sRootName;
-      fe.m_pDataDir = s_pData->m_DataDirectories[i].m_pDataDirectory;
-      s_pData->m_Event.Broadcast(fe);
+      fe.m_pDataDir = dataDirs[i].m_pDataDirectory;
+      BroadcastFileEvent(fe);
 
       return pReader;
     }
@@ -517,7 +682,7 @@ ezDataDirectoryReader* ezFileSystem::GetFileReader(ezStringView sFile, ezFileSha
     FileEvent fe;
     fe.m_EventType = FileEventType::OpenFileFailed;
     fe.m_sFileOrDirectory = sPath;
-    s_pData->m_Event.Broadcast(fe);
+    BroadcastFileEvent(fe);
   }
 
   return nullptr;
@@ -530,7 +695,8 @@ ezDataDirectoryWriter* ezFileSystem::GetFileWriter(ezStringView sFile, ezFileSha
   if (sFile.IsEmpty())
     return nullptr;
 
-  EZ_LOCK(s_pData->m_FsMutex);
+  DataDirReadScope readScope;
+  const auto& dataDirs = readScope.GetDataDirectories();
 
   ezString sRootName;
 
@@ -548,16 +714,16 @@ ezDataDirectoryWriter* ezFileSystem::GetFileWriter(ezStringView sFile, ezFileSha
   sPath.MakeCleanPath();
 
   // the last added data directory has the highest priority
-  for (ezInt32 i = (ezInt32)s_pData->m_DataDirectories.GetCount() - 1; i >= 0; --i)
+  for (ezInt32 i = (ezInt32)dataDirs.GetCount() - 1; i >= 0; --i)
   {
-    if (s_pData->m_DataDirectories[i].m_Usage != AllowWrites)
+    if (dataDirs[i].m_Usage != AllowWrites)
       continue;
 
     // ignore all directories that have not the category that is currently requested
-    if (s_pData->m_DataDirectories[i].m_sRootName != sRootName)
+    if (dataDirs[i].m_sRootName != sRootName)
       continue;
 
-    ezStringView sRelPath = GetDataDirRelativePath(sPath, i);
+    ezStringView sRelPath = GetDataDirRelativePath(sPath, dataDirs[i].m_pDataDirectory);
 
     if (bAllowFileEvents)
     {
@@ -567,11 +733,11 @@ ezDataDirectoryWriter* ezFileSystem::GetFileWriter(ezStringView sFile, ezFileSha
       fe.m_EventType = FileEventType::CreateFileAttempt;
       fe.m_sFileOrDirectory = sRelPath;
       fe.m_sOther = sRootName;
-      fe.m_pDataDir = s_pData->m_DataDirectories[i].m_pDataDirectory;
-      s_pData->m_Event.Broadcast(fe);
+      fe.m_pDataDir = dataDirs[i].m_pDataDirectory;
+      BroadcastFileEvent(fe);
     }
 
-    ezDataDirectoryWriter* pWriter = s_pData->m_DataDirectories[i].m_pDataDirectory->OpenFileToWrite(sRelPath, FileShareMode);
+    ezDataDirectoryWriter* pWriter = dataDirs[i].m_pDataDirectory->OpenFileToWrite(sRelPath, FileShareMode);
 
     if (bAllowFileEvents && pWriter != nullptr)
     {
@@ -580,8 +746,8 @@ ezDataDirectoryWriter* ezFileSystem::GetFileWriter(ezStringView sFile, ezFileSha
       fe.m_EventType = FileEventType::CreateFileSucceeded;
       fe.m_sFileOrDirectory = sRelPath;
       fe.m_sOther = sRootName;
-      fe.m_pDataDir = s_pData->m_DataDirectories[i].m_pDataDirectory;
-      s_pData->m_Event.Broadcast(fe);
+      fe.m_pDataDir = dataDirs[i].m_pDataDirectory;
+      BroadcastFileEvent(fe);
 
       return pWriter;
     }
@@ -593,7 +759,7 @@ ezDataDirectoryWriter* ezFileSystem::GetFileWriter(ezStringView sFile, ezFileSha
     FileEvent fe;
     fe.m_EventType = FileEventType::CreateFileFailed;
     fe.m_sFileOrDirectory = sPath;
-    s_pData->m_Event.Broadcast(fe);
+    BroadcastFileEvent(fe);
   }
 
   return nullptr;
@@ -603,7 +769,7 @@ ezResult ezFileSystem::ResolvePath(ezStringView sPath, ezStringBuilder* out_pAbs
 {
   EZ_ASSERT_DEV(s_pData != nullptr, "FileSystem is not initialized.");
 
-  EZ_LOCK(s_pData->m_FsMutex);
+  DataDirReadScope readScope;
 
   ezStringBuilder absPath, relPath;
 
@@ -613,7 +779,7 @@ ezResult ezFileSystem::ResolvePath(ezStringView sPath, ezStringBuilder* out_pAbs
     ezString sRootName;
     ExtractRootName(sPath, sRootName);
 
-    DataDirectory* pDataDir = GetDataDirForRoot(sRootName);
+    const DataDirectory* pDataDir = GetDataDirForRoot(readScope.GetSnapshot(), sRootName);
 
     if (pDataDir == nullptr)
       return EZ_FAILURE;
@@ -631,9 +797,11 @@ ezResult ezFileSystem::ResolvePath(ezStringView sPath, ezStringBuilder* out_pAbs
     absPath = sPath;
     absPath.MakeCleanPath();
 
-    for (ezUInt32 dd = s_pData->m_DataDirectories.GetCount(); dd > 0; --dd)
+    const auto& dataDirs = readScope.GetDataDirectories();
+
+    for (ezUInt32 dd = dataDirs.GetCount(); dd > 0; --dd)
     {
-      auto& dir = s_pData->m_DataDirectories[dd - 1];
+      auto& dir = dataDirs[dd - 1];
 
       if (ezPathUtils::IsSubPath(dir.m_pDataDirectory->GetRedirectedDataDirectoryPath(), absPath))
       {
@@ -762,9 +930,9 @@ ezResult ezFileSystem::FindFolderWithSubPath(ezStringBuilder& out_sResult, ezStr
 
 bool ezFileSystem::ResolveAssetRedirection(ezStringView sPathOrAssetGuid, ezStringBuilder& out_sRedirection)
 {
-  EZ_LOCK(s_pData->m_FsMutex);
+  DataDirReadScope readScope;
 
-  for (auto& dd : s_pData->m_DataDirectories)
+  for (auto& dd : readScope.GetDataDirectories())
   {
     if (dd.m_pDataDirectory->ResolveAssetRedirection(sPathOrAssetGuid, out_sRedirection))
       return true;
@@ -820,9 +988,9 @@ void ezFileSystem::ReloadAllExternalDataDirectoryConfigs()
 {
   EZ_LOG_BLOCK("ReloadAllExternalDataDirectoryConfigs");
 
-  EZ_LOCK(s_pData->m_FsMutex);
+  DataDirReadScope readScope;
 
-  for (auto& dd : s_pData->m_DataDirectories)
+  for (auto& dd : readScope.GetDataDirectories())
   {
     dd.m_pDataDirectory->ReloadExternalConfigs();
   }
@@ -831,6 +999,7 @@ void ezFileSystem::ReloadAllExternalDataDirectoryConfigs()
 void ezFileSystem::Startup()
 {
   s_pData = EZ_DEFAULT_NEW(FileSystemData);
+  s_pData->m_pDataDirs = EZ_DEFAULT_NEW(DataDirSnapshot);
 }
 
 void ezFileSystem::Shutdown()
@@ -841,6 +1010,17 @@ void ezFileSystem::Shutdown()
     s_pData->m_DataDirFactories.Clear();
 
     ClearAllDataDirectories();
+
+    // nothing reads the data directories anymore at this point
+    DataDirSnapshot* pDataDirs = s_pData->m_pDataDirs.exchange(nullptr);
+    EZ_DEFAULT_DELETE(pDataDirs);
+
+    while (s_pData->m_pRetiredDataDirs != nullptr)
+    {
+      DataDirSnapshot* pRetired = s_pData->m_pRetiredDataDirs;
+      s_pData->m_pRetiredDataDirs = pRetired->m_pNextRetired;
+      EZ_DEFAULT_DELETE(pRetired);
+    }
   }
 
   EZ_DEFAULT_DELETE(s_pData);
@@ -979,12 +1159,12 @@ ezMutex& ezFileSystem::GetMutex()
 
 void ezFileSystem::StartSearch(ezFileSystemIterator& ref_iterator, ezStringView sSearchTerm, ezBitflags<ezFileSystemIteratorFlags> flags /*= ezFileSystemIteratorFlags::Default*/)
 {
-  EZ_LOCK(s_pData->m_FsMutex);
+  DataDirReadScope readScope;
 
   ezHybridArray<ezString, 16> folders;
   ezStringBuilder sDdPath;
 
-  for (const auto& dd : s_pData->m_DataDirectories)
+  for (const auto& dd : readScope.GetDataDirectories())
   {
     sDdPath = dd.m_pDataDirectory->GetRedirectedDataDirectoryPath();
 
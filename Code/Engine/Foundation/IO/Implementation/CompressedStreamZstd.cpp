@@ -7,6 +7,34 @@
 #  include <Foundation/System/SystemInformation.h>
 #  include <zstd/zstd.h>
 
+namespace
+{
+  struct ezThreadLocalZstdContext
+  {
+    ~ezThreadLocalZstdContext()
+    {
+      if (m_pContext != nullptr)
+      {
+        ZSTD_freeDCtx(m_pContext);
+      }
+    }
+
+    ZSTD_DCtx* Get()
+    {
+      if (m_pContext == nullptr)
+      {
+        m_pContext = ZSTD_createDCtx();
+      }
+
+      return m_pContext;
+    }
+
+    ZSTD_DCtx* m_pContext = nullptr;
+  };
+
+  thread_local ezThreadLocalZstdContext s_ZstdContext;
+} // namespace
+
 ezCompressedStreamReaderZstd::ezCompressedStreamReaderZstd() = default;
 
 ezCompressedStreamReaderZstd::ezCompressedStreamReaderZstd(ezStreamReader* pInputStream)
@@ -93,6 +121,12 @@ ezUInt64 ezCompressedStreamReaderZstd::ReadBytes(void* pReadBuffer, ezUInt64 uiB
   return outBuffer.pos;
 }
 
+// static
+void* ezCompressedStreamReaderZstd::GetThreadLocalDecompressionContext()
+{
+  return s_ZstdContext.Get();
+}
+
 ezResult ezCompressedStreamReaderZstd::RefillReadCache()
 {
   // if our input buffer is empty, we need to read more into our cache
@@ -304,6 +338,269 @@ ezResult ezCompressedStreamWriterZstd::WriteBytes(const void* pWriteBuffer, ezUI
   return EZ_SUCCESS;
 }
 
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+// The seekable format is:
+//   all blocks (each compressed on its own, or stored uncompressed, if that is smaller)
+//   ezUInt64 offset of each block
+//   ezUInt64 uncompressed size
+//   ezUInt32 block size
+//   ezUInt32 number of blocks
+static constexpr ezUInt32 s_uiSeekableFooterSize = sizeof(ezUInt64) + sizeof(ezUInt32) * 2;
+
+ezCompressedStreamWriterZstdSeekable::ezCompressedStreamWriterZstdSeekable() = default;
+
+ezCompressedStreamWriterZstdSeekable::ezCompressedStreamWriterZstdSeekable(ezStreamWriter* pOutputStream, ezCompressedStreamWriterZstd::Compression ratio /*= ezCompressedStreamWriterZstd::Compression::Default*/, ezUInt32 uiBlockSizeKB /*= 64*/)
+{
+  SetOutputStream(pOutputStream, ratio, uiBlockSizeKB);
+}
+
+ezCompressedStreamWriterZstdSeekable::~ezCompressedStreamWriterZstdSeekable()
+{
+  FinishCompressedStream().IgnoreResult();
+
+  if (m_pZstdCCtx)
+  {
+    ZSTD_freeCCtx(reinterpret_cast<ZSTD_CCtx*>(m_pZstdCCtx));
+    m_pZstdCCtx = nullptr;
+  }
+}
+
+void ezCompressedStreamWriterZstdSeekable::SetOutputStream(ezStreamWriter* pOutputStream, ezCompressedStreamWriterZstd::Compression ratio /*= ezCompressedStreamWriterZstd::Compression::Default*/, ezUInt32 uiBlockSizeKB /*= 64*/)
+{
+  // finish anything done on a previous output stream
+  FinishCompressedStream().IgnoreResult();
+
+  m_uiUncompressedSize = 0;
+  m_uiWrittenBytes = 0;
+  m_uiBlockSize = ezMath::Max(1u, uiBlockSizeKB) * 1024;
+  m_iCompressionLevel = static_cast<ezInt32>(ratio);
+  m_pOutputStream = pOutputStream;
+
+  m_Block.Clear();
+  m_BlockOffsets.Clear();
+
+  if (pOutputStream != nullptr && m_pZstdCCtx == nullptr)
+  {
+    m_pZstdCCtx = ZSTD_createCCtx();
+  }
+}
+
+ezResult ezCompressedStreamWriterZstdSeekable::WriteBytes(const void* pWriteBuffer, ezUInt64 uiBytesToWrite)
+{
+  EZ_ASSERT_DEV(m_pOutputStream != nullptr, "The stream is already closed, you cannot write more data to it.");
+
+  m_uiUncompressedSize += uiBytesToWrite;
+
+  const ezUInt8* pSource = static_cast<const ezUInt8*>(pWriteBuffer);
+
+  while (uiBytesToWrite > 0)
+  {
+    const ezUInt32 uiToCopy = static_cast<ezUInt32>(ezMath::Min<ezUInt64>(uiBytesToWrite, m_uiBlockSize - m_Block.GetCount()));
+
+    m_Block.PushBackRange(ezArrayPtr<const ezUInt8>(pSource, uiToCopy));
+    pSource += uiToCopy;
+    uiBytesToWrite -= uiToCopy;
+
+    if (m_Block.GetCount() == m_uiBlockSize)
+    {
+      EZ_SUCCEED_OR_RETURN(WriteBlock());
+    }
+  }
+
+  return EZ_SUCCESS;
+}
+
+ezResult ezCompressedStreamWriterZstdSeekable::WriteBlock()
+{
+  m_BlockOffsets.PushBack(m_uiWrittenBytes);
+
+  m_CompressedBlock.SetCountUninitialized(static_cast<ezUInt32>(ZSTD_compressBound(m_Block.GetCount())));
+
+  const size_t uiCompressedSize = ZSTD_compressCCtx(reinterpret_cast<ZSTD_CCtx*>(m_pZstdCCtx), m_CompressedBlock.GetData(), m_CompressedBlock.GetCount(), m_Block.GetData(), m_Block.GetCount(), m_iCompressionLevel);
+  EZ_VERIFY(!ZSTD_isError(uiCompressedSize), "Compressing a zstd block failed: '{0}'", ZSTD_getErrorName(uiCompressedSize));
+
+  // the reader recognizes uncompressed blocks by their size
+  if (uiCompressedSize < m_Block.GetCount())
+  {
+    EZ_SUCCEED_OR_RETURN(m_pOutputStream->WriteBytes(m_CompressedBlock.GetData(), uiCompressedSize));
+    m_uiWrittenBytes += uiCompressedSize;
+  }
+  else
+  {
+    EZ_SUCCEED_OR_RETURN(m_pOutputStream->WriteBytes(m_Block.GetData(), m_Block.GetCount()));
+    m_uiWrittenBytes += m_Block.GetCount();
+  }
+
+  m_Block.Clear();
+  return EZ_SUCCESS;
+}
+
+ezResult ezCompressedStreamWriterZstdSeekable::FinishCompressedStream()
+{
+  if (m_pOutputStream == nullptr)
+    return EZ_SUCCESS;
+
+  if (!m_Block.IsEmpty())
+  {
+    EZ_SUCCEED_OR_RETURN(WriteBlock());
+  }
+
+  ezStreamWriter& stream = *m_pOutputStream;
+  m_pOutputStream = nullptr;
+
+  for (ezUInt64 uiOffset : m_BlockOffsets)
+  {
+    stream << uiOffset;
+  }
+
+  stream << m_uiUncompressedSize;
+  stream << m_uiBlockSize;
+  stream << m_BlockOffsets.GetCount();
+
+  m_uiWrittenBytes += m_BlockOffsets.GetCount() * sizeof(ezUInt64) + s_uiSeekableFooterSize;
+
+  return EZ_SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+ezCompressedStreamReaderZstdSeekable::ezCompressedStreamReaderZstdSeekable() = default;
+
+ezCompressedStreamReaderZstdSeekable::~ezCompressedStreamReaderZstdSeekable() = default;
+
+ezResult ezCompressedStreamReaderZstdSeekable::SetInputData(ezArrayPtr<const ezUInt8> compressedData)
+{
+  m_CompressedData = {};
+  m_pJumpTable = nullptr;
+  m_uiUncompressedSize = 0;
+  m_uiReadPosition = 0;
+  m_uiBlockSize = 0;
+  m_uiNumBlocks = 0;
+  m_uiCachedBlock = ezInvalidIndex;
+
+  if (compressedData.GetCount() < s_uiSeekableFooterSize)
+    return EZ_FAILURE;
+
+  const ezUInt8* pFooter = compressedData.GetEndPtr() - s_uiSeekableFooterSize;
+
+  ezUInt64 uiUncompressedSize = 0;
+  ezUInt32 uiBlockSize = 0;
+  ezUInt32 uiNumBlocks = 0;
+  ezMemoryUtils::RawByteCopy(&uiUncompressedSize, pFooter, sizeof(ezUInt64));
+  ezMemoryUtils::RawByteCopy(&uiBlockSize, pFooter + sizeof(ezUInt64), sizeof(ezUInt32));
+  ezMemoryUtils::RawByteCopy(&uiNumBlocks, pFooter + sizeof(ezUInt64) + sizeof(ezUInt32), sizeof(ezUInt32));
+
+  const ezUInt64 uiJumpTableSize = static_cast<ezUInt64>(uiNumBlocks) * sizeof(ezUInt64);
+
+  if (uiBlockSize == 0 || uiJumpTableSize + s_uiSeekableFooterSize > compressedData.GetCount() || (ezUInt64)uiNumBlocks * uiBlockSize < uiUncompressedSize)
+    return EZ_FAILURE;
+
+  m_CompressedData = compressedData.GetSubArray(0, compressedData.GetCount() - s_uiSeekableFooterSize - static_cast<ezUInt32>(uiJumpTableSize));
+  m_pJumpTable = m_CompressedData.GetEndPtr();
+  m_uiUncompressedSize = uiUncompressedSize;
+  m_uiBlockSize = uiBlockSize;
+  m_uiNumBlocks = uiNumBlocks;
+
+  return EZ_SUCCESS;
+}
+
+ezResult ezCompressedStreamReaderZstdSeekable::DecompressBlock(ezUInt32 uiBlockIdx, void* pTarget)
+{
+  ezUInt64 uiStart = 0;
+  ezUInt64 uiEnd = m_CompressedData.GetCount();
+  ezMemoryUtils::RawByteCopy(&uiStart, m_pJumpTable + uiBlockIdx * sizeof(ezUInt64), sizeof(ezUInt64));
+
+  if (uiBlockIdx + 1 < m_uiNumBlocks)
+  {
+    ezMemoryUtils::RawByteCopy(&uiEnd, m_pJumpTable + (uiBlockIdx + 1) * sizeof(ezUInt64), sizeof(ezUInt64));
+  }
+
+  if (uiStart > uiEnd || uiEnd > m_CompressedData.GetCount())
+    return EZ_FAILURE;
+
+  const ezUInt64 uiBlockStart = static_cast<ezUInt64>(uiBlockIdx) * m_uiBlockSize;
+  const size_t uiBlockSize = static_cast<size_t>(ezMath::Min<ezUInt64>(m_uiBlockSize, m_uiUncompressedSize - uiBlockStart));
+  const size_t uiStoredSize = static_cast<size_t>(uiEnd - uiStart);
+
+  if (uiStoredSize == uiBlockSize)
+  {
+    ezMemoryUtils::RawByteCopy(pTarget, m_CompressedData.GetPtr() + uiStart, uiBlockSize);
+    return EZ_SUCCESS;
+  }
+
+  // a one-shot decompression doesn't keep any state in the context, so the context of whichever thread reads the block can be used
+  const size_t res = ZSTD_decompressDCtx(s_ZstdContext.Get(), pTarget, uiBlockSize, m_CompressedData.GetPtr() + uiStart, uiStoredSize);
+
+  if (ZSTD_isError(res) || res != uiBlockSize)
+    return EZ_FAILURE;
+
+  return EZ_SUCCESS;
+}
+
+ezUInt64 ezCompressedStreamReaderZstdSeekable::ReadBytes(void* pReadBuffer, ezUInt64 uiBytesToRead)
+{
+  if (pReadBuffer == nullptr)
+    return SkipBytes(uiBytesToRead);
+
+  uiBytesToRead = ezMath::Min(uiBytesToRead, m_uiUncompressedSize - m_uiReadPosition);
+
+  ezUInt8* pTarget = static_cast<ezUInt8*>(pReadBuffer);
+  ezUInt64 uiBytesRead = 0;
+
+  while (uiBytesRead < uiBytesToRead)
+  {
+    const ezUInt32 uiBlockIdx = static_cast<ezUInt32>(m_uiReadPosition / m_uiBlockSize);
+    const ezUInt64 uiBlockStart = static_cast<ezUInt64>(uiBlockIdx) * m_uiBlockSize;
+    const ezUInt32 uiBlockSize = static_cast<ezUInt32>(ezMath::Min<ezUInt64>(m_uiBlockSize, m_uiUncompressedSize - uiBlockStart));
+    const ezUInt32 uiOffsetInBlock = static_cast<ezUInt32>(m_uiReadPosition - uiBlockStart);
+    const ezUInt32 uiToCopy = static_cast<ezUInt32>(ezMath::Min<ezUInt64>(uiBytesToRead - uiBytesRead, uiBlockSize - uiOffsetInBlock));
+
+    if (uiOffsetInBlock == 0 && uiToCopy == uiBlockSize && m_uiCachedBlock != uiBlockIdx)
+    {
+      // whole blocks are decompressed directly into the target buffer
+      if (DecompressBlock(uiBlockIdx, pTarget + uiBytesRead).Failed())
+        break;
+    }
+    else
+    {
+      if (m_uiCachedBlock != uiBlockIdx)
+      {
+        m_BlockCache.SetCountUninitialized(m_uiBlockSize);
+        m_uiCachedBlock = ezInvalidIndex;
+
+        if (DecompressBlock(uiBlockIdx, m_BlockCache.GetData()).Failed())
+          break;
+
+        m_uiCachedBlock = uiBlockIdx;
+      }
+
+      ezMemoryUtils::RawByteCopy(pTarget + uiBytesRead, m_BlockCache.GetData() + uiOffsetInBlock, uiToCopy);
+    }
+
+    uiBytesRead += uiToCopy;
+    m_uiReadPosition += uiToCopy;
+  }
+
+  return uiBytesRead;
+}
+
+ezUInt64 ezCompressedStreamReaderZstdSeekable::SkipBytes(ezUInt64 uiBytesToSkip)
+{
+  const ezUInt64 uiPrevPosition = m_uiReadPosition;
+  SetReadPosition(m_uiReadPosition + uiBytesToSkip);
+  return m_uiReadPosition - uiPrevPosition;
+}
+
+void ezCompressedStreamReaderZstdSeekable::SetReadPosition(ezUInt64 uiPosition)
+{
+  m_uiReadPosition = ezMath::Min(uiPosition, m_uiUncompressedSize);
+}
+
 #endif
 
 
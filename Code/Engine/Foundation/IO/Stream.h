@@ -17,6 +17,11 @@ struct ezHybridString;
 
 using ezString = ezHybridString<32, ezDefaultAllocatorWrapper>;
 
+// ReadHashTable() and WriteHashTable() for flat hash tables are implemented in FlatHashTable_inl.h, so that this header doesn't
+// have to include the SIMD intrinsics that ezFlatHashTable uses.
+template <typename KeyType, typename ValueType, typename Hasher>
+class ezFlatHashTableBase;
+
 /// \brief Interface for binary in (read) streams.
 class EZ_FOUNDATION_DLL ezStreamReader
 {
@@ -69,6 +74,10 @@ public:
   template <typename KeyType, typename ValueType, typename Hasher>
   ezResult ReadHashTable(ezHashTableBase<KeyType, ValueType, Hasher>& inout_hashTable); // [tested]
 
+  /// \brief Read a flat hash table (note that the entry order is not stable)
+  template <typename KeyType, typename ValueType, typename Hasher>
+  ezResult ReadHashTable(ezFlatHashTableBase<KeyType, ValueType, Hasher>& inout_hashTable); // [tested]
+
   /// \brief Reads a string into an ezStringBuilder
   ezResult ReadString(ezStringBuilder& ref_sBuilder); // [tested]
 
@@ -164,6 +173,10 @@ public:
   template <typename KeyType, typename ValueType, typename Hasher>
   ezResult WriteHashTable(const ezHashTableBase<KeyType, ValueType, Hasher>& hashTable); // [tested]
 
+  /// \brief Writes a flat hash table, in the same format as an ezHashTable (note that the entry order might change on read)
+  template <typename KeyType, typename ValueType, typename Hasher>
+  ezResult WriteHashTable(const ezFlatHashTableBase<KeyType, ValueType, Hasher>& hashTable); // [tested]
+
   /// \brief Writes a string
   ezResult WriteString(const ezStringView sStringView); // [tested]
 };
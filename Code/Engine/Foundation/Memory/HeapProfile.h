@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Memory/MemoryTracker.h>
+
+/// \brief A snapshot of the memory held by allocators with ezAllocatorTrackingMode::AllocationStatsSampled, grouped by allocator and call stack.
+///
+/// The sizes are estimated from the sampled allocations, see ezMemoryTracker::SetSamplingInterval().
+/// Capture a profile at two points in time and compute their difference to find out which code paths hold on to more and more memory.
+class EZ_FOUNDATION_DLL ezHeapProfile
+{
+public:
+  struct Entry
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    ezAllocatorId m_AllocatorId;
+    ezUInt32 m_uiStackTraceId = 0; ///< See ezMemoryTracker::GetSampledStackTrace().
+    ezInt64 m_iNumSamples = 0;
+    ezInt64 m_iEstimatedSize = 0; ///< Estimated number of live bytes. In a difference this is negative if memory was freed.
+  };
+
+  /// \brief Replaces the content of this profile with the sampled allocations that are currently alive.
+  void Capture();
+
+  /// \brief Replaces the content of this profile with 'after - before'. Entries that did not change are left out.
+  void MakeDifference(const ezHeapProfile& before, const ezHeapProfile& after);
+
+  /// \brief Prints the entries with the largest estimated sizes together with their resolved stack traces.
+  void Print(ezDelegate<void(const char* szText)> printFunc, ezUInt32 uiMaxEntries = 32) const;
+
+  /// \brief Returns all entries, sorted by allocator and stack trace.
+  ezArrayPtr<const Entry> GetEntries() const { return m_Entries; }
+
+  ezInt64 GetTotalEstimatedSize() const;
+
+private:
+  ezDynamicArray<Entry> m_Entries;
+};
@@ -0,0 +1,696 @@
+#include <Foundation/FoundationPCH.h>
+
+#include <Foundation/Memory/MemoryTracker.h>
+#include <Foundation/Memory/Policies/AllocPolicyAlignedHeap.h>
+#include <Foundation/Memory/Policies/AllocPolicyThreadCaching.h>
+#include <Foundation/Threading/Lock.h>
+#include <Foundation/Threading/Mutex.h>
+
+#include <atomic>
+
+namespace
+{
+  constexpr ezUInt32 s_uiThreadCachingSlabSizeBits = 16;
+  constexpr size_t s_uiThreadCachingSlabSize = size_t(1) << s_uiThreadCachingSlabSizeBits;
+  constexpr ezUInt32 s_uiThreadCachingSlabsPerSpan = 16;
+
+  constexpr ezUInt32 s_uiThreadCachingNumSizeClasses = 24;
+  constexpr ezUInt32 s_ThreadCachingSizeClasses[s_uiThreadCachingNumSizeClasses] = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256,
+    320, 384, 448, 512,
+    640, 768, 896, 1024,
+    1280, 1536, 1792, 2048};
+
+  static_assert(s_ThreadCachingSizeClasses[s_uiThreadCachingNumSizeClasses - 1] == ezAllocPolicyThreadCaching::MaxSmallSize);
+
+  /// Maps (size + 15) / 16 to the index of the smallest size class that fits.
+  struct ThreadCachingSizeClassLookup
+  {
+    constexpr ThreadCachingSizeClassLookup()
+    {
+      ezUInt32 uiClass = 0;
+      for (ezUInt32 i = 0; i < EZ_ARRAY_SIZE(m_Index); ++i)
+      {
+        while (s_ThreadCachingSizeClasses[uiClass] < i * 16)
+        {
+          ++uiClass;
+        }
+        m_Index[i] = static_cast<ezUInt8>(uiClass);
+      }
+    }
+
+    ezUInt8 m_Index[ezAllocPolicyThreadCaching::MaxSmallSize / 16 + 1] = {};
+  };
+
+  constexpr ThreadCachingSizeClassLookup s_ThreadCachingSizeClassLookup;
+
+  /// Number of allocations and deallocations after which a thread cache adds its counts to the memory tracker.
+  constexpr ezUInt32 s_uiThreadCachingReportInterval = 64;
+
+  /// Number of blocks that are moved between a thread cache and the central pool at once.
+  EZ_ALWAYS_INLINE ezUInt32 GetThreadCachingBatchSize(ezUInt32 uiSizeClass)
+  {
+    return ezMath::Clamp<ezUInt32>(8192 / s_ThreadCachingSizeClasses[uiSizeClass], 4, 64);
+  }
+
+  // Two level map from slab address to size class + 1, shared by all policy instances. Zero means that the address does not belong to any
+  // slab, i.e. it is a large allocation. Entries are written before the blocks of a slab are handed out and cleared when the slab is freed.
+  struct ThreadCachingPageMapLeaf
+  {
+    ezUInt8 m_SizeClass[1 << 16];
+  };
+
+  std::atomic<ThreadCachingPageMapLeaf*> s_ThreadCachingPageMap[1 << 16];
+
+  EZ_ALWAYS_INLINE ezUInt32 LookupThreadCachingSlab(const void* pPtr)
+  {
+    const size_t uiSlab = reinterpret_cast<size_t>(pPtr) >> s_uiThreadCachingSlabSizeBits;
+    const size_t uiLeaf = uiSlab >> 16;
+    if (uiLeaf >= EZ_ARRAY_SIZE(s_ThreadCachingPageMap))
+      return 0;
+
+    const ThreadCachingPageMapLeaf* pLeaf = s_ThreadCachingPageMap[uiLeaf].load(std::memory_order_acquire);
+    return pLeaf != nullptr ? pLeaf->m_SizeClass[uiSlab & 0xFFFF] : 0;
+  }
+
+  void SetThreadCachingSlab(const void* pSlab, ezUInt32 uiValue)
+  {
+    const size_t uiSlab = reinterpret_cast<size_t>(pSlab) >> s_uiThreadCachingSlabSizeBits;
+    const size_t uiLeaf = uiSlab >> 16;
+    EZ_ASSERT_DEV(uiLeaf < EZ_ARRAY_SIZE(s_ThreadCachingPageMap), "Slab address is outside of the supported address range");
+
+    ThreadCachingPageMapLeaf* pLeaf = s_ThreadCachingPageMap[uiLeaf].load(std::memory_order_acquire);
+    if (pLeaf == nullptr)
+    {
+      ThreadCachingPageMapLeaf* pNewLeaf = static_cast<ThreadCachingPageMapLeaf*>(calloc(1, sizeof(ThreadCachingPageMapLeaf)));
+      if (s_ThreadCachingPageMap[uiLeaf].compare_exchange_strong(pLeaf, pNewLeaf, std::memory_order_acq_rel))
+      {
+        pLeaf = pNewLeaf;
+      }
+      else
+      {
+        free(pNewLeaf);
+      }
+    }
+
+    pLeaf->m_SizeClass[uiSlab & 0xFFFF] = static_cast<ezUInt8>(uiValue);
+  }
+} // namespace
+
+struct ezAllocPolicyThreadCaching::ThreadCache
+{
+  struct FreeBlock
+  {
+    FreeBlock* m_pNext;
+    FreeBlock* m_pNextBatch; ///< only used by the first block of a batch in the central pool
+  };
+
+  struct Bin
+  {
+    FreeBlock* m_pFirst = nullptr;
+    ezUInt32 m_uiCount = 0;
+  };
+
+  Bin m_Bins[s_uiThreadCachingNumSizeClasses];
+
+  // Only written by the owning thread, GetStats reads them from other threads.
+  std::atomic<ezUInt64> m_uiNumAllocations = 0;
+  std::atomic<ezUInt64> m_uiNumDeallocations = 0;
+  std::atomic<ezUInt64> m_uiAllocatedBytes = 0;
+  std::atomic<ezUInt64> m_uiDeallocatedBytes = 0;
+
+  // The part of the counters that was already added to the memory tracker, only accessed by the owning thread.
+  ezAllocatorId m_AllocatorId;
+  ezUInt32 m_uiNumUnreported = 0;
+  ezUInt64 m_uiReportedNumAllocations = 0;
+  ezUInt64 m_uiReportedNumDeallocations = 0;
+  ezUInt64 m_uiReportedAllocatedBytes = 0;
+  ezUInt64 m_uiReportedDeallocatedBytes = 0;
+
+  ThreadCache* m_pNext = nullptr;
+  bool m_bInUse = false;
+
+  EZ_ALWAYS_INLINE void CountAllocation(size_t uiSize)
+  {
+    m_uiNumAllocations.store(m_uiNumAllocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_uiAllocatedBytes.store(m_uiAllocatedBytes.load(std::memory_order_relaxed) + uiSize, std::memory_order_relaxed);
+
+    if (++m_uiNumUnreported >= s_uiThreadCachingReportInterval)
+    {
+      ReportStats();
+    }
+  }
+
+  EZ_ALWAYS_INLINE void CountDeallocation(size_t uiSize)
+  {
+    m_uiNumDeallocations.store(m_uiNumDeallocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_uiDeallocatedBytes.store(m_uiDeallocatedBytes.load(std::memory_order_relaxed) + uiSize, std::memory_order_relaxed);
+
+    if (++m_uiNumUnreported >= s_uiThreadCachingReportInterval)
+    {
+      ReportStats();
+    }
+  }
+
+  void ReportStats();
+
+  void* Allocate(Pool& ref_pool, ezUInt32 uiSizeClass);
+  void Deallocate(Pool& ref_pool, ezUInt32 uiSizeClass, void* pPtr);
+};
+
+struct ezAllocPolicyThreadCaching::Pool
+{
+  using FreeBlock = ThreadCache::FreeBlock;
+
+  struct CentralBin
+  {
+    FreeBlock* m_pBatches = nullptr; ///< stack of full batches, linked through FreeBlock::m_pNextBatch
+    FreeBlock* m_pLoose = nullptr;   ///< blocks that did not fill a whole batch
+    ezUInt32 m_uiNumLoose = 0;
+  };
+
+  struct Span
+  {
+    void* m_pMemory;
+    Span* m_pNext;
+  };
+
+  ezUInt64 m_uiId = 0;
+  Pool* m_pNextLivePool = nullptr;
+
+  ezMutex m_Mutex;
+  CentralBin m_Bins[s_uiThreadCachingNumSizeClasses];
+
+  ThreadCache* m_pThreadCaches = nullptr;
+  ThreadCache m_SharedCache; ///< used under m_Mutex by threads that have no thread cache slot left
+
+  Span* m_pSpans = nullptr;
+  ezUInt8* m_pNextSlab = nullptr;
+  ezUInt32 m_uiRemainingSlabs = 0;
+
+  ezAllocPolicyAlignedHeap m_AlignedHeap = ezAllocPolicyAlignedHeap(nullptr);
+
+  void Refill(ThreadCache::Bin& ref_bin, ezUInt32 uiSizeClass);
+  void ReleaseBatch(ThreadCache::Bin& ref_bin, ezUInt32 uiSizeClass);
+  void ReleaseThreadCache(ThreadCache& ref_cache);
+  void CarveSlab(ezUInt32 uiSizeClass);
+};
+
+namespace
+{
+  /// All live pools, so that exiting threads can check whether the pools of their caches still exist.
+  struct ThreadCachingRegistry
+  {
+    ezMutex m_Mutex;
+    ezAllocPolicyThreadCaching::Pool* m_pFirstPool = nullptr;
+    ezUInt64 m_uiNextPoolId = 1;
+
+    ezAllocPolicyThreadCaching::Pool* FindPool(ezUInt64 uiId) const
+    {
+      for (ezAllocPolicyThreadCaching::Pool* pPool = m_pFirstPool; pPool != nullptr; pPool = pPool->m_pNextLivePool)
+      {
+        if (pPool->m_uiId == uiId)
+          return pPool;
+      }
+      return nullptr;
+    }
+  };
+
+  ThreadCachingRegistry& GetThreadCachingRegistry()
+  {
+    // never destroyed, threads may still exit after static destruction
+    alignas(ThreadCachingRegistry) static ezUInt8 s_Buffer[sizeof(ThreadCachingRegistry)];
+    static ThreadCachingRegistry* s_pRegistry = new (s_Buffer) ThreadCachingRegistry();
+    return *s_pRegistry;
+  }
+
+  struct ThreadCachingSlots
+  {
+    struct Slot
+    {
+      ezUInt64 m_uiPoolId = 0;
+      ezAllocPolicyThreadCaching::ThreadCache* m_pCache = nullptr;
+    };
+
+    Slot m_Slots[8];
+
+    ~ThreadCachingSlots()
+    {
+      ThreadCachingRegistry& registry = GetThreadCachingRegistry();
+      EZ_LOCK(registry.m_Mutex);
+
+      for (Slot& slot : m_Slots)
+      {
+        if (slot.m_uiPoolId == 0)
+          continue;
+
+        if (ezAllocPolicyThreadCaching::Pool* pPool = registry.FindPool(slot.m_uiPoolId))
+        {
+          pPool->ReleaseThreadCache(*slot.m_pCache);
+        }
+
+        slot = Slot();
+      }
+    }
+  };
+
+  thread_local ThreadCachingSlots tl_ThreadCachingSlots;
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+void ezAllocPolicyThreadCaching::ThreadCache::ReportStats()
+{
+  m_uiNumUnreported = 0;
+
+  if (m_AllocatorId.IsInvalidated())
+    return;
+
+  const ezUInt64 uiNumAllocations = m_uiNumAllocations.load(std::memory_order_relaxed);
+  const ezUInt64 uiNumDeallocations = m_uiNumDeallocations.load(std::memory_order_relaxed);
+  const ezUInt64 uiAllocatedBytes = m_uiAllocatedBytes.load(std::memory_order_relaxed);
+  const ezUInt64 uiDeallocatedBytes = m_uiDeallocatedBytes.load(std::memory_order_relaxed);
+
+  ezMemoryTracker::AddAllocatorStats(m_AllocatorId, uiNumAllocations - m_uiReportedNumAllocations, uiNumDeallocations - m_uiReportedNumDeallocations,
+    uiAllocatedBytes - m_uiReportedAllocatedBytes, uiDeallocatedBytes - m_uiReportedDeallocatedBytes);
+
+  m_uiReportedNumAllocations = uiNumAllocations;
+  m_uiReportedNumDeallocations = uiNumDeallocations;
+  m_uiReportedAllocatedBytes = uiAllocatedBytes;
+  m_uiReportedDeallocatedBytes = uiDeallocatedBytes;
+}
+
+EZ_FORCE_INLINE void* ezAllocPolicyThreadCaching::ThreadCache::Allocate(Pool& ref_pool, ezUInt32 uiSizeClass)
+{
+  Bin& bin = m_Bins[uiSizeClass];
+  if (bin.m_pFirst == nullptr)
+  {
+    ref_pool.Refill(bin, uiSizeClass);
+  }
+
+  FreeBlock* pBlock = bin.m_pFirst;
+  bin.m_pFirst = pBlock->m_pNext;
+  --bin.m_uiCount;
+
+  CountAllocation(s_ThreadCachingSizeClasses[uiSizeClass]);
+  return pBlock;
+}
+
+EZ_FORCE_INLINE void ezAllocPolicyThreadCaching::ThreadCache::Deallocate(Pool& ref_pool, ezUInt32 uiSizeClass, void* pPtr)
+{
+  Bin& bin = m_Bins[uiSizeClass];
+
+  FreeBlock* pBlock = static_cast<FreeBlock*>(pPtr);
+  pBlock->m_pNext = bin.m_pFirst;
+  bin.m_pFirst = pBlock;
+  ++bin.m_uiCount;
+
+  CountDeallocation(s_ThreadCachingSizeClasses[uiSizeClass]);
+
+  if (bin.m_uiCount >= 2 * GetThreadCachingBatchSize(uiSizeClass))
+  {
+    ref_pool.ReleaseBatch(bin, uiSizeClass);
+  }
+}
+
+void ezAllocPolicyThreadCaching::Pool::Refill(ThreadCache::Bin& ref_bin, ezUInt32 uiSizeClass)
+{
+  EZ_LOCK(m_Mutex);
+
+  CentralBin& centralBin = m_Bins[uiSizeClass];
+
+  if (centralBin.m_pBatches == nullptr && centralBin.m_pLoose == nullptr)
+  {
+    CarveSlab(uiSizeClass);
+  }
+
+  if (centralBin.m_pBatches != nullptr)
+  {
+    FreeBlock* pBatch = centralBin.m_pBatches;
+    centralBin.m_pBatches = pBatch->m_pNextBatch;
+
+    ref_bin.m_pFirst = pBatch;
+    ref_bin.m_uiCount = GetThreadCachingBatchSize(uiSizeClass);
+  }
+  else
+  {
+    ref_bin.m_pFirst = centralBin.m_pLoose;
+    ref_bin.m_uiCount = centralBin.m_uiNumLoose;
+
+    centralBin.m_pLoose = nullptr;
+    centralBin.m_uiNumLoose = 0;
+  }
+}
+
+void ezAllocPolicyThreadCaching::Pool::ReleaseBatch(ThreadCache::Bin& ref_bin, ezUInt32 uiSizeClass)
+{
+  const ezUInt32 uiBatchSize = GetThreadCachingBatchSize(uiSizeClass);
+  EZ_ASSERT_DEBUG(ref_bin.m_uiCount >= uiBatchSize, "Not enough blocks for a whole batch");
+
+  // cut the batch off the bin without holding the lock
+  FreeBlock* pFirst = ref_bin.m_pFirst;
+  FreeBlock* pLast = pFirst;
+  for (ezUInt32 i = 1; i < uiBatchSize; ++i)
+  {
+    pLast = pLast->m_pNext;
+  }
+
+  ref_bin.m_pFirst = pLast->m_pNext;
+  ref_bin.m_uiCount -= uiBatchSize;
+  pLast->m_pNext = nullptr;
+
+  EZ_LOCK(m_Mutex);
+
+  CentralBin& centralBin = m_Bins[uiSizeClass];
+  pFirst->m_pNextBatch = centralBin.m_pBatches;
+  centralBin.m_pBatches = pFirst;
+}
+
+void ezAllocPolicyThreadCaching::Pool::ReleaseThreadCache(ThreadCache& ref_cache)
+{
+  ref_cache.ReportStats();
+
+  for (ezUInt32 uiSizeClass = 0; uiSizeClass < s_uiThreadCachingNumSizeClasses; ++uiSizeClass)
+  {
+    ThreadCache::Bin& bin = ref_cache.m_Bins[uiSizeClass];
+
+    while (bin.m_uiCount >= GetThreadCachingBatchSize(uiSizeClass))
+    {
+      ReleaseBatch(bin, uiSizeClass);
+    }
+
+    if (bin.m_pFirst != nullptr)
+    {
+      FreeBlock* pLast = bin.m_pFirst;
+      while (pLast->m_pNext != nullptr)
+      {
+        pLast = pLast->m_pNext;
+      }
+
+      EZ_LOCK(m_Mutex);
+
+      CentralBin& centralBin = m_Bins[uiSizeClass];
+      pLast->m_pNext = centralBin.m_pLoose;
+      centralBin.m_pLoose = bin.m_pFirst;
+      centralBin.m_uiNumLoose += bin.m_uiCount;
+    }
+
+    bin = ThreadCache::Bin();
+  }
+
+  EZ_LOCK(m_Mutex);
+  ref_cache.m_bInUse = false;
+}
+
+void ezAllocPolicyThreadCaching::Pool::CarveSlab(ezUInt32 uiSizeClass)
+{
+  if (m_uiRemainingSlabs == 0)
+  {
+    const size_t uiSpanSize = s_uiThreadCachingSlabSize * s_uiThreadCachingSlabsPerSpan;
+
+    Span* pSpan = static_cast<Span*>(malloc(sizeof(Span)));
+    pSpan->m_pMemory = m_AlignedHeap.Allocate(uiSpanSize, s_uiThreadCachingSlabSize);
+    pSpan->m_pNext = m_pSpans;
+    m_pSpans = pSpan;
+
+    m_pNextSlab = static_cast<ezUInt8*>(pSpan->m_pMemory);
+    m_uiRemainingSlabs = s_uiThreadCachingSlabsPerSpan;
+  }
+
+  ezUInt8* pSlab = m_pNextSlab;
+  m_pNextSlab += s_uiThreadCachingSlabSize;
+  --m_uiRemainingSlabs;
+
+  SetThreadCachingSlab(pSlab, uiSizeClass + 1);
+
+  const ezUInt32 uiBlockSize = s_ThreadCachingSizeClasses[uiSizeClass];
+  const ezUInt32 uiNumBlocks = static_cast<ezUInt32>(s_uiThreadCachingSlabSize / uiBlockSize);
+  const ezUInt32 uiBatchSize = GetThreadCachingBatchSize(uiSizeClass);
+
+  CentralBin& centralBin = m_Bins[uiSizeClass];
+
+  // push the blocks in reverse, so that they are handed out in address order
+  ezUInt32 uiBlock = uiNumBlocks;
+  while (uiBlock >= uiBatchSize)
+  {
+    FreeBlock* pFirst = nullptr;
+    for (ezUInt32 i = 0; i < uiBatchSize; ++i)
+    {
+      --uiBlock;
+      FreeBlock* pBlock = reinterpret_cast<FreeBlock*>(pSlab + uiBlock * uiBlockSize);
+      pBlock->m_pNext = pFirst;
+      pFirst = pBlock;
+    }
+
+    pFirst->m_pNextBatch = centralBin.m_pBatches;
+    centralBin.m_pBatches = pFirst;
+  }
+
+  while (uiBlock > 0)
+  {
+    --uiBlock;
+    FreeBlock* pBlock = reinterpret_cast<FreeBlock*>(pSlab + uiBlock * uiBlockSize);
+    pBlock->m_pNext = centralBin.m_pLoose;
+    centralBin.m_pLoose = pBlock;
+    ++centralBin.m_uiNumLoose;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+ezAllocPolicyThreadCaching::ezAllocPolicyThreadCaching(ezAllocator* pParent)
+{
+  void* pPoolMemory = malloc(sizeof(Pool));
+  m_pPool = new (pPoolMemory) Pool();
+
+  ThreadCachingRegistry& registry = GetThreadCachingRegistry();
+  EZ_LOCK(registry.m_Mutex);
+
+  m_pPool->m_uiId = registry.m_uiNextPoolId++;
+  m_pPool->m_pNextLivePool = registry.m_pFirstPool;
+  registry.m_pFirstPool = m_pPool;
+}
+
+ezAllocPolicyThreadCaching::~ezAllocPolicyThreadCaching()
+{
+  {
+    ThreadCachingRegistry& registry = GetThreadCachingRegistry();
+    EZ_LOCK(registry.m_Mutex);
+
+    Pool** ppPool = &registry.m_pFirstPool;
+    while (*ppPool != m_pPool)
+    {
+      ppPool = &(*ppPool)->m_pNextLivePool;
+    }
+    *ppPool = m_pPool->m_pNextLivePool;
+  }
+
+  // thread slots that still reference this pool are recognized as stale through the pool id and reused later
+  while (ThreadCache* pCache = m_pPool->m_pThreadCaches)
+  {
+    m_pPool->m_pThreadCaches = pCache->m_pNext;
+    pCache->~ThreadCache();
+    free(pCache);
+  }
+
+  while (Pool::Span* pSpan = m_pPool->m_pSpans)
+  {
+    m_pPool->m_pSpans = pSpan->m_pNext;
+
+    for (ezUInt32 i = 0; i < s_uiThreadCachingSlabsPerSpan; ++i)
+    {
+      SetThreadCachingSlab(static_cast<ezUInt8*>(pSpan->m_pMemory) + i * s_uiThreadCachingSlabSize, 0);
+    }
+
+    m_pPool->m_AlignedHeap.Deallocate(pSpan->m_pMemory);
+    free(pSpan);
+  }
+
+  m_pPool->~Pool();
+  free(m_pPool);
+  m_pPool = nullptr;
+}
+
+ezAllocPolicyThreadCaching::ThreadCache* ezAllocPolicyThreadCaching::GetThreadCache()
+{
+  ThreadCachingSlots& slots = tl_ThreadCachingSlots;
+  const ezUInt64 uiPoolId = m_pPool->m_uiId;
+
+  for (const ThreadCachingSlots::Slot& slot : slots.m_Slots)
+  {
+    if (slot.m_uiPoolId == uiPoolId)
+      return slot.m_pCache;
+  }
+
+  // slow path, first use of this pool on this thread
+  ThreadCachingSlots::Slot* pFreeSlot = nullptr;
+  {
+    ThreadCachingRegistry& registry = GetThreadCachingRegistry();
+    EZ_LOCK(registry.m_Mutex);
+
+    for (ThreadCachingSlots::Slot& slot : slots.m_Slots)
+    {
+      if (slot.m_uiPoolId != 0 && registry.FindPool(slot.m_uiPoolId) == nullptr)
+      {
+        slot = ThreadCachingSlots::Slot();
+      }
+
+      if (slot.m_uiPoolId == 0 && pFreeSlot == nullptr)
+      {
+        pFreeSlot = &slot;
+      }
+    }
+  }
+
+  if (pFreeSlot == nullptr)
+    return nullptr;
+
+  EZ_LOCK(m_pPool->m_Mutex);
+
+  ThreadCache* pCache = m_pPool->m_pThreadCaches;
+  while (pCache != nullptr && pCache->m_bInUse)
+  {
+    pCache = pCache->m_pNext;
+  }
+
+  if (pCache == nullptr)
+  {
+    void* pCacheMemory = malloc(sizeof(ThreadCache));
+    pCache = new (pCacheMemory) ThreadCache();
+    pCache->m_AllocatorId = m_pPool->m_SharedCache.m_AllocatorId;
+    pCache->m_pNext = m_pPool->m_pThreadCaches;
+    m_pPool->m_pThreadCaches = pCache;
+  }
+
+  pCache->m_bInUse = true;
+
+  pFreeSlot->m_uiPoolId = uiPoolId;
+  pFreeSlot->m_pCache = pCache;
+  return pCache;
+}
+
+void* ezAllocPolicyThreadCaching::Allocate(size_t uiSize, size_t uiAlign)
+{
+  ThreadCache* pCache = GetThreadCache();
+
+  if (uiSize <= MaxSmallSize && uiAlign <= MaxSmallAlignment)
+  {
+    const ezUInt32 uiSizeClass = s_ThreadCachingSizeClassLookup.m_Index[(uiSize + 15) / 16];
+
+    if (pCache != nullptr)
+      return pCache->Allocate(*m_pPool, uiSizeClass);
+
+    EZ_LOCK(m_pPool->m_Mutex);
+    return m_pPool->m_SharedCache.Allocate(*m_pPool, uiSizeClass);
+  }
+
+  // large allocations store their size and the offset to the actual memory right in front of the returned pointer
+  const size_t uiOffset = ezMath::Max<size_t>(uiAlign, 2 * sizeof(size_t));
+  ezUInt8* pMemory = static_cast<ezUInt8*>(m_pPool->m_AlignedHeap.Allocate(uiSize + uiOffset, uiOffset));
+
+  size_t* pHeader = reinterpret_cast<size_t*>(pMemory + uiOffset) - 2;
+  pHeader[0] = uiSize;
+  pHeader[1] = uiOffset;
+
+  if (pCache != nullptr)
+  {
+    pCache->CountAllocation(uiSize);
+  }
+  else
+  {
+    EZ_LOCK(m_pPool->m_Mutex);
+    m_pPool->m_SharedCache.CountAllocation(uiSize);
+  }
+
+  return pMemory + uiOffset;
+}
+
+void ezAllocPolicyThreadCaching::Deallocate(void* pPtr)
+{
+  if (pPtr == nullptr)
+    return;
+
+  ThreadCache* pCache = GetThreadCache();
+
+  if (const ezUInt32 uiSlab = LookupThreadCachingSlab(pPtr))
+  {
+    if (pCache != nullptr)
+    {
+      pCache->Deallocate(*m_pPool, uiSlab - 1, pPtr);
+    }
+    else
+    {
+      EZ_LOCK(m_pPool->m_Mutex);
+      m_pPool->m_SharedCache.Deallocate(*m_pPool, uiSlab - 1, pPtr);
+    }
+
+    return;
+  }
+
+  const size_t* pHeader = static_cast<const size_t*>(pPtr) - 2;
+  const size_t uiSize = pHeader[0];
+  const size_t uiOffset = pHeader[1];
+
+  if (pCache != nullptr)
+  {
+    pCache->CountDeallocation(uiSize);
+  }
+  else
+  {
+    EZ_LOCK(m_pPool->m_Mutex);
+    m_pPool->m_SharedCache.CountDeallocation(uiSize);
+  }
+
+  m_pPool->m_AlignedHeap.Deallocate(static_cast<ezUInt8*>(pPtr) - uiOffset);
+}
+
+size_t ezAllocPolicyThreadCaching::GetAllocatedSize(const void* pPtr) const
+{
+  if (const ezUInt32 uiSlab = LookupThreadCachingSlab(pPtr))
+  {
+    return s_ThreadCachingSizeClasses[uiSlab - 1];
+  }
+
+  return (static_cast<const size_t*>(pPtr) - 2)[0];
+}
+
+void ezAllocPolicyThreadCaching::SetAllocatorId(ezAllocatorId allocatorId)
+{
+  EZ_LOCK(m_pPool->m_Mutex);
+  EZ_ASSERT_DEV(m_pPool->m_pThreadCaches == nullptr, "The allocator id has to be set before the first allocation");
+
+  m_pPool->m_SharedCache.m_AllocatorId = allocatorId;
+}
+
+void ezAllocPolicyThreadCaching::GetStats(ezAllocator::Stats& out_stats) const
+{
+  ezUInt64 uiNumAllocations = 0;
+  ezUInt64 uiNumDeallocations = 0;
+  ezUInt64 uiAllocatedBytes = 0;
+  ezUInt64 uiDeallocatedBytes = 0;
+
+  auto AddCache = [&](const ThreadCache& cache)
+  {
+    uiNumDeallocations += cache.m_uiNumDeallocations.load(std::memory_order_relaxed);
+    uiDeallocatedBytes += cache.m_uiDeallocatedBytes.load(std::memory_order_relaxed);
+    uiNumAllocations += cache.m_uiNumAllocations.load(std::memory_order_relaxed);
+    uiAllocatedBytes += cache.m_uiAllocatedBytes.load(std::memory_order_relaxed);
+  };
+
+  {
+    EZ_LOCK(m_pPool->m_Mutex);
+
+    AddCache(m_pPool->m_SharedCache);
+
+    for (const ThreadCache* pCache = m_pPool->m_pThreadCaches; pCache != nullptr; pCache = pCache->m_pNext)
+    {
+      AddCache(*pCache);
+    }
+  }
+
+  out_stats.m_uiNumAllocations = uiNumAllocations;
+  out_stats.m_uiNumDeallocations = uiNumDeallocations;
+  // counters of other threads may be read mid-update, so don't let the difference wrap around
+  out_stats.m_uiAllocationSize = uiAllocatedBytes > uiDeallocatedBytes ? uiAllocatedBytes - uiDeallocatedBytes : 0;
+}
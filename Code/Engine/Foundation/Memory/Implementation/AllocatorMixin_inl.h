@@ -68,23 +68,36 @@ void* ezInternal::ezAllocatorImpl<A, TrackingMode>::Allocate(size_t uiSize, size
 
   EZ_ASSERT_DEBUG(ezMath::IsPowerOf2((ezUInt32)uiAlign), "Alignment must be power of two");
 
-  ezTime fAllocationTime = ezTime::Now();
-
-  void* ptr = m_allocator.Allocate(uiSize, uiAlign);
-  EZ_ASSERT_DEV(ptr != nullptr, "Could not allocate {0} bytes. Out of memory?", uiSize);
-
   if constexpr (TrackingMode >= ezAllocatorTrackingMode::AllocationStats)
   {
+    ezTime fAllocationTime = ezTime::Now();
+
+    void* ptr = m_allocator.Allocate(uiSize, uiAlign);
+    EZ_ASSERT_DEV(ptr != nullptr, "Could not allocate {0} bytes. Out of memory?", uiSize);
+
     ezMemoryTracker::AddAllocation(this->m_Id, TrackingMode, ptr, uiSize, uiAlign, ezTime::Now() - fAllocationTime);
+
+    return ptr;
   }
+  else
+  {
+    // don't query the time if nobody is interested in it
+    void* ptr = m_allocator.Allocate(uiSize, uiAlign);
+    EZ_ASSERT_DEV(ptr != nullptr, "Could not allocate {0} bytes. Out of memory?", uiSize);
+
+    if constexpr (TrackingMode >= ezAllocatorTrackingMode::AllocationStatsSampled)
+    {
+      ezMemoryTracker::AddAllocation(this->m_Id, TrackingMode, ptr, uiSize, uiAlign, ezTime::MakeZero());
+    }
 
-  return ptr;
+    return ptr;
+  }
 }
 
 template <typename A, ezAllocatorTrackingMode TrackingMode>
 void ezInternal::ezAllocatorImpl<A, TrackingMode>::Deallocate(void* pPtr)
 {
-  if constexpr (TrackingMode >= ezAllocatorTrackingMode::AllocationStats)
+  if constexpr (TrackingMode >= ezAllocatorTrackingMode::AllocationStatsSampled)
   {
     ezMemoryTracker::RemoveAllocation(this->m_Id, pPtr);
   }
@@ -145,7 +158,7 @@ ezInternal::ezAllocatorMixinReallocate<A, TrackingMode, true>::ezAllocatorMixinR
 template <typename A, ezAllocatorTrackingMode TrackingMode>
 void* ezInternal::ezAllocatorMixinReallocate<A, TrackingMode, true>::Reallocate(void* pPtr, size_t uiCurrentSize, size_t uiNewSize, size_t uiAlign)
 {
-  if constexpr (TrackingMode >= ezAllocatorTrackingMode::AllocationStats)
+  if constexpr (TrackingMode >= ezAllocatorTrackingMode::AllocationStatsSampled)
   {
     ezMemoryTracker::RemoveAllocation(this->m_Id, pPtr);
   }
@@ -154,7 +167,7 @@ void* ezInternal::ezAllocatorMixinReallocate<A, TrackingMode, true>::Reallocate(
 
   void* pNewMem = this->m_allocator.Reallocate(pPtr, uiCurrentSize, uiNewSize, uiAlign);
 
-  if constexpr (TrackingMode >= ezAllocatorTrackingMode::AllocationStats)
+  if constexpr (TrackingMode >= ezAllocatorTrackingMode::AllocationStatsSampled)
   {
     ezMemoryTracker::AddAllocation(this->m_Id, TrackingMode, pNewMem, uiNewSize, uiAlign, ezTime::Now() - fAllocationTime);
   }
@@ -0,0 +1,156 @@
+#include <Foundation/FoundationPCH.h>
+
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Memory/HeapProfile.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/System/StackTracer.h>
+
+namespace
+{
+  EZ_ALWAYS_INLINE bool IsSameHeapProfileKey(const ezHeapProfile::Entry& a, const ezHeapProfile::Entry& b)
+  {
+    return a.m_AllocatorId == b.m_AllocatorId && a.m_uiStackTraceId == b.m_uiStackTraceId;
+  }
+
+  EZ_ALWAYS_INLINE bool IsLessHeapProfileKey(const ezHeapProfile::Entry& a, const ezHeapProfile::Entry& b)
+  {
+    if (a.m_AllocatorId != b.m_AllocatorId)
+      return a.m_AllocatorId < b.m_AllocatorId;
+
+    return a.m_uiStackTraceId < b.m_uiStackTraceId;
+  }
+} // namespace
+
+void ezHeapProfile::Capture()
+{
+  m_Entries.Clear();
+
+  ezMemoryTracker::EnumerateSampledAllocations([this](const ezMemoryTracker::SampledAllocation& sample)
+    {
+      Entry& entry = m_Entries.ExpandAndGetRef();
+      entry.m_AllocatorId = sample.m_AllocatorId;
+      entry.m_uiStackTraceId = sample.m_uiStackTraceId;
+      entry.m_iNumSamples = 1;
+      entry.m_iEstimatedSize = static_cast<ezInt64>(sample.m_uiWeight); });
+
+  m_Entries.Sort([](const Entry& a, const Entry& b)
+    { return IsLessHeapProfileKey(a, b); });
+
+  // merge the samples with the same allocator and stack trace
+  ezUInt32 uiNumMerged = 0;
+  for (ezUInt32 i = 0; i < m_Entries.GetCount(); ++i)
+  {
+    if (uiNumMerged > 0 && IsSameHeapProfileKey(m_Entries[uiNumMerged - 1], m_Entries[i]))
+    {
+      m_Entries[uiNumMerged - 1].m_iNumSamples += m_Entries[i].m_iNumSamples;
+      m_Entries[uiNumMerged - 1].m_iEstimatedSize += m_Entries[i].m_iEstimatedSize;
+    }
+    else
+    {
+      m_Entries[uiNumMerged++] = m_Entries[i];
+    }
+  }
+
+  m_Entries.SetCount(uiNumMerged);
+}
+
+void ezHeapProfile::MakeDifference(const ezHeapProfile& before, const ezHeapProfile& after)
+{
+  EZ_ASSERT_DEV(this != &before && this != &after, "The difference can't be stored in one of its inputs");
+
+  m_Entries.Clear();
+
+  auto AddEntry = [&](const Entry& entry, ezInt64 iSign)
+  {
+    if (!m_Entries.IsEmpty() && IsSameHeapProfileKey(m_Entries.PeekBack(), entry))
+    {
+      m_Entries.PeekBack().m_iNumSamples += iSign * entry.m_iNumSamples;
+      m_Entries.PeekBack().m_iEstimatedSize += iSign * entry.m_iEstimatedSize;
+
+      if (m_Entries.PeekBack().m_iNumSamples == 0 && m_Entries.PeekBack().m_iEstimatedSize == 0)
+      {
+        m_Entries.PopBack();
+      }
+    }
+    else
+    {
+      Entry& newEntry = m_Entries.ExpandAndGetRef();
+      newEntry = entry;
+      newEntry.m_iNumSamples *= iSign;
+      newEntry.m_iEstimatedSize *= iSign;
+    }
+  };
+
+  // both inputs are sorted, so equal keys end up next to each other
+  ezUInt32 uiBefore = 0;
+  ezUInt32 uiAfter = 0;
+  while (uiBefore < before.m_Entries.GetCount() || uiAfter < after.m_Entries.GetCount())
+  {
+    if (uiAfter == after.m_Entries.GetCount() || (uiBefore < before.m_Entries.GetCount() && !IsLessHeapProfileKey(after.m_Entries[uiAfter], before.m_Entries[uiBefore])))
+    {
+      AddEntry(before.m_Entries[uiBefore++], -1);
+    }
+    else
+    {
+      AddEntry(after.m_Entries[uiAfter++], 1);
+    }
+  }
+}
+
+void ezHeapProfile::Print(ezDelegate<void(const char* szText)> printFunc, ezUInt32 uiMaxEntries /*= 32*/) const
+{
+  ezHashTable<ezUInt32, ezString> allocatorNames;
+  for (auto it = ezMemoryTracker::GetIterator(); it.IsValid(); ++it)
+  {
+    allocatorNames[it.Id().m_Data] = it.Name();
+  }
+
+  ezDynamicArray<const Entry*> sortedEntries;
+  sortedEntries.Reserve(m_Entries.GetCount());
+  for (const Entry& entry : m_Entries)
+  {
+    sortedEntries.PushBack(&entry);
+  }
+
+  sortedEntries.Sort([](const Entry* a, const Entry* b)
+    { return a->m_iEstimatedSize > b->m_iEstimatedSize; });
+
+  ezStringBuilder sLine;
+  sLine.SetFormat("Heap profile: {0} bytes in {1} call stacks, sampling interval {2} bytes\n", GetTotalEstimatedSize(), m_Entries.GetCount(), ezMemoryTracker::GetSamplingInterval());
+  printFunc(sLine.GetData());
+
+  const ezUInt32 uiNumEntries = ezMath::Min(uiMaxEntries, sortedEntries.GetCount());
+  for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+  {
+    const Entry& entry = *sortedEntries[i];
+
+    const ezString* pAllocatorName = nullptr;
+    allocatorNames.TryGetValue(entry.m_AllocatorId.m_Data, pAllocatorName);
+
+    sLine.SetFormat("\n{0} bytes, {1} samples, allocator '{2}'\n", entry.m_iEstimatedSize, entry.m_iNumSamples, pAllocatorName != nullptr ? pAllocatorName->GetView() : ezStringView("<destroyed>"));
+    printFunc(sLine.GetData());
+
+    const ezArrayPtr<void*> stackTrace = ezMemoryTracker::GetSampledStackTrace(entry.m_uiStackTraceId);
+    if (!stackTrace.IsEmpty())
+    {
+      ezStackTracer::ResolveStackTrace(stackTrace, printFunc);
+    }
+  }
+
+  if (uiNumEntries < sortedEntries.GetCount())
+  {
+    sLine.SetFormat("\n{0} more call stacks\n", sortedEntries.GetCount() - uiNumEntries);
+    printFunc(sLine.GetData());
+  }
+}
+
+ezInt64 ezHeapProfile::GetTotalEstimatedSize() const
+{
+  ezInt64 iTotalSize = 0;
+  for (const Entry& entry : m_Entries)
+  {
+    iTotalSize += entry.m_iEstimatedSize;
+  }
+
+  return iTotalSize;
+}
@@ -162,7 +162,7 @@ void* ezLargeBlockAllocator<BlockSize>::Allocate(size_t uiAlign)
     ptr = pMemory;
   }
 
-  if (m_TrackingMode >= ezAllocatorTrackingMode::AllocationStats)
+  if (m_TrackingMode >= ezAllocatorTrackingMode::AllocationStatsSampled)
   {
     ezMemoryTracker::AddAllocation(m_Id, m_TrackingMode, ptr, BlockSize, uiAlign, ezTime::Now() - fAllocationTime);
   }
@@ -175,7 +175,7 @@ void ezLargeBlockAllocator<BlockSize>::Deallocate(void* ptr)
 {
   EZ_LOCK(m_Mutex);
 
-  if (m_TrackingMode >= ezAllocatorTrackingMode::AllocationStats)
+  if (m_TrackingMode >= ezAllocatorTrackingMode::AllocationStatsSampled)
   {
     ezMemoryTracker::RemoveAllocation(m_Id, ptr);
   }
@@ -69,7 +69,7 @@ void ezLinearAllocator<TrackingMode>::Reset()
   m_PtrToDestructDataIndexTable.Clear();
 
   this->m_allocator.Reset();
-  if constexpr (TrackingMode >= ezAllocatorTrackingMode::AllocationStats)
+  if constexpr (TrackingMode >= ezAllocatorTrackingMode::AllocationStatsSampled)
   {
     ezMemoryTracker::RemoveAllAllocations(this->m_Id);
   }
@@ -1,5 +1,7 @@
 #include <Foundation/FoundationPCH.h>
 
+#include <Foundation/Algorithm/HashingUtils.h>
+#include <Foundation/Containers/DynamicArray.h>
 #include <Foundation/Containers/HashTable.h>
 #include <Foundation/Containers/IdTable.h>
 #include <Foundation/Logging/Log.h>
@@ -7,6 +9,7 @@
 #include <Foundation/Memory/Policies/AllocPolicyHeap.h>
 #include <Foundation/Strings/String.h>
 #include <Foundation/System/StackTracer.h>
+#include <Foundation/Threading/AtomicInteger.h>
 #include <Foundation/Threading/Lock.h>
 #include <Foundation/Threading/Mutex.h>
 
@@ -46,12 +49,296 @@ namespace
 
     using AllocatorTable = ezIdTable<ezAllocatorId, AllocatorData, TrackerDataAllocatorWrapper>;
     AllocatorTable m_AllocatorData;
+
+    // stack traces of sampled allocations, deduplicated and never freed so that heap profiles can refer to them by id
+    ezMutex m_StackTraceMutex;
+    ezHashTable<ezUInt64, ezUInt32, ezHashHelper<ezUInt64>, TrackerDataAllocatorWrapper> m_StackTraceIds;
+    ezDynamicArray<ezArrayPtr<void*>, TrackerDataAllocatorWrapper> m_StackTraces;
   };
 
   static TrackerData* s_pTrackerData;
   static bool s_bIsInitialized = false;
   static bool s_bIsInitializing = false;
 
+  //////////////////////////////////////////////////////////////////////////
+  // Sampled tracking
+
+  /// Counters of a single allocator that can be updated without holding the tracker lock.
+  struct AllocatorCounters
+  {
+    ezAllocatorTrackingMode m_TrackingMode;
+    ezAtomicBool m_bReportedByAllocator; ///< set once the allocator reports its stats through AddAllocatorStats()
+    ezAtomicInteger64 m_iNumAllocations;
+    ezAtomicInteger64 m_iNumDeallocations;
+    ezAtomicInteger64 m_iAllocationSize;
+    ezAtomicInteger64 m_iPerFrameAllocationSize;
+  };
+
+  constexpr ezUInt32 s_uiAllocatorCountersPerChunk = 256;
+  constexpr ezUInt32 s_uiMaxAllocatorCounterChunks = 4096;
+
+  // chunks are only added while holding the tracker lock and are never freed, so they can be read without it
+  static AllocatorCounters* s_AllocatorCounterChunks[s_uiMaxAllocatorCounterChunks];
+
+  EZ_ALWAYS_INLINE AllocatorCounters& GetAllocatorCounters(ezAllocatorId allocatorId)
+  {
+    const ezUInt32 uiIndex = allocatorId.m_InstanceIndex;
+    return s_AllocatorCounterChunks[uiIndex / s_uiAllocatorCountersPerChunk][uiIndex % s_uiAllocatorCountersPerChunk];
+  }
+
+  constexpr ezUInt32 s_uiNumSampleShards = 16;
+  constexpr ezUInt32 s_uiSampleBucketsPerShard = 256;
+  constexpr ezUInt32 s_uiSampleSlotsPerBucket = 8;
+
+  // slot keys that are not the address of a sampled allocation
+  constexpr ezInt64 s_iFreeSampleSlot = 0;
+  constexpr ezInt64 s_iReservedSampleSlot = 1;
+
+  /// One part of the lock-free table of sampled allocations.
+  ///
+  /// Every address maps to one bucket of eight slots, which are claimed and released with atomic operations. If all slots are taken
+  /// the sample is dropped. Every deallocation has to look up its address, so the number of occupied slots per bucket is kept
+  /// separately to skip the vast majority of lookups without touching the bucket.
+  struct SampleShard
+  {
+    struct Bucket
+    {
+      ezInt64 m_Keys[s_uiSampleSlotsPerBucket];
+      ezMemoryTracker::SampledAllocation m_Samples[s_uiSampleSlotsPerBucket];
+    };
+
+    ezInt32 m_BucketOccupancy[s_uiSampleBucketsPerShard];
+    Bucket m_Buckets[s_uiSampleBucketsPerShard];
+    ezInt32 m_iNumDroppedSamples;
+  };
+
+  // allocated when the first allocator with sampled tracking is registered
+  static SampleShard* s_pSampleShards = nullptr;
+
+  // read and written atomically, a plain integer is constant initialized and thus valid during static initialization
+  static ezInt64 s_iSamplingInterval = 512 * 1024;
+
+  struct SamplingState
+  {
+    ezInt64 m_iBytesUntilNextSample = 0;
+    ezUInt32 m_uiRandom = 0;
+  };
+
+  thread_local SamplingState tl_SamplingState;
+
+  /// Distances between the events of a Poisson process are exponentially distributed.
+  static ezInt64 DrawSamplingDistance(SamplingState& ref_state, ezInt64 iInterval)
+  {
+    ezUInt32 x = ref_state.m_uiRandom;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    ref_state.m_uiRandom = x;
+
+    const float fUniform = (static_cast<float>(x >> 8) + 1.0f) / 16777216.0f; // (0, 1]
+    return static_cast<ezInt64>(-ezMath::Ln(fUniform) * iInterval) + 1;
+  }
+
+  /// Returns the number of bytes a sample of this allocation stands for, or zero if the allocation is not sampled.
+  static ezUInt64 SampleAllocation(size_t uiSize)
+  {
+    const ezInt64 iInterval = ezAtomicUtils::Read(s_iSamplingInterval);
+    if (iInterval <= 1)
+      return uiSize;
+
+    SamplingState& state = tl_SamplingState;
+    if (state.m_uiRandom == 0)
+    {
+      state.m_uiRandom = static_cast<ezUInt32>((reinterpret_cast<ezUInt64>(&state) * 0x9E3779B97F4A7C15ull) >> 32) | 1u;
+      state.m_iBytesUntilNextSample = DrawSamplingDistance(state, iInterval);
+    }
+
+    state.m_iBytesUntilNextSample -= static_cast<ezInt64>(uiSize);
+    if (state.m_iBytesUntilNextSample > 0)
+      return 0;
+
+    state.m_iBytesUntilNextSample = DrawSamplingDistance(state, iInterval);
+
+    // an allocation is sampled with a probability of 1 - e^(-size / interval), weighting it with the inverse gives an unbiased estimate
+    // expm1 stays precise for allocations that are tiny compared to the interval, where 1 - e^x would cancel out in float
+    const double fProbability = -std::expm1(-static_cast<double>(uiSize) / static_cast<double>(iInterval));
+    return static_cast<ezUInt64>(static_cast<double>(uiSize) / fProbability);
+  }
+
+  EZ_ALWAYS_INLINE ezUInt32 HashSampleAddress(const void* pPtr)
+  {
+    return static_cast<ezUInt32>(((reinterpret_cast<ezUInt64>(pPtr) >> 3) * 0x9E3779B97F4A7C15ull) >> 32);
+  }
+
+  static bool InsertSample(const void* pPtr, const ezMemoryTracker::SampledAllocation& sample)
+  {
+    const ezUInt32 uiHash = HashSampleAddress(pPtr);
+    SampleShard& shard = s_pSampleShards[uiHash % s_uiNumSampleShards];
+    const ezUInt32 uiBucket = (uiHash / s_uiNumSampleShards) % s_uiSampleBucketsPerShard;
+    SampleShard::Bucket& bucket = shard.m_Buckets[uiBucket];
+
+    for (ezUInt32 i = 0; i < s_uiSampleSlotsPerBucket; ++i)
+    {
+      if (ezAtomicUtils::Read(bucket.m_Keys[i]) == s_iFreeSampleSlot && ezAtomicUtils::TestAndSet(bucket.m_Keys[i], s_iFreeSampleSlot, s_iReservedSampleSlot))
+      {
+        bucket.m_Samples[i] = sample;
+        ezAtomicUtils::Increment(shard.m_BucketOccupancy[uiBucket]);
+        ezAtomicUtils::Set(bucket.m_Keys[i], reinterpret_cast<ezInt64>(pPtr));
+        return true;
+      }
+    }
+
+    ezAtomicUtils::Increment(shard.m_iNumDroppedSamples);
+    return false;
+  }
+
+  /// Nested allocators may return the same address as their parent, so a sample only matches if it also belongs to the given allocator.
+  static bool RemoveSample(ezAllocatorId allocatorId, const void* pPtr, ezMemoryTracker::SampledAllocation& out_sample)
+  {
+    const ezUInt32 uiHash = HashSampleAddress(pPtr);
+    SampleShard& shard = s_pSampleShards[uiHash % s_uiNumSampleShards];
+    const ezUInt32 uiBucket = (uiHash / s_uiNumSampleShards) % s_uiSampleBucketsPerShard;
+
+    if (ezAtomicUtils::Read(shard.m_BucketOccupancy[uiBucket]) == 0)
+      return false;
+
+    SampleShard::Bucket& bucket = shard.m_Buckets[uiBucket];
+    const ezInt64 iKey = reinterpret_cast<ezInt64>(pPtr);
+
+    for (ezUInt32 i = 0; i < s_uiSampleSlotsPerBucket; ++i)
+    {
+      // the sample is written before its key is published, so it can be read once the key matches
+      if (ezAtomicUtils::Read(bucket.m_Keys[i]) != iKey || bucket.m_Samples[i].m_AllocatorId != allocatorId)
+        continue;
+
+      const ezMemoryTracker::SampledAllocation sample = bucket.m_Samples[i];
+
+      // another allocator may free a sample with the same address concurrently, and can't tell whether this one is its own
+      if (ezAtomicUtils::TestAndSet(bucket.m_Keys[i], iKey, s_iFreeSampleSlot))
+      {
+        out_sample = sample;
+        ezAtomicUtils::Decrement(shard.m_BucketOccupancy[uiBucket]);
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /// Calls the callback for every consistent snapshot of a live sample. If bRemove is set, the samples of the given allocator are removed.
+  template <typename Callback>
+  static void VisitSamples(ezAllocatorId allocatorId, bool bRemove, Callback callback)
+  {
+    if (s_pSampleShards == nullptr)
+      return;
+
+    for (ezUInt32 uiShard = 0; uiShard < s_uiNumSampleShards; ++uiShard)
+    {
+      SampleShard& shard = s_pSampleShards[uiShard];
+
+      for (ezUInt32 uiBucket = 0; uiBucket < s_uiSampleBucketsPerShard; ++uiBucket)
+      {
+        if (ezAtomicUtils::Read(shard.m_BucketOccupancy[uiBucket]) == 0)
+          continue;
+
+        SampleShard::Bucket& bucket = shard.m_Buckets[uiBucket];
+        for (ezUInt32 i = 0; i < s_uiSampleSlotsPerBucket; ++i)
+        {
+          const ezInt64 iKey = ezAtomicUtils::Read(bucket.m_Keys[i]);
+          if (iKey == s_iFreeSampleSlot || iKey == s_iReservedSampleSlot)
+            continue;
+
+          const ezMemoryTracker::SampledAllocation sample = bucket.m_Samples[i];
+
+          // the slot might have been reused while copying the sample
+          if (ezAtomicUtils::Read(bucket.m_Keys[i]) != iKey)
+            continue;
+
+          if (bRemove)
+          {
+            if (sample.m_AllocatorId != allocatorId || !ezAtomicUtils::TestAndSet(bucket.m_Keys[i], iKey, s_iFreeSampleSlot))
+              continue;
+
+            ezAtomicUtils::Decrement(shard.m_BucketOccupancy[uiBucket]);
+          }
+
+          callback(sample);
+        }
+      }
+    }
+  }
+
+  static ezUInt32 StoreSampledStackTrace()
+  {
+    void* pBuffer[64];
+    ezArrayPtr<void*> tempTrace(pBuffer);
+    const ezUInt32 uiNumTraces = ezStackTracer::GetStackTrace(tempTrace);
+    if (uiNumTraces == 0)
+      return 0;
+
+    const ezUInt64 uiHash = ezHashingUtils::xxHash64(pBuffer, uiNumTraces * sizeof(void*));
+
+    EZ_LOCK(s_pTrackerData->m_StackTraceMutex);
+
+    ezUInt32 uiStackTraceId = 0;
+    if (!s_pTrackerData->m_StackTraceIds.TryGetValue(uiHash, uiStackTraceId))
+    {
+      ezArrayPtr<void*> stackTrace = EZ_NEW_ARRAY(s_pTrackerDataAllocator, void*, uiNumTraces);
+      ezMemoryUtils::Copy(stackTrace.GetPtr(), pBuffer, uiNumTraces);
+
+      s_pTrackerData->m_StackTraces.PushBack(stackTrace);
+      uiStackTraceId = s_pTrackerData->m_StackTraces.GetCount();
+      s_pTrackerData->m_StackTraceIds.Insert(uiHash, uiStackTraceId);
+    }
+
+    return uiStackTraceId;
+  }
+
+  static void AddSampledAllocation(ezAllocatorId allocatorId, const void* pPtr, size_t uiSize)
+  {
+    AllocatorCounters& counters = GetAllocatorCounters(allocatorId);
+    counters.m_iNumAllocations.Increment();
+    counters.m_iPerFrameAllocationSize.Add(static_cast<ezInt64>(uiSize));
+
+    const ezUInt64 uiWeight = SampleAllocation(uiSize);
+    if (uiWeight == 0)
+      return;
+
+    ezMemoryTracker::SampledAllocation sample;
+    sample.m_AllocatorId = allocatorId;
+    sample.m_uiStackTraceId = StoreSampledStackTrace();
+    sample.m_uiSize = uiSize;
+    sample.m_uiWeight = uiWeight;
+
+    if (InsertSample(pPtr, sample))
+    {
+      counters.m_iAllocationSize.Add(static_cast<ezInt64>(uiWeight));
+    }
+  }
+
+  static void RemoveSampledAllocation(ezAllocatorId allocatorId, AllocatorCounters& ref_counters, const void* pPtr)
+  {
+    ref_counters.m_iNumDeallocations.Increment();
+
+    ezMemoryTracker::SampledAllocation sample;
+    if (RemoveSample(allocatorId, pPtr, sample))
+    {
+      ref_counters.m_iAllocationSize.Subtract(static_cast<ezInt64>(sample.m_uiWeight));
+    }
+  }
+
+  static void UpdateCountedStats(ezAllocatorId allocatorId, AllocatorData& ref_data)
+  {
+    const AllocatorCounters& counters = GetAllocatorCounters(allocatorId);
+    if (ref_data.m_TrackingMode != ezAllocatorTrackingMode::AllocationStatsSampled && !counters.m_bReportedByAllocator)
+      return;
+
+    ref_data.m_Stats.m_uiNumAllocations = static_cast<ezUInt64>(counters.m_iNumAllocations);
+    ref_data.m_Stats.m_uiNumDeallocations = static_cast<ezUInt64>(counters.m_iNumDeallocations);
+    ref_data.m_Stats.m_uiAllocationSize = static_cast<ezUInt64>(counters.m_iAllocationSize);
+    ref_data.m_Stats.m_uiPerFrameAllocationSize = static_cast<ezUInt64>(counters.m_iPerFrameAllocationSize);
+  }
+
   static void Initialize()
   {
     if (s_bIsInitialized)
@@ -148,7 +435,34 @@ ezAllocatorId ezMemoryTracker::RegisterAllocator(ezStringView sName, ezAllocator
   data.m_TrackingMode = mode;
   data.m_ParentId = parentId;
 
-  return s_pTrackerData->m_AllocatorData.Insert(data);
+  const ezAllocatorId allocatorId = s_pTrackerData->m_AllocatorData.Insert(data);
+
+  const ezUInt32 uiChunk = allocatorId.m_InstanceIndex / s_uiAllocatorCountersPerChunk;
+  EZ_ASSERT_DEV(uiChunk < s_uiMaxAllocatorCounterChunks, "Too many allocators");
+
+  if (s_AllocatorCounterChunks[uiChunk] == nullptr)
+  {
+    AllocatorCounters* pChunk = EZ_NEW_ARRAY(s_pTrackerDataAllocator, AllocatorCounters, s_uiAllocatorCountersPerChunk).GetPtr();
+    ezMemoryUtils::ZeroFill(pChunk, s_uiAllocatorCountersPerChunk);
+    s_AllocatorCounterChunks[uiChunk] = pChunk;
+  }
+
+  AllocatorCounters& counters = GetAllocatorCounters(allocatorId);
+  counters.m_TrackingMode = mode;
+  counters.m_bReportedByAllocator = false;
+  counters.m_iNumAllocations = 0;
+  counters.m_iNumDeallocations = 0;
+  counters.m_iAllocationSize = 0;
+  counters.m_iPerFrameAllocationSize = 0;
+
+  if (mode == ezAllocatorTrackingMode::AllocationStatsSampled && s_pSampleShards == nullptr)
+  {
+    SampleShard* pShards = EZ_NEW_ARRAY(s_pTrackerDataAllocator, SampleShard, s_uiNumSampleShards).GetPtr();
+    ezMemoryUtils::ZeroFill(pShards, s_uiNumSampleShards);
+    s_pSampleShards = pShards;
+  }
+
+  return allocatorId;
 }
 
 // static
@@ -156,7 +470,28 @@ void ezMemoryTracker::DeregisterAllocator(ezAllocatorId allocatorId)
 {
   EZ_LOCK(*s_pTrackerData);
 
-  const AllocatorData& data = s_pTrackerData->m_AllocatorData[allocatorId];
+  AllocatorData& data = s_pTrackerData->m_AllocatorData[allocatorId];
+
+  if (data.m_TrackingMode == ezAllocatorTrackingMode::AllocationStatsSampled)
+  {
+    UpdateCountedStats(allocatorId, data);
+
+    const ezUInt64 uiLiveAllocations = data.m_Stats.m_uiNumAllocations - data.m_Stats.m_uiNumDeallocations;
+    if (uiLiveAllocations != 0)
+    {
+      // only the sampled part of the leaked allocations is known
+      VisitSamples(allocatorId, true, [&](const SampledAllocation& sample)
+        {
+          AllocationInfo info;
+          info.m_uiSize = sample.m_uiSize;
+          info.SetStackTrace(GetSampledStackTrace(sample.m_uiStackTraceId));
+          DumpLeak(info, data.m_sName.GetData()); });
+
+      EZ_REPORT_FAILURE("Allocator '{0}' leaked {1} allocation(s)", data.m_sName.GetData(), uiLiveAllocations);
+    }
+
+    GetAllocatorCounters(allocatorId).m_TrackingMode = ezAllocatorTrackingMode::Nothing;
+  }
 
   ezUInt32 uiLiveAllocations = data.m_Allocations.GetCount();
   if (uiLiveAllocations != 0)
@@ -177,6 +512,12 @@ void ezMemoryTracker::AddAllocation(ezAllocatorId allocatorId, ezAllocatorTracki
 {
   EZ_ASSERT_DEV(uiAlign < 0xFFFF, "Alignment too big");
 
+  if (mode == ezAllocatorTrackingMode::AllocationStatsSampled)
+  {
+    AddSampledAllocation(allocatorId, pPtr, uiSize);
+    return;
+  }
+
   ezArrayPtr<void*> stackTrace;
   if (mode >= ezAllocatorTrackingMode::AllocationStatsAndStacktraces)
   {
@@ -207,6 +548,13 @@ void ezMemoryTracker::AddAllocation(ezAllocatorId allocatorId, ezAllocatorTracki
 // static
 void ezMemoryTracker::RemoveAllocation(ezAllocatorId allocatorId, const void* pPtr)
 {
+  AllocatorCounters& counters = GetAllocatorCounters(allocatorId);
+  if (counters.m_TrackingMode == ezAllocatorTrackingMode::AllocationStatsSampled)
+  {
+    RemoveSampledAllocation(allocatorId, counters, pPtr);
+    return;
+  }
+
   ezArrayPtr<void*> stackTrace;
 
   {
@@ -236,6 +584,15 @@ void ezMemoryTracker::RemoveAllAllocations(ezAllocatorId allocatorId)
 {
   EZ_LOCK(*s_pTrackerData);
   AllocatorData& data = s_pTrackerData->m_AllocatorData[allocatorId];
+
+  if (data.m_TrackingMode == ezAllocatorTrackingMode::AllocationStatsSampled)
+  {
+    AllocatorCounters& counters = GetAllocatorCounters(allocatorId);
+    VisitSamples(allocatorId, true, [&](const SampledAllocation& sample)
+      { counters.m_iAllocationSize.Subtract(static_cast<ezInt64>(sample.m_uiWeight)); });
+    counters.m_iNumDeallocations = static_cast<ezInt64>(counters.m_iNumAllocations);
+  }
+
   for (auto it = data.m_Allocations.GetIterator(); it.IsValid(); ++it)
   {
     auto& info = it.Value();
@@ -255,6 +612,21 @@ void ezMemoryTracker::SetAllocatorStats(ezAllocatorId allocatorId, const ezAlloc
   s_pTrackerData->m_AllocatorData[allocatorId].m_Stats = stats;
 }
 
+// static
+void ezMemoryTracker::AddAllocatorStats(ezAllocatorId allocatorId, ezUInt64 uiNumAllocations, ezUInt64 uiNumDeallocations, ezUInt64 uiAllocatedBytes, ezUInt64 uiDeallocatedBytes)
+{
+  AllocatorCounters& counters = GetAllocatorCounters(allocatorId);
+  if (!counters.m_bReportedByAllocator)
+  {
+    counters.m_bReportedByAllocator = true;
+  }
+
+  counters.m_iNumAllocations.Add(static_cast<ezInt64>(uiNumAllocations));
+  counters.m_iNumDeallocations.Add(static_cast<ezInt64>(uiNumDeallocations));
+  counters.m_iAllocationSize.Add(static_cast<ezInt64>(uiAllocatedBytes) - static_cast<ezInt64>(uiDeallocatedBytes));
+  counters.m_iPerFrameAllocationSize.Add(static_cast<ezInt64>(uiAllocatedBytes));
+}
+
 // static
 void ezMemoryTracker::ResetPerFrameAllocatorStats()
 {
@@ -265,6 +637,12 @@ void ezMemoryTracker::ResetPerFrameAllocatorStats()
     AllocatorData& data = it.Value();
     data.m_Stats.m_uiPerFrameAllocationSize = 0;
     data.m_Stats.m_PerFrameAllocationTime = ezTime::MakeZero();
+
+    AllocatorCounters& counters = GetAllocatorCounters(it.Id());
+    if (data.m_TrackingMode == ezAllocatorTrackingMode::AllocationStatsSampled || counters.m_bReportedByAllocator)
+    {
+      counters.m_iPerFrameAllocationSize = 0;
+    }
   }
 }
 
@@ -281,7 +659,10 @@ const ezAllocator::Stats& ezMemoryTracker::GetAllocatorStats(ezAllocatorId alloc
 {
   EZ_LOCK(*s_pTrackerData);
 
-  return s_pTrackerData->m_AllocatorData[allocatorId].m_Stats;
+  AllocatorData& data = s_pTrackerData->m_AllocatorData[allocatorId];
+  UpdateCountedStats(allocatorId, data);
+
+  return data.m_Stats;
 }
 
 // static
@@ -430,6 +811,47 @@ void ezMemoryTracker::DumpMemoryLeaks()
 // static
 ezMemoryTracker::Iterator ezMemoryTracker::GetIterator()
 {
+  {
+    EZ_LOCK(*s_pTrackerData);
+
+    for (auto it = s_pTrackerData->m_AllocatorData.GetIterator(); it.IsValid(); ++it)
+    {
+      UpdateCountedStats(it.Id(), it.Value());
+    }
+  }
+
   auto pInnerIt = EZ_NEW(s_pTrackerDataAllocator, TrackerData::AllocatorTable::Iterator, s_pTrackerData->m_AllocatorData.GetIterator());
   return Iterator(pInnerIt);
 }
+
+// static
+void ezMemoryTracker::SetSamplingInterval(ezUInt32 uiBytes)
+{
+  ezAtomicUtils::Set(s_iSamplingInterval, static_cast<ezInt64>(ezMath::Max(uiBytes, 1u)));
+}
+
+// static
+ezUInt32 ezMemoryTracker::GetSamplingInterval()
+{
+  return static_cast<ezUInt32>(ezAtomicUtils::Read(s_iSamplingInterval));
+}
+
+// static
+void ezMemoryTracker::EnumerateSampledAllocations(ezDelegate<void(const SampledAllocation&)> callback)
+{
+  VisitSamples(ezAllocatorId(), false, callback);
+}
+
+// static
+ezArrayPtr<void*> ezMemoryTracker::GetSampledStackTrace(ezUInt32 uiStackTraceId)
+{
+  if (s_pTrackerData == nullptr)
+    return {};
+
+  EZ_LOCK(s_pTrackerData->m_StackTraceMutex);
+
+  if (uiStackTraceId == 0 || uiStackTraceId > s_pTrackerData->m_StackTraces.GetCount())
+    return {};
+
+  return s_pTrackerData->m_StackTraces[uiStackTraceId - 1];
+}
@@ -0,0 +1,31 @@
+
+inline ezThreadCachingAllocator::ezThreadCachingAllocator(ezStringView sName, ezAllocator* pParent /* = nullptr */)
+  : ezAllocatorWithPolicy<ezAllocPolicyThreadCaching, ezAllocatorTrackingMode::Basics>(sName, pParent)
+{
+  this->m_allocator.SetAllocatorId(this->m_Id);
+}
+
+inline ezThreadCachingAllocator::~ezThreadCachingAllocator()
+{
+  const Stats stats = GetStats();
+  if (stats.m_uiNumAllocations != stats.m_uiNumDeallocations)
+  {
+    EZ_REPORT_FAILURE("Allocator '{0}' leaked {1} allocation(s)", ezMemoryTracker::GetAllocatorName(this->m_Id),
+      stats.m_uiNumAllocations - stats.m_uiNumDeallocations);
+  }
+}
+
+inline size_t ezThreadCachingAllocator::AllocatedSize(const void* pPtr)
+{
+  return this->m_allocator.GetAllocatedSize(pPtr);
+}
+
+inline ezAllocator::Stats ezThreadCachingAllocator::GetStats() const
+{
+  ezAllocator::Stats stats;
+  this->m_allocator.GetStats(stats);
+
+  // the per-frame values are only known to the tracker, as it resets them
+  stats.m_uiPerFrameAllocationSize = ezMemoryTracker::GetAllocatorStats(this->m_Id).m_uiPerFrameAllocationSize;
+  return stats;
+}
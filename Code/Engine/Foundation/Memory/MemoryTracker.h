@@ -3,11 +3,19 @@
 #include <Foundation/Basics.h>
 #include <Foundation/Time/Time.h>
 #include <Foundation/Types/Bitflags.h>
-
+#include <Foundation/Types/Delegate.h>
+
+/// \brief How much an allocator reports to the ezMemoryTracker.
+///
+/// AllocationStatsSampled is cheap enough for production, as it avoids the per-allocation table, and with it the tracker lock, of the
+/// full AllocationStats modes. The numbers of allocations and deallocations and the bytes allocated per frame are still exact. The live
+/// allocation size, however, is only estimated from the sampled allocations, because deallocations don't pass their size and looking it
+/// up would require that table.
 enum class ezAllocatorTrackingMode : ezUInt32
 {
   Nothing,                       ///< The allocator doesn't track anything. Use this for best performance.
   Basics,                        ///< The allocator will be known to the system, so it can show up in debugging tools, but barely anything more.
+  AllocationStatsSampled,        ///< Counts allocations without a lock and records a random sample of them, see ezHeapProfile.
   AllocationStats,               ///< The allocator keeps track of how many allocations and deallocations it did and how large its memory usage is.
   AllocationStatsIgnoreLeaks,    ///< Same as AllocationStats, but any remaining allocations at shutdown are not reported as leaks.
   AllocationStatsAndStacktraces, ///< The allocator will record stack traces for each allocation, which can be used to find memory leaks.
@@ -44,6 +52,17 @@ public:
     }
   };
 
+  /// \brief Information about an allocation that was recorded by an allocator with ezAllocatorTrackingMode::AllocationStatsSampled.
+  struct SampledAllocation
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    ezAllocatorId m_AllocatorId;
+    ezUInt32 m_uiStackTraceId = 0; ///< See GetSampledStackTrace(), 0 if no stack trace could be recorded.
+    ezUInt64 m_uiSize = 0;
+    ezUInt64 m_uiWeight = 0; ///< The number of bytes this sample stands for.
+  };
+
   class EZ_FOUNDATION_DLL Iterator
   {
   public:
@@ -78,6 +97,11 @@ public:
   static void RemoveAllAllocations(ezAllocatorId allocatorId);
   static void SetAllocatorStats(ezAllocatorId allocatorId, const ezAllocator::Stats& stats);
 
+  /// \brief Adds to the stats of an allocator that counts its allocations itself, without taking the tracker lock.
+  ///
+  /// Once an allocator reports through this function, its stats are only made up of the reported numbers.
+  static void AddAllocatorStats(ezAllocatorId allocatorId, ezUInt64 uiNumAllocations, ezUInt64 uiNumDeallocations, ezUInt64 uiAllocatedBytes, ezUInt64 uiDeallocatedBytes);
+
   static void ResetPerFrameAllocatorStats();
 
   static ezStringView GetAllocatorName(ezAllocatorId allocatorId);
@@ -87,6 +111,21 @@ public:
 
   static Iterator GetIterator();
 
+  /// \brief Sets the mean distance in bytes between two sampled allocations of allocators with ezAllocatorTrackingMode::AllocationStatsSampled.
+  ///
+  /// The sampling is a Poisson process over the allocated bytes, so large allocations are more likely to be sampled than small ones.
+  /// An interval of 1 records every allocation.
+  static void SetSamplingInterval(ezUInt32 uiBytes);
+  static ezUInt32 GetSamplingInterval();
+
+  /// \brief Calls the given function for all sampled allocations that are currently alive.
+  ///
+  /// Allocations may be made and freed concurrently, so the result is only a snapshot.
+  static void EnumerateSampledAllocations(ezDelegate<void(const SampledAllocation&)> callback);
+
+  /// \brief Returns the stack trace with the given id. Stack traces of sampled allocations are kept until shutdown.
+  static ezArrayPtr<void*> GetSampledStackTrace(ezUInt32 uiStackTraceId);
+
   /// \brief Callback for printing strings.
   using PrintFunc = void (*)(const char* szLine);
 
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Foundation/Basics.h>
+
+/// \brief Allocation policy that serves small allocations from per-thread caches.
+///
+/// Allocations of up to MaxSmallSize bytes are rounded up to one of a few size classes and carved from 64 KB slabs. Every thread owns
+/// a cache of free blocks per size class, so allocating and freeing small blocks does not need any lock in the common case. Blocks
+/// move between the thread caches and a central pool in batches, which only takes the pool lock once per batch.
+/// Larger allocations and allocations that need more than MaxSmallAlignment are forwarded to the aligned heap.
+///
+/// Slabs are never returned to the system before the policy is destroyed, free blocks are only recycled.
+///
+/// Every thread cache counts its own allocations and, once an allocator id is set, adds them to the memory tracker every few dozen
+/// operations, so the tracker never has to be locked on the allocation path.
+///
+/// \see ezAllocatorWithPolicy, ezThreadCachingAllocator
+class EZ_FOUNDATION_DLL ezAllocPolicyThreadCaching
+{
+public:
+  static constexpr size_t MaxSmallSize = 2048;
+  static constexpr size_t MaxSmallAlignment = 16;
+
+  ezAllocPolicyThreadCaching(ezAllocator* pParent);
+  ~ezAllocPolicyThreadCaching();
+
+  void* Allocate(size_t uiSize, size_t uiAlign);
+  void Deallocate(void* pPtr);
+
+  /// \brief Returns the usable size of the given allocation, which for small allocations is the size of its size class.
+  size_t GetAllocatedSize(const void* pPtr) const;
+
+  /// \brief Sets the allocator whose stats in the memory tracker are updated by the thread caches. Must be called before the first allocation.
+  void SetAllocatorId(ezAllocatorId allocatorId);
+
+  /// \brief Sums up the exact statistics of all thread caches, the per-frame allocation size is not filled out.
+  void GetStats(ezAllocator::Stats& out_stats) const;
+
+  EZ_ALWAYS_INLINE ezAllocator* GetParent() const { return nullptr; }
+
+  struct ThreadCache;
+  struct Pool;
+
+private:
+  ThreadCache* GetThreadCache();
+
+  Pool* m_pPool = nullptr;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Foundation/Memory/AllocatorWithPolicy.h>
+#include <Foundation/Memory/Policies/AllocPolicyThreadCaching.h>
+
+/// \brief Allocator for many small allocations from many threads, see ezAllocPolicyThreadCaching.
+///
+/// Instead of calling into the memory tracker, and thus taking its lock, for every allocation, statistics are counted per thread and
+/// added to the tracker without a lock every few dozen operations, so the tracker may lag slightly behind. GetStats() returns the exact
+/// numbers. Individual allocations are not tracked, so leaks are detected by comparing the number of allocations and deallocations when
+/// the allocator is destroyed.
+class ezThreadCachingAllocator : public ezAllocatorWithPolicy<ezAllocPolicyThreadCaching, ezAllocatorTrackingMode::Basics>
+{
+public:
+  ezThreadCachingAllocator(ezStringView sName, ezAllocator* pParent = nullptr);
+  ~ezThreadCachingAllocator();
+
+  virtual size_t AllocatedSize(const void* pPtr) override;
+  virtual Stats GetStats() const override;
+};
+
+#include <Foundation/Memory/Implementation/ThreadCachingAllocator_inl.h>
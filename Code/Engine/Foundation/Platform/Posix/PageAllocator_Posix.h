@@ -16,7 +16,7 @@ void* ezPageAllocator::AllocatePage(size_t uiSize)
 
   EZ_CHECK_ALIGNMENT(ptr, uiAlign);
 
-  if constexpr (ezAllocatorTrackingMode::Default >= ezAllocatorTrackingMode::AllocationStats)
+  if constexpr (ezAllocatorTrackingMode::Default >= ezAllocatorTrackingMode::AllocationStatsSampled)
   {
     ezMemoryTracker::AddAllocation(ezPageAllocator::GetId(), ezAllocatorTrackingMode::Default, ptr, uiSize, uiAlign, ezTime::Now() - fAllocationTime);
   }
@@ -27,7 +27,7 @@ void* ezPageAllocator::AllocatePage(size_t uiSize)
 // static
 void ezPageAllocator::DeallocatePage(void* ptr)
 {
-  if constexpr (ezAllocatorTrackingMode::Default >= ezAllocatorTrackingMode::AllocationStats)
+  if constexpr (ezAllocatorTrackingMode::Default >= ezAllocatorTrackingMode::AllocationStatsSampled)
   {
     ezMemoryTracker::RemoveAllocation(ezPageAllocator::GetId(), ptr);
   }
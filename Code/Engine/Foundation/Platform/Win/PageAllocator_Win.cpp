@@ -19,7 +19,7 @@ void* ezPageAllocator::AllocatePage(size_t uiSize)
   size_t uiAlign = ezSystemInformation::Get().GetMemoryPageSize();
   EZ_CHECK_ALIGNMENT(ptr, uiAlign);
 
-  if constexpr (ezAllocatorTrackingMode::Default >= ezAllocatorTrackingMode::AllocationStats)
+  if constexpr (ezAllocatorTrackingMode::Default >= ezAllocatorTrackingMode::AllocationStatsSampled)
   {
     ezMemoryTracker::AddAllocation(ezPageAllocator::GetId(), ezAllocatorTrackingMode::Default, ptr, uiSize, uiAlign, ezTime::Now() - fAllocationTime);
   }
@@ -30,7 +30,7 @@ void* ezPageAllocator::AllocatePage(size_t uiSize)
 // static
 void ezPageAllocator::DeallocatePage(void* pPtr)
 {
-  if constexpr (ezAllocatorTrackingMode::Default >= ezAllocatorTrackingMode::AllocationStats)
+  if constexpr (ezAllocatorTrackingMode::Default >= ezAllocatorTrackingMode::AllocationStatsSampled)
   {
     ezMemoryTracker::RemoveAllocation(ezPageAllocator::GetId(), pPtr);
   }
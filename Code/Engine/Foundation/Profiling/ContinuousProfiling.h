@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Foundation/Profiling/Profiling.h>
+#include <Foundation/Strings/String.h>
+
+/// \brief Continuously writes all profiling data to disk, so that rare events like hitches can still be inspected after they happened.
+///
+/// ezProfilingSystem::Capture() only returns what still fits into the in-memory buffers. Instead, a background thread regularly collects
+/// the CPU and GPU scopes, frames and fast scopes (see ezFastProfilingSystem) that were recorded since its last flush and appends them to
+/// a (zstd compressed) segment file. Every Settings::m_SegmentDuration a new segment file is started and segments that are older than
+/// Settings::m_RetentionDuration are deleted, so the disk usage stays bounded while the most recent minutes are always available.
+///
+/// ExportTimeRange() and RequestExport() convert the data of a time range back into the regular JSON format of
+/// ezProfilingSystem::ProfilingData::Write(). With SetExportOnScopeTimeout() this happens automatically whenever a profiling scope exceeds
+/// its timeout (see EZ_PROFILE_SCOPE_WITH_TIMEOUT).
+class EZ_FOUNDATION_DLL ezContinuousProfiling
+{
+public:
+  struct Settings
+  {
+    /// The folder in which the segment files are written. Segment files from a previous run may get overwritten.
+    ezString m_sOutputFolder;
+
+    /// How much data is kept on disk.
+    ezTime m_RetentionDuration = ezTime::MakeFromMinutes(5);
+
+    /// How much data is written to each segment file. Whole segments are deleted once they are older than the retention duration.
+    ezTime m_SegmentDuration = ezTime::MakeFromSeconds(10);
+
+    /// How often the background thread collects new data. This needs to be short enough that the ezProfilingSystem's ring buffers don't overflow in between.
+    ezTime m_FlushInterval = ezTime::MakeFromMilliseconds(250);
+  };
+
+  /// \brief Starts the background thread. Fails if it is already running. The segment files of a previous run are deleted.
+  static ezResult Start(const Settings& settings); // [tested]
+
+  /// \brief Writes all remaining data and stops the background thread. The segment files are kept.
+  static void Stop(); // [tested]
+
+  static bool IsRunning(); // [tested]
+
+  /// \brief Immediately writes all data that was recorded so far, instead of waiting for the background thread.
+  static void Flush(); // [tested]
+
+  /// \brief Returns the number of segment files that are currently on disk.
+  static ezUInt32 GetNumSegments(); // [tested]
+
+  /// \brief Writes all data of the given time range, which is still on disk, as JSON to the given file. Time values are in the time base of ezTime::Now().
+  static ezResult ExportTimeRange(ezStringView sOutputFile, ezTime startTime, ezTime endTime); // [tested]
+
+  /// \brief Exports the time from \a timeBefore before now until \a timeAfter after now. The export is done by the background thread, once that time has passed.
+  ///
+  /// Only one export can be pending at a time, further requests are ignored until it is done. Requests are also ignored while not running.
+  /// This function is lock-free, so it can be called at any time from any thread, e.g. when a hitch is detected.
+  static void RequestExport(ezStringView sOutputFile, ezTime timeBefore, ezTime timeAfter = ezTime::MakeZero()); // [tested]
+
+  /// \brief Installs a scope timeout callback (see ezProfilingSystem::SetScopeTimeoutCallback()) that calls RequestExport() whenever a scope
+  /// takes longer than its timeout. The files are written to the given folder and named after the frame in which the timeout happened.
+  static void SetExportOnScopeTimeout(ezStringView sOutputFolder, ezTime timeBefore, ezTime timeAfter); // [tested]
+
+  /// \brief Removes the scope timeout callback again.
+  static void DisableExportOnScopeTimeout(); // [tested]
+};
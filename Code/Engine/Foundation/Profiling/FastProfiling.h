@@ -0,0 +1,159 @@
+#pragma once
+
+#include <Foundation/Profiling/Profiling.h>
+
+class ezStreamReader;
+class ezStreamWriter;
+
+/// \brief A low-overhead alternative to the regular CPU scopes of the ezProfilingSystem, for profiling fine-grained hot paths.
+///
+/// Regular profiling scopes copy their name into the event buffer and are discarded when they are shorter than the discard threshold.
+/// Fast scopes instead refer to a name that is registered once per call site (see EZ_PROFILE_SCOPE_FAST), and only record the name ID
+/// and two raw CPU timestamps into a lock-free ring buffer of the calling thread. Nothing is discarded, once a buffer is full the oldest
+/// events are overwritten.
+///
+/// The timestamps are only converted to ezTime when the data is read, using a conversion factor that is calibrated against ezTime::Now().
+///
+/// Fast scopes are included in ezProfilingSystem::Capture(), so they show up in the regular JSON output.
+/// Additionally, ezFastProfilingStream can be used to write all recorded events to a stream in a compact binary format,
+/// which can be converted to ezProfilingSystem::ProfilingData with ConvertBinaryDump().
+class EZ_FOUNDATION_DLL ezFastProfilingSystem
+{
+public:
+  /// \brief The size of the ring buffer of each thread. Since the owning thread may be writing to one slot at any time, only the most recent
+  /// EventsPerThread - 1 events can be read.
+  static constexpr ezUInt32 EventsPerThread = 1 << 16;
+
+  /// \brief A single recorded scope.
+  struct Event
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    ezUInt64 m_uiBeginTicks;
+    ezUInt64 m_uiEndTicks;
+    ezUInt32 m_uiNameId;
+    ezUInt32 m_uiReserved;
+  };
+
+  /// \brief Enables or disables recording of fast scopes. Enabled by default.
+  static void SetEnabled(bool bEnabled); // [tested]
+
+  static bool IsEnabled(); // [tested]
+
+  /// \brief Returns the ID for the given scope and function name. Registering the same names again returns the same ID.
+  ///
+  /// This takes a lock, so it should be called once per call site and not for every recorded scope.
+  static ezUInt32 RegisterScopeName(ezStringView sName, const char* szFunctionName); // [tested]
+
+  /// \brief Returns the name with which the given ID was registered.
+  static ezStringView GetScopeName(ezUInt32 uiNameId); // [tested]
+
+  /// \brief Returns the current timestamp in ticks. On x86 this is the CPU's time stamp counter.
+  static ezUInt64 GetTimestamp(); // [tested]
+
+  /// \brief Converts a timestamp returned by GetTimestamp() to the time base of ezTime::Now().
+  static ezTime TicksToTime(ezUInt64 uiTicks); // [tested]
+
+  /// \brief Returns how many ticks of GetTimestamp() correspond to one second.
+  static double GetTicksPerSecond(); // [tested]
+
+  /// \brief Records a scope for the calling thread. This is lock-free and doesn't allocate, except for the very first event of each thread.
+  ///
+  /// The ring buffer of a thread that exited is handed to the next new thread, or released by Clear().
+  static void AddScope(ezUInt32 uiNameId, ezUInt64 uiBeginTicks, ezUInt64 uiEndTicks); // [tested]
+
+  /// \brief Discards all recorded events. Called by ezProfilingSystem::Clear().
+  static void Clear(); // [tested]
+
+  /// \brief Appends all recorded events to the CPU scopes of the given profiling data. Called by ezProfilingSystem::Capture().
+  ///
+  /// Scope names longer than ezProfilingSystem::CPUScope::NAME_SIZE are truncated.
+  static void Capture(ezProfilingSystem::ProfilingData& ref_profilingData); // [tested]
+
+  /// \brief Reads a binary dump that was written with ezFastProfilingStream and converts it to the regular profiling data.
+  ///
+  /// The result can be written as JSON with ezProfilingSystem::ProfilingData::Write().
+  static ezResult ConvertBinaryDump(ezStreamReader& ref_stream, ezProfilingSystem::ProfilingData& out_profilingData); // [tested]
+
+private:
+  EZ_MAKE_SUBSYSTEM_STARTUP_FRIEND(Foundation, ProfilingSystem);
+  friend class ezProfilingSystem;
+  friend class ezFastProfilingStream;
+
+  static void Initialize();
+  static void Shutdown();
+  static void StartNewFrame(ezUInt64 uiFrameCount);
+
+  /// \brief Called by ezProfilingSystem::RemoveThread() before the current thread exits, so that its ring buffer can be reclaimed.
+  static void RemoveThread();
+};
+
+/// \brief Writes the events recorded by the ezFastProfilingSystem to a stream.
+///
+/// Each call to WriteNewEvents() only writes what has been recorded since the previous call, so the output can be streamed to a file
+/// while the application is running. Events that were overwritten in the ring buffers before they could be written are counted as lost.
+/// The data is written in native byte order and is meant to be converted with ezFastProfilingSystem::ConvertBinaryDump().
+class EZ_FOUNDATION_DLL ezFastProfilingStream
+{
+public:
+  ezFastProfilingStream();
+  ~ezFastProfilingStream();
+
+  /// \brief Writes all events, scope names, thread names and frames that were not written by a previous call.
+  ezResult WriteNewEvents(ezStreamWriter& ref_stream); // [tested]
+
+  /// \brief Starts a new stream. The next call to WriteNewEvents() writes everything that is still in the ring buffers.
+  void Reset(); // [tested]
+
+  /// \brief The next call to WriteNewEvents() writes the header and all scope names again, but only events that were not written before.
+  ///
+  /// Use this when the output is split into several files that each have to be readable on their own.
+  void StartNewSegment(); // [tested]
+
+  /// \brief Returns how many events were overwritten before they could be written.
+  ezUInt64 GetNumLostEvents() const { return m_uiNumLostEvents; } // [tested]
+
+private:
+  bool m_bHeaderWritten = false;
+  ezUInt32 m_uiNumNamesWritten = 0;
+  ezUInt64 m_uiNextFrame = 0;
+  ezUInt64 m_uiNumLostEvents = 0;
+
+  // the index of the next event to write, per thread buffer
+  ezDynamicArray<ezUInt64> m_ReadPositions;
+};
+
+/// \brief Scope for the ezFastProfilingSystem. You shouldn't need to use this directly, use EZ_PROFILE_SCOPE_FAST instead.
+class ezFastProfilingScope
+{
+public:
+  EZ_ALWAYS_INLINE explicit ezFastProfilingScope(ezUInt32 uiNameId)
+    : m_uiNameId(uiNameId)
+    , m_uiBeginTicks(ezFastProfilingSystem::GetTimestamp())
+  {
+  }
+
+  EZ_ALWAYS_INLINE ~ezFastProfilingScope() { ezFastProfilingSystem::AddScope(m_uiNameId, m_uiBeginTicks, ezFastProfilingSystem::GetTimestamp()); }
+
+private:
+  ezUInt32 m_uiNameId;
+  ezUInt64 m_uiBeginTicks;
+};
+
+#if EZ_ENABLED(EZ_USE_PROFILING) || defined(EZ_DOCS)
+
+/// \brief Profiles the current scope using the ezFastProfilingSystem.
+///
+/// The name is only registered the first time the scope is executed, so it has to be the same every time (typically a string literal).
+/// Use this instead of EZ_PROFILE_SCOPE for scopes that are executed very often and are very short.
+///
+/// \sa ezFastProfilingSystem
+#  define EZ_PROFILE_SCOPE_FAST(szScopeName)                                                                                                       \
+    static const ezUInt32 EZ_CONCAT(_ezFastProfilingName, EZ_SOURCE_LINE) = ezFastProfilingSystem::RegisterScopeName(szScopeName, EZ_SOURCE_FUNCTION); \
+    ezFastProfilingScope EZ_CONCAT(_ezFastProfilingScope, EZ_SOURCE_LINE)(EZ_CONCAT(_ezFastProfilingName, EZ_SOURCE_LINE))
+
+#else
+
+#  define EZ_PROFILE_SCOPE_FAST(szScopeName) /*empty*/
+
+#endif
@@ -0,0 +1,824 @@
+#include <Foundation/FoundationPCH.h>
+
+#include <Foundation/Containers/Deque.h>
+#include <Foundation/IO/CompressedStreamZstd.h>
+#include <Foundation/IO/FileSystem/FileReader.h>
+#include <Foundation/IO/FileSystem/FileSystem.h>
+#include <Foundation/IO/FileSystem/FileWriter.h>
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Profiling/ContinuousProfiling.h>
+#include <Foundation/Profiling/FastProfiling.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Threading/ThreadSignal.h>
+
+#include <atomic>
+
+#if EZ_ENABLED(EZ_USE_PROFILING)
+
+namespace
+{
+  constexpr ezUInt32 s_uiSegmentMagic = 0x4350455A; // 'EZPC'
+  constexpr ezUInt8 s_uiSegmentVersion = 1;
+  constexpr ezUInt32 s_uiNoString = 0xFFFFFFFF;
+
+  struct BlockType
+  {
+    enum Enum : ezUInt8
+    {
+      Threads,
+      Frames,
+      CPUScopes,
+      GPUScopes,
+      FastScopes,
+    };
+  };
+
+  struct Segment
+  {
+    ezString m_sFile;
+    ezTime m_StartTime;
+    ezTime m_EndTime;
+  };
+
+  class ezContinuousProfilingThread : public ezThread
+  {
+  public:
+    ezContinuousProfilingThread()
+      : ezThread("Continuous Profiling")
+    {
+    }
+
+    std::atomic<bool> m_bStop = false;
+    ezThreadSignal m_Signal;
+    ezTime m_FlushInterval;
+
+  private:
+    virtual ezUInt32 Run() override;
+  };
+
+  /// Everything that is only needed while the background thread is running.
+  struct RecordingState
+  {
+    ezContinuousProfiling::Settings m_Settings;
+    ezContinuousProfilingThread m_Thread;
+
+    ezProfilingSystem::CaptureCursor m_Cursor;
+    ezFastProfilingStream m_FastStream;
+    ezUInt32 m_uiNextSegmentIndex = 0;
+
+    // the segment that is currently written
+    bool m_bSegmentOpen = false;
+    ezFileWriter m_SegmentFile;
+#  ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+    ezCompressedStreamWriterZstd m_Compressor;
+#  endif
+    ezStreamWriter* m_pSegmentStream = nullptr;
+
+    // strings are written once per segment and then referenced by index
+    ezHashTable<ezString, ezUInt32> m_SegmentStrings;
+  };
+
+  struct ExportState
+  {
+    enum Enum : ezUInt32
+    {
+      Idle,
+      Preparing,
+      Pending,
+      Exporting,
+    };
+  };
+
+  static ezMutex s_Mutex;
+  static RecordingState* s_pState = nullptr;
+  static std::atomic<bool> s_bRunning = false;
+  static ezDeque<Segment> s_Segments;
+
+  // RequestExport() must not block, so the pending export is stored without any allocations
+  static std::atomic<ezUInt32> s_ExportState = ExportState::Idle;
+  static char s_szExportFile[256];
+  static ezTime s_ExportTime;
+  static ezTime s_ExportTimeBefore;
+  static ezTime s_ExportTimeAfter;
+
+  static ezString s_sTimeoutExportFolder;
+  static ezTime s_TimeoutExportBefore;
+  static ezTime s_TimeoutExportAfter;
+
+  void WriteStringRef(RecordingState& ref_state, ezStreamWriter& inout_stream, ezStringView sString)
+  {
+    ezUInt32 uiIndex = 0;
+    if (ref_state.m_SegmentStrings.TryGetValue(sString, uiIndex))
+    {
+      inout_stream << uiIndex;
+      return;
+    }
+
+    // an index that is not known yet means that the string follows
+    uiIndex = ref_state.m_SegmentStrings.GetCount();
+    ref_state.m_SegmentStrings.Insert(sString, uiIndex);
+
+    inout_stream << uiIndex;
+    inout_stream.WriteString(sString).IgnoreResult();
+  }
+
+  ezResult ReadStringRef(ezStreamReader& inout_stream, ezDeque<ezString>& ref_strings, const char*& out_szString)
+  {
+    ezUInt32 uiIndex = 0;
+    inout_stream >> uiIndex;
+
+    if (uiIndex == s_uiNoString)
+    {
+      out_szString = nullptr;
+      return EZ_SUCCESS;
+    }
+
+    if (uiIndex == ref_strings.GetCount())
+    {
+      EZ_SUCCEED_OR_RETURN(inout_stream.ReadString(ref_strings.ExpandAndGetRef()));
+    }
+
+    if (uiIndex >= ref_strings.GetCount())
+      return EZ_FAILURE;
+
+    // the deque never relocates its elements, so the pointer stays valid as long as the deque exists
+    out_szString = ref_strings[uiIndex].GetData();
+    return EZ_SUCCESS;
+  }
+
+  void CloseSegment(RecordingState& ref_state)
+  {
+    if (!ref_state.m_bSegmentOpen)
+      return;
+
+#  ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+    ref_state.m_Compressor.FinishCompressedStream().IgnoreResult();
+#  endif
+    ref_state.m_SegmentFile.Close();
+    ref_state.m_pSegmentStream = nullptr;
+    ref_state.m_bSegmentOpen = false;
+  }
+
+  ezResult OpenSegment(RecordingState& ref_state)
+  {
+    ezStringBuilder sFile;
+    sFile.SetFormat("{}/Segment-{}.ezProfilingSegment", ref_state.m_Settings.m_sOutputFolder, ezArgU(ref_state.m_uiNextSegmentIndex, 6, true));
+
+    if (ref_state.m_SegmentFile.Open(sFile).Failed())
+    {
+      ezLog::Error("Could not open profiling segment file '{}'.", sFile);
+      return EZ_FAILURE;
+    }
+
+    ++ref_state.m_uiNextSegmentIndex;
+
+#  ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+    ref_state.m_Compressor.SetOutputStream(&ref_state.m_SegmentFile, 0);
+    ref_state.m_pSegmentStream = &ref_state.m_Compressor;
+#  else
+    ref_state.m_pSegmentStream = &ref_state.m_SegmentFile;
+#  endif
+
+    ref_state.m_bSegmentOpen = true;
+    ref_state.m_SegmentStrings.Clear();
+    ref_state.m_FastStream.StartNewSegment();
+
+    *ref_state.m_pSegmentStream << s_uiSegmentMagic;
+    *ref_state.m_pSegmentStream << s_uiSegmentVersion;
+
+    Segment& segment = s_Segments.ExpandAndGetRef();
+    segment.m_sFile = sFile;
+    segment.m_StartTime = ezTime::Now();
+    segment.m_EndTime = segment.m_StartTime;
+
+    return EZ_SUCCESS;
+  }
+
+  void FlushNewData(RecordingState& ref_state)
+  {
+    if (!ref_state.m_bSegmentOpen && OpenSegment(ref_state).Failed())
+      return;
+
+    ezStreamWriter& stream = *ref_state.m_pSegmentStream;
+
+    ezProfilingSystem::ProfilingData data;
+    ezProfilingSystem::CaptureNewData(data, ref_state.m_Cursor);
+
+    stream << static_cast<ezUInt8>(BlockType::Threads);
+    stream << data.m_ThreadInfos.GetCount();
+    for (const auto& info : data.m_ThreadInfos)
+    {
+      stream << info.m_uiThreadId;
+      WriteStringRef(ref_state, stream, info.m_sName);
+    }
+
+    if (!data.m_FrameStartTimes.IsEmpty())
+    {
+      stream << static_cast<ezUInt8>(BlockType::Frames);
+      stream << data.m_uiFrameCount;
+      stream << data.m_FrameStartTimes.GetCount();
+      for (ezTime t : data.m_FrameStartTimes)
+      {
+        stream << t.GetSeconds();
+      }
+    }
+
+    for (const auto& eventBuffer : data.m_AllEventBuffers)
+    {
+      stream << static_cast<ezUInt8>(BlockType::CPUScopes);
+      stream << eventBuffer.m_uiThreadId;
+      stream << eventBuffer.m_Data.GetCount();
+
+      for (const auto& scope : eventBuffer.m_Data)
+      {
+        stream << scope.m_BeginTime.GetSeconds();
+        stream << scope.m_EndTime.GetSeconds();
+        WriteStringRef(ref_state, stream, scope.m_szName);
+
+        if (scope.m_szFunctionName != nullptr)
+        {
+          WriteStringRef(ref_state, stream, scope.m_szFunctionName);
+        }
+        else
+        {
+          stream << s_uiNoString;
+        }
+      }
+    }
+
+    for (ezUInt32 uiGpuIndex = 0; uiGpuIndex < data.m_GPUScopes.GetCount(); ++uiGpuIndex)
+    {
+      if (data.m_GPUScopes[uiGpuIndex].IsEmpty())
+        continue;
+
+      stream << static_cast<ezUInt8>(BlockType::GPUScopes);
+      stream << uiGpuIndex;
+      stream << data.m_GPUScopes[uiGpuIndex].GetCount();
+
+      for (const auto& scope : data.m_GPUScopes[uiGpuIndex])
+      {
+        stream << scope.m_BeginTime.GetSeconds();
+        stream << scope.m_EndTime.GetSeconds();
+        WriteStringRef(ref_state, stream, scope.m_szName);
+      }
+    }
+
+    // the fast scopes are stored in their own format, the blocks of one segment together form a complete ezFastProfilingStream
+    {
+      ezDefaultMemoryStreamStorage fastStorage;
+      ezMemoryStreamWriter fastWriter(&fastStorage);
+      ref_state.m_FastStream.WriteNewEvents(fastWriter).IgnoreResult();
+
+      stream << static_cast<ezUInt8>(BlockType::FastScopes);
+      stream << fastStorage.GetStorageSize32();
+      fastStorage.CopyToStream(stream).IgnoreResult();
+    }
+
+    stream.Flush().IgnoreResult();
+    ref_state.m_SegmentFile.Flush().IgnoreResult();
+
+    s_Segments.PeekBack().m_EndTime = ezTime::Now();
+  }
+
+  void AppendEvents(ezProfilingSystem::ProfilingData& ref_target, const ezProfilingSystem::CPUScopesBufferFlat& source)
+  {
+    for (auto& eventBuffer : ref_target.m_AllEventBuffers)
+    {
+      if (eventBuffer.m_uiThreadId == source.m_uiThreadId)
+      {
+        eventBuffer.m_Data.PushBackRange(source.m_Data);
+        return;
+      }
+    }
+
+    ref_target.m_AllEventBuffers.PushBack(source);
+  }
+
+  void AppendThreadInfo(ezProfilingSystem::ProfilingData& ref_target, ezUInt64 uiThreadId, ezStringView sName)
+  {
+    for (const auto& info : ref_target.m_ThreadInfos)
+    {
+      if (info.m_uiThreadId == uiThreadId)
+        return;
+    }
+
+    auto& info = ref_target.m_ThreadInfos.ExpandAndGetRef();
+    info.m_uiThreadId = uiThreadId;
+    info.m_sName = sName;
+  }
+
+  ezResult ReadSegment(ezStringView sFile, ezProfilingSystem::ProfilingData& ref_data, ezDeque<ezString>& ref_strings)
+  {
+    ezFileReader file;
+    EZ_SUCCEED_OR_RETURN(file.Open(sFile));
+
+#  ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+    ezCompressedStreamReaderZstd decompressor(&file);
+    ezStreamReader& stream = decompressor;
+#  else
+    ezStreamReader& stream = file;
+#  endif
+
+    ezUInt32 uiMagic = 0;
+    ezUInt8 uiVersion = 0;
+    stream >> uiMagic;
+    stream >> uiVersion;
+
+    if (uiMagic != s_uiSegmentMagic || uiVersion != s_uiSegmentVersion)
+      return EZ_FAILURE;
+
+    // strings are only valid within one segment
+    ezDeque<ezString> segmentStrings;
+    ezDefaultMemoryStreamStorage fastStorage;
+    ezMemoryStreamWriter fastWriter(&fastStorage);
+    ezDynamicArray<ezUInt8> fastBlock;
+
+    const char* szName = nullptr;
+    const char* szFunction = nullptr;
+
+    // a segment that is still being written (or was not closed properly) simply ends at the last complete block
+    while (true)
+    {
+      ezUInt8 uiBlockType = 0;
+      if (stream.ReadBytes(&uiBlockType, sizeof(ezUInt8)) != sizeof(ezUInt8))
+        break;
+
+      switch (uiBlockType)
+      {
+        case BlockType::Threads:
+        {
+          ezUInt32 uiCount = 0;
+          stream >> uiCount;
+
+          for (ezUInt32 i = 0; i < uiCount; ++i)
+          {
+            ezUInt64 uiThreadId = 0;
+            stream >> uiThreadId;
+            EZ_SUCCEED_OR_RETURN(ReadStringRef(stream, segmentStrings, szName));
+
+            AppendThreadInfo(ref_data, uiThreadId, szName);
+          }
+          break;
+        }
+
+        case BlockType::Frames:
+        {
+          ezUInt32 uiCount = 0;
+          stream >> ref_data.m_uiFrameCount;
+          stream >> uiCount;
+
+          for (ezUInt32 i = 0; i < uiCount; ++i)
+          {
+            double fSeconds = 0;
+            stream >> fSeconds;
+            ref_data.m_FrameStartTimes.PushBack(ezTime::MakeFromSeconds(fSeconds));
+          }
+          break;
+        }
+
+        case BlockType::CPUScopes:
+        {
+          ezProfilingSystem::CPUScopesBufferFlat eventBuffer;
+          ezUInt32 uiCount = 0;
+          stream >> eventBuffer.m_uiThreadId;
+          stream >> uiCount;
+
+          eventBuffer.m_Data.SetCountUninitialized(uiCount);
+          for (auto& scope : eventBuffer.m_Data)
+          {
+            double fBegin = 0;
+            double fEnd = 0;
+            stream >> fBegin;
+            stream >> fEnd;
+            EZ_SUCCEED_OR_RETURN(ReadStringRef(stream, segmentStrings, szName));
+            EZ_SUCCEED_OR_RETURN(ReadStringRef(stream, segmentStrings, szFunction));
+
+            scope.m_BeginTime = ezTime::MakeFromSeconds(fBegin);
+            scope.m_EndTime = ezTime::MakeFromSeconds(fEnd);
+            ezStringUtils::Copy(scope.m_szName, ezProfilingSystem::CPUScope::NAME_SIZE, szName);
+
+            // the function names have to outlive the profiling data, so they are stored in the strings of the caller
+            if (szFunction != nullptr)
+            {
+              ref_strings.PushBack(szFunction);
+              scope.m_szFunctionName = ref_strings.PeekBack().GetData();
+            }
+            else
+            {
+              scope.m_szFunctionName = nullptr;
+            }
+          }
+
+          AppendEvents(ref_data, eventBuffer);
+          break;
+        }
+
+        case BlockType::GPUScopes:
+        {
+          ezUInt32 uiGpuIndex = 0;
+          ezUInt32 uiCount = 0;
+          stream >> uiGpuIndex;
+          stream >> uiCount;
+
+          if (ref_data.m_GPUScopes.GetCount() <= uiGpuIndex)
+          {
+            ref_data.m_GPUScopes.SetCount(uiGpuIndex + 1);
+          }
+
+          for (ezUInt32 i = 0; i < uiCount; ++i)
+          {
+            double fBegin = 0;
+            double fEnd = 0;
+            stream >> fBegin;
+            stream >> fEnd;
+            EZ_SUCCEED_OR_RETURN(ReadStringRef(stream, segmentStrings, szName));
+
+            auto& scope = ref_data.m_GPUScopes[uiGpuIndex].ExpandAndGetRef();
+            scope.m_BeginTime = ezTime::MakeFromSeconds(fBegin);
+            scope.m_EndTime = ezTime::MakeFromSeconds(fEnd);
+            ezStringUtils::Copy(scope.m_szName, ezProfilingSystem::GPUScope::NAME_SIZE, szName);
+          }
+          break;
+        }
+
+        case BlockType::FastScopes:
+        {
+          ezUInt32 uiSize = 0;
+          stream >> uiSize;
+
+          fastBlock.SetCountUninitialized(uiSize);
+          if (stream.ReadBytes(fastBlock.GetData(), uiSize) != uiSize)
+            return EZ_FAILURE;
+
+          fastWriter.WriteBytes(fastBlock.GetData(), uiSize).IgnoreResult();
+          break;
+        }
+
+        default:
+          return EZ_FAILURE;
+      }
+    }
+
+    if (fastStorage.GetStorageSize64() > 0)
+    {
+      ezMemoryStreamReader fastReader(&fastStorage);
+
+      ezProfilingSystem::ProfilingData fastData;
+      if (ezFastProfilingSystem::ConvertBinaryDump(fastReader, fastData).Succeeded())
+      {
+        // the frames are already known from the regular profiling data
+        for (const auto& eventBuffer : fastData.m_AllEventBuffers)
+        {
+          AppendEvents(ref_data, eventBuffer);
+        }
+      }
+    }
+
+    return EZ_SUCCESS;
+  }
+
+  template <typename ScopeType>
+  void RemoveScopesOutsideOfTimeRange(ezDynamicArray<ScopeType>& ref_scopes, ezTime startTime, ezTime endTime)
+  {
+    ezUInt32 uiNumKept = 0;
+    for (const ScopeType& scope : ref_scopes)
+    {
+      if (scope.m_EndTime >= startTime && scope.m_BeginTime <= endTime)
+      {
+        ref_scopes[uiNumKept++] = scope;
+      }
+    }
+
+    ref_scopes.SetCountUninitialized(uiNumKept);
+  }
+
+  void RemoveDataOutsideOfTimeRange(ezProfilingSystem::ProfilingData& ref_data, ezTime startTime, ezTime endTime)
+  {
+    for (auto& eventBuffer : ref_data.m_AllEventBuffers)
+    {
+      RemoveScopesOutsideOfTimeRange(eventBuffer.m_Data, startTime, endTime);
+    }
+
+    for (auto& gpuScopes : ref_data.m_GPUScopes)
+    {
+      RemoveScopesOutsideOfTimeRange(gpuScopes, startTime, endTime);
+    }
+
+    // the frame count is the number of the last frame
+    ezUInt32 uiFirstFrame = 0;
+    ezUInt32 uiEndFrame = ref_data.m_FrameStartTimes.GetCount();
+
+    while (uiFirstFrame < uiEndFrame && ref_data.m_FrameStartTimes[uiFirstFrame] < startTime)
+      ++uiFirstFrame;
+
+    while (uiEndFrame > uiFirstFrame && ref_data.m_FrameStartTimes[uiEndFrame - 1] > endTime)
+    {
+      --uiEndFrame;
+      --ref_data.m_uiFrameCount;
+    }
+
+    ref_data.m_FrameStartTimes.RemoveAtAndCopy(uiEndFrame, ref_data.m_FrameStartTimes.GetCount() - uiEndFrame);
+    ref_data.m_FrameStartTimes.RemoveAtAndCopy(0, uiFirstFrame);
+  }
+
+  ezResult ExportTimeRangeLocked(ezStringView sOutputFile, ezTime startTime, ezTime endTime)
+  {
+    if (s_pState != nullptr)
+    {
+      // the segment that is currently written has to be finished to be readable
+      FlushNewData(*s_pState);
+      CloseSegment(*s_pState);
+    }
+
+    ezProfilingSystem::ProfilingData data;
+#  if EZ_ENABLED(EZ_SUPPORTS_PROCESSES)
+    data.m_uiProcessID = ezProcess::GetCurrentProcessID();
+#  endif
+
+    ezDeque<ezString> strings;
+
+    for (const Segment& segment : s_Segments)
+    {
+      // scopes are written once they have ended, so every segment that ended later may contain scopes that overlap the time range
+      if (segment.m_EndTime < startTime)
+        continue;
+
+      ezProfilingSystem::ProfilingData segmentData;
+      if (ReadSegment(segment.m_sFile, segmentData, strings).Failed())
+      {
+        ezLog::Warning("Profiling segment '{}' could not be read.", segment.m_sFile);
+        continue;
+      }
+
+      RemoveDataOutsideOfTimeRange(segmentData, startTime, endTime);
+
+      for (const auto& info : segmentData.m_ThreadInfos)
+      {
+        AppendThreadInfo(data, info.m_uiThreadId, info.m_sName);
+      }
+
+      for (const auto& eventBuffer : segmentData.m_AllEventBuffers)
+      {
+        AppendEvents(data, eventBuffer);
+      }
+
+      if (data.m_GPUScopes.GetCount() < segmentData.m_GPUScopes.GetCount())
+      {
+        data.m_GPUScopes.SetCount(segmentData.m_GPUScopes.GetCount());
+      }
+
+      for (ezUInt32 i = 0; i < segmentData.m_GPUScopes.GetCount(); ++i)
+      {
+        data.m_GPUScopes[i].PushBackRange(segmentData.m_GPUScopes[i]);
+      }
+
+      if (!segmentData.m_FrameStartTimes.IsEmpty())
+      {
+        data.m_FrameStartTimes.PushBackRange(segmentData.m_FrameStartTimes);
+        data.m_uiFrameCount = segmentData.m_uiFrameCount;
+      }
+    }
+
+    ezFileWriter file;
+    if (file.Open(sOutputFile).Failed())
+    {
+      ezLog::Error("Could not write profiling capture to '{}'.", sOutputFile);
+      return EZ_FAILURE;
+    }
+
+    if (data.Write(file).Failed())
+    {
+      ezLog::Error("Failed to write profiling capture: {}.", sOutputFile);
+      return EZ_FAILURE;
+    }
+
+    ezLog::Info("Profiling capture saved to '{}'.", file.GetFilePathAbsolute().GetData());
+    return EZ_SUCCESS;
+  }
+
+  void ExecutePendingExport(bool bForce)
+  {
+    if (s_ExportState.load(std::memory_order_acquire) != ExportState::Pending)
+      return;
+
+    if (!bForce && ezTime::Now() < s_ExportTime + s_ExportTimeAfter)
+      return;
+
+    s_ExportState.store(ExportState::Exporting, std::memory_order_relaxed);
+    ExportTimeRangeLocked(s_szExportFile, s_ExportTime - s_ExportTimeBefore, s_ExportTime + s_ExportTimeAfter).IgnoreResult();
+    s_ExportState.store(ExportState::Idle, std::memory_order_release);
+  }
+
+  void Update()
+  {
+    EZ_LOCK(s_Mutex);
+
+    if (s_pState == nullptr)
+      return;
+
+    RecordingState& state = *s_pState;
+    FlushNewData(state);
+
+    const ezTime tNow = ezTime::Now();
+
+    if (state.m_bSegmentOpen && tNow - s_Segments.PeekBack().m_StartTime >= state.m_Settings.m_SegmentDuration)
+    {
+      CloseSegment(state);
+    }
+
+    // never delete the segment that is currently written
+    while (s_Segments.GetCount() > 1 && s_Segments.PeekFront().m_EndTime < tNow - state.m_Settings.m_RetentionDuration)
+    {
+      ezFileSystem::DeleteFile(s_Segments.PeekFront().m_sFile);
+      s_Segments.PopFront();
+    }
+
+    ExecutePendingExport(false);
+  }
+
+  ezUInt32 ezContinuousProfilingThread::Run()
+  {
+    while (!m_bStop.load())
+    {
+      m_Signal.WaitForSignal(m_FlushInterval);
+      Update();
+    }
+
+    return 0;
+  }
+
+  void OnScopeTimeout(ezStringView sName, ezStringView sFunctionName, ezTime duration)
+  {
+    if (s_ExportState.load(std::memory_order_relaxed) != ExportState::Idle)
+      return;
+
+    ezStringBuilder sFile;
+    sFile.SetFormat("{}/ScopeTimeout-Frame{}.json", s_sTimeoutExportFolder, ezProfilingSystem::GetFrameCount());
+
+    ezContinuousProfiling::RequestExport(sFile, s_TimeoutExportBefore, s_TimeoutExportAfter);
+  }
+} // namespace
+
+// static
+ezResult ezContinuousProfiling::Start(const Settings& settings)
+{
+  EZ_LOCK(s_Mutex);
+
+  if (s_pState != nullptr)
+  {
+    ezLog::Error("Continuous profiling is already running.");
+    return EZ_FAILURE;
+  }
+
+  // the segments of the previous run are not tracked anymore after this, and would never be deleted
+  for (const Segment& segment : s_Segments)
+  {
+    ezFileSystem::DeleteFile(segment.m_sFile);
+  }
+
+  s_Segments.Clear();
+
+  s_pState = EZ_DEFAULT_NEW(RecordingState);
+  s_pState->m_Settings = settings;
+
+  // only new data is written
+  ezProfilingSystem::ProfilingData ignored;
+  ezProfilingSystem::CaptureNewData(ignored, s_pState->m_Cursor);
+
+  s_pState->m_Thread.m_FlushInterval = settings.m_FlushInterval;
+  s_pState->m_Thread.Start();
+
+  s_bRunning = true;
+
+  return EZ_SUCCESS;
+}
+
+// static
+void ezContinuousProfiling::Stop()
+{
+  RecordingState* pState = nullptr;
+  {
+    EZ_LOCK(s_Mutex);
+    pState = s_pState;
+  }
+
+  if (pState == nullptr)
+    return;
+
+  s_bRunning = false;
+
+  pState->m_Thread.m_bStop = true;
+  pState->m_Thread.m_Signal.RaiseSignal();
+  pState->m_Thread.Join();
+
+  EZ_LOCK(s_Mutex);
+
+  FlushNewData(*pState);
+  ExecutePendingExport(true);
+  CloseSegment(*pState);
+
+  EZ_DEFAULT_DELETE(s_pState);
+}
+
+// static
+bool ezContinuousProfiling::IsRunning()
+{
+  return s_bRunning;
+}
+
+// static
+void ezContinuousProfiling::Flush()
+{
+  EZ_LOCK(s_Mutex);
+
+  if (s_pState != nullptr)
+  {
+    FlushNewData(*s_pState);
+  }
+}
+
+// static
+ezUInt32 ezContinuousProfiling::GetNumSegments()
+{
+  EZ_LOCK(s_Mutex);
+  return s_Segments.GetCount();
+}
+
+// static
+ezResult ezContinuousProfiling::ExportTimeRange(ezStringView sOutputFile, ezTime startTime, ezTime endTime)
+{
+  EZ_LOCK(s_Mutex);
+  return ExportTimeRangeLocked(sOutputFile, startTime, endTime);
+}
+
+// static
+void ezContinuousProfiling::RequestExport(ezStringView sOutputFile, ezTime timeBefore, ezTime timeAfter)
+{
+  // the export is done by the background thread
+  if (!s_bRunning)
+    return;
+
+  ezUInt32 uiExpected = ExportState::Idle;
+  if (!s_ExportState.compare_exchange_strong(uiExpected, ExportState::Preparing, std::memory_order_acquire))
+    return;
+
+  ezStringUtils::Copy(s_szExportFile, EZ_ARRAY_SIZE(s_szExportFile), sOutputFile.GetStartPointer(), sOutputFile.GetEndPointer());
+  s_ExportTime = ezTime::Now();
+  s_ExportTimeBefore = timeBefore;
+  s_ExportTimeAfter = timeAfter;
+
+  s_ExportState.store(ExportState::Pending, std::memory_order_release);
+}
+
+// static
+void ezContinuousProfiling::SetExportOnScopeTimeout(ezStringView sOutputFolder, ezTime timeBefore, ezTime timeAfter)
+{
+  s_sTimeoutExportFolder = sOutputFolder;
+  s_TimeoutExportBefore = timeBefore;
+  s_TimeoutExportAfter = timeAfter;
+
+  ezProfilingSystem::SetScopeTimeoutCallback(&OnScopeTimeout);
+}
+
+// static
+void ezContinuousProfiling::DisableExportOnScopeTimeout()
+{
+  ezProfilingSystem::SetScopeTimeoutCallback({});
+}
+
+#else
+
+ezResult ezContinuousProfiling::Start(const Settings& settings)
+{
+  return EZ_FAILURE;
+}
+
+void ezContinuousProfiling::Stop() {}
+
+bool ezContinuousProfiling::IsRunning()
+{
+  return false;
+}
+
+void ezContinuousProfiling::Flush() {}
+
+ezUInt32 ezContinuousProfiling::GetNumSegments()
+{
+  return 0;
+}
+
+ezResult ezContinuousProfiling::ExportTimeRange(ezStringView sOutputFile, ezTime startTime, ezTime endTime)
+{
+  return EZ_FAILURE;
+}
+
+void ezContinuousProfiling::RequestExport(ezStringView sOutputFile, ezTime timeBefore, ezTime timeAfter) {}
+
+void ezContinuousProfiling::SetExportOnScopeTimeout(ezStringView sOutputFolder, ezTime timeBefore, ezTime timeAfter) {}
+
+void ezContinuousProfiling::DisableExportOnScopeTimeout() {}
+
+#endif
+
+EZ_STATICLINK_FILE(Foundation, Foundation_Profiling_Implementation_ContinuousProfiling);
@@ -0,0 +1,830 @@
+#include <Foundation/FoundationPCH.h>
+
+#include <Foundation/Containers/Deque.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/IO/Stream.h>
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Profiling/FastProfiling.h>
+#include <Foundation/Threading/ThreadUtils.h>
+
+#include <atomic>
+
+#if EZ_ENABLED(EZ_PLATFORM_ARCH_X86)
+#  if EZ_ENABLED(EZ_COMPILER_MSVC)
+#    include <intrin.h>
+#  else
+#    include <x86intrin.h>
+#  endif
+#endif
+
+// static
+ezUInt64 ezFastProfilingSystem::GetTimestamp()
+{
+#if EZ_ENABLED(EZ_PLATFORM_ARCH_X86)
+  return __rdtsc();
+#else
+  return static_cast<ezUInt64>(ezTime::Now().GetNanoseconds());
+#endif
+}
+
+#if EZ_ENABLED(EZ_USE_PROFILING)
+
+namespace
+{
+  constexpr ezUInt32 s_uiEventIndexMask = ezFastProfilingSystem::EventsPerThread - 1;
+  EZ_CHECK_AT_COMPILETIME_MSG((ezFastProfilingSystem::EventsPerThread & s_uiEventIndexMask) == 0, "EventsPerThread must be a power of two");
+  EZ_CHECK_AT_COMPILETIME(sizeof(ezFastProfilingSystem::Event) == 24);
+
+  constexpr ezUInt32 s_uiMaxFrames = 1024;
+
+  constexpr ezUInt32 s_uiStreamMagic = 0x5046455A; // 'EZFP'
+  constexpr ezUInt8 s_uiStreamVersion = 1;
+
+  struct ChunkType
+  {
+    enum Enum : ezUInt8
+    {
+      Header,
+      Calibration,
+      Names,
+      Threads,
+      Frames,
+      Events,
+    };
+  };
+
+  /// Ring buffer of a single thread. Only the owning thread writes to it, any other thread may read it while holding s_BuffersMutex.
+  ///
+  /// The buffers themselves are never deleted, so that a thread that is still in AddScope() during Shutdown() never touches freed memory.
+  /// Only their events are released, and a buffer whose thread exited is handed to the next new thread.
+  struct ThreadBuffer
+  {
+    ezUInt64 m_uiThreadId = 0;
+    ezUInt32 m_uiIndex = 0;
+
+    // set by the owning thread while it is in AddScope(), Shutdown() waits for it before releasing the events
+    std::atomic<bool> m_bWriting = false;
+
+    // protected by s_BuffersMutex, a buffer without a thread can be reused by the next thread that records an event
+    bool m_bThreadExited = false;
+
+    // the number of events that were ever written, the next event goes to m_pEvents[m_uiWriteIndex & s_uiEventIndexMask]
+    std::atomic<ezUInt64> m_uiWriteIndex = 0;
+
+    // events before this index were discarded with ezFastProfilingSystem::Clear()
+    std::atomic<ezUInt64> m_uiClearedIndex = 0;
+
+    // EventsPerThread events, nullptr once released
+    ezFastProfilingSystem::Event* m_pEvents = nullptr;
+  };
+
+  struct ThreadBufferRef
+  {
+    ThreadBuffer* m_pBuffer = nullptr;
+    ezUInt32 m_uiGeneration = 0;
+  };
+
+  struct NameEntry
+  {
+    ezString m_sName;
+    ezString m_sFunction;
+  };
+
+  struct Calibration
+  {
+    ezUInt64 m_uiTicks0 = 0;
+    double m_fTime0 = 0.0;
+    double m_fTicksPerSecond = 1e9;
+  };
+
+  // the interval between the two reference points of the initial calibration
+  constexpr double s_fMinCalibrationInterval = 0.01;
+
+  static std::atomic<bool> s_bEnabled = true;
+
+  // incremented by Shutdown(), so that threads know that the buffer they know about has no events anymore
+  static std::atomic<ezUInt32> s_uiGeneration = 1;
+  static thread_local ThreadBufferRef s_ThreadBuffer;
+
+  static ezMutex s_BuffersMutex;
+  static ezDeque<ThreadBuffer, ezStaticsAllocatorWrapper> s_Buffers;
+
+  static ezMutex s_NamesMutex;
+  static ezDeque<NameEntry> s_Names;
+  static ezHashTable<ezString, ezUInt32> s_NameToId;
+
+  // only written once by ezFastProfilingSystem::Initialize()
+  static Calibration s_Calibration;
+
+  static ezUInt64 s_FrameTicks[s_uiMaxFrames];
+  static std::atomic<ezUInt64> s_uiLastFrame = 0;
+
+  /// Assigns a buffer to the calling thread and marks it as being written to.
+  ThreadBuffer* RegisterThreadBuffer()
+  {
+    EZ_LOCK(s_BuffersMutex);
+
+    ThreadBuffer* pBuffer = nullptr;
+    for (ThreadBuffer& buffer : s_Buffers)
+    {
+      if (buffer.m_bThreadExited)
+      {
+        pBuffer = &buffer;
+        break;
+      }
+    }
+
+    if (pBuffer == nullptr)
+    {
+      pBuffer = &s_Buffers.ExpandAndGetRef();
+      pBuffer->m_uiIndex = s_Buffers.GetCount() - 1;
+    }
+
+    // the events of the previous thread are discarded, the write index keeps counting so that ezFastProfilingStream doesn't get confused
+    pBuffer->m_uiThreadId = (ezUInt64)ezThreadUtils::GetCurrentThreadID();
+    pBuffer->m_bThreadExited = false;
+    pBuffer->m_uiClearedIndex.store(pBuffer->m_uiWriteIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    if (pBuffer->m_pEvents == nullptr)
+    {
+      pBuffer->m_pEvents = EZ_DEFAULT_NEW_RAW_BUFFER(ezFastProfilingSystem::Event, ezFastProfilingSystem::EventsPerThread);
+    }
+
+    pBuffer->m_bWriting.store(true, std::memory_order_relaxed);
+
+    s_ThreadBuffer.m_pBuffer = pBuffer;
+    s_ThreadBuffer.m_uiGeneration = s_uiGeneration.load(std::memory_order_relaxed);
+    return pBuffer;
+  }
+
+  /// Returns the buffer of the calling thread and marks it as being written to, the caller has to reset m_bWriting once it is done.
+  EZ_ALWAYS_INLINE ThreadBuffer* AcquireThreadBuffer()
+  {
+    ThreadBuffer* pBuffer = s_ThreadBuffer.m_pBuffer;
+
+    if (pBuffer != nullptr)
+    {
+      // announced before the generation is checked, so Shutdown() either waits for this write, or this thread sees the new generation
+      pBuffer->m_bWriting.store(true, std::memory_order_seq_cst);
+
+      if (s_ThreadBuffer.m_uiGeneration == s_uiGeneration.load(std::memory_order_seq_cst))
+        return pBuffer;
+
+      pBuffer->m_bWriting.store(false, std::memory_order_release);
+    }
+
+    return RegisterThreadBuffer();
+  }
+
+  /// Copies the events with index uiStart and later out of the ring buffer. Returns the index of the first copied event, which is larger than
+  /// uiStart if the requested events were already overwritten.
+  ezUInt64 ReadEvents(const ThreadBuffer& buffer, ezUInt64 uiStart, ezDynamicArray<ezFastProfilingSystem::Event>& out_events)
+  {
+    const ezUInt64 uiEnd = buffer.m_uiWriteIndex.load(std::memory_order_acquire);
+
+    out_events.Clear();
+    if (buffer.m_pEvents == nullptr)
+      return uiEnd;
+
+    uiStart = ezMath::Max(uiStart, buffer.m_uiClearedIndex.load(std::memory_order_relaxed));
+    uiStart = ezMath::Min(uiStart, uiEnd);
+
+    // the slot of the oldest event is the one that the owning thread writes to next, so it is never read
+    if (uiEnd - uiStart > ezFastProfilingSystem::EventsPerThread - 1)
+    {
+      uiStart = uiEnd - (ezFastProfilingSystem::EventsPerThread - 1);
+    }
+
+    const ezUInt32 uiCount = static_cast<ezUInt32>(uiEnd - uiStart);
+    out_events.SetCountUninitialized(uiCount);
+
+    for (ezUInt32 i = 0; i < uiCount; ++i)
+    {
+      out_events[i] = buffer.m_pEvents[(uiStart + i) & s_uiEventIndexMask];
+    }
+
+    // the owning thread may have continued writing while we copied the events,
+    // everything that shares a slot with an event written in the meantime may be garbage
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const ezUInt64 uiEndAfterRead = buffer.m_uiWriteIndex.load(std::memory_order_relaxed);
+
+    if (uiEndAfterRead + 1 > uiStart + ezFastProfilingSystem::EventsPerThread)
+    {
+      const ezUInt64 uiNumOverwritten = ezMath::Min<ezUInt64>(uiEndAfterRead + 1 - ezFastProfilingSystem::EventsPerThread - uiStart, uiCount);
+      out_events.RemoveAtAndCopy(0, static_cast<ezUInt32>(uiNumOverwritten));
+      uiStart += uiNumOverwritten;
+    }
+
+    return uiStart;
+  }
+
+  /// Computes the conversion factor from the initial reference point to now, the longer the interval, the more precise the factor is.
+  Calibration GetCalibration()
+  {
+    Calibration calibration = s_Calibration;
+
+#  if EZ_ENABLED(EZ_PLATFORM_ARCH_X86)
+    const double fNow = ezTime::Now().GetSeconds();
+    const ezUInt64 uiTicks = ezFastProfilingSystem::GetTimestamp();
+
+    if (fNow - calibration.m_fTime0 >= s_fMinCalibrationInterval && uiTicks > calibration.m_uiTicks0)
+    {
+      calibration.m_fTicksPerSecond = static_cast<double>(uiTicks - calibration.m_uiTicks0) / (fNow - calibration.m_fTime0);
+    }
+#  endif
+
+    return calibration;
+  }
+
+  ezTime ConvertTicks(const Calibration& calibration, ezUInt64 uiTicks)
+  {
+    const double fDeltaTicks = uiTicks >= calibration.m_uiTicks0 ? static_cast<double>(uiTicks - calibration.m_uiTicks0) : -static_cast<double>(calibration.m_uiTicks0 - uiTicks);
+    return ezTime::MakeFromSeconds(calibration.m_fTime0 + fDeltaTicks / calibration.m_fTicksPerSecond);
+  }
+
+  ezProfilingSystem::CPUScopesBufferFlat& GetOrAddEventBuffer(ezProfilingSystem::ProfilingData& ref_profilingData, ezUInt64 uiThreadId)
+  {
+    for (auto& eventBuffer : ref_profilingData.m_AllEventBuffers)
+    {
+      if (eventBuffer.m_uiThreadId == uiThreadId)
+        return eventBuffer;
+    }
+
+    auto& eventBuffer = ref_profilingData.m_AllEventBuffers.ExpandAndGetRef();
+    eventBuffer.m_uiThreadId = uiThreadId;
+    return eventBuffer;
+  }
+
+  void AppendEvents(ezProfilingSystem::CPUScopesBufferFlat& ref_eventBuffer, ezArrayPtr<const ezFastProfilingSystem::Event> events, const Calibration& calibration, ezArrayPtr<const ezUInt32> nameIdRemapping)
+  {
+    EZ_LOCK(s_NamesMutex);
+
+    ref_eventBuffer.m_Data.Reserve(ref_eventBuffer.m_Data.GetCount() + events.GetCount());
+
+    for (const auto& e : events)
+    {
+      const ezUInt32 uiNameId = nameIdRemapping.IsEmpty() ? e.m_uiNameId : (e.m_uiNameId < nameIdRemapping.GetCount() ? nameIdRemapping[e.m_uiNameId] : ezInvalidIndex);
+      if (uiNameId >= s_Names.GetCount())
+        continue;
+
+      const NameEntry& name = s_Names[uiNameId];
+
+      ezProfilingSystem::CPUScope& scope = ref_eventBuffer.m_Data.ExpandAndGetRef();
+      scope.m_szFunctionName = name.m_sFunction.IsEmpty() ? nullptr : name.m_sFunction.GetData();
+      scope.m_BeginTime = ConvertTicks(calibration, e.m_uiBeginTicks);
+      scope.m_EndTime = ConvertTicks(calibration, e.m_uiEndTicks);
+      ezStringUtils::Copy(scope.m_szName, ezProfilingSystem::CPUScope::NAME_SIZE, name.m_sName.GetData());
+    }
+  }
+} // namespace
+
+// static
+void ezFastProfilingSystem::SetEnabled(bool bEnabled)
+{
+  s_bEnabled.store(bEnabled, std::memory_order_relaxed);
+}
+
+// static
+bool ezFastProfilingSystem::IsEnabled()
+{
+  return s_bEnabled.load(std::memory_order_relaxed);
+}
+
+// static
+ezUInt32 ezFastProfilingSystem::RegisterScopeName(ezStringView sName, const char* szFunctionName)
+{
+  ezStringBuilder sKey;
+  sKey.Set(szFunctionName, "\n", sName);
+
+  EZ_LOCK(s_NamesMutex);
+
+  ezUInt32 uiNameId = 0;
+  if (s_NameToId.TryGetValue(sKey, uiNameId))
+    return uiNameId;
+
+  uiNameId = s_Names.GetCount();
+
+  NameEntry& entry = s_Names.ExpandAndGetRef();
+  entry.m_sName = sName;
+  entry.m_sFunction = szFunctionName;
+
+  s_NameToId.Insert(sKey, uiNameId);
+  return uiNameId;
+}
+
+// static
+ezStringView ezFastProfilingSystem::GetScopeName(ezUInt32 uiNameId)
+{
+  EZ_LOCK(s_NamesMutex);
+
+  if (uiNameId >= s_Names.GetCount())
+    return {};
+
+  // the entries never move, so the view stays valid
+  return s_Names[uiNameId].m_sName;
+}
+
+// static
+ezTime ezFastProfilingSystem::TicksToTime(ezUInt64 uiTicks)
+{
+  return ConvertTicks(GetCalibration(), uiTicks);
+}
+
+// static
+double ezFastProfilingSystem::GetTicksPerSecond()
+{
+  return GetCalibration().m_fTicksPerSecond;
+}
+
+// static
+void ezFastProfilingSystem::AddScope(ezUInt32 uiNameId, ezUInt64 uiBeginTicks, ezUInt64 uiEndTicks)
+{
+  if (!s_bEnabled.load(std::memory_order_relaxed))
+    return;
+
+  ThreadBuffer* pBuffer = AcquireThreadBuffer();
+
+  // only this thread writes to the buffer, readers detect overwritten events through the write index
+  const ezUInt64 uiWriteIndex = pBuffer->m_uiWriteIndex.load(std::memory_order_relaxed);
+
+  Event& e = pBuffer->m_pEvents[uiWriteIndex & s_uiEventIndexMask];
+  e.m_uiBeginTicks = uiBeginTicks;
+  e.m_uiEndTicks = uiEndTicks;
+  e.m_uiNameId = uiNameId;
+  e.m_uiReserved = 0;
+
+  pBuffer->m_uiWriteIndex.store(uiWriteIndex + 1, std::memory_order_release);
+  pBuffer->m_bWriting.store(false, std::memory_order_release);
+}
+
+// static
+void ezFastProfilingSystem::Clear()
+{
+  EZ_LOCK(s_BuffersMutex);
+
+  for (ThreadBuffer& buffer : s_Buffers)
+  {
+    buffer.m_uiClearedIndex.store(buffer.m_uiWriteIndex.load(std::memory_order_acquire), std::memory_order_relaxed);
+
+    // nobody needs the events of exited threads anymore, the next new thread allocates them again
+    if (buffer.m_bThreadExited && buffer.m_pEvents != nullptr)
+    {
+      EZ_DEFAULT_DELETE_RAW_BUFFER(buffer.m_pEvents);
+    }
+  }
+}
+
+// static
+void ezFastProfilingSystem::Capture(ezProfilingSystem::ProfilingData& ref_profilingData)
+{
+  const Calibration calibration = GetCalibration();
+
+  EZ_LOCK(s_BuffersMutex);
+
+  ezDynamicArray<Event> events;
+  for (const ThreadBuffer& buffer : s_Buffers)
+  {
+    ReadEvents(buffer, 0, events);
+
+    if (!events.IsEmpty())
+    {
+      AppendEvents(GetOrAddEventBuffer(ref_profilingData, buffer.m_uiThreadId), events, calibration, {});
+    }
+  }
+}
+
+// static
+ezResult ezFastProfilingSystem::ConvertBinaryDump(ezStreamReader& inout_stream, ezProfilingSystem::ProfilingData& out_profilingData)
+{
+  out_profilingData.Clear();
+
+#  if EZ_ENABLED(EZ_SUPPORTS_PROCESSES)
+  out_profilingData.m_uiProcessID = ezProcess::GetCurrentProcessID();
+#  endif
+
+  Calibration calibration;
+  ezDynamicArray<ezUInt32> nameIdRemapping;
+
+  struct ThreadEvents
+  {
+    ezUInt64 m_uiThreadId = 0;
+    ezDynamicArray<Event> m_Events;
+  };
+
+  ezDynamicArray<ThreadEvents> threadEvents;
+  ezDynamicArray<ezUInt64> frameTicks;
+  ezStringBuilder sName;
+  ezStringBuilder sFunction;
+
+  while (true)
+  {
+    ezUInt8 uiChunkType = 0;
+    if (inout_stream.ReadBytes(&uiChunkType, sizeof(ezUInt8)) != sizeof(ezUInt8))
+      break;
+
+    switch (uiChunkType)
+    {
+      case ChunkType::Header:
+      {
+        ezUInt32 uiMagic = 0;
+        ezUInt8 uiVersion = 0;
+        inout_stream >> uiMagic;
+        inout_stream >> uiVersion;
+
+        if (uiMagic != s_uiStreamMagic || uiVersion != s_uiStreamVersion)
+        {
+          ezLog::Error("Invalid profiling stream header or unsupported version {}.", uiVersion);
+          return EZ_FAILURE;
+        }
+        break;
+      }
+
+      case ChunkType::Calibration:
+      {
+        inout_stream >> calibration.m_uiTicks0;
+        inout_stream >> calibration.m_fTime0;
+        inout_stream >> calibration.m_fTicksPerSecond;
+        break;
+      }
+
+      case ChunkType::Names:
+      {
+        ezUInt32 uiFirstId = 0;
+        ezUInt32 uiCount = 0;
+        inout_stream >> uiFirstId;
+        inout_stream >> uiCount;
+
+        if (nameIdRemapping.GetCount() < uiFirstId + uiCount)
+        {
+          nameIdRemapping.SetCount(uiFirstId + uiCount, ezInvalidIndex);
+        }
+
+        // the names are registered in this process, which guarantees that the strings outlive the profiling data
+        for (ezUInt32 i = 0; i < uiCount; ++i)
+        {
+          EZ_SUCCEED_OR_RETURN(inout_stream.ReadString(sName));
+          EZ_SUCCEED_OR_RETURN(inout_stream.ReadString(sFunction));
+
+          nameIdRemapping[uiFirstId + i] = RegisterScopeName(sName, sFunction.IsEmpty() ? nullptr : sFunction.GetData());
+        }
+        break;
+      }
+
+      case ChunkType::Threads:
+      {
+        ezUInt32 uiCount = 0;
+        inout_stream >> uiCount;
+
+        for (ezUInt32 i = 0; i < uiCount; ++i)
+        {
+          ezProfilingSystem::ThreadInfo info;
+          inout_stream >> info.m_uiThreadId;
+          EZ_SUCCEED_OR_RETURN(inout_stream.ReadString(info.m_sName));
+
+          bool bKnown = false;
+          for (const auto& existing : out_profilingData.m_ThreadInfos)
+          {
+            bKnown |= existing.m_uiThreadId == info.m_uiThreadId;
+          }
+
+          if (!bKnown)
+          {
+            out_profilingData.m_ThreadInfos.PushBack(info);
+          }
+        }
+        break;
+      }
+
+      case ChunkType::Frames:
+      {
+        ezUInt64 uiFirstFrame = 0;
+        ezUInt32 uiCount = 0;
+        inout_stream >> uiFirstFrame;
+        inout_stream >> uiCount;
+
+        const ezUInt32 uiOffset = frameTicks.GetCount();
+        frameTicks.SetCountUninitialized(uiOffset + uiCount);
+        if (inout_stream.ReadBytes(frameTicks.GetData() + uiOffset, sizeof(ezUInt64) * uiCount) != sizeof(ezUInt64) * uiCount)
+          return EZ_FAILURE;
+
+        out_profilingData.m_uiFrameCount = uiFirstFrame + uiCount - 1;
+        break;
+      }
+
+      case ChunkType::Events:
+      {
+        ezUInt64 uiThreadId = 0;
+        ezUInt32 uiCount = 0;
+        inout_stream >> uiThreadId;
+        inout_stream >> uiCount;
+
+        ThreadEvents* pThreadEvents = nullptr;
+        for (auto& te : threadEvents)
+        {
+          if (te.m_uiThreadId == uiThreadId)
+            pThreadEvents = &te;
+        }
+
+        if (pThreadEvents == nullptr)
+        {
+          pThreadEvents = &threadEvents.ExpandAndGetRef();
+          pThreadEvents->m_uiThreadId = uiThreadId;
+        }
+
+        const ezUInt32 uiOffset = pThreadEvents->m_Events.GetCount();
+        pThreadEvents->m_Events.SetCountUninitialized(uiOffset + uiCount);
+        if (inout_stream.ReadBytes(pThreadEvents->m_Events.GetData() + uiOffset, sizeof(Event) * uiCount) != sizeof(Event) * uiCount)
+          return EZ_FAILURE;
+
+        break;
+      }
+
+      default:
+        ezLog::Error("Invalid chunk type {} in profiling stream.", uiChunkType);
+        return EZ_FAILURE;
+    }
+  }
+
+  // timestamps can only be converted once the final calibration is known
+  for (const auto& te : threadEvents)
+  {
+    AppendEvents(GetOrAddEventBuffer(out_profilingData, te.m_uiThreadId), te.m_Events, calibration, nameIdRemapping);
+  }
+
+  out_profilingData.m_FrameStartTimes.SetCountUninitialized(frameTicks.GetCount());
+  for (ezUInt32 i = 0; i < frameTicks.GetCount(); ++i)
+  {
+    out_profilingData.m_FrameStartTimes[i] = ConvertTicks(calibration, frameTicks[i]);
+  }
+
+  return EZ_SUCCESS;
+}
+
+// static
+void ezFastProfilingSystem::Initialize()
+{
+  // calibrated once, before any other thread can convert timestamps, so that no lock is needed to read the calibration
+#  if EZ_ENABLED(EZ_PLATFORM_ARCH_X86)
+  if (s_Calibration.m_uiTicks0 == 0)
+  {
+    Calibration calibration;
+    calibration.m_uiTicks0 = GetTimestamp();
+    calibration.m_fTime0 = ezTime::Now().GetSeconds();
+
+    double fNow = calibration.m_fTime0;
+    while (fNow - calibration.m_fTime0 < s_fMinCalibrationInterval)
+    {
+      fNow = ezTime::Now().GetSeconds();
+    }
+
+    calibration.m_fTicksPerSecond = static_cast<double>(GetTimestamp() - calibration.m_uiTicks0) / (fNow - calibration.m_fTime0);
+    s_Calibration = calibration;
+  }
+#  else
+  // the timestamps are nanoseconds of ezTime::Now() already
+  s_Calibration = Calibration();
+#  endif
+}
+
+// static
+void ezFastProfilingSystem::Shutdown()
+{
+  EZ_LOCK(s_BuffersMutex);
+
+  // threads that record an event from now on need a new buffer, threads that are recording one right now are waited for
+  s_uiGeneration.fetch_add(1, std::memory_order_seq_cst);
+
+  for (ThreadBuffer& buffer : s_Buffers)
+  {
+    while (buffer.m_bWriting.load(std::memory_order_seq_cst))
+    {
+      ezThreadUtils::YieldTimeSlice();
+    }
+
+    if (buffer.m_pEvents != nullptr)
+    {
+      EZ_DEFAULT_DELETE_RAW_BUFFER(buffer.m_pEvents);
+    }
+
+    buffer.m_bThreadExited = true;
+  }
+
+  s_ThreadBuffer.m_pBuffer = nullptr;
+}
+
+// static
+void ezFastProfilingSystem::RemoveThread()
+{
+  EZ_LOCK(s_BuffersMutex);
+
+  ThreadBuffer* pBuffer = s_ThreadBuffer.m_pBuffer;
+  if (pBuffer != nullptr && s_ThreadBuffer.m_uiGeneration == s_uiGeneration.load(std::memory_order_relaxed))
+  {
+    // the events are kept until they are cleared or the buffer is reused, so that they can still be captured
+    pBuffer->m_bThreadExited = true;
+  }
+
+  s_ThreadBuffer.m_pBuffer = nullptr;
+}
+
+// static
+void ezFastProfilingSystem::StartNewFrame(ezUInt64 uiFrameCount)
+{
+  s_FrameTicks[uiFrameCount % s_uiMaxFrames] = GetTimestamp();
+  s_uiLastFrame.store(uiFrameCount, std::memory_order_release);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+ezFastProfilingStream::ezFastProfilingStream() = default;
+ezFastProfilingStream::~ezFastProfilingStream() = default;
+
+void ezFastProfilingStream::Reset()
+{
+  m_bHeaderWritten = false;
+  m_uiNumNamesWritten = 0;
+  m_uiNextFrame = 0;
+  m_uiNumLostEvents = 0;
+  m_ReadPositions.Clear();
+}
+
+void ezFastProfilingStream::StartNewSegment()
+{
+  m_bHeaderWritten = false;
+  m_uiNumNamesWritten = 0;
+}
+
+ezResult ezFastProfilingStream::WriteNewEvents(ezStreamWriter& inout_stream)
+{
+  if (!m_bHeaderWritten)
+  {
+    inout_stream << static_cast<ezUInt8>(ChunkType::Header);
+    inout_stream << s_uiStreamMagic;
+    inout_stream << s_uiStreamVersion;
+
+    m_bHeaderWritten = true;
+  }
+
+  // names
+  {
+    EZ_LOCK(s_NamesMutex);
+
+    if (m_uiNumNamesWritten < s_Names.GetCount())
+    {
+      inout_stream << static_cast<ezUInt8>(ChunkType::Names);
+      inout_stream << m_uiNumNamesWritten;
+      inout_stream << s_Names.GetCount() - m_uiNumNamesWritten;
+
+      for (ezUInt32 i = m_uiNumNamesWritten; i < s_Names.GetCount(); ++i)
+      {
+        EZ_SUCCEED_OR_RETURN(inout_stream.WriteString(s_Names[i].m_sName));
+        EZ_SUCCEED_OR_RETURN(inout_stream.WriteString(s_Names[i].m_sFunction));
+      }
+
+      m_uiNumNamesWritten = s_Names.GetCount();
+    }
+  }
+
+  // threads, these are few, so all of them are written every time
+  {
+    ezHybridArray<ezProfilingSystem::ThreadInfo, 16> threadInfos;
+    ezProfilingSystem::GetThreadInfos(threadInfos);
+
+    inout_stream << static_cast<ezUInt8>(ChunkType::Threads);
+    inout_stream << threadInfos.GetCount();
+
+    for (const auto& info : threadInfos)
+    {
+      inout_stream << info.m_uiThreadId;
+      EZ_SUCCEED_OR_RETURN(inout_stream.WriteString(info.m_sName));
+    }
+  }
+
+  // frames
+  {
+    const ezUInt64 uiLastFrame = s_uiLastFrame.load(std::memory_order_acquire);
+    ezUInt64 uiFirstFrame = ezMath::Max(m_uiNextFrame, uiLastFrame >= s_uiMaxFrames ? uiLastFrame - s_uiMaxFrames + 1 : 1);
+
+    if (uiLastFrame >= uiFirstFrame)
+    {
+      const ezUInt32 uiCount = static_cast<ezUInt32>(uiLastFrame - uiFirstFrame + 1);
+
+      inout_stream << static_cast<ezUInt8>(ChunkType::Frames);
+      inout_stream << uiFirstFrame;
+      inout_stream << uiCount;
+
+      for (ezUInt64 uiFrame = uiFirstFrame; uiFrame <= uiLastFrame; ++uiFrame)
+      {
+        inout_stream << s_FrameTicks[uiFrame % s_uiMaxFrames];
+      }
+
+      m_uiNextFrame = uiLastFrame + 1;
+    }
+  }
+
+  // events
+  {
+    EZ_LOCK(s_BuffersMutex);
+
+    if (m_ReadPositions.GetCount() < s_Buffers.GetCount())
+    {
+      m_ReadPositions.SetCount(s_Buffers.GetCount());
+    }
+
+    ezDynamicArray<ezFastProfilingSystem::Event> events;
+    for (const ThreadBuffer& buffer : s_Buffers)
+    {
+      ezUInt64& uiReadPosition = m_ReadPositions[buffer.m_uiIndex];
+      const ezUInt64 uiExpectedFirst = ezMath::Max(uiReadPosition, buffer.m_uiClearedIndex.load(std::memory_order_relaxed));
+      const ezUInt64 uiFirstRead = ReadEvents(buffer, uiReadPosition, events);
+
+      // everything between the last written event and the first one that is still available was overwritten
+      m_uiNumLostEvents += uiFirstRead > uiExpectedFirst ? uiFirstRead - uiExpectedFirst : 0;
+      uiReadPosition = uiFirstRead + events.GetCount();
+
+      if (events.IsEmpty())
+        continue;
+
+      inout_stream << static_cast<ezUInt8>(ChunkType::Events);
+      inout_stream << buffer.m_uiThreadId;
+      inout_stream << events.GetCount();
+      EZ_SUCCEED_OR_RETURN(inout_stream.WriteBytes(events.GetData(), events.GetCount() * sizeof(ezFastProfilingSystem::Event)));
+    }
+  }
+
+  // written last, so that the most recent (and most precise) calibration is used for all events
+  {
+    const Calibration calibration = GetCalibration();
+
+    inout_stream << static_cast<ezUInt8>(ChunkType::Calibration);
+    inout_stream << calibration.m_uiTicks0;
+    inout_stream << calibration.m_fTime0;
+    inout_stream << calibration.m_fTicksPerSecond;
+  }
+
+  return EZ_SUCCESS;
+}
+
+#else
+
+void ezFastProfilingSystem::SetEnabled(bool bEnabled) {}
+
+bool ezFastProfilingSystem::IsEnabled()
+{
+  return false;
+}
+
+ezUInt32 ezFastProfilingSystem::RegisterScopeName(ezStringView sName, const char* szFunctionName)
+{
+  return 0;
+}
+
+ezStringView ezFastProfilingSystem::GetScopeName(ezUInt32 uiNameId)
+{
+  return {};
+}
+
+ezTime ezFastProfilingSystem::TicksToTime(ezUInt64 uiTicks)
+{
+  return ezTime::MakeZero();
+}
+
+double ezFastProfilingSystem::GetTicksPerSecond()
+{
+  return 1.0;
+}
+
+void ezFastProfilingSystem::AddScope(ezUInt32 uiNameId, ezUInt64 uiBeginTicks, ezUInt64 uiEndTicks) {}
+
+void ezFastProfilingSystem::Clear() {}
+
+void ezFastProfilingSystem::Capture(ezProfilingSystem::ProfilingData& ref_profilingData) {}
+
+ezResult ezFastProfilingSystem::ConvertBinaryDump(ezStreamReader& inout_stream, ezProfilingSystem::ProfilingData& out_profilingData)
+{
+  return EZ_FAILURE;
+}
+
+void ezFastProfilingSystem::Initialize() {}
+
+void ezFastProfilingSystem::Shutdown() {}
+
+void ezFastProfilingSystem::StartNewFrame(ezUInt64 uiFrameCount) {}
+
+void ezFastProfilingSystem::RemoveThread() {}
+
+ezFastProfilingStream::ezFastProfilingStream() = default;
+ezFastProfilingStream::~ezFastProfilingStream() = default;
+
+void ezFastProfilingStream::Reset() {}
+
+void ezFastProfilingStream::StartNewSegment() {}
+
+ezResult ezFastProfilingStream::WriteNewEvents(ezStreamWriter& inout_stream)
+{
+  return EZ_FAILURE;
+}
+
+#endif
+
+EZ_STATICLINK_FILE(Foundation, Foundation_Profiling_Implementation_FastProfiling);
@@ -8,6 +8,7 @@
 #include <Foundation/Containers/StaticRingBuffer.h>
 #include <Foundation/IO/JSONWriter.h>
 #include <Foundation/Memory/CommonAllocators.h>
+#include <Foundation/Profiling/FastProfiling.h>
 #include <Foundation/Profiling/Profiling.h>
 #include <Foundation/Threading/ThreadUtils.h>
 
@@ -44,6 +45,7 @@ EZ_BEGIN_SUBSYSTEM_DECLARATION(Foundation, ProfilingSystem)
   {
     s_ProfileCaptureDataTransfer.DisableDataTransfer();
     ezProfilingSystem::Reset();
+    ezFastProfilingSystem::Shutdown();
   }
 
 EZ_END_SUBSYSTEM_DECLARATION;
@@ -72,6 +74,9 @@ namespace
 
     ezUInt64 m_uiThreadId = 0;
     bool IsMainThread() const { return m_uiThreadId == s_MainThreadId; }
+
+    // the number of scopes that were ever added, used by ezProfilingSystem::CaptureNewData()
+    ezUInt64 m_uiNumScopesAdded = 0;
   };
 
   template <ezUInt32 SizeInBytes>
@@ -112,6 +117,51 @@ namespace
   static ezProfilingSystem::ScopeTimeoutDelegate s_ScopeTimeoutCallback;
 
   static ezDynamicArray<ezUniquePtr<GPUScopesBuffer>> s_GPUScopes;
+  static ezDynamicArray<ezUInt64> s_NumGPUScopesAdded;
+
+  // protects s_FrameStartTimes, s_uiFrameCount and the GPU scopes, which are read by the continuous profiling thread
+  static ezMutex s_FramesAndGPUScopesMutex;
+
+  ezUInt32 GetNumScopes(CpuScopesBufferBase* pEventBuffer)
+  {
+    return pEventBuffer->IsMainThread() ? CastToMainThreadEventBuffer(pEventBuffer)->m_Data.GetCount() : CastToOtherThreadEventBuffer(pEventBuffer)->m_Data.GetCount();
+  }
+
+  /// Copies the last uiCount scopes of the given buffer.
+  void CopyLastScopes(CpuScopesBufferBase* pSourceEventBuffer, ezUInt32 uiCount, ezProfilingSystem::CPUScopesBufferFlat& ref_targetEventBuffer)
+  {
+    const ezUInt32 uiFirst = GetNumScopes(pSourceEventBuffer) - uiCount;
+
+    ref_targetEventBuffer.m_uiThreadId = pSourceEventBuffer->m_uiThreadId;
+    ref_targetEventBuffer.m_Data.SetCountUninitialized(uiCount);
+    for (ezUInt32 j = 0; j < uiCount; ++j)
+    {
+      const ezProfilingSystem::CPUScope& sourceEvent = pSourceEventBuffer->IsMainThread() ? CastToMainThreadEventBuffer(pSourceEventBuffer)->m_Data[uiFirst + j] : CastToOtherThreadEventBuffer(pSourceEventBuffer)->m_Data[uiFirst + j];
+
+      ezProfilingSystem::CPUScope& copiedEvent = ref_targetEventBuffer.m_Data[j];
+      copiedEvent.m_szFunctionName = sourceEvent.m_szFunctionName;
+      copiedEvent.m_BeginTime = sourceEvent.m_BeginTime;
+      copiedEvent.m_EndTime = sourceEvent.m_EndTime;
+      ezStringUtils::Copy(copiedEvent.m_szName, ezProfilingSystem::CPUScope::NAME_SIZE, sourceEvent.m_szName);
+    }
+  }
+
+  /// Copies the last uiCount scopes of the given GPU buffer.
+  void CopyLastGPUScopes(const GPUScopesBuffer& sourceBuffer, ezUInt32 uiCount, ezDynamicArray<ezProfilingSystem::GPUScope>& ref_targetBuffer)
+  {
+    const ezUInt32 uiFirst = sourceBuffer.GetCount() - uiCount;
+
+    ref_targetBuffer.SetCountUninitialized(uiCount);
+    for (ezUInt32 i = 0; i < uiCount; ++i)
+    {
+      const ezProfilingSystem::GPUScope& sourceGpuDat = sourceBuffer[uiFirst + i];
+
+      ezProfilingSystem::GPUScope& copiedGpuData = ref_targetBuffer[i];
+      copiedGpuData.m_BeginTime = sourceGpuDat.m_BeginTime;
+      copiedGpuData.m_EndTime = sourceGpuDat.m_EndTime;
+      ezStringUtils::Copy(copiedGpuData.m_szName, ezProfilingSystem::GPUScope::NAME_SIZE, sourceGpuDat.m_szName);
+    }
+  }
 
   static ezEventSubscriptionID s_PluginEventSubscription = 0;
   void PluginEvent(const ezPluginEvent& e)
@@ -547,6 +597,10 @@ void ezProfilingSystem::Clear()
     }
   }
 
+  ezFastProfilingSystem::Clear();
+
+  EZ_LOCK(s_FramesAndGPUScopesMutex);
+
   s_FrameStartTimes.Clear();
 
   for (auto& gpuScopes : s_GPUScopes)
@@ -589,58 +643,93 @@ void ezProfilingSystem::Capture(ezProfilingSystem::ProfilingData& ref_profilingD
     ref_profilingData.m_AllEventBuffers.Reserve(s_AllCpuScopes.GetCount());
     for (ezUInt32 i = 0; i < s_AllCpuScopes.GetCount(); ++i)
     {
-      const auto& sourceEventBuffer = s_AllCpuScopes[i];
-      CPUScopesBufferFlat& targetEventBuffer = ref_profilingData.m_AllEventBuffers.ExpandAndGetRef();
+      CopyLastScopes(s_AllCpuScopes[i], GetNumScopes(s_AllCpuScopes[i]), ref_profilingData.m_AllEventBuffers.ExpandAndGetRef());
+    }
+  }
 
-      targetEventBuffer.m_uiThreadId = sourceEventBuffer->m_uiThreadId;
+  ezFastProfilingSystem::Capture(ref_profilingData);
 
-      ezUInt32 uiSourceCount = sourceEventBuffer->IsMainThread() ? CastToMainThreadEventBuffer(sourceEventBuffer)->m_Data.GetCount() : CastToOtherThreadEventBuffer(sourceEventBuffer)->m_Data.GetCount();
-      targetEventBuffer.m_Data.SetCountUninitialized(uiSourceCount);
-      for (ezUInt32 j = 0; j < uiSourceCount; ++j)
-      {
-        const CPUScope& sourceEvent = sourceEventBuffer->IsMainThread() ? CastToMainThreadEventBuffer(sourceEventBuffer)->m_Data[j] : CastToOtherThreadEventBuffer(sourceEventBuffer)->m_Data[j];
+  {
+    EZ_LOCK(s_FramesAndGPUScopesMutex);
 
-        CPUScope& copiedEvent = targetEventBuffer.m_Data[j];
-        copiedEvent.m_szFunctionName = sourceEvent.m_szFunctionName;
-        copiedEvent.m_BeginTime = sourceEvent.m_BeginTime;
-        copiedEvent.m_EndTime = sourceEvent.m_EndTime;
-        ezStringUtils::Copy(copiedEvent.m_szName, CPUScope::NAME_SIZE, sourceEvent.m_szName);
+    ref_profilingData.m_uiFrameCount = s_uiFrameCount;
+
+    ref_profilingData.m_FrameStartTimes.SetCountUninitialized(s_FrameStartTimes.GetCount());
+    for (ezUInt32 i = 0; i < s_FrameStartTimes.GetCount(); ++i)
+    {
+      ref_profilingData.m_FrameStartTimes[i] = s_FrameStartTimes[i];
+    }
+
+    for (const auto& gpuScopes : s_GPUScopes)
+    {
+      if (gpuScopes != nullptr)
+      {
+        CopyLastGPUScopes(*gpuScopes, gpuScopes->GetCount(), ref_profilingData.m_GPUScopes.ExpandAndGetRef());
       }
     }
   }
 
-  ref_profilingData.m_uiFrameCount = s_uiFrameCount;
-
-  ref_profilingData.m_FrameStartTimes.SetCountUninitialized(s_FrameStartTimes.GetCount());
-  for (ezUInt32 i = 0; i < s_FrameStartTimes.GetCount(); ++i)
+  if (bClearAfterCapture)
   {
-    ref_profilingData.m_FrameStartTimes[i] = s_FrameStartTimes[i];
+    Clear();
   }
+}
+
+// static
+void ezProfilingSystem::CaptureNewData(ezProfilingSystem::ProfilingData& ref_profilingData, CaptureCursor& inout_cursor)
+{
+  ref_profilingData.Clear();
+
+  ref_profilingData.m_uiFramesThreadID = 0;
+#  if EZ_ENABLED(EZ_SUPPORTS_PROCESSES)
+  ref_profilingData.m_uiProcessID = ezProcess::GetCurrentProcessID();
+#  else
+  ref_profilingData.m_uiProcessID = 0;
+#  endif
+
+  GetThreadInfos(ref_profilingData.m_ThreadInfos);
 
-  if (!s_GPUScopes.IsEmpty())
   {
-    for (const auto& gpuScopes : s_GPUScopes)
+    EZ_LOCK(s_AllCpuScopesMutex);
+
+    for (CpuScopesBufferBase* pSourceEventBuffer : s_AllCpuScopes)
     {
-      if (gpuScopes != nullptr)
-      {
-        ezDynamicArray<GPUScope>& gpuScopesCopy = ref_profilingData.m_GPUScopes.ExpandAndGetRef();
-        gpuScopesCopy.SetCountUninitialized(gpuScopes->GetCount());
-        for (ezUInt32 i = 0; i < gpuScopes->GetCount(); ++i)
-        {
-          const GPUScope& sourceGpuDat = (*gpuScopes)[i];
+      ezUInt64& uiNumCaptured = inout_cursor.m_NumCPUScopesPerThread[pSourceEventBuffer->m_uiThreadId];
+      const ezUInt32 uiNumNew = static_cast<ezUInt32>(ezMath::Min<ezUInt64>(pSourceEventBuffer->m_uiNumScopesAdded - uiNumCaptured, GetNumScopes(pSourceEventBuffer)));
+      uiNumCaptured = pSourceEventBuffer->m_uiNumScopesAdded;
 
-          GPUScope& copiedGpuData = gpuScopesCopy[i];
-          copiedGpuData.m_BeginTime = sourceGpuDat.m_BeginTime;
-          copiedGpuData.m_EndTime = sourceGpuDat.m_EndTime;
-          ezStringUtils::Copy(copiedGpuData.m_szName, GPUScope::NAME_SIZE, sourceGpuDat.m_szName);
-        }
+      if (uiNumNew > 0)
+      {
+        CopyLastScopes(pSourceEventBuffer, uiNumNew, ref_profilingData.m_AllEventBuffers.ExpandAndGetRef());
       }
     }
   }
 
-  if (bClearAfterCapture)
+  EZ_LOCK(s_FramesAndGPUScopesMutex);
+
   {
-    Clear();
+    const ezUInt32 uiNumNewFrames = static_cast<ezUInt32>(ezMath::Min<ezUInt64>(s_uiFrameCount - inout_cursor.m_uiFrameCount, s_FrameStartTimes.GetCount()));
+    inout_cursor.m_uiFrameCount = s_uiFrameCount;
+
+    ref_profilingData.m_uiFrameCount = s_uiFrameCount;
+    ref_profilingData.m_FrameStartTimes.SetCountUninitialized(uiNumNewFrames);
+    for (ezUInt32 i = 0; i < uiNumNewFrames; ++i)
+    {
+      ref_profilingData.m_FrameStartTimes[i] = s_FrameStartTimes[s_FrameStartTimes.GetCount() - uiNumNewFrames + i];
+    }
+  }
+
+  inout_cursor.m_NumGPUScopes.SetCount(s_GPUScopes.GetCount());
+  for (ezUInt32 uiGpuIndex = 0; uiGpuIndex < s_GPUScopes.GetCount(); ++uiGpuIndex)
+  {
+    if (s_GPUScopes[uiGpuIndex] == nullptr)
+      continue;
+
+    const GPUScopesBuffer& gpuScopes = *s_GPUScopes[uiGpuIndex];
+    const ezUInt32 uiNumNew = static_cast<ezUInt32>(ezMath::Min<ezUInt64>(s_NumGPUScopesAdded[uiGpuIndex] - inout_cursor.m_NumGPUScopes[uiGpuIndex], gpuScopes.GetCount()));
+    inout_cursor.m_NumGPUScopes[uiGpuIndex] = s_NumGPUScopesAdded[uiGpuIndex];
+
+    CopyLastGPUScopes(gpuScopes, uiNumNew, ref_profilingData.m_GPUScopes.ExpandAndGetRef());
   }
 }
 
@@ -664,14 +753,22 @@ ezUInt64 ezProfilingSystem::GetFrameCount()
 // static
 void ezProfilingSystem::StartNewFrame()
 {
-  ++s_uiFrameCount;
+  ezUInt64 uiFrameCount = 0;
 
-  if (!s_FrameStartTimes.CanAppend())
   {
-    s_FrameStartTimes.PopFront();
+    EZ_LOCK(s_FramesAndGPUScopesMutex);
+
+    uiFrameCount = ++s_uiFrameCount;
+
+    if (!s_FrameStartTimes.CanAppend())
+    {
+      s_FrameStartTimes.PopFront();
+    }
+
+    s_FrameStartTimes.PushBack(ezTime::Now());
   }
 
-  s_FrameStartTimes.PushBack(ezTime::Now());
+  ezFastProfilingSystem::StartNewFrame(uiFrameCount);
 }
 
 // static
@@ -720,6 +817,7 @@ void ezProfilingSystem::AddCPUScope(ezStringView sName, const char* szFunctionNa
     }
 
     pMainThreadBuffer->m_Data.PushBack(scope);
+    ++pMainThreadBuffer->m_uiNumScopesAdded;
   }
   else
   {
@@ -730,6 +828,7 @@ void ezProfilingSystem::AddCPUScope(ezStringView sName, const char* szFunctionNa
     }
 
     pOtherThreadBuffer->m_Data.PushBack(scope);
+    ++pOtherThreadBuffer->m_uiNumScopesAdded;
   }
 
   if (scopeTimeout.IsPositive() && duration > scopeTimeout && s_ScopeTimeoutCallback.IsValid())
@@ -745,6 +844,8 @@ void ezProfilingSystem::Initialize()
 
   s_MainThreadId = (ezUInt64)ezThreadUtils::GetCurrentThreadID();
 
+  ezFastProfilingSystem::Initialize();
+
   s_PluginEventSubscription = ezPlugin::Events().AddEventHandler(&PluginEvent);
 }
 
@@ -796,17 +897,30 @@ void ezProfilingSystem::SetThreadName(ezStringView sThreadName)
 // static
 void ezProfilingSystem::RemoveThread()
 {
+  ezFastProfilingSystem::RemoveThread();
+
   EZ_LOCK(s_ThreadInfosMutex);
 
   s_DeadThreadIDs.PushBack((ezUInt64)ezThreadUtils::GetCurrentThreadID());
 }
 
+// static
+void ezProfilingSystem::GetThreadInfos(ezHybridArray<ThreadInfo, 16>& out_threadInfos)
+{
+  EZ_LOCK(s_ThreadInfosMutex);
+
+  out_threadInfos = s_ThreadInfos;
+}
+
 // static
 void ezProfilingSystem::InitializeGPUData(ezUInt32 uiGpuCount)
 {
+  EZ_LOCK(s_FramesAndGPUScopesMutex);
+
   if (s_GPUScopes.GetCount() < uiGpuCount)
   {
     s_GPUScopes.SetCount(uiGpuCount);
+    s_NumGPUScopesAdded.SetCount(uiGpuCount);
   }
 
   for (auto& gpuScopes : s_GPUScopes)
@@ -824,6 +938,8 @@ void ezProfilingSystem::AddGPUScope(ezStringView sName, ezTime beginTime, ezTime
   if (endTime - beginTime < ezTime::MakeFromMilliseconds(cvar_ProfilingDiscardThresholdMS))
     return;
 
+  EZ_LOCK(s_FramesAndGPUScopesMutex);
+
   if (!s_GPUScopes[uiGpuIndex]->CanAppend())
   {
     s_GPUScopes[uiGpuIndex]->PopFront();
@@ -835,6 +951,7 @@ void ezProfilingSystem::AddGPUScope(ezStringView sName, ezTime beginTime, ezTime
   ezStringUtils::Copy(scope.m_szName, EZ_ARRAY_SIZE(scope.m_szName), sName.GetStartPointer(), sName.GetEndPointer());
 
   s_GPUScopes[uiGpuIndex]->PushBack(scope);
+  ++s_NumGPUScopesAdded[uiGpuIndex];
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -899,6 +1016,8 @@ void ezProfilingSystem::Clear() {}
 
 void ezProfilingSystem::Capture(ezProfilingSystem::ProfilingData& out_Capture, bool bClearAfterCapture) {}
 
+void ezProfilingSystem::CaptureNewData(ezProfilingSystem::ProfilingData& out_Capture, CaptureCursor& inout_cursor) {}
+
 void ezProfilingSystem::SetDiscardThreshold(ezTime threshold) {}
 
 void ezProfilingSystem::StartNewFrame() {}
@@ -913,6 +1032,8 @@ void ezProfilingSystem::SetThreadName(ezStringView sThreadName) {}
 
 void ezProfilingSystem::RemoveThread() {}
 
+void ezProfilingSystem::GetThreadInfos(ezHybridArray<ThreadInfo, 16>& out_threadInfos) {}
+
 void ezProfilingSystem::InitializeGPUData(ezUInt32 gpuCount) {}
 
 void ezProfilingSystem::AddGPUScope(ezStringView sName, ezTime beginTime, ezTime endTime, ezUInt32 gpuIndex) {}
@@ -2,6 +2,7 @@
 
 #include <Foundation/Basics.h>
 #include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
 #include <Foundation/Containers/StaticRingBuffer.h>
 #include <Foundation/System/Process.h>
 #include <Foundation/Time/Time.h>
@@ -119,11 +120,24 @@ public:
     static void Merge(ProfilingData& out_merged, ezArrayPtr<const ProfilingData*> inputs);
   };
 
+  /// \brief Remembers which scopes and frames were already returned by CaptureNewData().
+  struct CaptureCursor
+  {
+    ezHashTable<ezUInt64, ezUInt64> m_NumCPUScopesPerThread;
+    ezDynamicArray<ezUInt64> m_NumGPUScopes;
+    ezUInt64 m_uiFrameCount = 0;
+  };
+
 public:
   static void Clear();
 
   static void Capture(ezProfilingSystem::ProfilingData& out_capture, bool bClearAfterCapture = false);
 
+  /// \brief Like Capture(), but only returns the scopes and frame start times that were added since the last call with the same cursor.
+  ///
+  /// Data that was already overwritten in the internal ring buffers in the meantime is skipped.
+  static void CaptureNewData(ezProfilingSystem::ProfilingData& out_capture, CaptureCursor& inout_cursor);
+
   /// \brief Scopes are discarded if their duration is shorter than the specified threshold. Default is 0.1ms.
   static void SetDiscardThreshold(ezTime threshold);
 
@@ -155,6 +169,11 @@ private:
   ///  Needs to be called before the thread exits to be able to release profiling memory of dead threads on Reset.
   static void RemoveThread();
 
+  friend class ezFastProfilingStream;
+
+  /// \brief Copies the names of all known threads.
+  static void GetThreadInfos(ezHybridArray<ThreadInfo, 16>& out_threadInfos);
+
 public:
   /// \brief Initialized internal data structures for GPU profiling data. Needs to be called before adding any data.
   static void InitializeGPUData(ezUInt32 uiGpuCount = 1);
@@ -14,7 +14,8 @@ class ezTempHashedString;
 /// (it's a pointer comparison).\n
 /// Copying ezHashedString objects around and assigning between them is very fast as well.\n
 /// \n
-/// Assigning from some other string type is rather slow though, as it requires thread synchronization.\n
+/// Assigning from some other string type is rather slow though, as it requires hashing the string and looking it up in the central storage.
+/// Looking up a string that is already stored does not take a lock, only adding a new string locks one of the storage's shards.\n
 /// You can also get access to the actual string data via GetString().\n
 /// \n
 /// You should use ezHashedString whenever the size of the encapsulating object is important and when changes to the string itself
@@ -26,15 +27,28 @@ class EZ_FOUNDATION_DLL ezHashedString
 public:
   struct HashedData
   {
+    ezUInt64 m_uiHash = 0;
 #if EZ_ENABLED(EZ_HASHED_STRING_REF_COUNTING)
     ezAtomicInteger32 m_iRefCount;
 #endif
     ezString m_sString;
   };
 
-  // Do NOT use a hash-table! The map does not relocate memory when it resizes, which is a vital aspect for the hashed strings to work.
-  using StringStorage = ezMap<ezUInt64, HashedData, ezCompareHelper<ezUInt64>, ezStaticsAllocatorWrapper>;
-  using HashedType = StringStorage::Iterator;
+  // The data is allocated in an arena and never relocated, which is a vital aspect for the hashed strings to work.
+  using HashedType = HashedData*;
+
+  /// \brief Describes how much memory the central string storage uses.
+  struct MemoryStatistics
+  {
+    ezUInt32 m_uiNumStrings = 0;
+    ezUInt64 m_uiStringBytes = 0;     ///< The length of all stored strings, including their terminators.
+    ezUInt64 m_uiEntryBytes = 0;      ///< The arena memory for the entries. Short strings are stored inside their entry.
+    ezUInt64 m_uiStringHeapBytes = 0; ///< The memory allocated for strings that don't fit into their entry.
+    ezUInt64 m_uiTableBytes = 0;      ///< The memory for the lookup tables, including old tables that are kept alive for concurrent readers.
+  };
+
+  /// \brief Returns how much memory the central string storage currently uses.
+  static MemoryStatistics GetMemoryStatistics(); // [tested]
 
 #if EZ_ENABLED(EZ_HASHED_STRING_REF_COUNTING)
   /// \brief This will remove all hashed strings from the central storage, that are not referenced anymore.
@@ -45,6 +59,8 @@ public:
   /// This function will clean up all unused strings. It should typically not be necessary to call this function at all, unless lots of
   /// strings get stored in ezHashedString that are not really used throughout the applications life time.
   ///
+  /// The memory of long strings is freed and the entries of the removed strings are reused for strings that are added later.
+  ///
   /// Returns the number of unused strings that were removed.
   static ezUInt32 ClearUnusedStrings();
 #endif
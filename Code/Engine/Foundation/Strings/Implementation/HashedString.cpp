@@ -1,59 +1,306 @@
 #include <Foundation/FoundationPCH.h>
 
+#include <Foundation/Containers/DynamicArray.h>
 #include <Foundation/Logging/Log.h>
 #include <Foundation/Strings/HashedString.h>
 #include <Foundation/Threading/Lock.h>
 #include <Foundation/Threading/Mutex.h>
 
-struct HashedStringData
+#include <atomic>
+
+namespace
 {
-  ezMutex m_Mutex;
-  ezHashedString::StringStorage m_Storage;
-  ezHashedString::HashedType m_Empty;
-};
+  using HashedData = ezHashedString::HashedData;
 
-static HashedStringData* s_pHSData;
+  /// The storage is split into shards by the lower bits of the hash, so adding strings on different threads rarely waits for the same mutex.
+  constexpr ezUInt32 s_uiNumHashedStringShardBits = 5;
+  constexpr ezUInt32 s_uiNumHashedStringShards = 1u << s_uiNumHashedStringShardBits;
+  constexpr ezUInt32 s_uiMinHashedStringTableSize = 64;
+  constexpr ezUInt32 s_uiMinHashedStringChunkSize = 16;
+  constexpr ezUInt32 s_uiMaxHashedStringChunkSize = 1024;
 
-EZ_MSVC_ANALYSIS_WARNING_PUSH
-EZ_MSVC_ANALYSIS_WARNING_DISABLE(6011) // Disable warning for null pointer dereference as InitHashedString() will ensure that s_pHSData is set
+  /// Marks a slot whose string was removed by ezHashedString::ClearUnusedStrings(). Lookups have to probe past it.
+  EZ_ALWAYS_INLINE HashedData* GetRemovedHashedStringMarker()
+  {
+    return reinterpret_cast<HashedData*>(static_cast<uintptr_t>(1));
+  }
 
-// static
-ezHashedString::HashedType ezHashedString::AddHashedString(ezStringView sString, ezUInt64 uiHash)
-{
-  if (s_pHSData == nullptr)
-    InitHashedString();
+#if EZ_ENABLED(EZ_HASHED_STRING_REF_COUNTING)
+  /// The reference count of removed entries. Lookups that still find such an entry increment it temporarily, so it must stay far from zero.
+  constexpr ezInt32 s_iRemovedHashedStringRefCount = -(1 << 30);
+#endif
+
+  /// The hash is stored next to the entry, so that lock-free lookups never have to read an entry that they don't hold a reference to.
+  /// Entries of removed strings get reused for other strings, lookups that still see them in an old slot must not read their data.
+  struct HashedStringSlot
+  {
+    std::atomic<ezUInt64> m_uiHash{0};
+    std::atomic<HashedData*> m_pData{nullptr};
+  };
+
+  /// Open addressing table with linear probing. Readers access it without a lock, therefore slots are only ever written with
+  /// release semantics and a table is never modified anymore, once it has been replaced by a larger one.
+  struct HashedStringTable
+  {
+    ezUInt32 m_uiMask = 0;
+    HashedStringSlot* m_pSlots = nullptr;
+    HashedStringTable* m_pNextRetired = nullptr;
+  };
+
+  /// A block of the arena that stores the entries. Entries are never moved or freed, so ezHashedString can point to them.
+  struct HashedStringChunk
+  {
+    HashedStringChunk* m_pNext = nullptr;
+    ezUInt32 m_uiCapacity = 0;
+    ezUInt32 m_uiCount = 0;
+
+    EZ_ALWAYS_INLINE HashedData* GetEntries() { return reinterpret_cast<HashedData*>(this + 1); }
+  };
+
+  static_assert(sizeof(HashedStringChunk) % EZ_ALIGNMENT_OF(HashedData) == 0, "The entries directly follow the chunk header");
+
+  // aligned to a cache line, so that adding a string in one shard doesn't slow down the readers of its neighbors
+  struct alignas(64) HashedStringShard
+  {
+    ezMutex m_Mutex;
+    std::atomic<HashedStringTable*> m_pTable{nullptr};
+    ezUInt32 m_uiNumUsedSlots = 0; ///< Includes removed slots, they only get cleaned up when the table grows.
+    ezUInt32 m_uiNumStrings = 0;
+    HashedStringTable* m_pRetiredTables = nullptr; ///< Concurrent readers may still look at these, so they are kept alive.
+    HashedStringChunk* m_pChunks = nullptr;        ///< The newest chunk comes first.
+    ezDynamicArray<HashedData*, ezStaticsAllocatorWrapper> m_FreeEntries; ///< Entries of removed strings, reused before the arena grows.
+  };
+
+  HashedStringTable* CreateHashedStringTable(ezUInt32 uiNumSlots)
+  {
+    const size_t uiSize = sizeof(HashedStringTable) + uiNumSlots * sizeof(HashedStringSlot);
+    HashedStringTable* pTable = new (ezFoundation::GetStaticsAllocator()->Allocate(uiSize, EZ_ALIGNMENT_OF(HashedStringSlot))) HashedStringTable();
+    pTable->m_uiMask = uiNumSlots - 1;
+    pTable->m_pSlots = reinterpret_cast<HashedStringSlot*>(pTable + 1);
+
+    for (ezUInt32 i = 0; i < uiNumSlots; ++i)
+    {
+      new (&pTable->m_pSlots[i]) HashedStringSlot();
+    }
+
+    return pTable;
+  }
+
+  EZ_ALWAYS_INLINE ezUInt32 GetHashedStringTableSize(const HashedStringTable* pTable)
+  {
+    return sizeof(HashedStringTable) + (pTable->m_uiMask + 1) * sizeof(HashedStringSlot);
+  }
+
+  EZ_ALWAYS_INLINE ezUInt32 GetFirstHashedStringSlot(const HashedStringTable* pTable, ezUInt64 uiHash)
+  {
+    // the lower bits already selected the shard
+    return static_cast<ezUInt32>(uiHash >> s_uiNumHashedStringShardBits) & pTable->m_uiMask;
+  }
 
-  EZ_LOCK(s_pHSData->m_Mutex);
+  HashedData* FindHashedString(const HashedStringTable* pTable, ezUInt64 uiHash)
+  {
+    // the table is never more than half full, so there is always an empty slot that ends the search
+    for (ezUInt32 uiSlot = GetFirstHashedStringSlot(pTable, uiHash);; uiSlot = (uiSlot + 1) & pTable->m_uiMask)
+    {
+      const HashedStringSlot& slot = pTable->m_pSlots[uiSlot];
+      HashedData* pData = slot.m_pData.load(std::memory_order_acquire);
+
+      if (pData == nullptr)
+        return nullptr;
+
+      if (pData != GetRemovedHashedStringMarker() && slot.m_uiHash.load(std::memory_order_relaxed) == uiHash)
+        return pData;
+    }
+  }
+
+  /// Returns false if ezHashedString::ClearUnusedStrings() removed the string in the meantime, or if its entry now holds another string.
+  EZ_ALWAYS_INLINE bool TryAddHashedStringReference(HashedData* pData, ezUInt64 uiHash)
+  {
+#if EZ_ENABLED(EZ_HASHED_STRING_REF_COUNTING)
+    // the reference prevents the entry from being removed and reused, only then its data can be read
+    if (pData->m_iRefCount.Increment() > 0 && pData->m_uiHash == uiHash)
+      return true;
 
-  // try to find the existing string
-  bool bExisted = false;
-  auto ret = s_pHSData->m_Storage.FindOrAdd(uiHash, &bExisted);
+    pData->m_iRefCount.Decrement();
+    return false;
+#else
+    EZ_IGNORE_UNUSED(pData);
+    EZ_IGNORE_UNUSED(uiHash);
+    return true;
+#endif
+  }
 
-  // if it already exists, just increase the refcount
-  if (bExisted)
+  EZ_ALWAYS_INLINE void CheckForHashCollision(const HashedData* pData, ezStringView sString)
   {
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
-    if (ret.Value().m_sString != sString)
+    if (pData->m_sString != sString)
     {
       // TODO: I think this should be a more serious issue
-      ezLog::Error("Hash collision encountered: Strings \"{}\" and \"{}\" both hash to {}.", ezArgSensitive(ret.Value().m_sString), ezArgSensitive(sString), uiHash);
+      ezLog::Error("Hash collision encountered: Strings \"{}\" and \"{}\" both hash to {}.", ezArgSensitive(pData->m_sString), ezArgSensitive(sString), pData->m_uiHash);
     }
+#else
+    EZ_IGNORE_UNUSED(pData);
+    EZ_IGNORE_UNUSED(sString);
 #endif
+  }
+
+  /// Must be called with the shard's mutex held. The entry counts as removed until InitHashedStringEntry() is called.
+  HashedData* AllocateHashedStringEntry(HashedStringShard& shard)
+  {
+    if (!shard.m_FreeEntries.IsEmpty())
+    {
+      HashedData* pData = shard.m_FreeEntries.PeekBack();
+      shard.m_FreeEntries.PopBack();
+      return pData;
+    }
 
+    HashedStringChunk* pChunk = shard.m_pChunks;
+
+    if (pChunk == nullptr || pChunk->m_uiCount == pChunk->m_uiCapacity)
+    {
+      const ezUInt32 uiCapacity = pChunk == nullptr ? s_uiMinHashedStringChunkSize : ezMath::Min(pChunk->m_uiCapacity * 2, s_uiMaxHashedStringChunkSize);
+      const size_t uiSize = sizeof(HashedStringChunk) + uiCapacity * sizeof(HashedData);
+
+      HashedStringChunk* pNewChunk = new (ezFoundation::GetStaticsAllocator()->Allocate(uiSize, EZ_ALIGNMENT_OF(HashedData))) HashedStringChunk();
+      pNewChunk->m_pNext = pChunk;
+      pNewChunk->m_uiCapacity = uiCapacity;
+
+      shard.m_pChunks = pNewChunk;
+      pChunk = pNewChunk;
+    }
+
+    HashedData* pData = new (&pChunk->GetEntries()[pChunk->m_uiCount++]) HashedData();
 #if EZ_ENABLED(EZ_HASHED_STRING_REF_COUNTING)
-    ret.Value().m_iRefCount.Increment();
+    pData->m_iRefCount = s_iRemovedHashedStringRefCount;
 #endif
+    return pData;
   }
-  else
+
+  /// Must be called with the shard's mutex held, before the entry is published in a slot.
+  void InitHashedStringEntry(HashedData* pData, ezStringView sString, ezUInt64 uiHash)
   {
-    ezHashedString::HashedData& d = ret.Value();
+    pData->m_uiHash = uiHash;
+    pData->m_sString = sString;
+
 #if EZ_ENABLED(EZ_HASHED_STRING_REF_COUNTING)
-    d.m_iRefCount = 1;
+    // Lookups that still find a reused entry in an old slot may be in the middle of incrementing and decrementing its reference count,
+    // so it is offset instead of overwritten. This also makes the data written above visible to every lookup that gets a reference.
+    pData->m_iRefCount.Add(1 - s_iRemovedHashedStringRefCount);
 #endif
-    d.m_sString = sString;
   }
 
-  return ret;
+  /// Must be called with the shard's mutex held. Makes room for one more string.
+  void GrowHashedStringTable(HashedStringShard& shard)
+  {
+    HashedStringTable* pOldTable = shard.m_pTable.load(std::memory_order_relaxed);
+
+    if (pOldTable != nullptr && (shard.m_uiNumUsedSlots + 1) * 2 <= pOldTable->m_uiMask + 1)
+      return;
+
+    const ezUInt32 uiNumSlots = ezMath::Max(s_uiMinHashedStringTableSize, ezMath::PowerOfTwo_Ceil((shard.m_uiNumStrings + 1) * 4));
+    HashedStringTable* pNewTable = CreateHashedStringTable(uiNumSlots);
+
+    if (pOldTable != nullptr)
+    {
+      for (ezUInt32 i = 0; i <= pOldTable->m_uiMask; ++i)
+      {
+        HashedData* pData = pOldTable->m_pSlots[i].m_pData.load(std::memory_order_relaxed);
+        if (pData == nullptr || pData == GetRemovedHashedStringMarker())
+          continue;
+
+        ezUInt32 uiSlot = GetFirstHashedStringSlot(pNewTable, pData->m_uiHash);
+        while (pNewTable->m_pSlots[uiSlot].m_pData.load(std::memory_order_relaxed) != nullptr)
+        {
+          uiSlot = (uiSlot + 1) & pNewTable->m_uiMask;
+        }
+
+        pNewTable->m_pSlots[uiSlot].m_uiHash.store(pData->m_uiHash, std::memory_order_relaxed);
+        pNewTable->m_pSlots[uiSlot].m_pData.store(pData, std::memory_order_relaxed);
+      }
+
+      pOldTable->m_pNextRetired = shard.m_pRetiredTables;
+      shard.m_pRetiredTables = pOldTable;
+    }
+
+    shard.m_uiNumUsedSlots = shard.m_uiNumStrings;
+    shard.m_pTable.store(pNewTable, std::memory_order_release);
+  }
+
+  struct HashedStringData
+  {
+    HashedStringShard m_Shards[s_uiNumHashedStringShards];
+    ezHashedString::HashedType m_Empty;
+  };
+} // namespace
+
+static HashedStringData* s_pHSData;
+
+EZ_MSVC_ANALYSIS_WARNING_PUSH
+EZ_MSVC_ANALYSIS_WARNING_DISABLE(6011) // Disable warning for null pointer dereference as InitHashedString() will ensure that s_pHSData is set
+
+// static
+ezHashedString::HashedType ezHashedString::AddHashedString(ezStringView sString, ezUInt64 uiHash)
+{
+  if (s_pHSData == nullptr)
+    InitHashedString();
+
+  HashedStringShard& shard = s_pHSData->m_Shards[uiHash & (s_uiNumHashedStringShards - 1)];
+
+  // strings are typically added once and looked up many times, so first try to find it without taking the lock
+  if (const HashedStringTable* pTable = shard.m_pTable.load(std::memory_order_acquire))
+  {
+    HashedData* pData = FindHashedString(pTable, uiHash);
+    if (pData != nullptr && TryAddHashedStringReference(pData, uiHash))
+    {
+      CheckForHashCollision(pData, sString);
+      return pData;
+    }
+  }
+
+  EZ_LOCK(shard.m_Mutex);
+
+  // another thread might have added the string in the meantime
+  if (const HashedStringTable* pTable = shard.m_pTable.load(std::memory_order_relaxed))
+  {
+    // removing strings also requires the lock, so the reference can't fail here
+    HashedData* pData = FindHashedString(pTable, uiHash);
+    if (pData != nullptr && TryAddHashedStringReference(pData, uiHash))
+    {
+      CheckForHashCollision(pData, sString);
+      return pData;
+    }
+  }
+
+  GrowHashedStringTable(shard);
+
+  HashedData* pData = AllocateHashedStringEntry(shard);
+  InitHashedStringEntry(pData, sString, uiHash);
+
+  // a removed slot can be reused, the string can't be stored further along, because the lookup above didn't find it
+  HashedStringTable* pTable = shard.m_pTable.load(std::memory_order_relaxed);
+  ezUInt32 uiSlot = GetFirstHashedStringSlot(pTable, uiHash);
+  while (true)
+  {
+    HashedData* pSlotData = pTable->m_pSlots[uiSlot].m_pData.load(std::memory_order_relaxed);
+
+    if (pSlotData == nullptr)
+    {
+      ++shard.m_uiNumUsedSlots;
+      break;
+    }
+
+    if (pSlotData == GetRemovedHashedStringMarker())
+      break;
+
+    uiSlot = (uiSlot + 1) & pTable->m_uiMask;
+  }
+
+  // publishes the fully initialized entry to the readers
+  pTable->m_pSlots[uiSlot].m_uiHash.store(uiHash, std::memory_order_relaxed);
+  pTable->m_pSlots[uiSlot].m_pData.store(pData, std::memory_order_release);
+  ++shard.m_uiNumStrings;
+
+  return pData;
 }
 
 EZ_MSVC_ANALYSIS_WARNING_POP
@@ -72,32 +319,94 @@ void ezHashedString::InitHashedString()
 
 #if EZ_ENABLED(EZ_HASHED_STRING_REF_COUNTING)
   // this one should never get deleted, so make sure its refcount is 2
-  s_pHSData->m_Empty.Value().m_iRefCount.Increment();
+  s_pHSData->m_Empty->m_iRefCount.Increment();
 #endif
 }
 
 #if EZ_ENABLED(EZ_HASHED_STRING_REF_COUNTING)
 ezUInt32 ezHashedString::ClearUnusedStrings()
 {
-  EZ_LOCK(s_pHSData->m_Mutex);
-
   ezUInt32 uiDeleted = 0;
 
-  for (auto it = s_pHSData->m_Storage.GetIterator(); it.IsValid();)
+  for (HashedStringShard& shard : s_pHSData->m_Shards)
   {
-    if (it.Value().m_iRefCount == 0)
+    EZ_LOCK(shard.m_Mutex);
+
+    HashedStringTable* pTable = shard.m_pTable.load(std::memory_order_relaxed);
+    if (pTable == nullptr)
+      continue;
+
+    for (ezUInt32 i = 0; i <= pTable->m_uiMask; ++i)
     {
-      it = s_pHSData->m_Storage.Remove(it);
+      HashedData* pData = pTable->m_pSlots[i].m_pData.load(std::memory_order_relaxed);
+      if (pData == nullptr || pData == GetRemovedHashedStringMarker())
+        continue;
+
+      // a concurrent lookup may revive the string at any time, in that case it has to stay
+      if (!pData->m_iRefCount.TestAndSet(0, s_iRemovedHashedStringRefCount))
+        continue;
+
+      pTable->m_pSlots[i].m_pData.store(GetRemovedHashedStringMarker(), std::memory_order_release);
+      --shard.m_uiNumStrings;
       ++uiDeleted;
+
+      // lookups that still see the entry fail to add a reference and never touch its data, so the entry can be reused right away
+      pData->m_sString.~ezString();
+      new (&pData->m_sString) ezString();
+      shard.m_FreeEntries.PushBack(pData);
     }
-    else
-      ++it;
   }
 
   return uiDeleted;
 }
 #endif
 
+// static
+ezHashedString::MemoryStatistics ezHashedString::GetMemoryStatistics()
+{
+  if (s_pHSData == nullptr)
+    InitHashedString();
+
+  MemoryStatistics stats;
+
+  for (HashedStringShard& shard : s_pHSData->m_Shards)
+  {
+    EZ_LOCK(shard.m_Mutex);
+
+    stats.m_uiNumStrings += shard.m_uiNumStrings;
+
+    if (const HashedStringTable* pTable = shard.m_pTable.load(std::memory_order_relaxed))
+    {
+      stats.m_uiTableBytes += GetHashedStringTableSize(pTable);
+    }
+
+    for (const HashedStringTable* pTable = shard.m_pRetiredTables; pTable != nullptr; pTable = pTable->m_pNextRetired)
+    {
+      stats.m_uiTableBytes += GetHashedStringTableSize(pTable);
+    }
+
+    for (HashedStringChunk* pChunk = shard.m_pChunks; pChunk != nullptr; pChunk = pChunk->m_pNext)
+    {
+      stats.m_uiEntryBytes += sizeof(HashedStringChunk) + pChunk->m_uiCapacity * sizeof(HashedData);
+
+      for (ezUInt32 i = 0; i < pChunk->m_uiCount; ++i)
+      {
+        const HashedData& data = pChunk->GetEntries()[i];
+
+#if EZ_ENABLED(EZ_HASHED_STRING_REF_COUNTING)
+        if (data.m_iRefCount < 0)
+          continue;
+#endif
+
+        stats.m_uiStringBytes += data.m_sString.GetElementCount() + 1;
+        stats.m_uiStringHeapBytes += data.m_sString.GetHeapMemoryUsage();
+      }
+    }
+  }
+
+  return stats;
+}
+
 EZ_MSVC_ANALYSIS_WARNING_PUSH
 EZ_MSVC_ANALYSIS_WARNING_DISABLE(6011) // Disable warning for null pointer dereference as InitHashedString() will ensure that s_pHSData is set
 
@@ -112,7 +421,7 @@ ezHashedString::ezHashedString()
 
   m_Data = s_pHSData->m_Empty;
 #if EZ_ENABLED(EZ_HASHED_STRING_REF_COUNTING)
-  m_Data.Value().m_iRefCount.Increment();
+  m_Data->m_iRefCount.Increment();
 #endif
 }
 
@@ -131,13 +440,11 @@ void ezHashedString::Clear()
     HashedType tmp = m_Data;
 
     m_Data = s_pHSData->m_Empty;
-    m_Data.Value().m_iRefCount.Increment();
+    m_Data->m_iRefCount.Increment();
 
-    tmp.Value().m_iRefCount.Decrement();
+    tmp->m_iRefCount.Decrement();
   }
 #else
   m_Data = s_pHSData->m_Empty;
 #endif
 }
-
-
@@ -1,7 +1,12 @@
 #include <Foundation/FoundationPCH.h>
 
+#include <Foundation/Algorithm/HashingUtils.h>
+#include <Foundation/Threading/Implementation/TaskSystemState.h>
+#include <Foundation/Threading/Lock.h>
 #include <Foundation/Threading/TaskSystem.h>
 
+#include <atomic>
+
 /// \brief This is a helper class that splits up task items via index ranges.
 template <typename IndexType, typename Callback>
 class IndexedTask final : public ezTask
@@ -71,7 +76,7 @@ void ParallelForIndexedInternal(IndexType uiStartIndex, IndexType uiNumItems, Ca
     pIndexedTask->ConfigureTask(szTaskName, ezTaskNesting::Never);
 
     pIndexedTask->SetMultiplicity(uiMultiplicity);
-    ezTaskGroupID taskGroupId = ezTaskSystem::StartSingleTask(pIndexedTask, ezTaskPriority::EarlyThisFrame);
+    ezTaskGroupID taskGroupId = ezTaskSystem::StartSingleTask(pIndexedTask, params.m_TaskPriority);
     ezTaskSystem::WaitForGroup(taskGroupId);
   }
 }
@@ -129,13 +134,233 @@ void ezParallelForParams::DetermineThreading(ezUInt64 uiNumItemsToExecute, ezUIn
   }
 }
 
+namespace
+{
+  /// \brief The per-item cost that was measured for one adaptive ParallelFor call site, identified by the hash of its task name.
+  struct ezParallelForCost
+  {
+    std::atomic<ezUInt32> m_uiNameHash = 0;
+    std::atomic<float> m_fNanosecondsPerItem = 0.0f;
+  };
+
+  // A small hash table with linear probing, so that looking up and adding call sites never locks or allocates.
+  // Once it is full, additional call sites don't learn their cost anymore.
+  static constexpr ezUInt32 s_uiMaxParallelForCallSites = 256;
+  static constexpr ezUInt32 s_uiMaxParallelForProbes = 16;
+  static ezParallelForCost s_ParallelForCosts[s_uiMaxParallelForCallSites];
+
+  // Batches should take about this long. Long enough that the overhead of splitting and scheduling is negligible,
+  // short enough that idle threads get work quickly.
+  static constexpr double s_fTargetBatchNanoseconds = 50000.0;
+
+  ezParallelForCost* FindParallelForCost(const char* szTaskName, bool bAdd)
+  {
+    ezUInt32 uiHash = ezHashingUtils::StringHashTo32(ezHashingUtils::StringHash(ezStringView(szTaskName)));
+    uiHash = (uiHash != 0) ? uiHash : 1; // zero marks unused entries
+
+    for (ezUInt32 i = 0; i < s_uiMaxParallelForProbes; ++i)
+    {
+      ezParallelForCost& entry = s_ParallelForCosts[(uiHash + i) % s_uiMaxParallelForCallSites];
+      ezUInt32 uiEntryHash = entry.m_uiNameHash.load(std::memory_order_acquire);
+
+      if (uiEntryHash == uiHash)
+        return &entry;
+
+      if (uiEntryHash == 0)
+      {
+        if (!bAdd)
+          return nullptr;
+
+        // if another thread claimed the entry in the meantime, it may have done so for the same name
+        if (entry.m_uiNameHash.compare_exchange_strong(uiEntryHash, uiHash, std::memory_order_acq_rel) || uiEntryHash == uiHash)
+          return &entry;
+      }
+    }
+
+    return nullptr;
+  }
+} // namespace
+
+/// \brief Shared by all threads that work on the same adaptive ParallelFor invocation. Lives on the stack of the calling thread.
+struct ezParallelForAdaptiveState
+{
+  const ezParallelForIndexedFunction64* m_pTaskCallback = nullptr;
+  const char* m_szTaskName = nullptr;
+  ezTaskNesting m_NestingMode = ezTaskNesting::Never;
+  ezTaskPriority::Enum m_TaskPriority = ezTaskPriority::EarlyThisFrame;
+  ezAllocator* m_pAllocator = nullptr; // if null, the split off tasks are taken from the pool in ezTaskSystemState
+  ezUInt64 m_uiBatchSize = 1;
+
+  ezAtomicInteger64 m_iRemainingItems;
+  ezAtomicInteger64 m_iMeasuredNanoseconds;
+};
+
+/// \brief Executes one half that was split off an adaptive ParallelFor range. Can be reused for another range once it is finished.
+class ezParallelForRangeTask final : public ezTask
+{
+public:
+  void SetRange(ezParallelForAdaptiveState* pState, ezUInt64 uiStartIndex, ezUInt64 uiEndIndex)
+  {
+    m_pState = pState;
+    m_uiStartIndex = uiStartIndex;
+    m_uiEndIndex = uiEndIndex;
+  }
+
+  virtual void Execute() override { ezTaskSystem::ParallelForAdaptiveRange(*m_pState, m_uiStartIndex, m_uiEndIndex); }
+
+private:
+  ezParallelForAdaptiveState* m_pState = nullptr;
+  ezUInt64 m_uiStartIndex = 0;
+  ezUInt64 m_uiEndIndex = 0;
+};
+
+void ezTaskSystem::ParallelForAdaptive(ezUInt64 uiStartIndex, ezUInt64 uiNumItems, const ezParallelForIndexedFunction64& taskCallback, const char* szTaskName, const ezParallelForParams& params)
+{
+  if (uiNumItems == 0)
+    return;
+
+  if (!szTaskName)
+  {
+    szTaskName = "Generic Indexed Task";
+  }
+
+  ezParallelForCost* pCost = FindParallelForCost(szTaskName, true);
+  const float fNanosecondsPerItem = (pCost != nullptr) ? pCost->m_fNanosecondsPerItem.load(std::memory_order_relaxed) : 0.0f;
+
+  ezParallelForAdaptiveState state;
+  state.m_pTaskCallback = &taskCallback;
+  state.m_szTaskName = szTaskName;
+  state.m_NestingMode = params.m_NestingMode;
+  state.m_TaskPriority = params.m_TaskPriority;
+  state.m_pAllocator = params.m_pTaskAllocator;
+  state.m_iRemainingItems = uiNumItems;
+
+  if (fNanosecondsPerItem > 0.0f)
+  {
+    // loops that are cheaper than a single batch are executed serially, as they are not worth splitting up
+    state.m_uiBatchSize = ezMath::Clamp<ezUInt64>(static_cast<ezUInt64>(s_fTargetBatchNanoseconds / fNanosecondsPerItem), 1, uiNumItems);
+  }
+  else
+  {
+    // the cost is not known yet, use a batch size that gives every thread a couple of batches
+    const ezUInt64 uiNumThreads = GetWorkerThreadCount(ezWorkerThreadType::ShortTasks) + 1;
+    state.m_uiBatchSize = ezMath::Max<ezUInt64>(1, uiNumItems / (uiNumThreads * 4));
+  }
+
+  // the calling thread works on the whole range itself and splits off work for other threads as needed
+  ParallelForAdaptiveRange(state, uiStartIndex, uiStartIndex + uiNumItems);
+
+  if (state.m_iRemainingItems != 0)
+  {
+    WaitForCondition([&state]()
+      { return state.m_iRemainingItems == 0; });
+  }
+
+  if (pCost != nullptr)
+  {
+    const float fMeasuredNanosecondsPerItem = static_cast<float>(static_cast<double>(state.m_iMeasuredNanoseconds) / uiNumItems);
+
+    // smooth out the measurements over multiple invocations, races between concurrent invocations of the same call site are benign
+    const float fNewCost = (fNanosecondsPerItem > 0.0f) ? ezMath::Lerp(fNanosecondsPerItem, fMeasuredNanosecondsPerItem, 0.25f) : fMeasuredNanosecondsPerItem;
+    pCost->m_fNanosecondsPerItem.store(ezMath::Max(fNewCost, 0.001f), std::memory_order_relaxed);
+  }
+}
+
+void ezTaskSystem::ParallelForAdaptiveRange(ezParallelForAdaptiveState& ref_state, ezUInt64 uiStartIndex, ezUInt64 uiEndIndex)
+{
+  const ezUInt64 uiBatchSize = ref_state.m_uiBatchSize;
+  ezUInt64 uiNumItemsProcessed = 0;
+
+  const ezTime tStart = ezTime::Now();
+
+  while (uiStartIndex < uiEndIndex)
+  {
+    // Lazy binary splitting: only hand off the upper half of the remaining range, when there is no other work queued that idle threads could take.
+    // Thus the range is only split as often as there are threads to work on it.
+    while (uiEndIndex - uiStartIndex > uiBatchSize && IsStarvingForWork(ref_state.m_TaskPriority))
+    {
+      const ezUInt64 uiMiddleIndex = uiStartIndex + (uiEndIndex - uiStartIndex) / 2;
+
+      ezSharedPtr<ezTask> pTask;
+
+      if (ref_state.m_pAllocator != nullptr)
+      {
+        // tasks from a user provided allocator are not pooled, that allocator may be gone long before the task system shuts down
+        pTask = EZ_NEW(ref_state.m_pAllocator, ezParallelForRangeTask);
+        pTask->ConfigureTask(ref_state.m_szTaskName, ref_state.m_NestingMode);
+      }
+      else
+      {
+        {
+          EZ_LOCK(s_pState->m_ParallelForRangeTasksMutex);
+
+          if (!s_pState->m_ParallelForRangeTasks.IsEmpty())
+          {
+            pTask = s_pState->m_ParallelForRangeTasks.PeekBack();
+            s_pState->m_ParallelForRangeTasks.PopBack();
+          }
+        }
+
+        if (pTask == nullptr)
+        {
+          pTask = EZ_DEFAULT_NEW(ezParallelForRangeTask);
+        }
+
+        // the finished callback is only called once the task is done, so it can be reused right away
+        pTask->ConfigureTask(ref_state.m_szTaskName, ref_state.m_NestingMode, [](const ezSharedPtr<ezTask>& pFinishedTask)
+          {
+            EZ_LOCK(s_pState->m_ParallelForRangeTasksMutex);
+            s_pState->m_ParallelForRangeTasks.PushBack(pFinishedTask);
+          });
+      }
+
+      static_cast<ezParallelForRangeTask*>(pTask.Borrow())->SetRange(&ref_state, uiMiddleIndex, uiEndIndex);
+      StartSingleTask(pTask, ref_state.m_TaskPriority);
+
+      uiEndIndex = uiMiddleIndex;
+    }
+
+    const ezUInt64 uiBatchEndIndex = ezMath::Min(uiStartIndex + uiBatchSize, uiEndIndex);
+    (*ref_state.m_pTaskCallback)(uiStartIndex, uiBatchEndIndex);
+
+    uiNumItemsProcessed += uiBatchEndIndex - uiStartIndex;
+    uiStartIndex = uiBatchEndIndex;
+  }
+
+  ref_state.m_iMeasuredNanoseconds.Add(static_cast<ezInt64>((ezTime::Now() - tStart).GetNanoseconds()));
+
+  // this has to be the last access to the state, the calling thread may return as soon as all items are done
+  ref_state.m_iRemainingItems.Subtract(static_cast<ezInt64>(uiNumItemsProcessed));
+}
+
+ezTime ezTaskSystem::GetParallelForItemCost(const char* szTaskName)
+{
+  const ezParallelForCost* pCost = FindParallelForCost(szTaskName, false);
+  return ezTime::MakeFromNanoseconds((pCost != nullptr) ? pCost->m_fNanosecondsPerItem.load(std::memory_order_relaxed) : 0.0);
+}
+
 void ezTaskSystem::ParallelForIndexed(ezUInt32 uiStartIndex, ezUInt32 uiNumItems, ezParallelForIndexedFunction32 taskCallback, const char* szTaskName, const ezParallelForParams& params)
 {
+  if (params.m_bAdaptive)
+  {
+    auto indexedCallback = [&taskCallback](ezUInt64 uiSliceStartIndex, ezUInt64 uiSliceEndIndex)
+    { taskCallback(static_cast<ezUInt32>(uiSliceStartIndex), static_cast<ezUInt32>(uiSliceEndIndex)); };
+
+    ParallelForAdaptive(uiStartIndex, uiNumItems, indexedCallback, szTaskName, params);
+    return;
+  }
+
   ParallelForIndexedInternal<ezUInt32, ezParallelForIndexedFunction32>(uiStartIndex, uiNumItems, std::move(taskCallback), szTaskName, params);
 }
 
 void ezTaskSystem::ParallelForIndexed(ezUInt64 uiStartIndex, ezUInt64 uiNumItems, ezParallelForIndexedFunction64 taskCallback, const char* szTaskName, const ezParallelForParams& params)
 {
+  if (params.m_bAdaptive)
+  {
+    ParallelForAdaptive(uiStartIndex, uiNumItems, taskCallback, szTaskName, params);
+    return;
+  }
+
   ParallelForIndexedInternal<ezUInt64, ezParallelForIndexedFunction64>(uiStartIndex, uiNumItems, std::move(taskCallback), szTaskName, params);
 }
 
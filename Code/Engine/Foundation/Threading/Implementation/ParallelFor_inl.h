@@ -44,7 +44,16 @@ private:
 template <typename ElemType>
 void ezTaskSystem::ParallelForInternal(ezArrayPtr<ElemType> taskItems, ezParallelForFunction<ElemType> taskCallback, const char* taskName, const ezParallelForParams& params)
 {
-  if (taskItems.GetCount() <= params.m_uiBinSize)
+  if (params.m_bAdaptive)
+  {
+    auto indexedCallback = [&taskCallback, taskItems](ezUInt64 uiStartIndex, ezUInt64 uiEndIndex)
+    {
+      taskCallback(static_cast<ezUInt32>(uiStartIndex), taskItems.GetSubArray(static_cast<ezUInt32>(uiStartIndex), static_cast<ezUInt32>(uiEndIndex - uiStartIndex)));
+    };
+
+    ParallelForAdaptive(0, taskItems.GetCount(), indexedCallback, taskName ? taskName : "Generic ArrayPtr Task", params);
+  }
+  else if (taskItems.GetCount() <= params.m_uiBinSize)
   {
     ArrayPtrTask<ElemType> arrayPtrTask(taskItems, std::move(taskCallback), taskItems.GetCount());
     arrayPtrTask.ConfigureTask(taskName ? taskName : "Generic ArrayPtr Task", params.m_NestingMode);
@@ -64,7 +73,7 @@ void ezTaskSystem::ParallelForInternal(ezArrayPtr<ElemType> taskItems, ezParalle
     pArrayPtrTask->ConfigureTask(taskName ? taskName : "Generic ArrayPtr Task", params.m_NestingMode);
 
     pArrayPtrTask->SetMultiplicity(uiMultiplicity);
-    ezTaskGroupID taskGroupId = ezTaskSystem::StartSingleTask(pArrayPtrTask, ezTaskPriority::EarlyThisFrame);
+    ezTaskGroupID taskGroupId = ezTaskSystem::StartSingleTask(pArrayPtrTask, params.m_TaskPriority);
     ezTaskSystem::WaitForGroup(taskGroupId);
   }
 }
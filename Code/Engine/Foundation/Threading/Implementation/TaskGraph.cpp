@@ -0,0 +1,286 @@
+#include <Foundation/FoundationPCH.h>
+
+#include <Foundation/Algorithm/Sorting.h>
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Threading/TaskGraph.h>
+
+ezTaskGraph::ezTaskGraph() = default;
+
+ezTaskGraph::~ezTaskGraph()
+{
+  EZ_ASSERT_DEV(!IsRunning(), "A task graph must not be destroyed while it is running.");
+
+  ReleaseTaskGroups();
+}
+
+void ezTaskGraph::Clear()
+{
+  EZ_ASSERT_DEV(!IsRunning(), "A task graph must not be modified while it is running.");
+
+  m_bCompiled = false;
+  ReleaseTaskGroups();
+  m_Nodes.Clear();
+  m_Dependencies.Clear();
+  m_Dependents.Clear();
+  m_RootNodes.Clear();
+  m_TopologicalOrder.Clear();
+}
+
+ezTaskGraph::NodeIndex ezTaskGraph::AddNode(const ezSharedPtr<ezTask>& pTask, float fCostEstimate)
+{
+  EZ_ASSERT_DEV(!IsRunning(), "A task graph must not be modified while it is running.");
+  EZ_ASSERT_DEBUG(pTask != nullptr, "Cannot add nullptr tasks.");
+
+  m_bCompiled = false;
+
+  Node& node = m_Nodes.ExpandAndGetRef();
+  node.m_pGraph = this;
+  node.m_pTask = pTask;
+  node.m_fCostEstimate = fCostEstimate;
+
+  return m_Nodes.GetCount() - 1;
+}
+
+void ezTaskGraph::AddDependency(NodeIndex node, NodeIndex dependsOn)
+{
+  EZ_ASSERT_DEV(!IsRunning(), "A task graph must not be modified while it is running.");
+  EZ_ASSERT_DEV(node < m_Nodes.GetCount() && dependsOn < m_Nodes.GetCount(), "Invalid node index");
+  EZ_ASSERT_DEV(node != dependsOn, "A node cannot depend on itself");
+
+  m_bCompiled = false;
+
+  Dependency& dep = m_Dependencies.ExpandAndGetRef();
+  dep.m_Node = node;
+  dep.m_DependsOn = dependsOn;
+}
+
+ezResult ezTaskGraph::Compile()
+{
+  EZ_ASSERT_DEV(!IsRunning(), "A task graph must not be modified while it is running.");
+
+  m_bCompiled = false;
+
+  const ezUInt32 uiNumNodes = m_Nodes.GetCount();
+
+  // store the dependents of all nodes consecutively
+  for (Node& node : m_Nodes)
+  {
+    node.m_uiNumDependencies = 0;
+    node.m_uiNumDependents = 0;
+  }
+
+  for (const Dependency& dep : m_Dependencies)
+  {
+    ++m_Nodes[dep.m_Node].m_uiNumDependencies;
+    ++m_Nodes[dep.m_DependsOn].m_uiNumDependents;
+  }
+
+  ezUInt32 uiFirstDependent = 0;
+  for (Node& node : m_Nodes)
+  {
+    node.m_uiFirstDependent = uiFirstDependent;
+    uiFirstDependent += node.m_uiNumDependents;
+    node.m_uiNumDependents = 0;
+  }
+
+  m_Dependents.SetCountUninitialized(m_Dependencies.GetCount());
+
+  for (const Dependency& dep : m_Dependencies)
+  {
+    Node& node = m_Nodes[dep.m_DependsOn];
+    m_Dependents[node.m_uiFirstDependent + node.m_uiNumDependents] = dep.m_Node;
+    ++node.m_uiNumDependents;
+  }
+
+  // sort topologically (Kahn's algorithm), m_TopologicalOrder is used as the queue of nodes whose dependencies are all processed
+  m_TopologicalOrder.Clear();
+  m_TopologicalOrder.Reserve(uiNumNodes);
+  m_RootNodes.Clear();
+
+  for (NodeIndex i = 0; i < uiNumNodes; ++i)
+  {
+    m_Nodes[i].m_iRemainingDependencies = m_Nodes[i].m_uiNumDependencies;
+
+    if (m_Nodes[i].m_uiNumDependencies == 0)
+    {
+      m_RootNodes.PushBack(i);
+      m_TopologicalOrder.PushBack(i);
+    }
+  }
+
+  for (ezUInt32 i = 0; i < m_TopologicalOrder.GetCount(); ++i)
+  {
+    const Node& node = m_Nodes[m_TopologicalOrder[i]];
+
+    for (ezUInt32 d = 0; d < node.m_uiNumDependents; ++d)
+    {
+      const NodeIndex dependent = m_Dependents[node.m_uiFirstDependent + d];
+
+      if (m_Nodes[dependent].m_iRemainingDependencies.Decrement() == 0)
+      {
+        m_TopologicalOrder.PushBack(dependent);
+      }
+    }
+  }
+
+  if (m_TopologicalOrder.GetCount() != uiNumNodes)
+  {
+    ezLog::Error("Task graph contains a cycle, {} of {} nodes can never be executed.", uiNumNodes - m_TopologicalOrder.GetCount(), uiNumNodes);
+    m_TopologicalOrder.Clear();
+    return EZ_FAILURE;
+  }
+
+  CreateTaskGroups();
+
+  m_bSchedulingOrderValid = false;
+  m_bCompiled = true;
+  return EZ_SUCCESS;
+}
+
+void ezTaskGraph::CreateTaskGroups()
+{
+  // nodes may have been added since the last compilation, which moves them in memory, so the callbacks have to be set up again
+  ReleaseTaskGroups();
+
+  for (Node& node : m_Nodes)
+  {
+    node.m_pTaskGroup = ezTaskSystem::CreatePersistentTaskGroup(node.m_pTask, ezMakeDelegate(&Node::OnTaskGroupFinished, &node));
+  }
+
+  // the completion group never gets any tasks, it is started once the last node has finished and thus finishes immediately
+  m_pCompletionGroup = ezTaskSystem::CreatePersistentTaskGroup(nullptr, ezOnTaskGroupFinishedCallback());
+}
+
+void ezTaskGraph::ReleaseTaskGroups()
+{
+  for (Node& node : m_Nodes)
+  {
+    if (node.m_pTaskGroup != nullptr)
+    {
+      ezTaskSystem::ReleasePersistentTaskGroup(node.m_pTaskGroup);
+      node.m_pTaskGroup = nullptr;
+    }
+  }
+
+  if (m_pCompletionGroup != nullptr)
+  {
+    ezTaskSystem::ReleasePersistentTaskGroup(m_pCompletionGroup);
+    m_pCompletionGroup = nullptr;
+  }
+}
+
+void ezTaskGraph::SetNodeCostEstimate(NodeIndex node, float fCostEstimate)
+{
+  EZ_ASSERT_DEV(!IsRunning(), "A task graph must not be modified while it is running.");
+
+  if (m_Nodes[node].m_fCostEstimate != fCostEstimate)
+  {
+    m_Nodes[node].m_fCostEstimate = fCostEstimate;
+    m_bSchedulingOrderValid = false;
+  }
+}
+
+void ezTaskGraph::UpdateSchedulingOrder()
+{
+  // going backwards through the topological order guarantees that all dependents of a node are already processed
+  for (ezUInt32 i = m_TopologicalOrder.GetCount(); i-- > 0;)
+  {
+    Node& node = m_Nodes[m_TopologicalOrder[i]];
+
+    float fMaxDependentCost = 0.0f;
+    for (ezUInt32 d = 0; d < node.m_uiNumDependents; ++d)
+    {
+      fMaxDependentCost = ezMath::Max(fMaxDependentCost, m_Nodes[m_Dependents[node.m_uiFirstDependent + d]].m_fCriticalPathCost);
+    }
+
+    node.m_fCriticalPathCost = node.m_fCostEstimate + fMaxDependentCost;
+  }
+
+  // nodes that are started first are also executed first, so start the most expensive paths first
+  auto comparer = [this](NodeIndex a, NodeIndex b)
+  {
+    const float fCostA = m_Nodes[a].m_fCriticalPathCost;
+    const float fCostB = m_Nodes[b].m_fCriticalPathCost;
+    return fCostA > fCostB || (fCostA == fCostB && a < b);
+  };
+
+  m_RootNodes.Sort(comparer);
+
+  for (const Node& node : m_Nodes)
+  {
+    if (node.m_uiNumDependents > 1)
+    {
+      ezArrayPtr<NodeIndex> dependents = m_Dependents.GetArrayPtr().GetSubArray(node.m_uiFirstDependent, node.m_uiNumDependents);
+      ezSorting::QuickSort(dependents, comparer);
+    }
+  }
+
+  m_bSchedulingOrderValid = true;
+}
+
+ezTaskGroupID ezTaskGraph::Launch(ezTaskPriority::Enum priority)
+{
+  EZ_ASSERT_DEV(m_bCompiled, "The task graph has to be compiled successfully before it can be launched.");
+  EZ_ASSERT_DEV(!IsRunning(), "The task graph is already running.");
+
+  if (!m_bSchedulingOrderValid)
+  {
+    UpdateSchedulingOrder();
+  }
+
+  m_Priority = priority;
+
+  m_CompletionGroup = ezTaskSystem::RestartPersistentTaskGroup(m_pCompletionGroup, priority);
+  const ezTaskGroupID completionGroup = m_CompletionGroup;
+
+  if (m_Nodes.IsEmpty())
+  {
+    ezTaskSystem::StartTaskGroup(completionGroup);
+    return completionGroup;
+  }
+
+  for (Node& node : m_Nodes)
+  {
+    node.m_iRemainingDependencies = node.m_uiNumDependencies;
+  }
+
+  m_iRemainingNodes = m_Nodes.GetCount();
+
+  for (NodeIndex root : m_RootNodes)
+  {
+    StartNode(root);
+  }
+
+  // the graph may already be finished at this point, so don't access m_CompletionGroup anymore
+  return completionGroup;
+}
+
+void ezTaskGraph::StartNode(NodeIndex nodeIndex)
+{
+  ezTaskSystem::StartTaskGroup(ezTaskSystem::RestartPersistentTaskGroup(m_Nodes[nodeIndex].m_pTaskGroup, m_Priority));
+}
+
+void ezTaskGraph::Node::OnTaskGroupFinished(ezTaskGroupID groupID)
+{
+  m_pGraph->NodeHasFinished(static_cast<NodeIndex>(this - m_pGraph->m_Nodes.GetData()));
+}
+
+void ezTaskGraph::NodeHasFinished(NodeIndex nodeIndex)
+{
+  const Node& node = m_Nodes[nodeIndex];
+
+  for (ezUInt32 d = 0; d < node.m_uiNumDependents; ++d)
+  {
+    const NodeIndex dependent = m_Dependents[node.m_uiFirstDependent + d];
+
+    if (m_Nodes[dependent].m_iRemainingDependencies.Decrement() == 0)
+    {
+      StartNode(dependent);
+    }
+  }
+
+  if (m_iRemainingNodes.Decrement() == 0)
+  {
+    ezTaskSystem::StartTaskGroup(m_CompletionGroup);
+  }
+}
@@ -25,13 +25,41 @@ void ezTaskGroup::Reuse(ezTaskPriority::Enum priority, ezOnTaskGroupFinishedCall
   m_bInUse = true;
   m_bStartedByUser = false;
   m_uiGroupCounter += 2; // even if it wraps around, it will never be zero, thus zero stays an invalid group counter
+  m_uiDependentsListHead.store((static_cast<ezUInt64>(m_uiGroupCounter) << 32) | EndOfDependentsList, std::memory_order_release);
   m_Tasks.Clear();
+  m_ScheduledTasks.Clear();
   m_DependsOnGroups.Clear();
-  m_OthersDependingOnMe.Clear();
   m_Priority = priority;
   m_OnFinishedCallback = callback;
 }
 
+bool ezTaskGroup::AddDependentGroup(ezTaskGroup& ref_dependent, ezUInt32 uiDependencyIndex)
+{
+  DependencyLink& link = ref_dependent.m_DependsOnGroups[uiDependencyIndex];
+  const ezUInt64 uiOpenTag = static_cast<ezUInt64>(link.m_DependsOn.m_uiGroupCounter) << 32;
+  const ezUInt64 uiNewHead = uiOpenTag | MakeLink(ref_dependent.m_uiTaskGroupIndex, uiDependencyIndex);
+
+  ezUInt64 uiHead = m_uiDependentsListHead.load(std::memory_order_acquire);
+
+  while (true)
+  {
+    // the list is only open for the incarnation of this group that the dependency refers to
+    if ((uiHead & 0xFFFFFFFF00000000ull) != uiOpenTag)
+      return false;
+
+    link.m_uiNextLink = static_cast<ezUInt32>(uiHead);
+
+    if (m_uiDependentsListHead.compare_exchange_weak(uiHead, uiNewHead, std::memory_order_acq_rel, std::memory_order_acquire))
+      return true;
+  }
+}
+
+ezUInt32 ezTaskGroup::TakeDependentsList()
+{
+  // group counters are always odd, so a zero tag can never match any group ID
+  return static_cast<ezUInt32>(m_uiDependentsListHead.exchange(0, std::memory_order_acq_rel));
+}
+
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEBUG)
 void ezTaskGroup::DebugCheckTaskGroup(ezTaskGroupID groupID, ezMutex& mutex)
 {
@@ -46,4 +74,103 @@ void ezTaskGroup::DebugCheckTaskGroup(ezTaskGroupID groupID, ezMutex& mutex)
 }
 #endif
 
+ezTaskGroupPool::ezTaskGroupPool() = default;
+
+ezTaskGroupPool::~ezTaskGroupPool()
+{
+  const ezUInt32 uiNumBlocks = m_uiNumGroups.load(std::memory_order_relaxed) / BlockSize;
+
+  for (ezUInt32 i = 0; i < uiNumBlocks; ++i)
+  {
+    ezArrayPtr<ezTaskGroup> block(m_Blocks[i], BlockSize);
+    EZ_DEFAULT_DELETE_ARRAY(block);
+  }
+}
+
+ezTaskGroup* ezTaskGroupPool::Allocate()
+{
+  ezUInt32 uiIndex = 0;
+
+  if (!TryPopFreeGroup(uiIndex))
+  {
+    EZ_LOCK(m_BlockMutex);
+
+    // another thread may have added a block in the meantime
+    if (!TryPopFreeGroup(uiIndex))
+    {
+      const ezUInt32 uiFirstIndex = m_uiNumGroups.load(std::memory_order_relaxed);
+      const ezUInt32 uiBlock = uiFirstIndex / BlockSize;
+      EZ_ASSERT_ALWAYS(uiBlock < MaxBlocks, "Too many task groups in use at the same time.");
+
+      ezTaskGroup* pBlock = EZ_DEFAULT_NEW_ARRAY(ezTaskGroup, BlockSize).GetPtr();
+
+      for (ezUInt32 i = 0; i < BlockSize; ++i)
+      {
+        pBlock[i].m_uiTaskGroupIndex = uiFirstIndex + i;
+      }
+
+      m_Blocks[uiBlock] = pBlock;
+      m_uiNumGroups.store(uiFirstIndex + BlockSize, std::memory_order_release);
 
+      // keep the first group for ourselves, all others are available to everyone
+      uiIndex = uiFirstIndex;
+      PushFreeGroups(uiFirstIndex + 1, uiFirstIndex + BlockSize - 1);
+    }
+  }
+
+  ezTaskGroup* pGroup = &GetGroup(uiIndex);
+  EZ_ASSERT_DEBUG(!pGroup->m_bInUse, "Task group was handed out twice.");
+  return pGroup;
+}
+
+void ezTaskGroupPool::Release(ezTaskGroup* pGroup)
+{
+  pGroup->m_bInUse = false;
+
+  PushFreeGroups(pGroup->m_uiTaskGroupIndex, pGroup->m_uiTaskGroupIndex);
+}
+
+bool ezTaskGroupPool::TryPopFreeGroup(ezUInt32& out_uiIndex)
+{
+  ezUInt64 uiHead = m_uiFreeListHead.load(std::memory_order_acquire);
+
+  while (true)
+  {
+    const ezUInt32 uiFirst = static_cast<ezUInt32>(uiHead);
+
+    if (uiFirst == 0)
+      return false;
+
+    // groups are never deallocated, so even if another thread pops this group concurrently, reading from it is fine
+    // the tag makes sure the exchange fails in that case
+    const ezUInt32 uiNext = GetGroup(uiFirst - 1).m_uiNextFreeGroup.load(std::memory_order_relaxed);
+    const ezUInt64 uiNewHead = ((uiHead >> 32) + 1) << 32 | uiNext;
+
+    if (m_uiFreeListHead.compare_exchange_weak(uiHead, uiNewHead, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+      out_uiIndex = uiFirst - 1;
+      return true;
+    }
+  }
+}
+
+void ezTaskGroupPool::PushFreeGroups(ezUInt32 uiFirstIndex, ezUInt32 uiLastIndex)
+{
+  // link the given range of groups up front, then attach it to the list with a single exchange
+  for (ezUInt32 i = uiFirstIndex; i < uiLastIndex; ++i)
+  {
+    GetGroup(i).m_uiNextFreeGroup.store(i + 2, std::memory_order_relaxed);
+  }
+
+  ezTaskGroup& lastGroup = GetGroup(uiLastIndex);
+  ezUInt64 uiHead = m_uiFreeListHead.load(std::memory_order_relaxed);
+
+  while (true)
+  {
+    lastGroup.m_uiNextFreeGroup.store(static_cast<ezUInt32>(uiHead), std::memory_order_relaxed);
+    const ezUInt64 uiNewHead = ((uiHead >> 32) + 1) << 32 | (uiFirstIndex + 1);
+
+    if (m_uiFreeListHead.compare_exchange_weak(uiHead, uiNewHead, std::memory_order_release, std::memory_order_relaxed))
+      return;
+  }
+}
@@ -3,8 +3,11 @@
 #include <Foundation/Strings/String.h>
 #include <Foundation/Threading/ConditionVariable.h>
 #include <Foundation/Threading/Implementation/TaskSystemDeclarations.h>
+#include <Foundation/Threading/TaskSystem.h>
 #include <Foundation/Types/SharedPtr.h>
 
+#include <atomic>
+
 /// \internal Represents the state of a group of tasks that can be waited on
 class ezTaskGroup
 {
@@ -16,6 +19,38 @@ public:
 
 private:
   friend class ezTaskSystem;
+  friend class ezTaskGroupPool;
+
+  /// Maximum number of dependencies that a single group may have.
+  static constexpr ezUInt32 MaxDependencies = 1 << 12;
+
+  /// Marks the end of the list of dependent groups.
+  static constexpr ezUInt32 EndOfDependentsList = 0xFFFFFFFF;
+
+  struct DependencyLink
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    ezTaskGroupID m_DependsOn;
+
+    // the next entry in m_DependsOn's list of dependent groups, see m_uiDependentsListHead
+    ezUInt32 m_uiNextLink;
+  };
+
+  EZ_ALWAYS_INLINE static ezUInt32 MakeLink(ezUInt32 uiGroupIndex, ezUInt32 uiDependencyIndex) { return (uiGroupIndex << 12) | uiDependencyIndex; }
+  EZ_ALWAYS_INLINE static ezUInt32 GetLinkGroupIndex(ezUInt32 uiLink) { return uiLink >> 12; }
+  EZ_ALWAYS_INLINE static ezUInt32 GetLinkDependencyIndex(ezUInt32 uiLink) { return uiLink & (MaxDependencies - 1); }
+
+  /// \brief Registers m_DependsOnGroups[uiDependencyIndex] of \a ref_dependent in this group's list of dependent groups.
+  ///
+  /// Returns false, if this group has already finished (or is not the incarnation referenced by the dependency anymore),
+  /// in which case the dependency is already fulfilled and the dependent group won't be notified.
+  bool AddDependentGroup(ezTaskGroup& ref_dependent, ezUInt32 uiDependencyIndex);
+
+  /// \brief Closes the list of dependent groups and returns the first link of it.
+  ///
+  /// After this, AddDependentGroup() fails for the current incarnation of the group.
+  ezUInt32 TakeDependentsList();
 
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEBUG)
   static void DebugCheckTaskGroup(ezTaskGroupID groupID, ezMutex& mutex);
@@ -27,16 +62,75 @@ private:
   void WaitForFinish(ezTaskGroupID group) const;
   void Reuse(ezTaskPriority::Enum priority, ezOnTaskGroupFinishedCallback callback);
 
-  bool m_bInUse = true;
+  bool m_bInUse = false;
   bool m_bStartedByUser = false;
-  ezUInt16 m_uiTaskGroupIndex = 0xFFFF; // only there as a debugging aid
-  ezUInt32 m_uiGroupCounter = 1;
+
+  // persistent groups keep their tasks and are not put back into the pool when they finish, see ezTaskSystem::CreatePersistentTaskGroup()
+  bool m_bPersistent = false;
+
+  // set while a run of a persistent group is in progress, only cleared once ezTaskSystem::TaskHasFinished() doesn't access the group anymore
+  std::atomic<bool> m_bPersistentRunInProgress = false;
+  ezUInt32 m_uiTaskGroupIndex = 0xFFFFFFFF; // the index in the ezTaskGroupPool
+  std::atomic<ezUInt32> m_uiGroupCounter = 1;
   ezHybridArray<ezSharedPtr<ezTask>, 16> m_Tasks;
-  ezHybridArray<ezTaskGroupID, 4> m_DependsOnGroups;
-  ezHybridArray<ezTaskGroupID, 8> m_OthersDependingOnMe;
+  ezHybridArray<ezTaskSystem::TaskData, 16> m_ScheduledTasks; // only used by ezTaskSchedulingMode::WorkStealing, the thread queues point into this
+  ezHybridArray<DependencyLink, 4> m_DependsOnGroups;
+
+  // Intrusive lock-free list of all groups that wait for this one to finish. The upper 32 bits store the group counter for which the
+  // list is open, the lower 32 bits the link to the first DependencyLink (see MakeLink()). The nodes of the list are the entries in
+  // the dependent groups' m_DependsOnGroups arrays, so registering a dependency never allocates.
+  // When the group finishes, the head is replaced with a value that no group ID can match, which closes the list.
+  std::atomic<ezUInt64> m_uiDependentsListHead = 0;
+
+  // the next group in the ezTaskGroupPool's free list
+  std::atomic<ezUInt32> m_uiNextFreeGroup = 0;
+
   ezAtomicInteger32 m_iNumActiveDependencies;
   ezAtomicInteger32 m_iNumRemainingTasks;
   ezOnTaskGroupFinishedCallback m_OnFinishedCallback;
   ezTaskPriority::Enum m_Priority = ezTaskPriority::ThisFrame;
   mutable ezConditionVariable m_CondVarGroupFinished;
 };
+
+/// \internal Owns all ezTaskGroup objects and recycles them without locking.
+///
+/// Groups are allocated in blocks that never move, so ezTaskGroupID can point directly to them and groups can be looked up by index.
+/// Unused groups are kept in a lock-free free list. Only when the free list runs empty, a mutex is taken to allocate another block.
+/// Once the system has warmed up, creating and releasing groups neither locks nor allocates.
+class ezTaskGroupPool
+{
+  EZ_DISALLOW_COPY_AND_ASSIGN(ezTaskGroupPool);
+
+public:
+  ezTaskGroupPool();
+  ~ezTaskGroupPool();
+
+  /// \brief Returns an unused group.
+  ezTaskGroup* Allocate();
+
+  /// \brief Puts a finished group back into the free list.
+  void Release(ezTaskGroup* pGroup);
+
+  /// \brief Returns how many groups have been allocated so far. Not all of them are necessarily in use.
+  EZ_ALWAYS_INLINE ezUInt32 GetCount() const { return m_uiNumGroups.load(std::memory_order_acquire); }
+
+  EZ_ALWAYS_INLINE ezTaskGroup& GetGroup(ezUInt32 uiIndex) { return m_Blocks[uiIndex / BlockSize][uiIndex % BlockSize]; }
+  EZ_ALWAYS_INLINE const ezTaskGroup& GetGroup(ezUInt32 uiIndex) const { return m_Blocks[uiIndex / BlockSize][uiIndex % BlockSize]; }
+
+private:
+  static constexpr ezUInt32 BlockSize = 256;
+
+  // one block less than what fits into the 20 bits of group index in ezTaskGroup::MakeLink(), to keep EndOfDependentsList unambiguous
+  static constexpr ezUInt32 MaxBlocks = (1 << 20) / BlockSize - 1;
+
+  bool TryPopFreeGroup(ezUInt32& out_uiIndex);
+  void PushFreeGroups(ezUInt32 uiFirstIndex, ezUInt32 uiLastIndex);
+
+  // The upper 32 bits are a tag that changes with every modification (to prevent ABA problems), the lower 32 bits are the index + 1
+  // of the first free group, zero means the list is empty.
+  std::atomic<ezUInt64> m_uiFreeListHead = 0;
+
+  std::atomic<ezUInt32> m_uiNumGroups = 0;
+  ezMutex m_BlockMutex;
+  ezTaskGroup* m_Blocks[MaxBlocks] = {};
+};
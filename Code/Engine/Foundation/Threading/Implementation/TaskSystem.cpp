@@ -39,8 +39,14 @@ void ezTaskSystem::Startup()
   s_pThreadState = EZ_DEFAULT_NEW(ezTaskSystemThreadState);
   s_pState = EZ_DEFAULT_NEW(ezTaskSystemState);
 
+  // room for the main thread queue plus the maximum number of worker threads (see SetWorkerThreadCount())
+  s_pThreadState->m_WorkQueues.SetCount(ezTaskSystemThreadState::s_uiMaxWorkQueues);
+  s_pThreadState->m_WorkQueues[0] = &s_pThreadState->m_MainThreadQueue;
+  s_pThreadState->m_uiNumWorkQueues = 1;
+
   tl_TaskWorkerInfo.m_WorkerType = ezWorkerThreadType::MainThread;
   tl_TaskWorkerInfo.m_iWorkerIndex = 0;
+  tl_TaskWorkerInfo.m_pWorkQueue = &s_pThreadState->m_MainThreadQueue;
 
   // initialize with the default number of worker threads
   SetWorkerThreadCount();
@@ -53,6 +59,8 @@ void ezTaskSystem::Shutdown()
 
   StopWorkerThreads();
 
+  tl_TaskWorkerInfo.m_pWorkQueue = nullptr;
+
   s_pState.Clear();
   s_pThreadState.Clear();
 }
@@ -62,4 +70,31 @@ void ezTaskSystem::SetTargetFrameTime(ezTime targetFrameTime)
   s_pState->m_TargetFrameTime = targetFrameTime;
 }
 
+void ezTaskSystem::SetSchedulingMode(ezTaskSchedulingMode::Enum mode)
+{
+  if (s_pState->m_SchedulingMode == mode)
+    return;
+
+  const ezUInt32 uiShortTasks = s_pThreadState->m_uiMaxWorkersToUse[ezWorkerThreadType::ShortTasks];
+  const ezUInt32 uiLongTasks = s_pThreadState->m_uiMaxWorkersToUse[ezWorkerThreadType::LongTasks];
+
+  // the worker threads read the mode without synchronization, so only switch it while they are shut down
+  // this also moves all tasks that are still in the thread queues into the global lists
+  StopWorkerThreads();
+
+  s_pState->m_SchedulingMode = mode;
+
+  SetWorkerThreadCount(uiShortTasks, uiLongTasks);
+}
+
+ezUInt64 ezTaskSystem::GetNumStolenTasks()
+{
+  return s_pState->m_uiNumStolenTasks.load(std::memory_order_relaxed);
+}
+
+ezTaskSchedulingMode::Enum ezTaskSystem::GetSchedulingMode()
+{
+  return s_pState->m_SchedulingMode;
+}
+
 EZ_STATICLINK_FILE(Foundation, Foundation_Threading_Implementation_TaskSystem);
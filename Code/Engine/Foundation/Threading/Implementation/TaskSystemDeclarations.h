@@ -12,6 +12,8 @@ class ezTaskGroup;
 class ezTaskWorkerThread;
 class ezTaskSystemState;
 class ezTaskSystemThreadState;
+class ezTaskWorkQueue;
+struct ezParallelForAdaptiveState;
 class ezDGMLGraph;
 class ezAllocator;
 
@@ -82,6 +84,19 @@ struct ezOnTaskRunning
   };
 };
 
+/// \brief Describes how the ezTaskSystem hands out scheduled tasks to the threads that execute them.
+struct ezTaskSchedulingMode
+{
+  enum Enum : ezUInt8
+  {
+    GlobalQueue,  ///< All scheduled tasks are stored in one list per priority, which is protected by the global task system mutex.
+    WorkStealing, ///< Tasks that never wait for other tasks (ezTaskNesting::Never) are pushed into lock-free queues owned by the scheduling
+                  ///< thread. Idle threads take work from their own queue first and steal from other threads' queues otherwise.
+                  ///< All other tasks, as well as main thread and file access tasks, still go through the global lists.
+    Default = GlobalQueue
+  };
+};
+
 /// \internal Enum that lists the different task worker thread types.
 struct ezWorkerThreadType
 {
@@ -182,6 +197,16 @@ struct EZ_FOUNDATION_DLL ezParallelForParams
 
   ezTaskNesting m_NestingMode = ezTaskNesting::Never;
 
+  /// The priority with which the tasks of the parallel-for are scheduled. The calling thread always works on the items as well.
+  ezTaskPriority::Enum m_TaskPriority = ezTaskPriority::EarlyThisFrame;
+
+  /// If enabled, the batch size is chosen automatically and m_uiBinSize and m_uiMaxTasksPerThread are ignored.
+  /// The task system measures how long each item takes and remembers it per task name, so the batch size adapts over
+  /// multiple invocations. Loops that are cheap in total run serially. Work is split lazily in halves, only when other
+  /// threads have nothing to do, which also balances workloads where items take very different amounts of time.
+  /// Use distinct task names for different loops, otherwise they share the same cost estimate.
+  bool m_bAdaptive = false;
+
   /// The allocator used to for the tasks that the parallel-for uses internally. If null, will use the default allocator.
   ezAllocator* m_pTaskAllocator = nullptr;
 
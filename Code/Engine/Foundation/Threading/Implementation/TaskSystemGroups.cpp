@@ -11,30 +11,12 @@
 
 ezTaskGroupID ezTaskSystem::CreateTaskGroup(ezTaskPriority::Enum priority, ezOnTaskGroupFinishedCallback callback)
 {
-  EZ_LOCK(s_TaskSystemMutex);
-
-  ezUInt32 i = 0;
-
-  // this search could be speed up with a stack of free groups
-  for (; i < s_pState->m_TaskGroups.GetCount(); ++i)
-  {
-    if (!s_pState->m_TaskGroups[i].m_bInUse)
-    {
-      goto foundtaskgroup;
-    }
-  }
-
-  // no free group found, create a new one
-  s_pState->m_TaskGroups.ExpandAndGetRef();
-  s_pState->m_TaskGroups[i].m_uiTaskGroupIndex = static_cast<ezUInt16>(i);
-
-foundtaskgroup:
-
-  s_pState->m_TaskGroups[i].Reuse(priority, callback);
+  ezTaskGroup* pGroup = s_pState->m_TaskGroups.Allocate();
+  pGroup->Reuse(priority, callback);
 
   ezTaskGroupID id;
-  id.m_pTaskGroup = &s_pState->m_TaskGroups[i];
-  id.m_uiGroupCounter = s_pState->m_TaskGroups[i].m_uiGroupCounter;
+  id.m_pTaskGroup = pGroup;
+  id.m_uiGroupCounter = pGroup->m_uiGroupCounter;
   return id;
 }
 
@@ -58,7 +40,9 @@ void ezTaskSystem::AddTaskGroupDependency(ezTaskGroupID groupID, ezTaskGroupID d
 
   ezTaskGroup::DebugCheckTaskGroup(groupID, s_TaskSystemMutex);
 
-  groupID.m_pTaskGroup->m_DependsOnGroups.PushBack(dependsOn);
+  EZ_ASSERT_DEV(groupID.m_pTaskGroup->m_DependsOnGroups.GetCount() < ezTaskGroup::MaxDependencies, "A task group can't have more than {} dependencies.", ezTaskGroup::MaxDependencies);
+
+  groupID.m_pTaskGroup->m_DependsOnGroups.ExpandAndGetRef().m_DependsOn = dependsOn;
 }
 
 void ezTaskSystem::AddTaskGroupDependencyBatch(ezArrayPtr<const ezTaskGroupDependency> batch)
@@ -80,46 +64,39 @@ void ezTaskSystem::StartTaskGroup(ezTaskGroupID groupID)
 
   ezTaskGroup::DebugCheckTaskGroup(groupID, s_TaskSystemMutex);
 
-  ezInt32 iActiveDependencies = 0;
-
-  {
-    EZ_LOCK(s_TaskSystemMutex);
-
-    ezTaskGroup& tg = *groupID.m_pTaskGroup;
+  ezTaskGroup& tg = *groupID.m_pTaskGroup;
 
-    tg.m_bStartedByUser = true;
+  tg.m_bStartedByUser = true;
 
-    for (ezUInt32 i = 0; i < tg.m_DependsOnGroups.GetCount(); ++i)
-    {
-      if (!IsTaskGroupFinished(tg.m_DependsOnGroups[i]))
-      {
-        ezTaskGroup& Dependency = *tg.m_DependsOnGroups[i].m_pTaskGroup;
+  const ezUInt32 uiNumDependencies = tg.m_DependsOnGroups.GetCount();
 
-        // add this task group to the list of dependencies, such that when that group finishes, this task group can get woken up
-        Dependency.m_OthersDependingOnMe.PushBack(groupID);
+  if (uiNumDependencies == 0)
+  {
+    ScheduleGroupTasks(&tg, false);
+    return;
+  }
 
-        // count how many other groups need to finish before this task group can be executed
-        ++iActiveDependencies;
-      }
-    }
+  // The additional count prevents dependencies that finish while we are still registering from scheduling this group early.
+  tg.m_iNumActiveDependencies = uiNumDependencies + 1;
 
-    if (iActiveDependencies != 0)
+  for (ezUInt32 i = 0; i < uiNumDependencies; ++i)
+  {
+    // add this task group to the list of dependents of the other group, such that when that group finishes, this task group can get woken up
+    if (!tg.m_DependsOnGroups[i].m_DependsOn.m_pTaskGroup->AddDependentGroup(tg, i))
     {
-      // atomic integers are quite slow, so do not use them in the loop, where they are not yet needed
-      tg.m_iNumActiveDependencies = iActiveDependencies;
+      // the other group has already finished, can't reach zero here because of the additional count
+      tg.m_iNumActiveDependencies.Decrement();
     }
   }
 
-  if (iActiveDependencies == 0)
+  if (tg.m_iNumActiveDependencies.Decrement() == 0)
   {
-    ScheduleGroupTasks(groupID.m_pTaskGroup, false);
+    ScheduleGroupTasks(&tg, false);
   }
 }
 
 void ezTaskSystem::StartTaskGroupBatch(ezArrayPtr<const ezTaskGroupID> batch)
 {
-  EZ_LOCK(s_TaskSystemMutex);
-
   for (const ezTaskGroupID& group : batch)
   {
     StartTaskGroup(group);
@@ -132,6 +109,121 @@ bool ezTaskSystem::IsTaskGroupFinished(ezTaskGroupID group)
   return (group.m_pTaskGroup == nullptr) || (group.m_pTaskGroup->m_uiGroupCounter != group.m_uiGroupCounter);
 }
 
+ezTaskGroup* ezTaskSystem::CreatePersistentTaskGroup(const ezSharedPtr<ezTask>& pTask, ezOnTaskGroupFinishedCallback callback)
+{
+  EZ_ASSERT_DEBUG(pTask == nullptr || !pTask->m_sTaskName.IsEmpty(), "Every task should have a name");
+
+  ezTaskGroup* pGroup = s_pState->m_TaskGroups.Allocate();
+  pGroup->Reuse(ezTaskPriority::ThisFrame, callback);
+  pGroup->m_bPersistent = true;
+
+  // no ID of this incarnation is handed out, so the group counts as finished until it gets restarted
+  pGroup->m_uiGroupCounter += 2;
+
+  if (pTask != nullptr)
+  {
+    pGroup->m_Tasks.PushBack(pTask);
+  }
+
+  return pGroup;
+}
+
+ezTaskGroupID ezTaskSystem::RestartPersistentTaskGroup(ezTaskGroup* pGroup, ezTaskPriority::Enum priority)
+{
+  EZ_ASSERT_DEBUG(pGroup->m_bPersistent, "Only persistent task groups can be restarted.");
+
+  // the previous run may already count as finished, while TaskHasFinished() is still notifying its dependents
+  while (pGroup->m_bPersistentRunInProgress.load(std::memory_order_acquire))
+  {
+    ezThreadUtils::YieldTimeSlice();
+  }
+
+  pGroup->m_bPersistentRunInProgress.store(true, std::memory_order_relaxed);
+  pGroup->m_bStartedByUser = false;
+  pGroup->m_uiGroupCounter += 2;
+  pGroup->m_uiDependentsListHead.store((static_cast<ezUInt64>(pGroup->m_uiGroupCounter) << 32) | ezTaskGroup::EndOfDependentsList, std::memory_order_release);
+  pGroup->m_DependsOnGroups.Clear();
+  pGroup->m_Priority = priority;
+
+  ezTaskGroupID id;
+  id.m_pTaskGroup = pGroup;
+  id.m_uiGroupCounter = pGroup->m_uiGroupCounter;
+
+  for (const ezSharedPtr<ezTask>& pTask : pGroup->m_Tasks)
+  {
+    EZ_ASSERT_DEV(pTask->IsTaskFinished(), "The task '{}' is not finished! Cannot reuse a task before it is done.", pTask->m_sTaskName);
+
+    pTask->Reset();
+    pTask->m_BelongsToGroup = id;
+  }
+
+  return id;
+}
+
+void ezTaskSystem::ReleasePersistentTaskGroup(ezTaskGroup* pGroup)
+{
+  // all groups are deallocated at shutdown anyway
+  if (s_pState == nullptr)
+    return;
+
+  EZ_ASSERT_DEBUG(pGroup->m_bPersistent, "Only persistent task groups can be released with this function.");
+
+  while (pGroup->m_bPersistentRunInProgress.load(std::memory_order_acquire))
+  {
+    ezThreadUtils::YieldTimeSlice();
+  }
+
+  pGroup->m_bPersistent = false;
+  pGroup->m_Tasks.Clear();
+  s_pState->m_TaskGroups.Release(pGroup);
+}
+
+static void WakeUpThreadsForPriority(ezTaskPriority::Enum priority, ezUInt32 uiNumTasks)
+{
+  // send the proper thread signal, to make sure one of the correct worker threads is awake
+  switch (priority)
+  {
+    case ezTaskPriority::EarlyThisFrame:
+    case ezTaskPriority::ThisFrame:
+    case ezTaskPriority::LateThisFrame:
+    case ezTaskPriority::EarlyNextFrame:
+    case ezTaskPriority::NextFrame:
+    case ezTaskPriority::LateNextFrame:
+    case ezTaskPriority::In2Frames:
+    case ezTaskPriority::In3Frames:
+    case ezTaskPriority::In4Frames:
+    case ezTaskPriority::In5Frames:
+    case ezTaskPriority::In6Frames:
+    case ezTaskPriority::In7Frames:
+    case ezTaskPriority::In8Frames:
+    case ezTaskPriority::In9Frames:
+    {
+      ezTaskSystem::WakeUpThreads(ezWorkerThreadType::ShortTasks, uiNumTasks);
+      break;
+    }
+
+    case ezTaskPriority::LongRunning:
+    case ezTaskPriority::LongRunningHighPriority:
+    {
+      ezTaskSystem::WakeUpThreads(ezWorkerThreadType::LongTasks, uiNumTasks);
+      break;
+    }
+
+    case ezTaskPriority::FileAccess:
+    case ezTaskPriority::FileAccessHighPriority:
+    {
+      ezTaskSystem::WakeUpThreads(ezWorkerThreadType::FileAccess, uiNumTasks);
+      break;
+    }
+
+    case ezTaskPriority::SomeFrameMainThread:
+    case ezTaskPriority::ThisFrameMainThread:
+    case ezTaskPriority::ENUM_COUNT:
+      // nothing to do for these enum values
+      break;
+  }
+}
+
 void ezTaskSystem::ScheduleGroupTasks(ezTaskGroup* pGroup, bool bHighPriority)
 {
   if (pGroup->m_Tasks.IsEmpty())
@@ -143,6 +235,15 @@ void ezTaskSystem::ScheduleGroupTasks(ezTaskGroup* pGroup, bool bHighPriority)
     return;
   }
 
+  const ezTaskPriority::Enum priority = pGroup->m_Priority;
+
+  ezTaskWorkQueue* pWorkQueue = tl_TaskWorkerInfo.m_pWorkQueue;
+  if (s_pState->m_SchedulingMode == ezTaskSchedulingMode::WorkStealing && pWorkQueue != nullptr && ezTaskWorkQueue::IsPriorityHandled(priority))
+  {
+    ScheduleGroupTasksWorkStealing(pGroup, bHighPriority, *pWorkQueue);
+    return;
+  }
+
   ezInt32 iRemainingTasks = 0;
 
   // add all the tasks to the task list, so that they will be processed
@@ -174,55 +275,91 @@ void ezTaskSystem::ScheduleGroupTasks(ezTaskGroup* pGroup, bool bHighPriority)
         td.m_uiInvocation = mult;
 
         if (bHighPriority)
-          s_pState->m_Tasks[pGroup->m_Priority].PushFront(td);
+          s_pState->m_Tasks[priority].PushFront(td);
         else
-          s_pState->m_Tasks[pGroup->m_Priority].PushBack(td);
+          s_pState->m_Tasks[priority].PushBack(td);
       }
     }
 
-    // send the proper thread signal, to make sure one of the correct worker threads is awake
-    switch (pGroup->m_Priority)
+    UpdateGlobalTaskCount(priority);
+
+    WakeUpThreadsForPriority(priority, iRemainingTasks);
+  }
+}
+
+void ezTaskSystem::ScheduleGroupTasksWorkStealing(ezTaskGroup* pGroup, bool bHighPriority, ezTaskWorkQueue& ref_workQueue)
+{
+  const ezTaskPriority::Enum priority = pGroup->m_Priority;
+
+  ezInt32 iRemainingTasks = 0;
+  ezUInt32 uiNumWaitingTasks = 0;
+
+  for (auto pTask : pGroup->m_Tasks)
+  {
+    const ezUInt32 uiRuns = ezMath::Max(1u, pTask->m_uiMultiplicity);
+
+    iRemainingTasks += uiRuns;
+    pTask->m_iRemainingRuns = uiRuns;
+    pTask->m_bTaskIsScheduled = true;
+
+    if (pTask->m_NestingMode != ezTaskNesting::Never)
     {
-      case ezTaskPriority::EarlyThisFrame:
-      case ezTaskPriority::ThisFrame:
-      case ezTaskPriority::LateThisFrame:
-      case ezTaskPriority::EarlyNextFrame:
-      case ezTaskPriority::NextFrame:
-      case ezTaskPriority::LateNextFrame:
-      case ezTaskPriority::In2Frames:
-      case ezTaskPriority::In3Frames:
-      case ezTaskPriority::In4Frames:
-      case ezTaskPriority::In5Frames:
-      case ezTaskPriority::In6Frames:
-      case ezTaskPriority::In7Frames:
-      case ezTaskPriority::In8Frames:
-      case ezTaskPriority::In9Frames:
-      {
-        WakeUpThreads(ezWorkerThreadType::ShortTasks, iRemainingTasks);
-        break;
-      }
+      uiNumWaitingTasks += uiRuns;
+    }
+  }
 
-      case ezTaskPriority::LongRunning:
-      case ezTaskPriority::LongRunningHighPriority:
-      {
-        WakeUpThreads(ezWorkerThreadType::LongTasks, iRemainingTasks);
-        break;
-      }
+  pGroup->m_iNumRemainingTasks = iRemainingTasks;
 
-      case ezTaskPriority::FileAccess:
-      case ezTaskPriority::FileAccessHighPriority:
+  // The thread queues only store pointers into m_ScheduledTasks, so it has to be fully set up before the first task gets queued.
+  // Tasks that may wait are stored first, they go into the global list, where the nesting rules can be checked before handing them out.
+  auto& scheduled = pGroup->m_ScheduledTasks;
+  scheduled.Clear();
+  scheduled.Reserve(iRemainingTasks);
+
+  for (ezUInt32 pass = 0; pass < 2; ++pass)
+  {
+    const bool bNeverWaits = (pass == 1);
+
+    for (auto& pTask : pGroup->m_Tasks)
+    {
+      if ((pTask->m_NestingMode == ezTaskNesting::Never) != bNeverWaits)
+        continue;
+
+      for (ezUInt32 mult = 0; mult < ezMath::Max(1u, pTask->m_uiMultiplicity); ++mult)
       {
-        WakeUpThreads(ezWorkerThreadType::FileAccess, iRemainingTasks);
-        break;
+        TaskData& td = scheduled.ExpandAndGetRef();
+        td.m_pBelongsToGroup = pGroup;
+        td.m_pTask = pTask;
+        td.m_uiInvocation = mult;
       }
+    }
+  }
 
-      case ezTaskPriority::SomeFrameMainThread:
-      case ezTaskPriority::ThisFrameMainThread:
-      case ezTaskPriority::ENUM_COUNT:
-        // nothing to do for these enum values
-        break;
+  // once the last task is queued, the group may finish at any time and must not be accessed anymore
+  TaskData* pTasks = scheduled.GetData();
+
+  if (uiNumWaitingTasks > 0)
+  {
+    EZ_LOCK(s_TaskSystemMutex);
+
+    for (ezUInt32 i = 0; i < uiNumWaitingTasks; ++i)
+    {
+      if (bHighPriority)
+        s_pState->m_Tasks[priority].PushFront(pTasks[i]);
+      else
+        s_pState->m_Tasks[priority].PushBack(pTasks[i]);
     }
+
+    UpdateGlobalTaskCount(priority);
   }
+
+  auto& deque = ref_workQueue.GetDeque(priority);
+  for (ezUInt32 i = uiNumWaitingTasks; i < static_cast<ezUInt32>(iRemainingTasks); ++i)
+  {
+    deque.PushBottom(&pTasks[i]);
+  }
+
+  WakeUpThreadsForPriority(priority, iRemainingTasks);
 }
 
 void ezTaskSystem::DependencyHasFinished(ezTaskGroup* pGroup)
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <Foundation/Threading/Implementation/TaskGroup.h>
+#include <Foundation/Threading/Implementation/TaskWorkQueue.h>
 #include <Foundation/Threading/TaskSystem.h>
 
 class ezTaskSystemThreadState
@@ -8,6 +10,14 @@ private:
   friend class ezTaskSystem;
   friend class ezTaskWorkerThread;
 
+  // The maximum number of threads that may be allocated for each worker thread type (see SetWorkerThreadCount()).
+  static constexpr ezUInt32 s_uiMaxShortTaskWorkers = 1024;
+  static constexpr ezUInt32 s_uiMaxLongTaskWorkers = 1024;
+  static constexpr ezUInt32 s_uiMaxFileAccessWorkers = 128;
+
+  // One work queue for the main thread plus one for every worker thread that may be allocated.
+  static constexpr ezUInt32 s_uiMaxWorkQueues = 1 + s_uiMaxShortTaskWorkers + s_uiMaxLongTaskWorkers + s_uiMaxFileAccessWorkers;
+
   // The arrays of all the active worker threads.
   ezDynamicArray<ezTaskWorkerThread*> m_Workers[ezWorkerThreadType::ENUM_COUNT];
 
@@ -16,6 +26,15 @@ private:
 
   // the maximum number of worker threads that should be non-idle (and not blocked) at any time
   ezUInt32 m_uiMaxWorkersToUse[ezWorkerThreadType::ENUM_COUNT] = {};
+
+  // The queue of the main thread for ezTaskSchedulingMode::WorkStealing. The worker threads own their queues themselves.
+  ezTaskWorkQueue m_MainThreadQueue;
+
+  // All queues that idle threads may steal tasks from. Allocated once with a fixed size, so that it never relocates while others iterate it.
+  ezDynamicArray<ezTaskWorkQueue*> m_WorkQueues;
+
+  // the number of valid entries in m_WorkQueues, the main thread queue is always at index 0
+  std::atomic<ezUInt32> m_uiNumWorkQueues = 0;
 };
 
 class ezTaskSystemState
@@ -26,9 +45,22 @@ private:
   // The target frame time used by FinishFrameTasks()
   ezTime m_TargetFrameTime = ezTime::MakeFromSeconds(1.0 / 40.0); // => 25 ms
 
-  // The deque can grow without relocating existing data, therefore the ezTaskGroupID's can store pointers directly to the data
-  ezDeque<ezTaskGroup> m_TaskGroups;
+  // The pool never relocates existing groups, therefore the ezTaskGroupID's can store pointers directly to the data
+  ezTaskGroupPool m_TaskGroups;
 
   // The lists of all scheduled tasks, for each priority.
   ezList<ezTaskSystem::TaskData> m_Tasks[ezTaskPriority::ENUM_COUNT];
+
+  // The number of tasks in m_Tasks, readable without locking the mutex. Allows work stealing threads to skip empty lists.
+  std::atomic<ezUInt32> m_uiNumGlobalTasks[ezTaskPriority::ENUM_COUNT] = {};
+
+  // How tasks are distributed to the threads. May only change while the worker threads are stopped.
+  ezTaskSchedulingMode::Enum m_SchedulingMode = ezTaskSchedulingMode::Default;
+
+  // How many tasks were taken from the queue of another thread in ezTaskSchedulingMode::WorkStealing.
+  std::atomic<ezUInt64> m_uiNumStolenTasks = 0;
+
+  // Finished tasks that adaptive ParallelFor invocations have split off, they are reused instead of allocating a new task for every split.
+  ezMutex m_ParallelForRangeTasksMutex;
+  ezDynamicArray<ezSharedPtr<ezTask>> m_ParallelForRangeTasks;
 };
@@ -62,12 +62,25 @@ void ezTaskSystem::TaskHasFinished(ezSharedPtr<ezTask>&& pTask, ezTaskGroup* pGr
       EZ_LOCK(s_TaskSystemMutex);
 
       // unless an outside reference is held onto a task, this will deallocate the tasks
-      pGroup->m_Tasks.Clear();
-
-      for (ezUInt32 dep = 0; dep < pGroup->m_OthersDependingOnMe.GetCount(); ++dep)
+      if (!pGroup->m_bPersistent)
       {
-        DependencyHasFinished(pGroup->m_OthersDependingOnMe[dep].m_pTaskGroup);
+        pGroup->m_Tasks.Clear();
       }
+
+      pGroup->m_ScheduledTasks.Clear();
+    }
+
+    // from here on no other group can register itself as a dependent anymore
+    ezUInt32 uiLink = pGroup->TakeDependentsList();
+
+    while (uiLink != ezTaskGroup::EndOfDependentsList)
+    {
+      ezTaskGroup& dependent = s_pState->m_TaskGroups.GetGroup(ezTaskGroup::GetLinkGroupIndex(uiLink));
+
+      // read the next link first, the dependent group may get scheduled, finish and be reused right away
+      uiLink = dependent.m_DependsOnGroups[ezTaskGroup::GetLinkDependencyIndex(uiLink)].m_uiNextLink;
+
+      DependencyHasFinished(&dependent);
     }
 
     // wake up all threads that are waiting for this group
@@ -81,8 +94,15 @@ void ezTaskSystem::TaskHasFinished(ezSharedPtr<ezTask>&& pTask, ezTaskGroup* pGr
       pGroup->m_OnFinishedCallback(id);
     }
 
+    if (pGroup->m_bPersistent)
+    {
+      // the group may be restarted right away from here on
+      pGroup->m_bPersistentRunInProgress.store(false, std::memory_order_release);
+      return;
+    }
+
     // set this task available for reuse
-    pGroup->m_bInUse = false;
+    s_pState->m_TaskGroups.Release(pGroup);
   }
 }
 
@@ -94,6 +114,11 @@ ezTaskSystem::TaskData ezTaskSystem::GetNextTask(ezTaskPriority::Enum FirstPrior
   EZ_ASSERT_DEV(FirstPriority >= ezTaskPriority::EarlyThisFrame && LastPriority < ezTaskPriority::ENUM_COUNT, "Priority Range is invalid: {0} to {1}",
     FirstPriority, LastPriority);
 
+  if (s_pState->m_SchedulingMode == ezTaskSchedulingMode::WorkStealing)
+  {
+    return GetNextTaskWorkStealing(FirstPriority, LastPriority, bOnlyTasksThatNeverWait, WaitingForGroup, pWorkerState);
+  }
+
   EZ_LOCK(s_TaskSystemMutex);
 
   // go through all the task lists that this thread is willing to work on
@@ -106,6 +131,7 @@ ezTaskSystem::TaskData ezTaskSystem::GetNextTask(ezTaskPriority::Enum FirstPrior
         TaskData td = *it;
 
         s_pState->m_Tasks[prio].Remove(it);
+        UpdateGlobalTaskCount(prio);
         return td;
       }
     }
@@ -119,6 +145,184 @@ ezTaskSystem::TaskData ezTaskSystem::GetNextTask(ezTaskPriority::Enum FirstPrior
   return TaskData();
 }
 
+ezTaskSystem::TaskData ezTaskSystem::GetNextTaskWorkStealing(ezTaskPriority::Enum FirstPriority, ezTaskPriority::Enum LastPriority,
+  bool bOnlyTasksThatNeverWait, const ezTaskGroupID& WaitingForGroup, ezAtomicInteger32* pWorkerState)
+{
+  ezTaskWorkQueue* pOwnQueue = tl_TaskWorkerInfo.m_pWorkQueue;
+
+  while (true)
+  {
+    const ezUInt32 uiNumQueues = s_pThreadState->m_uiNumWorkQueues.load(std::memory_order_acquire);
+    const ezUInt32 uiFirstVictim = (pOwnQueue != nullptr) ? pOwnQueue->m_uiQueueIndex + 1 : 0;
+
+    for (ezUInt32 prio = FirstPriority; prio <= (ezUInt32)LastPriority; ++prio)
+    {
+      TaskData td;
+
+      if (ezTaskWorkQueue::IsPriorityHandled(prio))
+      {
+        // the thread queues only contain tasks that never wait, so they can be taken without checking the nesting rules
+
+        // prefer the most recently queued task of this thread, its data is most likely still in the cache
+        if (pOwnQueue != nullptr)
+        {
+          if (TaskData* pTask = pOwnQueue->GetDeque(prio).PopBottom())
+            return *pTask;
+        }
+
+        if (TakeTaskFromGlobalList(prio, bOnlyTasksThatNeverWait, WaitingForGroup, td))
+          return td;
+
+        // try to steal the oldest task from other threads, start at a different queue on every thread to spread out the contention
+        for (ezUInt32 i = 0; i < uiNumQueues; ++i)
+        {
+          ezTaskWorkQueue* pVictim = s_pThreadState->m_WorkQueues[(uiFirstVictim + i) % uiNumQueues];
+
+          if (pVictim == pOwnQueue)
+            continue;
+
+          if (TaskData* pTask = pVictim->GetDeque(prio).Steal())
+          {
+            s_pState->m_uiNumStolenTasks.fetch_add(1, std::memory_order_relaxed);
+            return *pTask;
+          }
+        }
+      }
+      else if (TakeTaskFromGlobalList(prio, bOnlyTasksThatNeverWait, WaitingForGroup, td))
+      {
+        return td;
+      }
+    }
+
+    if (pWorkerState == nullptr)
+      return TaskData();
+
+    EZ_VERIFY(pWorkerState->Set((int)ezTaskWorkerState::Idle) == (int)ezTaskWorkerState::Active, "Corrupt Worker State");
+
+    // Tasks are queued without holding the mutex, so some thread may have queued a task after we looked,
+    // but before we were marked as idle. In that case it might not have woken us up, because we still looked busy.
+    // Since the idle state is set with a full barrier, this check will see all tasks that were queued without waking us up.
+    if (!HasQueuedTasks(FirstPriority, LastPriority))
+      return TaskData();
+
+    if (!pWorkerState->TestAndSet((int)ezTaskWorkerState::Idle, (int)ezTaskWorkerState::Active))
+    {
+      // someone else has woken us up in the mean time and raised our wake-up signal, so we will return right away from sleeping
+      return TaskData();
+    }
+  }
+}
+
+bool ezTaskSystem::TakeTaskFromGlobalList(ezUInt32 uiPriority, bool bOnlyTasksThatNeverWait, const ezTaskGroupID& WaitingForGroup, TaskData& out_task)
+{
+  if (s_pState->m_uiNumGlobalTasks[uiPriority].load(std::memory_order_relaxed) == 0)
+    return false;
+
+  EZ_LOCK(s_TaskSystemMutex);
+
+  for (auto it = s_pState->m_Tasks[uiPriority].GetIterator(); it.IsValid(); ++it)
+  {
+    if (!bOnlyTasksThatNeverWait || (it->m_pTask->m_NestingMode == ezTaskNesting::Never) || it->m_pBelongsToGroup == WaitingForGroup.m_pTaskGroup)
+    {
+      out_task = *it;
+
+      s_pState->m_Tasks[uiPriority].Remove(it);
+      UpdateGlobalTaskCount(uiPriority);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool ezTaskSystem::HasQueuedTasks(ezTaskPriority::Enum FirstPriority, ezTaskPriority::Enum LastPriority)
+{
+  const ezUInt32 uiNumQueues = s_pThreadState->m_uiNumWorkQueues.load(std::memory_order_acquire);
+
+  for (ezUInt32 prio = FirstPriority; prio <= (ezUInt32)LastPriority; ++prio)
+  {
+    if (s_pState->m_uiNumGlobalTasks[prio].load(std::memory_order_relaxed) > 0)
+      return true;
+
+    if (!ezTaskWorkQueue::IsPriorityHandled(prio))
+      continue;
+
+    for (ezUInt32 i = 0; i < uiNumQueues; ++i)
+    {
+      if (!s_pThreadState->m_WorkQueues[i]->GetDeque(prio).IsEmpty())
+        return true;
+    }
+  }
+
+  return false;
+}
+
+bool ezTaskSystem::IsStarvingForWork(ezTaskPriority::Enum priority)
+{
+  // a sleeping worker picks up new work right away, even if other threads still have tasks queued in their local queues, which it could steal
+  if (priority >= ezTaskPriority::EarlyThisFrame && priority <= ezTaskPriority::In9Frames)
+  {
+    if (HasIdleWorkerThreads(ezWorkerThreadType::ShortTasks))
+      return true;
+  }
+  else if (priority == ezTaskPriority::LongRunningHighPriority || priority == ezTaskPriority::LongRunning)
+  {
+    if (HasIdleWorkerThreads(ezWorkerThreadType::LongTasks))
+      return true;
+  }
+
+  if (s_pState->m_uiNumGlobalTasks[priority].load(std::memory_order_relaxed) > 0)
+    return false;
+
+  // with work stealing, other threads take work from our own queue first
+  ezTaskWorkQueue* pWorkQueue = tl_TaskWorkerInfo.m_pWorkQueue;
+  if (s_pState->m_SchedulingMode == ezTaskSchedulingMode::WorkStealing && pWorkQueue != nullptr && ezTaskWorkQueue::IsPriorityHandled(priority))
+  {
+    return pWorkQueue->GetDeque(priority).IsEmpty();
+  }
+
+  return true;
+}
+
+void ezTaskSystem::MoveWorkQueueTasksToGlobalLists(ezTaskWorkQueue& ref_queue, bool bReprioritize)
+{
+  for (ezUInt32 prio = ezTaskWorkQueue::FirstPriority; prio <= ezTaskWorkQueue::LastPriority; ++prio)
+  {
+    ezUInt32 uiTargetPrio = prio;
+
+    // same mapping as in ReprioritizeFrameTasks()
+    if (bReprioritize)
+    {
+      if (prio >= ezTaskPriority::ThisFrame && prio <= ezTaskPriority::LateThisFrame)
+        uiTargetPrio = ezTaskPriority::EarlyThisFrame;
+      else if (prio >= ezTaskPriority::EarlyNextFrame && prio <= ezTaskPriority::LateNextFrame)
+        uiTargetPrio = prio - 3;
+      else if (prio >= ezTaskPriority::In2Frames && prio <= ezTaskPriority::In9Frames)
+        uiTargetPrio = prio - 1;
+      else
+        continue;
+    }
+
+    auto& deque = ref_queue.GetDeque(prio);
+
+    // other threads may still take tasks from the queue concurrently, so a failed steal doesn't mean that the queue is empty
+    while (!deque.IsEmpty())
+    {
+      if (TaskData* pTask = deque.Steal())
+      {
+        s_pState->m_Tasks[uiTargetPrio].PushBack(*pTask);
+      }
+    }
+
+    UpdateGlobalTaskCount(uiTargetPrio);
+  }
+}
+
+void ezTaskSystem::UpdateGlobalTaskCount(ezUInt32 uiPriority)
+{
+  s_pState->m_uiNumGlobalTasks[uiPriority].store(s_pState->m_Tasks[uiPriority].GetCount(), std::memory_order_relaxed);
+}
+
 bool ezTaskSystem::ExecuteTask(ezTaskPriority::Enum FirstPriority, ezTaskPriority::Enum LastPriority, bool bOnlyTasksThatNeverWait,
   const ezTaskGroupID& WaitingForGroup, ezAtomicInteger32* pWorkerState)
 {
@@ -191,6 +395,7 @@ ezResult ezTaskSystem::CancelTask(const ezSharedPtr<ezTask>& pTask, ezOnTaskRunn
             TaskHasFinished(std::move(it->m_pTask), it->m_pBelongsToGroup);
 
             s_pState->m_Tasks[i].Remove(it);
+            UpdateGlobalTaskCount(i);
             return EZ_SUCCESS;
           }
 
@@ -201,6 +406,7 @@ ezResult ezTaskSystem::CancelTask(const ezSharedPtr<ezTask>& pTask, ezOnTaskRunn
   }
 
   // if we made it here, the task was already running
+  // (or it sits in a work stealing queue, from which it cannot be removed, but it will skip its execution due to the cancel flag)
   // thus we just wait for it to finish
 
   if (onTaskRunning == ezOnTaskRunning::WaitTillFinished)
@@ -277,6 +483,21 @@ void ezTaskSystem::ReprioritizeFrameTasks()
     // remove the tasks from their current queue
     s_pState->m_Tasks[i].Clear();
   }
+
+  for (ezUInt32 i = (ezUInt32)ezTaskPriority::EarlyThisFrame; i <= (ezUInt32)ezTaskPriority::In9Frames; ++i)
+  {
+    UpdateGlobalTaskCount(i);
+  }
+
+  // the thread queues cannot be reordered, instead all 'later' tasks are moved into the global lists with their new priority
+  if (s_pState->m_SchedulingMode == ezTaskSchedulingMode::WorkStealing)
+  {
+    const ezUInt32 uiNumQueues = s_pThreadState->m_uiNumWorkQueues;
+    for (ezUInt32 i = 0; i < uiNumQueues; ++i)
+    {
+      MoveWorkQueueTasksToGlobalLists(*s_pThreadState->m_WorkQueues[i], true);
+    }
+  }
 }
 
 void ezTaskSystem::ExecuteSomeFrameTasks(ezTime smoothFrameTime)
@@ -47,9 +47,9 @@ void ezTaskSystem::SetWorkerThreadCount(ezInt32 iShortTasks, ezInt32 iLongTasks)
   StopWorkerThreads();
 
   // this only allocates pointers, i.e. the maximum possible number of threads that we may be able to realloc at runtime
-  s_pThreadState->m_Workers[ezWorkerThreadType::ShortTasks].SetCount(1024);
-  s_pThreadState->m_Workers[ezWorkerThreadType::LongTasks].SetCount(1024);
-  s_pThreadState->m_Workers[ezWorkerThreadType::FileAccess].SetCount(128);
+  s_pThreadState->m_Workers[ezWorkerThreadType::ShortTasks].SetCount(ezTaskSystemThreadState::s_uiMaxShortTaskWorkers);
+  s_pThreadState->m_Workers[ezWorkerThreadType::LongTasks].SetCount(ezTaskSystemThreadState::s_uiMaxLongTaskWorkers);
+  s_pThreadState->m_Workers[ezWorkerThreadType::FileAccess].SetCount(ezTaskSystemThreadState::s_uiMaxFileAccessWorkers);
 
   s_pThreadState->m_uiMaxWorkersToUse[ezWorkerThreadType::ShortTasks] = uiShortTasks;
   s_pThreadState->m_uiMaxWorkersToUse[ezWorkerThreadType::LongTasks] = uiLongTasks;
@@ -93,6 +93,29 @@ void ezTaskSystem::StopWorkerThreads()
     for (ezUInt32 i = 0; i < uiNumWorkers; ++i)
     {
       s_pThreadState->m_Workers[type][i]->Join();
+    }
+  }
+
+  {
+    EZ_LOCK(s_TaskSystemMutex);
+
+    // tasks that are still queued in the thread queues must not get lost, hand them over to the global lists
+    const ezUInt32 uiNumQueues = s_pThreadState->m_uiNumWorkQueues;
+    for (ezUInt32 i = 0; i < uiNumQueues; ++i)
+    {
+      MoveWorkQueueTasksToGlobalLists(*s_pThreadState->m_WorkQueues[i], false);
+    }
+
+    // only the main thread queue remains
+    s_pThreadState->m_uiNumWorkQueues = 1;
+  }
+
+  for (ezUInt32 type = 0; type < ezWorkerThreadType::ENUM_COUNT; ++type)
+  {
+    const ezUInt32 uiNumWorkers = s_pThreadState->m_iAllocatedWorkers[type];
+
+    for (ezUInt32 i = 0; i < uiNumWorkers; ++i)
+    {
       EZ_DEFAULT_DELETE(s_pThreadState->m_Workers[type][i]);
     }
 
@@ -117,8 +140,18 @@ void ezTaskSystem::AllocateThreads(ezWorkerThreadType::Enum type, ezUInt32 uiAdd
 
     for (ezUInt32 i = 0; i < uiAddThreads; ++i)
     {
-      s_pThreadState->m_Workers[type][uiNextThreadIdx] = EZ_DEFAULT_NEW(ezTaskWorkerThread, (ezWorkerThreadType::Enum)type, uiNextThreadIdx);
-      s_pThreadState->m_Workers[type][uiNextThreadIdx]->Start();
+      ezTaskWorkerThread* pWorker = EZ_DEFAULT_NEW(ezTaskWorkerThread, (ezWorkerThreadType::Enum)type, uiNextThreadIdx);
+      s_pThreadState->m_Workers[type][uiNextThreadIdx] = pWorker;
+
+      // make the queue of the new thread visible to everyone who wants to steal work
+      const ezUInt32 uiQueueIdx = s_pThreadState->m_uiNumWorkQueues;
+      EZ_ASSERT_ALWAYS(uiQueueIdx < ezTaskSystemThreadState::s_uiMaxWorkQueues, "Max number of work queues ({}) exceeded.", ezTaskSystemThreadState::s_uiMaxWorkQueues);
+
+      pWorker->GetWorkQueue().m_uiQueueIndex = uiQueueIdx;
+      s_pThreadState->m_WorkQueues[uiQueueIdx] = &pWorker->GetWorkQueue();
+      s_pThreadState->m_uiNumWorkQueues = uiQueueIdx + 1;
+
+      pWorker->Start();
 
       ++uiNextThreadIdx;
     }
@@ -190,6 +223,25 @@ double ezTaskSystem::GetThreadUtilization(ezWorkerThreadType::Enum type, ezUInt3
   return s_pThreadState->m_Workers[type][uiThreadIndex]->GetThreadUtilization(pNumTasksExecuted);
 }
 
+bool ezTaskSystem::HasIdleWorkerThreads(ezWorkerThreadType::Enum type)
+{
+  // same rules as in WakeUpThreads(): blocked threads don't count, threads beyond m_uiMaxWorkersToUse are only woken up to replace blocked ones
+  const ezUInt32 uiTotalThreads = s_pThreadState->m_iAllocatedWorkers[type];
+  const ezUInt32 uiAllowedActiveThreads = s_pThreadState->m_uiMaxWorkersToUse[type];
+  ezUInt32 uiActiveThreads = 0;
+
+  for (ezUInt32 threadIdx = 0; threadIdx < uiTotalThreads; ++threadIdx)
+  {
+    if (s_pThreadState->m_Workers[type][threadIdx]->GetWorkerState() == ezTaskWorkerState::Active)
+    {
+      if (++uiActiveThreads >= uiAllowedActiveThreads)
+        return false;
+    }
+  }
+
+  return true;
+}
+
 void ezTaskSystem::DetermineTasksToExecuteOnThread(ezTaskPriority::Enum& out_FirstPriority, ezTaskPriority::Enum& out_LastPriority)
 {
   switch (tl_TaskWorkerInfo.m_WorkerType)
@@ -75,7 +75,7 @@ void ezTaskSystem::WriteStateSnapshotToDGML(ezDGMLGraph& ref_graph)
 
   for (ezUInt32 g = 0; g < s_pState->m_TaskGroups.GetCount(); ++g)
   {
-    const ezTaskGroup& tg = s_pState->m_TaskGroups[g];
+    const ezTaskGroup& tg = s_pState->m_TaskGroups.GetGroup(g);
 
     if (!tg.m_bInUse)
       continue;
@@ -109,15 +109,16 @@ void ezTaskSystem::WriteStateSnapshotToDGML(ezDGMLGraph& ref_graph)
 
   for (ezUInt32 g = 0; g < s_pState->m_TaskGroups.GetCount(); ++g)
   {
-    const ezTaskGroup& tg = s_pState->m_TaskGroups[g];
+    const ezTaskGroup& tg = s_pState->m_TaskGroups.GetGroup(g);
 
     if (!tg.m_bInUse)
       continue;
 
     const ezDGMLGraph::NodeId ownNodeId = groupNodeIds[&tg];
 
-    for (const ezTaskGroupID& dependsOn : tg.m_DependsOnGroups)
+    for (const ezTaskGroup::DependencyLink& link : tg.m_DependsOnGroups)
     {
+      const ezTaskGroupID& dependsOn = link.m_DependsOn;
       ezDGMLGraph::NodeId otherNodeId;
 
       // filter out already fulfilled dependencies
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Threading/TaskSystem.h>
+
+#include <atomic>
+
+/// \internal A lock-free, growable work-stealing deque (Chase-Lev).
+///
+/// Only the owning thread may call PushBottom() and PopBottom(), every thread may call Steal().
+/// The owner works LIFO on its own end, which keeps recently spawned (and thus cache-hot) work local,
+/// while other threads take the oldest items from the opposite end.
+///
+/// Buffers that were replaced while growing are kept alive until the deque is destroyed,
+/// because a concurrent thief may still read from them.
+///
+/// T must be a pointer type, because items are read and written with single atomic operations.
+template <typename T>
+class ezTaskWorkStealingDeque
+{
+  EZ_DISALLOW_COPY_AND_ASSIGN(ezTaskWorkStealingDeque);
+
+public:
+  ezTaskWorkStealingDeque(ezUInt32 uiInitialCapacity = 64)
+  {
+    EZ_ASSERT_DEV(ezMath::IsPowerOf2(uiInitialCapacity), "Capacity must be a power of two");
+    m_pBuffer.store(CreateBuffer(uiInitialCapacity), std::memory_order_relaxed);
+  }
+
+  ~ezTaskWorkStealingDeque()
+  {
+    DestroyBuffer(m_pBuffer.load(std::memory_order_relaxed));
+
+    for (Buffer* pBuffer : m_RetiredBuffers)
+    {
+      DestroyBuffer(pBuffer);
+    }
+  }
+
+  /// \brief Adds an item at the owner's end. Must only be called by the owning thread.
+  void PushBottom(T item)
+  {
+    const ezInt64 b = m_iBottom.load(std::memory_order_relaxed);
+    const ezInt64 t = m_iTop.load(std::memory_order_acquire);
+    Buffer* pBuffer = m_pBuffer.load(std::memory_order_relaxed);
+
+    if (b - t > static_cast<ezInt64>(pBuffer->m_uiMask))
+    {
+      pBuffer = Grow(pBuffer, t, b);
+    }
+
+    pBuffer->m_pItems[b & pBuffer->m_uiMask].store(item, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_iBottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  /// \brief Removes the most recently pushed item. Must only be called by the owning thread. Returns nullptr if the deque is empty.
+  T PopBottom()
+  {
+    const ezInt64 b = m_iBottom.load(std::memory_order_relaxed) - 1;
+    Buffer* pBuffer = m_pBuffer.load(std::memory_order_relaxed);
+    m_iBottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    ezInt64 t = m_iTop.load(std::memory_order_relaxed);
+
+    if (t > b)
+    {
+      // deque was empty
+      m_iBottom.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    T item = pBuffer->m_pItems[b & pBuffer->m_uiMask].load(std::memory_order_relaxed);
+
+    if (t == b)
+    {
+      // this is the last item, race against thieves for it
+      if (!m_iTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      {
+        item = nullptr;
+      }
+
+      m_iBottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    return item;
+  }
+
+  /// \brief Removes the oldest item. May be called from any thread.
+  ///
+  /// Returns nullptr if the deque is empty or another thread took the item first.
+  T Steal()
+  {
+    ezInt64 t = m_iTop.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const ezInt64 b = m_iBottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+      return nullptr;
+
+    Buffer* pBuffer = m_pBuffer.load(std::memory_order_acquire);
+    T item = pBuffer->m_pItems[t & pBuffer->m_uiMask].load(std::memory_order_relaxed);
+
+    if (!m_iTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      return nullptr;
+
+    return item;
+  }
+
+  /// \brief Returns whether the deque currently appears to be empty. The result may be outdated by the time it is returned.
+  bool IsEmpty() const
+  {
+    const ezInt64 t = m_iTop.load(std::memory_order_acquire);
+    const ezInt64 b = m_iBottom.load(std::memory_order_acquire);
+    return t >= b;
+  }
+
+private:
+  struct Buffer
+  {
+    ezUInt64 m_uiMask = 0;
+    std::atomic<T>* m_pItems = nullptr;
+  };
+
+  static Buffer* CreateBuffer(ezUInt32 uiCapacity)
+  {
+    Buffer* pBuffer = EZ_DEFAULT_NEW(Buffer);
+    pBuffer->m_uiMask = uiCapacity - 1;
+    pBuffer->m_pItems = EZ_DEFAULT_NEW_RAW_BUFFER(std::atomic<T>, uiCapacity);
+    return pBuffer;
+  }
+
+  static void DestroyBuffer(Buffer* pBuffer)
+  {
+    EZ_DEFAULT_DELETE_RAW_BUFFER(pBuffer->m_pItems);
+    EZ_DEFAULT_DELETE(pBuffer);
+  }
+
+  Buffer* Grow(Buffer* pOldBuffer, ezInt64 t, ezInt64 b)
+  {
+    Buffer* pNewBuffer = CreateBuffer(static_cast<ezUInt32>(pOldBuffer->m_uiMask + 1) * 2);
+
+    for (ezInt64 i = t; i < b; ++i)
+    {
+      pNewBuffer->m_pItems[i & pNewBuffer->m_uiMask].store(pOldBuffer->m_pItems[i & pOldBuffer->m_uiMask].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    m_RetiredBuffers.PushBack(pOldBuffer);
+    m_pBuffer.store(pNewBuffer, std::memory_order_release);
+    return pNewBuffer;
+  }
+
+  // top and bottom are written by different threads, keep them on separate cache lines
+  std::atomic<ezInt64> m_iTop = 0;
+  ezUInt8 m_TopPadding[64 - sizeof(std::atomic<ezInt64>)];
+  std::atomic<ezInt64> m_iBottom = 0;
+  ezUInt8 m_BottomPadding[64 - sizeof(std::atomic<ezInt64>)];
+  std::atomic<Buffer*> m_pBuffer;
+  ezDynamicArray<Buffer*> m_RetiredBuffers;
+};
+
+/// \internal The per-thread task queues that are used by ezTaskSchedulingMode::WorkStealing.
+///
+/// There is one deque for every priority that is executed by the short and long task worker threads.
+/// Main thread and file access tasks always go through the global task lists.
+class ezTaskWorkQueue
+{
+  EZ_DISALLOW_COPY_AND_ASSIGN(ezTaskWorkQueue);
+
+public:
+  ezTaskWorkQueue() = default;
+
+  static constexpr ezUInt32 FirstPriority = ezTaskPriority::EarlyThisFrame;
+  static constexpr ezUInt32 LastPriority = ezTaskPriority::LongRunning;
+
+  EZ_ALWAYS_INLINE static bool IsPriorityHandled(ezUInt32 uiPriority) { return uiPriority <= LastPriority; }
+
+  EZ_ALWAYS_INLINE ezTaskWorkStealingDeque<ezTaskSystem::TaskData*>& GetDeque(ezUInt32 uiPriority) { return m_Deques[uiPriority - FirstPriority]; }
+
+  /// Index of this queue in ezTaskSystemThreadState::m_WorkQueues, used to spread out which queues idle threads try to steal from first.
+  ezUInt32 m_uiQueueIndex = 0;
+
+private:
+  ezTaskWorkStealingDeque<ezTaskSystem::TaskData*> m_Deques[LastPriority - FirstPriority + 1];
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Foundation/Threading/Implementation/TaskSystemDeclarations.h>
+#include <Foundation/Threading/Implementation/TaskWorkQueue.h>
 
 #include <Foundation/Threading/Thread.h>
 #include <Foundation/Threading/ThreadSignal.h>
@@ -21,6 +22,9 @@ public:
   /// \brief Deactivates the thread. Returns failure, if the thread is currently still running.
   ezResult DeactivateWorker();
 
+  /// \brief The queue into which this thread pushes the tasks that it schedules, when ezTaskSchedulingMode::WorkStealing is active.
+  ezTaskWorkQueue& GetWorkQueue() { return m_WorkQueue; }
+
 private:
   // Which types of tasks this thread should work on.
   ezWorkerThreadType::Enum m_WorkerType;
@@ -31,6 +35,9 @@ private:
   // For display purposes.
   ezUInt16 m_uiWorkerThreadNumber = 0xFFFF;
 
+  // Tasks scheduled by this thread in ezTaskSchedulingMode::WorkStealing.
+  ezTaskWorkQueue m_WorkQueue;
+
   ///@}
 
   /// \name Thread Utilization
@@ -60,6 +67,9 @@ public:
   /// \brief If the thread is currently idle, this will wake it up and return EZ_SUCCESS.
   ezTaskWorkerState WakeUpIfIdle();
 
+  /// \brief Returns whether the thread is currently working, sleeping or blocked.
+  ezTaskWorkerState GetWorkerState() const { return static_cast<ezTaskWorkerState>((ezInt32)m_iWorkerState); }
+
 private:
   // Puts the thread to sleep (idle state)
   void WaitForWork();
@@ -85,6 +95,7 @@ struct ezTaskWorkerInfo
   ezInt32 m_iWorkerIndex = -1;
   const char* m_szTaskName = nullptr;
   ezAtomicInteger32* m_pWorkerState = nullptr;
+  ezTaskWorkQueue* m_pWorkQueue = nullptr;
 };
 
 extern thread_local ezTaskWorkerInfo tl_TaskWorkerInfo;
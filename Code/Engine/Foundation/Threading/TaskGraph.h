@@ -0,0 +1,118 @@
+#pragma once
+
+#include <Foundation/Threading/TaskSystem.h>
+
+/// \brief A graph of tasks and their dependencies that is built once and can then be launched any number of times.
+///
+/// Systems that run the same tasks with the same dependencies every frame would otherwise have to recreate all task groups and
+/// dependencies each time. Instead, they can record the tasks into an ezTaskGraph once and call Compile(), which validates the graph
+/// and determines the order in which nodes should be started. Compile() also creates one task group per node, which is kept and reused for
+/// every launch. Launching the compiled graph then only resets one atomic counter per node and starts the nodes without dependencies.
+/// Dependencies are tracked by the graph itself, no task group dependencies need to be registered with the ezTaskSystem.
+///
+/// Each node can be given a cost estimate. Whenever several nodes become ready at the same time, the ones with the longest remaining
+/// path through the graph (the critical path) are started first.
+///
+/// The graph (and its tasks) must stay alive and must not be modified while it is running.
+class EZ_FOUNDATION_DLL ezTaskGraph
+{
+  EZ_DISALLOW_COPY_AND_ASSIGN(ezTaskGraph);
+
+public:
+  using NodeIndex = ezUInt32;
+
+  ezTaskGraph();
+  ~ezTaskGraph();
+
+  /// \brief Removes all nodes and dependencies. The graph must not be running.
+  void Clear(); // [tested]
+
+  /// \brief Adds a node that executes the given task. The cost estimate is only used to decide which nodes to start first.
+  NodeIndex AddNode(const ezSharedPtr<ezTask>& pTask, float fCostEstimate = 1.0f); // [tested]
+
+  /// \brief Makes \a node wait for \a dependsOn to finish.
+  void AddDependency(NodeIndex node, NodeIndex dependsOn); // [tested]
+
+  /// \brief Validates the graph and prepares it for execution.
+  ///
+  /// Returns EZ_FAILURE if the dependencies contain a cycle. The graph can't be launched in that case.
+  /// Adding nodes or dependencies afterwards requires another call to Compile().
+  ezResult Compile(); // [tested]
+
+  /// \brief Returns whether the graph has been successfully compiled since it was last modified.
+  bool IsCompiled() const { return m_bCompiled; } // [tested]
+
+  /// \brief Returns the number of nodes in the graph.
+  ezUInt32 GetNodeCount() const { return m_Nodes.GetCount(); } // [tested]
+
+  /// \brief Updates the cost estimate of a node. This does not require the graph to be recompiled.
+  void SetNodeCostEstimate(NodeIndex node, float fCostEstimate); // [tested]
+
+  /// \brief Returns the cost estimate of a node.
+  float GetNodeCostEstimate(NodeIndex node) const { return m_Nodes[node].m_fCostEstimate; } // [tested]
+
+  /// \brief Returns all nodes in topological order, as determined by the last call to Compile().
+  ezArrayPtr<const NodeIndex> GetTopologicalOrder() const { return m_TopologicalOrder; } // [tested]
+
+  /// \brief Starts executing the compiled graph with the given priority.
+  ///
+  /// Returns the ID of a task group that finishes once all nodes have finished. It can be used to wait for the graph,
+  /// or as a dependency for other task groups.
+  ezTaskGroupID Launch(ezTaskPriority::Enum priority); // [tested]
+
+  /// \brief Returns whether the graph was launched and has not yet finished.
+  bool IsRunning() const { return !ezTaskSystem::IsTaskGroupFinished(m_CompletionGroup); } // [tested]
+
+private:
+  struct Node
+  {
+    ezTaskGraph* m_pGraph = nullptr;
+    ezSharedPtr<ezTask> m_pTask;
+    float m_fCostEstimate = 1.0f;
+
+    // the cost of this node plus the cost of the most expensive path through all nodes that depend on it
+    float m_fCriticalPathCost = 0.0f;
+
+    ezUInt32 m_uiNumDependencies = 0;
+    ezUInt32 m_uiFirstDependent = 0;
+    ezUInt32 m_uiNumDependents = 0;
+    ezAtomicInteger32 m_iRemainingDependencies;
+
+    // created by Compile() and restarted for every launch
+    ezTaskGroup* m_pTaskGroup = nullptr;
+
+    void OnTaskGroupFinished(ezTaskGroupID groupID);
+  };
+
+  void CreateTaskGroups();
+  void ReleaseTaskGroups();
+  void UpdateSchedulingOrder();
+  void StartNode(NodeIndex node);
+  void NodeHasFinished(NodeIndex node);
+
+  struct Dependency
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    NodeIndex m_Node;
+    NodeIndex m_DependsOn;
+  };
+
+  bool m_bCompiled = false;
+  bool m_bSchedulingOrderValid = false;
+  ezTaskPriority::Enum m_Priority = ezTaskPriority::ThisFrame;
+  ezTaskGroup* m_pCompletionGroup = nullptr;
+  ezTaskGroupID m_CompletionGroup;
+  ezAtomicInteger32 m_iRemainingNodes;
+
+  ezDynamicArray<Node> m_Nodes;
+  ezDynamicArray<Dependency> m_Dependencies;
+
+  // the dependents of each node, stored consecutively per node (see Node::m_uiFirstDependent) and sorted by critical path cost
+  ezDynamicArray<NodeIndex> m_Dependents;
+
+  // all nodes without dependencies, sorted by critical path cost
+  ezDynamicArray<NodeIndex> m_RootNodes;
+
+  ezDynamicArray<NodeIndex> m_TopologicalOrder;
+};
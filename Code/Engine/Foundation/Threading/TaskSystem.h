@@ -72,6 +72,9 @@ public:
   /// Therefore when bWaitForIt is true, this function might block for a very long time.
   /// It is advised to implement tasks that need to be canceled regularly (e.g. path searches for units that might die)
   /// in a way that allows for quick canceling.
+  ///
+  /// With ezTaskSchedulingMode::WorkStealing, tasks that already sit in a thread's local queue cannot be removed anymore.
+  /// They are flagged as canceled, skip their execution once they are dequeued and are treated like already running tasks.
   static ezResult CancelTask(const ezSharedPtr<ezTask>& pTask, ezOnTaskRunning::Enum onTaskRunning = ezOnTaskRunning::WaitTillFinished); // [tested]
 
   struct TaskData
@@ -99,6 +102,22 @@ private:
   /// \brief Executes tasks of priority 'SomeFrameMainThread', as long as the last duration between frames is no longer than fSmoothFrameMS.
   static void ExecuteSomeFrameTasks(ezTime smoothFrameTime);
 
+  /// \brief GetNextTask() for ezTaskSchedulingMode::WorkStealing. Only locks the global mutex, if a global task list is not empty.
+  static TaskData GetNextTaskWorkStealing(ezTaskPriority::Enum FirstPriority, ezTaskPriority::Enum LastPriority, bool bOnlyTasksThatNeverWait,
+    const ezTaskGroupID& WaitingForGroup, ezAtomicInteger32* pWorkerState);
+
+  /// \brief Tries to take a task of the given priority from the global list. Only tasks matching the nesting / waiting rules are returned.
+  static bool TakeTaskFromGlobalList(ezUInt32 uiPriority, bool bOnlyTasksThatNeverWait, const ezTaskGroupID& WaitingForGroup, TaskData& out_task);
+
+  /// \brief Returns whether any global list or thread queue in the given priority range appears to contain tasks.
+  static bool HasQueuedTasks(ezTaskPriority::Enum FirstPriority, ezTaskPriority::Enum LastPriority);
+
+  /// \brief Moves all tasks from the per-thread queues into the global lists. The task system mutex must be locked.
+  static void MoveWorkQueueTasksToGlobalLists(ezTaskWorkQueue& ref_queue, bool bReprioritize);
+
+  /// \brief Publishes the number of tasks in the global list of the given priority. The task system mutex must be locked.
+  static void UpdateGlobalTaskCount(ezUInt32 uiPriority);
+
 
   /// \brief Helps executing tasks that are suitable for the calling thread. Returns true if a task was found and executed.
   static bool HelpExecutingTasks(const ezTaskGroupID& WaitingForGroup);
@@ -169,10 +188,28 @@ public:
   /// thus guaranteeing, that there are enough unblocked threads in the system to do all the work.
   static void WaitForCondition(ezDelegate<bool()> condition);
 
+private:
+  friend class ezTaskGraph;
+
+  /// \brief Creates a group that keeps \a pTask and is not recycled when it finishes, so that it can be run any number of times.
+  ///
+  /// The group starts out as finished. Each run has to be prepared with RestartPersistentTaskGroup().
+  /// Once the group isn't needed anymore, it has to be given back with ReleasePersistentTaskGroup().
+  static ezTaskGroup* CreatePersistentTaskGroup(const ezSharedPtr<ezTask>& pTask, ezOnTaskGroupFinishedCallback callback);
+
+  /// \brief Prepares another run of a finished persistent group and returns its ID, which can then be passed to StartTaskGroup().
+  static ezTaskGroupID RestartPersistentTaskGroup(ezTaskGroup* pGroup, ezTaskPriority::Enum priority);
+
+  /// \brief Puts a persistent group back into the pool. The group must not be running.
+  static void ReleasePersistentTaskGroup(ezTaskGroup* pGroup);
+
 private:
   /// \brief Takes all the tasks in the given group and schedules them for execution, by inserting them into the proper task lists.
   static void ScheduleGroupTasks(ezTaskGroup* pGroup, bool bHighPriority);
 
+  /// \brief ScheduleGroupTasks() for ezTaskSchedulingMode::WorkStealing. Tasks that never wait are pushed into the calling thread's queue.
+  static void ScheduleGroupTasksWorkStealing(ezTaskGroup* pGroup, bool bHighPriority, ezTaskWorkQueue& ref_workQueue);
+
   /// \brief Is called whenever a dependency of pGroup has finished. Once all dependencies are finished, the group's tasks will get scheduled.
   static void DependencyHasFinished(ezTaskGroup* pGroup);
 
@@ -217,6 +254,18 @@ public:
   /// \brief [internal] Wakes up or allocates up to \a uiNumThreads, unless enough threads are currently active and not blocked
   static void WakeUpThreads(ezWorkerThreadType::Enum type, ezUInt32 uiNumThreads);
 
+  /// \brief Selects how scheduled tasks are distributed to the threads. See ezTaskSchedulingMode.
+  ///
+  /// Changing the mode restarts all worker threads, similar to SetWorkerThreadCount(). Tasks that are queued at that time are preserved.
+  /// This should not be called while other threads are scheduling tasks.
+  static void SetSchedulingMode(ezTaskSchedulingMode::Enum mode); // [tested]
+
+  /// \brief Returns the currently active scheduling mode.
+  static ezTaskSchedulingMode::Enum GetSchedulingMode(); // [tested]
+
+  /// \brief Returns how many tasks idle threads have taken from the queues of other threads so far, in ezTaskSchedulingMode::WorkStealing.
+  static ezUInt64 GetNumStolenTasks(); // [tested]
+
 private:
   friend class ezTaskWorkerThread;
 
@@ -226,6 +275,9 @@ private:
   /// \brief Shuts down all worker threads. Does NOT finish the remaining tasks that were not started yet. Does not clear them either, though.
   static void StopWorkerThreads();
 
+  /// \brief Returns whether fewer threads of \a type are working than should be, i.e. whether WakeUpThreads() would find an idle thread to run a new task.
+  static bool HasIdleWorkerThreads(ezWorkerThreadType::Enum type);
+
   /// \brief Uses a thread local variable to know the current thread type and to decide the range of task priorities that it may execute
   static void DetermineTasksToExecuteOnThread(ezTaskPriority::Enum& out_FirstPriority, ezTaskPriority::Enum& out_LastPriority);
 
@@ -270,7 +322,22 @@ public:
   static void ParallelForSingleIndex(
     ezArrayPtr<ElemType> taskItems, Callback taskCallback, const char* szTaskName = nullptr, const ezParallelForParams& params = ezParallelForParams());
 
+  /// \brief Returns the cost per item that was measured for ParallelFor invocations with the given task name and ezParallelForParams::m_bAdaptive enabled.
+  ///
+  /// Returns zero, if no such invocation has been measured yet.
+  static ezTime GetParallelForItemCost(const char* szTaskName); // [tested]
+
 private:
+  friend class ezParallelForRangeTask;
+
+  static void ParallelForAdaptive(ezUInt64 uiStartIndex, ezUInt64 uiNumItems, const ezParallelForIndexedFunction64& taskCallback, const char* szTaskName, const ezParallelForParams& params);
+
+  /// \brief Executes the given range of an adaptive ParallelFor in batches and hands off halves of it to other threads when they are idle.
+  static void ParallelForAdaptiveRange(ezParallelForAdaptiveState& ref_state, ezUInt64 uiStartIndex, ezUInt64 uiEndIndex);
+
+  /// \brief Returns true if a worker thread for the given priority is idle, or if there are no queued tasks of that priority that idle threads could pick up.
+  static bool IsStarvingForWork(ezTaskPriority::Enum priority);
+
   template <typename ElemType>
   static void ParallelForInternal(
     ezArrayPtr<ElemType> taskItems, ezParallelForFunction<ElemType> taskCallback, const char* taskName, const ezParallelForParams& params);
@@ -30,8 +30,18 @@ public:
   EZ_ALWAYS_INLINE const ezDebugRendererContext& GetViewDebugContext() const { return m_ViewDebugContext; }
 
   void AddRenderData(const ezRenderData* pRenderData, ezRenderData::Category category);
+
+  /// \brief Appends all render data that was added to \a other, in the same order.
+  ///
+  /// The sorting keys are taken over as they are, so \a other must have been set up with the same camera.
+  void AddRenderData(const ezExtractedRenderData& other);
+
   void AddFrameData(const ezRenderData* pFrameData);
 
+  /// \brief Sorts the render data of every category and groups it into batches.
+  ///
+  /// Categories with many entries are sorted with a radix sort on the sorting key and batch ID, and categories are sorted in parallel on
+  /// the task system if there is enough render data overall.
   void SortAndBatch();
 
   void Clear();
@@ -48,12 +58,31 @@ public:
 private:
   const ezRenderData* GetFrameData(const ezRTTI* pRtti) const;
 
+  struct RadixSortEntry
+  {
+    EZ_DECLARE_POD_TYPE();
+
+    ezUInt64 m_uiSortingKey;
+    ezUInt32 m_uiBatchId;
+    ezUInt32 m_uiIndex;
+  };
+
   struct DataPerCategory
   {
     ezDynamicArray<ezRenderDataBatch> m_Batches;
     ezDynamicArray<ezRenderDataBatch::SortableRenderData> m_SortableRenderData;
+
+    // Scratch data for sorting and batching, kept around so that it doesn't need to be allocated every frame
+    ezDynamicArray<RadixSortEntry> m_SortEntries;
+    ezDynamicArray<RadixSortEntry> m_SortEntriesTemp;
+    ezDynamicArray<ezRenderDataBatch::SortableRenderData> m_SortedRenderData;
+    ezDynamicArray<ezUInt32> m_SortedBatchIds;
+    ezDynamicArray<const ezRTTI*> m_Types;
+    ezDynamicArray<const ezRTTI*> m_SortedTypes;
   };
 
+  static void SortAndBatchCategory(DataPerCategory& ref_dataPerCategory);
+
   ezCamera m_Camera;
   ezCamera m_LodCamera; // Temporary until we have a real LOD system
   ezViewData m_ViewData;
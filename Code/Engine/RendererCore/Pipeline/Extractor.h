@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Foundation/Strings/HashedString.h>
+#include <Foundation/Types/UniquePtr.h>
 #include <RendererCore/Pipeline/RenderData.h>
 
 class ezStreamWriter;
@@ -34,6 +35,12 @@ protected:
   /// \brief extracts the render data for the given object.
   void ExtractRenderData(const ezView& view, const ezGameObject* pObject, ezMsgExtractRenderData& msg, ezExtractedRenderData& extractedRenderData) const;
 
+  /// \brief Same as above, but counts the cached and uncached render data into the given variables instead of the extractor's stats.
+  ///
+  /// This makes it possible to extract different objects from multiple threads at the same time.
+  void ExtractRenderData(const ezView& view, const ezGameObject* pObject, ezMsgExtractRenderData& msg, ezExtractedRenderData& extractedRenderData,
+    ezUInt32& inout_uiNumCachedRenderData, ezUInt32& inout_uiNumUncachedRenderData) const;
+
 private:
   friend class ezRenderPipeline;
 
@@ -59,9 +66,26 @@ public:
   ezVisibleObjectsExtractor(const char* szName = "VisibleObjectsExtractor");
   ~ezVisibleObjectsExtractor();
 
+  /// \brief Extracts the render data of all visible objects.
+  ///
+  /// If there are enough visible objects, they are split into consecutive chunks which are extracted in parallel on the task system.
+  /// Every chunk writes into its own render data list and the lists are appended in chunk order afterwards,
+  /// so the result is exactly the same as with serial extraction.
   virtual void Extract(const ezView& view, const ezDynamicArray<const ezGameObject*>& visibleObjects, ezExtractedRenderData& ref_extractedRenderData) override;
   virtual ezResult Serialize(ezStreamWriter& inout_stream) const override;
   virtual ezResult Deserialize(ezStreamReader& inout_stream) override;
+
+private:
+  void ExtractParallel(const ezView& view, const ezDynamicArray<const ezGameObject*>& visibleObjects, ezExtractedRenderData& ref_extractedRenderData, ezUInt32 uiNumChunks);
+
+  struct ExtractionChunk
+  {
+    ezUniquePtr<ezExtractedRenderData> m_pRenderData;
+    ezUInt32 m_uiNumCachedRenderData = 0;
+    ezUInt32 m_uiNumUncachedRenderData = 0;
+  };
+
+  ezDynamicArray<ExtractionChunk> m_ExtractionChunks;
 };
 
 class EZ_RENDERERCORE_DLL ezSelectedObjectsExtractorBase : public ezExtractor
@@ -1,8 +1,108 @@
 #include <RendererCore/RendererCorePCH.h>
 
+#include <Foundation/Configuration/CVar.h>
 #include <Foundation/Profiling/Profiling.h>
+#include <Foundation/SimdMath/SimdVec4i.h>
+#include <Foundation/Threading/TaskSystem.h>
 #include <RendererCore/Pipeline/ExtractedRenderData.h>
 
+ezCVarBool cvar_RenderingSortingRadixSort("Rendering.Sorting.RadixSort", true, ezCVarFlags::Default, "Sort large render data categories with a radix sort instead of a comparison sort");
+ezCVarBool cvar_RenderingSortingMultithreaded("Rendering.Sorting.Multithreaded", true, ezCVarFlags::Default, "Sort the render data categories in parallel");
+
+namespace
+{
+  // Below this, a comparison sort is faster than the fixed cost of the radix sort histograms
+  constexpr ezUInt32 s_uiMinRenderDataForRadixSort = 256;
+  constexpr ezUInt32 s_uiMinRenderDataForParallelSorting = 4096;
+
+  /// LSD radix sort with 8 bits per pass on the 96 bit value of sorting key (high bits) and batch ID (low bits).
+  /// Passes in which all entries have the same digit are skipped, which is common for the upper bits of the batch ID and the type hash.
+  template <typename Entry>
+  void RadixSort(ezDynamicArray<Entry>& ref_entries, ezDynamicArray<Entry>& ref_temp)
+  {
+    constexpr ezUInt32 uiNumPasses = 12;
+
+    auto GetDigit = [](const Entry& entry, ezUInt32 uiPass) -> ezUInt32 {
+      if (uiPass < 4)
+        return (entry.m_uiBatchId >> (uiPass * 8)) & 0xFF;
+
+      return static_cast<ezUInt32>(entry.m_uiSortingKey >> ((uiPass - 4) * 8)) & 0xFF;
+    };
+
+    const ezUInt32 uiCount = ref_entries.GetCount();
+
+    // all histograms are built in one go, so the entries only need to be read once more per pass
+    ezUInt32 histograms[uiNumPasses][256] = {};
+    for (const Entry& entry : ref_entries)
+    {
+      for (ezUInt32 uiPass = 0; uiPass < uiNumPasses; ++uiPass)
+      {
+        ++histograms[uiPass][GetDigit(entry, uiPass)];
+      }
+    }
+
+    ref_temp.SetCountUninitialized(uiCount);
+
+    Entry* pSource = ref_entries.GetData();
+    Entry* pTarget = ref_temp.GetData();
+
+    for (ezUInt32 uiPass = 0; uiPass < uiNumPasses; ++uiPass)
+    {
+      ezUInt32* pHistogram = histograms[uiPass];
+      if (pHistogram[GetDigit(pSource[0], uiPass)] == uiCount)
+        continue;
+
+      ezUInt32 uiOffset = 0;
+      for (ezUInt32 uiDigit = 0; uiDigit < 256; ++uiDigit)
+      {
+        const ezUInt32 uiDigitCount = pHistogram[uiDigit];
+        pHistogram[uiDigit] = uiOffset;
+        uiOffset += uiDigitCount;
+      }
+
+      for (ezUInt32 i = 0; i < uiCount; ++i)
+      {
+        pTarget[pHistogram[GetDigit(pSource[i], uiPass)]++] = pSource[i];
+      }
+
+      ezMath::Swap(pSource, pTarget);
+    }
+
+    if (pSource != ref_entries.GetData())
+    {
+      ref_entries.Swap(ref_temp);
+    }
+  }
+
+  /// Returns true if the four entries starting at the given pointers all belong to the same batch as their predecessors.
+  EZ_FORCE_INLINE bool IsSameBatchBlock(const ezUInt32* pBatchIds, const ezRTTI* const* pTypes)
+  {
+    ezSimdVec4i batchIds, prevBatchIds;
+    batchIds.Load<4>(reinterpret_cast<const ezInt32*>(pBatchIds));
+    prevBatchIds.Load<4>(reinterpret_cast<const ezInt32*>(pBatchIds - 1));
+
+    if (!(batchIds == prevBatchIds).AllSet())
+      return false;
+
+    // compare the type pointers as integers, four at a time
+    constexpr ezUInt32 uiIntsPerType = sizeof(const ezRTTI*) / sizeof(ezInt32);
+    const ezInt32* pTypeInts = reinterpret_cast<const ezInt32*>(pTypes);
+    const ezInt32* pPrevTypeInts = reinterpret_cast<const ezInt32*>(pTypes - 1);
+
+    for (ezUInt32 i = 0; i < uiIntsPerType; ++i)
+    {
+      ezSimdVec4i types, prevTypes;
+      types.Load<4>(pTypeInts + i * 4);
+      prevTypes.Load<4>(pPrevTypeInts + i * 4);
+
+      if (!(types == prevTypes).AllSet())
+        return false;
+    }
+
+    return true;
+  }
+} // namespace
+
 ezExtractedRenderData::ezExtractedRenderData() = default;
 
 void ezExtractedRenderData::AddRenderData(const ezRenderData* pRenderData, ezRenderData::Category category)
@@ -14,6 +114,16 @@ void ezExtractedRenderData::AddRenderData(const ezRenderData* pRenderData, ezRen
   sortableRenderData.m_uiSortingKey = pRenderData->GetCategorySortingKey(category, m_Camera);
 }
 
+void ezExtractedRenderData::AddRenderData(const ezExtractedRenderData& other)
+{
+  m_DataPerCategory.EnsureCount(other.m_DataPerCategory.GetCount());
+
+  for (ezUInt32 i = 0; i < other.m_DataPerCategory.GetCount(); ++i)
+  {
+    m_DataPerCategory[i].m_SortableRenderData.PushBackRange(other.m_DataPerCategory[i].m_SortableRenderData.GetArrayPtr());
+  }
+}
+
 void ezExtractedRenderData::AddFrameData(const ezRenderData* pFrameData)
 {
   m_FrameData.PushBack(pFrameData);
@@ -23,50 +133,142 @@ void ezExtractedRenderData::SortAndBatch()
 {
   EZ_PROFILE_SCOPE("SortAndBatch");
 
-  struct RenderDataComparer
+  ezUInt32 uiTotalCount = 0;
+  ezUInt32 uiNumNonEmptyCategories = 0;
+  for (auto& dataPerCategory : m_DataPerCategory)
+  {
+    uiTotalCount += dataPerCategory.m_SortableRenderData.GetCount();
+    uiNumNonEmptyCategories += dataPerCategory.m_SortableRenderData.IsEmpty() ? 0 : 1;
+  }
+
+  if (cvar_RenderingSortingMultithreaded && uiTotalCount >= s_uiMinRenderDataForParallelSorting && uiNumNonEmptyCategories > 1)
+  {
+    ezParallelForParams params;
+    params.m_uiBinSize = 1;
+    params.m_uiMaxTasksPerThread = 1;
+
+    ezTaskSystem::ParallelForIndexed(
+      0u, m_DataPerCategory.GetCount(), [this](ezUInt32 uiStartIndex, ezUInt32 uiEndIndex) {
+        for (ezUInt32 i = uiStartIndex; i < uiEndIndex; ++i)
+        {
+          SortAndBatchCategory(m_DataPerCategory[i]);
+        }
+      },
+      "SortAndBatchCategories", params);
+  }
+  else
   {
-    EZ_FORCE_INLINE bool Less(const ezRenderDataBatch::SortableRenderData& a, const ezRenderDataBatch::SortableRenderData& b) const
+    for (auto& dataPerCategory : m_DataPerCategory)
     {
-      if (a.m_uiSortingKey == b.m_uiSortingKey)
-      {
-        return a.m_pRenderData->m_uiBatchId < b.m_pRenderData->m_uiBatchId;
-      }
+      SortAndBatchCategory(dataPerCategory);
+    }
+  }
+}
 
-      return a.m_uiSortingKey < b.m_uiSortingKey;
+// static
+void ezExtractedRenderData::SortAndBatchCategory(DataPerCategory& ref_dataPerCategory)
+{
+  auto& data = ref_dataPerCategory.m_SortableRenderData;
+  if (data.IsEmpty())
+    return;
+
+  const ezUInt32 uiCount = data.GetCount();
+
+  ref_dataPerCategory.m_SortedBatchIds.SetCountUninitialized(uiCount);
+  ref_dataPerCategory.m_SortedTypes.SetCountUninitialized(uiCount);
+
+  if (cvar_RenderingSortingRadixSort && uiCount >= s_uiMinRenderDataForRadixSort)
+  {
+    auto& entries = ref_dataPerCategory.m_SortEntries;
+    auto& types = ref_dataPerCategory.m_Types;
+    entries.SetCountUninitialized(uiCount);
+    types.SetCountUninitialized(uiCount);
+
+    // this is the only pass that touches the render data itself
+    for (ezUInt32 i = 0; i < uiCount; ++i)
+    {
+      const ezRenderData* pRenderData = data[i].m_pRenderData;
+
+      auto& entry = entries[i];
+      entry.m_uiSortingKey = data[i].m_uiSortingKey;
+      entry.m_uiBatchId = pRenderData->m_uiBatchId;
+      entry.m_uiIndex = i;
+
+      types[i] = pRenderData->GetDynamicRTTI();
     }
-  };
 
-  for (auto& dataPerCategory : m_DataPerCategory)
+    RadixSort(entries, ref_dataPerCategory.m_SortEntriesTemp);
+
+    auto& sortedData = ref_dataPerCategory.m_SortedRenderData;
+    sortedData.SetCountUninitialized(uiCount);
+
+    for (ezUInt32 i = 0; i < uiCount; ++i)
+    {
+      const ezUInt32 uiIndex = entries[i].m_uiIndex;
+      sortedData[i] = data[uiIndex];
+      ref_dataPerCategory.m_SortedBatchIds[i] = entries[i].m_uiBatchId;
+      ref_dataPerCategory.m_SortedTypes[i] = types[uiIndex];
+    }
+
+    data.Swap(sortedData);
+  }
+  else
   {
-    if (dataPerCategory.m_SortableRenderData.IsEmpty())
-      continue;
+    struct RenderDataComparer
+    {
+      EZ_FORCE_INLINE bool Less(const ezRenderDataBatch::SortableRenderData& a, const ezRenderDataBatch::SortableRenderData& b) const
+      {
+        if (a.m_uiSortingKey == b.m_uiSortingKey)
+        {
+          return a.m_pRenderData->m_uiBatchId < b.m_pRenderData->m_uiBatchId;
+        }
 
-    auto& data = dataPerCategory.m_SortableRenderData;
+        return a.m_uiSortingKey < b.m_uiSortingKey;
+      }
+    };
 
-    // Sort
     data.Sort(RenderDataComparer());
 
-    // Find batches
-    ezUInt32 uiCurrentBatchId = data[0].m_pRenderData->m_uiBatchId;
-    ezUInt32 uiCurrentBatchStartIndex = 0;
-    const ezRTTI* pCurrentBatchType = data[0].m_pRenderData->GetDynamicRTTI();
+    for (ezUInt32 i = 0; i < uiCount; ++i)
+    {
+      ref_dataPerCategory.m_SortedBatchIds[i] = data[i].m_pRenderData->m_uiBatchId;
+      ref_dataPerCategory.m_SortedTypes[i] = data[i].m_pRenderData->GetDynamicRTTI();
+    }
+  }
+
+  // Find batches
+  const ezUInt32* pBatchIds = ref_dataPerCategory.m_SortedBatchIds.GetData();
+  const ezRTTI* const* pTypes = ref_dataPerCategory.m_SortedTypes.GetData();
+  ezUInt32 uiCurrentBatchStartIndex = 0;
 
-    for (ezUInt32 i = 1; i < data.GetCount(); ++i)
+  auto AddBatchIfBoundary = [&](ezUInt32 i) {
+    if (pBatchIds[i] != pBatchIds[i - 1] || pTypes[i] != pTypes[i - 1])
     {
-      auto pRenderData = data[i].m_pRenderData;
+      ref_dataPerCategory.m_Batches.ExpandAndGetRef().m_Data = ezMakeArrayPtr(&data[uiCurrentBatchStartIndex], i - uiCurrentBatchStartIndex);
+      uiCurrentBatchStartIndex = i;
+    }
+  };
 
-      if (pRenderData->m_uiBatchId != uiCurrentBatchId || pRenderData->GetDynamicRTTI() != pCurrentBatchType)
-      {
-        dataPerCategory.m_Batches.ExpandAndGetRef().m_Data = ezMakeArrayPtr(&data[uiCurrentBatchStartIndex], i - uiCurrentBatchStartIndex);
+  ezUInt32 i = 1;
 
-        uiCurrentBatchId = pRenderData->m_uiBatchId;
-        uiCurrentBatchStartIndex = i;
-        pCurrentBatchType = pRenderData->GetDynamicRTTI();
+  // Batches are usually much longer than four entries, so most of the time a whole block can be skipped with one comparison
+  for (; i + 4 <= uiCount; i += 4)
+  {
+    if (!IsSameBatchBlock(pBatchIds + i, pTypes + i))
+    {
+      for (ezUInt32 j = i; j < i + 4; ++j)
+      {
+        AddBatchIfBoundary(j);
       }
     }
+  }
 
-    dataPerCategory.m_Batches.ExpandAndGetRef().m_Data = ezMakeArrayPtr(&data[uiCurrentBatchStartIndex], data.GetCount() - uiCurrentBatchStartIndex);
+  for (; i < uiCount; ++i)
+  {
+    AddBatchIfBoundary(i);
   }
+
+  ref_dataPerCategory.m_Batches.ExpandAndGetRef().m_Data = ezMakeArrayPtr(&data[uiCurrentBatchStartIndex], uiCount - uiCurrentBatchStartIndex);
 }
 
 void ezExtractedRenderData::Clear()
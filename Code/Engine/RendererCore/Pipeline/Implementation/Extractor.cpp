@@ -4,6 +4,7 @@
 #include <Core/World/World.h>
 #include <Foundation/Configuration/CVar.h>
 #include <Foundation/IO/TypeVersionContext.h>
+#include <Foundation/Threading/TaskSystem.h>
 #include <RendererCore/Debug/DebugRenderer.h>
 #include <RendererCore/Pipeline/ExtractedRenderData.h>
 #include <RendererCore/Pipeline/Extractor.h>
@@ -21,8 +22,13 @@ ezCVarString cvar_SpatialVisDataOnlyObject("Spatial.VisData.OnlyObject", "", ezC
 ezCVarBool cvar_SpatialExtractionShowStats("Spatial.Extraction.ShowStats", false, ezCVarFlags::Default, "Display some stats of the render data extraction");
 #endif
 
+ezCVarBool cvar_SpatialExtractionMultithreaded("Spatial.Extraction.Multithreaded", true, ezCVarFlags::Default, "Extract the render data of visible objects on multiple threads");
+
 namespace
 {
+  // Extracting a single object is rather cheap, so a chunk needs to contain a decent amount of objects to be worth a task.
+  constexpr ezUInt32 s_uiMinObjectsPerExtractionChunk = 512;
+
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
   void VisualizeSpatialData(const ezView& view)
   {
@@ -142,6 +148,18 @@ bool ezExtractor::FilterByViewTags(const ezView& view, const ezGameObject* pObje
 }
 
 void ezExtractor::ExtractRenderData(const ezView& view, const ezGameObject* pObject, ezMsgExtractRenderData& msg, ezExtractedRenderData& extractedRenderData) const
+{
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  ExtractRenderData(view, pObject, msg, extractedRenderData, m_uiNumCachedRenderData, m_uiNumUncachedRenderData);
+#else
+  ezUInt32 uiNumCachedRenderData = 0;
+  ezUInt32 uiNumUncachedRenderData = 0;
+  ExtractRenderData(view, pObject, msg, extractedRenderData, uiNumCachedRenderData, uiNumUncachedRenderData);
+#endif
+}
+
+void ezExtractor::ExtractRenderData(const ezView& view, const ezGameObject* pObject, ezMsgExtractRenderData& msg, ezExtractedRenderData& extractedRenderData,
+  ezUInt32& inout_uiNumCachedRenderData, ezUInt32& inout_uiNumUncachedRenderData) const
 {
   auto AddRenderDataFromMessage = [&](const ezMsgExtractRenderData& msg) {
     if (msg.m_OverrideCategory != ezInvalidRenderDataCategory)
@@ -159,9 +177,7 @@ void ezExtractor::ExtractRenderData(const ezView& view, const ezGameObject* pObj
       }
     }
 
-#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
-    m_uiNumUncachedRenderData += msg.m_ExtractedRenderData.GetCount();
-#endif
+    inout_uiNumUncachedRenderData += msg.m_ExtractedRenderData.GetCount();
   };
 
   if (pObject->IsStatic())
@@ -194,10 +210,7 @@ void ezExtractor::ExtractRenderData(const ezView& view, const ezGameObject* pObj
         if (cacheEntry.m_pRenderData != nullptr)
         {
           extractedRenderData.AddRenderData(cacheEntry.m_pRenderData, msg.m_OverrideCategory != ezInvalidRenderDataCategory ? msg.m_OverrideCategory : ezRenderData::Category(cacheEntry.m_uiCategory));
-
-#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
-          ++m_uiNumCachedRenderData;
-#endif
+          ++inout_uiNumCachedRenderData;
         }
         ++uiCacheIndex;
 
@@ -301,9 +314,6 @@ ezVisibleObjectsExtractor::~ezVisibleObjectsExtractor() = default;
 void ezVisibleObjectsExtractor::Extract(
   const ezView& view, const ezDynamicArray<const ezGameObject*>& visibleObjects, ezExtractedRenderData& ref_extractedRenderData)
 {
-  ezMsgExtractRenderData msg;
-  msg.m_pView = &view;
-
   EZ_LOCK(view.GetWorld()->GetReadMarker());
 
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
@@ -313,12 +323,29 @@ void ezVisibleObjectsExtractor::Extract(
   m_uiNumUncachedRenderData = 0;
 #endif
 
-  for (auto pObject : visibleObjects)
+  const ezUInt32 uiMaxChunks = ezTaskSystem::GetWorkerThreadCount(ezWorkerThreadType::ShortTasks) * 2;
+  const ezUInt32 uiNumChunks = ezMath::Min(visibleObjects.GetCount() / s_uiMinObjectsPerExtractionChunk, uiMaxChunks);
+
+  if (cvar_SpatialExtractionMultithreaded && uiNumChunks > 1)
   {
-    ExtractRenderData(view, pObject, msg, ref_extractedRenderData);
+    ExtractParallel(view, visibleObjects, ref_extractedRenderData, uiNumChunks);
+  }
+  else
+  {
+    ezMsgExtractRenderData msg;
+    msg.m_pView = &view;
+
+    for (auto pObject : visibleObjects)
+    {
+      ExtractRenderData(view, pObject, msg, ref_extractedRenderData);
+    }
+  }
 
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
-    if (cvar_SpatialVisBounds || cvar_SpatialVisLocalBBox || cvar_SpatialVisData)
+  // the debug renderer is not meant to be fed from multiple threads, so visualization is always done afterwards
+  if (cvar_SpatialVisBounds || cvar_SpatialVisLocalBBox || cvar_SpatialVisData)
+  {
+    for (auto pObject : visibleObjects)
     {
       if ((cvar_SpatialVisDataOnlyObject.GetValue().IsEmpty() ||
             pObject->GetName().FindSubString_NoCase(cvar_SpatialVisDataOnlyObject.GetValue()) != nullptr) &&
@@ -327,10 +354,8 @@ void ezVisibleObjectsExtractor::Extract(
         VisualizeObject(view, pObject);
       }
     }
-#endif
   }
 
-#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
   const bool bIsMainView = (view.GetCameraUsageHint() == ezCameraUsageHint::MainView || view.GetCameraUsageHint() == ezCameraUsageHint::EditorView);
 
   if (cvar_SpatialExtractionShowStats && bIsMainView)
@@ -350,6 +375,71 @@ void ezVisibleObjectsExtractor::Extract(
 #endif
 }
 
+void ezVisibleObjectsExtractor::ExtractParallel(
+  const ezView& view, const ezDynamicArray<const ezGameObject*>& visibleObjects, ezExtractedRenderData& ref_extractedRenderData, ezUInt32 uiNumChunks)
+{
+  EZ_PROFILE_SCOPE("ExtractParallel");
+
+  if (m_ExtractionChunks.GetCount() < uiNumChunks)
+  {
+    m_ExtractionChunks.SetCount(uiNumChunks);
+  }
+
+  for (ezUInt32 i = 0; i < uiNumChunks; ++i)
+  {
+    auto& chunk = m_ExtractionChunks[i];
+    if (chunk.m_pRenderData == nullptr)
+    {
+      chunk.m_pRenderData = EZ_DEFAULT_NEW(ezExtractedRenderData);
+    }
+
+    // the sorting key of each render data is computed when it is added, so every chunk needs the same camera
+    chunk.m_pRenderData->Clear();
+    chunk.m_pRenderData->SetCamera(ref_extractedRenderData.GetCamera());
+    chunk.m_uiNumCachedRenderData = 0;
+    chunk.m_uiNumUncachedRenderData = 0;
+  }
+
+  // consecutive chunks of objects, so that appending the chunks in order gives the same result as serial extraction
+  const ezUInt32 uiObjectsPerChunk = (visibleObjects.GetCount() + uiNumChunks - 1) / uiNumChunks;
+
+  auto ExtractChunks = [&](ezUInt32 uiStartChunk, ezUInt32 uiEndChunk) {
+    ezMsgExtractRenderData msg;
+    msg.m_pView = &view;
+
+    for (ezUInt32 uiChunk = uiStartChunk; uiChunk < uiEndChunk; ++uiChunk)
+    {
+      auto& chunk = m_ExtractionChunks[uiChunk];
+
+      const ezUInt32 uiStartObject = uiChunk * uiObjectsPerChunk;
+      const ezUInt32 uiEndObject = ezMath::Min(uiStartObject + uiObjectsPerChunk, visibleObjects.GetCount());
+
+      for (ezUInt32 i = uiStartObject; i < uiEndObject; ++i)
+      {
+        ExtractRenderData(view, visibleObjects[i], msg, *chunk.m_pRenderData, chunk.m_uiNumCachedRenderData, chunk.m_uiNumUncachedRenderData);
+      }
+    }
+  };
+
+  ezParallelForParams params;
+  params.m_uiBinSize = 1;
+  params.m_uiMaxTasksPerThread = 2;
+
+  // the calling thread holds the world's read marker for the whole time, which also covers the read accesses of the worker threads
+  ezTaskSystem::ParallelForIndexed(0u, uiNumChunks, ExtractChunks, "ExtractRenderDataChunks", params);
+
+  for (ezUInt32 i = 0; i < uiNumChunks; ++i)
+  {
+    auto& chunk = m_ExtractionChunks[i];
+    ref_extractedRenderData.AddRenderData(*chunk.m_pRenderData);
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+    m_uiNumCachedRenderData += chunk.m_uiNumCachedRenderData;
+    m_uiNumUncachedRenderData += chunk.m_uiNumUncachedRenderData;
+#endif
+  }
+}
+
 ezResult ezVisibleObjectsExtractor::Serialize(ezStreamWriter& inout_stream) const
 {
   EZ_SUCCEED_OR_RETURN(SUPER::Serialize(inout_stream));
@@ -31,6 +31,8 @@ ezCVarBool ezRenderPipeline::cvar_SpatialCullingVis("Spatial.Culling.Vis", false
 ezCVarBool cvar_SpatialCullingShowStats("Spatial.Culling.ShowStats", false, ezCVarFlags::Default, "Display some stats of the visibility culling");
 #endif
 
+ezCVarBool cvar_SpatialCullingMultiView("Spatial.Culling.MultiView", true, ezCVarFlags::Default, "Cull views that are added together, e.g. the shadow views of a light, in one pass without occlusion culling.");
+
 ezCVarBool cvar_SpatialCullingOcclusionEnable("Spatial.Occlusion.Enable", true, ezCVarFlags::Default, "Use software rasterization for occlusion culling.");
 ezCVarBool cvar_SpatialCullingOcclusionVisView("Spatial.Occlusion.VisView", false, ezCVarFlags::Default, "Render the occlusion framebuffer as an overlay.");
 ezCVarFloat cvar_SpatialCullingOcclusionBoundsInlation("Spatial.Occlusion.BoundsInflation", 0.5f, ezCVarFlags::Default, "How much to inflate bounds during occlusion check.");
@@ -42,6 +44,7 @@ ezRenderPipeline::ezRenderPipeline()
   m_CurrentExtractThread = (ezThreadID)0;
   m_CurrentRenderThread = (ezThreadID)0;
   m_uiLastExtractionFrame = -1;
+  m_uiVisibleObjectsFrame = -1;
   m_uiLastRenderFrame = -1;
 
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
@@ -977,6 +980,12 @@ EZ_END_SUBSYSTEM_DECLARATION;
 
 void ezRenderPipeline::FindVisibleObjects(const ezView& view)
 {
+  if (m_uiVisibleObjectsFrame == ezRenderWorld::GetFrameCounter())
+  {
+    // already culled together with other views
+    return;
+  }
+
   EZ_PROFILE_SCOPE("Visibility Culling");
 
   ezFrustum frustum;
@@ -1011,18 +1020,20 @@ void ezRenderPipeline::FindVisibleObjects(const ezView& view)
   {
     EZ_PROFILE_SCOPE("Occlusion::FindVisibleObjects");
 
-    auto IsOccluded = [=](const ezSimdBBox& aabb) {
-      // grow the bbox by some percent to counter the lower precision of the occlusion buffer
+    // grow the bboxes by some percent to counter the lower precision of the occlusion buffer
+    const float fBoundsScale = 1.0f + cvar_SpatialCullingOcclusionBoundsInlation;
 
-      const ezSimdVec4f c = aabb.GetCenter();
-      const ezSimdVec4f e = aabb.GetHalfExtents();
-      const ezSimdBBox aabb2 = ezSimdBBox::MakeFromCenterAndHalfExtents(c, e.CompMul(ezSimdVec4f(1.0f + cvar_SpatialCullingOcclusionBoundsInlation)));
+    auto AreOccluded = [=](ezArrayPtr<const ezSimdBBox> boxes, ezArrayPtr<bool> out_occluded) {
+      pRasterizer->AreVisible(boxes, out_occluded, fBoundsScale);
 
-      return !pRasterizer->IsVisible(aabb2);
+      for (bool& bOccluded : out_occluded)
+      {
+        bOccluded = !bOccluded;
+      }
     };
 
     m_VisibleObjects.Clear();
-    view.GetWorld()->GetSpatialSystem()->FindVisibleObjects(frustum, queryParams, m_VisibleObjects, IsOccluded, visType);
+    view.GetWorld()->GetSpatialSystem()->FindVisibleObjects(frustum, queryParams, m_VisibleObjects, {}, visType, AreOccluded);
   }
   else
   {
@@ -1337,6 +1348,78 @@ void ezRenderPipeline::CreateDgmlGraph(ezDGMLGraph& ref_graph)
   }
 }
 
+// static
+void ezRenderPipeline::FindVisibleObjectsMultiView(ezArrayPtr<ezView* const> views)
+{
+  if (!cvar_SpatialCullingMultiView || views.GetCount() < 2)
+    return;
+
+  EZ_PROFILE_SCOPE("Visibility Culling (Multi-View)");
+
+  auto GetVisType = [](const ezView& view) {
+    const bool bIsMainView = (view.GetCameraUsageHint() == ezCameraUsageHint::MainView || view.GetCameraUsageHint() == ezCameraUsageHint::EditorView);
+    return bIsMainView ? ezVisibilityState::Direct : ezVisibilityState::Indirect;
+  };
+
+  ezHybridArray<bool, 16> processed;
+  processed.SetCount(views.GetCount(), false);
+
+  ezHybridArray<ezFrustum, 16> frustums;
+  ezHybridArray<ezDynamicArray<const ezGameObject*>*, 16> visibleObjects;
+  ezHybridArray<ezRenderPipeline*, 16> pipelines;
+
+  for (ezUInt32 i = 0; i < views.GetCount(); ++i)
+  {
+    if (processed[i])
+      continue;
+
+    const ezView& firstView = *views[i];
+    const ezVisibilityState visType = GetVisType(firstView);
+
+    frustums.Clear();
+    visibleObjects.Clear();
+    pipelines.Clear();
+
+    // only views that see the same objects can be culled together
+    for (ezUInt32 j = i; j < views.GetCount(); ++j)
+    {
+      const ezView& view = *views[j];
+      if (processed[j] || view.GetWorld() != firstView.GetWorld() || GetVisType(view) != visType ||
+          view.m_IncludeTags != firstView.m_IncludeTags || view.m_ExcludeTags != firstView.m_ExcludeTags)
+        continue;
+
+      processed[j] = true;
+
+      ezRenderPipeline* pPipeline = view.m_pRenderPipeline.Borrow();
+      pPipeline->m_VisibleObjects.Clear();
+
+      view.ComputeCullingFrustum(frustums.ExpandAndGetRef());
+      visibleObjects.PushBack(&pPipeline->m_VisibleObjects);
+      pipelines.PushBack(pPipeline);
+    }
+
+    // a single view is culled as usual, including occlusion culling
+    if (pipelines.GetCount() < 2)
+      continue;
+
+    {
+      EZ_LOCK(firstView.GetWorld()->GetReadMarker());
+
+      ezSpatialSystem::QueryParams queryParams;
+      queryParams.m_uiCategoryBitmask = ezDefaultSpatialDataCategories::RenderStatic.GetBitmask() | ezDefaultSpatialDataCategories::RenderDynamic.GetBitmask();
+      queryParams.m_pIncludeTags = &firstView.m_IncludeTags;
+      queryParams.m_pExcludeTags = &firstView.m_ExcludeTags;
+
+      firstView.GetWorld()->GetSpatialSystem()->FindVisibleObjectsMultiView(frustums, queryParams, visibleObjects, visType);
+    }
+
+    for (ezRenderPipeline* pPipeline : pipelines)
+    {
+      pPipeline->m_uiVisibleObjectsFrame = ezRenderWorld::GetFrameCounter();
+    }
+  }
+}
+
 ezRasterizerView* ezRenderPipeline::PrepareOcclusionCulling(const ezFrustum& frustum, const ezView& view)
 {
 #if EZ_ENABLED(EZ_PLATFORM_ARCH_X86)
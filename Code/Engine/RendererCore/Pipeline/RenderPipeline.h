@@ -92,6 +92,11 @@ private:
   void ExtractData(const ezView& view);
   void FindVisibleObjects(const ezView& view);
 
+  /// \brief Culls views of the same world that see the same objects together in one pass and stores the result in their pipelines.
+  ///
+  /// Must only be called for views that have not been extracted in this frame yet. These views then skip FindVisibleObjects during extraction.
+  static void FindVisibleObjectsMultiView(ezArrayPtr<ezView* const> views);
+
   void Render(ezRenderContext* pRenderer);
 
   ezRasterizerView* PrepareOcclusionCulling(const ezFrustum& frustum, const ezView& view);
@@ -105,6 +110,7 @@ private: // Member data
   // Pipeline render data
   ezExtractedRenderData m_Data[2];
   ezDynamicArray<const ezGameObject*> m_VisibleObjects;
+  ezUInt64 m_uiVisibleObjectsFrame; ///< The frame in which m_VisibleObjects has already been filled by FindVisibleObjectsMultiView
 
 #if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
   ezTime m_AverageCullingTime;
@@ -141,6 +141,7 @@ public:
 
 private:
   friend class ezRenderWorld;
+  friend class ezRenderPipeline;
   friend class ezMemoryUtils;
 
   ezViewId m_InternalId;
@@ -1,10 +1,12 @@
 #include <RendererCore/RendererCorePCH.h>
 
 #include <Core/Graphics/Camera.h>
+#include <Foundation/Algorithm/HashingUtils.h>
 #include <Foundation/Configuration/CVar.h>
 #include <Foundation/Profiling/Profiling.h>
 #include <Foundation/SimdMath/SimdBBox.h>
 #include <Foundation/SimdMath/SimdConversion.h>
+#include <Foundation/Threading/TaskSystem.h>
 #include <RendererCore/Rasterizer/RasterizerObject.h>
 #include <RendererCore/Rasterizer/RasterizerView.h>
 #include <RendererCore/Rasterizer/Thirdparty/Occluder.h>
@@ -12,6 +14,19 @@
 
 ezCVarInt cvar_SpatialCullingOcclusionMaxResolution("Spatial.Occlusion.MaxResolution", 512, ezCVarFlags::Default, "Max resolution for occlusion buffers.");
 ezCVarInt cvar_SpatialCullingOcclusionMaxOccluders("Spatial.Occlusion.MaxOccluders", 64, ezCVarFlags::Default, "Max number of occluders to rasterize per frame.");
+ezCVarInt cvar_SpatialCullingOcclusionTiles("Spatial.Occlusion.Tiles", 8, ezCVarFlags::Default, "Number of horizontal tiles that the occlusion buffer is split into.");
+ezCVarBool cvar_SpatialCullingOcclusionMultithreaded("Spatial.Occlusion.Multithreaded", true, ezCVarFlags::Default, "Rasterize the occlusion buffer tiles in parallel.");
+ezCVarBool cvar_SpatialCullingOcclusionReprojection("Spatial.Occlusion.Reprojection", false, ezCVarFlags::Default, "Start from the reprojected depth of an earlier frame and only rasterize occluders that changed or are close to the camera.");
+ezCVarInt cvar_SpatialCullingOcclusionReprojectionMaxFrames("Spatial.Occlusion.ReprojectionMaxFrames", 8, ezCVarFlags::Default, "Max number of frames that reuse the same depth, before all occluders are rasterized again.");
+ezCVarFloat cvar_SpatialCullingOcclusionReprojectionMaxDistance("Spatial.Occlusion.ReprojectionMaxDistance", 2.0f, ezCVarFlags::Default, "Max distance the camera may move before all occluders are rasterized again.");
+ezCVarFloat cvar_SpatialCullingOcclusionReprojectionMaxAngle("Spatial.Occlusion.ReprojectionMaxAngle", 10.0f, ezCVarFlags::Default, "Max angle (in degrees) the camera may rotate before all occluders are rasterized again.");
+ezCVarFloat cvar_SpatialCullingOcclusionReprojectionNearDistance("Spatial.Occlusion.ReprojectionNearDistance", 10.0f, ezCVarFlags::Default, "Occluders closer than this are rasterized every frame, since reprojecting them is too imprecise.");
+
+// each tile needs to be at least this many 8x8 blocks high, otherwise the per-tile overhead outweighs the gains
+static constexpr ezUInt32 s_uiMinBlockRowsPerTile = 4;
+
+// how much the distance to the camera may vary within a block and between neighboring blocks, for the block to be reprojected
+static constexpr float s_fMaxReprojectionDepthVariation = 0.1f;
 
 ezRasterizerView::ezRasterizerView() = default;
 ezRasterizerView::~ezRasterizerView() = default;
@@ -23,7 +38,8 @@ void ezRasterizerView::SetResolution(ezUInt32 uiWidth, ezUInt32 uiHeight, float
     m_uiResolutionX = uiWidth;
     m_uiResolutionY = uiHeight;
 
-    m_pRasterizer = EZ_DEFAULT_NEW(Rasterizer, uiWidth, uiHeight);
+    m_Tiles.Clear();
+    m_Keyframe.m_bValid = false;
   }
 
   if (fAspectRatio == 0.0f)
@@ -32,13 +48,59 @@ void ezRasterizerView::SetResolution(ezUInt32 uiWidth, ezUInt32 uiHeight, float
     m_fAspectRation = fAspectRatio;
 }
 
+void ezRasterizerView::CreateTiles(ezUInt32 uiNumTiles)
+{
+  EZ_ASSERT_DEV(m_uiResolutionX % 8 == 0 && m_uiResolutionY % 8 == 0, "The resolution must be a multiple of 8.");
+
+  m_uiNumRequestedTiles = uiNumTiles;
+  m_Keyframe.m_bValid = false;
+
+  const ezUInt32 uiBlockRows = m_uiResolutionY / 8;
+  uiNumTiles = ezMath::Clamp<ezUInt32>(uiNumTiles, 1u, ezMath::Max(uiBlockRows / s_uiMinBlockRowsPerTile, 1u));
+
+  m_uiTileRows = (uiBlockRows / uiNumTiles) * 8;
+
+  m_Tiles.Clear();
+  m_Tiles.SetCount(uiNumTiles);
+
+  // The rasterizer maps clip space y to the rows [0; height - 8] (shifted by half a block).
+  // To get exactly the same pixel grid as with one big buffer, every tile remaps clip space y such that its rows line up with the full buffer.
+  const float fFullScale = m_uiResolutionY * 0.5f - 4.0f;
+
+  for (ezUInt32 i = 0; i < uiNumTiles; ++i)
+  {
+    Tile& tile = m_Tiles[i];
+    tile.m_uiFirstRow = i * m_uiTileRows;
+    tile.m_uiNumRows = (i + 1 < uiNumTiles) ? m_uiTileRows : (m_uiResolutionY - tile.m_uiFirstRow);
+
+    const float fTileScale = tile.m_uiNumRows * 0.5f - 4.0f;
+    tile.m_fClipScaleY = fFullScale / fTileScale;
+    tile.m_fClipOffsetY = (fFullScale - tile.m_uiFirstRow) / fTileScale - 1.0f;
+
+    tile.m_pRasterizer = EZ_DEFAULT_NEW(Rasterizer, m_uiResolutionX, tile.m_uiNumRows);
+  }
+}
+
 void ezRasterizerView::BeginScene()
 {
-  EZ_ASSERT_DEV(m_pRasterizer != nullptr, "Call SetResolution() first.");
+  EZ_ASSERT_DEV(m_uiResolutionX > 0 && m_uiResolutionY > 0, "Call SetResolution() first.");
+
+  const ezUInt32 uiNumTiles = ezMath::Max(cvar_SpatialCullingOcclusionTiles.GetValue(), 1);
+  if (m_Tiles.IsEmpty() || m_uiNumRequestedTiles != uiNumTiles)
+  {
+    CreateTiles(uiNumTiles);
+  }
 
   EZ_PROFILE_SCOPE("Occlusion::Clear");
 
-  m_pRasterizer->clear();
+  for (Tile& tile : m_Tiles)
+  {
+    tile.m_pRasterizer->clear();
+    tile.m_bAnyOccludersRasterized = false;
+    tile.m_Bin.Clear();
+    tile.m_Rasterized.Clear();
+  }
+
   m_bAnyOccludersRasterized = false;
 }
 
@@ -46,59 +108,169 @@ void ezRasterizerView::ReadBackFrame(ezArrayPtr<ezColorLinearUB> targetBuffer) c
 {
   EZ_PROFILE_SCOPE("Occlusion::ReadFrame");
 
-  EZ_ASSERT_DEV(m_pRasterizer != nullptr, "Call SetResolution() first.");
+  EZ_ASSERT_DEV(!m_Tiles.IsEmpty(), "Call BeginScene() first.");
   EZ_ASSERT_DEV(targetBuffer.GetCount() >= m_uiResolutionX * m_uiResolutionY, "Target buffer is too small.");
 
-  m_pRasterizer->readBackDepth(targetBuffer.GetPtr());
+  // the tiles line up with the rows of the full buffer, so each one can write directly to its part of the target
+  for (const Tile& tile : m_Tiles)
+  {
+    tile.m_pRasterizer->readBackDepth(targetBuffer.GetPtr() + tile.m_uiFirstRow * m_uiResolutionX);
+  }
 }
 
 void ezRasterizerView::EndScene()
 {
+  m_bReprojected = false;
+
   if (m_Instances.IsEmpty())
+  {
+    m_Keyframe.m_bValid = false;
     return;
+  }
 
   EZ_PROFILE_SCOPE("Occlusion::RasterizeScene");
 
-  SortObjectsFrontToBack();
-
   UpdateViewProjectionMatrix();
 
+  const bool bUseReprojection = EZ_ENABLED(EZ_RASTERIZER_SUPPORTED) && cvar_SpatialCullingOcclusionReprojection;
+
+  if (bUseReprojection)
+  {
+    // identifies an occluder across frames, as long as it doesn't move
+    for (Instance& inst : m_Instances)
+    {
+      inst.m_uiHash = ezHashingUtils::xxHash64(&inst.m_Transform, sizeof(ezTransform), ezHashingUtils::xxHash64(&inst.m_pObject, sizeof(inst.m_pObject)));
+    }
+
+    if (CanReproject())
+    {
+      Reproject();
+      RemoveReprojectedObjects();
+    }
+  }
+  else
+  {
+    m_Keyframe.m_bValid = false;
+  }
+
+  // sort only after reprojection, which may drop most objects
+  SortObjectsFrontToBack();
+
   // only rasterize a limited number of the closest objects
-  RasterizeObjects(cvar_SpatialCullingOcclusionMaxOccluders);
+  BinObjects(ezMath::Max(cvar_SpatialCullingOcclusionMaxOccluders.GetValue(), 0));
+
+  RasterizeObjects();
+
+  if (bUseReprojection && !m_bReprojected)
+  {
+    StoreKeyframe();
+  }
 
   m_Instances.Clear();
 
-  m_pRasterizer->setModelViewProjection(m_mViewProjection.m_fElementsCM);
+  for (Tile& tile : m_Tiles)
+  {
+    ApplyModelViewProjectionMatrix(tile, m_mViewProjection);
+  }
+}
+
+void ezRasterizerView::BinObjects(ezUInt32 uiMaxObjects)
+{
+#if EZ_ENABLED(EZ_RASTERIZER_SUPPORTED)
+  EZ_PROFILE_SCOPE("Occlusion::BinObjects");
+
+  ezUInt32 uiNumBinned = 0;
+
+  for (ezUInt32 i = 0; i < m_Instances.GetCount(); ++i)
+  {
+    Instance& inst = m_Instances[i];
+    inst.m_mModelViewProjection = m_mViewProjection * inst.m_Transform.GetAsMat4();
+
+    const Occluder& occluder = inst.m_pObject->m_Occluder;
+
+    ezUInt32 uiFirstTile, uiLastTile;
+    if (!ComputeTileRange(ezSimdConversion::ToMat4(inst.m_mModelViewProjection), occluder.m_boundsMin, occluder.m_boundsMax, uiFirstTile, uiLastTile))
+      continue;
+
+    inst.m_bOnScreen = true;
+
+    // the objects are sorted front to back, so the budget goes to the closest ones, no matter how many tiles they overlap
+    if (uiNumBinned == uiMaxObjects)
+      continue;
+
+    ++uiNumBinned;
+
+    for (ezUInt32 t = uiFirstTile; t <= uiLastTile; ++t)
+    {
+      m_Tiles[t].m_Bin.PushBack(i);
+    }
+  }
+#endif
 }
 
-void ezRasterizerView::RasterizeObjects(ezUInt32 uiMaxObjects)
+void ezRasterizerView::RasterizeObjects()
 {
 #if EZ_ENABLED(EZ_RASTERIZER_SUPPORTED)
 
   EZ_PROFILE_SCOPE("Occlusion::RasterizeObjects");
 
-  for (const Instance& inst : m_Instances)
+  if (cvar_SpatialCullingOcclusionMultithreaded && m_Tiles.GetCount() > 1)
   {
-    ApplyModelViewProjectionMatrix(inst.m_Transform);
+    ezParallelForParams params;
+    params.m_uiBinSize = 1;
+    params.m_uiMaxTasksPerThread = 2;
+
+    ezTaskSystem::ParallelForIndexed(
+      0u, m_Tiles.GetCount(), [&](ezUInt32 uiStartIndex, ezUInt32 uiEndIndex) {
+        for (ezUInt32 i = uiStartIndex; i < uiEndIndex; ++i)
+        {
+          RasterizeTile(m_Tiles[i]);
+        }
+      },
+      "Occlusion::RasterizeTiles", params);
+  }
+  else
+  {
+    for (Tile& tile : m_Tiles)
+    {
+      RasterizeTile(tile);
+    }
+  }
+
+  for (const Tile& tile : m_Tiles)
+  {
+    m_bAnyOccludersRasterized |= tile.m_bAnyOccludersRasterized;
+  }
+#endif
+}
+
+void ezRasterizerView::RasterizeTile(Tile& tile)
+{
+#if EZ_ENABLED(EZ_RASTERIZER_SUPPORTED)
+  for (ezUInt32 uiInstance : tile.m_Bin)
+  {
+    const Instance& inst = m_Instances[uiInstance];
+
+    ApplyModelViewProjectionMatrix(tile, inst.m_mModelViewProjection);
 
     bool bNeedsClipping;
     const Occluder& occluder = inst.m_pObject->m_Occluder;
 
-    if (m_pRasterizer->queryVisibility(occluder.m_boundsMin, occluder.m_boundsMax, bNeedsClipping))
+    // occluders that are hidden behind closer occluders don't need to be rasterized
+    if (tile.m_pRasterizer->queryVisibility(occluder.m_boundsMin, occluder.m_boundsMax, bNeedsClipping))
     {
-      m_bAnyOccludersRasterized = true;
+      tile.m_bAnyOccludersRasterized = true;
 
       if (bNeedsClipping)
       {
-        m_pRasterizer->rasterize<true>(occluder);
+        tile.m_pRasterizer->rasterize<true>(occluder);
       }
       else
       {
-        m_pRasterizer->rasterize<false>(occluder);
+        tile.m_pRasterizer->rasterize<false>(occluder);
       }
 
-      if (--uiMaxObjects == 0)
-        return;
+      tile.m_Rasterized.PushBack(uiInstance);
     }
   }
 #endif
@@ -106,18 +278,457 @@ void ezRasterizerView::RasterizeObjects(ezUInt32 uiMaxObjects)
 
 void ezRasterizerView::UpdateViewProjectionMatrix()
 {
-  ezMat4 mProjection;
-  m_pCamera->GetProjectionMatrix(m_fAspectRation, mProjection, ezCameraEye::Left, ezClipSpaceDepthRange::ZeroToOne);
+  m_pCamera->GetProjectionMatrix(m_fAspectRation, m_mProjection, ezCameraEye::Left, ezClipSpaceDepthRange::ZeroToOne);
+
+  m_mViewProjection = m_mProjection * m_pCamera->GetViewMatrix();
+}
+
+void ezRasterizerView::ApplyModelViewProjectionMatrix(Tile& tile, const ezMat4& mModelViewProjection)
+{
+  ezMat4 mTile = mModelViewProjection;
+
+  // y' = y * scale + w * offset
+  for (ezUInt32 c = 0; c < 4; ++c)
+  {
+    mTile.Element(c, 1) = mModelViewProjection.Element(c, 1) * tile.m_fClipScaleY + mModelViewProjection.Element(c, 3) * tile.m_fClipOffsetY;
+  }
+
+  tile.m_pRasterizer->setModelViewProjection(mTile.m_fElementsCM);
+}
+
+bool ezRasterizerView::ComputeTileRange(const ezSimdMat4f& mModelViewProjection, const ezSimdVec4f& vMin, const ezSimdVec4f& vMax, ezUInt32& out_uiFirstTile, ezUInt32& out_uiLastTile) const
+{
+  const ezUInt32 uiLastTile = m_Tiles.GetCount() - 1;
+
+  // transform the y and w components of all 8 corners at once, 4 corners per z plane
+  const ezSimdVec4f xs = vMin.GetCombined<ezSwizzle::XXXX>(vMax).Get<ezSwizzle::XZXZ>();
+  const ezSimdVec4f ys = vMin.GetCombined<ezSwizzle::YYYY>(vMax);
+
+  const ezSimdVec4f& c0 = mModelViewProjection.m_col0;
+  const ezSimdVec4f& c1 = mModelViewProjection.m_col1;
+  const ezSimdVec4f& c2 = mModelViewProjection.m_col2;
+  const ezSimdVec4f& c3 = mModelViewProjection.m_col3;
+
+  const ezSimdVec4f yBase = ezSimdVec4f::MulAdd(xs, c0.y(), ezSimdVec4f::MulAdd(ys, c1.y(), ezSimdVec4f(c3.y())));
+  const ezSimdVec4f wBase = ezSimdVec4f::MulAdd(xs, c0.w(), ezSimdVec4f::MulAdd(ys, c1.w(), ezSimdVec4f(c3.w())));
+
+  const ezSimdVec4f yNear = yBase + ezSimdVec4f(c2.y() * vMin.z());
+  const ezSimdVec4f yFar = yBase + ezSimdVec4f(c2.y() * vMax.z());
+  const ezSimdVec4f wNear = wBase + ezSimdVec4f(c2.w() * vMin.z());
+  const ezSimdVec4f wFar = wBase + ezSimdVec4f(c2.w() * vMax.z());
+
+  if ((wNear.CompMin(wFar) < ezSimdVec4f(ezMath::DefaultEpsilon<float>())).AnySet())
+  {
+    // crosses the near plane, the screen space extents are unknown
+    out_uiFirstTile = 0;
+    out_uiLastTile = uiLastTile;
+    return true;
+  }
+
+  const ezSimdVec4f ndcNear = yNear.CompDiv<ezMathAcc::BITS_12>(wNear);
+  const ezSimdVec4f ndcFar = yFar.CompDiv<ezMathAcc::BITS_12>(wFar);
+
+  const float fRowScale = m_uiResolutionY * 0.5f - 4.0f;
+
+  // grow the range by one block in each direction, to account for the half block shift and the limited precision of the rasterizer
+  const float fMinRow = ((float)ndcNear.CompMin(ndcFar).HorizontalMin<4>() + 1.0f) * fRowScale - 8.0f;
+  const float fMaxRow = ((float)ndcNear.CompMax(ndcFar).HorizontalMax<4>() + 1.0f) * fRowScale + 8.0f;
+
+  if (fMaxRow < 0.0f || fMinRow >= (float)m_uiResolutionY)
+    return false;
+
+  out_uiFirstTile = ezMath::Min((ezUInt32)ezMath::Max(fMinRow, 0.0f) / m_uiTileRows, uiLastTile);
+  out_uiLastTile = ezMath::Min((ezUInt32)ezMath::Min(fMaxRow, (float)m_uiResolutionY) / m_uiTileRows, uiLastTile);
+  return true;
+}
+
+ezRectU16 ezRasterizerView::ComputeBlockRect(const ezMat4& mModelViewProjection, const ezVec3& vMin, const ezVec3& vMax, bool& out_bClipped) const
+{
+  const ezUInt32 uiBlocksX = m_uiResolutionX / 8;
+  const ezUInt32 uiBlocksY = m_uiResolutionY / 8;
+
+  const float fScaleX = m_uiResolutionX * 0.5f - 4.0f;
+  const float fScaleY = m_uiResolutionY * 0.5f - 4.0f;
+
+  ezVec2 vScreenMin(ezMath::MaxValue<float>());
+  ezVec2 vScreenMax(-ezMath::MaxValue<float>());
+
+  for (ezUInt32 i = 0; i < 8; ++i)
+  {
+    const ezVec3 vCorner((i & 1) ? vMax.x : vMin.x, (i & 2) ? vMax.y : vMin.y, (i & 4) ? vMax.z : vMin.z);
+    const ezVec4 vClip = mModelViewProjection * vCorner.GetAsVec4(1.0f);
+
+    if (vClip.w < ezMath::DefaultEpsilon<float>())
+    {
+      // crosses the near plane, the screen space extents are unknown
+      out_bClipped = true;
+      return ezRectU16(0, 0, static_cast<ezUInt16>(uiBlocksX), static_cast<ezUInt16>(uiBlocksY));
+    }
+
+    const ezVec2 vScreen((vClip.x / vClip.w + 1.0f) * fScaleX, (vClip.y / vClip.w + 1.0f) * fScaleY);
+    vScreenMin = vScreenMin.CompMin(vScreen);
+    vScreenMax = vScreenMax.CompMax(vScreen);
+  }
+
+  out_bClipped = vScreenMin.x < 0.0f || vScreenMin.y < 0.0f || vScreenMax.x > m_uiResolutionX || vScreenMax.y > m_uiResolutionY;
+
+  // grow the rect by one block in each direction, to account for the limited precision of the rasterizer
+  const ezUInt32 uiFirstX = static_cast<ezUInt32>(ezMath::Clamp(vScreenMin.x / 8.0f - 1.0f, 0.0f, uiBlocksX - 1.0f));
+  const ezUInt32 uiFirstY = static_cast<ezUInt32>(ezMath::Clamp(vScreenMin.y / 8.0f - 1.0f, 0.0f, uiBlocksY - 1.0f));
+  const ezUInt32 uiLastX = static_cast<ezUInt32>(ezMath::Clamp(vScreenMax.x / 8.0f + 1.0f, 0.0f, uiBlocksX - 1.0f));
+  const ezUInt32 uiLastY = static_cast<ezUInt32>(ezMath::Clamp(vScreenMax.y / 8.0f + 1.0f, 0.0f, uiBlocksY - 1.0f));
+
+  return ezRectU16(static_cast<ezUInt16>(uiFirstX), static_cast<ezUInt16>(uiFirstY), static_cast<ezUInt16>(uiLastX + 1 - ezMath::Min(uiFirstX, uiLastX)), static_cast<ezUInt16>(uiLastY + 1 - ezMath::Min(uiFirstY, uiLastY)));
+}
+
+bool ezRasterizerView::CanReproject() const
+{
+  if (!m_Keyframe.m_bValid || m_Keyframe.m_uiNumReprojectedFrames >= static_cast<ezUInt32>(ezMath::Max(cvar_SpatialCullingOcclusionReprojectionMaxFrames.GetValue(), 0)))
+    return false;
+
+  if (!m_Keyframe.m_mProjection.IsEqual(m_mProjection, 0.0001f))
+    return false;
+
+  if ((m_pCamera->GetCenterPosition() - m_Keyframe.m_vCameraPosition).GetLength() > cvar_SpatialCullingOcclusionReprojectionMaxDistance)
+    return false;
+
+  const ezAngle maxAngle = ezAngle::MakeFromDegree(cvar_SpatialCullingOcclusionReprojectionMaxAngle);
+
+  return m_pCamera->GetCenterDirForwards().GetAngleBetween(m_Keyframe.m_vCameraDirForwards) <= maxAngle &&
+         m_pCamera->GetCenterDirUp().GetAngleBetween(m_Keyframe.m_vCameraDirUp) <= maxAngle;
+}
+
+void ezRasterizerView::Reproject()
+{
+#if EZ_ENABLED(EZ_RASTERIZER_SUPPORTED)
+  EZ_PROFILE_SCOPE("Occlusion::Reproject");
+
+  m_bReprojected = true;
+  ++m_Keyframe.m_uiNumReprojectedFrames;
+
+  const ezUInt32 uiBlocksX = m_uiResolutionX / 8;
+  const ezUInt32 uiBlocksY = m_uiResolutionY / 8;
+
+  const ezUInt32 uiFrame = m_Keyframe.m_uiNumReprojectedFrames;
+
+  for (Instance& inst : m_Instances)
+  {
+    if (KeyframeOccluder* pKeyframeOccluder = m_Keyframe.m_Occluders.GetValue(inst.m_uiHash))
+    {
+      pKeyframeOccluder->m_uiLastFrameSeen = uiFrame;
+      inst.m_bPartOfKeyframe = !pKeyframeOccluder->m_bClipped;
+    }
+  }
+
+  // the keyframe blocks that were covered by occluders which moved or disappeared since then can't be reprojected
+  m_BlockScratch.Clear();
+  m_BlockScratch.SetCount(uiBlocksX * uiBlocksY, 0.0f);
+
+  for (auto it = m_Keyframe.m_Occluders.GetIterator(); it.IsValid(); ++it)
+  {
+    if (it.Value().m_uiLastFrameSeen == uiFrame)
+      continue;
+
+    const ezRectU16& blocks = it.Value().m_Blocks;
+    for (ezUInt32 y = blocks.Top(); y < blocks.Bottom(); ++y)
+    {
+      for (ezUInt32 x = blocks.Left(); x < blocks.Right(); ++x)
+      {
+        m_BlockScratch[y * uiBlocksX + x] = 1.0f;
+      }
+    }
+  }
+
+  // zero means that nothing was written to the pixel
+  m_DepthScratch.SetCountUninitialized(m_uiResolutionX * m_uiResolutionY);
+  ezMemoryUtils::ZeroFill(m_DepthScratch.GetData(), m_DepthScratch.GetCount());
+
+  const float fScaleX = m_uiResolutionX * 0.5f - 4.0f;
+  const float fScaleY = m_uiResolutionY * 0.5f - 4.0f;
+  const ezUInt32 uiLastTile = m_Tiles.GetCount() - 1;
+
+  for (const ReprojectionQuad& quad : m_Keyframe.m_Quads)
+  {
+    if (m_BlockScratch[quad.m_uiBlock] != 0.0f)
+      continue;
+
+    ezVec2 vScreen[4];
+    ezVec2 vScreenMin(ezMath::MaxValue<float>());
+    ezVec2 vScreenMax(-ezMath::MaxValue<float>());
+    float fDepth = ezMath::MaxValue<float>();
+    bool bBehindCamera = false;
+
+    for (ezUInt32 i = 0; i < 4; ++i)
+    {
+      const ezVec4 vClip = m_mViewProjection * quad.m_vCorners[i].GetAsVec4(1.0f);
+
+      if (vClip.w < ezMath::DefaultEpsilon<float>())
+      {
+        bBehindCamera = true;
+        break;
+      }
+
+      vScreen[i].Set((vClip.x / vClip.w + 1.0f) * fScaleX, (vClip.y / vClip.w + 1.0f) * fScaleY);
+      vScreenMin = vScreenMin.CompMin(vScreen[i]);
+      vScreenMax = vScreenMax.CompMax(vScreen[i]);
+
+      // larger values are closer, the quad is written with the depth of its farthest corner
+      fDepth = ezMath::Min(fDepth, 0.5f * (1.0f - vClip.z / vClip.w));
+    }
+
+    if (bBehindCamera || fDepth <= 0.0f)
+      continue;
+
+    const ezUInt32 uiFirstX = static_cast<ezUInt32>(ezMath::Clamp(ezMath::Floor(vScreenMin.x), 0.0f, (float)m_uiResolutionX));
+    const ezUInt32 uiFirstY = static_cast<ezUInt32>(ezMath::Clamp(ezMath::Floor(vScreenMin.y), 0.0f, (float)m_uiResolutionY));
+    const ezUInt32 uiEndX = static_cast<ezUInt32>(ezMath::Clamp(ezMath::Ceil(vScreenMax.x), 0.0f, (float)m_uiResolutionX));
+    const ezUInt32 uiEndY = static_cast<ezUInt32>(ezMath::Clamp(ezMath::Ceil(vScreenMax.y), 0.0f, (float)m_uiResolutionY));
+
+    if (uiFirstX >= uiEndX || uiFirstY >= uiEndY)
+      continue;
+
+    // once the camera rotated, the quad isn't axis aligned anymore and its bounding rectangle would cover pixels next to the occluder,
+    // so only the pixels whose centers lie inside the projected quad are written
+    // the corners are stored row by row, going around the quad they are in the order 0, 1, 3, 2
+    const ezVec2 vPolygon[4] = {vScreen[0], vScreen[1], vScreen[3], vScreen[2]};
+
+    // the winding depends on whether the projection mirrors the quad, flip the edge functions such that inside is always positive
+    float fArea = 0.0f;
+    for (ezUInt32 i = 0; i < 4; ++i)
+    {
+      const ezVec2& a = vPolygon[i];
+      const ezVec2& b = vPolygon[(i + 1) % 4];
+      fArea += a.x * b.y - b.x * a.y;
+    }
+
+    if (fArea == 0.0f)
+      continue;
+
+    const float fWinding = fArea > 0.0f ? 1.0f : -1.0f;
+
+    bool bAnyPixelWritten = false;
+
+    for (ezUInt32 y = uiFirstY; y < uiEndY; ++y)
+    {
+      float* pRow = m_DepthScratch.GetData() + y * m_uiResolutionX;
+      const float fPixelY = y + 0.5f;
+
+      for (ezUInt32 x = uiFirstX; x < uiEndX; ++x)
+      {
+        const float fPixelX = x + 0.5f;
+
+        bool bInside = true;
+        for (ezUInt32 i = 0; i < 4 && bInside; ++i)
+        {
+          const ezVec2& a = vPolygon[i];
+          const ezVec2& b = vPolygon[(i + 1) % 4];
+          bInside = fWinding * ((b.x - a.x) * (fPixelY - a.y) - (b.y - a.y) * (fPixelX - a.x)) >= 0.0f;
+        }
+
+        if (!bInside)
+          continue;
+
+        // where quads overlap, keep the farther one
+        pRow[x] = (pRow[x] == 0.0f) ? fDepth : ezMath::Min(pRow[x], fDepth);
+        bAnyPixelWritten = true;
+      }
+    }
+
+    if (!bAnyPixelWritten)
+      continue;
+
+    for (ezUInt32 t = ezMath::Min(uiFirstY / m_uiTileRows, uiLastTile); t <= ezMath::Min((uiEndY - 1) / m_uiTileRows, uiLastTile); ++t)
+    {
+      m_Tiles[t].m_bAnyOccludersRasterized = true;
+    }
+  }
+
+  for (Tile& tile : m_Tiles)
+  {
+    tile.m_pRasterizer->writeRawDepth(m_DepthScratch.GetData() + tile.m_uiFirstRow * m_uiResolutionX);
+  }
+#endif
+}
+
+void ezRasterizerView::RemoveReprojectedObjects()
+{
+#if EZ_ENABLED(EZ_RASTERIZER_SUPPORTED)
+  const ezVec3 vCameraPosition = m_pCamera->GetCenterPosition();
+  const float fNearDistance = cvar_SpatialCullingOcclusionReprojectionNearDistance;
+
+  ezUInt32 uiNumRemaining = 0;
+
+  for (ezUInt32 i = 0; i < m_Instances.GetCount(); ++i)
+  {
+    const Instance& inst = m_Instances[i];
+
+    if (inst.m_bPartOfKeyframe)
+    {
+      // occluders that didn't change since the keyframe are already part of the reprojected depth, unless they are so close that the reprojection is too imprecise
+      const Occluder& occluder = inst.m_pObject->m_Occluder;
+      const float fRadius = (float)(ezSimdVec4f(occluder.m_boundsMax) - ezSimdVec4f(occluder.m_boundsMin)).GetLength<3>() * 0.5f * inst.m_Transform.GetMaxScale();
+
+      if ((inst.m_Transform.m_vPosition - vCameraPosition).GetLength() - fRadius > fNearDistance)
+        continue;
+    }
+
+    if (uiNumRemaining != i)
+    {
+      m_Instances[uiNumRemaining] = inst;
+    }
+
+    ++uiNumRemaining;
+  }
 
-  m_mViewProjection = mProjection * m_pCamera->GetViewMatrix();
+  m_Instances.SetCount(uiNumRemaining);
+#endif
 }
 
-void ezRasterizerView::ApplyModelViewProjectionMatrix(const ezTransform& modelTransform)
+void ezRasterizerView::StoreKeyframe()
 {
-  const ezMat4 mModel = modelTransform.GetAsMat4();
-  const ezMat4 mMVP = m_mViewProjection * mModel;
+#if EZ_ENABLED(EZ_RASTERIZER_SUPPORTED)
+  EZ_PROFILE_SCOPE("Occlusion::StoreKeyframe");
+
+  const ezUInt32 uiBlocksX = m_uiResolutionX / 8;
+  const ezUInt32 uiBlocksY = m_uiResolutionY / 8;
+
+  m_DepthScratch.SetCountUninitialized(m_uiResolutionX * m_uiResolutionY);
+
+  for (const Tile& tile : m_Tiles)
+  {
+    tile.m_pRasterizer->readBackRawDepth(m_DepthScratch.GetData() + tile.m_uiFirstRow * m_uiResolutionX);
+  }
+
+  const ezVec3 vCameraPosition = m_pCamera->GetCenterPosition();
+  const ezMat4 mInverseViewProjection = m_mViewProjection.GetInverse(0.0f);
+  const float fScaleX = m_uiResolutionX * 0.5f - 4.0f;
+  const float fScaleY = m_uiResolutionY * 0.5f - 4.0f;
+
+  auto Unproject = [&](float fX, float fY, float fDepth) {
+    const ezVec4 vWorld = mInverseViewProjection * ezVec4(fX / fScaleX - 1.0f, fY / fScaleY - 1.0f, 1.0f - 2.0f * fDepth, 1.0f);
+    return vWorld.GetAsVec3() / vWorld.w;
+  };
+
+  auto GetDepthRange = [&](ezUInt32 uiBlockX, ezUInt32 uiBlockY, float& out_fFarthest, float& out_fClosest) {
+    out_fFarthest = ezMath::MaxValue<float>();
+    out_fClosest = 0.0f;
+
+    for (ezUInt32 y = 0; y < 8; ++y)
+    {
+      const float* pRow = m_DepthScratch.GetData() + (uiBlockY * 8 + y) * m_uiResolutionX + uiBlockX * 8;
+
+      for (ezUInt32 x = 0; x < 8; ++x)
+      {
+        out_fFarthest = ezMath::Min(out_fFarthest, pRow[x]);
+        out_fClosest = ezMath::Max(out_fClosest, pRow[x]);
+      }
+    }
+  };
+
+  // find the blocks that are fully covered by a single surface, stores the distance to that surface or -1
+  m_BlockScratch.SetCountUninitialized(uiBlocksX * uiBlocksY);
+
+  for (ezUInt32 by = 0; by < uiBlocksY; ++by)
+  {
+    for (ezUInt32 bx = 0; bx < uiBlocksX; ++bx)
+    {
+      float fFarthest, fClosest;
+      GetDepthRange(bx, by, fFarthest, fClosest);
+
+      float& fBlockDistance = m_BlockScratch[by * uiBlocksX + bx];
+      fBlockDistance = -1.0f;
 
-  m_pRasterizer->setModelViewProjection(mMVP.m_fElementsCM);
+      if (fFarthest > 0.0f)
+      {
+        const float fCenterX = bx * 8.0f + 4.0f;
+        const float fCenterY = by * 8.0f + 4.0f;
+        const float fFarDistance = (Unproject(fCenterX, fCenterY, fFarthest) - vCameraPosition).GetLength();
+        const float fNearDistance = (Unproject(fCenterX, fCenterY, fClosest) - vCameraPosition).GetLength();
+
+        if (fFarDistance <= fNearDistance * (1.0f + s_fMaxReprojectionDepthVariation))
+        {
+          fBlockDistance = fFarDistance;
+        }
+      }
+    }
+  }
+
+  // only reproject blocks whose neighbors lie on the same surface, the others may be at a silhouette and would grow the occluders when reprojected
+  m_Keyframe.m_Quads.Clear();
+
+  for (ezUInt32 by = 1; by + 1 < uiBlocksY; ++by)
+  {
+    for (ezUInt32 bx = 1; bx + 1 < uiBlocksX; ++bx)
+    {
+      const float fBlockDistance = m_BlockScratch[by * uiBlocksX + bx];
+      if (fBlockDistance < 0.0f)
+        continue;
+
+      bool bContinuous = true;
+      for (ezUInt32 ny = by - 1; ny <= by + 1 && bContinuous; ++ny)
+      {
+        for (ezUInt32 nx = bx - 1; nx <= bx + 1 && bContinuous; ++nx)
+        {
+          const float fNeighborDistance = m_BlockScratch[ny * uiBlocksX + nx];
+          bContinuous = fNeighborDistance >= 0.0f && ezMath::Abs(fNeighborDistance - fBlockDistance) <= fBlockDistance * s_fMaxReprojectionDepthVariation;
+        }
+      }
+
+      if (!bContinuous)
+        continue;
+
+      float fFarthest, fClosest;
+      GetDepthRange(bx, by, fFarthest, fClosest);
+
+      const float fX = bx * 8.0f;
+      const float fY = by * 8.0f;
+
+      ReprojectionQuad& quad = m_Keyframe.m_Quads.ExpandAndGetRef();
+      quad.m_vCorners[0] = Unproject(fX, fY, fFarthest);
+      quad.m_vCorners[1] = Unproject(fX + 8.0f, fY, fFarthest);
+      quad.m_vCorners[2] = Unproject(fX, fY + 8.0f, fFarthest);
+      quad.m_vCorners[3] = Unproject(fX + 8.0f, fY + 8.0f, fFarthest);
+      quad.m_uiBlock = by * uiBlocksX + bx;
+    }
+  }
+
+  // remember which occluders are part of the keyframe, and where they are, to detect when they move or disappear
+  // occluders that were on screen but not rasterized are remembered as well, they don't need to be tested again while the keyframe is reprojected
+  m_Keyframe.m_Occluders.Clear();
+
+  for (const Tile& tile : m_Tiles)
+  {
+    for (ezUInt32 uiInstance : tile.m_Rasterized)
+    {
+      const Instance& inst = m_Instances[uiInstance];
+
+      if (m_Keyframe.m_Occluders.Contains(inst.m_uiHash))
+        continue;
+
+      const Occluder& occluder = inst.m_pObject->m_Occluder;
+
+      KeyframeOccluder keyframeOccluder;
+      keyframeOccluder.m_Blocks = ComputeBlockRect(inst.m_mModelViewProjection, ezSimdConversion::ToVec3(ezSimdVec4f(occluder.m_boundsMin)), ezSimdConversion::ToVec3(ezSimdVec4f(occluder.m_boundsMax)), keyframeOccluder.m_bClipped);
+
+      m_Keyframe.m_Occluders.Insert(inst.m_uiHash, keyframeOccluder);
+    }
+  }
+
+  for (const Instance& inst : m_Instances)
+  {
+    if (inst.m_bOnScreen && !m_Keyframe.m_Occluders.Contains(inst.m_uiHash))
+    {
+      m_Keyframe.m_Occluders.Insert(inst.m_uiHash, KeyframeOccluder());
+    }
+  }
+
+  m_Keyframe.m_bValid = true;
+  m_Keyframe.m_uiNumReprojectedFrames = 0;
+  m_Keyframe.m_vCameraPosition = vCameraPosition;
+  m_Keyframe.m_vCameraDirForwards = m_pCamera->GetCenterDirForwards();
+  m_Keyframe.m_vCameraDirUp = m_pCamera->GetCenterDirUp();
+  m_Keyframe.m_mProjection = m_mProjection;
+#endif
 }
 
 void ezRasterizerView::SortObjectsFrontToBack()
@@ -135,6 +746,36 @@ void ezRasterizerView::SortObjectsFrontToBack()
 #endif
 }
 
+bool ezRasterizerView::IsVisibleInTiles(const ezSimdMat4f& mViewProjection, ezSimdVec4f vMin, ezSimdVec4f vMax) const
+{
+#if EZ_ENABLED(EZ_RASTERIZER_SUPPORTED)
+  // ezSimdBBox makes no guarantees what's in the W component
+  // but the SW rasterizer requires them to be 1
+  vMin.SetW(1);
+  vMax.SetW(1);
+
+  ezUInt32 uiFirstTile, uiLastTile;
+  if (!ComputeTileRange(mViewProjection, vMin, vMax, uiFirstTile, uiLastTile))
+    return false;
+
+  for (ezUInt32 t = uiFirstTile; t <= uiLastTile; ++t)
+  {
+    const Tile& tile = m_Tiles[t];
+
+    if (!tile.m_bAnyOccludersRasterized)
+      return true;
+
+    bool needsClipping = false;
+    if (tile.m_pRasterizer->queryVisibility(vMin.m_v, vMax.m_v, needsClipping))
+      return true;
+  }
+
+  return false;
+#else
+  return true;
+#endif
+}
+
 bool ezRasterizerView::IsVisible(const ezSimdBBox& aabb) const
 {
 #if EZ_ENABLED(EZ_RASTERIZER_SUPPORTED)
@@ -143,21 +784,165 @@ bool ezRasterizerView::IsVisible(const ezSimdBBox& aabb) const
 
   EZ_PROFILE_SCOPE("Occlusion::IsVisible");
 
-  ezSimdVec4f vmin = aabb.m_Min;
-  ezSimdVec4f vmax = aabb.m_Max;
-
-  // ezSimdBBox makes no guarantees what's in the W component
-  // but the SW rasterizer requires them to be 1
-  vmin.SetW(1);
-  vmax.SetW(1);
-
-  bool needsClipping = false;
-  return m_pRasterizer->queryVisibility(vmin.m_v, vmax.m_v, needsClipping);
+  return IsVisibleInTiles(ezSimdConversion::ToMat4(m_mViewProjection), aabb.m_Min, aabb.m_Max);
 #else
   return true;
 #endif
 }
 
+void ezRasterizerView::AreVisible(ezArrayPtr<const ezSimdBBox> boxes, ezArrayPtr<bool> out_visible, float fBoundsScale /*= 1.0f*/) const
+{
+  EZ_ASSERT_DEBUG(out_visible.GetCount() >= boxes.GetCount(), "Output array is too small.");
+
+  if (!m_bAnyOccludersRasterized)
+  {
+    for (ezUInt32 i = 0; i < boxes.GetCount(); ++i)
+    {
+      out_visible[i] = true;
+    }
+
+    return;
+  }
+
+  EZ_PROFILE_SCOPE("Occlusion::AreVisible");
+
+  const ezSimdMat4f mViewProjection = ezSimdConversion::ToMat4(m_mViewProjection);
+  const ezSimdVec4f& c0 = mViewProjection.m_col0;
+  const ezSimdVec4f& c1 = mViewProjection.m_col1;
+  const ezSimdVec4f& c2 = mViewProjection.m_col2;
+  const ezSimdVec4f& c3 = mViewProjection.m_col3;
+
+  const ezSimdVec4f vScale(fBoundsScale);
+  const ezSimdVec4f vOne(1.0f);
+  const ezSimdVec4f vScreenScaleX(m_uiResolutionX * 0.5f - 4.0f);
+  const ezSimdVec4f vScreenScaleY(m_uiResolutionY * 0.5f - 4.0f);
+  const ezUInt32 uiLastTile = m_Tiles.GetCount() - 1;
+
+  for (ezUInt32 uiFirstBox = 0; uiFirstBox < boxes.GetCount(); uiFirstBox += 4)
+  {
+    const ezUInt32 uiNumBoxes = ezMath::Min(boxes.GetCount() - uiFirstBox, 4u);
+
+    // transpose four boxes into SoA layout, so that each SIMD lane handles one box, unused lanes repeat the last box
+    ezSimdMat4f mMin, mMax;
+    {
+      ezSimdVec4f vMin[4], vMax[4];
+
+      for (ezUInt32 i = 0; i < 4; ++i)
+      {
+        const ezSimdBBox& box = boxes[uiFirstBox + ezMath::Min(i, uiNumBoxes - 1)];
+        const ezSimdVec4f vCenter = box.GetCenter();
+        const ezSimdVec4f vHalfExtents = box.GetHalfExtents().CompMul(vScale);
+
+        vMin[i] = vCenter - vHalfExtents;
+        vMax[i] = vCenter + vHalfExtents;
+      }
+
+      mMin = ezSimdMat4f::MakeFromColumns(vMin[0], vMin[1], vMin[2], vMin[3]).GetTranspose();
+      mMax = ezSimdMat4f::MakeFromColumns(vMax[0], vMax[1], vMax[2], vMax[3]).GetTranspose();
+    }
+
+    // same near plane tolerance as Rasterizer::queryVisibility()
+    const ezSimdVec4f vExtents0 = mMax.m_col0 - mMin.m_col0;
+    const ezSimdVec4f vExtents1 = mMax.m_col1 - mMin.m_col1;
+    const ezSimdVec4f vExtents2 = mMax.m_col2 - mMin.m_col2;
+    const ezSimdVec4f vNearPlaneEpsilon = (vExtents0.CompMax(vExtents1).CompMax(vExtents2) * 0.001f).CompMax(ezSimdVec4f(ezMath::DefaultEpsilon<float>()));
+
+    ezSimdVec4f vScreenMinX(ezMath::MaxValue<float>());
+    ezSimdVec4f vScreenMinY(ezMath::MaxValue<float>());
+    ezSimdVec4f vScreenMaxX(-ezMath::MaxValue<float>());
+    ezSimdVec4f vScreenMaxY(-ezMath::MaxValue<float>());
+    ezSimdVec4f vClosestDepth(-ezMath::MaxValue<float>());
+    ezSimdVec4b vNearClipped(false);
+
+    for (ezUInt32 uiCorner = 0; uiCorner < 8; ++uiCorner)
+    {
+      const ezSimdVec4f& xs = (uiCorner & 1) ? mMax.m_col0 : mMin.m_col0;
+      const ezSimdVec4f& ys = (uiCorner & 2) ? mMax.m_col1 : mMin.m_col1;
+      const ezSimdVec4f& zs = (uiCorner & 4) ? mMax.m_col2 : mMin.m_col2;
+
+      const ezSimdVec4f vClipX = ezSimdVec4f::MulAdd(xs, c0.x(), ezSimdVec4f::MulAdd(ys, c1.x(), ezSimdVec4f::MulAdd(zs, c2.x(), ezSimdVec4f(c3.x()))));
+      const ezSimdVec4f vClipY = ezSimdVec4f::MulAdd(xs, c0.y(), ezSimdVec4f::MulAdd(ys, c1.y(), ezSimdVec4f::MulAdd(zs, c2.y(), ezSimdVec4f(c3.y()))));
+      const ezSimdVec4f vClipZ = ezSimdVec4f::MulAdd(xs, c0.z(), ezSimdVec4f::MulAdd(ys, c1.z(), ezSimdVec4f::MulAdd(zs, c2.z(), ezSimdVec4f(c3.z()))));
+      const ezSimdVec4f vClipW = ezSimdVec4f::MulAdd(xs, c0.w(), ezSimdVec4f::MulAdd(ys, c1.w(), ezSimdVec4f::MulAdd(zs, c2.w(), ezSimdVec4f(c3.w()))));
+
+      // the results of lanes that cross the near plane are garbage, those boxes are treated as visible below
+      vNearClipped = vNearClipped || (vClipW < vNearPlaneEpsilon);
+
+      const ezSimdVec4f vInvW = vOne.CompDiv(vClipW);
+
+      // the same pixel grid as the rasterizer, in rows of the full buffer
+      const ezSimdVec4f vScreenX = ezSimdVec4f::MulAdd(vClipX, vInvW, vOne).CompMul(vScreenScaleX);
+      const ezSimdVec4f vScreenY = ezSimdVec4f::MulAdd(vClipY, vInvW, vOne).CompMul(vScreenScaleY);
+
+      vScreenMinX = vScreenMinX.CompMin(vScreenX);
+      vScreenMinY = vScreenMinY.CompMin(vScreenY);
+      vScreenMaxX = vScreenMaxX.CompMax(vScreenX);
+      vScreenMaxY = vScreenMaxY.CompMax(vScreenY);
+
+      // raw depth, larger values are closer
+      vClosestDepth = vClosestDepth.CompMax((vOne - vClipZ.CompMul(vInvW)) * 0.5f);
+    }
+
+    // the rasterizer inflates the box by two pixels, to prevent incorrect occlusion due to its low precision
+    const ezSimdVec4f vInflate(2.0f);
+    vScreenMinX = (vScreenMinX - vInflate).CompMax(ezSimdVec4f::MakeZero()).Floor();
+    vScreenMinY = (vScreenMinY - vInflate).CompMax(ezSimdVec4f::MakeZero()).Floor();
+    vScreenMaxX = (vScreenMaxX + vInflate).CompMin(ezSimdVec4f(m_uiResolutionX - 1.0f)).Ceil();
+    vScreenMaxY = (vScreenMaxY + vInflate).CompMin(ezSimdVec4f(m_uiResolutionY - 1.0f)).Ceil();
+
+    // marks the boxes that cross the near plane
+    vScreenMinX = ezSimdVec4f::Select(vNearClipped, ezSimdVec4f(-1.0f), vScreenMinX);
+
+    float fMinX[4], fMinY[4], fMaxX[4], fMaxY[4], fClosestDepth[4];
+    vScreenMinX.Store<4>(fMinX);
+    vScreenMinY.Store<4>(fMinY);
+    vScreenMaxX.Store<4>(fMaxX);
+    vScreenMaxY.Store<4>(fMaxY);
+    vClosestDepth.Store<4>(fClosestDepth);
+
+    for (ezUInt32 i = 0; i < uiNumBoxes; ++i)
+    {
+      bool& bVisible = out_visible[uiFirstBox + i];
+
+      if (fMinX[i] < 0.0f)
+      {
+        bVisible = true;
+        continue;
+      }
+
+      // completely off-screen
+      bVisible = false;
+      if (fMinX[i] >= fMaxX[i] || fMinY[i] >= fMaxY[i])
+        continue;
+
+      const ezUInt32 uiMinX = static_cast<ezUInt32>(fMinX[i]);
+      const ezUInt32 uiMaxX = static_cast<ezUInt32>(fMaxX[i]);
+      const ezUInt32 uiMinY = static_cast<ezUInt32>(fMinY[i]);
+      const ezUInt32 uiMaxY = static_cast<ezUInt32>(fMaxY[i]);
+
+      for (ezUInt32 t = ezMath::Min(uiMinY / m_uiTileRows, uiLastTile); t <= ezMath::Min(uiMaxY / m_uiTileRows, uiLastTile) && !bVisible; ++t)
+      {
+        const Tile& tile = m_Tiles[t];
+
+        if (!tile.m_bAnyOccludersRasterized)
+        {
+          bVisible = true;
+          break;
+        }
+
+        // the rows of a tile line up with the rows of the full buffer
+        const ezUInt32 uiTileMinY = ezMath::Max(uiMinY, tile.m_uiFirstRow) - tile.m_uiFirstRow;
+        const ezUInt32 uiTileMaxY = ezMath::Min(uiMaxY - tile.m_uiFirstRow, tile.m_uiNumRows - 1);
+
+        if (uiTileMinY < uiTileMaxY)
+        {
+          bVisible = tile.m_pRasterizer->queryVisibilityRaw(uiMinX, uiMaxX, uiTileMinY, uiTileMaxY, fClosestDepth[i]);
+        }
+      }
+    }
+  }
+}
+
 ezRasterizerView* ezRasterizerViewPool::GetRasterizerView(ezUInt32 uiWidth, ezUInt32 uiHeight, float fAspectRatio)
 {
   EZ_PROFILE_SCOPE("Occlusion::GetViewFromPool");
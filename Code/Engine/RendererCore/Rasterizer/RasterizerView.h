@@ -1,9 +1,14 @@
 #pragma once
 
 #include <Foundation/Containers/Deque.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Math/Rect.h>
 #include <Foundation/Math/Transform.h>
+#include <Foundation/SimdMath/SimdMat4f.h>
 #include <Foundation/Threading/Mutex.h>
 #include <Foundation/Types/ArrayPtr.h>
+#include <Foundation/Types/UniquePtr.h>
 #include <RendererCore/RendererCoreDLL.h>
 
 class Rasterizer;
@@ -12,6 +17,16 @@ class ezColorLinearUB;
 class ezCamera;
 class ezSimdBBox;
 
+/// \brief Rasterizes occluders into a (low resolution) depth buffer on the CPU and allows to test whether bounding boxes are hidden behind them.
+///
+/// The depth buffer is split into horizontal tiles, each with its own hierarchical depth buffer. During EndScene() every occluder is binned into
+/// the tiles that it overlaps and all tiles are then rasterized in parallel on the task system. Only the closest 'Spatial.Occlusion.MaxOccluders'
+/// occluders on screen are binned, so the limit applies to the whole view, no matter how many tiles an occluder overlaps.
+///
+/// With 'Spatial.Occlusion.Reprojection' enabled, the depth buffer of a fully rasterized frame is kept as a keyframe. As long as the camera
+/// only moves a little, following frames start from the reprojected keyframe depth and only rasterize occluders that were added or moved
+/// since then, or that are close to the camera. Only blocks of the depth buffer that lie on a continuous surface are reprojected and blocks
+/// covered by occluders that moved or disappeared are discarded, so the result stays conservative.
 class EZ_RENDERERCORE_DLL ezRasterizerView final
 {
   EZ_DISALLOW_COPY_AND_ASSIGN(ezRasterizerView);
@@ -56,33 +71,121 @@ public:
   /// Note: This only works after EndScene().
   bool IsVisible(const ezSimdBBox& aabb) const;
 
+  /// \brief Checks the visibility of many boxes at once and writes the result for boxes[i] to out_visible[i].
+  ///
+  /// Every box is scaled around its center by fBoundsScale before the test, which can be used to counter the low precision of the occlusion buffer.
+  /// The boxes are projected to the screen four at a time with SIMD and then only tested against the tiles that they overlap, which makes this
+  /// considerably cheaper than calling IsVisible() for every box.
+  ///
+  /// Note: This only works after EndScene().
+  void AreVisible(ezArrayPtr<const ezSimdBBox> boxes, ezArrayPtr<bool> out_visible, float fBoundsScale = 1.0f) const;
+
   /// \brief Wether any occluder was actually added and also rasterized. If not, no need to do any visibility checks.
   bool HasRasterizedAnyOccluders() const
   {
     return m_bAnyOccludersRasterized;
   }
 
+  /// \brief Whether the last EndScene() started from the reprojected depth buffer of an earlier frame, instead of rasterizing all occluders.
+  bool WasReprojected() const
+  {
+    return m_bReprojected;
+  }
+
 private:
+  struct Tile
+  {
+    ezUniquePtr<Rasterizer> m_pRasterizer;
+    ezUInt32 m_uiFirstRow = 0;
+    ezUInt32 m_uiNumRows = 0;
+
+    // maps clip space y of the full buffer into the clip space of this tile
+    float m_fClipScaleY = 1.0f;
+    float m_fClipOffsetY = 0.0f;
+
+    bool m_bAnyOccludersRasterized = false;
+
+    // indices into m_Instances, sorted front to back
+    ezDynamicArray<ezUInt32> m_Bin;
+
+    // indices into m_Instances that were actually rasterized into this tile
+    ezDynamicArray<ezUInt32> m_Rasterized;
+  };
+
+  struct KeyframeOccluder
+  {
+    // the blocks of the depth buffer that the occluder may have covered, empty if it wasn't rasterized (e.g. because it was hidden)
+    ezRectU16 m_Blocks = ezRectU16(0, 0, 0, 0);
+
+    // the occluder was partially off-screen, so the keyframe doesn't contain all of it
+    bool m_bClipped = false;
+
+    // the last reprojected frame that still contained this occluder
+    ezUInt32 m_uiLastFrameSeen = 0;
+  };
+
+  // a block of the depth buffer that can be reprojected, as a quad in world space at the farthest depth of the block
+  struct ReprojectionQuad
+  {
+    ezVec3 m_vCorners[4];
+    ezUInt32 m_uiBlock = 0;
+  };
+
+  struct Keyframe
+  {
+    bool m_bValid = false;
+    ezUInt32 m_uiNumReprojectedFrames = 0;
+    ezVec3 m_vCameraPosition;
+    ezVec3 m_vCameraDirForwards;
+    ezVec3 m_vCameraDirUp;
+    ezMat4 m_mProjection;
+
+    ezDynamicArray<ReprojectionQuad> m_Quads;
+    ezHashTable<ezUInt64, KeyframeOccluder> m_Occluders;
+  };
+
+  void CreateTiles(ezUInt32 uiNumTiles);
   void SortObjectsFrontToBack();
-  void RasterizeObjects(ezUInt32 uiMaxObjects);
+  void BinObjects(ezUInt32 uiMaxObjects);
+  void RasterizeObjects();
+  void RasterizeTile(Tile& tile);
   void UpdateViewProjectionMatrix();
-  void ApplyModelViewProjectionMatrix(const ezTransform& modelTransform);
+  void ApplyModelViewProjectionMatrix(Tile& tile, const ezMat4& mModelViewProjection);
+  bool ComputeTileRange(const ezSimdMat4f& mModelViewProjection, const ezSimdVec4f& vMin, const ezSimdVec4f& vMax, ezUInt32& out_uiFirstTile, ezUInt32& out_uiLastTile) const;
+  bool IsVisibleInTiles(const ezSimdMat4f& mViewProjection, ezSimdVec4f vMin, ezSimdVec4f vMax) const;
+  bool CanReproject() const;
+  void Reproject();
+  void RemoveReprojectedObjects();
+  void StoreKeyframe();
+  ezRectU16 ComputeBlockRect(const ezMat4& mModelViewProjection, const ezVec3& vMin, const ezVec3& vMax, bool& out_bClipped) const;
 
   bool m_bAnyOccludersRasterized = false;
+  bool m_bReprojected = false;
   const ezCamera* m_pCamera = nullptr;
   ezUInt32 m_uiResolutionX = 0;
   ezUInt32 m_uiResolutionY = 0;
+  ezUInt32 m_uiTileRows = 0;
+  ezUInt32 m_uiNumRequestedTiles = 0;
   float m_fAspectRation = 1.0f;
-  ezUniquePtr<Rasterizer> m_pRasterizer;
+  ezDynamicArray<Tile> m_Tiles;
 
   struct Instance
   {
     ezTransform m_Transform;
     const ezRasterizerObject* m_pObject;
+    ezMat4 m_mModelViewProjection;
+    ezUInt64 m_uiHash = 0;
+    bool m_bOnScreen = false;
+    bool m_bPartOfKeyframe = false;
   };
 
   ezDeque<Instance> m_Instances;
+  ezMat4 m_mProjection;
   ezMat4 m_mViewProjection;
+
+  Keyframe m_Keyframe;
+  ezDynamicArray<float> m_DepthScratch;
+  ezDynamicArray<float> m_BlockScratch;
 };
 
 class ezRasterizerViewPool
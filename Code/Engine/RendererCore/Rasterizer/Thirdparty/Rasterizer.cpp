@@ -517,6 +517,15 @@ bool Rasterizer::queryVisibility(__m128 boundsMin, __m128 boundsMax, bool& needs
   return true;
 }
 
+bool Rasterizer::queryVisibilityRaw(uint32_t minX, uint32_t maxX, uint32_t minY, uint32_t maxY, float closestRawDepth) const
+{
+  // Same compression as in queryVisibility()
+  __m128 depth = _mm_set1_ps(closestRawDepth * floatCompressionBias);
+  uint16_t maxZ = uint16_t(_mm_extract_epi16(packDepthPremultiplied(depth, depth), 0));
+
+  return query2D(minX, maxX, minY, maxY, maxZ);
+}
+
 bool Rasterizer::query2D(uint32_t minX, uint32_t maxX, uint32_t minY, uint32_t maxY, uint32_t maxZ) const
 {
   const uint16_t* pHiZBuffer = &*m_hiZ.begin();
@@ -635,6 +644,62 @@ void Rasterizer::readBackDepth(void* target) const
   }
 }
 
+void Rasterizer::readBackRawDepth(float* target) const
+{
+  for (uint32_t blockY = 0; blockY < m_blocksY; ++blockY)
+  {
+    for (uint32_t blockX = 0; blockX < m_blocksX; ++blockX)
+    {
+      const bool cleared = m_hiZ[blockY * m_blocksX + blockX] == 1;
+      const uint16_t* source = reinterpret_cast<const uint16_t*>(&m_depthBuffer[8 * (blockY * m_blocksX + blockX)]);
+
+      for (uint32_t y = 0; y < 8; ++y)
+      {
+        float* dest = target + 8 * blockX + m_width * (8 * blockY + y);
+
+        for (uint32_t x = 0; x < 8; ++x)
+        {
+          dest[x] = cleared ? 0.0f : decompressFloat(source[8 * y + x]);
+        }
+      }
+    }
+  }
+}
+
+void Rasterizer::writeRawDepth(const float* source)
+{
+  const __m256 compressionBias = _mm256_set1_ps(floatCompressionBias);
+
+  for (uint32_t blockY = 0; blockY < m_blocksY; ++blockY)
+  {
+    for (uint32_t blockX = 0; blockX < m_blocksX; ++blockX)
+    {
+      __m128i* dest = &m_depthBuffer[8 * (blockY * m_blocksX + blockX)];
+
+      __m128i minDepth = _mm_set1_epi16(-1);
+      __m128i maxDepth = _mm_setzero_si128();
+
+      for (uint32_t y = 0; y < 8; ++y)
+      {
+        // Truncating the mantissa rounds towards the far plane, so the stored depth is never closer than the source
+        __m256 depth = _mm256_mul_ps(_mm256_loadu_ps(source + 8 * blockX + m_width * (8 * blockY + y)), compressionBias);
+        __m128i packed = packDepthPremultiplied(depth);
+
+        _mm_storeu_si128(dest + y, packed);
+
+        minDepth = _mm_min_epu16(minDepth, packed);
+        maxDepth = _mm_max_epu16(maxDepth, packed);
+      }
+
+      const uint16_t blockMin = uint16_t(_mm_extract_epi16(_mm_minpos_epu16(minDepth), 0));
+      const uint16_t blockMax = uint16_t(0xFFFF ^ _mm_extract_epi16(_mm_minpos_epu16(_mm_xor_si128(maxDepth, _mm_set1_epi16(-1))), 0));
+
+      // Blocks without any depth are marked as cleared, see clear()
+      m_hiZ[blockY * m_blocksX + blockX] = blockMax == 0 ? 1 : blockMin;
+    }
+  }
+}
+
 __forceinline float Rasterizer::decompressFloat(uint16_t depth)
 {
   const float bias = 3.9623753e+28f; // 1.0f / floatCompressionBias
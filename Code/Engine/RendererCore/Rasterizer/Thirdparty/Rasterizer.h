@@ -24,7 +24,14 @@ public:
 
   bool query2D(uint32_t minX, uint32_t maxX, uint32_t minY, uint32_t maxY, uint32_t maxZ) const;
 
+  // Like query2D(), but takes the raw depth of the closest point (larger is closer, see readBackRawDepth()).
+  bool queryVisibilityRaw(uint32_t minX, uint32_t maxX, uint32_t minY, uint32_t maxY, float closestRawDepth) const;
+
   void readBackDepth(void* target) const;
+
+  // Raw depth values as used internally (larger is closer), one float per pixel, 0 where nothing was rasterized.
+  void readBackRawDepth(float* target) const;
+  void writeRawDepth(const float* source);
 #else
   Rasterizer(uint32_t width, uint32_t height)
   {
@@ -48,7 +55,15 @@ public:
     return true;
   }
 
+  bool queryVisibilityRaw(uint32_t minX, uint32_t maxX, uint32_t minY, uint32_t maxY, float closestRawDepth) const
+  {
+    return true;
+  }
+
   void readBackDepth(void* pTarget) const {}
+
+  void readBackRawDepth(float* pTarget) const {}
+  void writeRawDepth(const float* pSource) {}
 #endif
 
 private:
@@ -400,43 +400,60 @@ ezArrayPtr<const ezInternal::RenderDataCacheEntry> ezRenderWorld::GetCachedRende
 
 void ezRenderWorld::AddViewToRender(const ezViewHandle& hView)
 {
-  ezView* pView = nullptr;
-  if (!TryGetView(hView, pView))
-    return;
+  AddViewsToRender(ezMakeArrayPtr(&hView, 1));
+}
 
-  if (!pView->IsValid())
-    return;
+void ezRenderWorld::AddViewsToRender(ezArrayPtr<const ezViewHandle> views)
+{
+  ezHybridArray<ezView*, 8> newViews;
 
   {
     EZ_LOCK(s_ViewsToRenderMutex);
     EZ_ASSERT_DEV(s_bInExtract, "Render views need to be collected during extraction");
 
-    // make sure the view is put at the end of the array, if it is already there, reorder it
-    // this ensures that the views that have been referenced by the last other view, get rendered first
-    ezUInt32 uiIndex = s_ViewsToRender.IndexOf(pView);
-    if (uiIndex != ezInvalidIndex)
+    for (const ezViewHandle& hView : views)
     {
-      s_ViewsToRender.RemoveAtAndCopy(uiIndex);
+      ezView* pView = nullptr;
+      if (!TryGetView(hView, pView))
+        continue;
+
+      if (!pView->IsValid())
+        continue;
+
+      // make sure the view is put at the end of the array, if it is already there, reorder it
+      // this ensures that the views that have been referenced by the last other view, get rendered first
+      ezUInt32 uiIndex = s_ViewsToRender.IndexOf(pView);
+      if (uiIndex != ezInvalidIndex)
+      {
+        s_ViewsToRender.RemoveAtAndCopy(uiIndex);
+        s_ViewsToRender.PushBack(pView);
+        continue;
+      }
+
       s_ViewsToRender.PushBack(pView);
-      return;
+      newViews.PushBack(pView);
     }
-
-    s_ViewsToRender.PushBack(pView);
   }
 
-  if (cvar_RenderingMultithreading)
+  // the new views are not extracted yet, so their visible objects can be determined up front
+  ezRenderPipeline::FindVisibleObjectsMultiView(newViews);
+
+  for (ezView* pView : newViews)
   {
-    ezTaskGroupID extractTaskID = ezTaskSystem::StartSingleTask(pView->GetExtractTask(), ezTaskPriority::EarlyThisFrame);
+    if (cvar_RenderingMultithreading)
+    {
+      ezTaskGroupID extractTaskID = ezTaskSystem::StartSingleTask(pView->GetExtractTask(), ezTaskPriority::EarlyThisFrame);
 
+      {
+        EZ_LOCK(s_ExtractTasksMutex);
+        s_ExtractTasks.PushBack(extractTaskID);
+      }
+    }
+    else
     {
-      EZ_LOCK(s_ExtractTasksMutex);
-      s_ExtractTasks.PushBack(extractTaskID);
+      pView->ExtractData();
     }
   }
-  else
-  {
-    pView->ExtractData();
-  }
 }
 
 void ezRenderWorld::ExtractMainViews()
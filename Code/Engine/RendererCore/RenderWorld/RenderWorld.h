@@ -63,6 +63,11 @@ public:
 
   static void AddViewToRender(const ezViewHandle& hView);
 
+  /// \brief Adds several views to render at once, e.g. all shadow views of a light.
+  ///
+  /// Views of the same world that see the same objects are culled together in one pass, see ezSpatialSystem::FindVisibleObjectsMultiView.
+  static void AddViewsToRender(ezArrayPtr<const ezViewHandle> views);
+
   static void ExtractMainViews();
 
   static void Render(ezRenderContext* pRenderContext);
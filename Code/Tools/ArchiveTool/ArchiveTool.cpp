@@ -36,6 +36,13 @@
     Example:
       -pack "path/to/folder" "path/to/another/folder"
 
+-benchmark <paths>
+    One or multiple paths to folders that are packed with different compression modes, to compare the compression ratio and decompression speed.
+    The archives are written to the temp folder.
+
+    Example:
+      -benchmark "path/to/folder"
+
 Description:
     -pack and -unpack can take multiple inputs to either aggregate multiple folders into one archive (pack)
     or to unpack multiple archives at the same time.
@@ -85,6 +92,15 @@ Example:\n\
 ",
   "");
 
+ezCommandLineOptionDoc opt_Benchmark("_ArchiveTool", "-benchmark", "<paths>", "\
+One or multiple paths to folders that are packed with different compression modes, to compare the compression ratio and decompression speed.\n\
+The archives are written to the temp folder.\n\
+\n\
+Example:\n\
+  -benchmark \"path/to/folder\"\n\
+",
+  "");
+
 ezCommandLineOptionDoc opt_Desc("_ArchiveTool", "Description:", "", "\
 -pack and -unpack can take multiple inputs to either aggregate multiple folders into one archive (pack)\n\
 or to unpack multiple archives at the same time.\n\
@@ -148,6 +164,7 @@ public:
     Auto,
     Pack,
     Unpack,
+    Benchmark,
   };
 
   ArchiveMode m_Mode = ArchiveMode::Auto;
@@ -196,6 +213,22 @@ public:
         }
       }
     }
+    else if (cmd.GetStringOptionArguments("-benchmark") > 0)
+    {
+      m_Mode = ArchiveMode::Benchmark;
+      const ezUInt32 args = cmd.GetStringOptionArguments("-benchmark");
+
+      for (ezUInt32 a = 0; a < args; ++a)
+      {
+        m_sInputs.PushBack(cmd.GetAbsolutePathOption("-benchmark", a));
+
+        if (!ezOSFile::ExistsDirectory(m_sInputs.PeekBack()))
+        {
+          ezLog::Error("-benchmark input path is not a valid directory: '{}'", m_sInputs.PeekBack());
+          return EZ_FAILURE;
+        }
+      }
+    }
     else if (cmd.GetStringOptionArguments("-unpack") > 0)
     {
       m_Mode = ArchiveMode::Unpack;
@@ -254,7 +287,8 @@ public:
       }
     }
 
-    ezLog::Info("Mode is: {}", m_Mode == ArchiveMode::Pack ? "pack" : "unpack");
+    const char* szModes[] = {"auto", "pack", "unpack", "benchmark"};
+    ezLog::Info("Mode is: {}", szModes[(int)m_Mode]);
     ezLog::Info("Inputs:");
 
     for (const auto& input : m_sInputs)
@@ -304,6 +338,100 @@ public:
     return ezArchiveBuilder::InclusionMode::Compress_zstd_average;
   }
 
+  static ezArchiveBuilder::InclusionMode PackFileDictionaryCallback(ezStringView sFile)
+  {
+    const ezArchiveBuilder::InclusionMode mode = PackFileCallback(sFile);
+
+    if (mode != ezArchiveBuilder::InclusionMode::Compress_zstd_average)
+      return mode;
+
+    // only small files benefit from a dictionary
+    ezFileStats stats;
+    if (ezOSFile::GetFileStats(sFile, stats).Succeeded() && stats.m_uiFileSize <= 64 * 1024)
+      return ezArchiveBuilder::InclusionMode::Compress_zstd_dictionary;
+
+    return mode;
+  }
+
+  ezResult Benchmark()
+  {
+    struct Config
+    {
+      const char* m_szName;
+      ezArchiveBuilder::InclusionCallback m_Callback;
+    };
+
+    const Config configs[] = {
+      {"zstd", PackFileCallback},
+      {"zstd-dictionary", PackFileDictionaryCallback},
+    };
+
+    constexpr ezUInt32 uiNumRuns = 5;
+
+    for (const Config& config : configs)
+    {
+      ezArchiveBuilder archive;
+
+      for (const auto& folder : m_sInputs)
+      {
+        archive.AddFolder(folder, ezArchiveCompressionMode::Compressed_zstd, config.m_Callback);
+      }
+
+      ezStringBuilder sArchiveFile = ezOSFile::GetTempDataFolder("ArchiveTool");
+      sArchiveFile.AppendFormat("/Benchmark-{}.ezArchive", config.m_szName);
+
+      ezStopwatch sw;
+      EZ_SUCCEED_OR_RETURN(archive.WriteArchive(sArchiveFile));
+      const ezTime tWrite = sw.GetRunningTotal();
+
+      ezArchiveReader reader;
+      EZ_SUCCEED_OR_RETURN(reader.OpenArchive(sArchiveFile));
+
+      const ezArchiveTOC& toc = reader.GetArchiveTOC();
+      const ezUInt32 uiNumEntries = toc.m_Entries.GetCount();
+
+      ezUInt64 uiUncompressedSize = 0;
+      ezUInt64 uiStoredSize = toc.m_CompressionDictionary.GetCount();
+      ezUInt64 uiLargestEntry = 0;
+
+      for (const ezArchiveEntry& entry : toc.m_Entries)
+      {
+        uiUncompressedSize += entry.m_uiUncompressedDataSize;
+        uiStoredSize += entry.m_uiStoredDataSize;
+        uiLargestEntry = ezMath::Max(uiLargestEntry, entry.m_uiUncompressedDataSize);
+      }
+
+      ezDynamicArray<ezUInt8> buffer;
+      buffer.SetCountUninitialized(static_cast<ezUInt32>(uiLargestEntry));
+
+      ezTime tBestRead = ezTime::MakeFromHours(1);
+
+      for (ezUInt32 uiRun = 0; uiRun < uiNumRuns; ++uiRun)
+      {
+        sw.StopAndReset();
+        sw.Resume();
+
+        for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+        {
+          if (reader.ReadEntry(i, buffer.GetArrayPtr().GetSubArray(0, static_cast<ezUInt32>(toc.m_Entries[i].m_uiUncompressedDataSize))).Failed())
+          {
+            ezLog::Error("Failed to read entry '{}'", toc.GetEntryPathString(i));
+            return EZ_FAILURE;
+          }
+        }
+
+        tBestRead = ezMath::Min(tBestRead, sw.GetRunningTotal());
+      }
+
+      const double fRatio = uiStoredSize > 0 ? (double)uiUncompressedSize / (double)uiStoredSize : 1.0;
+      const double fThroughput = (uiUncompressedSize / (1024.0 * 1024.0)) / ezMath::Max(tBestRead.GetSeconds(), 0.000001);
+
+      ezLog::Info("{}: {} entries, {} -> {} (ratio {}, dictionary {}), packing: {}, decompression: {} ({} MB/s)", config.m_szName, uiNumEntries, ezArgFileSize(uiUncompressedSize), ezArgFileSize(uiStoredSize), ezArgF(fRatio, 2), ezArgFileSize(toc.m_CompressionDictionary.GetCount()), tWrite, tBestRead, ezArgF(fThroughput, 1));
+    }
+
+    return EZ_SUCCESS;
+  }
+
   ezResult Pack()
   {
     ezArchiveBuilderImpl archive;
@@ -411,6 +539,18 @@ public:
       return ezApplication::Execution::Quit;
     }
 
+    if (m_Mode == ArchiveMode::Benchmark)
+    {
+      if (Benchmark().Failed())
+      {
+        ezLog::Error("Benchmark failed");
+        SetReturnCode(4);
+      }
+
+      ezLog::Success("Finished benchmark in {}", sw.GetRunningTotal());
+      return ezApplication::Execution::Quit;
+    }
+
     ezLog::Error("Unknown mode");
     return ezApplication::Execution::Quit;
   }
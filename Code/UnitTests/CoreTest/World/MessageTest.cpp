@@ -1,7 +1,9 @@
 #include <CoreTest/CoreTestPCH.h>
 
 #include <Core/World/World.h>
+#include <Foundation/Configuration/CVar.h>
 #include <Foundation/Memory/FrameAllocator.h>
+#include <Foundation/Threading/Thread.h>
 #include <Foundation/Time/Clock.h>
 
 namespace
@@ -80,6 +82,65 @@ namespace
   EZ_END_COMPONENT_TYPE;
   // clang-format on
 
+  class TestComponentBatchMsg;
+
+  class TestComponentBatchMsgManager : public ezComponentManager<TestComponentBatchMsg, ezBlockStorageType::FreeList>
+  {
+  public:
+    TestComponentBatchMsgManager(ezWorld* pWorld)
+      : ezComponentManager<TestComponentBatchMsg, ezBlockStorageType::FreeList>(pWorld)
+    {
+    }
+
+    virtual bool HandleMessageBatch(ezMessageId msgId, ezArrayPtr<const MessageBatchEntry> batch) override;
+
+    ezUInt32 m_uiNumBatches = 0;
+    ezUInt32 m_uiNumBatchedMessages = 0;
+  };
+
+  class TestComponentBatchMsg : public ezComponent
+  {
+    EZ_DECLARE_COMPONENT_TYPE(TestComponentBatchMsg, ezComponent, TestComponentBatchMsgManager);
+
+  public:
+    void OnTestMessage(TestMessage1& ref_msg) { m_iSomeData += ref_msg.m_iValue; }
+
+    void OnTestMessage2(TestMessage2& ref_msg) { m_iSomeData2 += 2 * ref_msg.m_iValue; }
+
+    ezInt32 m_iSomeData = 1;
+    ezInt32 m_iSomeData2 = 2;
+  };
+
+  // clang-format off
+  EZ_BEGIN_COMPONENT_TYPE(TestComponentBatchMsg, 1, ezComponentMode::Static)
+  {
+    EZ_BEGIN_MESSAGEHANDLERS
+    {
+      EZ_MESSAGE_HANDLER(TestMessage1, OnTestMessage),
+      EZ_MESSAGE_HANDLER(TestMessage2, OnTestMessage2),
+    }
+    EZ_END_MESSAGEHANDLERS;
+  }
+  EZ_END_COMPONENT_TYPE;
+  // clang-format on
+
+  bool TestComponentBatchMsgManager::HandleMessageBatch(ezMessageId msgId, ezArrayPtr<const MessageBatchEntry> batch)
+  {
+    // only TestMessage1 is handled in batches, TestMessage2 falls back to the regular handler
+    if (msgId != TestMessage1::GetTypeMsgId())
+      return false;
+
+    ++m_uiNumBatches;
+    m_uiNumBatchedMessages += batch.GetCount();
+
+    for (const MessageBatchEntry& entry : batch)
+    {
+      static_cast<TestComponentBatchMsg*>(entry.m_pComponent)->m_iSomeData += 10 * static_cast<TestMessage1*>(entry.m_pMessage)->m_iValue;
+    }
+
+    return true;
+  }
+
   void ResetComponents(ezGameObject& ref_object)
   {
     TestComponentMsg* pComponent = nullptr;
@@ -94,6 +155,38 @@ namespace
       ResetComponents(*it);
     }
   }
+
+  class PostMessageThread : public ezThread
+  {
+  public:
+    PostMessageThread(const ezWorld& world, ezGameObjectHandle hReceiver, ezUInt32 uiNumMessages)
+      : ezThread("PostMessageThread")
+      , m_World(world)
+      , m_hReceiver(hReceiver)
+      , m_uiNumMessages(uiNumMessages)
+    {
+    }
+
+    virtual ezUInt32 Run() override
+    {
+      for (ezUInt32 i = 0; i < m_uiNumMessages; ++i)
+      {
+        TestMessage1 msg;
+        msg.m_iValue = 1;
+        m_World.PostMessage(m_hReceiver, msg, ezTime::MakeZero(), ezObjectMsgQueueType::NextFrame);
+
+        TestMessage2 msg2;
+        msg2.m_iValue = 1;
+        m_World.PostMessage(m_hReceiver, msg2, ezTime::MakeFromSeconds(0.5), ezObjectMsgQueueType::NextFrame);
+      }
+
+      return 0;
+    }
+
+    const ezWorld& m_World;
+    ezGameObjectHandle m_hReceiver;
+    ezUInt32 m_uiNumMessages;
+  };
 } // namespace
 
 EZ_CREATE_SIMPLE_TEST(World, Messaging)
@@ -233,4 +326,132 @@ EZ_CREATE_SIMPLE_TEST(World, Messaging)
 
     ezFrameAllocator::Reset();
   }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Batched dispatch")
+  {
+    ezCVarBool* pBatchedDispatch = static_cast<ezCVarBool*>(ezCVar::FindCVarByName("World.BatchedMessageDispatch"));
+    EZ_TEST_BOOL(pBatchedDispatch != nullptr);
+
+    TestComponentBatchMsgManager* pBatchManager = world.GetOrCreateComponentManager<TestComponentBatchMsgManager>();
+
+    ezHybridArray<TestComponentBatchMsg*, 8> batchComponents;
+    for (ezUInt32 i = 0; i < 8; ++i)
+    {
+      TestComponentBatchMsg* pBatchComponent = nullptr;
+      pBatchManager->CreateComponent(i < 4 ? pParents[0] : pParents[1], pBatchComponent);
+      batchComponents.PushBack(pBatchComponent);
+    }
+
+    TestComponentMsg* pParentComponent = nullptr;
+    pParents[0]->TryGetComponentOfBaseType(pParentComponent);
+
+    // initialize the new components
+    world.Update();
+
+    const bool bOldValue = *pBatchedDispatch;
+
+    for (bool bBatched : {true, false})
+    {
+      *pBatchedDispatch = bBatched;
+
+      ResetComponents(*pRoot);
+      for (TestComponentBatchMsg* pBatchComponent : batchComponents)
+      {
+        pBatchComponent->m_iSomeData = 1;
+        pBatchComponent->m_iSomeData2 = 2;
+      }
+      pBatchManager->m_uiNumBatches = 0;
+      pBatchManager->m_uiNumBatchedMessages = 0;
+
+      // interleave messages for both component types, the world has to group them
+      for (ezUInt32 i = 0; i < 3; ++i)
+      {
+        for (TestComponentBatchMsg* pBatchComponent : batchComponents)
+        {
+          TestMessage1 msg;
+          msg.m_iValue = i + 1;
+          pBatchComponent->PostMessage(msg, ezTime::MakeZero(), ezObjectMsgQueueType::NextFrame);
+
+          TestMessage2 msg2;
+          msg2.m_iValue = i + 1;
+          pBatchComponent->PostMessage(msg2, ezTime::MakeZero(), ezObjectMsgQueueType::NextFrame);
+        }
+
+        TestMessage1 msg;
+        msg.m_iValue = i + 1;
+        pParentComponent->PostMessage(msg, ezTime::MakeZero(), ezObjectMsgQueueType::NextFrame);
+      }
+
+      world.Update();
+
+      const ezInt32 iFactor = bBatched ? 10 : 1;
+      for (TestComponentBatchMsg* pBatchComponent : batchComponents)
+      {
+        EZ_TEST_INT(pBatchComponent->m_iSomeData, 1 + iFactor * 6);
+        EZ_TEST_INT(pBatchComponent->m_iSomeData2, 2 + 2 * 6);
+      }
+
+      EZ_TEST_INT(pParentComponent->m_iSomeData, 1 + 6);
+
+      EZ_TEST_INT(pBatchManager->m_uiNumBatches, bBatched ? 1 : 0);
+      EZ_TEST_INT(pBatchManager->m_uiNumBatchedMessages, bBatched ? 24 : 0);
+    }
+
+    *pBatchedDispatch = bOldValue;
+
+    for (TestComponentBatchMsg* pBatchComponent : batchComponents)
+    {
+      pBatchManager->DeleteComponent(pBatchComponent);
+    }
+
+    ezFrameAllocator::Reset();
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Queuing from multiple threads")
+  {
+    ezCVarBool* pThreadMessageBuffers = static_cast<ezCVarBool*>(ezCVar::FindCVarByName("World.ThreadMessageBuffers"));
+    EZ_TEST_BOOL(pThreadMessageBuffers != nullptr);
+
+    world.GetClock().SetFixedTimeStep(ezTime::MakeFromSeconds(1.001f));
+
+    for (bool bThreadMessageBuffers : {true, false})
+    {
+      *pThreadMessageBuffers = bThreadMessageBuffers;
+
+      ResetComponents(*pRoot);
+
+      constexpr ezUInt32 uiNumThreads = 8;
+      constexpr ezUInt32 uiNumMessagesPerThread = 1000;
+
+      {
+        ezHybridArray<ezUniquePtr<PostMessageThread>, uiNumThreads> threads;
+        for (ezUInt32 i = 0; i < uiNumThreads; ++i)
+        {
+          threads.PushBack(EZ_DEFAULT_NEW(PostMessageThread, world, pRoot->GetHandle(), uiNumMessagesPerThread));
+          threads.PeekBack()->Start();
+        }
+
+        for (auto& pThread : threads)
+        {
+          pThread->Join();
+        }
+      }
+
+      TestComponentMsg* pComponent2 = nullptr;
+      pRoot->TryGetComponentOfBaseType(pComponent2);
+
+      // the threads are gone by now, their messages must still be delivered
+      world.Update();
+      EZ_TEST_INT(pComponent2->m_iSomeData, 1 + uiNumThreads * uiNumMessagesPerThread);
+      EZ_TEST_INT(pComponent2->m_iSomeData2, 2 + 2 * uiNumThreads * uiNumMessagesPerThread);
+
+      world.Update();
+      EZ_TEST_INT(pComponent2->m_iSomeData, 1 + uiNumThreads * uiNumMessagesPerThread);
+      EZ_TEST_INT(pComponent2->m_iSomeData2, 2 + 2 * uiNumThreads * uiNumMessagesPerThread);
+    }
+
+    *pThreadMessageBuffers = true;
+
+    ezFrameAllocator::Reset();
+  }
 }
@@ -1,13 +1,18 @@
 #include <CoreTest/CoreTestPCH.h>
 
 #include <Core/Messages/UpdateLocalBoundsMessage.h>
+#include <Core/World/SpatialSystem_Bvh.h>
+#include <Core/World/SpatialSystem_RegularGrid.h>
 #include <Core/World/World.h>
+#include <Foundation/Configuration/CVar.h>
 #include <Foundation/Containers/HashSet.h>
 #include <Foundation/IO/FileSystem/DataDirTypeFolder.h>
 #include <Foundation/IO/FileSystem/FileSystem.h>
 #include <Foundation/IO/FileSystem/FileWriter.h>
 #include <Foundation/Profiling/Profiling.h>
 #include <Foundation/Profiling/ProfilingUtils.h>
+#include <Foundation/SimdMath/SimdConversion.h>
+#include <Foundation/Types/TagRegistry.h>
 #include <Foundation/Utilities/GraphicsUtils.h>
 
 namespace
@@ -56,6 +61,206 @@ namespace
   }
   EZ_END_COMPONENT_TYPE;
   // clang-format on
+
+  ezSimdBBoxSphere GetRandomBounds(ezRandom& ref_rng, double fRange)
+  {
+    const ezVec3 vCenter((float)ref_rng.DoubleMinMax(-fRange, fRange), (float)ref_rng.DoubleMinMax(-fRange, fRange), (float)ref_rng.DoubleMinMax(-fRange, fRange));
+
+    // sizes are distributed logarithmically so that tiny and huge objects are mixed
+    const ezVec3 vHalfExtents((float)ezMath::Pow(2.0, ref_rng.DoubleMinMax(-1.0, 8.0)), (float)ezMath::Pow(2.0, ref_rng.DoubleMinMax(-1.0, 8.0)), (float)ezMath::Pow(2.0, ref_rng.DoubleMinMax(-1.0, 8.0)));
+
+    return ezSimdBBoxSphere::MakeFromCenterExtents(ezSimdConversion::ToVec3(vCenter), ezSimdConversion::ToVec3(vHalfExtents), vHalfExtents.GetLength());
+  }
+
+  ezFrustum GetRandomFrustum(ezRandom& ref_rng, double fRange)
+  {
+    const ezVec3 vPos((float)ref_rng.DoubleMinMax(-fRange, fRange), (float)ref_rng.DoubleMinMax(-fRange, fRange), (float)ref_rng.DoubleMinMax(-fRange, fRange));
+
+    ezVec3 vDir = ezVec3::MakeRandomDirection(ref_rng);
+    vDir.z *= 0.5f;
+    vDir.Normalize();
+
+    ezMat4 lookAt = ezGraphicsUtils::CreateLookAtViewMatrix(vPos, vPos + vDir, ezVec3::MakeAxisZ());
+    ezMat4 projection = ezGraphicsUtils::CreatePerspectiveProjectionMatrixFromFovX(ezAngle::MakeFromDegree(70.0f), 1.0f, 1.0f, (float)fRange);
+
+    return ezFrustum::MakeFromMVP(projection * lookAt);
+  }
+
+  /// \brief Applies the same operations to a regular grid and a BVH spatial system, so that the results of their queries can be compared.
+  struct SpatialSystemComparison
+  {
+    ezSpatialSystem_RegularGrid m_GridSystem;
+    ezSpatialSystem_Bvh m_BvhSystem;
+
+    ezSpatialSystem& m_Grid = m_GridSystem;
+    ezSpatialSystem& m_Bvh = m_BvhSystem;
+
+    struct Object
+    {
+      ezSimdBBoxSphere m_Bounds;
+      bool m_bAlwaysVisible = false;
+      ezSpatialDataHandle m_hGridData;
+      ezSpatialDataHandle m_hBvhData;
+    };
+
+    ezDynamicArray<Object> m_Objects;
+
+    // The spatial systems never dereference the object pointers, so the object index is good enough as an identifier
+    static ezGameObject* GetObjectPointer(ezUInt32 uiIndex) { return reinterpret_cast<ezGameObject*>(static_cast<size_t>(uiIndex + 1) * 16); }
+    static ezUInt32 GetObjectIndex(const ezGameObject* pObject) { return static_cast<ezUInt32>(reinterpret_cast<size_t>(pObject) / 16 - 1); }
+
+    void Create(const ezSimdBBoxSphere& bounds, ezUInt32 uiCategoryBitmask, const ezTagSet& tags, bool bAlwaysVisible)
+    {
+      ezGameObject* pObject = GetObjectPointer(m_Objects.GetCount());
+
+      auto& object = m_Objects.ExpandAndGetRef();
+      object.m_Bounds = bounds;
+      object.m_bAlwaysVisible = bAlwaysVisible;
+
+      if (bAlwaysVisible)
+      {
+        object.m_hGridData = m_Grid.CreateSpatialDataAlwaysVisible(pObject, uiCategoryBitmask, tags);
+        object.m_hBvhData = m_Bvh.CreateSpatialDataAlwaysVisible(pObject, uiCategoryBitmask, tags);
+      }
+      else
+      {
+        object.m_hGridData = m_Grid.CreateSpatialData(bounds, pObject, uiCategoryBitmask, tags);
+        object.m_hBvhData = m_Bvh.CreateSpatialData(bounds, pObject, uiCategoryBitmask, tags);
+      }
+    }
+
+    void Update(ezUInt32 uiIndex, const ezSimdBBoxSphere& bounds)
+    {
+      auto& object = m_Objects[uiIndex];
+      object.m_Bounds = bounds;
+
+      if (!object.m_hGridData.IsInvalidated())
+      {
+        m_Grid.UpdateSpatialDataBounds(object.m_hGridData, bounds);
+        m_Bvh.UpdateSpatialDataBounds(object.m_hBvhData, bounds);
+      }
+    }
+
+    void Delete(ezUInt32 uiIndex)
+    {
+      auto& object = m_Objects[uiIndex];
+      if (!object.m_hGridData.IsInvalidated())
+      {
+        m_Grid.DeleteSpatialData(object.m_hGridData);
+        m_Bvh.DeleteSpatialData(object.m_hBvhData);
+
+        object.m_hGridData.Invalidate();
+        object.m_hBvhData.Invalidate();
+      }
+    }
+
+    void StartNewFrame()
+    {
+      m_Grid.StartNewFrame();
+      m_Bvh.StartNewFrame();
+    }
+
+    template <typename T>
+    static bool HaveSameElements(ezDynamicArray<T>& ref_a, ezDynamicArray<T>& ref_b)
+    {
+      ref_a.Sort();
+      ref_b.Sort();
+      return ref_a == ref_b;
+    }
+
+    void CompareShapeQueries(ezRandom& ref_rng, double fRange, const ezSpatialSystem::QueryParams& queryParams)
+    {
+      for (ezUInt32 i = 0; i < 16; ++i)
+      {
+        const ezSimdBBoxSphere queryBounds = GetRandomBounds(ref_rng, fRange);
+        const ezBoundingBoxSphere bounds = ezSimdConversion::ToBBoxSphere(queryBounds);
+
+        ezDynamicArray<ezGameObject*> gridObjects;
+        ezDynamicArray<ezGameObject*> bvhObjects;
+
+        const ezBoundingSphere sphere = ezBoundingSphere::MakeFromCenterAndRadius(bounds.m_vCenter, bounds.m_fSphereRadius * 4.0f);
+        m_Grid.FindObjectsInSphere(sphere, queryParams, gridObjects);
+        m_Bvh.FindObjectsInSphere(sphere, queryParams, bvhObjects);
+        EZ_TEST_BOOL(HaveSameElements(gridObjects, bvhObjects));
+
+        gridObjects.Clear();
+        bvhObjects.Clear();
+
+        const ezBoundingBox box = ezBoundingBox::MakeFromCenterAndHalfExtents(bounds.m_vCenter, bounds.m_vBoxHalfExtends * 4.0f);
+        m_Grid.FindObjectsInBox(box, queryParams, gridObjects);
+        m_Bvh.FindObjectsInBox(box, queryParams, bvhObjects);
+        EZ_TEST_BOOL(HaveSameElements(gridObjects, bvhObjects));
+      }
+    }
+
+    /// The regular grid only approximates the bounds of moved objects with its cells, so it may miss objects that are barely visible.
+    /// The BVH has to find everything the grid finds and anything else it finds has to be visible as well.
+    void CheckVisibleObjects(const ezFrustum& frustum, ezDynamicArray<const ezGameObject*>& ref_gridObjects, ezDynamicArray<const ezGameObject*>& ref_bvhObjects)
+    {
+      ezHashSet<const ezGameObject*> bvhObjects;
+      for (const ezGameObject* pObject : ref_bvhObjects)
+      {
+        EZ_TEST_BOOL(!bvhObjects.Insert(pObject));
+      }
+
+      for (const ezGameObject* pObject : ref_gridObjects)
+      {
+        EZ_TEST_BOOL(bvhObjects.Remove(pObject));
+      }
+
+      for (const ezGameObject* pObject : bvhObjects)
+      {
+        EZ_TEST_BOOL(frustum.Overlaps(m_Objects[GetObjectIndex(pObject)].m_Bounds.GetSphere()));
+      }
+    }
+
+    void CompareVisibleObjects(ezRandom& ref_rng, double fRange, const ezSpatialSystem::QueryParams& queryParams)
+    {
+      // everything on the negative y side counts as occluded
+      auto IsOccluded = [](const ezSimdBBox& box) -> bool {
+        return box.m_Max.y() < 0.0f;
+      };
+
+      for (ezUInt32 i = 0; i < 4; ++i)
+      {
+        const ezFrustum frustum = GetRandomFrustum(ref_rng, fRange);
+
+        ezDynamicArray<const ezGameObject*> gridObjects;
+        ezDynamicArray<const ezGameObject*> bvhObjects;
+
+        m_Grid.FindVisibleObjects(frustum, queryParams, gridObjects, {}, ezVisibilityState::Direct);
+        m_Bvh.FindVisibleObjects(frustum, queryParams, bvhObjects, {}, ezVisibilityState::Direct);
+        CheckVisibleObjects(frustum, gridObjects, bvhObjects);
+
+        gridObjects.Clear();
+        bvhObjects.Clear();
+
+        m_Grid.FindVisibleObjects(frustum, queryParams, gridObjects, IsOccluded, ezVisibilityState::Indirect);
+        m_Bvh.FindVisibleObjects(frustum, queryParams, bvhObjects, IsOccluded, ezVisibilityState::Indirect);
+        CheckVisibleObjects(frustum, gridObjects, bvhObjects);
+
+        for (const ezGameObject* pObject : bvhObjects)
+        {
+          const Object& object = m_Objects[GetObjectIndex(pObject)];
+          EZ_TEST_BOOL(object.m_bAlwaysVisible || !IsOccluded(object.m_Bounds.GetBox()));
+        }
+      }
+    }
+
+    void CompareVisibilityStates()
+    {
+      for (auto& object : m_Objects)
+      {
+        if (!object.m_hGridData.IsInvalidated())
+        {
+          if (m_Grid.GetVisibilityState(object.m_hGridData, 0) != ezVisibilityState::Invisible)
+          {
+            EZ_TEST_BOOL(m_Bvh.GetVisibilityState(object.m_hBvhData, 0) != ezVisibilityState::Invisible);
+          }
+        }
+      }
+    }
+  };
 } // namespace
 
 EZ_CREATE_SIMPLE_TEST(World, SpatialSystem)
@@ -279,6 +484,52 @@ EZ_CREATE_SIMPLE_TEST(World, SpatialSystem)
     }
   }
 
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "FindVisibleObjects with occlusion")
+  {
+    queryParams.m_uiCategoryBitmask = ezDefaultSpatialDataCategories::RenderDynamic.GetBitmask();
+
+    ezMat4 lookAt = ezGraphicsUtils::CreateLookAtViewMatrix(ezVec3::MakeZero(), ezVec3::MakeAxisX(), ezVec3::MakeAxisZ());
+    ezMat4 projection = ezGraphicsUtils::CreatePerspectiveProjectionMatrixFromFovX(ezAngle::MakeFromDegree(80.0f), 1.0f, 1.0f, 10000.0f);
+
+    ezFrustum testFrustum = ezFrustum::MakeFromMVP(projection * lookAt);
+
+    // everything on the negative y side counts as occluded
+    auto IsOccluded = [](const ezSimdBBox& box) -> bool {
+      return box.GetCenter().y() < 0.0f;
+    };
+
+    ezUInt32 uiNumBatchCalls = 0;
+    auto AreOccluded = [&](ezArrayPtr<const ezSimdBBox> boxes, ezArrayPtr<bool> out_occluded) {
+      ++uiNumBatchCalls;
+      for (ezUInt32 i = 0; i < boxes.GetCount(); ++i)
+      {
+        out_occluded[i] = IsOccluded(boxes[i]);
+      }
+    };
+
+    ezDynamicArray<const ezGameObject*> visibleObjects;
+    world.GetSpatialSystem()->FindVisibleObjects(testFrustum, queryParams, visibleObjects, IsOccluded, ezVisibilityState::Direct);
+
+    ezDynamicArray<const ezGameObject*> visibleObjectsBatched;
+    world.GetSpatialSystem()->FindVisibleObjects(testFrustum, queryParams, visibleObjectsBatched, {}, ezVisibilityState::Direct, AreOccluded);
+
+    EZ_TEST_BOOL(!visibleObjects.IsEmpty());
+    EZ_TEST_BOOL(uiNumBatchCalls > 0);
+
+    ezHashSet<const ezGameObject*> uniqueObjects;
+    for (auto pObject : visibleObjects)
+    {
+      EZ_TEST_BOOL(pObject->GetGlobalBoundsSimd().GetBox().GetCenter().y() >= 0.0f);
+      uniqueObjects.Insert(pObject);
+    }
+
+    EZ_TEST_INT(visibleObjectsBatched.GetCount(), visibleObjects.GetCount());
+    for (auto pObject : visibleObjectsBatched)
+    {
+      EZ_TEST_BOOL(uniqueObjects.Contains(pObject));
+    }
+  }
+
   if (false)
   {
     ezStringBuilder outputPath = ezTestFramework::GetInstance()->GetAbsOutputPath();
@@ -317,3 +568,422 @@ EZ_CREATE_SIMPLE_TEST(World, SpatialSystem)
     world.Update();
   }
 }
+
+EZ_CREATE_SIMPLE_TEST(World, SpatialSystem_Bvh)
+{
+  constexpr double fRange = 2000.0;
+
+  ezRandom rng;
+  rng.Initialize(42);
+
+  const ezTag& testTag = ezTagRegistry::GetGlobalRegistry().RegisterTag("BvhTestTag");
+  ezTagSet taggedSet;
+  taggedSet.Set(testTag);
+
+  const ezUInt32 categories[] = {
+    ezDefaultSpatialDataCategories::RenderStatic.GetBitmask(),
+    ezDefaultSpatialDataCategories::RenderDynamic.GetBitmask(),
+    s_SpecialTestCategory.GetBitmask(),
+  };
+
+  ezUniquePtr<SpatialSystemComparison> pComparison = EZ_NEW(ezFoundation::GetAlignedAllocator(), SpatialSystemComparison);
+  SpatialSystemComparison& comparison = *pComparison;
+
+  auto CompareAllQueries = [&]() {
+    for (ezUInt32 uiCategoryBitmask : categories)
+    {
+      ezSpatialSystem::QueryParams queryParams;
+      queryParams.m_uiCategoryBitmask = uiCategoryBitmask;
+      comparison.CompareShapeQueries(rng, fRange, queryParams);
+      comparison.CompareVisibleObjects(rng, fRange, queryParams);
+
+      queryParams.m_pIncludeTags = &taggedSet;
+      comparison.CompareShapeQueries(rng, fRange, queryParams);
+      comparison.CompareVisibleObjects(rng, fRange, queryParams);
+
+      queryParams.m_pIncludeTags = nullptr;
+      queryParams.m_pExcludeTags = &taggedSet;
+      comparison.CompareShapeQueries(rng, fRange, queryParams);
+      comparison.CompareVisibleObjects(rng, fRange, queryParams);
+    }
+  };
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Insert")
+  {
+    for (ezUInt32 i = 0; i < 3000; ++i)
+    {
+      ezUInt32 uiCategoryBitmask = categories[rng.UIntInRange(EZ_ARRAY_SIZE(categories))];
+      if (rng.UIntInRange(10) == 0)
+      {
+        uiCategoryBitmask |= s_SpecialTestCategory.GetBitmask();
+      }
+
+      const ezTagSet tags = rng.UIntInRange(2) == 0 ? taggedSet : ezTagSet();
+      comparison.Create(GetRandomBounds(rng, fRange), uiCategoryBitmask, tags, i % 500 == 0);
+    }
+
+    CompareAllQueries();
+
+    // the hierarchy is rebuilt after many insertions, queries have to return the same results afterwards
+    comparison.StartNewFrame();
+    CompareAllQueries();
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Update")
+  {
+    for (ezUInt32 uiFrame = 0; uiFrame < 5; ++uiFrame)
+    {
+      for (ezUInt32 i = 0; i < comparison.m_Objects.GetCount(); i += 2)
+      {
+        // small movements stay within the node bounds, large ones have to refit the hierarchy
+        const float fMoveRange = (i % 4 == 0) ? 1.0f : 500.0f;
+
+        ezSimdBBoxSphere bounds = comparison.m_Objects[i].m_Bounds;
+        bounds.m_CenterAndRadius += ezSimdVec4f(rng.FloatMinMax(-fMoveRange, fMoveRange), rng.FloatMinMax(-fMoveRange, fMoveRange), rng.FloatMinMax(-fMoveRange, fMoveRange), 0.0f);
+        comparison.Update(i, bounds);
+      }
+
+      comparison.StartNewFrame();
+      CompareAllQueries();
+      comparison.CompareVisibilityStates();
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Multiple categories")
+  {
+    ezSpatialSystem::QueryParams queryParams;
+    queryParams.m_uiCategoryBitmask = categories[0] | categories[1] | categories[2];
+
+    ezDynamicArray<ezGameObject*> objects;
+    comparison.m_Bvh.FindObjectsInSphere(ezBoundingSphere::MakeFromCenterAndRadius(ezVec3::MakeZero(), (float)fRange), queryParams, objects);
+    EZ_TEST_BOOL(!objects.IsEmpty());
+
+    // every object is only returned once, even if it is part of several of the queried categories
+    ezHashSet<ezGameObject*> uniqueObjects;
+    for (ezGameObject* pObject : objects)
+    {
+      EZ_TEST_BOOL(!uniqueObjects.Insert(pObject));
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Delete")
+  {
+    for (ezUInt32 i = 0; i < comparison.m_Objects.GetCount(); i += 3)
+    {
+      comparison.Delete(i);
+    }
+
+    CompareAllQueries();
+
+    comparison.StartNewFrame();
+    CompareAllQueries();
+
+    for (ezUInt32 i = 0; i < comparison.m_Objects.GetCount(); ++i)
+    {
+      comparison.Delete(i);
+    }
+
+    CompareAllQueries();
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "ezWorldDesc")
+  {
+    ezWorldDesc worldDesc("Test");
+    worldDesc.m_SpatialSystemType = ezSpatialSystemType::Bvh;
+
+    ezWorld world(worldDesc);
+    EZ_LOCK(world.GetWriteMarker());
+
+    EZ_TEST_BOOL(ezDynamicCast<const ezSpatialSystem_Bvh*>(world.GetSpatialSystem()) != nullptr);
+  }
+}
+
+EZ_CREATE_SIMPLE_TEST(World, SpatialSystem_MultithreadedCulling)
+{
+  constexpr double fRange = 2000.0;
+
+  ezRandom rng;
+  rng.Initialize(23);
+
+  const ezTag& testTag = ezTagRegistry::GetGlobalRegistry().RegisterTag("CullingTestTag");
+  ezTagSet taggedSet;
+  taggedSet.Set(testTag);
+
+  ezCVarBool* pMultithreaded = static_cast<ezCVarBool*>(ezCVar::FindCVarByName("Spatial.Culling.Multithreaded"));
+  if (!EZ_TEST_BOOL(pMultithreaded != nullptr))
+    return;
+
+  ezUniquePtr<ezSpatialSystem> pSystem = EZ_NEW(ezFoundation::GetAlignedAllocator(), ezSpatialSystem_RegularGrid);
+  ezSpatialSystem& system = *pSystem;
+
+  const ezUInt32 uiCategoryBitmask = ezDefaultSpatialDataCategories::RenderStatic.GetBitmask();
+
+  ezDynamicArray<ezSpatialDataHandle> handles;
+  for (ezUInt32 i = 0; i < 30000; ++i)
+  {
+    const ezTagSet tags = rng.UIntInRange(2) == 0 ? taggedSet : ezTagSet();
+    handles.PushBack(system.CreateSpatialData(GetRandomBounds(rng, fRange), reinterpret_cast<ezGameObject*>(static_cast<size_t>(i + 1) * 16), uiCategoryBitmask, tags));
+  }
+
+  system.StartNewFrame();
+
+  auto IsOccluded = [](const ezSimdBBox& box) -> bool {
+    return box.GetCenter().y() < 0.0f;
+  };
+
+  auto AreOccluded = [&](ezArrayPtr<const ezSimdBBox> boxes, ezArrayPtr<bool> out_occluded) {
+    for (ezUInt32 i = 0; i < boxes.GetCount(); ++i)
+    {
+      out_occluded[i] = IsOccluded(boxes[i]);
+    }
+  };
+
+  auto FindVisibleObjects = [&](bool bMultithreaded, const ezFrustum& frustum, const ezSpatialSystem::QueryParams& queryParams, ezUInt32 uiOcclusionMode, ezDynamicArray<const ezGameObject*>& out_objects) {
+    *pMultithreaded = bMultithreaded;
+
+    out_objects.Clear();
+    switch (uiOcclusionMode)
+    {
+      case 0:
+        system.FindVisibleObjects(frustum, queryParams, out_objects, {}, ezVisibilityState::Direct);
+        break;
+      case 1:
+        system.FindVisibleObjects(frustum, queryParams, out_objects, IsOccluded, ezVisibilityState::Direct);
+        break;
+      default:
+        system.FindVisibleObjects(frustum, queryParams, out_objects, {}, ezVisibilityState::Direct, AreOccluded);
+        break;
+    }
+  };
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Same results as single-threaded")
+  {
+    ezDynamicArray<const ezGameObject*> serialObjects;
+    ezDynamicArray<const ezGameObject*> parallelObjects;
+
+    for (ezUInt32 uiQuery = 0; uiQuery < 12; ++uiQuery)
+    {
+      ezSpatialSystem::QueryParams queryParams;
+      queryParams.m_uiCategoryBitmask = uiCategoryBitmask;
+      queryParams.m_pIncludeTags = (uiQuery % 4 == 3) ? &taggedSet : nullptr;
+
+      const ezFrustum frustum = GetRandomFrustum(rng, fRange);
+      const ezUInt32 uiOcclusionMode = uiQuery % 3;
+
+      FindVisibleObjects(false, frustum, queryParams, uiOcclusionMode, serialObjects);
+      FindVisibleObjects(true, frustum, queryParams, uiOcclusionMode, parallelObjects);
+
+      // the chunks are merged in order, so even the order of the objects has to be the same
+      if (EZ_TEST_INT(parallelObjects.GetCount(), serialObjects.GetCount()))
+      {
+        EZ_TEST_BOOL(parallelObjects == serialObjects);
+      }
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Visibility state")
+  {
+    system.StartNewFrame();
+
+    const ezFrustum frustum = GetRandomFrustum(rng, fRange);
+
+    ezSpatialSystem::QueryParams queryParams;
+    queryParams.m_uiCategoryBitmask = uiCategoryBitmask;
+
+    ezDynamicArray<const ezGameObject*> visibleObjects;
+    FindVisibleObjects(true, frustum, queryParams, 0, visibleObjects);
+    EZ_TEST_BOOL(!visibleObjects.IsEmpty());
+
+    for (const ezGameObject* pObject : visibleObjects)
+    {
+      const ezUInt32 uiIndex = static_cast<ezUInt32>(reinterpret_cast<size_t>(pObject) / 16 - 1);
+      EZ_TEST_BOOL(system.GetVisibilityState(handles[uiIndex], 0) == ezVisibilityState::Direct);
+    }
+  }
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEVELOPMENT)
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Internal stats")
+  {
+    system.StartNewFrame();
+
+    ezStringBuilder sStats;
+    system.GetInternalStats(sStats);
+
+    // the previous frame issued exactly one query
+    EZ_TEST_BOOL(sStats.FindSubString("View 0 (Direct)") != nullptr);
+    EZ_TEST_BOOL(sStats.FindSubString("View 1") == nullptr);
+  }
+#endif
+
+  *pMultithreaded = true;
+}
+
+EZ_CREATE_SIMPLE_TEST(World, SpatialSystem_MultiViewCulling)
+{
+  constexpr double fRange = 1000.0;
+
+  ezRandom rng;
+  rng.Initialize(31);
+
+  const ezTag& testTag = ezTagRegistry::GetGlobalRegistry().RegisterTag("MultiViewTestTag");
+  ezTagSet taggedSet;
+  taggedSet.Set(testTag);
+
+  ezUniquePtr<ezSpatialSystem_RegularGrid> pGrid = EZ_NEW(ezFoundation::GetAlignedAllocator(), ezSpatialSystem_RegularGrid);
+  ezUniquePtr<ezSpatialSystem_Bvh> pBvh = EZ_NEW(ezFoundation::GetAlignedAllocator(), ezSpatialSystem_Bvh);
+
+  const ezUInt32 uiCategoryBitmask = ezDefaultSpatialDataCategories::RenderStatic.GetBitmask();
+
+  ezDynamicArray<ezSpatialDataHandle> gridHandles;
+  for (ezUInt32 i = 0; i < 10000; ++i)
+  {
+    const ezSimdBBoxSphere bounds = GetRandomBounds(rng, fRange);
+    const ezTagSet tags = rng.UIntInRange(2) == 0 ? taggedSet : ezTagSet();
+    ezGameObject* pObject = reinterpret_cast<ezGameObject*>(static_cast<size_t>(i + 1) * 16);
+
+    gridHandles.PushBack(static_cast<ezSpatialSystem&>(*pGrid).CreateSpatialData(bounds, pObject, uiCategoryBitmask, tags));
+    static_cast<ezSpatialSystem&>(*pBvh).CreateSpatialData(bounds, pObject, uiCategoryBitmask, tags);
+  }
+
+  auto CompareWithSingleView = [&](const ezSpatialSystem& system, ezArrayPtr<const ezFrustum> frustums, const ezSpatialSystem::QueryParams& queryParams) {
+    ezHybridArray<ezDynamicArray<const ezGameObject*>, 8> multiViewObjects;
+    ezHybridArray<ezDynamicArray<const ezGameObject*>*, 8> multiViewOutputs;
+    multiViewObjects.SetCount(frustums.GetCount());
+    for (auto& objects : multiViewObjects)
+    {
+      multiViewOutputs.PushBack(&objects);
+    }
+
+    system.FindVisibleObjectsMultiView(frustums, queryParams, multiViewOutputs, ezVisibilityState::Indirect);
+
+    for (ezUInt32 uiView = 0; uiView < frustums.GetCount(); ++uiView)
+    {
+      ezDynamicArray<const ezGameObject*> singleViewObjects;
+      system.FindVisibleObjects(frustums[uiView], queryParams, singleViewObjects, {}, ezVisibilityState::Indirect);
+
+      ezHashSet<const ezGameObject*> uniqueObjects;
+      for (const ezGameObject* pObject : multiViewObjects[uiView])
+      {
+        EZ_TEST_BOOL(!uniqueObjects.Insert(pObject));
+      }
+
+      // cells outside of the bounding box of a single frustum can still pass the plane test, so the result may contain a few more objects
+      for (const ezGameObject* pObject : singleViewObjects)
+      {
+        EZ_TEST_BOOL(uniqueObjects.Contains(pObject));
+      }
+
+      EZ_TEST_BOOL(multiViewObjects[uiView].GetCount() >= singleViewObjects.GetCount());
+    }
+  };
+
+  auto GetCascadeFrustums = [&](ezHybridArray<ezFrustum, 8>& out_frustums) {
+    out_frustums.Clear();
+
+    const ezVec3 vPos((float)rng.DoubleMinMax(-fRange, fRange), (float)rng.DoubleMinMax(-fRange, fRange), (float)rng.DoubleMinMax(-fRange, fRange));
+    const ezVec3 vDir = ezVec3::MakeRandomDirection(rng);
+
+    for (ezUInt32 i = 0; i < 4; ++i)
+    {
+      const float fExtents = 50.0f * (1 << i);
+      ezMat4 lookAt = ezGraphicsUtils::CreateLookAtViewMatrix(vPos - vDir * fExtents, vPos, ezMath::Abs(vDir.z) < 0.9f ? ezVec3::MakeAxisZ() : ezVec3::MakeAxisX());
+      ezMat4 projection = ezGraphicsUtils::CreateOrthographicProjectionMatrix(fExtents * 2.0f, fExtents * 2.0f, 0.0f, fExtents * 2.0f);
+      out_frustums.PushBack(ezFrustum::MakeFromMVP(projection * lookAt));
+    }
+  };
+
+  auto GetPointLightFrustums = [&](ezHybridArray<ezFrustum, 8>& out_frustums) {
+    out_frustums.Clear();
+
+    const ezVec3 vPos((float)rng.DoubleMinMax(-fRange, fRange), (float)rng.DoubleMinMax(-fRange, fRange), (float)rng.DoubleMinMax(-fRange, fRange));
+    const ezVec3 faceDirs[6] = {ezVec3(1, 0, 0), ezVec3(-1, 0, 0), ezVec3(0, 1, 0), ezVec3(0, -1, 0), ezVec3(0, 0, 1), ezVec3(0, 0, -1)};
+
+    for (const ezVec3& vDir : faceDirs)
+    {
+      ezMat4 lookAt = ezGraphicsUtils::CreateLookAtViewMatrix(vPos, vPos + vDir, ezMath::Abs(vDir.z) < 0.9f ? ezVec3::MakeAxisZ() : ezVec3::MakeAxisX());
+      ezMat4 projection = ezGraphicsUtils::CreatePerspectiveProjectionMatrixFromFovX(ezAngle::MakeFromDegree(90.0f), 1.0f, 0.1f, 300.0f);
+      out_frustums.PushBack(ezFrustum::MakeFromMVP(projection * lookAt));
+    }
+  };
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Shadow cascades")
+  {
+    ezHybridArray<ezFrustum, 8> frustums;
+    for (ezUInt32 i = 0; i < 5; ++i)
+    {
+      GetCascadeFrustums(frustums);
+
+      ezSpatialSystem::QueryParams queryParams;
+      queryParams.m_uiCategoryBitmask = uiCategoryBitmask;
+      CompareWithSingleView(*pGrid, frustums, queryParams);
+      CompareWithSingleView(*pBvh, frustums, queryParams);
+
+      queryParams.m_pExcludeTags = &taggedSet;
+      CompareWithSingleView(*pGrid, frustums, queryParams);
+      CompareWithSingleView(*pBvh, frustums, queryParams);
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Point light faces")
+  {
+    ezHybridArray<ezFrustum, 8> frustums;
+    for (ezUInt32 i = 0; i < 5; ++i)
+    {
+      GetPointLightFrustums(frustums);
+
+      ezSpatialSystem::QueryParams queryParams;
+      queryParams.m_uiCategoryBitmask = uiCategoryBitmask;
+      CompareWithSingleView(*pGrid, frustums, queryParams);
+
+      queryParams.m_pIncludeTags = &taggedSet;
+      CompareWithSingleView(*pGrid, frustums, queryParams);
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Unrelated views")
+  {
+    ezHybridArray<ezFrustum, 8> frustums;
+    for (ezUInt32 i = 0; i < 4; ++i)
+    {
+      frustums.PushBack(GetRandomFrustum(rng, fRange));
+    }
+
+    ezSpatialSystem::QueryParams queryParams;
+    queryParams.m_uiCategoryBitmask = uiCategoryBitmask;
+    CompareWithSingleView(*pGrid, frustums, queryParams);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Visibility state")
+  {
+    ezSpatialSystem& system = *pGrid;
+    system.StartNewFrame();
+
+    ezHybridArray<ezFrustum, 8> frustums;
+    GetPointLightFrustums(frustums);
+
+    ezHybridArray<ezDynamicArray<const ezGameObject*>, 8> visibleObjects;
+    ezHybridArray<ezDynamicArray<const ezGameObject*>*, 8> outputs;
+    visibleObjects.SetCount(frustums.GetCount());
+    for (auto& objects : visibleObjects)
+    {
+      outputs.PushBack(&objects);
+    }
+
+    ezSpatialSystem::QueryParams queryParams;
+    queryParams.m_uiCategoryBitmask = uiCategoryBitmask;
+    system.FindVisibleObjectsMultiView(frustums, queryParams, outputs, ezVisibilityState::Indirect);
+
+    ezUInt32 uiNumVisible = 0;
+    for (auto& objects : visibleObjects)
+    {
+      for (const ezGameObject* pObject : objects)
+      {
+        const ezUInt32 uiIndex = static_cast<ezUInt32>(reinterpret_cast<size_t>(pObject) / 16 - 1);
+        EZ_TEST_BOOL(system.GetVisibilityState(gridHandles[uiIndex], 0) == ezVisibilityState::Indirect);
+        ++uiNumVisible;
+      }
+    }
+
+    EZ_TEST_BOOL(uiNumVisible > 0);
+  }
+}
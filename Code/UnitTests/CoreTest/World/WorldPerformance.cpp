@@ -1,8 +1,14 @@
 #include <CoreTest/CoreTestPCH.h>
 
+#include <Core/World/SpatialSystem_Bvh.h>
+#include <Core/World/SpatialSystem_RegularGrid.h>
 #include <Core/World/World.h>
+#include <Foundation/Configuration/CVar.h>
+#include <Foundation/SimdMath/SimdConversion.h>
+#include <Foundation/Threading/Thread.h>
 #include <Foundation/Time/Clock.h>
 #include <Foundation/Time/Stopwatch.h>
+#include <Foundation/Utilities/GraphicsUtils.h>
 
 namespace
 {
@@ -114,6 +120,244 @@ namespace
     }
   }
 
+
+  void MeasureSpatialSystem(ezSpatialSystem& ref_system, const char* szName, ezUInt32 uiNumObjects, ezUInt32 uiMovingPercentage)
+  {
+    constexpr float fRange = 4000.0f;
+    constexpr ezUInt32 uiNumFrames = 60;
+
+    ezRandom rng;
+    rng.Initialize(17);
+
+    auto GetRandomPosition = [&](float fPosRange) { return ezSimdVec4f(rng.FloatMinMax(-fPosRange, fPosRange), rng.FloatMinMax(-fPosRange, fPosRange), rng.FloatMinMax(-fPosRange, fPosRange), 0.0f); };
+
+    const ezUInt32 uiStaticCategory = ezDefaultSpatialDataCategories::RenderStatic.GetBitmask();
+    const ezUInt32 uiDynamicCategory = ezDefaultSpatialDataCategories::RenderDynamic.GetBitmask();
+
+    ezDynamicArray<ezSimdBBoxSphere, ezAlignedAllocatorWrapper> bounds;
+    ezDynamicArray<ezSpatialDataHandle> handles;
+    bounds.SetCount(uiNumObjects);
+    handles.SetCount(uiNumObjects);
+
+    for (ezUInt32 i = 0; i < uiNumObjects; ++i)
+    {
+      // mix of small props and a few huge objects
+      const float fHalfExtents = (float)ezMath::Pow(2.0, rng.DoubleMinMax(-1.0, 7.0));
+      bounds[i] = ezSimdBBoxSphere::MakeFromCenterExtents(GetRandomPosition(fRange), ezSimdVec4f(fHalfExtents), fHalfExtents * ezMath::Sqrt(3.0f));
+    }
+
+    const ezUInt32 uiNumMoving = uiNumObjects * uiMovingPercentage / 100;
+
+    ezStopwatch sw;
+
+    for (ezUInt32 i = 0; i < uiNumObjects; ++i)
+    {
+      ezGameObject* pObject = reinterpret_cast<ezGameObject*>(static_cast<size_t>(i + 1) * 16);
+      handles[i] = ref_system.CreateSpatialData(bounds[i], pObject, i < uiNumMoving ? uiDynamicCategory : uiStaticCategory, ezTagSet());
+    }
+    ref_system.StartNewFrame();
+
+    const ezTime tInsert = sw.Checkpoint();
+
+    ezTime tUpdate;
+    ezTime tQuery;
+    ezUInt32 uiNumFound = 0;
+
+    ezDynamicArray<ezGameObject*> objects;
+    ezDynamicArray<const ezGameObject*> visibleObjects;
+
+    for (ezUInt32 uiFrame = 0; uiFrame < uiNumFrames; ++uiFrame)
+    {
+      sw.Checkpoint();
+
+      for (ezUInt32 i = 0; i < uiNumMoving; ++i)
+      {
+        bounds[i].m_CenterAndRadius += GetRandomPosition(2.0f);
+        ref_system.UpdateSpatialDataBounds(handles[i], bounds[i]);
+      }
+      ref_system.StartNewFrame();
+
+      tUpdate += sw.Checkpoint();
+
+      ezSpatialSystem::QueryParams queryParams;
+      queryParams.m_uiCategoryBitmask = uiStaticCategory | uiDynamicCategory;
+
+      for (ezUInt32 i = 0; i < 16; ++i)
+      {
+        const ezVec3 vCenter = ezSimdConversion::ToVec3(GetRandomPosition(fRange));
+        const float fSize = rng.FloatMinMax(10.0f, 300.0f);
+
+        objects.Clear();
+        ref_system.FindObjectsInSphere(ezBoundingSphere::MakeFromCenterAndRadius(vCenter, fSize), queryParams, objects);
+        uiNumFound += objects.GetCount();
+
+        objects.Clear();
+        ref_system.FindObjectsInBox(ezBoundingBox::MakeFromCenterAndHalfExtents(vCenter, ezVec3(fSize)), queryParams, objects);
+        uiNumFound += objects.GetCount();
+      }
+
+      for (ezUInt32 i = 0; i < 2; ++i)
+      {
+        const ezVec3 vPos = ezSimdConversion::ToVec3(GetRandomPosition(fRange));
+        ezMat4 lookAt = ezGraphicsUtils::CreateLookAtViewMatrix(vPos, vPos + ezVec3::MakeAxisX(), ezVec3::MakeAxisZ());
+        ezMat4 projection = ezGraphicsUtils::CreatePerspectiveProjectionMatrixFromFovX(ezAngle::MakeFromDegree(80.0f), 1.0f, 1.0f, 2000.0f);
+
+        visibleObjects.Clear();
+        ref_system.FindVisibleObjects(ezFrustum::MakeFromMVP(projection * lookAt), queryParams, visibleObjects, {}, ezVisibilityState::Direct);
+        uiNumFound += visibleObjects.GetCount();
+      }
+
+      tQuery += sw.Checkpoint();
+    }
+
+    for (ezUInt32 i = 0; i < uiNumObjects; ++i)
+    {
+      ref_system.DeleteSpatialData(handles[i]);
+    }
+
+    ezTestFramework::Output(ezTestOutput::Duration, "%s, %u objects, %u%% moving: insert %.2fms, update %.2fms, query %.2fms (%u objects found)", szName, uiNumObjects,
+      uiMovingPercentage, tInsert.GetMilliseconds(), tUpdate.GetMilliseconds() / uiNumFrames, tQuery.GetMilliseconds() / uiNumFrames, uiNumFound);
+  }
+
+  struct ezMsgProfilePost : public ezMessage
+  {
+    EZ_DECLARE_MESSAGE_TYPE(ezMsgProfilePost, ezMessage);
+
+    ezUInt32 m_uiValue = 0;
+  };
+
+  // clang-format off
+  EZ_IMPLEMENT_MESSAGE_TYPE(ezMsgProfilePost);
+  EZ_BEGIN_DYNAMIC_REFLECTED_TYPE(ezMsgProfilePost, 1, ezRTTIDefaultAllocator<ezMsgProfilePost>)
+  EZ_END_DYNAMIC_REFLECTED_TYPE;
+  // clang-format on
+
+  class ProfilePostMessageThread : public ezThread
+  {
+  public:
+    ProfilePostMessageThread(const ezWorld& world, ezArrayPtr<const ezGameObjectHandle> receivers, ezUInt32 uiFirstMessage, ezUInt32 uiNumMessages, const ezAtomicBool& bStart)
+      : ezThread("ProfilePostMessageThread")
+      , m_World(world)
+      , m_Receivers(receivers)
+      , m_uiFirstMessage(uiFirstMessage)
+      , m_uiNumMessages(uiNumMessages)
+      , m_bStart(bStart)
+    {
+    }
+
+    virtual ezUInt32 Run() override
+    {
+      while (!m_bStart)
+      {
+        ezThreadUtils::YieldTimeSlice();
+      }
+
+      ezMsgProfilePost msg;
+      for (ezUInt32 i = m_uiFirstMessage; i < m_uiFirstMessage + m_uiNumMessages; ++i)
+      {
+        msg.m_uiValue = i;
+        m_World.PostMessage(m_Receivers[i % m_Receivers.GetCount()], msg, ezTime::MakeZero(), ezObjectMsgQueueType::NextFrame);
+      }
+
+      return 0;
+    }
+
+    const ezWorld& m_World;
+    ezArrayPtr<const ezGameObjectHandle> m_Receivers;
+    ezUInt32 m_uiFirstMessage;
+    ezUInt32 m_uiNumMessages;
+    const ezAtomicBool& m_bStart;
+  };
+
+  struct ezMsgProfileDamage : public ezMessage
+  {
+    EZ_DECLARE_MESSAGE_TYPE(ezMsgProfileDamage, ezMessage);
+
+    float m_fDamage = 0.0f;
+  };
+
+  struct ezMsgProfileTrigger : public ezMessage
+  {
+    EZ_DECLARE_MESSAGE_TYPE(ezMsgProfileTrigger, ezMessage);
+
+    ezUInt32 m_uiTriggerId = 0;
+  };
+
+  // clang-format off
+  EZ_IMPLEMENT_MESSAGE_TYPE(ezMsgProfileDamage);
+  EZ_BEGIN_DYNAMIC_REFLECTED_TYPE(ezMsgProfileDamage, 1, ezRTTIDefaultAllocator<ezMsgProfileDamage>)
+  EZ_END_DYNAMIC_REFLECTED_TYPE;
+
+  EZ_IMPLEMENT_MESSAGE_TYPE(ezMsgProfileTrigger);
+  EZ_BEGIN_DYNAMIC_REFLECTED_TYPE(ezMsgProfileTrigger, 1, ezRTTIDefaultAllocator<ezMsgProfileTrigger>)
+  EZ_END_DYNAMIC_REFLECTED_TYPE;
+  // clang-format on
+
+  class ezProfileHealthComponent;
+
+  class ezProfileHealthComponentManager : public ezComponentManager<ezProfileHealthComponent, ezBlockStorageType::Compact>
+  {
+  public:
+    ezProfileHealthComponentManager(ezWorld* pWorld)
+      : ezComponentManager<ezProfileHealthComponent, ezBlockStorageType::Compact>(pWorld)
+    {
+    }
+
+    virtual bool HandleMessageBatch(ezMessageId msgId, ezArrayPtr<const MessageBatchEntry> batch) override;
+
+    bool m_bUseBatchHandler = false;
+  };
+
+  class ezProfileHealthComponent : public ezComponent
+  {
+    EZ_DECLARE_COMPONENT_TYPE(ezProfileHealthComponent, ezComponent, ezProfileHealthComponentManager);
+
+  public:
+    void OnMsgDamage(ezMsgProfileDamage& ref_msg) { m_fHealth -= ref_msg.m_fDamage; }
+    void OnMsgTrigger(ezMsgProfileTrigger& ref_msg) { m_uiLastTriggerId = ref_msg.m_uiTriggerId; }
+
+    float m_fHealth = 100.0f;
+    ezUInt32 m_uiLastTriggerId = 0;
+  };
+
+  // clang-format off
+  EZ_BEGIN_COMPONENT_TYPE(ezProfileHealthComponent, 1, ezComponentMode::Static)
+  {
+    EZ_BEGIN_MESSAGEHANDLERS
+    {
+      EZ_MESSAGE_HANDLER(ezMsgProfileDamage, OnMsgDamage),
+      EZ_MESSAGE_HANDLER(ezMsgProfileTrigger, OnMsgTrigger),
+    }
+    EZ_END_MESSAGEHANDLERS;
+  }
+  EZ_END_COMPONENT_TYPE;
+  // clang-format on
+
+  bool ezProfileHealthComponentManager::HandleMessageBatch(ezMessageId msgId, ezArrayPtr<const MessageBatchEntry> batch)
+  {
+    if (!m_bUseBatchHandler)
+      return false;
+
+    if (msgId == ezMsgProfileDamage::GetTypeMsgId())
+    {
+      for (const MessageBatchEntry& entry : batch)
+      {
+        static_cast<ezProfileHealthComponent*>(entry.m_pComponent)->m_fHealth -= static_cast<const ezMsgProfileDamage*>(entry.m_pMessage)->m_fDamage;
+      }
+      return true;
+    }
+
+    if (msgId == ezMsgProfileTrigger::GetTypeMsgId())
+    {
+      for (const MessageBatchEntry& entry : batch)
+      {
+        static_cast<ezProfileHealthComponent*>(entry.m_pComponent)->m_uiLastTriggerId = static_cast<const ezMsgProfileTrigger*>(entry.m_pMessage)->m_uiTriggerId;
+      }
+      return true;
+    }
+
+    return false;
+  }
 } // namespace
 
 
@@ -287,4 +531,300 @@ EZ_CREATE_SIMPLE_TEST(World, Profile_Update)
       ezTestFramework::Output(ezTestOutput::Duration, "Updating %u objects (MT): %.2fms", world.GetObjectCount(), tDiff.GetMilliseconds());
     }
   }
+
+  EZ_TEST_BLOCK(EnableInRelease, "Update 1,000,000 dynamic objects across 8 hierarchy levels")
+  {
+    ezCVarBool* pBatched = static_cast<ezCVarBool*>(ezCVar::FindCVarByName("World.BatchedTransformUpdate"));
+    if (!EZ_TEST_BOOL(pBatched != nullptr))
+      return;
+
+    const bool bOldValue = *pBatched;
+
+    for (ezUInt32 uiSpatialSystem = 0; uiSpatialSystem < 2; ++uiSpatialSystem)
+    {
+      ezWorldDesc worldDesc("Test");
+      worldDesc.m_bAutoCreateSpatialSystem = uiSpatialSystem != 0;
+      ezWorld world(worldDesc);
+
+      // 125,000 chains of 8 objects each
+      MeasureCreationTime(true, 125000, 125000, 8, 0, &world);
+
+      for (ezUInt32 uiBatched = 0; uiBatched < 2; ++uiBatched)
+      {
+        *pBatched = uiBatched != 0;
+
+        ezStopwatch sw;
+
+        // first round always has some overhead
+        for (ezUInt32 i = 0; i < 3; ++i)
+        {
+          EZ_LOCK(world.GetWriteMarker());
+          world.Update();
+
+          const ezTime tDiff = sw.Checkpoint();
+
+          ezTestFramework::Output(ezTestOutput::Duration, "Updating %u objects (%s, %s): %.2fms", world.GetObjectCount(), uiSpatialSystem != 0 ? "spatial system" : "MT",
+            uiBatched != 0 ? "batched" : "single", tDiff.GetMilliseconds());
+        }
+      }
+    }
+
+    *pBatched = bOldValue;
+  }
+}
+
+EZ_CREATE_SIMPLE_TEST(World, Profile_SpatialSystem)
+{
+  EZ_TEST_BLOCK(EnableInRelease, "Regular grid vs. BVH")
+  {
+    for (ezUInt32 uiMovingPercentage : {5, 50})
+    {
+      {
+        ezSpatialSystem_RegularGrid grid;
+        MeasureSpatialSystem(grid, "Regular grid", 50000, uiMovingPercentage);
+      }
+
+      {
+        ezSpatialSystem_Bvh bvh;
+        MeasureSpatialSystem(bvh, "BVH", 50000, uiMovingPercentage);
+      }
+    }
+  }
+  EZ_TEST_BLOCK(EnableInRelease, "Culling many views")
+  {
+    ezCVarBool* pMultithreaded = static_cast<ezCVarBool*>(ezCVar::FindCVarByName("Spatial.Culling.Multithreaded"));
+    EZ_TEST_BOOL(pMultithreaded != nullptr);
+
+    ezRandom rng;
+    rng.Initialize(7);
+
+    constexpr float fRange = 1000.0f;
+    constexpr ezUInt32 uiNumObjects = 50000;
+
+    ezSpatialSystem_RegularGrid grid;
+    ezSpatialSystem& system = grid;
+    const ezUInt32 uiCategory = ezDefaultSpatialDataCategories::RenderStatic.GetBitmask();
+
+    for (ezUInt32 i = 0; i < uiNumObjects; ++i)
+    {
+      const ezSimdVec4f vCenter((float)rng.DoubleMinMax(-fRange, fRange), (float)rng.DoubleMinMax(-fRange, fRange), (float)rng.DoubleMinMax(-fRange, fRange));
+      const float fHalfExtents = (float)ezMath::Pow(2.0, rng.DoubleMinMax(-1.0, 5.0));
+
+      ezGameObject* pObject = reinterpret_cast<ezGameObject*>(static_cast<size_t>(i + 1) * 16);
+      system.CreateSpatialData(ezSimdBBoxSphere::MakeFromCenterExtents(vCenter, ezSimdVec4f(fHalfExtents), fHalfExtents * ezMath::Sqrt(3.0f)), pObject, uiCategory, ezTagSet());
+    }
+
+    // a main view and six shadow cascades looking in different directions
+    ezHybridArray<ezFrustum, 8> frustums;
+    for (ezUInt32 i = 0; i < 7; ++i)
+    {
+      const ezVec3 vDir = ezVec3::MakeRandomDirection(rng);
+      ezMat4 lookAt = ezGraphicsUtils::CreateLookAtViewMatrix(ezVec3::MakeZero(), vDir, ezMath::Abs(vDir.z) < 0.9f ? ezVec3::MakeAxisZ() : ezVec3::MakeAxisX());
+      ezMat4 projection = ezGraphicsUtils::CreatePerspectiveProjectionMatrixFromFovX(ezAngle::MakeFromDegree(90.0f), 1.0f, 1.0f, 1000.0f);
+      frustums.PushBack(ezFrustum::MakeFromMVP(projection * lookAt));
+    }
+
+    ezSpatialSystem::QueryParams queryParams;
+    queryParams.m_uiCategoryBitmask = uiCategory;
+
+    ezDynamicArray<const ezGameObject*> visibleObjects;
+
+    for (bool bMultithreaded : {false, true})
+    {
+      *pMultithreaded = bMultithreaded;
+
+      constexpr ezUInt32 uiNumFrames = 20;
+      ezUInt32 uiNumFound = 0;
+
+      ezStopwatch sw;
+      for (ezUInt32 uiFrame = 0; uiFrame < uiNumFrames; ++uiFrame)
+      {
+        system.StartNewFrame();
+
+        for (const ezFrustum& frustum : frustums)
+        {
+          visibleObjects.Clear();
+          system.FindVisibleObjects(frustum, queryParams, visibleObjects, {}, ezVisibilityState::Direct);
+          uiNumFound += visibleObjects.GetCount();
+        }
+      }
+
+      ezTestFramework::Output(ezTestOutput::Duration, "Culling %u objects in %u views (%s): %.2fms per frame (%u objects found)", uiNumObjects, frustums.GetCount(),
+        bMultithreaded ? "multi-threaded" : "single-threaded", sw.GetRunningTotal().GetMilliseconds() / uiNumFrames, uiNumFound / uiNumFrames);
+    }
+
+    *pMultithreaded = true;
+
+    {
+      ezHybridArray<ezDynamicArray<const ezGameObject*>, 8> multiViewObjects;
+      ezHybridArray<ezDynamicArray<const ezGameObject*>*, 8> multiViewOutputs;
+      multiViewObjects.SetCount(frustums.GetCount());
+      for (auto& objects : multiViewObjects)
+      {
+        multiViewOutputs.PushBack(&objects);
+      }
+
+      constexpr ezUInt32 uiNumFrames = 20;
+      ezUInt32 uiNumFound = 0;
+
+      ezStopwatch sw;
+      for (ezUInt32 uiFrame = 0; uiFrame < uiNumFrames; ++uiFrame)
+      {
+        system.StartNewFrame();
+
+        for (auto& objects : multiViewObjects)
+        {
+          objects.Clear();
+        }
+
+        system.FindVisibleObjectsMultiView(frustums, queryParams, multiViewOutputs, ezVisibilityState::Direct);
+
+        for (auto& objects : multiViewObjects)
+        {
+          uiNumFound += objects.GetCount();
+        }
+      }
+
+      ezTestFramework::Output(ezTestOutput::Duration, "Culling %u objects in %u views (one pass): %.2fms per frame (%u objects found)", uiNumObjects, frustums.GetCount(),
+        sw.GetRunningTotal().GetMilliseconds() / uiNumFrames, uiNumFound / uiNumFrames);
+    }
+  }
+}
+
+EZ_CREATE_SIMPLE_TEST(World, Profile_Messaging)
+{
+  EZ_TEST_BLOCK(EnableInRelease, "Post messages from many threads")
+  {
+    ezCVarBool* pThreadMessageBuffers = static_cast<ezCVarBool*>(ezCVar::FindCVarByName("World.ThreadMessageBuffers"));
+    EZ_TEST_BOOL(pThreadMessageBuffers != nullptr);
+
+    ezWorldDesc worldDesc("Test");
+    ezWorld world(worldDesc);
+
+    ezDynamicArray<ezGameObjectHandle> receivers;
+    {
+      EZ_LOCK(world.GetWriteMarker());
+
+      ezGameObjectDesc gd;
+      for (ezUInt32 i = 0; i < 1000; ++i)
+      {
+        receivers.PushBack(world.CreateObject(gd));
+      }
+
+      world.Update();
+    }
+
+    constexpr ezUInt32 uiNumMessages = 256 * 1024;
+
+    for (bool bThreadMessageBuffers : {false, true})
+    {
+      *pThreadMessageBuffers = bThreadMessageBuffers;
+
+      for (ezUInt32 uiNumThreads : {1, 2, 4, 8, 16, 32})
+      {
+        ezAtomicBool bStart;
+
+        const ezUInt32 uiNumMessagesPerThread = uiNumMessages / uiNumThreads;
+
+        ezHybridArray<ezUniquePtr<ProfilePostMessageThread>, 32> threads;
+        for (ezUInt32 i = 0; i < uiNumThreads; ++i)
+        {
+          threads.PushBack(EZ_DEFAULT_NEW(ProfilePostMessageThread, world, receivers, i * uiNumMessagesPerThread, uiNumMessagesPerThread, bStart));
+          threads.PeekBack()->Start();
+        }
+
+        ezStopwatch sw;
+        bStart = true;
+
+        for (auto& pThread : threads)
+        {
+          pThread->Join();
+        }
+
+        const ezTime tPost = sw.Checkpoint();
+
+        {
+          EZ_LOCK(world.GetWriteMarker());
+          world.Update();
+        }
+
+        const ezTime tProcess = sw.Checkpoint();
+
+        ezTestFramework::Output(ezTestOutput::Duration, "Posting %u messages from %2u threads (%s): post %.2fms, process %.2fms", uiNumMessages, uiNumThreads,
+          bThreadMessageBuffers ? "thread buffers" : "shared queue", tPost.GetMilliseconds(), tProcess.GetMilliseconds());
+      }
+    }
+
+    *pThreadMessageBuffers = true;
+  }
+
+  EZ_TEST_BLOCK(EnableInRelease, "Dispatch queued damage and trigger messages")
+  {
+    ezCVarBool* pBatchedDispatch = static_cast<ezCVarBool*>(ezCVar::FindCVarByName("World.BatchedMessageDispatch"));
+    EZ_TEST_BOOL(pBatchedDispatch != nullptr);
+
+    ezWorldDesc worldDesc("Test");
+    ezWorld world(worldDesc);
+    EZ_LOCK(world.GetWriteMarker());
+
+    ezProfileHealthComponentManager* pManager = world.GetOrCreateComponentManager<ezProfileHealthComponentManager>();
+
+    constexpr ezUInt32 uiNumObjects = 10000;
+    constexpr ezUInt32 uiNumMessages = 100000;
+
+    ezDynamicArray<ezComponentHandle> receivers;
+    for (ezUInt32 i = 0; i < uiNumObjects; ++i)
+    {
+      ezGameObjectDesc gd;
+      ezGameObject* pObject = nullptr;
+      world.CreateObject(gd, pObject);
+
+      ezProfileHealthComponent* pComponent = nullptr;
+      receivers.PushBack(pManager->CreateComponent(pObject, pComponent));
+    }
+
+    world.Update();
+
+    ezRandom rng;
+    rng.Initialize(42);
+
+    for (ezUInt32 uiMode = 0; uiMode < 3; ++uiMode)
+    {
+      *pBatchedDispatch = uiMode > 0;
+      pManager->m_bUseBatchHandler = uiMode > 1;
+
+      constexpr ezUInt32 uiNumFrames = 10;
+
+      ezTime tProcess;
+      for (ezUInt32 uiFrame = 0; uiFrame < uiNumFrames; ++uiFrame)
+      {
+        for (ezUInt32 i = 0; i < uiNumMessages; ++i)
+        {
+          const ezComponentHandle& hReceiver = receivers[rng.UIntInRange(uiNumObjects)];
+          if (i % 2 == 0)
+          {
+            ezMsgProfileDamage msg;
+            msg.m_fDamage = (float)rng.DoubleMinMax(0.0, 10.0);
+            world.PostMessage(hReceiver, msg, ezTime::MakeZero(), ezObjectMsgQueueType::NextFrame);
+          }
+          else
+          {
+            ezMsgProfileTrigger msg;
+            msg.m_uiTriggerId = i;
+            world.PostMessage(hReceiver, msg, ezTime::MakeZero(), ezObjectMsgQueueType::NextFrame);
+          }
+        }
+
+        ezStopwatch sw;
+        world.Update();
+        tProcess += sw.GetRunningTotal();
+      }
+
+      const char* szMode[] = {"one by one", "batched", "batched, batch handler"};
+      ezTestFramework::Output(ezTestOutput::Duration, "Dispatching %u queued damage and trigger messages (%s): %.2fms", uiNumMessages, szMode[uiMode],
+        tProcess.GetMilliseconds() / uiNumFrames);
+    }
+
+    *pBatchedDispatch = true;
+  }
 }
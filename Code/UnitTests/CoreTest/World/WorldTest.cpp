@@ -1,6 +1,9 @@
 #include <CoreTest/CoreTestPCH.h>
 
 #include <Core/World/World.h>
+#include <Foundation/Configuration/CVar.h>
+#include <Foundation/Math/Random.h>
+#include <Foundation/SimdMath/SimdConversion.h>
 #include <Foundation/Time/Clock.h>
 #include <Foundation/Utilities/GraphicsUtils.h>
 
@@ -216,6 +219,11 @@ public:
     EZ_TEST_BOOL(pObject->m_pTransformationData->m_pParentData == (pParent != nullptr ? pParent->m_pTransformationData : nullptr));
     EZ_TEST_BOOL(pObject->GetParent() == pParent);
   }
+
+  static void SetLocalBounds(ezGameObject* pObject, const ezSimdBBoxSphere& bounds)
+  {
+    pObject->m_pTransformationData->m_localBounds = bounds;
+  }
 };
 
 EZ_CREATE_SIMPLE_TEST(World, World)
@@ -710,6 +718,89 @@ EZ_CREATE_SIMPLE_TEST(World, World)
     }
   }
 
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Batched transform update")
+  {
+    ezCVarBool* pBatched = static_cast<ezCVarBool*>(ezCVar::FindCVarByName("World.BatchedTransformUpdate"));
+    if (!EZ_TEST_BOOL(pBatched != nullptr))
+      return;
+
+    const bool bOldValue = *pBatched;
+
+    for (ezUInt32 uiSpatialSystem = 0; uiSpatialSystem < 2; ++uiSpatialSystem)
+    {
+      ezWorldDesc worldDesc("Test");
+      worldDesc.m_bAutoCreateSpatialSystem = uiSpatialSystem != 0;
+      ezWorld world(worldDesc);
+      EZ_LOCK(world.GetWriteMarker());
+
+      ezRandom rng;
+      rng.Initialize(42);
+
+      // 4 hierarchy levels with a count that is not a multiple of four, so the remainder path is covered as well
+      ezDynamicArray<ezGameObject*> objects;
+      for (ezUInt32 uiLevel = 0; uiLevel < 4; ++uiLevel)
+      {
+        const ezUInt32 uiFirstParent = objects.GetCount() - (uiLevel > 0 ? 13 : 0);
+
+        for (ezUInt32 i = 0; i < 13; ++i)
+        {
+          ezGameObjectDesc desc;
+          desc.m_bDynamic = true;
+          desc.m_hParent = uiLevel > 0 ? objects[uiFirstParent + i]->GetHandle() : ezGameObjectHandle();
+          desc.m_LocalPosition = ezVec3(rng.FloatMinMax(-10.0f, 10.0f), rng.FloatMinMax(-10.0f, 10.0f), rng.FloatMinMax(-10.0f, 10.0f));
+          desc.m_LocalRotation = ezQuat::MakeFromAxisAndAngle(ezVec3(rng.FloatMinMax(-1.0f, 1.0f), rng.FloatMinMax(-1.0f, 1.0f), 1.0f).GetNormalized(), ezAngle::MakeFromDegree(rng.FloatMinMax(0.0f, 360.0f)));
+          desc.m_LocalScaling = ezVec3(rng.FloatMinMax(0.5f, 2.0f), rng.FloatMinMax(0.5f, 2.0f), rng.FloatMinMax(0.5f, 2.0f));
+          desc.m_LocalUniformScaling = rng.FloatMinMax(0.5f, 2.0f);
+
+          ezGameObject* pObject = nullptr;
+          world.CreateObject(desc, pObject);
+          objects.PushBack(pObject);
+
+          if (i % 5 != 0)
+          {
+            const ezVec3 vCenter(rng.FloatMinMax(-5.0f, 5.0f), rng.FloatMinMax(-5.0f, 5.0f), rng.FloatMinMax(-5.0f, 5.0f));
+            const ezVec3 vHalfExtents(rng.FloatMinMax(0.1f, 3.0f), rng.FloatMinMax(0.1f, 3.0f), rng.FloatMinMax(0.1f, 3.0f));
+            ezGameObjectTest::SetLocalBounds(pObject, ezSimdConversion::ToBBoxSphere(ezBoundingBoxSphere::MakeFromCenterExtents(vCenter, vHalfExtents, vHalfExtents.GetLength())));
+          }
+        }
+      }
+
+      *pBatched = false;
+      world.Update();
+
+      ezDynamicArray<ezTransform> expectedTransforms;
+      ezDynamicArray<ezBoundingBoxSphere> expectedBounds;
+      for (ezGameObject* pObject : objects)
+      {
+        expectedTransforms.PushBack(pObject->GetGlobalTransform());
+        expectedBounds.PushBack(pObject->GetGlobalBounds());
+      }
+
+      *pBatched = true;
+      world.Update();
+
+      const float eps = ezMath::LargeEpsilon<float>();
+      for (ezUInt32 i = 0; i < objects.GetCount(); ++i)
+      {
+        const ezTransform t = objects[i]->GetGlobalTransform();
+        EZ_TEST_VEC3(t.m_vPosition, expectedTransforms[i].m_vPosition, eps);
+        EZ_TEST_BOOL(t.m_qRotation.IsEqualRotation(expectedTransforms[i].m_qRotation, eps));
+        EZ_TEST_VEC3(t.m_vScale, expectedTransforms[i].m_vScale, eps);
+
+        const ezBoundingBoxSphere bounds = objects[i]->GetGlobalBounds();
+        EZ_TEST_BOOL(bounds.IsValid() == expectedBounds[i].IsValid());
+        if (bounds.IsValid())
+        {
+          EZ_TEST_VEC3(bounds.m_vCenter, expectedBounds[i].m_vCenter, eps);
+          EZ_TEST_VEC3(bounds.m_vBoxHalfExtends, expectedBounds[i].m_vBoxHalfExtends, eps);
+          EZ_TEST_FLOAT(bounds.m_fSphereRadius, expectedBounds[i].m_fSphereRadius, eps);
+        }
+      }
+    }
+
+    *pBatched = bOldValue;
+  }
+
 #if EZ_ENABLED(EZ_GAMEOBJECT_VELOCITY)
   EZ_TEST_BLOCK(ezTestBlock::Enabled, "Velocity")
   {
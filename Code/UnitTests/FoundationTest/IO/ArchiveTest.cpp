@@ -1,11 +1,16 @@
 #include <FoundationTest/FoundationTestPCH.h>
 
 #include <Foundation/IO/Archive/Archive.h>
+#include <Foundation/IO/Archive/ArchiveBuilder.h>
+#include <Foundation/IO/Archive/ArchiveCompressionDictionary.h>
+#include <Foundation/IO/Archive/ArchiveReader.h>
+#include <Foundation/IO/Archive/ArchiveUtils.h>
 #include <Foundation/IO/Archive/DataDirTypeArchive.h>
 #include <Foundation/IO/FileSystem/DataDirTypeFolder.h>
 #include <Foundation/IO/FileSystem/FileReader.h>
 #include <Foundation/IO/FileSystem/FileSystem.h>
 #include <Foundation/IO/FileSystem/FileWriter.h>
+#include <Foundation/IO/MemoryStream.h>
 #include <Foundation/System/Process.h>
 #include <Foundation/Utilities/CommandLineUtils.h>
 
@@ -157,3 +162,427 @@ EZ_CREATE_SIMPLE_TEST(IO, Archive)
 }
 
 #endif
+
+#if EZ_ENABLED(EZ_SUPPORTS_MEMORY_MAPPED_FILE)
+
+namespace
+{
+  void GenerateEntryData(ezUInt32 uiEntryIdx, ezDynamicArray<ezUInt8>& out_data)
+  {
+    out_data.SetCountUninitialized(64 + (uiEntryIdx % 16) * 256);
+
+    for (ezUInt32 i = 0; i < out_data.GetCount(); ++i)
+    {
+      out_data[i] = static_cast<ezUInt8>((i / 8) + uiEntryIdx);
+    }
+  }
+
+  /// Writes an archive with entries of all compression modes, without any source files on disk.
+  ezResult WriteTestArchive(ezStringView sFile, ezUInt32 uiNumEntries)
+  {
+    ezContiguousMemoryStreamStorage storage;
+    ezMemoryStreamWriter file(&storage);
+    EZ_SUCCEED_OR_RETURN(ezArchiveUtils::WriteHeader(file));
+
+    ezArchiveTOC toc;
+    ezUInt64 uiStreamSize = 0;
+    ezDynamicArray<ezUInt8> data;
+    ezStringBuilder sPath;
+
+    for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+    {
+      sPath.SetFormat("entries/entry{}.bin", i);
+
+      const ezUInt32 uiPathStringOffset = toc.m_AllPathStrings.GetCount();
+      toc.m_AllPathStrings.PushBackRange(ezArrayPtr<const ezUInt8>(reinterpret_cast<const ezUInt8*>(sPath.GetData()), sPath.GetElementCount() + 1));
+      toc.m_PathToEntryIndex[ezArchiveStoredString(ezHashingUtils::StringHash(sPath), uiPathStringOffset)] = toc.m_Entries.GetCount();
+
+      GenerateEntryData(i, data);
+      ezRawMemoryStreamReader source(data);
+
+      const ezArchiveCompressionMode modes[] = {ezArchiveCompressionMode::Uncompressed, ezArchiveCompressionMode::Compressed_zstd, ezArchiveCompressionMode::Compressed_zstd_seekable};
+      const ezArchiveCompressionMode mode = modes[i % EZ_ARRAY_SIZE(modes)];
+      EZ_SUCCEED_OR_RETURN(ezArchiveUtils::WriteEntry(file, source, data.GetCount(), uiPathStringOffset, mode, 0, toc.m_Entries.ExpandAndGetRef(), uiStreamSize));
+    }
+
+    EZ_SUCCEED_OR_RETURN(ezArchiveUtils::AppendTOC(file, toc));
+
+    ezOSFile osFile;
+    EZ_SUCCEED_OR_RETURN(osFile.Open(sFile, ezFileOpenMode::Write));
+    return osFile.Write(storage.GetData(), storage.GetStorageSize64());
+  }
+} // namespace
+
+EZ_CREATE_SIMPLE_TEST(IO, ArchiveReader)
+{
+  ezStringBuilder sOutputFolder = ezTestFramework::GetInstance()->GetAbsOutputPath();
+  sOutputFolder.AppendPath("ArchiveReaderTest");
+  sOutputFolder.MakeCleanPath();
+
+  ezOSFile::DeleteFolder(sOutputFolder).IgnoreResult();
+  ezOSFile::CreateDirectoryStructure(sOutputFolder).IgnoreResult();
+
+  const ezStringBuilder sArchiveFile(sOutputFolder, "/Test.ezArchive");
+  constexpr ezUInt32 uiNumEntries = 100;
+
+  EZ_TEST_BOOL(WriteTestArchive(sArchiveFile, uiNumEntries).Succeeded());
+
+  ezArchiveReader reader;
+  if (!EZ_TEST_BOOL(reader.OpenArchive(sArchiveFile).Succeeded()))
+    return;
+
+  const ezArchiveTOC& toc = reader.GetArchiveTOC();
+  EZ_TEST_INT(toc.m_Entries.GetCount(), uiNumEntries);
+
+  ezDynamicArray<ezUInt8> expected;
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "GetUncompressedEntryData")
+  {
+    for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+    {
+      GenerateEntryData(i, expected);
+
+      ezArrayPtr<const ezUInt8> view;
+      if (toc.m_Entries[i].m_CompressionMode == ezArchiveCompressionMode::Uncompressed)
+      {
+        EZ_TEST_BOOL(reader.GetUncompressedEntryData(i, view).Succeeded());
+        EZ_TEST_BOOL(view == expected.GetArrayPtr());
+
+        // the view points directly into the memory mapped file
+        EZ_TEST_BOOL(view.GetPtr() == reader.GetStoredEntryData(i).GetPtr());
+      }
+      else
+      {
+        EZ_TEST_BOOL(reader.GetUncompressedEntryData(i, view).Failed());
+        EZ_TEST_INT(reader.GetStoredEntryData(i).GetCount(), toc.m_Entries[i].m_uiStoredDataSize);
+      }
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "ReadEntry")
+  {
+    ezDynamicArray<ezUInt8> buffer;
+
+    for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+    {
+      GenerateEntryData(i, expected);
+
+      buffer.SetCount(expected.GetCount());
+      EZ_TEST_BOOL(reader.ReadEntry(i, buffer).Succeeded());
+      EZ_TEST_BOOL(buffer == expected);
+
+      // the buffer must have exactly the right size
+      buffer.SetCount(expected.GetCount() + 1);
+      EZ_TEST_BOOL(reader.ReadEntry(i, buffer).Failed());
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "ReadEntries")
+  {
+    ezDynamicArray<ezDynamicArray<ezUInt8>> buffers;
+    ezDynamicArray<ezArchiveReader::EntryRequest> requests;
+    buffers.SetCount(uiNumEntries);
+    requests.SetCount(uiNumEntries);
+
+    for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+    {
+      // read in reverse order, the order of the requests doesn't matter
+      const ezUInt32 uiEntryIdx = uiNumEntries - 1 - i;
+
+      buffers[i].SetCount(static_cast<ezUInt32>(toc.m_Entries[uiEntryIdx].m_uiUncompressedDataSize));
+      requests[i].m_uiEntryIdx = uiEntryIdx;
+      requests[i].m_TargetBuffer = buffers[i];
+    }
+
+    EZ_TEST_BOOL(reader.ReadEntries(requests).Succeeded());
+
+    for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+    {
+      GenerateEntryData(requests[i].m_uiEntryIdx, expected);
+
+      EZ_TEST_BOOL(requests[i].m_Result.Succeeded());
+      EZ_TEST_BOOL(buffers[i] == expected);
+    }
+
+    // a request with a wrong buffer size fails, but doesn't affect the others
+    requests[3].m_TargetBuffer = requests[3].m_TargetBuffer.GetSubArray(1);
+    EZ_TEST_BOOL(reader.ReadEntries(requests).Failed());
+    EZ_TEST_BOOL(requests[3].m_Result.Failed());
+    EZ_TEST_BOOL(requests[4].m_Result.Succeeded());
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "CreateEntryReader")
+  {
+    ezDynamicArray<ezUInt8> buffer;
+
+    for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+    {
+      GenerateEntryData(i, expected);
+
+      ezUniquePtr<ezStreamReader> pEntryReader = reader.CreateEntryReader(i);
+
+      buffer.SetCount(expected.GetCount() + 16);
+      EZ_TEST_INT(pEntryReader->ReadBytes(buffer.GetData(), buffer.GetCount()), expected.GetCount());
+      buffer.SetCount(expected.GetCount());
+      EZ_TEST_BOOL(buffer == expected);
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Data Directory")
+  {
+    if (EZ_TEST_BOOL(ezFileSystem::AddDataDirectory(sArchiveFile, "ArchiveReaderTest", "archive", ezFileSystem::ReadOnly).Succeeded()))
+    {
+      ezDynamicArray<ezUInt8> buffer;
+      ezStringBuilder sPath;
+
+      for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+      {
+        GenerateEntryData(i, expected);
+        sPath.SetFormat(":archive/entries/entry{}.bin", i);
+
+        ezFileReader file;
+        if (!EZ_TEST_BOOL(file.Open(sPath).Succeeded()))
+          continue;
+
+        buffer.SetCount(expected.GetCount());
+        EZ_TEST_INT(file.ReadBytes(buffer.GetData(), buffer.GetCount()), expected.GetCount());
+        EZ_TEST_BOOL(buffer == expected);
+      }
+
+      ezFileSystem::RemoveDataDirectoryGroup("ArchiveReaderTest");
+    }
+  }
+
+#  ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Seekable Entry")
+  {
+    // a large entry that spans many blocks
+    ezDynamicArray<ezUInt32> data;
+    data.SetCountUninitialized(1024 * 256);
+    for (ezUInt32 i = 0; i < data.GetCount(); ++i)
+    {
+      data[i] = i;
+    }
+
+    ezContiguousMemoryStreamStorage storage;
+    ezMemoryStreamWriter writer(&storage);
+    ezRawMemoryStreamReader source(data.GetData(), data.GetCount() * sizeof(ezUInt32));
+
+    ezArchiveEntry entry;
+    ezUInt64 uiStreamSize = 0;
+    EZ_TEST_BOOL(ezArchiveUtils::WriteEntry(writer, source, source.GetByteCount(), 0, ezArchiveCompressionMode::Compressed_zstd_seekable, 0, entry, uiStreamSize).Succeeded());
+    EZ_TEST_BOOL(entry.m_CompressionMode == ezArchiveCompressionMode::Compressed_zstd_seekable);
+    EZ_TEST_INT(entry.m_uiStoredDataSize, storage.GetStorageSize64());
+    EZ_TEST_BOOL(entry.m_uiStoredDataSize < entry.m_uiUncompressedDataSize);
+
+    ezUniquePtr<ezStreamReader> pEntryReader = ezArchiveUtils::CreateEntryReader(entry, storage.GetData());
+
+    ezUInt32 uiPos = 0;
+    for (ezUInt32 uiSkip : {100000u, 7u, 0u, 65536u, 3000u})
+    {
+      EZ_TEST_INT(pEntryReader->SkipBytes(uiSkip * sizeof(ezUInt32)), uiSkip * sizeof(ezUInt32));
+      uiPos += uiSkip;
+
+      ezUInt32 uiValues[4] = {};
+      EZ_TEST_INT(pEntryReader->ReadBytes(uiValues, sizeof(uiValues)), sizeof(uiValues));
+      EZ_TEST_INT(uiValues[0], uiPos);
+      EZ_TEST_INT(uiValues[3], uiPos + 3);
+      uiPos += 4;
+    }
+
+    ezDynamicArray<ezUInt32> readBack;
+    readBack.SetCount(data.GetCount());
+    EZ_TEST_BOOL(ezArchiveUtils::ReadEntry(entry, storage.GetData(), readBack.GetByteArrayPtr()).Succeeded());
+    EZ_TEST_BOOL(readBack == data);
+  }
+#  endif
+}
+
+#  if defined(BUILDSYSTEM_ENABLE_ZSTD_SUPPORT) && EZ_ENABLED(EZ_SUPPORTS_FILE_ITERATORS)
+
+namespace
+{
+  /// Small text files that share most of their content, like typical material or prefab files.
+  void GenerateSimilarFile(ezUInt32 uiFileIdx, ezStringBuilder& out_sContent)
+  {
+    out_sContent.SetFormat("Material\n{{\n  Shader = \"Shaders/Materials/DefaultMaterial.ezShader\";\n  BaseTexture = \"{{ 0x{}, 0x{} }\";\n", ezArgU(uiFileIdx * 2654435761u, 8, true, 16), ezArgU(uiFileIdx * 40503u, 8, true, 16));
+    out_sContent.AppendFormat("  NormalTexture = \"Textures/Defaults/FlatNormal.dds\";\n  Roughness = 0.{};\n  Metallic = {};\n", uiFileIdx % 10, uiFileIdx % 2);
+    out_sContent.AppendFormat("  BlendMode = \"Opaque\";\n  TwoSided = false;\n  ShadingMode = \"Lit\";\n  Tint = {{ r = 1.0, g = 0.{}, b = 1.0, a = 1.0 };\n}\n", uiFileIdx % 7);
+
+    for (ezUInt32 i = 0; i < uiFileIdx % 5; ++i)
+    {
+      out_sContent.AppendFormat("Parameter{}\n{{\n  Name = \"CustomParameter{}\";\n  Type = \"float\";\n  Value = {};\n}\n", i, i, uiFileIdx + i);
+    }
+  }
+} // namespace
+
+EZ_CREATE_SIMPLE_TEST(IO, ArchiveCompressionDictionary)
+{
+  constexpr ezUInt32 uiNumFiles = 300;
+
+  ezDynamicArray<ezStringBuilder> files;
+  files.SetCount(uiNumFiles);
+  for (ezUInt32 i = 0; i < uiNumFiles; ++i)
+  {
+    GenerateSimilarFile(i, files[i]);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Train")
+  {
+    ezDynamicArray<ezArrayPtr<const ezUInt8>> samples;
+    for (const auto& file : files)
+    {
+      samples.PushBack(ezArrayPtr<const ezUInt8>(reinterpret_cast<const ezUInt8*>(file.GetData()), file.GetElementCount()));
+    }
+
+    ezDynamicArray<ezUInt8> dictionaryData;
+
+    // not enough data
+    EZ_TEST_BOOL(ezArchiveCompressionDictionary::Train(samples.GetArrayPtr().GetSubArray(0, 2), 16 * 1024, dictionaryData).Failed());
+
+    EZ_TEST_BOOL(ezArchiveCompressionDictionary::Train(samples, 16 * 1024, dictionaryData).Succeeded());
+    EZ_TEST_BOOL(!dictionaryData.IsEmpty());
+    EZ_TEST_BOOL(dictionaryData.GetCount() <= 16 * 1024);
+
+    ezArchiveCompressionDictionary dictionary;
+    EZ_TEST_BOOL(dictionary.InitializeForCompression(dictionaryData, 10).Succeeded());
+    EZ_TEST_BOOL(dictionary.InitializeForDecompression(dictionaryData).Succeeded());
+
+    ezUInt64 uiUncompressed = 0;
+    ezUInt64 uiCompressedWithDict = 0;
+    ezUInt64 uiCompressedWithoutDict = 0;
+
+    ezDynamicArray<ezUInt8> compressed;
+    ezDynamicArray<ezUInt8> decompressed;
+
+    for (const auto& sample : samples)
+    {
+      compressed.Clear();
+      EZ_TEST_BOOL(dictionary.Compress(sample, compressed).Succeeded());
+
+      decompressed.SetCountUninitialized(sample.GetCount());
+      EZ_TEST_BOOL(dictionary.Decompress(compressed, decompressed).Succeeded());
+      EZ_TEST_BOOL(decompressed.GetArrayPtr() == sample);
+
+      // the target buffer must have the right size
+      decompressed.SetCountUninitialized(sample.GetCount() - 1);
+      EZ_TEST_BOOL(dictionary.Decompress(compressed, decompressed).Failed());
+
+      uiUncompressed += sample.GetCount();
+      uiCompressedWithDict += compressed.GetCount();
+
+      ezContiguousMemoryStreamStorage storage;
+      ezMemoryStreamWriter writer(&storage);
+      ezRawMemoryStreamReader source(sample.GetPtr(), sample.GetCount());
+      ezArchiveEntry entry;
+      ezUInt64 uiStreamPos = 0;
+      EZ_TEST_BOOL(ezArchiveUtils::WriteEntry(writer, source, sample.GetCount(), 0, ezArchiveCompressionMode::Compressed_zstd, 10, entry, uiStreamPos).Succeeded());
+      uiCompressedWithoutDict += entry.m_uiStoredDataSize;
+    }
+
+    EZ_TEST_BOOL(uiCompressedWithDict * 2 < uiCompressedWithoutDict);
+    EZ_TEST_BOOL(uiCompressedWithDict * 4 < uiUncompressed);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "ezArchiveBuilder")
+  {
+    ezStringBuilder sOutputFolder = ezTestFramework::GetInstance()->GetAbsOutputPath();
+    sOutputFolder.AppendPath("ArchiveDictionaryTest");
+    sOutputFolder.MakeCleanPath();
+
+    ezOSFile::DeleteFolder(sOutputFolder).IgnoreResult();
+
+    const ezStringBuilder sSourceFolder(sOutputFolder, "/Source");
+    const ezStringBuilder sArchiveFile(sOutputFolder, "/Test.ezArchive");
+
+    ezStringBuilder sPath;
+    for (ezUInt32 i = 0; i < uiNumFiles; ++i)
+    {
+      sPath.SetFormat("{}/Materials/Material{}.ezMaterial", sSourceFolder, i);
+      ezOSFile::CreateDirectoryStructure(sPath.GetFileDirectory()).IgnoreResult();
+
+      ezOSFile file;
+      EZ_TEST_BOOL(file.Open(sPath, ezFileOpenMode::Write).Succeeded());
+      EZ_TEST_BOOL(file.Write(files[i].GetData(), files[i].GetElementCount()).Succeeded());
+    }
+
+    // ezArchiveBuilder reads the source files through ezFileSystem
+    EZ_TEST_BOOL(ezFileSystem::AddDataDirectory(sOutputFolder, "ArchiveDictionaryTest").Succeeded());
+
+    ezArchiveBuilder builder;
+    builder.AddFolder(sSourceFolder, ezArchiveCompressionMode::Uncompressed, [](ezStringView) { return ezArchiveBuilder::InclusionMode::Compress_zstd_dictionary; });
+    EZ_TEST_INT(builder.m_Entries.GetCount(), uiNumFiles);
+
+    {
+      ezContiguousMemoryStreamStorage storage;
+      ezMemoryStreamWriter writer(&storage);
+      EZ_TEST_BOOL(builder.WriteArchive(writer).Succeeded());
+
+      ezOSFile file;
+      EZ_TEST_BOOL(file.Open(sArchiveFile, ezFileOpenMode::Write).Succeeded());
+      EZ_TEST_BOOL(file.Write(storage.GetData(), storage.GetStorageSize64()).Succeeded());
+    }
+
+    ezFileSystem::RemoveDataDirectoryGroup("ArchiveDictionaryTest");
+
+    ezArchiveReader reader;
+    if (!EZ_TEST_BOOL(reader.OpenArchive(sArchiveFile).Succeeded()))
+      return;
+
+    const ezArchiveTOC& toc = reader.GetArchiveTOC();
+    EZ_TEST_BOOL(!toc.m_CompressionDictionary.IsEmpty());
+    EZ_TEST_BOOL(reader.GetCompressionDictionary().IsInitializedForDecompression());
+
+    ezUInt32 uiNumDictionaryEntries = 0;
+    ezDynamicArray<ezUInt8> buffer;
+
+    for (ezUInt32 i = 0; i < uiNumFiles; ++i)
+    {
+      sPath.SetFormat("Materials/Material{}.ezMaterial", i);
+      const ezUInt32 uiEntryIdx = toc.FindEntry(sPath);
+      if (!EZ_TEST_BOOL(uiEntryIdx != ezInvalidIndex))
+        continue;
+
+      if (toc.m_Entries[uiEntryIdx].m_CompressionMode == ezArchiveCompressionMode::Compressed_zstd_dictionary)
+      {
+        ++uiNumDictionaryEntries;
+      }
+
+      const ezArrayPtr<const ezUInt8> expected(reinterpret_cast<const ezUInt8*>(files[i].GetData()), files[i].GetElementCount());
+
+      buffer.SetCountUninitialized(expected.GetCount());
+      EZ_TEST_BOOL(reader.ReadEntry(uiEntryIdx, buffer).Succeeded());
+      EZ_TEST_BOOL(buffer.GetArrayPtr() == expected);
+
+      ezUniquePtr<ezStreamReader> pEntryReader = reader.CreateEntryReader(uiEntryIdx);
+      buffer.SetCount(expected.GetCount() + 1);
+      EZ_TEST_INT(pEntryReader->ReadBytes(buffer.GetData(), buffer.GetCount()), expected.GetCount());
+      buffer.SetCount(expected.GetCount());
+      EZ_TEST_BOOL(buffer.GetArrayPtr() == expected);
+    }
+
+    EZ_TEST_BOOL(uiNumDictionaryEntries > uiNumFiles / 2);
+
+    // read through an archive data directory
+    if (EZ_TEST_BOOL(ezFileSystem::AddDataDirectory(sArchiveFile, "ArchiveDictionaryTest", "archive", ezFileSystem::ReadOnly).Succeeded()))
+    {
+      {
+        ezFileReader file;
+        if (EZ_TEST_BOOL(file.Open(":archive/Materials/Material42.ezMaterial").Succeeded()))
+        {
+          EZ_TEST_INT(file.GetFileSize(), files[42].GetElementCount());
+
+          buffer.SetCount(files[42].GetElementCount());
+          EZ_TEST_INT(file.ReadBytes(buffer.GetData(), buffer.GetCount()), files[42].GetElementCount());
+          EZ_TEST_BOOL(ezStringView(reinterpret_cast<const char*>(buffer.GetData()), buffer.GetCount()) == files[42]);
+        }
+      }
+
+      ezFileSystem::RemoveDataDirectoryGroup("ArchiveDictionaryTest");
+    }
+  }
+}
+
+#  endif
+
+#endif
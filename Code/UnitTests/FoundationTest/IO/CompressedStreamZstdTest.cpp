@@ -136,4 +136,123 @@ EZ_CREATE_SIMPLE_TEST(IO, CompressedStreamZstd)
   }
 }
 
+EZ_CREATE_SIMPLE_TEST(IO, CompressedStreamZstdSeekable)
+{
+  ezDynamicArray<ezUInt32> TestData;
+  TestData.SetCountUninitialized(1024 * 1024);
+
+  for (ezUInt32 i = 0; i < TestData.GetCount(); ++i)
+  {
+    TestData[i] = i % 1000;
+  }
+
+  ezContiguousMemoryStreamStorage StreamStorage;
+  ezMemoryStreamWriter MemoryWriter(&StreamStorage);
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Compress Data")
+  {
+    ezCompressedStreamWriterZstdSeekable CompressedWriter(&MemoryWriter, ezCompressedStreamWriterZstd::Compression::Default, 16);
+
+    // write in odd sizes, to not align with the block size
+    ezUInt32 uiWrite = 1;
+    for (ezUInt32 i = 0; i < TestData.GetCount();)
+    {
+      uiWrite = ezMath::Min<ezUInt32>(uiWrite, TestData.GetCount() - i);
+
+      EZ_TEST_BOOL(CompressedWriter.WriteBytes(&TestData[i], sizeof(ezUInt32) * uiWrite) == EZ_SUCCESS);
+
+      i += uiWrite;
+      uiWrite += 17;
+    }
+
+    EZ_TEST_BOOL(CompressedWriter.FinishCompressedStream().Succeeded());
+
+    EZ_TEST_INT(CompressedWriter.GetUncompressedSize(), TestData.GetCount() * sizeof(ezUInt32));
+    EZ_TEST_INT(CompressedWriter.GetWrittenBytes(), StreamStorage.GetStorageSize64());
+    EZ_TEST_BOOL(CompressedWriter.GetWrittenBytes() * 2 < CompressedWriter.GetUncompressedSize());
+  }
+
+  const ezArrayPtr<const ezUInt8> CompressedData(StreamStorage.GetData(), StreamStorage.GetStorageSize32());
+
+  ezCompressedStreamReaderZstdSeekable CompressedReader;
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Invalid Data")
+  {
+    EZ_TEST_BOOL(CompressedReader.SetInputData(CompressedData.GetSubArray(0, 3)).Failed());
+    EZ_TEST_BOOL(CompressedReader.SetInputData(CompressedData.GetSubArray(0, CompressedData.GetCount() - 1)).Failed());
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Uncompress Data")
+  {
+    EZ_TEST_BOOL(CompressedReader.SetInputData(CompressedData).Succeeded());
+    EZ_TEST_INT(CompressedReader.GetUncompressedSize(), TestData.GetCount() * sizeof(ezUInt32));
+
+    ezDynamicArray<ezUInt32> TestDataRead;
+    TestDataRead.SetCount(TestData.GetCount());
+
+    EZ_TEST_INT(CompressedReader.ReadBytes(TestDataRead.GetData(), TestDataRead.GetCount() * sizeof(ezUInt32)), TestData.GetCount() * sizeof(ezUInt32));
+    EZ_TEST_BOOL(TestData == TestDataRead);
+
+    ezUInt32 uiTemp = 0;
+    EZ_TEST_INT(CompressedReader.ReadBytes(&uiTemp, sizeof(ezUInt32)), 0);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Random Access")
+  {
+    EZ_TEST_BOOL(CompressedReader.SetInputData(CompressedData).Succeeded());
+
+    const ezUInt32 uiNumItems = TestData.GetCount();
+    ezUInt32 uiItem = 12345;
+
+    for (ezUInt32 i = 0; i < 200; ++i)
+    {
+      uiItem = (uiItem * 7919 + 104729) % uiNumItems;
+      const ezUInt32 uiCount = ezMath::Min(1 + (i * 131) % 9000, uiNumItems - uiItem);
+
+      ezDynamicArray<ezUInt32> Read;
+      Read.SetCount(uiCount);
+
+      CompressedReader.SetReadPosition(uiItem * sizeof(ezUInt32));
+      EZ_TEST_INT(CompressedReader.GetReadPosition(), uiItem * sizeof(ezUInt32));
+
+      EZ_TEST_INT(CompressedReader.ReadBytes(Read.GetData(), uiCount * sizeof(ezUInt32)), uiCount * sizeof(ezUInt32));
+      EZ_TEST_BOOL(Read.GetArrayPtr() == TestData.GetArrayPtr().GetSubArray(uiItem, uiCount));
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "SkipBytes")
+  {
+    EZ_TEST_BOOL(CompressedReader.SetInputData(CompressedData).Succeeded());
+
+    ezUInt32 uiValue = 0;
+    EZ_TEST_INT(CompressedReader.SkipBytes(500000 * sizeof(ezUInt32)), 500000 * sizeof(ezUInt32));
+    CompressedReader.ReadBytes(&uiValue, sizeof(ezUInt32));
+    EZ_TEST_INT(uiValue, TestData[500000]);
+
+    EZ_TEST_INT(CompressedReader.ReadBytes(nullptr, 99999 * sizeof(ezUInt32)), 99999 * sizeof(ezUInt32));
+    CompressedReader.ReadBytes(&uiValue, sizeof(ezUInt32));
+    EZ_TEST_INT(uiValue, TestData[600000]);
+
+    // skipping past the end is clamped
+    EZ_TEST_INT(CompressedReader.SkipBytes(0xFFFFFFFF), (TestData.GetCount() - 600001) * sizeof(ezUInt32));
+    EZ_TEST_INT(CompressedReader.ReadBytes(&uiValue, sizeof(ezUInt32)), 0);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Empty Stream")
+  {
+    ezContiguousMemoryStreamStorage EmptyStorage;
+    ezMemoryStreamWriter EmptyWriter(&EmptyStorage);
+
+    {
+      ezCompressedStreamWriterZstdSeekable CompressedWriter(&EmptyWriter);
+    }
+
+    EZ_TEST_BOOL(CompressedReader.SetInputData(ezArrayPtr<const ezUInt8>(EmptyStorage.GetData(), EmptyStorage.GetStorageSize32())).Succeeded());
+    EZ_TEST_INT(CompressedReader.GetUncompressedSize(), 0);
+
+    ezUInt32 uiValue = 0;
+    EZ_TEST_INT(CompressedReader.ReadBytes(&uiValue, sizeof(ezUInt32)), 0);
+  }
+}
+
 #endif
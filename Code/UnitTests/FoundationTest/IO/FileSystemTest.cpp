@@ -4,6 +4,9 @@
 #include <Foundation/IO/FileSystem/FileReader.h>
 #include <Foundation/IO/FileSystem/FileSystem.h>
 #include <Foundation/IO/FileSystem/FileWriter.h>
+#include <Foundation/IO/OSFile.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Threading/ThreadUtils.h>
 
 #if EZ_ENABLED(EZ_SUPPORTS_LONG_PATHS)
 #  define LongPath                                                                                                                                   \
@@ -13,6 +16,32 @@
 #  define LongPath "AShortPathBecaueThisPlatformDoesntSupportLongOnes"
 #endif
 
+namespace
+{
+  class FileSystemLookupThread : public ezThread
+  {
+  public:
+    FileSystemLookupThread()
+      : ezThread("FileSystem Lookup Thread")
+    {
+    }
+
+    ezAtomicBool m_bStop;
+    ezAtomicInteger32 m_iNumLookups;
+
+    virtual ezUInt32 Run() override
+    {
+      while (!m_bStop)
+      {
+        ezFileSystem::ExistsFile(":concurrent/FileSystemTest.txt");
+        m_iNumLookups.Increment();
+      }
+
+      return 0;
+    }
+  };
+} // namespace
+
 EZ_CREATE_SIMPLE_TEST(IO, FileSystem)
 {
   ezStringBuilder sFileContent = "Lyrics to Taste The Cake:\n\
@@ -363,4 +392,154 @@ Only concrete and clocks.\n\
 
     ezFileSystem::RemoveDataDirectoryGroup("remove");
   }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Remove Data Directories While Reading")
+  {
+    // removed data directories must stay alive until no lookup can access them anymore
+    FileSystemLookupThread threads[4];
+    for (FileSystemLookupThread& thread : threads)
+    {
+      thread.Start();
+    }
+
+    for (ezUInt32 i = 0; i < 200; ++i)
+    {
+      EZ_TEST_BOOL(ezFileSystem::AddDataDirectory(sOutputFolder1, "concurrent", "concurrent").Succeeded());
+      EZ_TEST_INT(ezFileSystem::RemoveDataDirectoryGroup("concurrent"), 1);
+    }
+
+    ezInt32 iNumLookups = 0;
+    for (FileSystemLookupThread& thread : threads)
+    {
+      thread.m_bStop = true;
+      thread.Join();
+      iNumLookups += thread.m_iNumLookups;
+    }
+
+    EZ_TEST_BOOL(iNumLookups > 0);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Indexed Data Directory")
+  {
+    ezStringBuilder sIndexedFolder = szOutputFolder;
+    sIndexedFolder.AppendPath("IO", "Indexed");
+    ezStringBuilder sCacheFolder = szOutputFolder;
+    sCacheFolder.AppendPath("IO", "IndexCache");
+
+    ezOSFile::DeleteFolder(sIndexedFolder).IgnoreResult();
+    ezOSFile::DeleteFolder(sCacheFolder).IgnoreResult();
+
+    auto CreateFile = [&](ezStringView sFile)
+    {
+      ezStringBuilder sPath = sIndexedFolder;
+      sPath.AppendPath(sFile);
+
+      ezOSFile file;
+      EZ_TEST_BOOL(file.Open(sPath, ezFileOpenMode::Write).Succeeded());
+    };
+
+    CreateFile("Existing.txt");
+    CreateFile("Sub/Existing.txt");
+
+    ezDataDirectory::FolderType::s_sFileIndexCacheFolder = sCacheFolder;
+    ezFileSystem::ClearAllDataDirectoryFactories();
+    ezFileSystem::RegisterDataDirectoryFactory(ezDataDirectory::FolderType::IndexedFactory);
+
+    EZ_TEST_BOOL(ezFileSystem::AddDataDirectory(sIndexedFolder, "Indexed", "indexed", ezFileSystem::AllowWrites).Succeeded());
+
+    auto* pDataDir = static_cast<ezDataDirectory::FolderType*>(ezFileSystem::FindDataDirectoryWithRoot("indexed"));
+    if (EZ_TEST_BOOL(pDataDir != nullptr))
+    {
+      EZ_TEST_BOOL(pDataDir->HasFileIndex() == EZ_ENABLED(EZ_SUPPORTS_DIRECTORY_WATCHER));
+    }
+
+    ezFileStats stats;
+
+    EZ_TEST_BOOL(ezFileSystem::ExistsFile(":indexed/Existing.txt"));
+    EZ_TEST_BOOL(ezFileSystem::ExistsFile(":indexed/Sub/Existing.txt"));
+    EZ_TEST_BOOL(!ezFileSystem::ExistsFile(":indexed/Missing.txt"));
+    EZ_TEST_BOOL(!ezFileSystem::ExistsFile(":indexed/Sub"));
+    EZ_TEST_BOOL(ezFileSystem::GetFileStats(":indexed/Sub", stats).Succeeded());
+    EZ_TEST_BOOL(stats.m_bIsDirectory);
+    EZ_TEST_BOOL(ezFileSystem::GetFileStats(":indexed/Missing", stats).Failed());
+
+    {
+      ezFileReader file;
+      EZ_TEST_BOOL(file.Open(":indexed/Sub/Existing.txt").Succeeded());
+
+      ezFileReader missingFile;
+      EZ_TEST_BOOL(missingFile.Open(":indexed/Sub/Missing.txt").Failed());
+    }
+
+    // files written and deleted through the data directory are known right away
+    {
+      ezFileWriter file;
+      EZ_TEST_BOOL(file.Open(":indexed/New/Written.txt").Succeeded());
+    }
+
+    EZ_TEST_BOOL(ezFileSystem::ExistsFile(":indexed/New/Written.txt"));
+    EZ_TEST_BOOL(ezFileSystem::GetFileStats(":indexed/New", stats).Succeeded());
+
+    ezFileSystem::DeleteFile(":indexed/New/Written.txt");
+    EZ_TEST_BOOL(!ezFileSystem::ExistsFile(":indexed/New/Written.txt"));
+
+#if EZ_ENABLED(EZ_SUPPORTS_DIRECTORY_WATCHER)
+    // files created by someone else are found once the changes reported by the directory watcher were applied
+    CreateFile("Sub/External.txt");
+    pDataDir->UpdateFileIndex();
+    EZ_TEST_BOOL(ezFileSystem::ExistsFile(":indexed/Sub/External.txt"));
+
+    // the background thread applies them as well, without any lookup asking the directory watcher
+    CreateFile("Sub/External2.txt");
+    for (ezUInt32 i = 0; i < 100 && !ezFileSystem::ExistsFile(":indexed/Sub/External2.txt"); ++i)
+    {
+      ezThreadUtils::Sleep(ezDataDirectory::FolderType::s_FileIndexUpdateInterval);
+    }
+    EZ_TEST_BOOL(ezFileSystem::ExistsFile(":indexed/Sub/External2.txt"));
+
+    ezStringBuilder sExternalFile = sIndexedFolder;
+    sExternalFile.AppendPath("Sub/External.txt");
+    EZ_TEST_BOOL(ezOSFile::DeleteFile(sExternalFile).Succeeded());
+    sExternalFile = sIndexedFolder;
+    sExternalFile.AppendPath("Sub/External2.txt");
+    EZ_TEST_BOOL(ezOSFile::DeleteFile(sExternalFile).Succeeded());
+    pDataDir->UpdateFileIndex();
+    EZ_TEST_BOOL(!ezFileSystem::ExistsFile(":indexed/Sub/External.txt"));
+#endif
+
+    EZ_TEST_INT(ezFileSystem::RemoveDataDirectoryGroup("Indexed"), 1);
+
+#if EZ_ENABLED(EZ_SUPPORTS_DIRECTORY_WATCHER)
+
+    // the index is only stored once the folders weren't modified for a moment
+    ezThreadUtils::Sleep(ezTime::MakeFromSeconds(2.5));
+
+    ezDynamicArray<ezFileStats> cacheFiles;
+    EZ_TEST_BOOL(ezFileSystem::AddDataDirectory(sIndexedFolder, "Indexed", "indexed").Succeeded());
+    ezOSFile::GatherAllItemsInFolder(cacheFiles, sCacheFolder, ezFileSystemIteratorFlags::ReportFiles);
+    EZ_TEST_INT(cacheFiles.GetCount(), 1);
+    EZ_TEST_INT(ezFileSystem::RemoveDataDirectoryGroup("Indexed"), 1);
+
+    // mounted from the stored index
+    EZ_TEST_BOOL(ezFileSystem::AddDataDirectory(sIndexedFolder, "Indexed", "indexed").Succeeded());
+    EZ_TEST_BOOL(ezFileSystem::ExistsFile(":indexed/Existing.txt"));
+    EZ_TEST_BOOL(ezFileSystem::ExistsFile(":indexed/Sub/Existing.txt"));
+    EZ_TEST_BOOL(!ezFileSystem::ExistsFile(":indexed/Missing.txt"));
+    EZ_TEST_BOOL(ezFileSystem::GetFileStats(":indexed/New", stats).Succeeded());
+    EZ_TEST_INT(ezFileSystem::RemoveDataDirectoryGroup("Indexed"), 1);
+
+    // a modified folder makes the stored index invalid
+    CreateFile("Sub/AfterCache.txt");
+    EZ_TEST_BOOL(ezFileSystem::AddDataDirectory(sIndexedFolder, "Indexed", "indexed").Succeeded());
+    EZ_TEST_BOOL(ezFileSystem::ExistsFile(":indexed/Sub/AfterCache.txt"));
+    EZ_TEST_INT(ezFileSystem::RemoveDataDirectoryGroup("Indexed"), 1);
+#endif
+
+    ezDataDirectory::FolderType::s_sFileIndexCacheFolder.Clear();
+    ezFileSystem::ClearAllDataDirectoryFactories();
+    ezFileSystem::RegisterDataDirectoryFactory(ezDataDirectory::FolderType::Factory);
+
+    ezOSFile::DeleteFolder(sIndexedFolder).IgnoreResult();
+    ezOSFile::DeleteFolder(sCacheFolder).IgnoreResult();
+  }
 }
@@ -1,6 +1,7 @@
 #include <FoundationTest/FoundationTestPCH.h>
 
 #include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/FlatHashTable.h>
 #include <Foundation/Containers/HybridArray.h>
 #include <Foundation/Containers/StaticArray.h>
 #include <Foundation/IO/MemoryStream.h>
@@ -278,6 +279,42 @@ EZ_CREATE_SIMPLE_TEST(IO, StreamOperation)
     EZ_TEST_BOOL(TestHashTableReadBack.GetValue(23)->IsEqual("World"));
   }
 
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "ezFlatHashTable Stream Operators")
+  {
+    ezDefaultMemoryStreamStorage StreamStorage(4096);
+
+    // Create writer
+    ezMemoryStreamWriter StreamWriter(&StreamStorage);
+
+    ezFlatHashTable<ezUInt64, ezString> TestHashTable;
+    TestHashTable.Insert(42, "Hello");
+    TestHashTable.Insert(23, "World");
+    TestHashTable.Insert(5, "!");
+
+    StreamWriter.WriteHashTable(TestHashTable).IgnoreResult();
+
+    // the format is the same as for ezHashTable
+    ezHashTable<ezUInt64, ezString> TestHashTableReadBack;
+    {
+      ezMemoryStreamReader StreamReader(&StreamStorage);
+      EZ_TEST_BOOL(StreamReader.ReadHashTable(TestHashTableReadBack).Succeeded());
+    }
+
+    EZ_TEST_INT(TestHashTableReadBack.GetCount(), 3);
+    EZ_TEST_BOOL(TestHashTableReadBack.GetValue(42)->IsEqual("Hello"));
+    EZ_TEST_BOOL(TestHashTableReadBack.GetValue(5)->IsEqual("!"));
+    EZ_TEST_BOOL(TestHashTableReadBack.GetValue(23)->IsEqual("World"));
+
+    ezFlatHashTable<ezUInt64, ezString> TestFlatHashTableReadBack;
+    TestFlatHashTableReadBack.Insert(1, "Shouldn't be there after deserialization.");
+    {
+      ezMemoryStreamReader StreamReader(&StreamStorage);
+      EZ_TEST_BOOL(StreamReader.ReadHashTable(TestFlatHashTableReadBack).Succeeded());
+    }
+
+    EZ_TEST_BOOL(TestFlatHashTableReadBack == TestHashTable);
+  }
+
   EZ_TEST_BLOCK(ezTestBlock::Enabled, "String Deduplication")
   {
     ezDefaultMemoryStreamStorage StreamStorageNonDeduplicated(4096);
@@ -1,8 +1,11 @@
 #include <FoundationTest/FoundationTestPCH.h>
 
 #include <Foundation/Memory/CommonAllocators.h>
+#include <Foundation/Memory/HeapProfile.h>
 #include <Foundation/Memory/LargeBlockAllocator.h>
 #include <Foundation/Memory/LinearAllocator.h>
+#include <Foundation/Memory/ThreadCachingAllocator.h>
+#include <Foundation/Threading/Thread.h>
 
 struct alignas(EZ_ALIGNMENT_MINIMUM) NonAlignedVector
 {
@@ -82,6 +85,58 @@ void TestAlignmentHelper(size_t uiExpectedAlignment)
   }
 }
 
+namespace
+{
+  class ThreadCachingTestThread : public ezThread
+  {
+  public:
+    ThreadCachingTestThread(ezAllocator* pAllocator, ezArrayPtr<void*> foreignAllocations)
+      : ezThread("ThreadCachingTestThread")
+      , m_pAllocator(pAllocator)
+      , m_ForeignAllocations(foreignAllocations)
+    {
+    }
+
+    virtual ezUInt32 Run() override
+    {
+      // free blocks that were allocated by another thread
+      for (void* pPtr : m_ForeignAllocations)
+      {
+        m_pAllocator->Deallocate(pPtr);
+      }
+
+      void* allocations[256];
+      for (ezUInt32 uiRound = 0; uiRound < 64; ++uiRound)
+      {
+        for (ezUInt32 i = 0; i < EZ_ARRAY_SIZE(allocations); ++i)
+        {
+          const size_t uiSize = 1 + (i * 37 + uiRound) % 700;
+          allocations[i] = m_pAllocator->Allocate(uiSize, 8);
+          ezMemoryUtils::PatternFill(static_cast<ezUInt8*>(allocations[i]), static_cast<ezUInt8>(i), uiSize);
+        }
+
+        for (ezUInt32 i = 0; i < EZ_ARRAY_SIZE(allocations); ++i)
+        {
+          const size_t uiSize = 1 + (i * 37 + uiRound) % 700;
+          const ezUInt8* pBytes = static_cast<const ezUInt8*>(allocations[i]);
+          if (pBytes[0] != static_cast<ezUInt8>(i) || pBytes[uiSize - 1] != static_cast<ezUInt8>(i))
+          {
+            m_bCorrupted = true;
+          }
+
+          m_pAllocator->Deallocate(allocations[i]);
+        }
+      }
+
+      return 0;
+    }
+
+    ezAllocator* m_pAllocator;
+    ezArrayPtr<void*> m_ForeignAllocations;
+    bool m_bCorrupted = false;
+  };
+} // namespace
+
 EZ_CREATE_SIMPLE_TEST_GROUP(Memory);
 
 EZ_CREATE_SIMPLE_TEST(Memory, Allocator)
@@ -167,6 +222,243 @@ EZ_CREATE_SIMPLE_TEST(Memory, Allocator)
     EZ_TEST_BOOL(stats.m_uiAllocationSize == 0);
   }
 
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "ThreadCachingAllocator")
+  {
+    ezThreadCachingAllocator allocator("TestThreadCachingAllocator");
+
+    ezDynamicArray<void*> allocations;
+    ezDynamicArray<size_t> sizes;
+
+    // small and large sizes with different alignments
+    for (ezUInt32 i = 0; i < 2000; ++i)
+    {
+      const size_t uiSize = (i % 10 == 0) ? 2000 + i * 3 : 1 + (i * 13) % ezAllocPolicyThreadCaching::MaxSmallSize;
+      const size_t uiAlign = size_t(4) << (i % 4);
+
+      void* pPtr = allocator.Allocate(uiSize, uiAlign);
+      EZ_TEST_BOOL(ezMemoryUtils::IsAligned(pPtr, uiAlign));
+      EZ_TEST_BOOL(allocator.AllocatedSize(pPtr) >= uiSize);
+
+      ezMemoryUtils::PatternFill(static_cast<ezUInt8*>(pPtr), static_cast<ezUInt8>(i), uiSize);
+
+      allocations.PushBack(pPtr);
+      sizes.PushBack(uiSize);
+    }
+
+    {
+      // the thread cache reports to the tracker on its own, at most one report interval behind
+      const ezAllocator::Stats& trackedStats = ezMemoryTracker::GetAllocatorStats(allocator.GetId());
+      EZ_TEST_BOOL(trackedStats.m_uiNumAllocations > 1900 && trackedStats.m_uiNumAllocations <= 2000);
+      EZ_TEST_BOOL(trackedStats.m_uiPerFrameAllocationSize >= trackedStats.m_uiAllocationSize);
+
+      ezAllocator::Stats stats = allocator.GetStats();
+      EZ_TEST_INT(stats.m_uiNumAllocations, 2000);
+      EZ_TEST_INT(stats.m_uiNumDeallocations, 0);
+      EZ_TEST_BOOL(stats.m_uiAllocationSize >= 2000);
+    }
+
+    // no allocation may overlap with another one
+    bool bAllIntact = true;
+    for (ezUInt32 i = 0; i < allocations.GetCount(); ++i)
+    {
+      const ezUInt8* pBytes = static_cast<const ezUInt8*>(allocations[i]);
+      for (size_t j = 0; j < sizes[i]; ++j)
+      {
+        bAllIntact &= (pBytes[j] == static_cast<ezUInt8>(i));
+      }
+    }
+    EZ_TEST_BOOL(bAllIntact);
+
+    // freed blocks are reused
+    void* pFirst = allocations[1];
+    const size_t uiFirstSize = sizes[1];
+    allocator.Deallocate(pFirst);
+    EZ_TEST_BOOL(allocator.Allocate(uiFirstSize, 8) == pFirst);
+
+    // hand half of the blocks to other threads to free them there
+    const ezUInt32 uiNumThreads = 4;
+    const ezUInt32 uiPerThread = allocations.GetCount() / 2 / uiNumThreads;
+
+    ezDynamicArray<ThreadCachingTestThread*> threads;
+    for (ezUInt32 t = 0; t < uiNumThreads; ++t)
+    {
+      threads.PushBack(EZ_DEFAULT_NEW(ThreadCachingTestThread, &allocator, allocations.GetArrayPtr().GetSubArray(t * uiPerThread, uiPerThread)));
+      threads.PeekBack()->Start();
+    }
+
+    for (ezUInt32 i = uiNumThreads * uiPerThread; i < allocations.GetCount(); ++i)
+    {
+      allocator.Deallocate(allocations[i]);
+    }
+
+    for (ThreadCachingTestThread* pThread : threads)
+    {
+      pThread->Join();
+      EZ_TEST_BOOL(!pThread->m_bCorrupted);
+      EZ_DEFAULT_DELETE(pThread);
+    }
+
+    {
+      ezAllocator::Stats stats = allocator.GetStats();
+      EZ_TEST_INT(stats.m_uiNumAllocations, stats.m_uiNumDeallocations);
+      EZ_TEST_INT(stats.m_uiAllocationSize, 0);
+      EZ_TEST_INT(stats.m_uiNumAllocations, 2001 + uiNumThreads * 64 * 256);
+
+      EZ_TEST_INT(ezMemoryTracker::GetAllocatorStats(allocator.GetId()).m_uiNumAllocations, stats.m_uiNumAllocations);
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Sampled Tracking")
+  {
+    const ezUInt32 uiPrevSamplingInterval = ezMemoryTracker::GetSamplingInterval();
+
+    ezAllocatorWithPolicy<ezAllocPolicyHeap, ezAllocatorTrackingMode::AllocationStatsSampled> allocator("SampledTest");
+
+    auto SumProfile = [&](const ezHeapProfile& profile, ezInt64& out_iNumSamples, ezInt64& out_iSize)
+    {
+      out_iNumSamples = 0;
+      out_iSize = 0;
+      for (const ezHeapProfile::Entry& entry : profile.GetEntries())
+      {
+        if (entry.m_AllocatorId == allocator.GetId())
+        {
+          out_iNumSamples += entry.m_iNumSamples;
+          out_iSize += entry.m_iEstimatedSize;
+        }
+      }
+    };
+
+    // an interval of 1 records every allocation
+    ezMemoryTracker::SetSamplingInterval(1);
+    {
+      void* allocations[100];
+      for (ezUInt32 i = 0; i < EZ_ARRAY_SIZE(allocations); ++i)
+      {
+        allocations[i] = allocator.Allocate(64, 8);
+      }
+
+      ezAllocator::Stats stats = allocator.GetStats();
+      EZ_TEST_INT(stats.m_uiNumAllocations, 100);
+      EZ_TEST_INT(stats.m_uiNumDeallocations, 0);
+      EZ_TEST_INT(stats.m_uiAllocationSize, 6400);
+      EZ_TEST_INT(stats.m_uiPerFrameAllocationSize, 6400);
+
+      // individual allocations are not tracked
+      EZ_TEST_INT(allocator.AllocatedSize(allocations[0]), 0);
+
+      ezHeapProfile fullProfile;
+      fullProfile.Capture();
+
+      ezInt64 iNumSamples = 0;
+      ezInt64 iSize = 0;
+      SumProfile(fullProfile, iNumSamples, iSize);
+      EZ_TEST_INT(iNumSamples, 100);
+      EZ_TEST_INT(iSize, 6400);
+
+      for (ezUInt32 i = 0; i < 50; ++i)
+      {
+        allocator.Deallocate(allocations[i]);
+      }
+
+      ezHeapProfile halfProfile;
+      halfProfile.Capture();
+
+      ezHeapProfile difference;
+      difference.MakeDifference(fullProfile, halfProfile);
+      SumProfile(difference, iNumSamples, iSize);
+      EZ_TEST_INT(iNumSamples, -50);
+      EZ_TEST_INT(iSize, -3200);
+
+      ezStringBuilder sPrinted;
+      halfProfile.Print([&](const char* szText)
+        { sPrinted.Append(szText); });
+      EZ_TEST_BOOL(sPrinted.FindSubString("allocator 'SampledTest'") != nullptr);
+
+      for (ezUInt32 i = 50; i < EZ_ARRAY_SIZE(allocations); ++i)
+      {
+        allocator.Deallocate(allocations[i]);
+      }
+
+      stats = allocator.GetStats();
+      EZ_TEST_INT(stats.m_uiNumDeallocations, 100);
+      EZ_TEST_INT(stats.m_uiAllocationSize, 0);
+
+      ezHeapProfile emptyProfile;
+      emptyProfile.Capture();
+      SumProfile(emptyProfile, iNumSamples, iSize);
+      EZ_TEST_INT(iNumSamples, 0);
+    }
+
+    // the estimate of the live memory should be close to the real value
+    ezMemoryTracker::SetSamplingInterval(16 * 1024);
+    {
+      ezDynamicArray<void*> allocations;
+      for (ezUInt32 i = 0; i < 4096; ++i)
+      {
+        allocations.PushBack(allocator.Allocate(1024, 8));
+      }
+
+      const ezAllocator::Stats stats = allocator.GetStats();
+      EZ_TEST_INT(stats.m_uiNumAllocations, 4196);
+      EZ_TEST_DOUBLE(static_cast<double>(stats.m_uiAllocationSize), 4.0 * 1024 * 1024, 1024 * 1024);
+
+      for (void* pPtr : allocations)
+      {
+        allocator.Deallocate(pPtr);
+      }
+
+      EZ_TEST_INT(allocator.GetStats().m_uiAllocationSize, 0);
+    }
+
+    // allocating and freeing from several threads at once
+    ezMemoryTracker::SetSamplingInterval(256);
+    {
+      constexpr ezUInt32 uiNumThreads = 4;
+
+      ezDynamicArray<void*> foreignAllocations;
+      for (ezUInt32 i = 0; i < uiNumThreads * 100; ++i)
+      {
+        foreignAllocations.PushBack(allocator.Allocate(32 + i, 8));
+      }
+
+      ezDynamicArray<ThreadCachingTestThread*> threads;
+      for (ezUInt32 i = 0; i < uiNumThreads; ++i)
+      {
+        threads.PushBack(EZ_DEFAULT_NEW(ThreadCachingTestThread, &allocator, foreignAllocations.GetArrayPtr().GetSubArray(i * 100, 100)));
+        threads.PeekBack()->Start();
+      }
+
+      for (ThreadCachingTestThread* pThread : threads)
+      {
+        pThread->Join();
+        EZ_TEST_BOOL(!pThread->m_bCorrupted);
+        EZ_DEFAULT_DELETE(pThread);
+      }
+
+      const ezAllocator::Stats stats = allocator.GetStats();
+      EZ_TEST_INT(stats.m_uiNumAllocations, stats.m_uiNumDeallocations);
+      EZ_TEST_INT(stats.m_uiAllocationSize, 0);
+    }
+
+    // a nested allocator may hand out the same address as its parent, freeing it must not remove the parent's sample
+    ezMemoryTracker::SetSamplingInterval(1);
+    {
+      ezAllocatorWithPolicy<ezAllocPolicyHeap, ezAllocatorTrackingMode::AllocationStatsSampled> nestedAllocator("SampledNestedTest");
+
+      void* pPtr = allocator.Allocate(64, 8);
+      ezMemoryTracker::AddAllocation(nestedAllocator.GetId(), ezAllocatorTrackingMode::AllocationStatsSampled, pPtr, 32, 8, ezTime::MakeZero());
+      ezMemoryTracker::RemoveAllocation(nestedAllocator.GetId(), pPtr);
+
+      EZ_TEST_INT(nestedAllocator.GetStats().m_uiAllocationSize, 0);
+      EZ_TEST_INT(allocator.GetStats().m_uiAllocationSize, 64);
+
+      allocator.Deallocate(pPtr);
+      EZ_TEST_INT(allocator.GetStats().m_uiAllocationSize, 0);
+    }
+
+    ezMemoryTracker::SetSamplingInterval(uiPrevSamplingInterval);
+  }
+
   EZ_TEST_BLOCK(ezTestBlock::Enabled, "StackAllocator")
   {
     ezLinearAllocator<> allocator("TestStackAllocator", ezFoundation::GetAlignedAllocator());
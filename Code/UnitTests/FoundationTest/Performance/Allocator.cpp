@@ -0,0 +1,141 @@
+#include <FoundationTest/FoundationTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Memory/CommonAllocators.h>
+#include <Foundation/Memory/ThreadCachingAllocator.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Time/Time.h>
+
+// Enable when needed
+#define EZ_PERFORMANCE_TESTS_STATE ezTestBlock::DisabledNoWarning
+
+namespace
+{
+  /// Mimics container growth: keeps a window of live allocations with mixed sizes and replaces the oldest one in every step.
+  class ezAllocatorStressThread : public ezThread
+  {
+  public:
+    ezAllocatorStressThread(ezAllocator* pAllocator, ezUInt32 uiNumAllocations, ezUInt32 uiSeed)
+      : ezThread("ezAllocatorStressThread")
+      , m_pAllocator(pAllocator)
+      , m_uiNumAllocations(uiNumAllocations)
+      , m_uiSeed(uiSeed)
+    {
+    }
+
+    virtual ezUInt32 Run() override
+    {
+      constexpr ezUInt32 uiWindowSize = 128;
+      void* window[uiWindowSize] = {};
+
+      ezUInt32 uiRandom = m_uiSeed;
+      for (ezUInt32 i = 0; i < m_uiNumAllocations; ++i)
+      {
+        uiRandom = uiRandom * 1664525u + 1013904223u;
+
+        // mostly small allocations, some medium sized ones
+        const size_t uiSize = (uiRandom >> 28) == 0 ? 256 + (uiRandom >> 16) % 1792 : 8 + (uiRandom >> 16) % 120;
+
+        void*& pSlot = window[i % uiWindowSize];
+        if (pSlot != nullptr)
+        {
+          m_pAllocator->Deallocate(pSlot);
+        }
+        pSlot = m_pAllocator->Allocate(uiSize, 8);
+        *static_cast<ezUInt32*>(pSlot) = i;
+      }
+
+      for (void* pPtr : window)
+      {
+        if (pPtr != nullptr)
+        {
+          m_pAllocator->Deallocate(pPtr);
+        }
+      }
+
+      return 0;
+    }
+
+  private:
+    ezAllocator* m_pAllocator;
+    ezUInt32 m_uiNumAllocations;
+    ezUInt32 m_uiSeed;
+  };
+
+  ezTime MeasureAllocatorStress(ezAllocator* pAllocator, ezUInt32 uiNumThreads, ezUInt32 uiTotalAllocations)
+  {
+    ezDynamicArray<ezAllocatorStressThread*> threads;
+    for (ezUInt32 i = 0; i < uiNumThreads; ++i)
+    {
+      threads.PushBack(EZ_DEFAULT_NEW(ezAllocatorStressThread, pAllocator, uiTotalAllocations / uiNumThreads, i + 1));
+    }
+
+    const ezTime tStart = ezTime::Now();
+
+    for (ezAllocatorStressThread* pThread : threads)
+    {
+      pThread->Start();
+    }
+
+    for (ezAllocatorStressThread* pThread : threads)
+    {
+      pThread->Join();
+    }
+
+    const ezTime tDuration = ezTime::Now() - tStart;
+
+    for (ezAllocatorStressThread* pThread : threads)
+    {
+      EZ_DEFAULT_DELETE(pThread);
+    }
+
+    return tDuration;
+  }
+} // namespace
+
+EZ_CREATE_SIMPLE_TEST(Performance, Allocator)
+{
+  EZ_TEST_BLOCK(EZ_PERFORMANCE_TESTS_STATE, "Allocator Stress")
+  {
+    constexpr ezUInt32 uiTotalAllocations = 1024 * 1024;
+
+    ezHeapAllocator heapAllocator("Stress Heap");
+    ezAllocatorWithPolicy<ezAllocPolicyHeap, ezAllocatorTrackingMode::AllocationStats> heapStatsAllocator("Stress Heap (Stats)");
+    ezAllocatorWithPolicy<ezAllocPolicyHeap, ezAllocatorTrackingMode::AllocationStatsSampled> heapSampledAllocator("Stress Heap (Sampled)");
+    ezThreadCachingAllocator threadCachingAllocator("Stress ThreadCaching");
+
+    struct Entry
+    {
+      EZ_DECLARE_POD_TYPE();
+
+      const char* m_szName;
+      ezAllocator* m_pAllocator;
+    };
+
+    ezHybridArray<Entry, 8> allocators;
+    allocators.PushBack({"Heap", &heapAllocator});
+    allocators.PushBack({"Heap (stats only)", &heapStatsAllocator});
+    allocators.PushBack({"Heap (sampled)", &heapSampledAllocator});
+#if EZ_ENABLED(EZ_PLATFORM_WINDOWS_DESKTOP)
+    ezGuardingAllocator guardingAllocator("Stress Guarding");
+    allocators.PushBack({"Guarding", &guardingAllocator});
+#endif
+    allocators.PushBack({"ThreadCaching", &threadCachingAllocator});
+
+    for (ezUInt32 uiNumThreads = 1; uiNumThreads <= 32; uiNumThreads *= 2)
+    {
+      for (const Entry& entry : allocators)
+      {
+        // the guarding allocator is far too slow for the full run
+        const ezUInt32 uiNumAllocations = ezStringUtils::IsEqual(entry.m_szName, "Guarding") ? uiTotalAllocations / 64 : uiTotalAllocations;
+
+        const ezTime tDuration = MeasureAllocatorStress(entry.m_pAllocator, uiNumThreads, uiNumAllocations);
+
+        ezLog::Info("[test]{} threads, {}: {}ms, {} allocations/ms", ezArgU(uiNumThreads, 2), entry.m_szName, ezArgF(tDuration.GetMilliseconds(), 2),
+          ezArgF(uiNumAllocations / tDuration.GetMilliseconds(), 1));
+      }
+    }
+
+    EZ_TEST_INT(threadCachingAllocator.GetStats().m_uiAllocationSize, 0);
+  }
+}
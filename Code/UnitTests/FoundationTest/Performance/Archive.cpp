@@ -0,0 +1,275 @@
+#include <FoundationTest/FoundationTestPCH.h>
+
+#include <Foundation/IO/Archive/ArchiveReader.h>
+#include <Foundation/IO/Archive/ArchiveUtils.h>
+#include <Foundation/IO/CompressedStreamZstd.h>
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/IO/OSFile.h>
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Time/Stopwatch.h>
+
+// Enable when needed
+#define EZ_PERFORMANCE_TESTS_STATE ezTestBlock::DisabledNoWarning
+
+#if EZ_ENABLED(EZ_SUPPORTS_MEMORY_MAPPED_FILE)
+
+namespace
+{
+  /// Typical small assets: between 256 bytes and 8 KB, somewhat compressible.
+  void GenerateAssetData(ezUInt32 uiEntryIdx, ezDynamicArray<ezUInt8>& out_data)
+  {
+    out_data.SetCountUninitialized(256 + (uiEntryIdx * 7919) % (8 * 1024));
+
+    ezUInt32 uiState = uiEntryIdx * 2654435761u + 1;
+    for (ezUInt32 i = 0; i < out_data.GetCount(); ++i)
+    {
+      if (i % 4 == 0)
+      {
+        uiState = uiState * 1664525u + 1013904223u;
+      }
+
+      out_data[i] = static_cast<ezUInt8>((uiState >> 24) & 0x3F);
+    }
+  }
+
+  /// Writes an archive with the given number of entries, every \a uiUncompressedEvery'th entry is stored uncompressed.
+  ezResult WriteSyntheticArchive(ezStringView sFile, ezUInt32 uiNumEntries, ezUInt32 uiUncompressedEvery)
+  {
+    ezContiguousMemoryStreamStorage storage;
+    ezMemoryStreamWriter file(&storage);
+    EZ_SUCCEED_OR_RETURN(ezArchiveUtils::WriteHeader(file));
+
+    ezArchiveTOC toc;
+    ezUInt64 uiStreamSize = 0;
+    ezDynamicArray<ezUInt8> data;
+    ezStringBuilder sPath;
+
+    for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+    {
+      sPath.SetFormat("assets/folder{}/asset{}.bin", i % 64, i);
+
+      const ezUInt32 uiPathStringOffset = toc.m_AllPathStrings.GetCount();
+      toc.m_AllPathStrings.PushBackRange(ezArrayPtr<const ezUInt8>(reinterpret_cast<const ezUInt8*>(sPath.GetData()), sPath.GetElementCount() + 1));
+      toc.m_PathToEntryIndex[ezArchiveStoredString(ezHashingUtils::StringHash(sPath), uiPathStringOffset)] = toc.m_Entries.GetCount();
+
+      GenerateAssetData(i, data);
+      ezRawMemoryStreamReader source(data);
+
+      const ezArchiveCompressionMode mode = (i % uiUncompressedEvery == 0) ? ezArchiveCompressionMode::Uncompressed : ezArchiveCompressionMode::Compressed_zstd;
+      EZ_SUCCEED_OR_RETURN(ezArchiveUtils::WriteEntry(file, source, data.GetCount(), uiPathStringOffset, mode, 0, toc.m_Entries.ExpandAndGetRef(), uiStreamSize));
+    }
+
+    EZ_SUCCEED_OR_RETURN(ezArchiveUtils::AppendTOC(file, toc));
+
+    ezOSFile osFile;
+    EZ_SUCCEED_OR_RETURN(osFile.Open(sFile, ezFileOpenMode::Write));
+    return osFile.Write(storage.GetData(), storage.GetStorageSize64());
+  }
+} // namespace
+
+EZ_CREATE_SIMPLE_TEST(Performance, Archive)
+{
+  EZ_TEST_BLOCK(EZ_PERFORMANCE_TESTS_STATE, "Startup: 50k Entries")
+  {
+    constexpr ezUInt32 uiNumEntries = 50000;
+
+    ezStringBuilder sOutputFolder = ezTestFramework::GetInstance()->GetAbsOutputPath();
+    sOutputFolder.AppendPath("ArchivePerformance");
+    sOutputFolder.MakeCleanPath();
+    ezOSFile::CreateDirectoryStructure(sOutputFolder).IgnoreResult();
+
+    const ezStringBuilder sArchiveFile(sOutputFolder, "/Synthetic.ezArchive");
+
+    ezStopwatch sw;
+    EZ_TEST_BOOL(WriteSyntheticArchive(sArchiveFile, uiNumEntries, 4).Succeeded());
+    ezLog::Info("[test]Writing the archive: {}ms", ezArgF(sw.GetRunningTotal().GetMilliseconds(), 1));
+
+    sw.StopAndReset();
+    sw.Resume();
+
+    ezArchiveReader reader;
+    if (!EZ_TEST_BOOL(reader.OpenArchive(sArchiveFile).Succeeded()))
+      return;
+
+    ezLog::Info("[test]Opening the archive: {}ms", ezArgF(sw.GetRunningTotal().GetMilliseconds(), 2));
+
+    const ezArchiveTOC& toc = reader.GetArchiveTOC();
+
+    // all entries are read into buffers that already exist, so only the reading itself is measured
+    ezUInt64 uiTotalSize = 0;
+    ezDynamicArray<ezUInt32> offsets;
+    offsets.SetCountUninitialized(uiNumEntries);
+    for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+    {
+      offsets[i] = static_cast<ezUInt32>(uiTotalSize);
+      uiTotalSize += toc.m_Entries[i].m_uiUncompressedDataSize;
+    }
+
+    ezDynamicArray<ezUInt8> targetMemory;
+    targetMemory.SetCount(static_cast<ezUInt32>(uiTotalSize));
+
+    auto GetTargetBuffer = [&](ezUInt32 uiEntryIdx)
+    { return targetMemory.GetArrayPtr().GetSubArray(offsets[uiEntryIdx], static_cast<ezUInt32>(toc.m_Entries[uiEntryIdx].m_uiUncompressedDataSize)); };
+
+    const double fTotalMB = uiTotalSize / (1024.0 * 1024.0);
+
+    {
+      sw.StopAndReset();
+      sw.Resume();
+
+      for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+      {
+        ezArrayPtr<ezUInt8> target = GetTargetBuffer(i);
+        ezUniquePtr<ezStreamReader> pReader = reader.CreateEntryReader(i);
+        pReader->ReadBytes(target.GetPtr(), target.GetCount());
+      }
+
+      const ezTime t = sw.GetRunningTotal();
+      ezLog::Info("[test]Stream readers (serial): {}ms, {} MB/s", ezArgF(t.GetMilliseconds(), 1), ezArgF(fTotalMB / t.GetSeconds(), 1));
+    }
+
+    {
+      sw.StopAndReset();
+      sw.Resume();
+
+      for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+      {
+        reader.ReadEntry(i, GetTargetBuffer(i)).IgnoreResult();
+      }
+
+      const ezTime t = sw.GetRunningTotal();
+      ezLog::Info("[test]ReadEntry (serial): {}ms, {} MB/s", ezArgF(t.GetMilliseconds(), 1), ezArgF(fTotalMB / t.GetSeconds(), 1));
+    }
+
+    {
+      ezDynamicArray<ezArchiveReader::EntryRequest> requests;
+      requests.SetCount(uiNumEntries);
+      for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+      {
+        requests[i].m_uiEntryIdx = i;
+        requests[i].m_TargetBuffer = GetTargetBuffer(i);
+      }
+
+      // warm up, so that the adaptive batch size is known
+      EZ_TEST_BOOL(reader.ReadEntries(requests).Succeeded());
+
+      sw.StopAndReset();
+      sw.Resume();
+
+      EZ_TEST_BOOL(reader.ReadEntries(requests).Succeeded());
+
+      const ezTime t = sw.GetRunningTotal();
+      ezLog::Info("[test]ReadEntries (parallel): {}ms, {} MB/s", ezArgF(t.GetMilliseconds(), 1), ezArgF(fTotalMB / t.GetSeconds(), 1));
+    }
+
+    {
+      sw.StopAndReset();
+      sw.Resume();
+
+      ezUInt64 uiViewBytes = 0;
+      ezUInt32 uiNumViews = 0;
+      ezArrayPtr<const ezUInt8> view;
+
+      for (ezUInt32 i = 0; i < uiNumEntries; ++i)
+      {
+        if (reader.GetUncompressedEntryData(i, view).Succeeded())
+        {
+          uiViewBytes += view.GetCount();
+          ++uiNumViews;
+        }
+      }
+
+      const ezTime t = sw.GetRunningTotal();
+      ezLog::Info("[test]Zero-copy views: {} entries, {} KB in {}ms", uiNumViews, uiViewBytes / 1024, ezArgF(t.GetMilliseconds(), 3));
+    }
+  }
+
+#  ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+  EZ_TEST_BLOCK(EZ_PERFORMANCE_TESTS_STATE, "Random Access: 4 KB reads from a 64 MB entry")
+  {
+    ezDynamicArray<ezUInt8> data;
+    data.SetCountUninitialized(64 * 1024 * 1024);
+
+    // the generator only produces small assets, so the data is put together from many of them
+    {
+      ezDynamicArray<ezUInt8> piece;
+      for (ezUInt32 i = 0; i < data.GetCount(); i += piece.GetCount())
+      {
+        GenerateAssetData(i / 1024, piece);
+        piece.SetCount(ezMath::Min(piece.GetCount(), data.GetCount() - i));
+        ezMemoryUtils::Copy(data.GetData() + i, piece.GetData(), piece.GetCount());
+      }
+    }
+
+    constexpr ezUInt32 uiReadSize = 4 * 1024;
+
+    ezDynamicArray<ezUInt32> readOffsets;
+    {
+      ezUInt32 uiState = 42;
+      for (ezUInt32 i = 0; i < 1000; ++i)
+      {
+        uiState = uiState * 1664525u + 1013904223u;
+        readOffsets.PushBack(uiState % (data.GetCount() - uiReadSize));
+      }
+    }
+
+    ezUInt8 readBuffer[uiReadSize];
+
+    for (ezArchiveCompressionMode mode : {ezArchiveCompressionMode::Compressed_zstd, ezArchiveCompressionMode::Compressed_zstd_seekable})
+    {
+      const char* szMode = mode == ezArchiveCompressionMode::Compressed_zstd ? "zstd" : "zstd seekable";
+
+      ezContiguousMemoryStreamStorage storage;
+      ezMemoryStreamWriter writer(&storage);
+      ezRawMemoryStreamReader source(data);
+
+      ezArchiveEntry entry;
+      ezUInt64 uiStreamSize = 0;
+
+      ezStopwatch sw;
+      EZ_TEST_BOOL(ezArchiveUtils::WriteEntry(writer, source, data.GetCount(), 0, mode, 0, entry, uiStreamSize).Succeeded());
+      ezLog::Info("[test]{}: Compressed 64 MB to {} KB in {}ms", szMode, entry.m_uiStoredDataSize / 1024, ezArgF(sw.GetRunningTotal().GetMilliseconds(), 1));
+
+      // without a jump table every read has to decompress everything in front of it, so only a few reads are done
+      const ezUInt32 uiNumReads = mode == ezArchiveCompressionMode::Compressed_zstd ? 10 : readOffsets.GetCount();
+
+      {
+        sw.StopAndReset();
+        sw.Resume();
+
+        for (ezUInt32 i = 0; i < uiNumReads; ++i)
+        {
+          ezUniquePtr<ezStreamReader> pReader = ezArchiveUtils::CreateEntryReader(entry, storage.GetData());
+          pReader->SkipBytes(readOffsets[i]);
+          pReader->ReadBytes(readBuffer, uiReadSize);
+
+          EZ_TEST_BOOL(ezMemoryUtils::IsEqual(readBuffer, data.GetData() + readOffsets[i], uiReadSize));
+        }
+
+        const ezTime t = sw.GetRunningTotal();
+        ezLog::Info("[test]{}: {} random reads with a new reader each: {}ms, {}us per read", szMode, uiNumReads, ezArgF(t.GetMilliseconds(), 1), ezArgF(t.GetMicroseconds() / uiNumReads, 1));
+      }
+
+      if (mode == ezArchiveCompressionMode::Compressed_zstd_seekable)
+      {
+        ezCompressedStreamReaderZstdSeekable reader;
+        EZ_TEST_BOOL(reader.SetInputData(ezArrayPtr<const ezUInt8>(storage.GetData(), storage.GetStorageSize32())).Succeeded());
+
+        sw.StopAndReset();
+        sw.Resume();
+
+        for (ezUInt32 i = 0; i < uiNumReads; ++i)
+        {
+          reader.SetReadPosition(readOffsets[i]);
+          reader.ReadBytes(readBuffer, uiReadSize);
+        }
+
+        const ezTime t = sw.GetRunningTotal();
+        ezLog::Info("[test]{}: {} random reads with one reader: {}ms, {}us per read", szMode, uiNumReads, ezArgF(t.GetMilliseconds(), 1), ezArgF(t.GetMicroseconds() / uiNumReads, 1));
+      }
+    }
+  }
+#  endif
+}
+
+#endif
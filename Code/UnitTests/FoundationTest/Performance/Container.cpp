@@ -1,6 +1,8 @@
 #include <FoundationTest/FoundationTestPCH.h>
 
 #include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/FlatHashTable.h>
+#include <Foundation/Containers/HashTable.h>
 #include <Foundation/Logging/Log.h>
 #include <Foundation/Reflection/Reflection.h>
 #include <Foundation/Strings/String.h>
@@ -77,6 +79,45 @@ namespace
   ezUInt32 SomeBigObject::destructionCount = 0;
 } // namespace
 
+namespace
+{
+  template <typename Table>
+  void HashTableBenchmark(const char* szName, ezArrayPtr<const ezUInt64> keys, ezArrayPtr<const ezUInt64> lookupOrder, ezArrayPtr<const ezUInt64> missingKeys)
+  {
+    ezUInt64 sum = 0;
+    Table table;
+
+    ezTime t0 = ezTime::Now();
+    for (ezUInt32 i = 0; i < keys.GetCount(); ++i)
+    {
+      table.Insert(keys[i], i);
+    }
+
+    ezTime t1 = ezTime::Now();
+    for (ezUInt64 key : lookupOrder)
+    {
+      sum += *table.GetValue(key);
+    }
+
+    ezTime t2 = ezTime::Now();
+    for (ezUInt64 key : missingKeys)
+    {
+      sum += table.Contains(key) ? 1 : 0;
+    }
+
+    ezTime t3 = ezTime::Now();
+    for (ezUInt64 key : lookupOrder)
+    {
+      sum += table.Remove(key) ? 1 : 0;
+    }
+
+    ezTime t4 = ezTime::Now();
+
+    const double fNumKeys = static_cast<double>(keys.GetCount());
+    ezLog::Info("[test]{0} size = {1}: insert {2}ns, lookup {3}ns, lookup (missing) {4}ns, erase {5}ns", szName, keys.GetCount(), ezArgF((t1 - t0).GetNanoseconds() / fNumKeys, 1), ezArgF((t2 - t1).GetNanoseconds() / fNumKeys, 1), ezArgF((t3 - t2).GetNanoseconds() / fNumKeys, 1), ezArgF((t4 - t3).GetNanoseconds() / fNumKeys, 1), sum);
+  }
+} // namespace
+
 // Enable when needed
 #define EZ_PERFORMANCE_TESTS_STATE ezTestBlock::DisabledNoWarning
 
@@ -419,4 +460,47 @@ EZ_CREATE_SIMPLE_TEST(Performance, Container)
         ezArgF((t1 - t0).GetMilliseconds() / static_cast<double>(NUM_SAMPLES), 4), sum);
     }
   }
+
+  EZ_TEST_BLOCK(EZ_PERFORMANCE_TESTS_STATE, "ezHashTable vs. ezFlatHashTable")
+  {
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEBUG)
+    const ezUInt32 uiMaxSize = 1000000;
+#else
+    const ezUInt32 uiMaxSize = 10000000;
+#endif
+
+    ezDynamicArray<ezUInt64> keys;
+    ezDynamicArray<ezUInt64> lookupOrder;
+    ezDynamicArray<ezUInt64> missingKeys;
+
+    ezUInt64 uiSeed = 0x853C49E6748FEA9Bull;
+    auto NextRandom = [&]()
+    {
+      uiSeed = uiSeed * 6364136223846793005ull + 1442695040888963407ull;
+      return uiSeed;
+    };
+
+    for (ezUInt32 uiSize = 1000; uiSize <= uiMaxSize; uiSize *= 10)
+    {
+      keys.Clear();
+      missingKeys.Clear();
+
+      // odd keys are inserted, even keys are guaranteed to be missing
+      for (ezUInt32 i = 0; i < uiSize; ++i)
+      {
+        keys.PushBack(NextRandom() | 1);
+        missingKeys.PushBack(NextRandom() & ~1ull);
+      }
+
+      // look up and erase in a different order than inserted
+      lookupOrder = keys;
+      for (ezUInt32 i = uiSize - 1; i > 0; --i)
+      {
+        ezMath::Swap(lookupOrder[i], lookupOrder[static_cast<ezUInt32>(NextRandom() % (i + 1))]);
+      }
+
+      HashTableBenchmark<ezHashTable<ezUInt64, ezUInt32>>("ezHashTable<ezUInt64, ezUInt32>", keys, lookupOrder, missingKeys);
+      HashTableBenchmark<ezFlatHashTable<ezUInt64, ezUInt32>>("ezFlatHashTable<ezUInt64, ezUInt32>", keys, lookupOrder, missingKeys);
+    }
+  }
 }
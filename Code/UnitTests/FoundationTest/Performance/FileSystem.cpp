@@ -0,0 +1,278 @@
+#include <FoundationTest/FoundationTestPCH.h>
+
+#include <Foundation/IO/FileSystem/DataDirTypeFolder.h>
+#include <Foundation/IO/FileSystem/FileReader.h>
+#include <Foundation/IO/FileSystem/FileSystem.h>
+#include <Foundation/IO/OSFile.h>
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Threading/ThreadUtils.h>
+#include <Foundation/Time/Time.h>
+
+// Enable when needed
+#define EZ_PERFORMANCE_TESTS_STATE ezTestBlock::DisabledNoWarning
+
+namespace
+{
+  constexpr ezUInt32 s_uiNumFileSystemPerfFiles = 1000;
+
+  /// Mimics resource loader threads that open files by their relative path.
+  class ezFileOpenThread : public ezThread
+  {
+  public:
+    ezFileOpenThread(ezUInt32 uiNumOpens, ezUInt32 uiSeed)
+      : ezThread("ezFileOpenThread")
+      , m_uiNumOpens(uiNumOpens)
+      , m_uiSeed(uiSeed)
+    {
+    }
+
+    virtual ezUInt32 Run() override
+    {
+      ezUInt32 uiRandom = m_uiSeed;
+      ezStringBuilder sFile;
+
+      for (ezUInt32 i = 0; i < m_uiNumOpens; ++i)
+      {
+        uiRandom = uiRandom * 1664525u + 1013904223u;
+        const ezUInt32 uiFile = (uiRandom >> 8) % s_uiNumFileSystemPerfFiles;
+        sFile.SetFormat("Folder{}/File{}.txt", uiFile % 16, uiFile);
+
+        ezFileReader file;
+        if (file.Open(sFile).Succeeded())
+        {
+          ++m_uiNumOpened;
+        }
+      }
+
+      return 0;
+    }
+
+    ezUInt32 m_uiNumOpened = 0;
+
+  private:
+    ezUInt32 m_uiNumOpens;
+    ezUInt32 m_uiSeed;
+  };
+
+  ezTime MeasureFileOpens(ezUInt32 uiNumThreads, ezUInt32 uiTotalOpens, ezUInt32& out_uiNumOpened)
+  {
+    ezDynamicArray<ezFileOpenThread*> threads;
+    for (ezUInt32 i = 0; i < uiNumThreads; ++i)
+    {
+      threads.PushBack(EZ_DEFAULT_NEW(ezFileOpenThread, uiTotalOpens / uiNumThreads, i + 1));
+    }
+
+    const ezTime tStart = ezTime::Now();
+
+    for (ezFileOpenThread* pThread : threads)
+    {
+      pThread->Start();
+    }
+
+    for (ezFileOpenThread* pThread : threads)
+    {
+      pThread->Join();
+    }
+
+    const ezTime tDuration = ezTime::Now() - tStart;
+
+    out_uiNumOpened = 0;
+    for (ezFileOpenThread* pThread : threads)
+    {
+      out_uiNumOpened += pThread->m_uiNumOpened;
+      EZ_DEFAULT_DELETE(pThread);
+    }
+
+    return tDuration;
+  }
+
+  constexpr ezUInt32 s_uiNumFileSystemPerfEmptyDataDirs = 4;
+
+  ezResult CreateFileSystemPerfData(ezStringView sRootFolder)
+  {
+    ezStringBuilder sFile;
+    for (ezUInt32 i = 0; i < s_uiNumFileSystemPerfFiles; ++i)
+    {
+      sFile.SetFormat("{}/Data/Folder{}/File{}.txt", sRootFolder, i % 16, i);
+
+      ezOSFile file;
+      EZ_SUCCEED_OR_RETURN(file.Open(sFile, ezFileOpenMode::Write));
+      EZ_SUCCEED_OR_RETURN(file.Write(sFile.GetData(), sFile.GetElementCount()));
+    }
+
+    for (ezUInt32 i = 0; i < s_uiNumFileSystemPerfEmptyDataDirs; ++i)
+    {
+      sFile.SetFormat("{}/Empty{}", sRootFolder, i);
+      EZ_SUCCEED_OR_RETURN(ezOSFile::CreateDirectoryStructure(sFile));
+    }
+
+    return EZ_SUCCESS;
+  }
+
+  ezResult MountFileSystemPerfData(ezStringView sRootFolder)
+  {
+    // the data directories that are added last are searched first, so every file open first misses in all the empty directories
+    ezStringBuilder sDataDir;
+    sDataDir.SetFormat("{}/Data", sRootFolder);
+    EZ_SUCCEED_OR_RETURN(ezFileSystem::AddDataDirectory(sDataDir, "FileSystemPerf"));
+
+    for (ezUInt32 i = 0; i < s_uiNumFileSystemPerfEmptyDataDirs; ++i)
+    {
+      sDataDir.SetFormat("{}/Empty{}", sRootFolder, i);
+      EZ_SUCCEED_OR_RETURN(ezFileSystem::AddDataDirectory(sDataDir, "FileSystemPerf"));
+    }
+
+    return EZ_SUCCESS;
+  }
+
+  ezUInt32 s_uiNumOSFileLookups = 0;
+
+  void CountOSFileLookups(const ezOSFile::EventData& e)
+  {
+    switch (e.m_EventType)
+    {
+      case ezOSFile::EventType::FileOpen:
+      case ezOSFile::EventType::FileExists:
+      case ezOSFile::EventType::DirectoryExists:
+      case ezOSFile::EventType::FileStat:
+        ++s_uiNumOSFileLookups;
+        break;
+
+      default:
+        break;
+    }
+  }
+} // namespace
+
+EZ_CREATE_SIMPLE_TEST(Performance, FileSystem)
+{
+  EZ_TEST_BLOCK(EZ_PERFORMANCE_TESTS_STATE, "Parallel File Open")
+  {
+    constexpr ezUInt32 uiTotalOpens = 100000;
+
+    ezStringBuilder sRootFolder = ezTestFramework::GetInstance()->GetAbsOutputPath();
+    sRootFolder.AppendPath("FileSystemPerf");
+    sRootFolder.MakeCleanPath();
+
+    if (!EZ_TEST_RESULT(CreateFileSystemPerfData(sRootFolder)))
+      return;
+
+    // the indexed data directories are watched, so this includes whatever it costs to keep them up to date
+    for (bool bIndexed : {false, true})
+    {
+      ezFileSystem::ClearAllDataDirectoryFactories();
+      ezFileSystem::RegisterDataDirectoryFactory(bIndexed ? ezDataDirectory::FolderType::IndexedFactory : ezDataDirectory::FolderType::Factory);
+      EZ_TEST_RESULT(MountFileSystemPerfData(sRootFolder));
+
+      for (ezUInt32 uiNumThreads = 1; uiNumThreads <= 16; uiNumThreads *= 2)
+      {
+        ezUInt32 uiNumOpened = 0;
+        const ezTime tDuration = MeasureFileOpens(uiNumThreads, uiTotalOpens, uiNumOpened);
+
+        EZ_TEST_INT(uiNumOpened, (uiTotalOpens / uiNumThreads) * uiNumThreads);
+
+        ezLog::Info("[test]{}{} threads, {} data directories: {}ms, {} file opens/ms", bIndexed ? "Indexed, " : "", ezArgU(uiNumThreads, 2), s_uiNumFileSystemPerfEmptyDataDirs + 1,
+          ezArgF(tDuration.GetMilliseconds(), 2), ezArgF(uiNumOpened / tDuration.GetMilliseconds(), 1));
+      }
+
+      EZ_TEST_INT(ezFileSystem::RemoveDataDirectoryGroup("FileSystemPerf"), s_uiNumFileSystemPerfEmptyDataDirs + 1);
+    }
+
+    ezFileSystem::ClearAllDataDirectoryFactories();
+    ezFileSystem::RegisterDataDirectoryFactory(ezDataDirectory::FolderType::Factory);
+    EZ_TEST_RESULT(ezOSFile::DeleteFolder(sRootFolder));
+  }
+
+  EZ_TEST_BLOCK(EZ_PERFORMANCE_TESTS_STATE, "Startup File Lookups")
+  {
+    ezStringBuilder sRootFolder = ezTestFramework::GetInstance()->GetAbsOutputPath();
+    sRootFolder.AppendPath("FileSystemPerf");
+    sRootFolder.MakeCleanPath();
+
+    ezStringBuilder sCacheFolder = sRootFolder;
+    sCacheFolder.AppendPath("IndexCache");
+
+    if (!EZ_TEST_RESULT(CreateFileSystemPerfData(sRootFolder)))
+      return;
+
+    // indices are only stored for folders that weren't modified for a moment
+    ezThreadUtils::Sleep(ezTime::MakeFromSeconds(2.5));
+
+    struct Variant
+    {
+      const char* m_szName;
+      ezFileSystem::ezDataDirFactory m_Factory;
+      bool m_bWatch;
+      bool m_bCache;
+    };
+
+    // the first cached mount stores the index, the second one loads it
+    const Variant variants[] = {
+      {"Folder", ezDataDirectory::FolderType::Factory, false, false},
+      {"Indexed", ezDataDirectory::FolderType::IndexedFactory, true, false},
+      {"Indexed, not watched", ezDataDirectory::FolderType::IndexedFactory, false, false},
+      {"Indexed, not watched, storing index", ezDataDirectory::FolderType::IndexedFactory, false, true},
+      {"Indexed, not watched, stored index", ezDataDirectory::FolderType::IndexedFactory, false, true},
+    };
+
+    ezOSFile::AddEventHandler(CountOSFileLookups);
+
+    ezStringBuilder sFile;
+    for (const Variant& variant : variants)
+    {
+      ezDataDirectory::FolderType::s_bWatchIndexedDataDirectories = variant.m_bWatch;
+      ezDataDirectory::FolderType::s_sFileIndexCacheFolder = variant.m_bCache ? sCacheFolder.GetView() : ezStringView();
+      ezFileSystem::ClearAllDataDirectoryFactories();
+      ezFileSystem::RegisterDataDirectoryFactory(variant.m_Factory);
+
+      s_uiNumOSFileLookups = 0;
+      ezTime tStart = ezTime::Now();
+
+      EZ_TEST_RESULT(MountFileSystemPerfData(sRootFolder));
+
+      const ezTime tMount = ezTime::Now() - tStart;
+      const ezUInt32 uiNumMountLookups = s_uiNumOSFileLookups;
+
+      // every file is loaded once, like at startup
+      s_uiNumOSFileLookups = 0;
+      tStart = ezTime::Now();
+
+      for (ezUInt32 i = 0; i < s_uiNumFileSystemPerfFiles; ++i)
+      {
+        sFile.SetFormat("Folder{}/File{}.txt", i % 16, i);
+
+        ezFileReader file;
+        EZ_TEST_RESULT(file.Open(sFile));
+      }
+
+      const ezTime tOpen = ezTime::Now() - tStart;
+      const ezUInt32 uiNumOpenLookups = s_uiNumOSFileLookups;
+
+      // files that don't exist anywhere, these miss in every data directory, the time includes asking the directory watchers (if any lookup did that)
+      tStart = ezTime::Now();
+
+      for (ezUInt32 i = 0; i < s_uiNumFileSystemPerfFiles; ++i)
+      {
+        sFile.SetFormat("Folder{}/Missing{}.txt", i % 16, i);
+        EZ_TEST_BOOL(!ezFileSystem::ExistsFile(sFile));
+      }
+
+      const ezTime tMissing = ezTime::Now() - tStart;
+
+      ezLog::Info("[test]{}: mount {}ms, {} OS lookups, opening {} files {}ms, {} OS lookups, {} missing files {}ms", variant.m_szName, ezArgF(tMount.GetMilliseconds(), 2), uiNumMountLookups,
+        s_uiNumFileSystemPerfFiles, ezArgF(tOpen.GetMilliseconds(), 2), uiNumOpenLookups, s_uiNumFileSystemPerfFiles, ezArgF(tMissing.GetMilliseconds(), 2));
+
+      EZ_TEST_INT(ezFileSystem::RemoveDataDirectoryGroup("FileSystemPerf"), s_uiNumFileSystemPerfEmptyDataDirs + 1);
+    }
+
+    ezOSFile::RemoveEventHandler(CountOSFileLookups);
+
+    ezDataDirectory::FolderType::s_bWatchIndexedDataDirectories = true;
+    ezDataDirectory::FolderType::s_sFileIndexCacheFolder.Clear();
+    ezFileSystem::ClearAllDataDirectoryFactories();
+    ezFileSystem::RegisterDataDirectoryFactory(ezDataDirectory::FolderType::Factory);
+
+    EZ_TEST_RESULT(ezOSFile::DeleteFolder(sRootFolder));
+  }
+}
@@ -0,0 +1,114 @@
+#include <FoundationTest/FoundationTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Strings/HashedString.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Time/Time.h>
+
+// Enable when needed
+#define EZ_PERFORMANCE_TESTS_STATE ezTestBlock::DisabledNoWarning
+
+namespace
+{
+  /// Mimics loader threads that create component and property names while a level is streamed in.
+  class ezHashedStringInternThread : public ezThread
+  {
+  public:
+    ezHashedStringInternThread(ezArrayPtr<const ezString> names, ezUInt32 uiNumAssignments, ezUInt32 uiSeed)
+      : ezThread("ezHashedStringInternThread")
+      , m_Names(names)
+      , m_uiNumAssignments(uiNumAssignments)
+      , m_uiSeed(uiSeed)
+    {
+    }
+
+    virtual ezUInt32 Run() override
+    {
+      ezUInt32 uiRandom = m_uiSeed;
+      ezHashedString sName;
+
+      for (ezUInt32 i = 0; i < m_uiNumAssignments; ++i)
+      {
+        uiRandom = uiRandom * 1664525u + 1013904223u;
+
+        sName.Assign(m_Names[(uiRandom >> 8) % m_Names.GetCount()]);
+        m_uiChecksum += sName.GetHash();
+      }
+
+      return 0;
+    }
+
+    ezUInt64 m_uiChecksum = 0;
+
+  private:
+    ezArrayPtr<const ezString> m_Names;
+    ezUInt32 m_uiNumAssignments;
+    ezUInt32 m_uiSeed;
+  };
+
+  ezTime MeasureInterning(ezArrayPtr<const ezString> names, ezUInt32 uiNumThreads, ezUInt32 uiTotalAssignments)
+  {
+    ezDynamicArray<ezHashedStringInternThread*> threads;
+    for (ezUInt32 i = 0; i < uiNumThreads; ++i)
+    {
+      threads.PushBack(EZ_DEFAULT_NEW(ezHashedStringInternThread, names, uiTotalAssignments / uiNumThreads, i + 1));
+    }
+
+    const ezTime tStart = ezTime::Now();
+
+    for (ezHashedStringInternThread* pThread : threads)
+    {
+      pThread->Start();
+    }
+
+    for (ezHashedStringInternThread* pThread : threads)
+    {
+      pThread->Join();
+    }
+
+    const ezTime tDuration = ezTime::Now() - tStart;
+
+    for (ezHashedStringInternThread* pThread : threads)
+    {
+      EZ_DEFAULT_DELETE(pThread);
+    }
+
+    return tDuration;
+  }
+} // namespace
+
+EZ_CREATE_SIMPLE_TEST(Performance, HashedString)
+{
+  EZ_TEST_BLOCK(EZ_PERFORMANCE_TESTS_STATE, "Interning")
+  {
+    constexpr ezUInt32 uiNumNames = 50000;
+    constexpr ezUInt32 uiTotalAssignments = 1024 * 1024;
+
+    ezUInt32 uiRun = 0;
+    ezDynamicArray<ezString> names;
+    ezStringBuilder sName;
+
+    for (ezUInt32 uiNumThreads = 1; uiNumThreads <= 16; uiNumThreads *= 2)
+    {
+      // a new set of names, so the first assignment of every name has to add it to the storage
+      names.Clear();
+      for (ezUInt32 i = 0; i < uiNumNames; ++i)
+      {
+        sName.SetFormat("Level{}/Component{}/Property", uiRun, i);
+        names.PushBack(sName);
+      }
+      ++uiRun;
+
+      const ezTime tNew = MeasureInterning(names, uiNumThreads, uiTotalAssignments);
+
+      // now all names are known and only need to be looked up
+      const ezTime tExisting = MeasureInterning(names, uiNumThreads, uiTotalAssignments);
+
+      ezLog::Info("[test]{} threads: new names {}ms, existing names {}ms", ezArgU(uiNumThreads, 2), ezArgF(tNew.GetMilliseconds(), 2), ezArgF(tExisting.GetMilliseconds(), 2));
+    }
+
+    const ezHashedString::MemoryStatistics stats = ezHashedString::GetMemoryStatistics();
+    ezLog::Info("[test]String storage: {} strings, {} of string data, {} of entries, {} of separately allocated string data, {} of lookup tables", stats.m_uiNumStrings, ezArgFileSize(stats.m_uiStringBytes), ezArgFileSize(stats.m_uiEntryBytes), ezArgFileSize(stats.m_uiStringHeapBytes), ezArgFileSize(stats.m_uiTableBytes));
+  }
+}
@@ -0,0 +1,278 @@
+#include <FoundationTest/FoundationTestPCH.h>
+
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Threading/TaskSystem.h>
+#include <Foundation/Time/Time.h>
+
+// Enable when needed
+#define EZ_PERFORMANCE_TESTS_STATE ezTestBlock::DisabledNoWarning
+
+namespace
+{
+  class ezTinyTask final : public ezTask
+  {
+  public:
+    ezTinyTask() { ConfigureTask("TinyTask", ezTaskNesting::Never); }
+
+    ezUInt32 m_uiResult = 0;
+
+  private:
+    virtual void Execute() override
+    {
+      for (ezUInt32 i = 0; i < 64; ++i)
+      {
+        m_uiResult += i * i;
+      }
+    }
+  };
+
+  /// Starts many tiny tasks from within a task and waits for them, which is the typical pattern of nested parallel work.
+  /// With the global queue every scheduling operation and every dequeue goes through the task system mutex.
+  class ezSpawnerTask final : public ezTask
+  {
+  public:
+    ezSpawnerTask(ezUInt32 uiNumChildren, ezUInt32 uiNumRounds)
+      : m_uiNumRounds(uiNumRounds)
+    {
+      ConfigureTask("SpawnerTask", ezTaskNesting::Maybe);
+
+      for (ezUInt32 i = 0; i < uiNumChildren; ++i)
+      {
+        m_Children.PushBack(EZ_DEFAULT_NEW(ezTinyTask));
+      }
+    }
+
+  private:
+    virtual void Execute() override
+    {
+      for (ezUInt32 round = 0; round < m_uiNumRounds; ++round)
+      {
+        ezTaskGroupID group = ezTaskSystem::CreateTaskGroup(ezTaskPriority::EarlyThisFrame);
+
+        for (auto& pChild : m_Children)
+        {
+          ezTaskSystem::AddTaskToGroup(group, pChild);
+        }
+
+        ezTaskSystem::StartTaskGroup(group);
+        ezTaskSystem::WaitForGroup(group);
+      }
+    }
+
+    ezUInt32 m_uiNumRounds = 0;
+    ezDynamicArray<ezSharedPtr<ezTask>> m_Children;
+  };
+
+  ezTime MeasureNestedTasks(ezUInt32 uiNumSpawners, ezUInt32 uiNumChildren, ezUInt32 uiNumRounds)
+  {
+    ezDynamicArray<ezSharedPtr<ezTask>> spawners;
+    for (ezUInt32 i = 0; i < uiNumSpawners; ++i)
+    {
+      spawners.PushBack(EZ_DEFAULT_NEW(ezSpawnerTask, uiNumChildren, uiNumRounds));
+    }
+
+    const ezTime tStart = ezTime::Now();
+
+    ezTaskGroupID group = ezTaskSystem::CreateTaskGroup(ezTaskPriority::ThisFrame);
+    for (auto& pSpawner : spawners)
+    {
+      ezTaskSystem::AddTaskToGroup(group, pSpawner);
+    }
+
+    ezTaskSystem::StartTaskGroup(group);
+    ezTaskSystem::WaitForGroup(group);
+
+    return ezTime::Now() - tStart;
+  }
+
+  /// Builds and runs a graph of single-task groups, where every group depends on up to three earlier groups.
+  /// Returns the time it took to build and start the graph in \a out_buildTime.
+  ezTime MeasureTaskGraph(ezArrayPtr<ezSharedPtr<ezTask>> tasks, ezDynamicArray<ezTaskGroupID>& ref_groups, ezTime& out_buildTime)
+  {
+    const ezUInt32 uiNumNodes = tasks.GetCount();
+
+    const ezTime tStart = ezTime::Now();
+
+    for (ezUInt32 i = 0; i < uiNumNodes; ++i)
+    {
+      ref_groups[i] = ezTaskSystem::CreateTaskGroup(ezTaskPriority::ThisFrame);
+      ezTaskSystem::AddTaskToGroup(ref_groups[i], tasks[i]);
+
+      for (ezUInt32 d : {1u, 5u, 97u})
+      {
+        if (i >= d)
+        {
+          ezTaskSystem::AddTaskGroupDependency(ref_groups[i], ref_groups[i - d]);
+        }
+      }
+
+      ezTaskSystem::StartTaskGroup(ref_groups[i]);
+    }
+
+    out_buildTime = ezTime::Now() - tStart;
+
+    for (ezUInt32 i = 0; i < uiNumNodes; ++i)
+    {
+      ezTaskSystem::WaitForGroup(ref_groups[i]);
+    }
+
+    return ezTime::Now() - tStart;
+  }
+  /// Runs a ParallelFor where the cost of each item is given by \a costFunc (in iterations of a dummy loop).
+  template <typename CostFunc>
+  ezTime MeasureParallelFor(ezUInt32 uiNumItems, CostFunc costFunc, const char* szTaskName, const ezParallelForParams& params, ezUInt32 uiNumRuns)
+  {
+    ezAtomicInteger64 iResult;
+
+    const ezTime tStart = ezTime::Now();
+
+    for (ezUInt32 run = 0; run < uiNumRuns; ++run)
+    {
+      ezTaskSystem::ParallelForIndexed(
+        0, uiNumItems,
+        [&](ezUInt32 uiStartIndex, ezUInt32 uiEndIndex)
+        {
+          ezUInt64 uiSum = 0;
+          for (ezUInt32 i = uiStartIndex; i < uiEndIndex; ++i)
+          {
+            const ezUInt32 uiCost = costFunc(i);
+            for (ezUInt32 j = 0; j < uiCost; ++j)
+            {
+              uiSum += (ezUInt64)j * i;
+            }
+          }
+
+          iResult.Add(static_cast<ezInt64>(uiSum));
+        },
+        szTaskName, params);
+    }
+
+    return (ezTime::Now() - tStart) / uiNumRuns;
+  }
+} // namespace
+
+EZ_CREATE_SIMPLE_TEST(Performance, TaskSystem)
+{
+  EZ_TEST_BLOCK(EZ_PERFORMANCE_TESTS_STATE, "Scheduler Contention")
+  {
+    const ezUInt32 uiNumSpawners = 16;
+    const ezUInt32 uiNumChildren = 256;
+    const ezUInt32 uiNumRounds = 16;
+    const ezUInt32 uiNumTasks = uiNumSpawners * uiNumChildren * uiNumRounds;
+
+    const ezTaskSchedulingMode::Enum modes[] = {ezTaskSchedulingMode::GlobalQueue, ezTaskSchedulingMode::WorkStealing};
+    const char* szModeNames[] = {"GlobalQueue", "WorkStealing"};
+
+    for (ezUInt32 uiNumThreads = 1; uiNumThreads <= 64; uiNumThreads *= 2)
+    {
+      ezTaskSystem::SetWorkerThreadCount(uiNumThreads, 2);
+
+      for (ezUInt32 m = 0; m < EZ_ARRAY_SIZE(modes); ++m)
+      {
+        ezTaskSystem::SetSchedulingMode(modes[m]);
+
+        // warm up, so that all worker threads and task groups are allocated
+        MeasureNestedTasks(uiNumSpawners, uiNumChildren, 1);
+
+        const ezTime tDuration = MeasureNestedTasks(uiNumSpawners, uiNumChildren, uiNumRounds);
+
+        ezLog::Info("[test]{} threads, {}: {}ms, {} tasks/ms", ezArgU(uiNumThreads, 2), szModeNames[m], ezArgF(tDuration.GetMilliseconds(), 2),
+          ezArgF(uiNumTasks / tDuration.GetMilliseconds(), 1));
+      }
+    }
+
+    ezTaskSystem::SetSchedulingMode(ezTaskSchedulingMode::Default);
+    ezTaskSystem::SetWorkerThreadCount();
+  }
+
+  EZ_TEST_BLOCK(EZ_PERFORMANCE_TESTS_STATE, "Task Graph Throughput")
+  {
+    constexpr ezUInt32 uiNumNodes = 10000;
+    constexpr ezUInt32 uiNumRuns = 10;
+
+    ezDynamicArray<ezSharedPtr<ezTask>> tasks;
+    ezDynamicArray<ezTaskGroupID> groups;
+    groups.SetCount(uiNumNodes);
+
+    for (ezUInt32 i = 0; i < uiNumNodes; ++i)
+    {
+      tasks.PushBack(EZ_DEFAULT_NEW(ezTinyTask));
+    }
+
+    // warm up, so that all task groups are allocated
+    ezTime tBuild;
+    MeasureTaskGraph(tasks, groups, tBuild);
+
+    ezTime tTotalBuild;
+    ezTime tTotal;
+
+    for (ezUInt32 run = 0; run < uiNumRuns; ++run)
+    {
+      tTotal += MeasureTaskGraph(tasks, groups, tBuild);
+      tTotalBuild += tBuild;
+    }
+
+    ezLog::Info("[test]Task graph with {} nodes: build + start {}ms, total {}ms, {} nodes/ms", uiNumNodes, ezArgF(tTotalBuild.GetMilliseconds() / uiNumRuns, 2),
+      ezArgF(tTotal.GetMilliseconds() / uiNumRuns, 2), ezArgF(uiNumNodes * uiNumRuns / tTotal.GetMilliseconds(), 1));
+  }
+
+  EZ_TEST_BLOCK(EZ_PERFORMANCE_TESTS_STATE, "ParallelFor Adaptive")
+  {
+    constexpr ezUInt32 uiNumRuns = 20;
+
+    ezParallelForParams staticParams;
+    ezParallelForParams adaptiveParams;
+    adaptiveParams.m_bAdaptive = true;
+
+    auto uniformCost = [](ezUInt32 i)
+    { return 64u; };
+
+    // 1% of the items are 1000 times as expensive as the others, and they are all at the end of the range
+    auto skewedCost = [](ezUInt32 i)
+    { return i >= 99000 ? 8000u : 8u; };
+
+    auto cheapCost = [](ezUInt32 i)
+    { return 1u; };
+
+    for (ezUInt32 uiNumThreads = 1; uiNumThreads <= 16; uiNumThreads *= 2)
+    {
+      ezTaskSystem::SetWorkerThreadCount(uiNumThreads, 2);
+
+      const char* szNames[] = {"Uniform", "Skewed", "Small"};
+      const ezUInt32 uiNumItems[] = {100000, 100000, 500};
+
+      for (ezUInt32 w = 0; w < EZ_ARRAY_SIZE(szNames); ++w)
+      {
+        ezTime tStatic;
+        ezTime tAdaptive;
+
+        // the first run is a warm up, which also lets the adaptive version learn the cost per item
+        for (ezUInt32 pass = 0; pass < 2; ++pass)
+        {
+          const ezUInt32 uiRuns = pass == 0 ? 1 : uiNumRuns;
+
+          switch (w)
+          {
+            case 0:
+              tStatic = MeasureParallelFor(uiNumItems[w], uniformCost, "Bench Uniform Static", staticParams, uiRuns);
+              tAdaptive = MeasureParallelFor(uiNumItems[w], uniformCost, "Bench Uniform Adaptive", adaptiveParams, uiRuns);
+              break;
+            case 1:
+              tStatic = MeasureParallelFor(uiNumItems[w], skewedCost, "Bench Skewed Static", staticParams, uiRuns);
+              tAdaptive = MeasureParallelFor(uiNumItems[w], skewedCost, "Bench Skewed Adaptive", adaptiveParams, uiRuns);
+              break;
+            case 2:
+              tStatic = MeasureParallelFor(uiNumItems[w], cheapCost, "Bench Small Static", staticParams, uiRuns);
+              tAdaptive = MeasureParallelFor(uiNumItems[w], cheapCost, "Bench Small Adaptive", adaptiveParams, uiRuns);
+              break;
+          }
+        }
+
+        ezLog::Info("[test]{} threads, {} ({} items): static {}ms, adaptive {}ms", ezArgU(uiNumThreads, 2), szNames[w], uiNumItems[w],
+          ezArgF(tStatic.GetMilliseconds(), 3), ezArgF(tAdaptive.GetMilliseconds(), 3));
+      }
+    }
+
+    ezTaskSystem::SetWorkerThreadCount();
+  }
+}
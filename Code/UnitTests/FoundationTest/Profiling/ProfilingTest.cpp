@@ -1,12 +1,55 @@
 #include <FoundationTest/FoundationTestPCH.h>
 
+#include <Foundation/IO/FileSystem/FileReader.h>
 #include <Foundation/IO/FileSystem/FileSystem.h>
 #include <Foundation/IO/FileSystem/FileWriter.h>
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/Profiling/ContinuousProfiling.h>
+#include <Foundation/Profiling/FastProfiling.h>
 #include <Foundation/Profiling/Profiling.h>
+#include <Foundation/Threading/Thread.h>
 #include <Foundation/Threading/ThreadUtils.h>
 
 namespace
 {
+  class ezFastProfilingTestThread : public ezThread
+  {
+  public:
+    ezFastProfilingTestThread(ezUInt32 uiNumScopes)
+      : ezThread("ezFastProfilingTestThread")
+      , m_uiNumScopes(uiNumScopes)
+    {
+    }
+
+    virtual ezUInt32 Run() override
+    {
+      for (ezUInt32 i = 0; i < m_uiNumScopes; ++i)
+      {
+        EZ_PROFILE_SCOPE_FAST("Fast thread scope");
+      }
+
+      return 0;
+    }
+
+  private:
+    ezUInt32 m_uiNumScopes;
+  };
+
+  ezUInt32 CountScopes(const ezProfilingSystem::ProfilingData& profilingData, ezStringView sName)
+  {
+    ezUInt32 uiCount = 0;
+
+    for (const auto& eventBuffer : profilingData.m_AllEventBuffers)
+    {
+      for (const auto& scope : eventBuffer.m_Data)
+      {
+        uiCount += (sName == scope.m_szName) ? 1 : 0;
+      }
+    }
+
+    return uiCount;
+  }
+
   void WriteOutProfilingCapture(const char* szFilePath)
   {
     ezStringBuilder outputPath = ezTestFramework::GetInstance()->GetAbsOutputPath();
@@ -21,6 +64,17 @@ namespace
       ezLog::Info("Profiling capture saved to '{0}'.", fileWriter.GetFilePathAbsolute().GetData());
     }
   }
+
+  bool FileContains(ezStringView sFile, ezStringView sText)
+  {
+    ezFileReader file;
+    if (file.Open(sFile).Failed())
+      return false;
+
+    ezStringBuilder sContent;
+    sContent.ReadAll(file);
+    return sContent.FindSubString(sText) != nullptr;
+  }
 } // namespace
 
 EZ_CREATE_SIMPLE_TEST_GROUP(Profiling);
@@ -52,4 +106,325 @@ EZ_CREATE_SIMPLE_TEST(Profiling, Profiling)
 
     WriteOutProfilingCapture(":output/profilingScopes.json");
   }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Fast scopes")
+  {
+    ezProfilingSystem::Clear();
+    EZ_TEST_BOOL(ezFastProfilingSystem::IsEnabled());
+
+    const ezUInt32 uiOuterId = ezFastProfilingSystem::RegisterScopeName("Fast outer scope", EZ_SOURCE_FUNCTION);
+    EZ_TEST_INT(ezFastProfilingSystem::RegisterScopeName("Fast outer scope", EZ_SOURCE_FUNCTION), uiOuterId);
+    EZ_TEST_STRING(ezFastProfilingSystem::GetScopeName(uiOuterId), "Fast outer scope");
+
+    for (ezUInt32 i = 0; i < 100; ++i)
+    {
+      ezFastProfilingScope outer(uiOuterId);
+
+      EZ_PROFILE_SCOPE_FAST("Fast inner scope");
+    }
+
+    ezFastProfilingSystem::SetEnabled(false);
+    {
+      EZ_PROFILE_SCOPE_FAST("Fast disabled scope");
+    }
+    ezFastProfilingSystem::SetEnabled(true);
+
+    EZ_TEST_BOOL(ezFastProfilingSystem::GetTicksPerSecond() > 0.0);
+
+    const ezTime tNow = ezTime::Now();
+    EZ_TEST_FLOAT(ezFastProfilingSystem::TicksToTime(ezFastProfilingSystem::GetTimestamp()).GetSeconds(), tNow.GetSeconds(), 0.05);
+
+    ezProfilingSystem::ProfilingData profilingData;
+    ezProfilingSystem::Capture(profilingData);
+
+    ezUInt32 uiNumOuter = 0;
+    ezUInt32 uiNumInner = 0;
+    ezUInt32 uiNumDisabled = 0;
+    ezTime tLastOuterBegin;
+
+    for (const auto& eventBuffer : profilingData.m_AllEventBuffers)
+    {
+      for (const auto& scope : eventBuffer.m_Data)
+      {
+        const ezStringView sName = scope.m_szName;
+
+        EZ_TEST_BOOL(scope.m_EndTime >= scope.m_BeginTime);
+
+        if (sName == "Fast outer scope")
+        {
+          EZ_TEST_BOOL(scope.m_BeginTime >= tLastOuterBegin);
+          EZ_TEST_BOOL(scope.m_BeginTime <= tNow);
+          tLastOuterBegin = scope.m_BeginTime;
+          ++uiNumOuter;
+        }
+        else if (sName == "Fast inner scope")
+        {
+          ++uiNumInner;
+        }
+        else if (sName == "Fast disabled scope")
+        {
+          ++uiNumDisabled;
+        }
+      }
+    }
+
+    EZ_TEST_INT(uiNumOuter, 100);
+    EZ_TEST_INT(uiNumInner, 100);
+    EZ_TEST_INT(uiNumDisabled, 0);
+
+    ezProfilingSystem::Clear();
+    profilingData.Clear();
+    ezProfilingSystem::Capture(profilingData);
+
+    for (const auto& eventBuffer : profilingData.m_AllEventBuffers)
+    {
+      for (const auto& scope : eventBuffer.m_Data)
+      {
+        EZ_TEST_BOOL(ezStringView(scope.m_szName) != "Fast outer scope");
+      }
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Fast scopes of exited threads")
+  {
+    ezProfilingSystem::Clear();
+
+    for (ezUInt32 uiNumScopes : {10, 20})
+    {
+      ezFastProfilingTestThread thread(uiNumScopes);
+      thread.Start();
+      thread.Join();
+
+      // the events of an exited thread can still be captured, until they are cleared
+      ezProfilingSystem::ProfilingData profilingData;
+      ezProfilingSystem::Capture(profilingData);
+      EZ_TEST_INT(CountScopes(profilingData, "Fast thread scope"), uiNumScopes);
+
+      ezProfilingSystem::Clear();
+
+      profilingData.Clear();
+      ezProfilingSystem::Capture(profilingData);
+      EZ_TEST_INT(CountScopes(profilingData, "Fast thread scope"), 0);
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Fast scopes binary dump")
+  {
+    ezProfilingSystem::Clear();
+
+    ezDefaultMemoryStreamStorage storage;
+    ezMemoryStreamWriter writer(&storage);
+
+    ezFastProfilingStream stream;
+
+    // the dump is written in two parts, the second one only contains what was recorded in between
+    for (ezUInt32 i = 0; i < 10; ++i)
+    {
+      EZ_PROFILE_SCOPE_FAST("Fast dump scope 1");
+    }
+
+    EZ_TEST_BOOL(stream.WriteNewEvents(writer).Succeeded());
+
+    for (ezUInt32 i = 0; i < 20; ++i)
+    {
+      EZ_PROFILE_SCOPE_FAST("Fast dump scope 2");
+    }
+
+    ezProfilingSystem::StartNewFrame();
+    ezProfilingSystem::StartNewFrame();
+
+    EZ_TEST_BOOL(stream.WriteNewEvents(writer).Succeeded());
+    EZ_TEST_INT(stream.GetNumLostEvents(), 0);
+
+    // overflow the ring buffer, the oldest events are lost
+    for (ezUInt32 i = 0; i < ezFastProfilingSystem::EventsPerThread - 1 + 100; ++i)
+    {
+      EZ_PROFILE_SCOPE_FAST("Fast dump scope 3");
+    }
+
+    EZ_TEST_BOOL(stream.WriteNewEvents(writer).Succeeded());
+    EZ_TEST_INT(stream.GetNumLostEvents(), 100);
+
+    ezMemoryStreamReader reader(&storage);
+
+    ezProfilingSystem::ProfilingData profilingData;
+    EZ_TEST_BOOL(ezFastProfilingSystem::ConvertBinaryDump(reader, profilingData).Succeeded());
+
+    ezUInt32 uiNumScopes[3] = {};
+    for (const auto& eventBuffer : profilingData.m_AllEventBuffers)
+    {
+      for (const auto& scope : eventBuffer.m_Data)
+      {
+        const ezStringView sName = scope.m_szName;
+        for (ezUInt32 i = 0; i < 3; ++i)
+        {
+          ezStringBuilder sExpected;
+          sExpected.SetFormat("Fast dump scope {}", i + 1);
+          if (sName == sExpected)
+          {
+            ++uiNumScopes[i];
+            EZ_TEST_STRING(scope.m_szFunctionName, EZ_SOURCE_FUNCTION);
+          }
+        }
+      }
+    }
+
+    EZ_TEST_INT(uiNumScopes[0], 10);
+    EZ_TEST_INT(uiNumScopes[1], 20);
+    EZ_TEST_INT(uiNumScopes[2], ezFastProfilingSystem::EventsPerThread - 1);
+
+    EZ_TEST_INT(profilingData.m_FrameStartTimes.GetCount(), 2);
+    EZ_TEST_INT(profilingData.m_uiFrameCount, ezProfilingSystem::GetFrameCount());
+    EZ_TEST_BOOL(!profilingData.m_ThreadInfos.IsEmpty());
+
+    // the converted data can be written as JSON like any other capture
+    ezDefaultMemoryStreamStorage jsonStorage;
+    ezMemoryStreamWriter jsonWriter(&jsonStorage);
+    EZ_TEST_BOOL(profilingData.Write(jsonWriter).Succeeded());
+    EZ_TEST_BOOL(jsonStorage.GetStorageSize64() > 0);
+
+    // starting a new stream writes everything that is still available again
+    stream.Reset();
+    ezDefaultMemoryStreamStorage storage2;
+    ezMemoryStreamWriter writer2(&storage2);
+    EZ_TEST_BOOL(stream.WriteNewEvents(writer2).Succeeded());
+
+    ezMemoryStreamReader reader2(&storage2);
+    EZ_TEST_BOOL(ezFastProfilingSystem::ConvertBinaryDump(reader2, profilingData).Succeeded());
+
+    ezUInt32 uiNumEvents = 0;
+    for (const auto& eventBuffer : profilingData.m_AllEventBuffers)
+    {
+      uiNumEvents += eventBuffer.m_Data.GetCount();
+    }
+
+    EZ_TEST_INT(uiNumEvents, ezFastProfilingSystem::EventsPerThread - 1);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Continuous profiling")
+  {
+    ezStringBuilder outputPath = ezTestFramework::GetInstance()->GetAbsOutputPath();
+    EZ_TEST_BOOL(ezFileSystem::AddDataDirectory(outputPath.GetData(), "ContinuousProfilingTest", "cpt", ezFileSystem::AllowWrites) == EZ_SUCCESS);
+
+    auto DeleteOutputFolder = [&](ezStringView sFolder)
+    {
+      ezStringBuilder sPath = outputPath;
+      sPath.AppendPath(sFolder);
+      ezOSFile::DeleteFolder(sPath).IgnoreResult();
+    };
+
+    DeleteOutputFolder("ContinuousProfiling");
+    DeleteOutputFolder("ContinuousProfiling2");
+
+    ezProfilingSystem::Clear();
+
+    ezContinuousProfiling::Settings settings;
+    settings.m_sOutputFolder = ":cpt/ContinuousProfiling";
+    settings.m_RetentionDuration = ezTime::MakeFromMilliseconds(200);
+    settings.m_SegmentDuration = ezTime::MakeFromMilliseconds(50);
+    settings.m_FlushInterval = ezTime::MakeFromMilliseconds(10);
+
+    EZ_TEST_BOOL(!ezContinuousProfiling::IsRunning());
+    EZ_TEST_BOOL(ezContinuousProfiling::Start(settings).Succeeded());
+    EZ_TEST_BOOL(ezContinuousProfiling::IsRunning());
+
+    {
+      ezMuteLog logErrorSink;
+      ezLogSystemScope ls(&logErrorSink);
+      EZ_TEST_BOOL(ezContinuousProfiling::Start(settings).Failed());
+    }
+
+    const ezTime startTime = ezTime::Now();
+    ezUInt32 uiMaxSegments = 0;
+
+    while (ezTime::Now() - startTime < ezTime::MakeFromMilliseconds(500))
+    {
+      {
+        EZ_PROFILE_SCOPE("Continuous scope");
+        EZ_PROFILE_SCOPE_FAST("Continuous fast scope");
+        ezThreadUtils::Sleep(ezTime::MakeFromMilliseconds(2));
+      }
+
+      ezProfilingSystem::StartNewFrame();
+      uiMaxSegments = ezMath::Max(uiMaxSegments, ezContinuousProfiling::GetNumSegments());
+    }
+
+    // old segments are deleted, so the number of segments depends on the retention duration and not on the recorded time
+    EZ_TEST_BOOL(uiMaxSegments > 1);
+    EZ_TEST_BOOL(uiMaxSegments < 10);
+
+    // the beginning of the recording is not available anymore, but the last 100ms are
+    const ezTime endTime = ezTime::Now();
+    {
+      EZ_PROFILE_SCOPE("Last scope");
+      ezThreadUtils::Sleep(ezTime::MakeFromMilliseconds(1));
+    }
+    ezContinuousProfiling::Flush();
+
+    EZ_TEST_BOOL(ezContinuousProfiling::ExportTimeRange(":cpt/ContinuousProfiling/Export.json", endTime - ezTime::MakeFromMilliseconds(100), endTime + ezTime::MakeFromSeconds(1)).Succeeded());
+    EZ_TEST_BOOL(FileContains(":cpt/ContinuousProfiling/Export.json", "Continuous scope"));
+    EZ_TEST_BOOL(FileContains(":cpt/ContinuousProfiling/Export.json", "Continuous fast scope"));
+    EZ_TEST_BOOL(FileContains(":cpt/ContinuousProfiling/Export.json", "Last scope"));
+
+    // requested exports are written by the background thread once the requested time has passed
+    ezFileSystem::DeleteFile(":cpt/ContinuousProfiling/Requested.json");
+    ezContinuousProfiling::RequestExport(":cpt/ContinuousProfiling/Requested.json", ezTime::MakeFromMilliseconds(50), ezTime::MakeFromMilliseconds(20));
+    {
+      EZ_PROFILE_SCOPE("Requested scope");
+      ezThreadUtils::Sleep(ezTime::MakeFromMilliseconds(1));
+    }
+
+    for (ezUInt32 i = 0; i < 100 && !ezFileSystem::ExistsFile(":cpt/ContinuousProfiling/Requested.json"); ++i)
+    {
+      ezThreadUtils::Sleep(ezTime::MakeFromMilliseconds(10));
+    }
+
+    EZ_TEST_BOOL(FileContains(":cpt/ContinuousProfiling/Requested.json", "Requested scope"));
+
+    // a scope that takes longer than its timeout triggers an export
+    ezContinuousProfiling::SetExportOnScopeTimeout(":cpt/ContinuousProfiling", ezTime::MakeFromMilliseconds(50), ezTime::MakeZero());
+    ezStringBuilder sTimeoutFile;
+    sTimeoutFile.SetFormat(":cpt/ContinuousProfiling/ScopeTimeout-Frame{}.json", ezProfilingSystem::GetFrameCount());
+    ezFileSystem::DeleteFile(sTimeoutFile);
+
+    {
+      EZ_PROFILE_SCOPE_WITH_TIMEOUT("Slow scope", ezTime::MakeFromMilliseconds(1));
+      ezThreadUtils::Sleep(ezTime::MakeFromMilliseconds(5));
+    }
+
+    ezContinuousProfiling::DisableExportOnScopeTimeout();
+
+    // stopping writes the pending export immediately
+    ezContinuousProfiling::Stop();
+    EZ_TEST_BOOL(!ezContinuousProfiling::IsRunning());
+    EZ_TEST_BOOL(FileContains(sTimeoutFile, "Slow scope"));
+
+    // the segments are kept after stopping, but a new run deletes them
+    auto CountSegmentFiles = [&](ezStringView sFolder)
+    {
+      ezStringBuilder sPath = outputPath;
+      sPath.AppendPath(sFolder);
+
+      ezDynamicArray<ezFileStats> files;
+      ezOSFile::GatherAllItemsInFolder(files, sPath, ezFileSystemIteratorFlags::ReportFiles);
+
+      ezUInt32 uiCount = 0;
+      for (const ezFileStats& file : files)
+      {
+        uiCount += ezPathUtils::HasExtension(file.m_sName, "ezProfilingSegment") ? 1 : 0;
+      }
+      return uiCount;
+    };
+
+    EZ_TEST_BOOL(CountSegmentFiles("ContinuousProfiling") > 0);
+
+    settings.m_sOutputFolder = ":cpt/ContinuousProfiling2";
+    EZ_TEST_BOOL(ezContinuousProfiling::Start(settings).Succeeded());
+    EZ_TEST_INT(CountSegmentFiles("ContinuousProfiling"), 0);
+    ezContinuousProfiling::Stop();
+
+    DeleteOutputFolder("ContinuousProfiling2");
+
+    ezFileSystem::RemoveDataDirectoryGroup("ContinuousProfilingTest");
+  }
 }
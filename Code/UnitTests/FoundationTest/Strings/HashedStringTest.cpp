@@ -1,6 +1,36 @@
 #include <FoundationTest/FoundationTestPCH.h>
 
 #include <Foundation/Strings/HashedString.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <Foundation/Threading/Thread.h>
+
+namespace
+{
+  class ezHashedStringTestThread : public ezThread
+  {
+  public:
+    ezHashedStringTestThread(ezUInt32 uiNumStrings)
+      : ezThread("ezHashedStringTestThread")
+      , m_uiNumStrings(uiNumStrings)
+    {
+    }
+
+    virtual ezUInt32 Run() override
+    {
+      ezStringBuilder sName;
+      for (ezUInt32 i = 0; i < m_uiNumStrings; ++i)
+      {
+        sName.SetFormat("HashedStringTestThread{}", i);
+        m_Strings.ExpandAndGetRef().Assign(sName);
+      }
+
+      return 0;
+    }
+
+    ezUInt32 m_uiNumStrings;
+    ezDynamicArray<ezHashedString> m_Strings;
+  };
+} // namespace
 
 EZ_CREATE_SIMPLE_TEST(Strings, HashedString)
 {
@@ -185,6 +215,59 @@ EZ_CREATE_SIMPLE_TEST(Strings, HashedString)
     EZ_TEST_STRING(s3.GetString().GetData(), "tut");
   }
 
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Multithreaded Assign")
+  {
+    constexpr ezUInt32 uiNumThreads = 4;
+    constexpr ezUInt32 uiNumStrings = 5000;
+
+    ezHashedStringTestThread* threads[uiNumThreads];
+    for (ezUInt32 t = 0; t < uiNumThreads; ++t)
+    {
+      threads[t] = EZ_DEFAULT_NEW(ezHashedStringTestThread, uiNumStrings);
+      threads[t]->Start();
+    }
+
+    for (ezUInt32 t = 0; t < uiNumThreads; ++t)
+    {
+      threads[t]->Join();
+    }
+
+    // all threads added the same strings concurrently, they must all have ended up with the same entries
+    ezStringBuilder sName;
+    for (ezUInt32 i = 0; i < uiNumStrings; ++i)
+    {
+      sName.SetFormat("HashedStringTestThread{}", i);
+      EZ_TEST_STRING(threads[0]->m_Strings[i].GetData(), sName);
+
+      for (ezUInt32 t = 1; t < uiNumThreads; ++t)
+      {
+        EZ_TEST_BOOL(threads[t]->m_Strings[i] == threads[0]->m_Strings[i]);
+      }
+    }
+
+    for (ezUInt32 t = 0; t < uiNumThreads; ++t)
+    {
+      EZ_DEFAULT_DELETE(threads[t]);
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "GetMemoryStatistics")
+  {
+    const ezHashedString::MemoryStatistics before = ezHashedString::GetMemoryStatistics();
+
+    ezHashedString s1, s2;
+    s1.Assign("GetMemoryStatistics short");
+    s2.Assign("GetMemoryStatistics with a string that is too long to be stored inside its entry");
+
+    const ezHashedString::MemoryStatistics after = ezHashedString::GetMemoryStatistics();
+
+    EZ_TEST_INT(after.m_uiNumStrings, before.m_uiNumStrings + 2);
+    EZ_TEST_INT(after.m_uiStringBytes, before.m_uiStringBytes + s1.GetString().GetElementCount() + s2.GetString().GetElementCount() + 2);
+    EZ_TEST_BOOL(after.m_uiStringHeapBytes > before.m_uiStringHeapBytes);
+    EZ_TEST_BOOL(after.m_uiEntryBytes >= before.m_uiEntryBytes);
+    EZ_TEST_BOOL(after.m_uiTableBytes > 0);
+  }
+
 #if EZ_ENABLED(EZ_HASHED_STRING_REF_COUNTING)
   EZ_TEST_BLOCK(ezTestBlock::Enabled, "ClearUnusedStrings")
   {
@@ -199,6 +282,32 @@ EZ_CREATE_SIMPLE_TEST(Strings, HashedString)
 
     EZ_TEST_INT(ezHashedString::ClearUnusedStrings(), 3);
     EZ_TEST_INT(ezHashedString::ClearUnusedStrings(), 0);
+
+    // the entries of removed strings are reused, so adding and removing the same strings over and over doesn't need more memory
+    constexpr ezUInt32 uiNumStrings = 4096;
+
+    ezUInt64 uiEntryBytes = 0;
+    for (ezUInt32 uiRound = 0; uiRound < 16; ++uiRound)
+    {
+      {
+        ezDynamicArray<ezHashedString> strings;
+        ezStringBuilder sName;
+        for (ezUInt32 i = 0; i < uiNumStrings; ++i)
+        {
+          sName.SetFormat("ClearUnusedStrings{}", i);
+          strings.ExpandAndGetRef().Assign(sName);
+        }
+
+        EZ_TEST_STRING(strings.PeekBack().GetString(), sName);
+      }
+
+      EZ_TEST_INT(ezHashedString::ClearUnusedStrings(), uiNumStrings);
+
+      if (uiRound == 0)
+        uiEntryBytes = ezHashedString::GetMemoryStatistics().m_uiEntryBytes;
+      else
+        EZ_TEST_INT(ezHashedString::GetMemoryStatistics().m_uiEntryBytes, uiEntryBytes);
+    }
   }
 #endif
 }
@@ -212,4 +212,131 @@ EZ_CREATE_SIMPLE_TEST(Threading, ParallelFor)
     // check the resulting sum
     EZ_TEST_INT(uiNumbersSum, 4 * uiNumbersCheckSum);
   }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Parallel For (Adaptive)")
+  {
+    ezParallelForParams adaptiveParams;
+    adaptiveParams.m_bAdaptive = true;
+
+    EZ_TEST_BOOL(ezTaskSystem::GetParallelForItemCost("ParallelFor Adaptive Test (Indexed)").IsZero());
+
+    // run several times, so that the batch size adapts to the measured cost in between
+    for (ezUInt32 uiNumItems : {1u, 7u, 1000u, 20000u, 20000u, 20000u})
+    {
+      ezDynamicArray<ezUInt32> visited;
+      visited.SetCount(uiNumItems);
+
+      ezAtomicInteger32 iNumRanges;
+
+      ezTaskSystem::ParallelForIndexed(
+        0, uiNumItems,
+        [&visited, &iNumRanges](ezUInt32 uiStartIndex, ezUInt32 uiEndIndex)
+        {
+          iNumRanges.Increment();
+
+          for (ezUInt32 i = uiStartIndex; i < uiEndIndex; ++i)
+          {
+            // skewed workload, items at the end are much more expensive
+            volatile ezUInt32 uiWork = 0;
+            for (ezUInt32 j = 0; j < (i * 32) / (ezUInt32)visited.GetCount(); ++j)
+            {
+              uiWork = uiWork + j;
+            }
+
+            visited[i] += 1;
+          }
+        },
+        "ParallelFor Adaptive Test (Indexed)", adaptiveParams);
+
+      EZ_TEST_BOOL(iNumRanges >= 1);
+
+      for (ezUInt32 i = 0; i < uiNumItems; ++i)
+      {
+        EZ_TEST_INT(visited[i], 1);
+      }
+    }
+
+    EZ_TEST_BOOL(ezTaskSystem::GetParallelForItemCost("ParallelFor Adaptive Test (Indexed)").IsPositive());
+
+    // 64 bit indices
+    {
+      ezAtomicInteger64 iSum;
+
+      ezTaskSystem::ParallelForIndexed(
+        ezUInt64(100), ezUInt64(5000), [&iSum](ezUInt64 uiStartIndex, ezUInt64 uiEndIndex)
+        {
+          for (ezUInt64 i = uiStartIndex; i < uiEndIndex; ++i)
+          {
+            iSum.Add(static_cast<ezInt64>(i));
+          }
+        },
+        "ParallelFor Adaptive Test (Indexed64)", adaptiveParams);
+
+      EZ_TEST_INT(iSum, (100 + 5099) * 5000 / 2);
+    }
+
+    // array variants
+    {
+      ResetSharedVariables();
+
+      ezTaskSystem::ParallelForSingleIndex(
+        numbers.GetArrayPtr(),
+        [](ezUInt32 uiIndex, ezUInt32& ref_uiNumber)
+        {
+          EZ_TEST_INT(ref_uiNumber, uiIndex + 1);
+          ref_uiNumber = ref_uiNumber * 2;
+        },
+        "ParallelFor Adaptive Test (Write)", adaptiveParams);
+
+      ezTaskSystem::ParallelFor(
+        numbers.GetArrayPtr(),
+        [&dataAccessMutex, &uiNumbersSum](ezArrayPtr<ezUInt32> taskItemSlice)
+        {
+          EZ_LOCK(dataAccessMutex);
+          for (const ezUInt32 uiNumber : taskItemSlice)
+          {
+            uiNumbersSum += uiNumber;
+          }
+        },
+        "ParallelFor Adaptive Test (Sum)", adaptiveParams);
+
+      EZ_TEST_INT(uiNumbersSum, 2 * uiNumbersCheckSum);
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Parallel For (Task Priority)")
+  {
+    // besides the calling thread, only the threads for the given priority may work on the items
+    for (bool bAdaptive : {false, true})
+    {
+      ezParallelForParams priorityParams;
+      priorityParams.m_uiBinSize = 8;
+      priorityParams.m_bAdaptive = bAdaptive;
+      priorityParams.m_TaskPriority = ezTaskPriority::LongRunning;
+
+      const ezWorkerThreadType::Enum callingThreadType = ezTaskSystem::GetCurrentThreadWorkerType();
+      ezAtomicInteger32 iNumWrongThreads;
+      ezAtomicInteger32 iSum;
+
+      ezTaskSystem::ParallelForIndexed(
+        0u, 4096u,
+        [&](ezUInt32 uiStartIndex, ezUInt32 uiEndIndex)
+        {
+          const ezWorkerThreadType::Enum threadType = ezTaskSystem::GetCurrentThreadWorkerType();
+          if (threadType != callingThreadType && threadType != ezWorkerThreadType::LongTasks)
+          {
+            iNumWrongThreads.Increment();
+          }
+
+          for (ezUInt32 i = uiStartIndex; i < uiEndIndex; ++i)
+          {
+            iSum.Add(1);
+          }
+        },
+        bAdaptive ? "ParallelFor Priority Test (Adaptive)" : "ParallelFor Priority Test", priorityParams);
+
+      EZ_TEST_INT(iNumWrongThreads, 0);
+      EZ_TEST_INT(iSum, 4096);
+    }
+  }
 }
@@ -0,0 +1,194 @@
+#include <FoundationTest/FoundationTestPCH.h>
+
+#include <Foundation/Threading/DelegateTask.h>
+#include <Foundation/Threading/TaskGraph.h>
+
+namespace
+{
+  struct NodeExecutionOrder
+  {
+    ezAtomicInteger32 m_iCounter;
+    ezInt32 m_iExecutedAs[8] = {};
+
+    ezSharedPtr<ezTask> CreateTask(ezUInt32 uiNode)
+    {
+      return EZ_DEFAULT_NEW(ezDelegateTask<void>, "GraphNode", ezTaskNesting::Never, [this, uiNode]()
+        { m_iExecutedAs[uiNode] = m_iCounter.Increment(); });
+    }
+  };
+} // namespace
+
+EZ_CREATE_SIMPLE_TEST(Threading, TaskGraph)
+{
+  ezTaskSystem::SetWorkerThreadCount(4, 4);
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Empty Graph")
+  {
+    ezTaskGraph graph;
+    EZ_TEST_BOOL(!graph.IsCompiled());
+    EZ_TEST_BOOL(graph.Compile().Succeeded());
+    EZ_TEST_BOOL(graph.IsCompiled());
+    EZ_TEST_INT(graph.GetNodeCount(), 0);
+
+    ezTaskGroupID group = graph.Launch(ezTaskPriority::ThisFrame);
+    ezTaskSystem::WaitForGroup(group);
+
+    EZ_TEST_BOOL(ezTaskSystem::IsTaskGroupFinished(group));
+    EZ_TEST_BOOL(!graph.IsRunning());
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Dependencies / Replay")
+  {
+    NodeExecutionOrder order;
+
+    //     0     1
+    //    / \    |
+    //   2   3   |
+    //    \ / \  |
+    //     4   5-+
+    //      \ /
+    //       6     7
+    ezTaskGraph graph;
+    ezTaskGraph::NodeIndex n[8];
+    for (ezUInt32 i = 0; i < EZ_ARRAY_SIZE(n); ++i)
+    {
+      n[i] = graph.AddNode(order.CreateTask(i));
+      EZ_TEST_INT(n[i], i);
+    }
+
+    graph.AddDependency(n[2], n[0]);
+    graph.AddDependency(n[3], n[0]);
+    graph.AddDependency(n[4], n[2]);
+    graph.AddDependency(n[4], n[3]);
+    graph.AddDependency(n[5], n[3]);
+    graph.AddDependency(n[5], n[1]);
+    graph.AddDependency(n[6], n[4]);
+    graph.AddDependency(n[6], n[5]);
+
+    EZ_TEST_BOOL(graph.Compile().Succeeded());
+    EZ_TEST_INT(graph.GetNodeCount(), 8);
+
+    // every node has to come after its dependencies in the topological order
+    {
+      ezArrayPtr<const ezTaskGraph::NodeIndex> topoOrder = graph.GetTopologicalOrder();
+      EZ_TEST_INT(topoOrder.GetCount(), 8);
+
+      ezUInt32 uiPosition[8] = {};
+      for (ezUInt32 i = 0; i < topoOrder.GetCount(); ++i)
+      {
+        uiPosition[topoOrder[i]] = i;
+      }
+
+      EZ_TEST_BOOL(uiPosition[0] < uiPosition[2] && uiPosition[0] < uiPosition[3]);
+      EZ_TEST_BOOL(uiPosition[2] < uiPosition[4] && uiPosition[3] < uiPosition[4]);
+      EZ_TEST_BOOL(uiPosition[1] < uiPosition[5] && uiPosition[3] < uiPosition[5]);
+      EZ_TEST_BOOL(uiPosition[4] < uiPosition[6] && uiPosition[5] < uiPosition[6]);
+    }
+
+    for (ezUInt32 run = 0; run < 20; ++run)
+    {
+      order.m_iCounter = 0;
+
+      // changing the cost estimates only changes which ready nodes are started first
+      graph.SetNodeCostEstimate(n[7], (run % 2 == 0) ? 100.0f : 1.0f);
+      EZ_TEST_BOOL(graph.IsCompiled());
+
+      ezTaskGroupID group = graph.Launch(ezTaskPriority::ThisFrame);
+      EZ_TEST_BOOL(group.IsValid());
+
+      ezTaskSystem::WaitForGroup(group);
+      EZ_TEST_BOOL(!graph.IsRunning());
+
+      EZ_TEST_INT(order.m_iCounter, 8);
+      EZ_TEST_BOOL(order.m_iExecutedAs[0] < order.m_iExecutedAs[2] && order.m_iExecutedAs[0] < order.m_iExecutedAs[3]);
+      EZ_TEST_BOOL(order.m_iExecutedAs[2] < order.m_iExecutedAs[4] && order.m_iExecutedAs[3] < order.m_iExecutedAs[4]);
+      EZ_TEST_BOOL(order.m_iExecutedAs[1] < order.m_iExecutedAs[5] && order.m_iExecutedAs[3] < order.m_iExecutedAs[5]);
+      EZ_TEST_BOOL(order.m_iExecutedAs[4] < order.m_iExecutedAs[6] && order.m_iExecutedAs[5] < order.m_iExecutedAs[6]);
+    }
+
+    EZ_TEST_FLOAT(graph.GetNodeCostEstimate(n[7]), 1.0f, 0.0f);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Graph as Dependency")
+  {
+    NodeExecutionOrder order;
+
+    ezTaskGraph graph;
+    const ezTaskGraph::NodeIndex first = graph.AddNode(order.CreateTask(0));
+    const ezTaskGraph::NodeIndex second = graph.AddNode(order.CreateTask(1));
+    graph.AddDependency(second, first);
+    EZ_TEST_BOOL(graph.Compile().Succeeded());
+
+    ezTaskGroupID graphGroup = graph.Launch(ezTaskPriority::LateThisFrame);
+    ezTaskGroupID afterGraph = ezTaskSystem::StartSingleTask(order.CreateTask(2), ezTaskPriority::EarlyThisFrame, graphGroup);
+
+    ezTaskSystem::WaitForGroup(afterGraph);
+
+    EZ_TEST_INT(order.m_iCounter, 3);
+    EZ_TEST_INT(order.m_iExecutedAs[0], 1);
+    EZ_TEST_INT(order.m_iExecutedAs[1], 2);
+    EZ_TEST_INT(order.m_iExecutedAs[2], 3);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Cycle Detection / Clear")
+  {
+    NodeExecutionOrder order;
+
+    ezTaskGraph graph;
+    const ezTaskGraph::NodeIndex a = graph.AddNode(order.CreateTask(0));
+    const ezTaskGraph::NodeIndex b = graph.AddNode(order.CreateTask(1));
+    const ezTaskGraph::NodeIndex c = graph.AddNode(order.CreateTask(2));
+    graph.AddDependency(b, a);
+    graph.AddDependency(c, b);
+    graph.AddDependency(a, c);
+
+    {
+      ezMuteLog logErrorSink;
+      ezLogSystemScope ls(&logErrorSink);
+
+      EZ_TEST_BOOL(graph.Compile().Failed());
+      EZ_TEST_BOOL(!graph.IsCompiled());
+      EZ_TEST_BOOL(graph.GetTopologicalOrder().IsEmpty());
+    }
+
+    graph.Clear();
+    EZ_TEST_INT(graph.GetNodeCount(), 0);
+
+    graph.AddNode(order.CreateTask(0));
+    EZ_TEST_BOOL(graph.Compile().Succeeded());
+    ezTaskSystem::WaitForGroup(graph.Launch(ezTaskPriority::ThisFrame));
+    EZ_TEST_INT(order.m_iCounter, 1);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Modify / Recompile")
+  {
+    NodeExecutionOrder order;
+
+    ezTaskGraph graph;
+    const ezTaskGraph::NodeIndex a = graph.AddNode(order.CreateTask(0));
+    EZ_TEST_BOOL(graph.Compile().Succeeded());
+    ezTaskSystem::WaitForGroup(graph.Launch(ezTaskPriority::ThisFrame));
+    EZ_TEST_INT(order.m_iCounter, 1);
+
+    // adding nodes moves the existing ones in memory, the relaunched graph must still track all of them
+    for (ezUInt32 i = 1; i < EZ_ARRAY_SIZE(order.m_iExecutedAs); ++i)
+    {
+      graph.AddDependency(graph.AddNode(order.CreateTask(i)), a);
+    }
+
+    EZ_TEST_BOOL(!graph.IsCompiled());
+    EZ_TEST_BOOL(graph.Compile().Succeeded());
+
+    for (ezUInt32 run = 0; run < 100; ++run)
+    {
+      order.m_iCounter = 0;
+
+      ezTaskGroupID group = graph.Launch((run % 2 == 0) ? ezTaskPriority::ThisFrame : ezTaskPriority::LateThisFrame);
+      ezTaskSystem::WaitForGroup(group);
+
+      EZ_TEST_BOOL(!graph.IsRunning());
+      EZ_TEST_INT(order.m_iCounter, 8);
+      EZ_TEST_INT(order.m_iExecutedAs[0], 1);
+    }
+  }
+}
@@ -2,6 +2,7 @@
 
 #include <Foundation/IO/FileSystem/DataDirTypeFolder.h>
 #include <Foundation/IO/FileSystem/FileWriter.h>
+#include <Foundation/Threading/DelegateTask.h>
 #include <Foundation/Threading/TaskSystem.h>
 #include <Foundation/Time/Time.h>
 #include <Foundation/Utilities/DGMLWriter.h>
@@ -550,6 +551,166 @@ EZ_CREATE_SIMPLE_TEST(Threading, TaskSystem)
     EZ_TEST_BOOL(t[2]->IsMultiplicityDone());
   }
 
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Work Stealing Scheduler")
+  {
+    ezTaskSystem::SetSchedulingMode(ezTaskSchedulingMode::WorkStealing);
+    EZ_TEST_BOOL(ezTaskSystem::GetSchedulingMode() == ezTaskSchedulingMode::WorkStealing);
+
+    constexpr ezUInt32 uiNumSpawners = 16;
+    constexpr ezUInt32 uiNumChildren = 64;
+
+    ezAtomicInteger32 iChildrenExecuted;
+
+    // the spawners run on the worker threads, so their children are pushed into the worker queues and have to be stolen by the others
+    auto spawn = [&iChildrenExecuted]()
+    {
+      ezTaskGroupID childGroup = ezTaskSystem::CreateTaskGroup(ezTaskPriority::EarlyThisFrame);
+
+      for (ezUInt32 i = 0; i < uiNumChildren; ++i)
+      {
+        ezSharedPtr<ezTask> pChild = EZ_DEFAULT_NEW(ezDelegateTask<void>, "Child", ezTaskNesting::Never, [&iChildrenExecuted]()
+          { iChildrenExecuted.Increment(); });
+        ezTaskSystem::AddTaskToGroup(childGroup, pChild);
+      }
+
+      ezTaskSystem::StartTaskGroup(childGroup);
+      ezTaskSystem::WaitForGroup(childGroup);
+    };
+
+    ezTaskGroupID spawnerGroup = ezTaskSystem::CreateTaskGroup(ezTaskPriority::ThisFrame);
+
+    for (ezUInt32 i = 0; i < uiNumSpawners; ++i)
+    {
+      ezSharedPtr<ezTask> pSpawner = EZ_DEFAULT_NEW(ezDelegateTask<void>, "Spawner", ezTaskNesting::Maybe, spawn);
+      ezTaskSystem::AddTaskToGroup(spawnerGroup, pSpawner);
+    }
+
+    ezTaskSystem::StartTaskGroup(spawnerGroup);
+    ezTaskSystem::WaitForGroup(spawnerGroup);
+
+    EZ_TEST_INT(iChildrenExecuted, uiNumSpawners * uiNumChildren);
+
+    // the main thread queues these in its own queue and doesn't help executing them, so the worker threads have to steal every single one
+    {
+      constexpr ezUInt32 uiNumStolen = 32;
+
+      const ezThreadID mainThreadID = ezThreadUtils::GetCurrentThreadID();
+      const ezUInt64 uiStolenBefore = ezTaskSystem::GetNumStolenTasks();
+      ezAtomicInteger32 iRunOnOtherThread;
+
+      ezTaskGroupID stealGroup = ezTaskSystem::CreateTaskGroup(ezTaskPriority::EarlyThisFrame);
+
+      for (ezUInt32 i = 0; i < uiNumStolen; ++i)
+      {
+        ezSharedPtr<ezTask> pTask = EZ_DEFAULT_NEW(ezDelegateTask<void>, "Stolen", ezTaskNesting::Never, [&iRunOnOtherThread, mainThreadID]()
+          {
+            if (ezThreadUtils::GetCurrentThreadID() != mainThreadID)
+              iRunOnOtherThread.Increment(); });
+        ezTaskSystem::AddTaskToGroup(stealGroup, pTask);
+      }
+
+      ezTaskSystem::StartTaskGroup(stealGroup);
+
+      while (!ezTaskSystem::IsTaskGroupFinished(stealGroup))
+      {
+        ezThreadUtils::Sleep(ezTime::MakeFromMilliseconds(1));
+      }
+
+      EZ_TEST_INT(iRunOnOtherThread, uiNumStolen);
+      EZ_TEST_BOOL(ezTaskSystem::GetNumStolenTasks() - uiStolenBefore >= uiNumStolen);
+    }
+
+    // tasks queued by the main thread with a later priority must still be reprioritized and finished
+    ezSharedPtr<ezTestTask> t[8];
+    ezTaskGroupID tg[8];
+
+    for (ezUInt32 i = 0; i < EZ_ARRAY_SIZE(t); ++i)
+    {
+      t[i] = EZ_DEFAULT_NEW(ezTestTask);
+      t[i]->m_uiIterations = 2;
+      t[i]->SetMultiplicity(i % 2);
+      const ezTaskPriority::Enum priority = (i < 4) ? ezTaskPriority::NextFrame : ezTaskPriority::In2Frames;
+
+      if (i == 0)
+        tg[i] = ezTaskSystem::StartSingleTask(t[i], priority);
+      else
+        tg[i] = ezTaskSystem::StartSingleTask(t[i], priority, tg[i - 1]);
+    }
+
+    ezTaskSystem::FinishFrameTasks();
+    ezTaskSystem::FinishFrameTasks();
+    ezTaskSystem::FinishFrameTasks();
+
+    for (ezUInt32 i = 0; i < EZ_ARRAY_SIZE(t); ++i)
+    {
+      ezTaskSystem::WaitForGroup(tg[i]);
+      EZ_TEST_BOOL(t[i]->IsTaskFinished());
+      EZ_TEST_BOOL((i % 2 == 0) ? t[i]->IsDone() : t[i]->IsMultiplicityDone());
+    }
+
+    ezTaskSystem::SetSchedulingMode(ezTaskSchedulingMode::GlobalQueue);
+    EZ_TEST_BOOL(ezTaskSystem::GetSchedulingMode() == ezTaskSchedulingMode::GlobalQueue);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Task Group Dependency Graphs")
+  {
+    constexpr ezUInt32 uiNumBuilders = 8;
+    constexpr ezUInt32 uiNumGroups = 300; // more than fit into one block of the group pool
+
+    ezAtomicInteger32 iTasksExecuted;
+    ezAtomicInteger32 iOrderViolations;
+
+    // several threads build and start graphs at the same time, each group depends on up to three earlier groups
+    auto build = [&]()
+    {
+      ezTaskGroupID groups[uiNumGroups];
+
+      for (ezUInt32 g = 0; g < uiNumGroups; ++g)
+      {
+        groups[g] = ezTaskSystem::CreateTaskGroup(ezTaskPriority::EarlyThisFrame);
+
+        ezHybridArray<ezTaskGroupID, 3> dependencies;
+        for (ezUInt32 d : {1u, 7u, 31u})
+        {
+          if (g >= d)
+          {
+            dependencies.PushBack(groups[g - d]);
+            ezTaskSystem::AddTaskGroupDependency(groups[g], groups[g - d]);
+          }
+        }
+
+        ezSharedPtr<ezTask> pTask = EZ_DEFAULT_NEW(ezDelegateTask<void>, "Node", ezTaskNesting::Never, [&iTasksExecuted, &iOrderViolations, dependencies]()
+          {
+            for (const ezTaskGroupID& dep : dependencies)
+            {
+              if (!ezTaskSystem::IsTaskGroupFinished(dep))
+                iOrderViolations.Increment();
+            }
+
+            iTasksExecuted.Increment(); });
+
+        ezTaskSystem::AddTaskToGroup(groups[g], pTask);
+        ezTaskSystem::StartTaskGroup(groups[g]);
+      }
+
+      ezTaskSystem::WaitForGroup(groups[uiNumGroups - 1]);
+    };
+
+    ezTaskGroupID builderGroup = ezTaskSystem::CreateTaskGroup(ezTaskPriority::ThisFrame);
+
+    for (ezUInt32 i = 0; i < uiNumBuilders; ++i)
+    {
+      ezSharedPtr<ezTask> pBuilder = EZ_DEFAULT_NEW(ezDelegateTask<void>, "Builder", ezTaskNesting::Maybe, build);
+      ezTaskSystem::AddTaskToGroup(builderGroup, pBuilder);
+    }
+
+    ezTaskSystem::StartTaskGroup(builderGroup);
+    ezTaskSystem::WaitForGroup(builderGroup);
+
+    EZ_TEST_INT(iTasksExecuted, uiNumBuilders * uiNumGroups);
+    EZ_TEST_INT(iOrderViolations, 0);
+  }
+
   // capture profiling info for testing
   /*ezStringBuilder sOutputPath = ezTestFramework::GetInstance()->GetAbsOutputPath();
 
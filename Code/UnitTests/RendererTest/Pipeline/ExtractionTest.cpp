@@ -0,0 +1,352 @@
+#include <RendererTest/RendererTestPCH.h>
+
+#include <Core/World/World.h>
+#include <Foundation/Configuration/CVar.h>
+#include <Foundation/Configuration/Startup.h>
+#include <Foundation/Memory/FrameAllocator.h>
+#include <Foundation/Time/Stopwatch.h>
+#include <RendererCore/Pipeline/ExtractedRenderData.h>
+#include <RendererCore/Pipeline/Extractor.h>
+#include <RendererCore/Pipeline/View.h>
+#include <RendererCore/RenderWorld/RenderWorld.h>
+
+namespace
+{
+  class ezExtractionTestRenderData : public ezRenderData
+  {
+    EZ_ADD_DYNAMIC_REFLECTION(ezExtractionTestRenderData, ezRenderData);
+
+  public:
+    ezUInt32 m_uiObjectIndex = 0;
+  };
+
+  // clang-format off
+  EZ_BEGIN_DYNAMIC_REFLECTED_TYPE(ezExtractionTestRenderData, 1, ezRTTIDefaultAllocator<ezExtractionTestRenderData>)
+  EZ_END_DYNAMIC_REFLECTED_TYPE;
+  // clang-format on
+
+  class ezExtractionTestComponentManager;
+
+  class ezExtractionTestComponent : public ezComponent
+  {
+    EZ_DECLARE_COMPONENT_TYPE(ezExtractionTestComponent, ezComponent, ezExtractionTestComponentManager);
+
+  public:
+    void OnMsgExtractRenderData(ezMsgExtractRenderData& msg) const
+    {
+      // two parts per object, in different categories, to make sure the merged order is the same for every category
+      for (ezUInt32 uiPart = 0; uiPart < 2; ++uiPart)
+      {
+        ezExtractionTestRenderData* pRenderData = ezCreateRenderDataForThisFrame<ezExtractionTestRenderData>(GetOwner());
+        pRenderData->m_GlobalTransform = GetOwner()->GetGlobalTransform();
+        pRenderData->m_GlobalBounds = GetOwner()->GetGlobalBounds();
+        pRenderData->m_uiBatchId = m_uiObjectIndex % 16;
+        pRenderData->m_uiSortingKey = m_uiObjectIndex % 7;
+        pRenderData->m_uiObjectIndex = m_uiObjectIndex;
+
+        msg.AddRenderData(pRenderData, uiPart == 0 ? ezDefaultRenderDataCategories::LitOpaque : ezDefaultRenderDataCategories::LitTransparent, ezRenderData::Caching::Never);
+      }
+    }
+
+    ezUInt32 m_uiObjectIndex = 0;
+  };
+
+  class ezExtractionTestComponentManager : public ezComponentManager<ezExtractionTestComponent, ezBlockStorageType::Compact>
+  {
+  public:
+    ezExtractionTestComponentManager(ezWorld* pWorld)
+      : ezComponentManager<ezExtractionTestComponent, ezBlockStorageType::Compact>(pWorld)
+    {
+    }
+  };
+
+  // clang-format off
+  EZ_BEGIN_COMPONENT_TYPE(ezExtractionTestComponent, 1, ezComponentMode::Dynamic)
+  {
+    EZ_BEGIN_MESSAGEHANDLERS
+    {
+      EZ_MESSAGE_HANDLER(ezMsgExtractRenderData, OnMsgExtractRenderData),
+    }
+    EZ_END_MESSAGEHANDLERS;
+  }
+  EZ_END_COMPONENT_TYPE;
+  // clang-format on
+
+  void SetBoolCVar(ezStringView sName, bool bValue)
+  {
+    ezCVarBool* pCVar = static_cast<ezCVarBool*>(ezCVar::FindCVarByName(sName));
+    if (pCVar != nullptr)
+    {
+      *pCVar = bValue;
+    }
+  }
+
+  ezTime Extract(ezExtractor& ref_extractor, const ezView& view, const ezDynamicArray<const ezGameObject*>& visibleObjects, ezExtractedRenderData& ref_extractedRenderData)
+  {
+    ref_extractedRenderData.Clear();
+
+    ezStopwatch sw;
+    ref_extractor.Extract(view, visibleObjects, ref_extractedRenderData);
+    const ezTime tDiff = sw.GetRunningTotal();
+
+    ref_extractedRenderData.SortAndBatch();
+    return tDiff;
+  }
+
+  void CompareRenderData(const ezExtractedRenderData& expected, const ezExtractedRenderData& actual, ezRenderData::Category category, bool bCompareObjectIndices = true)
+  {
+    ezRenderDataBatchList expectedBatches = expected.GetRenderDataBatchesWithCategory(category);
+    ezRenderDataBatchList actualBatches = actual.GetRenderDataBatchesWithCategory(category);
+
+    if (!EZ_TEST_INT(expectedBatches.GetBatchCount(), actualBatches.GetBatchCount()))
+      return;
+
+    for (ezUInt32 uiBatch = 0; uiBatch < expectedBatches.GetBatchCount(); ++uiBatch)
+    {
+      ezRenderDataBatch expectedBatch = expectedBatches.GetBatch(uiBatch);
+      ezRenderDataBatch actualBatch = actualBatches.GetBatch(uiBatch);
+
+      if (!EZ_TEST_INT(expectedBatch.GetCount(), actualBatch.GetCount()))
+        return;
+
+      auto itExpected = expectedBatch.GetIterator<ezExtractionTestRenderData>();
+      auto itActual = actualBatch.GetIterator<ezExtractionTestRenderData>();
+      for (; itExpected.IsValid() && itActual.IsValid(); ++itExpected, ++itActual)
+      {
+        if (bCompareObjectIndices && itExpected->m_uiObjectIndex != itActual->m_uiObjectIndex)
+        {
+          EZ_TEST_INT(itExpected->m_uiObjectIndex, itActual->m_uiObjectIndex);
+          return;
+        }
+
+        // entries with the same sorting key and batch ID may end up in any order, so only those are compared
+        const ezUInt64 uiExpectedKey = itExpected->GetCategorySortingKey(category, expected.GetCamera());
+        const ezUInt64 uiActualKey = itActual->GetCategorySortingKey(category, actual.GetCamera());
+        if (uiExpectedKey != uiActualKey || itExpected->m_uiBatchId != itActual->m_uiBatchId)
+        {
+          EZ_TEST_BOOL_MSG(false, "Render data %u is sorted differently", itExpected->m_uiObjectIndex);
+          return;
+        }
+      }
+    }
+  }
+} // namespace
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEBUG)
+static const ezTestBlock::Enum EnableInRelease = ezTestBlock::DisabledNoWarning;
+#else
+static const ezTestBlock::Enum EnableInRelease = ezTestBlock::Enabled;
+#endif
+
+EZ_CREATE_SIMPLE_TEST_GROUP(Pipeline);
+
+EZ_CREATE_SIMPLE_TEST(Pipeline, Extraction)
+{
+  ezStartup::StartupCoreSystems();
+  EZ_SCOPE_EXIT(ezStartup::ShutdownCoreSystems());
+
+  ezWorldDesc worldDesc("ExtractionTest");
+  ezWorld world(worldDesc);
+
+  ezView* pView = nullptr;
+  ezViewHandle hView = ezRenderWorld::CreateView("ExtractionTest", pView);
+  EZ_SCOPE_EXIT(ezRenderWorld::DeleteView(hView));
+  pView->SetWorld(&world);
+
+  ezCamera camera;
+  camera.LookAt(ezVec3(-10, -10, 10), ezVec3::MakeZero(), ezVec3(0, 0, 1));
+
+  ezDynamicArray<const ezGameObject*> visibleObjects;
+
+  auto CreateObjects = [&](ezUInt32 uiNumObjects) {
+    EZ_LOCK(world.GetWriteMarker());
+
+    ezExtractionTestComponentManager* pManager = world.GetOrCreateComponentManager<ezExtractionTestComponentManager>();
+
+    ezGameObjectDesc desc;
+    desc.m_bDynamic = true;
+
+    for (ezUInt32 i = visibleObjects.GetCount(); i < uiNumObjects; ++i)
+    {
+      desc.m_LocalPosition.Set(static_cast<float>(i % 256), static_cast<float>((i / 256) % 256), static_cast<float>(i / 65536));
+
+      ezGameObject* pObject = nullptr;
+      world.CreateObject(desc, pObject);
+
+      ezExtractionTestComponent* pComponent = nullptr;
+      pManager->CreateComponent(pObject, pComponent);
+      pComponent->m_uiObjectIndex = i;
+
+      visibleObjects.PushBack(pObject);
+    }
+
+    world.Update();
+  };
+
+  ezVisibleObjectsExtractor extractor;
+  ezExtractedRenderData serialRenderData;
+  ezExtractedRenderData parallelRenderData;
+  serialRenderData.SetCamera(camera);
+  parallelRenderData.SetCamera(camera);
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Deterministic Order")
+  {
+    for (ezUInt32 uiNumObjects : {100u, 5000u, 20000u})
+    {
+      CreateObjects(uiNumObjects);
+
+      SetBoolCVar("Spatial.Extraction.Multithreaded", false);
+      Extract(extractor, *pView, visibleObjects, serialRenderData);
+
+      SetBoolCVar("Spatial.Extraction.Multithreaded", true);
+      Extract(extractor, *pView, visibleObjects, parallelRenderData);
+
+      CompareRenderData(serialRenderData, parallelRenderData, ezDefaultRenderDataCategories::LitOpaque);
+      CompareRenderData(serialRenderData, parallelRenderData, ezDefaultRenderDataCategories::LitTransparent);
+
+      ezFrameAllocator::Reset();
+    }
+  }
+
+  EZ_TEST_BLOCK(EnableInRelease, "Benchmark")
+  {
+    for (ezUInt32 uiNumObjects : {10000u, 30000u, 80000u})
+    {
+      CreateObjects(uiNumObjects);
+
+      for (bool bMultithreaded : {false, true})
+      {
+        SetBoolCVar("Spatial.Extraction.Multithreaded", bMultithreaded);
+
+        // first round always has some overhead
+        Extract(extractor, *pView, visibleObjects, serialRenderData);
+        ezFrameAllocator::Reset();
+
+        ezTime tTotal;
+        constexpr ezUInt32 uiNumRounds = 10;
+        for (ezUInt32 i = 0; i < uiNumRounds; ++i)
+        {
+          tTotal += Extract(extractor, *pView, visibleObjects, serialRenderData);
+          ezFrameAllocator::Reset();
+        }
+
+        ezTestFramework::Output(ezTestOutput::Duration, "Extracting %u objects (%s): %.2fms", uiNumObjects, bMultithreaded ? "multi-threaded" : "single-threaded", tTotal.GetMilliseconds() / uiNumRounds);
+      }
+    }
+
+    SetBoolCVar("Spatial.Extraction.Multithreaded", true);
+  }
+
+  {
+    EZ_LOCK(world.GetWriteMarker());
+    world.Clear();
+  }
+}
+
+EZ_CREATE_SIMPLE_TEST(Pipeline, SortAndBatch)
+{
+  ezStartup::StartupCoreSystems();
+  EZ_SCOPE_EXIT(ezStartup::ShutdownCoreSystems());
+
+  ezCamera camera;
+  camera.LookAt(ezVec3(-10, -10, 10), ezVec3::MakeZero(), ezVec3(0, 0, 1));
+
+  ezDynamicArray<ezExtractionTestRenderData> renderData;
+
+  auto CreateRenderData = [&](ezUInt32 uiCount) {
+    renderData.Clear();
+    renderData.SetCount(uiCount);
+
+    ezUInt32 uiSeed = 42;
+    auto Random = [&]() {
+      uiSeed = uiSeed * 1664525u + 1013904223u;
+      return uiSeed >> 8;
+    };
+
+    for (ezUInt32 i = 0; i < uiCount; ++i)
+    {
+      auto& data = renderData[i];
+      data.m_GlobalTransform.m_vPosition.Set(static_cast<float>(Random() % 1000) * 0.1f, static_cast<float>(Random() % 1000) * 0.1f, 0.0f);
+      data.m_uiBatchId = Random() % 512;
+      data.m_uiSortingKey = Random() % 64;
+      data.m_uiObjectIndex = i;
+    }
+  };
+
+  auto SortAndBatch = [&](ezExtractedRenderData& ref_extractedRenderData) {
+    ref_extractedRenderData.Clear();
+
+    for (ezUInt32 i = 0; i < renderData.GetCount(); ++i)
+    {
+      ref_extractedRenderData.AddRenderData(&renderData[i], (i % 4) == 0 ? ezDefaultRenderDataCategories::LitTransparent : ezDefaultRenderDataCategories::LitOpaque);
+    }
+
+    ezStopwatch sw;
+    ref_extractedRenderData.SortAndBatch();
+    return sw.GetRunningTotal();
+  };
+
+  ezExtractedRenderData comparisonSorted;
+  ezExtractedRenderData radixSorted;
+  comparisonSorted.SetCamera(camera);
+  radixSorted.SetCamera(camera);
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Radix Sort")
+  {
+    for (ezUInt32 uiCount : {10u, 300u, 5000u, 50000u})
+    {
+      CreateRenderData(uiCount);
+
+      SetBoolCVar("Rendering.Sorting.RadixSort", false);
+      SortAndBatch(comparisonSorted);
+
+      SetBoolCVar("Rendering.Sorting.RadixSort", true);
+      SortAndBatch(radixSorted);
+
+      CompareRenderData(comparisonSorted, radixSorted, ezDefaultRenderDataCategories::LitOpaque, false);
+      CompareRenderData(comparisonSorted, radixSorted, ezDefaultRenderDataCategories::LitTransparent, false);
+    }
+  }
+
+  EZ_TEST_BLOCK(EnableInRelease, "Benchmark")
+  {
+    struct Config
+    {
+      const char* m_szName;
+      bool m_bRadixSort;
+      bool m_bMultithreaded;
+    };
+
+    const Config configs[] = {
+      {"comparison sort", false, false},
+      {"radix sort", true, false},
+      {"radix sort, multi-threaded", true, true},
+    };
+
+    for (ezUInt32 uiCount : {10000u, 100000u, 1000000u})
+    {
+      CreateRenderData(uiCount);
+
+      for (const Config& config : configs)
+      {
+        SetBoolCVar("Rendering.Sorting.RadixSort", config.m_bRadixSort);
+        SetBoolCVar("Rendering.Sorting.Multithreaded", config.m_bMultithreaded);
+
+        // first round always has some overhead
+        SortAndBatch(radixSorted);
+
+        ezTime tTotal;
+        constexpr ezUInt32 uiNumRounds = 5;
+        for (ezUInt32 i = 0; i < uiNumRounds; ++i)
+        {
+          tTotal += SortAndBatch(radixSorted);
+        }
+
+        ezTestFramework::Output(ezTestOutput::Duration, "Sorting and batching %u render data (%s): %.2fms", uiCount, config.m_szName, tTotal.GetMilliseconds() / uiNumRounds);
+      }
+    }
+
+    SetBoolCVar("Rendering.Sorting.RadixSort", true);
+    SetBoolCVar("Rendering.Sorting.Multithreaded", true);
+  }
+}
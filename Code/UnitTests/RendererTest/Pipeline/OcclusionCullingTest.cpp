@@ -0,0 +1,555 @@
+#include <RendererTest/RendererTestPCH.h>
+
+#include <Core/Graphics/Camera.h>
+#include <Core/Graphics/Geometry.h>
+#include <Foundation/Configuration/CVar.h>
+#include <Foundation/Configuration/Startup.h>
+#include <Foundation/SimdMath/SimdBBox.h>
+#include <Foundation/SimdMath/SimdConversion.h>
+#include <Foundation/System/SystemInformation.h>
+#include <Foundation/Time/Stopwatch.h>
+#include <RendererCore/Rasterizer/RasterizerObject.h>
+#include <RendererCore/Rasterizer/RasterizerView.h>
+
+namespace
+{
+  void SetIntCVar(ezStringView sName, int iValue)
+  {
+    ezCVarInt* pCVar = static_cast<ezCVarInt*>(ezCVar::FindCVarByName(sName));
+    if (pCVar != nullptr)
+    {
+      *pCVar = iValue;
+    }
+  }
+
+  void SetBoolCVar(ezStringView sName, bool bValue)
+  {
+    ezCVarBool* pCVar = static_cast<ezCVarBool*>(ezCVar::FindCVarByName(sName));
+    if (pCVar != nullptr)
+    {
+      *pCVar = bValue;
+    }
+  }
+
+  /// A grid of city blocks with random heights, separated by streets. The camera is placed at street level, looking down one of the streets.
+  ///
+  /// With bRoundTowers the blocks are round towers with many more triangles, instead of simple boxes.
+  struct CityScene
+  {
+    void Create(ezUInt32 uiBlocksX, ezUInt32 uiBlocksY, ezUInt32 uiNumTestBoxes, bool bRoundTowers = false)
+    {
+      ezUInt32 uiSeed = 42;
+      auto Random = [&](float fMin, float fMax) {
+        uiSeed = uiSeed * 1664525u + 1013904223u;
+        return fMin + (fMax - fMin) * static_cast<float>(uiSeed >> 8) / static_cast<float>(1u << 24);
+      };
+
+      constexpr float fBlockSize = 20.0f;
+      constexpr float fStreetWidth = 8.0f;
+      constexpr float fSpacing = fBlockSize + fStreetWidth;
+
+      m_Occluders.Clear();
+      m_Transforms.Clear();
+
+      ezSharedPtr<const ezRasterizerObject> pTower;
+      if (bRoundTowers)
+      {
+        ezGeometry geo;
+        geo.AddCylinder(0.5f, 0.5f, 0.5f, 0.5f, false, false, 64);
+        pTower = ezRasterizerObject::CreateMesh("OcclusionCullingTest.Tower", geo);
+      }
+
+      for (ezUInt32 y = 0; y < uiBlocksY; ++y)
+      {
+        for (ezUInt32 x = 0; x < uiBlocksX; ++x)
+        {
+          const float fHeight = Random(5.0f, 60.0f);
+          const ezVec3 vPosition(x * fSpacing, (y - uiBlocksY * 0.5f) * fSpacing, fHeight * 0.5f);
+
+          if (bRoundTowers)
+          {
+            m_Occluders.PushBack(pTower);
+            m_Transforms.PushBack(ezTransform(vPosition, ezQuat::MakeIdentity(), ezVec3(fBlockSize, fBlockSize, fHeight)));
+          }
+          else
+          {
+            m_Occluders.PushBack(ezRasterizerObject::CreateBox(ezVec3(fBlockSize, fBlockSize, fHeight)));
+            m_Transforms.PushBack(ezTransform(vPosition));
+          }
+        }
+      }
+
+      // small objects (cars, lamp posts, ...) that are distributed over the whole city
+      m_TestBoxes.Clear();
+      for (ezUInt32 i = 0; i < uiNumTestBoxes; ++i)
+      {
+        const ezVec3 vCenter(Random(0.0f, uiBlocksX * fSpacing), Random(-0.5f, 0.5f) * uiBlocksY * fSpacing, Random(0.0f, 10.0f));
+        const ezVec3 vHalfExtents(Random(0.2f, 2.0f), Random(0.2f, 2.0f), Random(0.2f, 2.0f));
+        m_TestBoxes.PushBack(ezSimdBBox::MakeFromCenterAndHalfExtents(ezSimdConversion::ToVec3(vCenter), ezSimdConversion::ToVec3(vHalfExtents)));
+      }
+
+      m_Camera.SetCameraMode(ezCameraMode::PerspectiveFixedFovY, 70.0f, 0.1f, 1000.0f);
+      m_Camera.LookAt(ezVec3(-fStreetWidth, fBlockSize * 0.5f + fStreetWidth * 0.5f, 1.8f), ezVec3(uiBlocksX * fSpacing, fSpacing, 1.8f), ezVec3(0, 0, 1));
+    }
+
+    ezTime Rasterize(ezRasterizerView& ref_view) const
+    {
+      ezStopwatch sw;
+
+      ref_view.SetCamera(&m_Camera);
+      ref_view.BeginScene();
+
+      for (ezUInt32 i = 0; i < m_Occluders.GetCount(); ++i)
+      {
+        ref_view.AddObject(m_Occluders[i].Borrow(), m_Transforms[i]);
+      }
+
+      ref_view.EndScene();
+      return sw.GetRunningTotal();
+    }
+
+    ezCamera m_Camera;
+    ezDynamicArray<ezSharedPtr<const ezRasterizerObject>> m_Occluders;
+    ezDynamicArray<ezTransform> m_Transforms;
+    ezDynamicArray<ezSimdBBox> m_TestBoxes;
+  };
+} // namespace
+
+#if EZ_ENABLED(EZ_COMPILE_FOR_DEBUG)
+static const ezTestBlock::Enum EnableInRelease = ezTestBlock::DisabledNoWarning;
+#else
+static const ezTestBlock::Enum EnableInRelease = ezTestBlock::Enabled;
+#endif
+
+EZ_CREATE_SIMPLE_TEST(Pipeline, OcclusionCulling)
+{
+  const bool bRasterizerSupported = EZ_ENABLED(EZ_RASTERIZER_SUPPORTED) && ezSystemInformation::Get().GetCpuFeatures().IsAvx2Available();
+  if (!bRasterizerSupported)
+  {
+    ezTestFramework::GetInstance()->Output(ezTestOutput::Warning, "The software occlusion rasterizer is not supported on this platform, skipping test.");
+    return;
+  }
+
+  ezStartup::StartupCoreSystems();
+  EZ_SCOPE_EXIT(ezStartup::ShutdownCoreSystems());
+
+  EZ_SCOPE_EXIT(SetIntCVar("Spatial.Occlusion.Tiles", 8));
+  EZ_SCOPE_EXIT(SetIntCVar("Spatial.Occlusion.MaxOccluders", 64));
+  EZ_SCOPE_EXIT(SetBoolCVar("Spatial.Occlusion.Multithreaded", true));
+  EZ_SCOPE_EXIT(SetBoolCVar("Spatial.Occlusion.Reprojection", false));
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Wall")
+  {
+    ezCamera camera;
+    camera.SetCameraMode(ezCameraMode::PerspectiveFixedFovY, 70.0f, 0.1f, 1000.0f);
+    camera.LookAt(ezVec3::MakeZero(), ezVec3(1, 0, 0), ezVec3(0, 0, 1));
+
+    // a wall that covers the entire screen
+    ezSharedPtr<const ezRasterizerObject> pWall = ezRasterizerObject::CreateBox(ezVec3(1, 200, 200));
+
+    const ezSimdBBox behindWall = ezSimdBBox::MakeFromCenterAndHalfExtents(ezSimdVec4f(30, 0, 0), ezSimdVec4f(1, 1, 1));
+    const ezSimdBBox inFrontOfWall = ezSimdBBox::MakeFromCenterAndHalfExtents(ezSimdVec4f(5, 0, 0), ezSimdVec4f(1, 1, 1));
+    const ezSimdBBox acrossTiles = ezSimdBBox::MakeFromCenterAndHalfExtents(ezSimdVec4f(5, 0, 0), ezSimdVec4f(0.5f, 0.5f, 8));
+    const ezSimdBBox boxes[] = {behindWall, inFrontOfWall, acrossTiles};
+    const bool expected[] = {false, true, true};
+
+    for (int iNumTiles : {1, 3, 8})
+    {
+      SetIntCVar("Spatial.Occlusion.Tiles", iNumTiles);
+
+      ezRasterizerView view;
+      view.SetResolution(256, 128, 0.0f);
+      view.SetCamera(&camera);
+      view.BeginScene();
+      view.AddObject(pWall.Borrow(), ezTransform(ezVec3(10, 0, 0)));
+      view.EndScene();
+
+      EZ_TEST_BOOL(view.HasRasterizedAnyOccluders());
+
+      bool visible[EZ_ARRAY_SIZE(boxes)];
+      view.AreVisible(boxes, visible);
+
+      for (ezUInt32 i = 0; i < EZ_ARRAY_SIZE(boxes); ++i)
+      {
+        EZ_TEST_BOOL(view.IsVisible(boxes[i]) == expected[i]);
+        EZ_TEST_BOOL(visible[i] == expected[i]);
+      }
+    }
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "City Blocks")
+  {
+    CityScene scene;
+    scene.Create(16, 16, 5000);
+
+    SetIntCVar("Spatial.Occlusion.MaxOccluders", 1000);
+
+    ezDynamicArray<bool> visibleSingleTile;
+    ezDynamicArray<bool> visibleTiled;
+    visibleSingleTile.SetCount(scene.m_TestBoxes.GetCount());
+    visibleTiled.SetCount(scene.m_TestBoxes.GetCount());
+
+    for (int iNumTiles : {1, 8})
+    {
+      SetIntCVar("Spatial.Occlusion.Tiles", iNumTiles);
+
+      ezRasterizerView view;
+      view.SetResolution(512, 256, 0.0f);
+      scene.Rasterize(view);
+
+      ezDynamicArray<bool>& visible = (iNumTiles == 1) ? visibleSingleTile : visibleTiled;
+      view.AreVisible(scene.m_TestBoxes, visible);
+
+      ezUInt32 uiNumVisible = 0;
+      ezUInt32 uiNumDifferentFromSingle = 0;
+      for (ezUInt32 i = 0; i < scene.m_TestBoxes.GetCount(); ++i)
+      {
+        uiNumVisible += visible[i] ? 1 : 0;
+        uiNumDifferentFromSingle += (view.IsVisible(scene.m_TestBoxes[i]) != visible[i]) ? 1 : 0;
+      }
+
+      // most of the city has to be hidden behind the first few blocks
+      EZ_TEST_BOOL(uiNumVisible > 0);
+      EZ_TEST_BOOL(uiNumVisible < scene.m_TestBoxes.GetCount() / 4);
+
+      // AreVisible() projects the boxes itself, only boxes at the edges of occluders may differ due to floating point precision
+      EZ_TEST_BOOL(uiNumDifferentFromSingle <= scene.m_TestBoxes.GetCount() / 100);
+    }
+
+    // the tiles use the same pixel grid as a single buffer, only edges may differ due to floating point precision
+    ezUInt32 uiNumDifferent = 0;
+    for (ezUInt32 i = 0; i < scene.m_TestBoxes.GetCount(); ++i)
+    {
+      uiNumDifferent += (visibleSingleTile[i] != visibleTiled[i]) ? 1 : 0;
+    }
+
+    EZ_TEST_BOOL(uiNumDifferent <= scene.m_TestBoxes.GetCount() / 100);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Occluder Budget")
+  {
+    ezCamera camera;
+    camera.SetCameraMode(ezCameraMode::PerspectiveFixedFovY, 70.0f, 0.1f, 1000.0f);
+    camera.LookAt(ezVec3::MakeZero(), ezVec3(1, 0, 0), ezVec3(0, 0, 1));
+
+    // a close wall that covers the upper half of the screen and a farther one that covers the lower half, so they end up in different tiles
+    ezSharedPtr<const ezRasterizerObject> pUpperWall = ezRasterizerObject::CreateBox(ezVec3(1, 200, 10));
+    ezSharedPtr<const ezRasterizerObject> pLowerWall = ezRasterizerObject::CreateBox(ezVec3(1, 400, 20));
+
+    const ezSimdBBox behindUpperWall = ezSimdBBox::MakeFromCenterAndHalfExtents(ezSimdVec4f(40, 0, 12), ezSimdVec4f(1, 1, 1));
+    const ezSimdBBox behindLowerWall = ezSimdBBox::MakeFromCenterAndHalfExtents(ezSimdVec4f(40, 0, -12), ezSimdVec4f(1, 1, 1));
+
+    for (bool bMultithreaded : {false, true})
+    {
+      SetBoolCVar("Spatial.Occlusion.Multithreaded", bMultithreaded);
+      SetIntCVar("Spatial.Occlusion.Tiles", 8);
+
+      for (int iMaxOccluders : {1, 2})
+      {
+        SetIntCVar("Spatial.Occlusion.MaxOccluders", iMaxOccluders);
+
+        ezRasterizerView view;
+        view.SetResolution(256, 128, 0.0f);
+        view.SetCamera(&camera);
+        view.BeginScene();
+        view.AddObject(pLowerWall.Borrow(), ezTransform(ezVec3(20, 0, -10.5f)));
+        view.AddObject(pUpperWall.Borrow(), ezTransform(ezVec3(10, 0, 5.5f)));
+        view.EndScene();
+
+        // the limit applies to the whole view and the closest occluder gets it, although the farther one is in other tiles
+        EZ_TEST_BOOL(!view.IsVisible(behindUpperWall));
+        EZ_TEST_BOOL(view.IsVisible(behindLowerWall) == (iMaxOccluders == 1));
+      }
+    }
+
+    SetBoolCVar("Spatial.Occlusion.Multithreaded", true);
+    SetIntCVar("Spatial.Occlusion.MaxOccluders", 64);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Reprojection")
+  {
+    CityScene scene;
+    scene.Create(16, 16, 5000);
+
+    SetIntCVar("Spatial.Occlusion.MaxOccluders", 1000);
+
+    ezRasterizerView reprojectedView;
+    reprojectedView.SetResolution(512, 256, 0.0f);
+
+    ezRasterizerView referenceView;
+    referenceView.SetResolution(512, 256, 0.0f);
+
+    ezDynamicArray<bool> visibleReprojected;
+    ezDynamicArray<bool> visibleReference;
+    visibleReprojected.SetCount(scene.m_TestBoxes.GetCount());
+    visibleReference.SetCount(scene.m_TestBoxes.GetCount());
+
+    const ezVec3 vStartPosition = scene.m_Camera.GetCenterPosition();
+    const ezVec3 vStartDirection = scene.m_Camera.GetCenterDirForwards();
+
+    ezUInt32 uiNumReprojectedFrames = 0;
+    ezUInt32 uiNumFalselyOccluded = 0;
+    ezUInt32 uiNumVisibleReference = 0;
+    ezUInt32 uiNumVisibleReprojected = 0;
+
+    // walk down the street while slowly turning, every frame compare against a fully rasterized buffer
+    for (ezUInt32 uiFrame = 0; uiFrame < 40; ++uiFrame)
+    {
+      const ezQuat qTurn = ezQuat::MakeFromAxisAndAngle(ezVec3(0, 0, 1), ezAngle::MakeFromDegree(uiFrame * 0.5f));
+      const ezVec3 vPosition = vStartPosition + vStartDirection * (uiFrame * 0.25f);
+      scene.m_Camera.LookAt(vPosition, vPosition + qTurn * vStartDirection, ezVec3(0, 0, 1));
+
+      SetBoolCVar("Spatial.Occlusion.Reprojection", true);
+      scene.Rasterize(reprojectedView);
+      reprojectedView.AreVisible(scene.m_TestBoxes, visibleReprojected);
+      uiNumReprojectedFrames += reprojectedView.WasReprojected() ? 1 : 0;
+
+      SetBoolCVar("Spatial.Occlusion.Reprojection", false);
+      scene.Rasterize(referenceView);
+      referenceView.AreVisible(scene.m_TestBoxes, visibleReference);
+      EZ_TEST_BOOL(!referenceView.WasReprojected());
+
+      for (ezUInt32 i = 0; i < scene.m_TestBoxes.GetCount(); ++i)
+      {
+        uiNumFalselyOccluded += (visibleReference[i] && !visibleReprojected[i]) ? 1 : 0;
+        uiNumVisibleReference += visibleReference[i] ? 1 : 0;
+        uiNumVisibleReprojected += visibleReprojected[i] ? 1 : 0;
+      }
+    }
+
+    // the reprojected buffer is conservative, it may hide fewer boxes but (apart from imprecisions at the edges) never more
+    EZ_TEST_BOOL(uiNumReprojectedFrames >= 30);
+    EZ_TEST_BOOL(uiNumFalselyOccluded <= uiNumVisibleReference / 1000);
+
+    // but it still has to hide most of the city
+    EZ_TEST_BOOL(uiNumVisibleReprojected < 40 * scene.m_TestBoxes.GetCount() / 4);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Reprojection with moving occluders")
+  {
+    SetBoolCVar("Spatial.Occlusion.Reprojection", true);
+
+    ezCamera camera;
+    camera.SetCameraMode(ezCameraMode::PerspectiveFixedFovY, 70.0f, 0.1f, 1000.0f);
+    camera.LookAt(ezVec3::MakeZero(), ezVec3(1, 0, 0), ezVec3(0, 0, 1));
+
+    ezSharedPtr<const ezRasterizerObject> pWall = ezRasterizerObject::CreateBox(ezVec3(1, 40, 40));
+    ezSharedPtr<const ezRasterizerObject> pPillar = ezRasterizerObject::CreateBox(ezVec3(1, 1, 40));
+
+    const ezSimdBBox behindWall = ezSimdBBox::MakeFromCenterAndHalfExtents(ezSimdVec4f(60, 0, 0), ezSimdVec4f(1, 1, 1));
+
+    ezRasterizerView view;
+    view.SetResolution(256, 128, 0.0f);
+
+    auto RasterizeFrame = [&](const ezTransform* pWallTransform) {
+      view.SetCamera(&camera);
+      view.BeginScene();
+
+      if (pWallTransform != nullptr)
+      {
+        view.AddObject(pWall.Borrow(), *pWallTransform);
+      }
+
+      view.AddObject(pPillar.Borrow(), ezTransform(ezVec3(30, 8, 0)));
+      view.EndScene();
+    };
+
+    const ezTransform wall(ezVec3(30, 0, 0));
+    RasterizeFrame(&wall);
+    EZ_TEST_BOOL(!view.WasReprojected());
+    EZ_TEST_BOOL(!view.IsVisible(behindWall));
+
+    RasterizeFrame(&wall);
+    EZ_TEST_BOOL(view.WasReprojected());
+    EZ_TEST_BOOL(!view.IsVisible(behindWall));
+
+    // the wall moves up, the box behind it becomes visible
+    const ezTransform movedWall(ezVec3(30, 0, 30));
+    RasterizeFrame(&movedWall);
+    EZ_TEST_BOOL(view.WasReprojected());
+    EZ_TEST_BOOL(view.IsVisible(behindWall));
+
+    // restore the keyframe state and then remove the wall entirely
+    SetBoolCVar("Spatial.Occlusion.Reprojection", false);
+    RasterizeFrame(&wall);
+    SetBoolCVar("Spatial.Occlusion.Reprojection", true);
+
+    RasterizeFrame(&wall);
+    EZ_TEST_BOOL(!view.WasReprojected());
+    EZ_TEST_BOOL(!view.IsVisible(behindWall));
+
+    RasterizeFrame(nullptr);
+    EZ_TEST_BOOL(view.WasReprojected());
+    EZ_TEST_BOOL(view.IsVisible(behindWall));
+
+    SetBoolCVar("Spatial.Occlusion.Reprojection", false);
+  }
+
+  EZ_TEST_BLOCK(ezTestBlock::Enabled, "Reprojection at silhouettes")
+  {
+    SetIntCVar("Spatial.Occlusion.MaxOccluders", 1000);
+
+    ezCamera camera;
+    camera.SetCameraMode(ezCameraMode::PerspectiveFixedFovY, 70.0f, 0.1f, 1000.0f);
+
+    ezSharedPtr<const ezRasterizerObject> pWall = ezRasterizerObject::CreateBox(ezVec3(1, 40, 20));
+    const ezTransform wall(ezVec3(40, 0, 0));
+
+    // small boxes behind the wall, right above and next to its edges, these must never be hidden
+    ezDynamicArray<ezSimdBBox> boxesAtEdges;
+    for (float fPos = -19.0f; fPos <= 19.0f; fPos += 1.0f)
+    {
+      boxesAtEdges.PushBack(ezSimdBBox::MakeFromCenterAndHalfExtents(ezSimdVec4f(41, fPos, 12.0f), ezSimdVec4f(0.2f)));
+      boxesAtEdges.PushBack(ezSimdBBox::MakeFromCenterAndHalfExtents(ezSimdVec4f(41, fPos, -12.0f), ezSimdVec4f(0.2f)));
+    }
+    for (float fPos = -9.0f; fPos <= 9.0f; fPos += 1.0f)
+    {
+      boxesAtEdges.PushBack(ezSimdBBox::MakeFromCenterAndHalfExtents(ezSimdVec4f(41, 22.0f, fPos), ezSimdVec4f(0.2f)));
+      boxesAtEdges.PushBack(ezSimdBBox::MakeFromCenterAndHalfExtents(ezSimdVec4f(41, -22.0f, fPos), ezSimdVec4f(0.2f)));
+    }
+
+    const ezSimdBBox behindWall = ezSimdBBox::MakeFromCenterAndHalfExtents(ezSimdVec4f(60, 0, 0), ezSimdVec4f(1, 1, 1));
+
+    ezRasterizerView reprojectedView;
+    reprojectedView.SetResolution(512, 256, 0.0f);
+
+    ezRasterizerView referenceView;
+    referenceView.SetResolution(512, 256, 0.0f);
+
+    auto RasterizeFrame = [&](ezRasterizerView& view, bool bReproject) {
+      SetBoolCVar("Spatial.Occlusion.Reprojection", bReproject);
+      view.SetCamera(&camera);
+      view.BeginScene();
+      view.AddObject(pWall.Borrow(), wall);
+      view.EndScene();
+    };
+
+    ezUInt32 uiNumReprojectedFrames = 0;
+    ezUInt32 uiNumFalselyOccluded = 0;
+
+    // roll and turn the camera, which rotates the reprojected blocks on screen, and move it sideways
+    for (ezUInt32 uiFrame = 0; uiFrame < 8; ++uiFrame)
+    {
+      const ezQuat qRoll = ezQuat::MakeFromAxisAndAngle(ezVec3(1, 0, 0), ezAngle::MakeFromDegree(uiFrame * 1.2f));
+      const ezQuat qTurn = ezQuat::MakeFromAxisAndAngle(ezVec3(0, 0, 1), ezAngle::MakeFromDegree(uiFrame * 0.5f));
+      const ezVec3 vPosition(0, uiFrame * 0.2f, 0);
+      camera.LookAt(vPosition, vPosition + qTurn * ezVec3(1, 0, 0), qRoll * ezVec3(0, 0, 1));
+
+      RasterizeFrame(reprojectedView, true);
+      uiNumReprojectedFrames += reprojectedView.WasReprojected() ? 1 : 0;
+
+      RasterizeFrame(referenceView, false);
+
+      for (const ezSimdBBox& box : boxesAtEdges)
+      {
+        const bool bVisibleReference = referenceView.IsVisible(box);
+        EZ_TEST_BOOL(bVisibleReference);
+
+        uiNumFalselyOccluded += (bVisibleReference && !reprojectedView.IsVisible(box)) ? 1 : 0;
+      }
+
+      EZ_TEST_BOOL(!reprojectedView.IsVisible(behindWall));
+    }
+
+    EZ_TEST_BOOL(uiNumReprojectedFrames == 7);
+    EZ_TEST_INT(uiNumFalselyOccluded, 0);
+
+    SetBoolCVar("Spatial.Occlusion.Reprojection", false);
+  }
+
+  EZ_TEST_BLOCK(EnableInRelease, "Benchmark")
+  {
+    CityScene scene;
+    scene.Create(64, 64, 100000);
+
+    SetIntCVar("Spatial.Occlusion.MaxOccluders", 256);
+
+    struct Config
+    {
+      const char* m_szName;
+      int m_iNumTiles;
+      bool m_bMultithreaded;
+    };
+
+    const Config configs[] = {
+      {"1 tile", 1, false},
+      {"8 tiles, single-threaded", 8, false},
+      {"8 tiles, multi-threaded", 8, true},
+    };
+
+    ezDynamicArray<bool> visible;
+    visible.SetCount(scene.m_TestBoxes.GetCount());
+
+    for (const Config& config : configs)
+    {
+      SetIntCVar("Spatial.Occlusion.Tiles", config.m_iNumTiles);
+      SetBoolCVar("Spatial.Occlusion.Multithreaded", config.m_bMultithreaded);
+
+      ezRasterizerView view;
+      view.SetResolution(512, 288, 0.0f);
+
+      // first round always has some overhead
+      scene.Rasterize(view);
+
+      constexpr ezUInt32 uiNumRounds = 20;
+
+      ezTime tRasterize;
+      for (ezUInt32 i = 0; i < uiNumRounds; ++i)
+      {
+        tRasterize += scene.Rasterize(view);
+      }
+
+      ezStopwatch sw;
+      for (ezUInt32 i = 0; i < uiNumRounds; ++i)
+      {
+        for (ezUInt32 b = 0; b < scene.m_TestBoxes.GetCount(); ++b)
+        {
+          visible[b] = view.IsVisible(scene.m_TestBoxes[b]);
+        }
+      }
+      const ezTime tSingleQueries = sw.Checkpoint();
+
+      for (ezUInt32 i = 0; i < uiNumRounds; ++i)
+      {
+        view.AreVisible(scene.m_TestBoxes, visible);
+      }
+      const ezTime tBatchQueries = sw.Checkpoint();
+
+      ezTestFramework::Output(ezTestOutput::Duration, "Rasterizing %u city blocks (%s): %.3fms", scene.m_Occluders.GetCount(), config.m_szName, tRasterize.GetMilliseconds() / uiNumRounds);
+      ezTestFramework::Output(ezTestOutput::Duration, "Testing %u boxes (%s): %.3fms individually, %.3fms batched", scene.m_TestBoxes.GetCount(), config.m_szName, tSingleQueries.GetMilliseconds() / uiNumRounds, tBatchQueries.GetMilliseconds() / uiNumRounds);
+    }
+
+    // per frame cost with a camera that walks down the street
+    SetIntCVar("Spatial.Occlusion.Tiles", 8);
+    SetBoolCVar("Spatial.Occlusion.Multithreaded", true);
+
+    for (bool bRoundTowers : {false, true})
+    {
+      scene.Create(64, 64, 0, bRoundTowers);
+
+      const ezVec3 vStartPosition = scene.m_Camera.GetCenterPosition();
+      const ezVec3 vDirection = scene.m_Camera.GetCenterDirForwards();
+
+      for (bool bReprojection : {false, true})
+      {
+        SetBoolCVar("Spatial.Occlusion.Reprojection", bReprojection);
+
+        ezRasterizerView view;
+        view.SetResolution(512, 288, 0.0f);
+
+        constexpr ezUInt32 uiNumFrames = 64;
+
+        ezTime tRasterize;
+        for (ezUInt32 uiFrame = 0; uiFrame < uiNumFrames; ++uiFrame)
+        {
+          const ezVec3 vPosition = vStartPosition + vDirection * (uiFrame * 0.1f);
+          scene.m_Camera.LookAt(vPosition, vPosition + vDirection, ezVec3(0, 0, 1));
+
+          tRasterize += scene.Rasterize(view);
+        }
+
+        ezTestFramework::Output(ezTestOutput::Duration, "Rasterizing %u %s with a moving camera (%s): %.3fms per frame", scene.m_Occluders.GetCount(), bRoundTowers ? "round towers" : "city blocks", bReprojection ? "reprojected" : "full", tRasterize.GetMilliseconds() / uiNumFrames);
+      }
+    }
+  }
+}